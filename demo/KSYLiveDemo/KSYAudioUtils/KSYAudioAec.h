@@ -0,0 +1,81 @@
+//
+//  KSYAudioAec.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** 回声消除 (分块频域自适应滤波, MDF)
+
+ 1. 远端参考信号(扬声器播放的内容)经自适应滤波估计出麦克风中的回声, 从麦克风信号中减去
+ 2. 滤波器按块长分为多段, 块长约12ms (44.1kHz时512帧), 每段每块要做一次 2*块长 点的
+    正/逆FFT (梯度约束), 计算量与回声尾长成正比
+ 3. 输出相对输入延迟一个块长, 与回声尾长无关
+ 4. 前台/后台两组滤波器: 后台以固定的归一化步长持续自适应, 误差稳定地小于前台时拷贝到前台,
+    明显大于前台时(双讲中被近端人声带偏)用前台覆盖; 输出只用前台, 双讲时不会被破坏
+ 5. 前台误差持续大于输入时认为回声路径已经突变, 清空滤波器重新收敛
+ 6. 只做线性回声消除, 输入输出均为单声道; 远端与近端须为同一采样率且逐帧对齐
+ */
+typedef struct _KSYAudioAec KSYAudioAec;
+
+/// 统计信息 (处理线程读取)
+typedef struct {
+    /// 回声衰减量 ERLE (dB, 远端有声音时的平滑值)
+    float   erleDb;
+    /// 前台滤波器是否已更新过 (初步收敛)
+    BOOL    bAdapted;
+    /// 最近一块远端是否有声音
+    BOOL    bFarActive;
+    /// 平均每块的处理耗时 (微秒)
+    float   avgUs;
+    /// 处理的块数
+    int64_t nbBlock;
+    /// 前台滤波器的更新次数
+    int     nbUpdate;
+    /// 发散后重置的次数
+    int     nbReset;
+} KSYAecStat;
+
+/**
+ @abstract  创建
+ @param     rate   采样率 (8000~48000)
+ @param     tailMs 回声尾长 (毫秒, 20~500), 应覆盖播放到采集的延迟加房间混响
+ @return    参数错误时返回NULL
+ */
+KSYAudioAec* ksy_aec_create(int rate, int tailMs);
+
+/**
+ @abstract  销毁
+ */
+void ksy_aec_destroy(KSYAudioAec* aec);
+
+/**
+ @abstract  块长 (帧), 即引入的延迟
+ */
+int ksy_aec_block_size(const KSYAudioAec* aec);
+
+/**
+ @abstract  处理 float 数据
+ @param     far  远端参考, 与 mic 同一时刻的 nbFrame 帧, NULL 表示静音
+ @param     mic  麦克风数据, 原地替换为消除回声后的结果
+ @param     nbFrame 帧数, 任意
+ */
+void ksy_aec_process_f32(KSYAudioAec* aec, const float* far, float* mic, int nbFrame);
+
+/**
+ @abstract  处理 S16 数据, 参数同 ksy_aec_process_f32
+ */
+void ksy_aec_process_s16(KSYAudioAec* aec, const int16_t* far, int16_t* mic, int nbFrame);
+
+/**
+ @abstract  读取统计信息
+ */
+void ksy_aec_get_stat(const KSYAudioAec* aec, KSYAecStat* stat);
+
+/**
+ @abstract  清空滤波器和缓冲的数据 (回声路径突变时, 如切换扬声器/耳机)
+ */
+void ksy_aec_reset(KSYAudioAec* aec);
@@ -0,0 +1,379 @@
+//
+//  KSYAudioAec.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioAec.h"
+#import "KSYAudioFFT.h"
+#import "KSYAudioKernel.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define AEC_MAX_PART    128
+#define AEC_IO          256     // S16 转换的块长 (帧)
+#define AEC_MU          0.8f    // 后台滤波器的步长 (归一化)
+#define AEC_FAR_THRESH  1e-7f   // 远端每个样本的平均功率低于此值 (-70dBFS) 时不更新滤波器
+#define AEC_REG         3.0f    // 归一化的正则项 (相对平均功率)
+#define AEC_BACKTRACK   4.0f    // 后台比前台差多少时用前台覆盖后台
+#define AEC_DIV_BLOCKS  50      // 前台误差持续大于输入的块数, 超过时认为已发散
+#define AEC_EPS         1e-10f
+
+struct _KSYAudioAec {
+    int             rate;
+    int             N;          // 块长
+    int             L;          // FFT长度 2N
+    int             nbBin;      // N+1
+    int             M;          // 分段数
+    KSYAudioFFT *   fft;
+    float *         xTime;      // 远端最近两块 (L)
+    float *         X;          // 各段的远端频谱 (M 个, 环形, 每个 L+2)
+    int             xHead;      // 最新一块所在的位置
+    float *         W;          // 后台滤波器频谱 (M 个, 每个 L+2), 持续自适应
+    float *         F;          // 前台滤波器频谱, 用于输出
+    float *         Pxx;        // 远端各段的功率谱之和 (NLMS 的归一化)
+    float *         E;          // 误差频谱
+    float *         Y;          // 回声估计频谱
+    float *         eb;         // 后台误差 (N)
+    float *         tmp;
+    float *         tmpF;
+    float           Davg1;      // 前后台误差之差的平滑 (短/长两个时间常数)
+    float           Dvar1;
+    float           Davg2;
+    float           Dvar2;
+    float           Sdd;        // 近端功率 (平滑, 计算ERLE)
+    float           Sff;        // 前台误差功率 (平滑)
+    int             divCnt;     // 前台误差大于输入的连续块数
+    // 分块缓冲
+    float *         farIn;
+    float *         micIn;
+    float *         out;
+    int             fill;
+    KSYAecStat      stat;
+    float           farIo[AEC_IO];
+    float           micIo[AEC_IO];
+};
+
+static double nowUs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec * 1e-3;
+}
+
+KSYAudioAec* ksy_aec_create(int rate, int tailMs) {
+    if (rate < 8000 || rate > 48000 || tailMs < 20 || tailMs > 500) {
+        return NULL;
+    }
+    KSYAudioAec* aec = calloc(1, sizeof(KSYAudioAec));
+    if (aec == NULL) {
+        return NULL;
+    }
+    // 块长取不超过约12ms的2的整数次幂
+    int N = 64;
+    while (N * 2 <= rate * 12 / 1000) {
+        N <<= 1;
+    }
+    int tail = (int)((int64_t)rate * tailMs / 1000);
+    aec->rate  = rate;
+    aec->N     = N;
+    aec->L     = 2 * N;
+    aec->nbBin = N + 1;
+    aec->M     = (tail + N - 1) / N;
+    if (aec->M > AEC_MAX_PART) {
+        aec->M = AEC_MAX_PART;
+    }
+    const int spec = aec->L + 2;
+    aec->fft   = ksy_fft_create(aec->L);
+    aec->xTime = calloc(aec->L, sizeof(float));
+    aec->X     = calloc((size_t)aec->M * spec, sizeof(float));
+    aec->W     = calloc((size_t)aec->M * spec, sizeof(float));
+    aec->F     = calloc((size_t)aec->M * spec, sizeof(float));
+    aec->Pxx   = calloc(aec->nbBin, sizeof(float));
+    aec->E     = calloc(spec, sizeof(float));
+    aec->Y     = calloc(spec, sizeof(float));
+    aec->eb    = calloc(N, sizeof(float));
+    aec->tmp   = calloc(spec, sizeof(float));
+    aec->tmpF  = calloc(spec, sizeof(float));
+    aec->farIn = calloc(N, sizeof(float));
+    aec->micIn = calloc(N, sizeof(float));
+    aec->out   = calloc(N, sizeof(float));
+    if (!aec->fft || !aec->xTime || !aec->X || !aec->W || !aec->F || !aec->Pxx || !aec->E ||
+        !aec->Y || !aec->eb || !aec->tmp || !aec->tmpF || !aec->farIn || !aec->micIn || !aec->out) {
+        ksy_aec_destroy(aec);
+        return NULL;
+    }
+    ksy_aec_reset(aec);
+    return aec;
+}
+
+void ksy_aec_destroy(KSYAudioAec* aec) {
+    if (aec == NULL) {
+        return;
+    }
+    ksy_fft_destroy(aec->fft);
+    free(aec->xTime);
+    free(aec->X);
+    free(aec->W);
+    free(aec->F);
+    free(aec->Pxx);
+    free(aec->E);
+    free(aec->Y);
+    free(aec->eb);
+    free(aec->tmp);
+    free(aec->tmpF);
+    free(aec->farIn);
+    free(aec->micIn);
+    free(aec->out);
+    free(aec);
+}
+
+int ksy_aec_block_size(const KSYAudioAec* aec) {
+    return aec ? aec->N : 0;
+}
+
+void ksy_aec_get_stat(const KSYAudioAec* aec, KSYAecStat* stat) {
+    if (aec && stat) {
+        *stat = aec->stat;
+    }
+}
+
+// 只清空滤波器和收敛状态, 远端历史保留
+static void resetFilter(KSYAudioAec* aec) {
+    const size_t spec = aec->L + 2;
+    memset(aec->W, 0, sizeof(float) * aec->M * spec);
+    memset(aec->F, 0, sizeof(float) * aec->M * spec);
+    aec->Davg1 = aec->Dvar1 = 0;
+    aec->Davg2 = aec->Dvar2 = 0;
+    aec->divCnt        = 0;
+    aec->stat.bAdapted = NO;
+}
+
+void ksy_aec_reset(KSYAudioAec* aec) {
+    if (aec == NULL) {
+        return;
+    }
+    const size_t spec = aec->L + 2;
+    memset(aec->xTime, 0, sizeof(float) * aec->L);
+    memset(aec->X,     0, sizeof(float) * aec->M * spec);
+    memset(aec->Pxx,   0, sizeof(float) * aec->nbBin);
+    memset(aec->farIn, 0, sizeof(float) * aec->N);
+    memset(aec->micIn, 0, sizeof(float) * aec->N);
+    memset(aec->out,   0, sizeof(float) * aec->N);
+    aec->fill  = 0;
+    aec->xHead = 0;
+    aec->Sdd   = 0;
+    aec->Sff   = 0;
+    memset(&aec->stat, 0, sizeof(KSYAecStat));
+    resetFilter(aec);
+}
+
+static float blockPower(const float* x, int n) {
+    float s = 0;
+    for (int i = 0; i < n; ++i) {
+        s += x[i] * x[i];
+    }
+    return s;
+}
+
+// 两组滤波器的比较: 后台误差持续小于前台时拷贝到前台, 明显大于前台时 (双讲中被带偏) 用前台覆盖后台
+static int compareFilters(KSYAudioAec* aec, float Sff, float See, float Dbf) {
+    float diff = Sff - See;
+    aec->Davg1 = 0.6f  * aec->Davg1 + 0.4f  * diff;
+    aec->Dvar1 = 0.36f * aec->Dvar1 + 0.16f * Sff * Dbf;
+    aec->Davg2 = 0.85f   * aec->Davg2 + 0.15f   * diff;
+    aec->Dvar2 = 0.7225f * aec->Dvar2 + 0.0225f * Sff * Dbf;
+    if (diff * fabsf(diff) > Sff * Dbf ||
+        aec->Davg1 * fabsf(aec->Davg1) > 0.5f  * aec->Dvar1 ||
+        aec->Davg2 * fabsf(aec->Davg2) > 0.25f * aec->Dvar2) {
+        aec->Davg1 = aec->Davg2 = aec->Dvar1 = aec->Dvar2 = 0;
+        return 1;
+    }
+    if (-diff * fabsf(diff) > AEC_BACKTRACK * Sff * Dbf ||
+        -aec->Davg1 * fabsf(aec->Davg1) > AEC_BACKTRACK * aec->Dvar1 ||
+        -aec->Davg2 * fabsf(aec->Davg2) > AEC_BACKTRACK * aec->Dvar2) {
+        aec->Davg1 = aec->Davg2 = aec->Dvar1 = aec->Dvar2 = 0;
+        return -1;
+    }
+    return 0;
+}
+
+// 累加 sum(H_m * X_m), 可同时累加远端的功率谱
+static void filterSpectrum(KSYAudioAec* aec, const float* H, float* Y, float* Pxx) {
+    const int spec = aec->L + 2, nb = aec->nbBin, M = aec->M;
+    memset(Y, 0, sizeof(float) * spec);
+    if (Pxx) {
+        memset(Pxx, 0, sizeof(float) * nb);
+    }
+    for (int m = 0; m < M; ++m) {
+        const float * Xm = aec->X + (size_t)((aec->xHead + m) % M) * spec;
+        const float * Hm = H + (size_t)m * spec;
+        for (int k = 0; k < nb; ++k) {
+            float xr = Xm[2*k], xi = Xm[2*k+1];
+            float hr = Hm[2*k], hi = Hm[2*k+1];
+            Y[2*k]   += hr * xr - hi * xi;
+            Y[2*k+1] += hr * xi + hi * xr;
+            if (Pxx) {
+                Pxx[k] += xr * xr + xi * xi;
+            }
+        }
+    }
+}
+
+// 处理一块: farIn/micIn -> out
+static void processBlock(KSYAudioAec* aec) {
+    const int N = aec->N, L = aec->L, nb = aec->nbBin, M = aec->M;
+    const int spec = L + 2;
+    const size_t wSize = sizeof(float) * M * spec;
+    double t0 = nowUs();
+    // 远端频谱移入历史, xHead 为最新的一块
+    memmove(aec->xTime, aec->xTime + N, sizeof(float) * N);
+    memcpy(aec->xTime + N, aec->farIn, sizeof(float) * N);
+    aec->xHead = (aec->xHead + M - 1) % M;
+    float * X0 = aec->X + (size_t)aec->xHead * spec;
+    ksy_fft_forward(aec->fft, aec->xTime, X0);
+    float Sxx = blockPower(aec->farIn, N);
+    BOOL bFarActive = Sxx > AEC_FAR_THRESH * N;
+
+    // 前台/后台的回声估计 y = IFFT(sum H_m X_m) 的后半段 (overlap-save)
+    float * tb = aec->tmp, * tf = aec->tmpF;
+    filterSpectrum(aec, aec->W, aec->Y, aec->Pxx);
+    ksy_fft_inverse(aec->fft, aec->Y, tb);
+    filterSpectrum(aec, aec->F, aec->E, NULL);
+    ksy_fft_inverse(aec->fft, aec->E, tf);
+    const float * yb = tb + N, * yf = tf + N;
+    float Sdd = 0, Sff = 0, See = 0, Dbf = AEC_FAR_THRESH * N;
+    for (int i = 0; i < N; ++i) {
+        float d  = aec->micIn[i];
+        float ef = d - yf[i];
+        float eb = d - yb[i];
+        aec->out[i] = ef;
+        aec->eb[i]  = eb;
+        Sdd += d * d;
+        Sff += ef * ef;
+        See += eb * eb;
+        Dbf += (yb[i] - yf[i]) * (yb[i] - yf[i]);
+    }
+    int cmp = bFarActive ? compareFilters(aec, Sff, See, Dbf) : 0;
+    if (cmp > 0) {
+        // 后台更好: 拷贝到前台, 本块内从旧的输出线性过渡到新的输出
+        memcpy(aec->F, aec->W, wSize);
+        for (int i = 0; i < N; ++i) {
+            float w = (float)(i + 1) / N;
+            aec->out[i] += w * (aec->eb[i] - aec->out[i]);
+        }
+        Sff = See;
+        aec->stat.bAdapted = YES;
+        aec->stat.nbUpdate++;
+    }
+    else if (cmp < 0) {
+        // 后台已被带偏: 从前台重新开始
+        memcpy(aec->W, aec->F, wSize);
+        memcpy(aec->eb, aec->out, sizeof(float) * N);
+        See = Sff;
+    }
+    // 前台的误差持续大于输入 (约0.6秒): 回声路径突变或已发散, 输出原始数据并重新收敛
+    aec->divCnt = Sff > Sdd + AEC_FAR_THRESH * N ? aec->divCnt + 1 : 0;
+    if (aec->divCnt >= AEC_DIV_BLOCKS) {
+        memcpy(aec->out, aec->micIn, sizeof(float) * N);
+        resetFilter(aec);
+        aec->stat.nbReset++;
+        goto done;
+    }
+    if (bFarActive) {
+        // 后台误差的频谱 (前半段补零)
+        float * E = aec->E;
+        memset(tb, 0, sizeof(float) * N);
+        memcpy(tb + N, aec->eb, sizeof(float) * N);
+        ksy_fft_forward(aec->fft, tb, E);
+        // 逐频点的步长 (已除以滤波器长度内的远端功率); 正则项取平均功率的一定比例,
+        // 避免谐波之间功率很小的频点步长过大. 误差远大于远端时 (近端在说话) 减小步长
+        float * mu = aec->tmp;
+        float reg = 0;
+        for (int k = 0; k < nb; ++k) {
+            reg += aec->Pxx[k];
+        }
+        reg = AEC_REG * reg / nb + AEC_FAR_THRESH * L * N;
+        float step = AEC_MU * (See > Sxx ? Sxx / See : 1.0f);
+        for (int k = 0; k < nb; ++k) {
+            mu[k] = step / (aec->Pxx[k] + reg);
+        }
+        // G_m = mu * conj(X_m) * E, 变换回时域后只保留前N个 (因果的部分) 再更新;
+        // 不做约束时循环卷积的误差会累积, 收敛到15dB左右就停滞
+        float * G = aec->Y;
+        for (int m = 0; m < M; ++m) {
+            const float * Xm = aec->X + (size_t)((aec->xHead + m) % M) * spec;
+            float * Wm = aec->W + (size_t)m * spec;
+            for (int k = 0; k < nb; ++k) {
+                float xr = Xm[2*k], xi = Xm[2*k+1];
+                float er = E[2*k], ei = E[2*k+1];
+                G[2*k]   = mu[k] * (xr * er + xi * ei);
+                G[2*k+1] = mu[k] * (xr * ei - xi * er);
+            }
+            ksy_fft_inverse(aec->fft, G, G);
+            memset(G + N, 0, sizeof(float) * (N + 2));
+            ksy_fft_forward(aec->fft, G, G);
+            for (int k = 0; k < 2 * nb; ++k) {
+                Wm[k] += G[k];
+            }
+        }
+        aec->Sdd += 0.05f * (Sdd - aec->Sdd);
+        aec->Sff += 0.05f * (Sff - aec->Sff);
+        aec->stat.erleDb = 10.0f * log10f((aec->Sdd + AEC_EPS) / (aec->Sff + AEC_EPS));
+    }
+done:
+    aec->stat.bFarActive = bFarActive;
+    float us = (float)(nowUs() - t0);
+    aec->stat.avgUs = aec->stat.nbBlock ? aec->stat.avgUs + 0.05f * (us - aec->stat.avgUs) : us;
+    aec->stat.nbBlock++;
+}
+
+void ksy_aec_process_f32(KSYAudioAec* aec, const float* far, float* mic, int nbFrame) {
+    if (aec == NULL || mic == NULL) {
+        return;
+    }
+    const int N = aec->N;
+    while (nbFrame > 0) {
+        int n = N - aec->fill;
+        n = nbFrame < n ? nbFrame : n;
+        if (far) {
+            memcpy(aec->farIn + aec->fill, far, sizeof(float) * n);
+            far += n;
+        }
+        else {
+            memset(aec->farIn + aec->fill, 0, sizeof(float) * n);
+        }
+        for (int i = 0; i < n; ++i) {
+            aec->micIn[aec->fill + i] = mic[i];
+            mic[i] = aec->out[aec->fill + i];
+        }
+        aec->fill += n;
+        mic       += n;
+        nbFrame   -= n;
+        if (aec->fill == N) {
+            processBlock(aec);
+            aec->fill = 0;
+        }
+    }
+}
+
+void ksy_aec_process_s16(KSYAudioAec* aec, const int16_t* far, int16_t* mic, int nbFrame) {
+    if (aec == NULL || mic == NULL) {
+        return;
+    }
+    while (nbFrame > 0) {
+        int n = nbFrame < AEC_IO ? nbFrame : AEC_IO;
+        if (far) {
+            ksy_s16_to_f32(aec->farIo, far, n);
+            far += n;
+        }
+        ksy_s16_to_f32(aec->micIo, mic, n);
+        ksy_aec_process_f32(aec, far ? aec->farIo : NULL, aec->micIo, n);
+        ksy_f32_to_s16(mic, aec->micIo, n);
+        mic     += n;
+        nbFrame -= n;
+    }
+}
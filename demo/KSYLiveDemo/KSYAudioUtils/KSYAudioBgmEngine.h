@@ -0,0 +1,153 @@
+//
+//  KSYAudioBgmEngine.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "KSYAudioCueTimeline.h"
+
+/** 背景音乐的流式解码引擎
+
+ 1. 解码线程按需解码, 只保持 readAheadMs 的预读PCM (无锁环形缓冲), 打开大文件不需要整体解码
+ 2. 播放线程(主轨线程)调用 ksy_bgm_read 取数据, 不加锁, 不等待解码
+ 3. 定位精确到帧: 解码线程定位后, 由播放线程丢弃预读的旧数据, 再写入新位置的数据
+ 4. 循环播放: 打开时预先解码文件头的一段, 到达结尾时直接接上, 不等待定位, 没有间隙
+ 5. 播放列表: 当前曲目接近结尾时预先打开下一首并解码第一块, 曲目之间无缝衔接
+ 6. 解码源由调用者提供 (如 ExtAudioFile, 或测试用的内存数据), 引擎本身与平台无关
+ 7. 数据为 float 交织格式, 采样率和声道数在创建时确定, 解码源负责转换
+ 8. 变速/变调 (KSYAudioTimeStretch) 在播放线程处理, 参数立即生效, 不受预读长度影响
+ 9. 时间轴事件 (KSYCueTimeline) 在播放线程按读出数据的曲目位置触发, 精确到帧
+ */
+typedef struct _KSYBgmEngine KSYBgmEngine;
+
+/// 解码源, 除 ctx 外的回调都在解码线程调用
+typedef struct {
+    void *  ctx;
+    /// 打开并设置输出格式, *nbFrame 为总帧数 (未知时为0); 失败返回NO
+    BOOL    (*open)(void* ctx, int rate, int chCnt, int64_t* nbFrame);
+    /// 解码 nbFrame 帧, 返回解码的帧数, 0 表示结束, 负数表示出错
+    int     (*read)(void* ctx, float* buf, int nbFrame);
+    /// 定位到第 frame 帧
+    BOOL    (*seek)(void* ctx, int64_t frame);
+    /// 关闭并释放 ctx (未打开过也会调用; 未打开就被清除的源在控制线程关闭)
+    void    (*close)(void* ctx);
+} KSYBgmSource;
+
+/// 播放线程上报的事件
+typedef NS_ENUM(int, KSYBgmEvent) {
+    /// 开始播放一首曲目
+    KSYBgmEvent_TrackStart = 0,
+    /// 循环播放回到开头
+    KSYBgmEvent_Loop,
+    /// 一首曲目播放结束 (或解码出错)
+    KSYBgmEvent_TrackEnd,
+    /// 播放列表已播放完
+    KSYBgmEvent_QueueEnd,
+};
+
+/**
+ @abstract  事件回调 (播放线程, 即 ksy_bgm_read 的调用线程)
+ */
+typedef void (*KSYBgmEventFn)(void* opaque, KSYBgmEvent event, int trackId);
+
+/// 统计信息 (任意线程)
+typedef struct {
+    /// 当前曲目的id, 没有时为-1
+    int     trackId;
+    /// 当前曲目的播放位置 (帧)
+    int64_t position;
+    /// 当前曲目的总帧数 (未知时为0)
+    int64_t duration;
+    /// 预读缓冲中的帧数
+    int     fillFrames;
+    /// 预读缓冲的时长 (毫秒)
+    float   fillMs;
+    /// 解码线程的CPU占用 (解码耗时 / 解码出的音频时长, 百分比, 平滑)
+    float   cpuPercent;
+    /// 播放中预读数据不足的次数
+    int64_t underrunCnt;
+    /// 列表中等待播放的曲目数 (不含当前曲目)
+    int     queued;
+    /// 是否暂停
+    BOOL    bPaused;
+} KSYBgmStat;
+
+/**
+ @abstract  创建, 同时启动解码线程
+ @param     rate        输出采样率
+ @param     chCnt       输出声道数 (1或2)
+ @param     readAheadMs 预读的时长 (毫秒, 100~10000)
+ @return    参数错误时返回NULL
+ */
+KSYBgmEngine* ksy_bgm_create(int rate, int chCnt, int readAheadMs);
+
+/**
+ @abstract  停止解码线程并销毁, 关闭所有解码源
+ */
+void ksy_bgm_destroy(KSYBgmEngine* eng);
+
+/**
+ @abstract  设置事件回调 (开始播放之前调用)
+ */
+void ksy_bgm_set_event_callback(KSYBgmEngine* eng, KSYBgmEventFn fn, void* opaque);
+
+/**
+ @abstract  加入播放列表 (控制线程)
+ @param     src   解码源, 引擎拷贝该结构体, 之后负责调用 close
+ @param     bLoop 是否循环播放 (循环的曲目不会结束, 需要 skip 才会播放下一首)
+ @return    曲目id (从0递增); 列表已满时返回-1, 并关闭该解码源
+ */
+int ksy_bgm_enqueue(KSYBgmEngine* eng, const KSYBgmSource* src, BOOL bLoop);
+
+/**
+ @abstract  结束当前曲目, 开始播放下一首 (控制线程)
+ */
+void ksy_bgm_skip(KSYBgmEngine* eng);
+
+/**
+ @abstract  停止播放并清空播放列表 (控制线程)
+ */
+void ksy_bgm_stop(KSYBgmEngine* eng);
+
+/**
+ @abstract  定位当前曲目 (控制线程), 精确到帧
+ @param     frame 目标位置 (帧)
+ @discussion 丢弃预读数据需要播放线程配合, 在下一次 ksy_bgm_read 时生效
+ */
+void ksy_bgm_seek(KSYBgmEngine* eng, int64_t frame);
+
+/**
+ @abstract  暂停/继续 (任意线程); 暂停期间 ksy_bgm_read 不输出, 预读保持
+ */
+void ksy_bgm_set_pause(KSYBgmEngine* eng, BOOL bPause);
+
+/**
+ @abstract  设置时间轴事件 (可以为NULL), 播放线程读取数据时触发
+ @discussion tl 由调用者创建和销毁, 须在 ksy_bgm_destroy 或重新设置之后销毁;
+             变速时按读入变速处理的位置触发, 比实际输出提前一段 (最多约60ms)
+ */
+void ksy_bgm_set_cues(KSYBgmEngine* eng, KSYCueTimeline* tl);
+
+/**
+ @abstract  设置播放速度 (任意线程, 0.5~2.0, 1.0为原速), 音高不变
+ */
+void ksy_bgm_set_tempo(KSYBgmEngine* eng, float tempo);
+
+/**
+ @abstract  设置音高 (任意线程, 半音, -12~12, 0为原调), 速度不变
+ */
+void ksy_bgm_set_pitch(KSYBgmEngine* eng, float semitone);
+
+/**
+ @abstract  取出数据 (播放线程)
+ @return    输出的帧数; 暂停/没有曲目时为0, 预读不足时小于 nbFrame
+ */
+int ksy_bgm_read(KSYBgmEngine* eng, float* out, int nbFrame);
+
+/**
+ @abstract  读取统计信息 (任意线程)
+ */
+void ksy_bgm_get_stat(const KSYBgmEngine* eng, KSYBgmStat* stat);
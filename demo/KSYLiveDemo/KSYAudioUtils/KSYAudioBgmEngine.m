@@ -0,0 +1,787 @@
+//
+//  KSYAudioBgmEngine.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioBgmEngine.h"
+#import "KSYAudioRing.h"
+#import "KSYAudioTimeStretch.h"
+#import "KSYAudioCueTimeline.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BGM_CHUNK       2048    // 每次解码的帧数
+#define BGM_HEAD_MS     250     // 预解码的文件头时长
+#define BGM_MAX_QUEUE   32
+#define BGM_MAX_MARKER  64
+#define BGM_IDLE_MS     10      // 预读已满时的等待间隔
+#define BGM_FLUSH_MS    2       // 等待播放线程丢弃数据的间隔
+#define BGM_CPU_SMOOTH  0.2f
+
+typedef enum {
+    BgmMark_Start = 0,  // 开始播放 track, 位置为 pos
+    BgmMark_Pos,        // 定位后的新位置 (track 不同时等同于 Start)
+    BgmMark_Loop,       // 回到开头
+    BgmMark_End,        // track 结束
+    BgmMark_QueueEnd,   // 列表播放完
+} BgmMarkType;
+
+// 解码线程 -> 播放线程: 数据流中第 at 帧处发生的事件
+typedef struct {
+    int64_t     at;
+    int         type;
+    int         track;
+    int64_t     pos;
+    int64_t     dur;
+} BgmMarker;
+
+typedef struct {
+    int             id;         // <0 表示空
+    KSYBgmSource    src;
+    BOOL            bLoop;
+    BOOL            bOpened;    // 已调用过 open
+    BOOL            bReady;     // 已打开并解码了文件头
+    int64_t         dur;
+    float *         head;       // 预解码的文件头
+    int             headFrames;
+    BOOL            bWhole;     // 整个文件都在 head 中
+    int             headOff;    // 下次从 head 的该位置输出, 等于 headFrames 时从解码源读取
+    int64_t         srcPos;     // 解码源的当前位置
+} BgmTrack;
+
+struct _KSYBgmEngine {
+    int                 rate;
+    int                 chCnt;
+    int                 aheadFrames;
+    int                 headCap;
+    KSYAudioRing *      data;
+    KSYAudioRing *      marks;
+    KSYAudioTimeStretch * stretch;  // 变速/变调, 在播放线程处理
+    KSYBgmEventFn       fn;
+    void *              opaque;
+    pthread_t           thread;
+    pthread_mutex_t     lock;
+    pthread_cond_t      cond;
+    // lock 保护
+    BOOL                bQuit;
+    BgmTrack            queue[BGM_MAX_QUEUE];
+    int                 qHead;
+    int                 qCnt;
+    int                 nextId;
+    BOOL                bSkip;
+    BOOL                bStop;
+    BOOL                bSeek;
+    int64_t             seekFrame;
+    int                 nbPreopen;
+    int                 pendSeq;    // 解码线程取走的命令序号
+    // 解码线程使用
+    BgmTrack            cur;
+    BgmTrack            nxt;
+    BgmTrack            done;       // 已解码完但可能还在播放的曲目, 定位时恢复为当前曲目
+    float *             buf;
+    int64_t             wPos;       // 累计写入的帧数
+    BOOL                bActive;    // 上次列表结束(或停止)后播放过曲目
+    BOOL                bFlushing;
+    BOOL                pendSkip;
+    BOOL                pendStop;
+    BOOL                pendSeek;
+    int64_t             pendFrame;
+    double              cpuSec;
+    int64_t             cpuFrames;
+    // 控制线程/解码线程 <-> 播放线程
+    atomic_int          cmdSeq;     // 停止/切歌/定位的序号, 与 flushSeen 不同时播放线程不再输出旧数据
+    atomic_int          flushReq;
+    atomic_int          flushAck;
+    _Atomic int64_t     wPosOut;
+    // 播放线程使用
+    BgmMarker           mark;
+    BOOL                bMark;
+    int64_t             rPos;       // 累计读出的帧数
+    int                 flushSeen;
+    BOOL                bRefill;    // 丢弃数据后尚未读满过一次, 不计入欠载
+    int                 curTrack;
+    int64_t             curPos;
+    BOOL                bStretchEnd; // 列表已播放完, 清空变速的缓存
+    int                 readOff;    // 本次 ksy_bgm_read 中已读出的帧数, 即事件点在输出块中的基准
+    atomic_int          endedId;    // 最近一次结束的曲目
+    // 统计
+    atomic_int          trackId;
+    _Atomic int64_t     position;
+    _Atomic int64_t     duration;
+    _Atomic int64_t     underrunCnt;
+    _Atomic float       cpuPercent;
+    atomic_int          queued;
+    atomic_bool         bPause;
+    _Atomic(KSYCueTimeline *) cues;
+};
+
+static double threadCpuSec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#pragma mark - decode thread
+static void closeTrack(BgmTrack* t) {
+    if (t->id >= 0 && t->src.close) {
+        t->src.close(t->src.ctx);
+    }
+    free(t->head);
+    memset(t, 0, sizeof(BgmTrack));
+    t->id = -1;
+}
+
+// 从解码源读取, 同时统计解码耗时
+static int decodeSrc(KSYBgmEngine* eng, BgmTrack* t, float* buf, int nbFrame) {
+    double t0 = threadCpuSec();
+    int n = t->src.read(t->src.ctx, buf, nbFrame);
+    if (n <= 0) {
+        return n;
+    }
+    t->srcPos      += n;
+    eng->cpuSec    += threadCpuSec() - t0;
+    eng->cpuFrames += n;
+    if (eng->cpuFrames >= eng->rate / 2) {
+        float pct = (float)(eng->cpuSec * eng->rate / eng->cpuFrames * 100);
+        float old = atomic_load_explicit(&eng->cpuPercent, memory_order_relaxed);
+        atomic_store_explicit(&eng->cpuPercent, old + BGM_CPU_SMOOTH * (pct - old),
+                              memory_order_relaxed);
+        eng->cpuSec    = 0;
+        eng->cpuFrames = 0;
+    }
+    return n;
+}
+
+// 打开并预解码文件头, 失败时 bReady 为NO
+static void openTrack(KSYBgmEngine* eng, BgmTrack* t) {
+    int64_t dur = 0;
+    if (t->bOpened) {
+        return;
+    }
+    t->bOpened = YES;
+    if (t->src.open == NULL || t->src.read == NULL ||
+        !t->src.open(t->src.ctx, eng->rate, eng->chCnt, &dur)) {
+        return;
+    }
+    t->dur  = dur > 0 ? dur : 0;
+    t->head = malloc(sizeof(float) * eng->headCap * eng->chCnt);
+    if (t->head == NULL) {
+        return;
+    }
+    while (t->headFrames < eng->headCap) {
+        int n = eng->headCap - t->headFrames;
+        n = decodeSrc(eng, t, t->head + (size_t)t->headFrames * eng->chCnt,
+                      n < BGM_CHUNK ? n : BGM_CHUNK);
+        if (n < 0) {
+            return;
+        }
+        if (n == 0) {
+            t->bWhole = YES;
+            break;
+        }
+        t->headFrames += n;
+    }
+    t->bReady = t->headFrames > 0;
+}
+
+// 定位: 文件头之内从 head 输出, 解码源停在文件头之后
+static BOOL seekTrack(BgmTrack* t, int64_t frame) {
+    int64_t target = frame;
+    if (frame < t->headFrames) {
+        t->headOff = (int)frame;
+        target     = t->headFrames;
+    }
+    else {
+        t->headOff = t->headFrames;
+    }
+    if (t->bWhole || t->srcPos == target) {
+        return YES;
+    }
+    if (t->src.seek == NULL || !t->src.seek(t->src.ctx, target)) {
+        return NO;
+    }
+    t->srcPos = target;
+    return YES;
+}
+
+static BOOL canPushMarker(KSYBgmEngine* eng) {
+    return ksy_ring_fill(eng->marks) < BGM_MAX_MARKER - 2;
+}
+
+static void pushMarker(KSYBgmEngine* eng, BgmMarkType type, int track, int64_t pos, int64_t dur) {
+    BgmMarker m = { eng->wPos, type, track, pos, dur };
+    ksy_ring_write(eng->marks, &m, 1);
+}
+
+// 把预先打开的下一首放回列表的最前面
+static void requeueNext(KSYBgmEngine* eng) {
+    BOOL bOk = NO;
+    pthread_mutex_lock(&eng->lock);
+    if (eng->qCnt < BGM_MAX_QUEUE) {
+        eng->qHead = (eng->qHead + BGM_MAX_QUEUE - 1) % BGM_MAX_QUEUE;
+        eng->queue[eng->qHead] = eng->nxt;
+        eng->qCnt += 1;
+        bOk = YES;
+    }
+    pthread_mutex_unlock(&eng->lock);
+    if (bOk) {
+        memset(&eng->nxt, 0, sizeof(BgmTrack));
+        eng->nxt.id = -1;
+    }
+    else {
+        closeTrack(&eng->nxt);
+    }
+}
+
+static void writeData(KSYBgmEngine* eng, const float* pcm, int nbFrame) {
+    ksy_ring_write(eng->data, pcm, nbFrame);
+    eng->wPos += nbFrame;
+    atomic_store_explicit(&eng->wPosOut, eng->wPos, memory_order_release);
+}
+
+// 预读数据已丢弃, 执行停止/切歌/定位 (此时两个缓冲都是空的)
+static void applyCmds(KSYBgmEngine* eng) {
+    int playing = atomic_load_explicit(&eng->trackId, memory_order_relaxed);
+    if (eng->pendStop) {
+        if (playing >= 0) {
+            pushMarker(eng, BgmMark_End, playing, 0, 0);
+        }
+        closeTrack(&eng->cur);
+        closeTrack(&eng->nxt);
+        closeTrack(&eng->done);
+        eng->bActive  = NO;
+        eng->pendStop = NO;
+        eng->pendSkip = NO;
+        eng->pendSeek = NO;
+        return;
+    }
+    BgmTrack * t = &eng->cur;
+    if (eng->pendSeek && playing >= 0 && playing == eng->done.id) {
+        // 正在播放的曲目已解码完, 解码线程已进入下一首: 下一首退回列表, 恢复正在播放的曲目
+        if (t->id >= 0) {
+            if (eng->nxt.id >= 0) {
+                requeueNext(eng);
+            }
+            eng->nxt = *t;
+            if (!seekTrack(&eng->nxt, 0)) {
+                closeTrack(&eng->nxt);
+            }
+        }
+        *t = eng->done;
+        memset(&eng->done, 0, sizeof(BgmTrack));
+        eng->done.id = -1;
+    }
+    if (playing >= 0) {
+        // 丢弃的标记中可能有 End/QueueEnd, 需要重新发出
+        eng->bActive = YES;
+        if (t->id < 0 && (eng->pendSkip || eng->pendSeek)) {
+            pushMarker(eng, BgmMark_End, playing, 0, 0);
+        }
+    }
+    if (eng->pendSkip && t->id >= 0) {
+        if (playing < 0 || playing == t->id) {
+            pushMarker(eng, BgmMark_End, t->id, 0, 0);
+            closeTrack(t);
+        }
+        else if (seekTrack(t, 0)) { // 解码已经进入下一首, 切歌即从头播放它
+            pushMarker(eng, BgmMark_Start, t->id, 0, t->dur);
+        }
+        else {
+            pushMarker(eng, BgmMark_End, t->id, 0, 0);
+            closeTrack(t);
+        }
+    }
+    if (eng->pendSeek && t->id >= 0) {
+        int64_t frame = eng->pendFrame < 0 ? 0 : eng->pendFrame;
+        if (t->dur > 0 && frame > t->dur) {
+            frame = t->dur;
+        }
+        if (seekTrack(t, frame)) {
+            pushMarker(eng, BgmMark_Pos, t->id, frame, t->dur);
+        }
+        else {
+            pushMarker(eng, BgmMark_End, t->id, 0, 0);
+            closeTrack(t);
+        }
+    }
+    eng->pendSkip = NO;
+    eng->pendSeek = NO;
+}
+
+// 解码一步, 返回NO表示暂时无事可做
+static BOOL decodeStep(KSYBgmEngine* eng) {
+    if (eng->bFlushing) {
+        if (atomic_load_explicit(&eng->flushAck, memory_order_acquire) != eng->pendSeq) {
+            return NO;
+        }
+        eng->bFlushing = NO;
+        applyCmds(eng);
+        return YES;
+    }
+    if (eng->pendStop || eng->pendSkip || eng->pendSeek) {
+        // 请播放线程丢弃预读数据, 之前不再写入
+        eng->bFlushing = YES;
+        atomic_store_explicit(&eng->flushReq, eng->pendSeq, memory_order_release);
+        return NO;
+    }
+    if (eng->done.id >= 0 &&
+        atomic_load_explicit(&eng->endedId, memory_order_relaxed) >= eng->done.id) {
+        closeTrack(&eng->done);
+    }
+    BgmTrack * t = &eng->cur;
+    if (t->id < 0) {
+        if (eng->nxt.id < 0) {
+            if (eng->bActive && canPushMarker(eng)) {
+                pushMarker(eng, BgmMark_QueueEnd, -1, 0, 0);
+                eng->bActive = NO;
+            }
+            return NO;
+        }
+        if (!canPushMarker(eng)) {
+            return NO;
+        }
+        *t = eng->nxt;
+        memset(&eng->nxt, 0, sizeof(BgmTrack));
+        eng->nxt.id  = -1;
+        eng->bActive = YES;
+        if (t->bReady) {
+            pushMarker(eng, BgmMark_Start, t->id, 0, t->dur);
+        }
+        else { // 打开失败
+            pushMarker(eng, BgmMark_End, t->id, 0, 0);
+            closeTrack(t);
+        }
+        return YES;
+    }
+    int space = eng->aheadFrames - ksy_ring_fill(eng->data);
+    if (space < BGM_CHUNK) {
+        return NO;
+    }
+    int ch = eng->chCnt;
+    if (t->headOff < t->headFrames) {
+        int n = t->headFrames - t->headOff;
+        n = n < BGM_CHUNK ? n : BGM_CHUNK;
+        writeData(eng, t->head + (size_t)t->headOff * ch, n);
+        t->headOff += n;
+        return YES;
+    }
+    int n = decodeSrc(eng, t, eng->buf, BGM_CHUNK);
+    if (n > 0) {
+        writeData(eng, eng->buf, n);
+        return YES;
+    }
+    if (!canPushMarker(eng)) {
+        return NO;
+    }
+    // 结尾: 循环时直接接上预解码的文件头, 解码源跳过文件头
+    if (n == 0 && t->bLoop && seekTrack(t, 0)) {
+        pushMarker(eng, BgmMark_Loop, t->id, 0, t->dur);
+        return YES;
+    }
+    pushMarker(eng, BgmMark_End, t->id, 0, 0);
+    if (n < 0) {
+        closeTrack(t);
+        return YES;
+    }
+    // 保留到播放完, 期间可以定位回来
+    closeTrack(&eng->done);
+    eng->done = *t;
+    memset(t, 0, sizeof(BgmTrack));
+    t->id = -1;
+    return YES;
+}
+
+static void* bgmThread(void* arg) {
+    KSYBgmEngine* eng = (KSYBgmEngine*)arg;
+    BOOL bBusy = YES;
+    pthread_mutex_lock(&eng->lock);
+    while (!eng->bQuit) {
+        // 取走命令; 丢弃数据的过程中到达的命令留到下一轮, 与序号保持一致
+        BOOL bCmd = eng->bStop || eng->bSkip || eng->bSeek;
+        if (bCmd && !eng->bFlushing) {
+            eng->pendStop |= eng->bStop;
+            eng->pendSkip |= eng->bSkip;
+            if (eng->bSeek) {
+                eng->pendSeek  = YES;
+                eng->pendFrame = eng->seekFrame;
+            }
+            eng->bStop = eng->bSkip = eng->bSeek = NO;
+            eng->pendSeq = atomic_load_explicit(&eng->cmdSeq, memory_order_relaxed);
+        }
+        // 当前曲目预读已满(或没有当前曲目)时, 预先打开下一首
+        BgmTrack pop = { .id = -1 };
+        if (eng->nxt.id < 0 && eng->qCnt > 0 && !eng->pendStop &&
+            (eng->cur.id < 0 || !bBusy)) {
+            pop = eng->queue[eng->qHead];
+            eng->qHead = (eng->qHead + 1) % BGM_MAX_QUEUE;
+            eng->qCnt -= 1;
+        }
+        eng->nbPreopen = (eng->nxt.id >= 0 || pop.id >= 0) ? 1 : 0;
+        atomic_store_explicit(&eng->queued, eng->qCnt + eng->nbPreopen, memory_order_relaxed);
+        pthread_mutex_unlock(&eng->lock);
+
+        if (pop.id >= 0) {
+            openTrack(eng, &pop);
+            eng->nxt = pop;
+        }
+        bBusy = decodeStep(eng);
+
+        pthread_mutex_lock(&eng->lock);
+        bCmd = eng->bStop || eng->bSkip || eng->bSeek;
+        if (!bBusy && !eng->bQuit && (eng->bFlushing ||
+            (!bCmd && !(eng->nxt.id < 0 && eng->qCnt > 0 && !eng->pendStop)))) {
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            long ns = (eng->bFlushing ? BGM_FLUSH_MS : BGM_IDLE_MS) * 1000000L;
+            ts.tv_nsec += ns;
+            if (ts.tv_nsec >= 1000000000L) {
+                ts.tv_sec  += 1;
+                ts.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&eng->cond, &eng->lock, &ts);
+        }
+    }
+    pthread_mutex_unlock(&eng->lock);
+    return NULL;
+}
+
+#pragma mark - control
+KSYBgmEngine* ksy_bgm_create(int rate, int chCnt, int readAheadMs) {
+    if (rate < 8000 || rate > 192000 || chCnt < 1 || chCnt > 2 ||
+        readAheadMs < 100 || readAheadMs > 10000) {
+        return NULL;
+    }
+    KSYBgmEngine* eng = calloc(1, sizeof(KSYBgmEngine));
+    if (eng == NULL) {
+        return NULL;
+    }
+    eng->rate        = rate;
+    eng->chCnt       = chCnt;
+    eng->aheadFrames = (int)((int64_t)rate * readAheadMs / 1000);
+    eng->headCap     = rate * BGM_HEAD_MS / 1000;
+    eng->data        = ksy_ring_create(eng->aheadFrames + BGM_CHUNK, sizeof(float) * chCnt);
+    eng->marks       = ksy_ring_create(BGM_MAX_MARKER, sizeof(BgmMarker));
+    eng->buf         = malloc(sizeof(float) * BGM_CHUNK * chCnt);
+    eng->stretch     = ksy_stretch_create(rate, chCnt);
+    eng->cur.id      = -1;
+    eng->nxt.id      = -1;
+    eng->done.id     = -1;
+    eng->curTrack    = -1;
+    atomic_init(&eng->cmdSeq, 0);
+    atomic_init(&eng->flushReq, 0);
+    atomic_init(&eng->flushAck, 0);
+    atomic_init(&eng->wPosOut, 0);
+    atomic_init(&eng->endedId, -1);
+    atomic_init(&eng->trackId, -1);
+    atomic_init(&eng->position, 0);
+    atomic_init(&eng->duration, 0);
+    atomic_init(&eng->underrunCnt, 0);
+    atomic_init(&eng->cpuPercent, 0);
+    atomic_init(&eng->queued, 0);
+    atomic_init(&eng->bPause, NO);
+    atomic_init(&eng->cues, NULL);
+    if (eng->data == NULL || eng->marks == NULL || eng->buf == NULL || eng->stretch == NULL) {
+        ksy_ring_destroy(eng->data);
+        ksy_ring_destroy(eng->marks);
+        ksy_stretch_destroy(eng->stretch);
+        free(eng->buf);
+        free(eng);
+        return NULL;
+    }
+    pthread_mutex_init(&eng->lock, NULL);
+    pthread_cond_init(&eng->cond, NULL);
+    if (pthread_create(&eng->thread, NULL, bgmThread, eng) != 0) {
+        pthread_cond_destroy(&eng->cond);
+        pthread_mutex_destroy(&eng->lock);
+        ksy_ring_destroy(eng->data);
+        ksy_ring_destroy(eng->marks);
+        ksy_stretch_destroy(eng->stretch);
+        free(eng->buf);
+        free(eng);
+        return NULL;
+    }
+    return eng;
+}
+
+void ksy_bgm_destroy(KSYBgmEngine* eng) {
+    if (eng == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&eng->lock);
+    eng->bQuit = YES;
+    pthread_cond_signal(&eng->cond);
+    pthread_mutex_unlock(&eng->lock);
+    pthread_join(eng->thread, NULL);
+    closeTrack(&eng->cur);
+    closeTrack(&eng->nxt);
+    closeTrack(&eng->done);
+    for (int i = 0; i < eng->qCnt; ++i) {
+        closeTrack(&eng->queue[(eng->qHead + i) % BGM_MAX_QUEUE]);
+    }
+    pthread_cond_destroy(&eng->cond);
+    pthread_mutex_destroy(&eng->lock);
+    ksy_ring_destroy(eng->data);
+    ksy_ring_destroy(eng->marks);
+    ksy_stretch_destroy(eng->stretch);
+    free(eng->buf);
+    free(eng);
+}
+
+void ksy_bgm_set_event_callback(KSYBgmEngine* eng, KSYBgmEventFn fn, void* opaque) {
+    if (eng) {
+        eng->fn     = fn;
+        eng->opaque = opaque;
+    }
+}
+
+int ksy_bgm_enqueue(KSYBgmEngine* eng, const KSYBgmSource* src, BOOL bLoop) {
+    if (eng == NULL || src == NULL) {
+        return -1;
+    }
+    pthread_mutex_lock(&eng->lock);
+    if (eng->qCnt >= BGM_MAX_QUEUE) {
+        pthread_mutex_unlock(&eng->lock);
+        if (src->close) {
+            src->close(src->ctx);
+        }
+        return -1;
+    }
+    BgmTrack * t = &eng->queue[(eng->qHead + eng->qCnt) % BGM_MAX_QUEUE];
+    memset(t, 0, sizeof(BgmTrack));
+    t->id    = eng->nextId++;
+    t->src   = *src;
+    t->bLoop = bLoop;
+    eng->qCnt += 1;
+    atomic_store_explicit(&eng->queued, eng->qCnt + eng->nbPreopen, memory_order_relaxed);
+    int trackId = t->id;
+    pthread_cond_signal(&eng->cond);
+    pthread_mutex_unlock(&eng->lock);
+    return trackId;
+}
+
+void ksy_bgm_skip(KSYBgmEngine* eng) {
+    if (eng == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&eng->lock);
+    eng->bSkip = YES;
+    atomic_fetch_add_explicit(&eng->cmdSeq, 1, memory_order_relaxed);
+    eng->bSeek = NO;
+    pthread_cond_signal(&eng->cond);
+    pthread_mutex_unlock(&eng->lock);
+}
+
+void ksy_bgm_stop(KSYBgmEngine* eng) {
+    if (eng == NULL) {
+        return;
+    }
+    BgmTrack dropped[BGM_MAX_QUEUE];
+    pthread_mutex_lock(&eng->lock);
+    int nbDrop = eng->qCnt;
+    for (int i = 0; i < nbDrop; ++i) {
+        dropped[i] = eng->queue[(eng->qHead + i) % BGM_MAX_QUEUE];
+    }
+    eng->qCnt  = 0;
+    eng->bStop = YES;
+    atomic_fetch_add_explicit(&eng->cmdSeq, 1, memory_order_relaxed);
+    atomic_store_explicit(&eng->queued, eng->nbPreopen, memory_order_relaxed);
+    pthread_cond_signal(&eng->cond);
+    pthread_mutex_unlock(&eng->lock);
+    for (int i = 0; i < nbDrop; ++i) {
+        closeTrack(&dropped[i]);
+    }
+}
+
+void ksy_bgm_seek(KSYBgmEngine* eng, int64_t frame) {
+    if (eng == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&eng->lock);
+    eng->bSeek     = YES;
+    atomic_fetch_add_explicit(&eng->cmdSeq, 1, memory_order_relaxed);
+    eng->seekFrame = frame;
+    pthread_cond_signal(&eng->cond);
+    pthread_mutex_unlock(&eng->lock);
+}
+
+void ksy_bgm_set_pause(KSYBgmEngine* eng, BOOL bPause) {
+    if (eng) {
+        atomic_store_explicit(&eng->bPause, bPause, memory_order_relaxed);
+    }
+}
+
+void ksy_bgm_set_cues(KSYBgmEngine* eng, KSYCueTimeline* tl) {
+    if (eng) {
+        atomic_store_explicit(&eng->cues, tl, memory_order_release);
+    }
+}
+
+void ksy_bgm_set_tempo(KSYBgmEngine* eng, float tempo) {
+    if (eng) {
+        ksy_stretch_set_tempo(eng->stretch, tempo);
+    }
+}
+
+void ksy_bgm_set_pitch(KSYBgmEngine* eng, float semitone) {
+    if (eng) {
+        ksy_stretch_set_pitch(eng->stretch, semitone);
+    }
+}
+
+#pragma mark - render thread
+static void fireEvent(KSYBgmEngine* eng, KSYBgmEvent event, int track) {
+    if (eng->fn) {
+        eng->fn(eng->opaque, event, track);
+    }
+}
+
+static void applyMarker(KSYBgmEngine* eng, const BgmMarker* m) {
+    switch (m->type) {
+        case BgmMark_Start:
+        case BgmMark_Pos:
+            if (eng->curTrack != m->track) {
+                if (eng->curTrack >= 0) {
+                    atomic_store_explicit(&eng->endedId, eng->curTrack, memory_order_relaxed);
+                    fireEvent(eng, KSYBgmEvent_TrackEnd, eng->curTrack);
+                }
+                eng->curTrack = m->track;
+                atomic_store_explicit(&eng->trackId, m->track, memory_order_relaxed);
+                fireEvent(eng, KSYBgmEvent_TrackStart, m->track);
+            }
+            eng->curPos = m->pos;
+            atomic_store_explicit(&eng->duration, m->dur, memory_order_relaxed);
+            break;
+        case BgmMark_Loop:
+            eng->curPos = 0;
+            fireEvent(eng, KSYBgmEvent_Loop, m->track);
+            break;
+        case BgmMark_End:
+            if (eng->curTrack == m->track) {
+                eng->curTrack = -1;
+                eng->curPos   = 0;
+                atomic_store_explicit(&eng->trackId, -1, memory_order_relaxed);
+                atomic_store_explicit(&eng->duration, 0, memory_order_relaxed);
+            }
+            if (m->track > atomic_load_explicit(&eng->endedId, memory_order_relaxed)) {
+                atomic_store_explicit(&eng->endedId, m->track, memory_order_relaxed);
+            }
+            fireEvent(eng, KSYBgmEvent_TrackEnd, m->track);
+            break;
+        default:
+            eng->curTrack    = -1;
+            eng->bStretchEnd = YES;
+            atomic_store_explicit(&eng->trackId, -1, memory_order_relaxed);
+            fireEvent(eng, KSYBgmEvent_QueueEnd, -1);
+            break;
+    }
+}
+
+// 处理已到达的标记, 返回后 bMark 为YES时 mark 在当前读位置之后
+static void applyMarkers(KSYBgmEngine* eng) {
+    while (1) {
+        if (!eng->bMark) {
+            if (ksy_ring_fill(eng->marks) <= 0) {
+                return;
+            }
+            eng->bMark = ksy_ring_read(eng->marks, &eng->mark, 1) == 1;
+        }
+        if (!eng->bMark || eng->mark.at > eng->rPos) {
+            return;
+        }
+        eng->bMark = NO;
+        applyMarker(eng, &eng->mark);
+    }
+}
+
+// 从预读缓冲取数据, 处理标记和欠载统计 (变速的读取回调, 播放线程)
+static int readData(void* ctx, float* out, int nbFrame) {
+    KSYBgmEngine * eng = ctx;
+    int ch  = eng->chCnt;
+    int got = 0;
+    while (1) {
+        // 先取数据长度: 这些数据之前的标记一定已经写入
+        int avail = ksy_ring_fill(eng->data);
+        applyMarkers(eng);
+        int n = nbFrame - got;
+        n = n < avail ? n : avail;
+        if (eng->bMark && eng->mark.at - eng->rPos < n) {
+            n = (int)(eng->mark.at - eng->rPos);
+        }
+        if (n <= 0) {
+            break;
+        }
+        ksy_ring_read(eng->data, out + (size_t)got * ch, n);
+        got       += n;
+        eng->rPos += n;
+        if (eng->curTrack >= 0) {
+            ksy_cue_advance(atomic_load_explicit(&eng->cues, memory_order_acquire),
+                            eng->curTrack, eng->curPos, n, eng->readOff + got - n);
+            eng->curPos += n;
+        }
+    }
+    if (got == nbFrame) {
+        eng->bRefill = NO;
+    }
+    else if (eng->curTrack >= 0 && !eng->bRefill) {
+        atomic_fetch_add_explicit(&eng->underrunCnt, 1, memory_order_relaxed);
+    }
+    atomic_store_explicit(&eng->position, eng->curPos, memory_order_relaxed);
+    eng->readOff += got;
+    return got;
+}
+
+int ksy_bgm_read(KSYBgmEngine* eng, float* out, int nbFrame) {
+    if (eng == NULL || out == NULL || nbFrame <= 0) {
+        return 0;
+    }
+    int req = atomic_load_explicit(&eng->flushReq, memory_order_acquire);
+    if (req != eng->flushSeen) { // 解码线程已停止写入, 丢弃全部预读
+        ksy_ring_flush(eng->data);
+        ksy_ring_flush(eng->marks);
+        eng->bMark     = NO;
+        eng->rPos      = atomic_load_explicit(&eng->wPosOut, memory_order_acquire);
+        eng->flushSeen = req;
+        eng->bRefill   = YES;
+        ksy_stretch_reset(eng->stretch);
+        atomic_store_explicit(&eng->flushAck, req, memory_order_release);
+    }
+    if (atomic_load_explicit(&eng->cmdSeq, memory_order_relaxed) != eng->flushSeen) {
+        return 0; // 等待解码线程响应命令, 旧的预读数据不再输出
+    }
+    if (atomic_load_explicit(&eng->bPause, memory_order_relaxed)) {
+        applyMarkers(eng); // 暂停时定位, 位置也立即更新
+        atomic_store_explicit(&eng->position, eng->curPos, memory_order_relaxed);
+        return 0;
+    }
+    eng->readOff = 0; // 变速时为读入的帧数, 事件的块内位置是近似的
+    int got = ksy_stretch_process(eng->stretch, readData, eng, out, nbFrame);
+    if (eng->bStretchEnd) { // 在处理之外清空, 最后不足一段的数据丢弃
+        eng->bStretchEnd = NO;
+        if (eng->curTrack < 0) {
+            ksy_stretch_reset(eng->stretch);
+        }
+    }
+    return got;
+}
+
+void ksy_bgm_get_stat(const KSYBgmEngine* eng, KSYBgmStat* stat) {
+    if (eng == NULL || stat == NULL) {
+        return;
+    }
+    KSYBgmEngine* e = (KSYBgmEngine*)eng;
+    stat->trackId     = atomic_load_explicit(&e->trackId, memory_order_relaxed);
+    stat->position    = atomic_load_explicit(&e->position, memory_order_relaxed);
+    stat->duration    = atomic_load_explicit(&e->duration, memory_order_relaxed);
+    stat->fillFrames  = ksy_ring_fill(e->data);
+    stat->fillMs      = stat->fillFrames * 1000.0f / e->rate;
+    stat->cpuPercent  = atomic_load_explicit(&e->cpuPercent, memory_order_relaxed);
+    stat->underrunCnt = atomic_load_explicit(&e->underrunCnt, memory_order_relaxed);
+    stat->queued      = atomic_load_explicit(&e->queued, memory_order_relaxed);
+    stat->bPaused     = atomic_load_explicit(&e->bPause, memory_order_relaxed);
+}
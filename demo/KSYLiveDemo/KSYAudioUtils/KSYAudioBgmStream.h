@@ -0,0 +1,212 @@
+//
+//  KSYAudioBgmStream.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <CoreMedia/CoreMedia.h>
+#import "KSYAudioBgmEngine.h"
+#import "KSYAudioOutputStage.h"
+#import "KSYAudioDucker.h"
+#import "KSYAudioFileCache.h"
+#if USING_DYNAMIC_FRAMEWORK
+#import <libksygpulivedylib/KSYAudioMixer.h>
+#else
+#import <libksygpulive/KSYAudioMixer.h>
+#endif
+
+/** 流式解码的背景音乐 (KSYBgmPlayer 的推流端替代)
+
+ 1. 文件由 ExtAudioFile 边解码边播放, 只保持 readAheadMs 的预读, 大文件也能立即开始, 内存不随文件增长
+ 2. seekTo: 精确到帧 (文件采样率与混音器相同时; 不同时误差在一帧以内)
+ 3. 循环播放时文件头预先解码, 结尾直接接上, 没有间隙; 播放列表预先打开下一首, 曲目间无缝衔接
+ 4. 解码在独立线程, feedMixer: 在主轨线程只做读取和格式转换, 与 KSYAudioEffectPool 相同的方式送入混音器
+ 5. 只送入混音器(推流), 本地不播放
+ 6. 控制接口在同一个线程(如主线程)调用, 统计属性可以在任意线程读取
+ 7. 设置 cache 后, 已缓存的文件直接从内存映射的PCM播放, 不再解码; 未缓存的文件播放的同时在后台存入缓存
+ 8. tempo/pitch 变速不变调、变调不变速, 在读取时处理 (预读的数据不受影响), 修改后立即生效
+ 9. 时间轴事件 (歌词/节拍): 按送入混音器的数据中的播放位置触发, 精确到帧, 不需要定时查询 position
+ */
+@interface KSYAudioBgmStream : NSObject
+
+/**
+ @abstract  初始化, 同时启动解码线程
+ @param     mixer       数据送往的混音器, 为nil时只能通过 render 离线读取
+ @param     trackId     混音器中对应的track
+ @param     readAheadMs 预读的时长 (毫秒, 100~10000)
+ */
+- (instancetype) initWithMixer:(KSYAudioMixer*)mixer
+                         track:(int)trackId
+                   readAheadMs:(int)readAheadMs;
+
+/**
+ @abstract  对应混音器中的track
+ */
+@property (nonatomic, readonly) int trackId;
+
+/**
+ @abstract  输出数据的格式 (即混音器的输出格式)
+ */
+@property (nonatomic, readonly) KSYAudioFormat outFmt;
+
+/**
+ @abstract  解码缓存 (可以为nil, 在 playFile/enqueueFile 之前设置)
+ */
+@property (nonatomic, strong) KSYAudioFileCache * cache;
+
+/**
+ @abstract  停止当前播放并清空列表, 然后播放该文件
+ @param     path  音频文件路径 (mp3/m4a/aac/wav/caf 等)
+ @param     bLoop 是否循环播放
+ @return    曲目id, 失败时返回 -1
+ */
+- (int) playFile:(NSString*)path
+            loop:(BOOL)bLoop;
+
+/**
+ @abstract  加入播放列表, 在前面的曲目结束后播放
+ @discussion 循环播放的曲目不会自动结束, 调用 skip 后才播放下一首
+ @return    曲目id, 列表已满时返回 -1
+ */
+- (int) enqueueFile:(NSString*)path
+               loop:(BOOL)bLoop;
+
+/**
+ @abstract  定位当前曲目 (秒)
+ */
+- (void) seekTo:(double)sec;
+
+/**
+ @abstract  结束当前曲目, 播放列表中的下一首
+ */
+- (void) skip;
+
+/**
+ @abstract  停止播放并清空播放列表
+ */
+- (void) stop;
+
+/**
+ @abstract  暂停/继续, 暂停期间预读保持不变
+ */
+- (void) pause;
+- (void) resume;
+@property (nonatomic, readonly) BOOL bPaused;
+
+/**
+ @abstract  播放速度 (0.5~2.0, 默认1.0), 音高不变 (任意线程)
+ */
+@property (nonatomic, assign) float tempo;
+
+/**
+ @abstract  音高 (半音, -12~12, 默认0), 速度不变 (任意线程)
+ */
+@property (nonatomic, assign) float pitch;
+
+/**
+ @abstract  事件回调 (在主线程回调), trackId 为 -1 表示列表播放完
+ */
+@property (atomic, copy) void(^onEvent)(KSYBgmEvent event, int trackId);
+
+/**
+ @abstract  设置一首曲目的时间轴事件点, 替换该曲目原有的事件点 (控制线程)
+ @param     seconds 事件点在曲目中的时间 (秒), 回调的 tag 为其下标
+ @param     trackId 曲目id (playFile/enqueueFile 的返回值)
+ @return    内存不足时返回NO
+ @discussion 事件点按 (曲目, 时间) 排序索引, 数量多时也不增加播放线程的开销;
+             定位/循环之后, 从新的位置开始触发
+ */
+- (BOOL) setCues:(NSArray<NSNumber*>*)seconds
+        forTrack:(int)trackId;
+
+/**
+ @abstract  解析LRC歌词, 每行歌词设为一个事件点 (控制线程)
+ @param     lrc     LRC格式的歌词 ([mm:ss.xx]歌词, 支持一行多个时间和 [offset:])
+ @param     trackId 曲目id
+ @return    各事件点对应的歌词 (下标即回调的 tag), 失败时返回nil
+ */
+- (NSArray<NSString*>*) setLrc:(NSString*)lrc
+                      forTrack:(int)trackId;
+
+/**
+ @abstract  清除全部曲目的事件点 (控制线程)
+ */
+- (void) clearCues;
+
+/**
+ @abstract  时间轴事件的回调 (在主线程回调), tag 为 setCues 中的下标
+ @discussion 按事件点在数据块中的位置延后派发到主线程, 与数据送入混音器的时刻一致
+ */
+@property (atomic, copy) void(^onCue)(int trackId, int tag);
+
+/**
+ @abstract  时间轴事件提前触发的时长 (毫秒, 默认0), 用于补偿混音之后推流/播放的延迟
+ */
+@property (nonatomic, assign) float cueLeadMs;
+
+/**
+ @abstract  当前曲目的id, 没有时为 -1 (任意线程, 下同)
+ */
+@property (nonatomic, readonly) int curTrack;
+
+/**
+ @abstract  当前曲目的播放位置/总时长 (秒)
+ */
+@property (nonatomic, readonly) double position;
+@property (nonatomic, readonly) double duration;
+
+/**
+ @abstract  预读缓冲的时长 (毫秒)
+ */
+@property (nonatomic, readonly) float bufferFillMs;
+
+/**
+ @abstract  解码线程的CPU占用 (解码耗时 / 解码出的音频时长, 百分比)
+ */
+@property (nonatomic, readonly) float cpuPercent;
+
+/**
+ @abstract  播放中预读数据不足的次数
+ */
+@property (nonatomic, readonly) int64_t underrunCnt;
+
+/**
+ @abstract  列表中等待播放的曲目数
+ */
+@property (nonatomic, readonly) int queued;
+
+/**
+ @abstract  以上统计的一次性读取 (帧为单位)
+ */
+@property (nonatomic, readonly) KSYBgmStat stat;
+
+/**
+ @abstract  闪避, 不为nil时按主轨的人声压低背景音乐 (可以为nil, 任意线程设置)
+ */
+@property (nonatomic, weak) KSYAudioDucker * ducker;
+
+/**
+ @abstract  电平统计, 送入混音器的数据同时按 trackId 送给它统计 (可以为nil)
+ */
+@property (nonatomic, weak) KSYAudioOutputStage * outputStage;
+
+/**
+ @abstract  读取背景音乐 (主轨线程)
+ @param     buf     输出buffer (S16, 输出格式)
+ @param     nbFrame 帧数
+ @return    读到的帧数, 不足 nbFrame 的部分未写入; 暂停/没有曲目时为0
+ */
+- (int) render:(int16_t*)buf
+       nbFrame:(int)nbFrame;
+
+/**
+ @abstract  读取背景音乐并送入混音器 (主轨线程)
+ @param     mainBuf 即将送入混音器的主轨数据, 用于计算需要的长度和时间戳
+ @return    送入混音器的帧数, 没有数据时为0 (预读不足时补零)
+ */
+- (int) feedMixer:(CMSampleBufferRef)mainBuf;
+
+@end
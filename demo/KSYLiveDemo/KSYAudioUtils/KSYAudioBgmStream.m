@@ -0,0 +1,468 @@
+//
+//  KSYAudioBgmStream.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioBgmStream.h"
+#import <AudioToolbox/AudioToolbox.h>
+#import "KSYAudioKernel.h"
+#import "KSYAudioTrackBuffer.h"
+
+#pragma mark - ExtAudioFile source
+// 解码线程使用
+typedef struct {
+    char *          path;   // 文件路径 (UTF8)
+    ExtAudioFileRef file;
+    double          ratio;  // 文件采样率 / 输出采样率
+    int             chCnt;
+    int             skip;   // 定位后需要丢弃的帧数 (采样率不同时)
+} KSYBgmFile;
+
+static BOOL fileOpen(void* ctx, int rate, int chCnt, int64_t* nbFrame) {
+    KSYBgmFile * f = ctx;
+    CFURLRef url = CFURLCreateFromFileSystemRepresentation(NULL, (const UInt8*)f->path,
+                                                           strlen(f->path), false);
+    OSStatus ret = url ? ExtAudioFileOpenURL(url, &f->file) : -1;
+    if (url) {
+        CFRelease(url);
+    }
+    if (ret != noErr) {
+        f->file = NULL;
+        return NO;
+    }
+    AudioStreamBasicDescription fileFmt = {0};
+    UInt32 size = sizeof(fileFmt);
+    SInt64 fileLen = 0;
+    UInt32 lenSize = sizeof(fileLen);
+    if (ExtAudioFileGetProperty(f->file, kExtAudioFileProperty_FileDataFormat,
+                                &size, &fileFmt) != noErr || fileFmt.mSampleRate <= 0) {
+        return NO;
+    }
+    // 由ExtAudioFile完成解码/重采样/声道转换, 输出float交织
+    AudioStreamBasicDescription asbd = {0};
+    asbd.mSampleRate       = rate;
+    asbd.mFormatID         = kAudioFormatLinearPCM;
+    asbd.mFormatFlags      = kAudioFormatFlagIsFloat | kAudioFormatFlagIsPacked;
+    asbd.mChannelsPerFrame = chCnt;
+    asbd.mBitsPerChannel   = 32;
+    asbd.mBytesPerFrame    = sizeof(float) * chCnt;
+    asbd.mFramesPerPacket  = 1;
+    asbd.mBytesPerPacket   = asbd.mBytesPerFrame;
+    if (ExtAudioFileSetProperty(f->file, kExtAudioFileProperty_ClientDataFormat,
+                                sizeof(asbd), &asbd) != noErr) {
+        return NO;
+    }
+    f->ratio = fileFmt.mSampleRate / rate;
+    f->chCnt = chCnt;
+    if (ExtAudioFileGetProperty(f->file, kExtAudioFileProperty_FileLengthFrames,
+                                &lenSize, &fileLen) == noErr && fileLen > 0) {
+        *nbFrame = (int64_t)(fileLen / f->ratio);
+    }
+    return YES;
+}
+
+static int fileReadRaw(KSYBgmFile* f, float* buf, int nbFrame) {
+    UInt32 nb = nbFrame;
+    AudioBufferList abl;
+    abl.mNumberBuffers = 1;
+    abl.mBuffers[0].mNumberChannels = f->chCnt;
+    abl.mBuffers[0].mDataByteSize   = nbFrame * sizeof(float) * f->chCnt;
+    abl.mBuffers[0].mData           = buf;
+    if (ExtAudioFileRead(f->file, &nb, &abl) != noErr) {
+        return -1;
+    }
+    return (int)nb;
+}
+
+static int fileRead(void* ctx, float* buf, int nbFrame) {
+    KSYBgmFile * f = ctx;
+    while (f->skip > 0) {
+        int n = fileReadRaw(f, buf, f->skip < nbFrame ? f->skip : nbFrame);
+        if (n <= 0) {
+            return n;
+        }
+        f->skip -= n;
+    }
+    return fileReadRaw(f, buf, nbFrame);
+}
+
+static BOOL fileSeek(void* ctx, int64_t frame) {
+    KSYBgmFile * f = ctx;
+    // 按文件的采样率定位, 采样率不同时定位到之前最近的一帧, 再丢弃多出的部分
+    SInt64 fileFrame = (SInt64)floor(frame * f->ratio);
+    if (ExtAudioFileSeek(f->file, fileFrame) != noErr) {
+        return NO;
+    }
+    f->skip = (int)llround(frame - fileFrame / f->ratio);
+    f->skip = f->skip > 0 ? f->skip : 0;
+    return YES;
+}
+
+static void fileClose(void* ctx) {
+    KSYBgmFile * f = ctx;
+    if (f->file) {
+        ExtAudioFileDispose(f->file);
+    }
+    free(f->path);
+    free(f);
+}
+
+#pragma mark - cached PCM source
+// 内存映射的缓存数据, 只需转换为float, 不需要解码
+typedef struct {
+    KSYPcmMap * map;
+    int64_t     pos;
+} KSYBgmMapped;
+
+static BOOL mapOpen(void* ctx, int rate, int chCnt, int64_t* nbFrame) {
+    KSYBgmMapped * m = ctx;
+    if (m->map->rate != rate || m->map->chCnt != chCnt) {
+        return NO;
+    }
+    *nbFrame = m->map->nbFrame;
+    return YES;
+}
+
+static int mapRead(void* ctx, float* buf, int nbFrame) {
+    KSYBgmMapped * m = ctx;
+    int64_t remain = m->map->nbFrame - m->pos;
+    int n = (int)(remain < nbFrame ? remain : nbFrame);
+    int ch = m->map->chCnt;
+    ksy_s16_to_f32(buf, m->map->pcm + m->pos * ch, n * ch);
+    m->pos += n;
+    return n;
+}
+
+static BOOL mapSeek(void* ctx, int64_t frame) {
+    KSYBgmMapped * m = ctx;
+    if (frame < 0 || frame > m->map->nbFrame) {
+        return NO;
+    }
+    m->pos = frame;
+    return YES;
+}
+
+static void mapClose(void* ctx) {
+    KSYBgmMapped * m = ctx;
+    ksy_pcm_map_release(m->map);
+    free(m);
+}
+
+static BOOL growBuf(void * buf, int * cap, int nbFrame, size_t frameSize) {
+    if (nbFrame <= *cap) {
+        return YES;
+    }
+    void * p = realloc(*(void**)buf, frameSize * nbFrame);
+    if (p == NULL) {
+        return NO;
+    }
+    *(void**)buf = p;
+    *cap = nbFrame;
+    return YES;
+}
+
+@interface KSYAudioBgmStream () {
+    KSYBgmEngine *  _engine;
+    KSYCueTimeline * _cues;
+    // 主轨线程使用
+    float *         _fltBuf;
+    int             _fltCap;  // 帧
+    int16_t *       _mixBuf;
+    int             _mixCap;  // 帧
+}
+@property (nonatomic, weak) KSYAudioMixer * mixer;
+@end
+
+@implementation KSYAudioBgmStream
+
+static void onBgmEvent(void* opaque, KSYBgmEvent event, int trackId) {
+    KSYAudioBgmStream * s = (__bridge KSYAudioBgmStream*)opaque;
+    void (^block)(KSYBgmEvent, int) = s.onEvent;
+    if (block) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            block(event, trackId);
+        });
+    }
+}
+
+// 播放线程读取数据时触发, 按事件点在数据块中的位置延后回调, 误差为主线程的调度延迟
+static void onBgmCue(void* opaque, const KSYCue* cue, int offset) {
+    KSYAudioBgmStream * s = (__bridge KSYAudioBgmStream*)opaque;
+    void (^block)(int, int) = s.onCue;
+    if (block == nil) {
+        return;
+    }
+    int     trackId = cue->trackId;
+    int     tag     = cue->tag;
+    int64_t delay   = (int64_t)offset * NSEC_PER_SEC / s->_outFmt.sampleRate;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, delay), dispatch_get_main_queue(), ^{
+        block(trackId, tag);
+    });
+}
+
+- (instancetype) initWithMixer:(KSYAudioMixer*)mixer
+                         track:(int)trackId
+                   readAheadMs:(int)readAheadMs {
+    self = [super init];
+    if (self == nil) {
+        return nil;
+    }
+    _mixer   = mixer;
+    _trackId = trackId;
+    if (mixer) {
+        _outFmt = mixer.outFmt;
+    }
+    if (_outFmt.sampleRate <= 0 || _outFmt.chCnt <= 0) {
+        // 混音器的输出固定为 44.1KHz, 单声道, S16
+        _outFmt.sampleFmt  = KSYSampleFmt_S16;
+        _outFmt.sampleSize = 2;
+        _outFmt.chCnt      = 1;
+        _outFmt.chLayout   = 0x4; // AV_CH_LAYOUT_MONO
+        _outFmt.sampleRate = 44100;
+    }
+    _engine = ksy_bgm_create(_outFmt.sampleRate, _outFmt.chCnt, readAheadMs);
+    _cues   = ksy_cue_create(onBgmCue, (__bridge void*)self);
+    if (_engine == NULL || _cues == NULL) {
+        ksy_bgm_destroy(_engine);
+        ksy_cue_destroy(_cues);
+        return nil;
+    }
+    ksy_bgm_set_event_callback(_engine, onBgmEvent, (__bridge void*)self);
+    ksy_bgm_set_cues(_engine, _cues);
+    _tempo = 1.0f;
+    return self;
+}
+
+- (void) dealloc {
+    // 解码线程在此停止, 之后不再回调
+    ksy_bgm_destroy(_engine);
+    ksy_cue_destroy(_cues);
+    free(_fltBuf);
+    free(_mixBuf);
+}
+
+#pragma mark - control
+- (int) playFile:(NSString*)path
+            loop:(BOOL)bLoop {
+    ksy_bgm_stop(_engine);
+    return [self enqueueFile:path loop:bLoop];
+}
+
+- (int) enqueueFile:(NSString*)path
+               loop:(BOOL)bLoop {
+    if (path.length == 0) {
+        return -1;
+    }
+    KSYAudioFileCache * cache = _cache;
+    KSYPcmMap * map = [cache mapFile:path];
+    KSYBgmMapped * m = map ? calloc(1, sizeof(KSYBgmMapped)) : NULL;
+    if (m) {
+        m->map = map;
+        KSYBgmSource src = { m, mapOpen, mapRead, mapSeek, mapClose };
+        return ksy_bgm_enqueue(_engine, &src, bLoop);
+    }
+    ksy_pcm_map_release(map);
+    // 边解码边播放, 同时在后台存入缓存, 下次直接使用
+    [cache cacheFileAsync:path];
+    KSYBgmFile * f = calloc(1, sizeof(KSYBgmFile));
+    if (f == NULL) {
+        return -1;
+    }
+    f->path = strdup(path.fileSystemRepresentation);
+    if (f->path == NULL) {
+        free(f);
+        return -1;
+    }
+    KSYBgmSource src = { f, fileOpen, fileRead, fileSeek, fileClose };
+    return ksy_bgm_enqueue(_engine, &src, bLoop);
+}
+
+- (void) seekTo:(double)sec {
+    ksy_bgm_seek(_engine, (int64_t)llround(sec * _outFmt.sampleRate));
+}
+
+- (void) skip {
+    ksy_bgm_skip(_engine);
+}
+
+- (void) stop {
+    ksy_bgm_stop(_engine);
+}
+
+- (void) pause {
+    ksy_bgm_set_pause(_engine, YES);
+}
+
+- (void) resume {
+    ksy_bgm_set_pause(_engine, NO);
+}
+
+- (void) setTempo:(float)tempo {
+    _tempo = MIN(MAX(tempo, 0.5f), 2.0f);
+    ksy_bgm_set_tempo(_engine, _tempo);
+}
+
+- (void) setPitch:(float)pitch {
+    _pitch = MIN(MAX(pitch, -12.0f), 12.0f);
+    ksy_bgm_set_pitch(_engine, _pitch);
+}
+
+#pragma mark - cue
+- (BOOL) setCues:(NSArray<NSNumber*>*)seconds
+        forTrack:(int)trackId {
+    int      n    = (int)seconds.count;
+    KSYCue * cues = n ? malloc(sizeof(KSYCue) * n) : NULL;
+    if (n && cues == NULL) {
+        return NO;
+    }
+    for (int i = 0; i < n; ++i) {
+        cues[i].trackId = trackId;
+        cues[i].frame   = llround(seconds[i].doubleValue * _outFmt.sampleRate);
+        cues[i].tag     = i;
+    }
+    BOOL bOk = ksy_cue_set_track(_cues, trackId, cues, n);
+    free(cues);
+    return bOk;
+}
+
+- (NSArray<NSString*>*) setLrc:(NSString*)lrc
+                      forTrack:(int)trackId {
+    // [mm:ss.xx]歌词, 一行可以有多个时间; [offset:+/-毫秒] 整体调整 (正数提前)
+    NSRegularExpression * timeRe =
+        [NSRegularExpression regularExpressionWithPattern:@"\\[(\\d+):(\\d+(?:[.:]\\d+)?)\\]"
+                                                  options:0 error:nil];
+    NSRegularExpression * offRe =
+        [NSRegularExpression regularExpressionWithPattern:@"\\[offset:\\s*([+-]?\\d+)\\]"
+                                                  options:NSRegularExpressionCaseInsensitive
+                                                    error:nil];
+    NSMutableArray<NSNumber*> * times = [NSMutableArray array];
+    NSMutableArray<NSString*> * texts = [NSMutableArray array];
+    double offset = 0;
+    for (NSString * line in [lrc componentsSeparatedByCharactersInSet:
+                             [NSCharacterSet newlineCharacterSet]]) {
+        NSRange all = NSMakeRange(0, line.length);
+        NSTextCheckingResult * off = [offRe firstMatchInString:line options:0 range:all];
+        if (off) {
+            offset = [[line substringWithRange:[off rangeAtIndex:1]] doubleValue] / 1000.0;
+            continue;
+        }
+        NSArray * matches = [timeRe matchesInString:line options:0 range:all];
+        if (matches.count == 0) {
+            continue;
+        }
+        NSTextCheckingResult * last = matches.lastObject;
+        NSString * text = [line substringFromIndex:NSMaxRange(last.range)];
+        text = [text stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+        for (NSTextCheckingResult * m in matches) {
+            NSString * sec = [[line substringWithRange:[m rangeAtIndex:2]]
+                              stringByReplacingOccurrencesOfString:@":" withString:@"."];
+            [times addObject:@([[line substringWithRange:[m rangeAtIndex:1]] intValue] * 60.0 +
+                               sec.doubleValue)];
+            [texts addObject:text];
+        }
+    }
+    for (NSUInteger i = 0; offset != 0 && i < times.count; ++i) {
+        times[i] = @(MAX(times[i].doubleValue - offset, 0));
+    }
+    return [self setCues:times forTrack:trackId] ? texts : nil;
+}
+
+- (void) clearCues {
+    ksy_cue_clear(_cues);
+}
+
+- (void) setCueLeadMs:(float)cueLeadMs {
+    _cueLeadMs = MAX(cueLeadMs, 0);
+    ksy_cue_set_lead(_cues, (int)lrintf(_cueLeadMs * _outFmt.sampleRate / 1000));
+}
+
+#pragma mark - stat
+- (KSYBgmStat) stat {
+    KSYBgmStat st = {0};
+    ksy_bgm_get_stat(_engine, &st);
+    return st;
+}
+
+- (BOOL) bPaused {
+    return self.stat.bPaused;
+}
+
+- (int) curTrack {
+    return self.stat.trackId;
+}
+
+- (double) position {
+    return (double)self.stat.position / _outFmt.sampleRate;
+}
+
+- (double) duration {
+    return (double)self.stat.duration / _outFmt.sampleRate;
+}
+
+- (float) bufferFillMs {
+    return self.stat.fillMs;
+}
+
+- (float) cpuPercent {
+    return self.stat.cpuPercent;
+}
+
+- (int64_t) underrunCnt {
+    return self.stat.underrunCnt;
+}
+
+- (int) queued {
+    return self.stat.queued;
+}
+
+#pragma mark - render
+- (int) render:(int16_t*)buf
+       nbFrame:(int)nbFrame {
+    int ch = _outFmt.chCnt;
+    if (buf == NULL || nbFrame <= 0 ||
+        !growBuf(&_fltBuf, &_fltCap, nbFrame, sizeof(float)*ch)) {
+        return 0;
+    }
+    int n = ksy_bgm_read(_engine, _fltBuf, nbFrame);
+    if (n > 0) {
+        ksy_f32_to_s16(buf, _fltBuf, n * ch);
+    }
+    return n;
+}
+
+- (int) feedMixer:(CMSampleBufferRef)mainBuf {
+    KSYAudioMixer * mixer = _mixer;
+    if (mainBuf == NULL || mixer == nil) {
+        return 0;
+    }
+    CMFormatDescriptionRef desc = CMSampleBufferGetFormatDescription(mainBuf);
+    const AudioStreamBasicDescription * asbd = desc ?
+        CMAudioFormatDescriptionGetStreamBasicDescription(desc) : NULL;
+    if (asbd == NULL || asbd->mSampleRate <= 0) {
+        return 0;
+    }
+    int64_t nbMain = CMSampleBufferGetNumSamples(mainBuf);
+    int need = (int)((nbMain * _outFmt.sampleRate + (int64_t)asbd->mSampleRate/2)
+                     / (int64_t)asbd->mSampleRate);
+    int ch = _outFmt.chCnt;
+    if (need <= 0 || !growBuf(&_mixBuf, &_mixCap, need, sizeof(int16_t)*ch)) {
+        return 0;
+    }
+    int n = [self render:_mixBuf nbFrame:need];
+    if (n <= 0) {
+        return 0;
+    }
+    if (n < need) { // 预读不足, 补零保持与主轨对齐
+        memset(_mixBuf + n*ch, 0, sizeof(int16_t) * (need - n) * ch);
+    }
+    [_ducker applyGain:_mixBuf nbFrame:need chCnt:ch];
+    [_outputStage meterTrack:_trackId data:_mixBuf nbFrame:need format:&_outFmt];
+    ksy_mixer_feed_s16(mixer, _trackId, _mixBuf, need, &_outFmt,
+                       CMSampleBufferGetPresentationTimeStamp(mainBuf));
+    return need;
+}
+
+@end
@@ -0,0 +1,76 @@
+//
+//  KSYAudioConvert.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** PCM 格式和声道转换
+
+ 1. 采样格式和声道映射/声像在一次遍历中完成, 每路音频只做一次转换
+ 2. 声道映射和声像统一表示为 dstCh x srcCh 的增益矩阵
+ 3. 采样格式的取值与 KSYAudioFormat.sampleFmt 相同 (即 AVSampleFormat)
+ */
+
+/// 支持的采样格式
+typedef NS_ENUM(int, KSYSampleFmt) {
+    /// 16位整数, 交织
+    KSYSampleFmt_S16  = 1,
+    /// 32位浮点, 交织
+    KSYSampleFmt_FLT  = 3,
+    /// 16位整数, 平面(每个声道一块内存)
+    KSYSampleFmt_S16P = 6,
+    /// 32位浮点, 平面
+    KSYSampleFmt_FLTP = 8,
+};
+
+/// 转换支持的最大声道数
+#define KSY_AUDIO_MAX_CH  8
+
+/**
+ @abstract  采样格式是否被支持
+ */
+BOOL ksy_sample_fmt_valid(int fmt);
+
+/**
+ @abstract  是否为平面格式
+ */
+BOOL ksy_sample_fmt_planar(int fmt);
+
+/**
+ @abstract  每个样本的字节数, 不支持的格式返回0
+ */
+int ksy_sample_fmt_size(int fmt);
+
+/**
+ @abstract  生成声道转换矩阵
+ @param     mat    输出的矩阵, 行优先, 大小为 dstCh*srcCh
+ @param     dstCh  输出声道数
+ @param     srcCh  输入声道数
+ @param     chMap  输出声道o取输入的第chMap[o]个声道, -1为静音; NULL为默认映射
+ @param     pan    声像 (-1.0 全左 ~ 0 居中 ~ 1.0 全右), 仅对双声道输出有效; NAN 为不调节
+ @discussion 默认映射: 声道数相同时一一对应, 输出单声道时取各声道平均, 其余按序号循环
+ @discussion 单声道输入采用等功率声像, 多声道输入为平衡调节 (衰减另一侧)
+ */
+void ksy_audio_channel_matrix(float* mat, int dstCh, int srcCh,
+                              const int* chMap, float pan);
+
+/**
+ @abstract  格式和声道转换
+ @param     dst    输出数据, 平面格式时为各声道的指针
+ @param     dstFmt 输出采样格式
+ @param     dstCh  输出声道数
+ @param     src    输入数据, 平面格式时为各声道的指针
+ @param     srcFmt 输入采样格式
+ @param     srcCh  输入声道数
+ @param     mat    声道转换矩阵, NULL 为默认映射 (不调节声像, 单声道输入时两侧与输入相同)
+ @param     nbFrame 帧数
+ @return    0 成功; -1 格式或参数不支持
+ @discussion 转为S16时饱和取整
+ */
+int ksy_audio_convert(uint8_t* const* dst, int dstFmt, int dstCh,
+                      const uint8_t* const* src, int srcFmt, int srcCh,
+                      const float* mat, int nbFrame);
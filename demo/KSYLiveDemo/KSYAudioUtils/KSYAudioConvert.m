@@ -0,0 +1,225 @@
+//
+//  KSYAudioConvert.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioConvert.h"
+#include <string.h>
+#include <math.h>
+
+#define CVT_BLOCK  256  // 每次转换的帧数
+
+BOOL ksy_sample_fmt_valid(int fmt) {
+    return fmt == KSYSampleFmt_S16  || fmt == KSYSampleFmt_FLT ||
+           fmt == KSYSampleFmt_S16P || fmt == KSYSampleFmt_FLTP;
+}
+
+BOOL ksy_sample_fmt_planar(int fmt) {
+    return fmt == KSYSampleFmt_S16P || fmt == KSYSampleFmt_FLTP;
+}
+
+int ksy_sample_fmt_size(int fmt) {
+    switch (fmt) {
+        case KSYSampleFmt_S16:
+        case KSYSampleFmt_S16P:
+            return 2;
+        case KSYSampleFmt_FLT:
+        case KSYSampleFmt_FLTP:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+void ksy_audio_channel_matrix(float* mat, int dstCh, int srcCh,
+                              const int* chMap, float pan) {
+    if (mat == NULL || dstCh <= 0 || srcCh <= 0) {
+        return;
+    }
+    memset(mat, 0, sizeof(float)*dstCh*srcCh);
+    for (int o = 0; o < dstCh; ++o) {
+        float * row = mat + o*srcCh;
+        if (chMap) {
+            int c = chMap[o];
+            if (c >= 0 && c < srcCh) {
+                row[c] = 1.0f;
+            }
+        }
+        else if (dstCh == 1) {
+            for (int c = 0; c < srcCh; ++c) {
+                row[c] = 1.0f / srcCh;
+            }
+        }
+        else {
+            row[o % srcCh] = 1.0f;
+        }
+    }
+    if (dstCh != 2 || !(pan == pan)) {
+        return;
+    }
+    pan = pan < -1.0f ? -1.0f : (pan > 1.0f ? 1.0f : pan);
+    float gl, gr;
+    if (srcCh == 1) { // 等功率, 居中时两侧各 -3dB
+        float theta = (pan + 1.0f) * (float)M_PI_4;
+        gl = cosf(theta);
+        gr = sinf(theta);
+    }
+    else { // 平衡调节, 居中时不衰减
+        gl = pan > 0.0f ? 1.0f - pan : 1.0f;
+        gr = pan < 0.0f ? 1.0f + pan : 1.0f;
+    }
+    for (int c = 0; c < srcCh; ++c) {
+        mat[c]         *= gl;
+        mat[srcCh + c] *= gr;
+    }
+}
+
+// 读入一块数据, 转为 float, 交织存放于 out[frame*srcCh + ch]
+static void loadBlock(float* out, const uint8_t* const* src, int fmt,
+                      int srcCh, int off, int n) {
+    const float  s16Scale = 1.0f / 32768.0f;
+    switch (fmt) {
+        case KSYSampleFmt_S16: {
+            const int16_t * p = (const int16_t*)src[0] + (size_t)off*srcCh;
+            for (int i = 0; i < n*srcCh; ++i) {
+                out[i] = p[i] * s16Scale;
+            }
+            break;
+        }
+        case KSYSampleFmt_FLT:
+            memcpy(out, (const float*)src[0] + (size_t)off*srcCh, sizeof(float)*n*srcCh);
+            break;
+        case KSYSampleFmt_S16P:
+            for (int c = 0; c < srcCh; ++c) {
+                const int16_t * p = (const int16_t*)src[c] + off;
+                for (int i = 0; i < n; ++i) {
+                    out[i*srcCh + c] = p[i] * s16Scale;
+                }
+            }
+            break;
+        case KSYSampleFmt_FLTP:
+            for (int c = 0; c < srcCh; ++c) {
+                const float * p = (const float*)src[c] + off;
+                for (int i = 0; i < n; ++i) {
+                    out[i*srcCh + c] = p[i];
+                }
+            }
+            break;
+    }
+}
+
+static inline int16_t f2s16(float v) {
+    float s = v * 32768.0f;
+    if (s >= 32767.0f) {
+        return INT16_MAX;
+    }
+    if (s <= -32768.0f) {
+        return INT16_MIN;
+    }
+    return (int16_t)lrintf(s);
+}
+
+// 写出一块交织的 float 数据 in[frame*dstCh + ch]
+static void storeBlock(uint8_t* const* dst, int fmt, int dstCh,
+                       const float* in, int off, int n) {
+    switch (fmt) {
+        case KSYSampleFmt_S16: {
+            int16_t * p = (int16_t*)dst[0] + (size_t)off*dstCh;
+            for (int i = 0; i < n*dstCh; ++i) {
+                p[i] = f2s16(in[i]);
+            }
+            break;
+        }
+        case KSYSampleFmt_FLT:
+            memcpy((float*)dst[0] + (size_t)off*dstCh, in, sizeof(float)*n*dstCh);
+            break;
+        case KSYSampleFmt_S16P:
+            for (int c = 0; c < dstCh; ++c) {
+                int16_t * p = (int16_t*)dst[c] + off;
+                for (int i = 0; i < n; ++i) {
+                    p[i] = f2s16(in[i*dstCh + c]);
+                }
+            }
+            break;
+        case KSYSampleFmt_FLTP:
+            for (int c = 0; c < dstCh; ++c) {
+                float * p = (float*)dst[c] + off;
+                for (int i = 0; i < n; ++i) {
+                    p[i] = in[i*dstCh + c];
+                }
+            }
+            break;
+    }
+}
+
+static BOOL isIdentity(const float* mat, int dstCh, int srcCh) {
+    if (dstCh != srcCh) {
+        return NO;
+    }
+    for (int o = 0; o < dstCh; ++o) {
+        for (int c = 0; c < srcCh; ++c) {
+            if (mat[o*srcCh + c] != (o == c ? 1.0f : 0.0f)) {
+                return NO;
+            }
+        }
+    }
+    return YES;
+}
+
+int ksy_audio_convert(uint8_t* const* dst, int dstFmt, int dstCh,
+                      const uint8_t* const* src, int srcFmt, int srcCh,
+                      const float* mat, int nbFrame) {
+    if (dst == NULL || src == NULL || nbFrame < 0 ||
+        !ksy_sample_fmt_valid(dstFmt) || !ksy_sample_fmt_valid(srcFmt) ||
+        dstCh <= 0 || dstCh > KSY_AUDIO_MAX_CH ||
+        srcCh <= 0 || srcCh > KSY_AUDIO_MAX_CH) {
+        return -1;
+    }
+    float defMat[KSY_AUDIO_MAX_CH*KSY_AUDIO_MAX_CH];
+    if (mat == NULL) {
+        ksy_audio_channel_matrix(defMat, dstCh, srcCh, NULL, NAN);
+        mat = defMat;
+    }
+    BOOL bIdentity = isIdentity(mat, dstCh, srcCh);
+    // 格式相同且声道一一对应, 直接拷贝
+    if (bIdentity && dstFmt == srcFmt) {
+        int sz = ksy_sample_fmt_size(dstFmt);
+        if (ksy_sample_fmt_planar(dstFmt)) {
+            for (int c = 0; c < dstCh; ++c) {
+                memmove(dst[c], src[c], (size_t)sz*nbFrame);
+            }
+        }
+        else {
+            memmove(dst[0], src[0], (size_t)sz*nbFrame*dstCh);
+        }
+        return 0;
+    }
+    // 其余情况按块转为 float 交织, 乘以矩阵后写出
+    float inBuf [CVT_BLOCK*KSY_AUDIO_MAX_CH];
+    float outBuf[CVT_BLOCK*KSY_AUDIO_MAX_CH];
+    for (int off = 0; off < nbFrame; off += CVT_BLOCK) {
+        int n = nbFrame - off < CVT_BLOCK ? nbFrame - off : CVT_BLOCK;
+        loadBlock(inBuf, src, srcFmt, srcCh, off, n);
+        const float * mixed = inBuf;
+        if (!bIdentity) {
+            for (int i = 0; i < n; ++i) {
+                const float * x = inBuf  + i*srcCh;
+                float *       y = outBuf + i*dstCh;
+                for (int o = 0; o < dstCh; ++o) {
+                    const float * row = mat + o*srcCh;
+                    float acc = 0.0f;
+                    for (int c = 0; c < srcCh; ++c) {
+                        acc += row[c] * x[c];
+                    }
+                    y[o] = acc;
+                }
+            }
+            mixed = outBuf;
+        }
+        storeBlock(dst, dstFmt, dstCh, mixed, off, n);
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+//
+//  KSYAudioCueTimeline.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** 按播放位置触发的时间轴事件 (歌词行/节拍等)
+
+ 1. 事件点按 (曲目id, 帧) 排序存放, 播放线程每处理一块数据只比较游标处的一个事件点,
+    没有事件到达时的开销与事件点的数量无关
+ 2. 位置不连续 (切歌/定位/循环) 时用二分查找重新定位游标, 跳过的事件点不触发
+ 3. 触发精确到帧: 回调给出事件点在当前数据块中的偏移
+ 4. 控制线程修改事件点时生成新的索引, 播放线程在下一块数据时无锁换用, 旧索引由控制线程释放
+ 5. 位置由调用者给出 (播放线程读取数据时), 不依赖系统时钟, 可以用合成的时钟离线测试
+ */
+typedef struct _KSYCueTimeline KSYCueTimeline;
+
+/// 事件点
+typedef struct {
+    /// 所属曲目的id
+    int     trackId;
+    /// 在曲目中的位置 (帧)
+    int64_t frame;
+    /// 调用者的数据 (如歌词的行号, 节拍序号)
+    int     tag;
+} KSYCue;
+
+/**
+ @abstract  事件回调 (播放线程, 即 ksy_cue_advance 的调用线程; 不能阻塞)
+ @param     cue    到达的事件点
+ @param     offset 事件点在输出数据块中的位置 (帧)
+ */
+typedef void (*KSYCueFn)(void* opaque, const KSYCue* cue, int offset);
+
+/**
+ @abstract  创建
+ @param     fn     事件回调
+ @param     opaque 回调的参数
+ */
+KSYCueTimeline* ksy_cue_create(KSYCueFn fn, void* opaque);
+
+/**
+ @abstract  销毁 (须保证播放线程已不再调用 ksy_cue_advance)
+ */
+void ksy_cue_destroy(KSYCueTimeline* tl);
+
+/**
+ @abstract  设置一首曲目的全部事件点, 替换该曲目原有的事件点 (控制线程)
+ @param     trackId 曲目id (忽略 cues 中的 trackId)
+ @param     cues    事件点, 不需要排好序; nbCue 为0时清除该曲目的事件点
+ @return    内存不足时返回NO, 原有的事件点不变
+ */
+BOOL ksy_cue_set_track(KSYCueTimeline* tl, int trackId, const KSYCue* cues, int nbCue);
+
+/**
+ @abstract  清除全部事件点 (控制线程)
+ */
+void ksy_cue_clear(KSYCueTimeline* tl);
+
+/**
+ @abstract  事件点的总数 (控制线程)
+ */
+int ksy_cue_count(const KSYCueTimeline* tl);
+
+/**
+ @abstract  提前触发的帧数 (任意线程), 用于补偿数据块从读取到输出之间的延迟, 默认为0
+ */
+void ksy_cue_set_lead(KSYCueTimeline* tl, int frames);
+
+/**
+ @abstract  播放位置前进 (播放线程), 触发 [pos, pos+nbFrame) 内的事件点
+ @param     trackId 当前曲目的id
+ @param     pos     这块数据在曲目中的起始位置 (帧)
+ @param     nbFrame 这块数据的帧数
+ @param     outOff  这块数据在输出数据块中的起始位置 (一个输出块被标记分成几段时), 加到回调的 offset 上
+ @return    触发的事件数
+ */
+int ksy_cue_advance(KSYCueTimeline* tl, int trackId, int64_t pos, int nbFrame, int outOff);
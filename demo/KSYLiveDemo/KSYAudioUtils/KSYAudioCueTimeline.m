@@ -0,0 +1,224 @@
+//
+//  KSYAudioCueTimeline.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioCueTimeline.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 排好序的事件点, 生成后不再修改
+typedef struct {
+    int     cnt;
+    KSYCue  cues[];
+} CueIndex;
+
+struct _KSYCueTimeline {
+    KSYCueFn            fn;
+    void *              opaque;
+    pthread_mutex_t     lock;
+    // lock 保护 (控制线程)
+    KSYCue *            all;        // 排好序的全部事件点
+    int                 cnt;
+    // 控制线程 <-> 播放线程
+    _Atomic(CueIndex *) pending;    // 新生成的索引, 播放线程取走
+    _Atomic(CueIndex *) retired;    // 播放线程换下的索引, 控制线程释放
+    atomic_int          lead;
+    // 播放线程使用
+    CueIndex *          cur;
+    int                 cursor;     // 下一个待触发的事件点
+    int                 lastTrack;
+    int64_t             lastEnd;    // 上一块数据的结束位置 (已加上 lead)
+    BOOL                bSync;      // 游标与 lastTrack/lastEnd 一致
+};
+
+static int cmpCue(const KSYCue* a, int track, int64_t frame) {
+    if (a->trackId != track) {
+        return a->trackId < track ? -1 : 1;
+    }
+    if (a->frame != frame) {
+        return a->frame < frame ? -1 : 1;
+    }
+    return 0;
+}
+
+static int sortCue(const void* pa, const void* pb) {
+    const KSYCue * a = pa;
+    const KSYCue * b = pb;
+    int c = cmpCue(a, b->trackId, b->frame);
+    return c ? c : (a->tag > b->tag) - (a->tag < b->tag);
+}
+
+// 第一个不早于 (track, frame) 的事件点
+static int lowerBound(const CueIndex* idx, int track, int64_t frame) {
+    int lo = 0, hi = idx->cnt;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (cmpCue(&idx->cues[mid], track, frame) < 0) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+KSYCueTimeline* ksy_cue_create(KSYCueFn fn, void* opaque) {
+    KSYCueTimeline * tl = calloc(1, sizeof(KSYCueTimeline));
+    if (tl == NULL) {
+        return NULL;
+    }
+    tl->fn        = fn;
+    tl->opaque    = opaque;
+    tl->lastTrack = -1;
+    atomic_init(&tl->pending, NULL);
+    atomic_init(&tl->retired, NULL);
+    atomic_init(&tl->lead, 0);
+    pthread_mutex_init(&tl->lock, NULL);
+    return tl;
+}
+
+void ksy_cue_destroy(KSYCueTimeline* tl) {
+    if (tl == NULL) {
+        return;
+    }
+    free(atomic_load(&tl->pending));
+    free(atomic_load(&tl->retired));
+    free(tl->cur);
+    free(tl->all);
+    pthread_mutex_destroy(&tl->lock);
+    free(tl);
+}
+
+#pragma mark - control
+// 用 all 生成新索引交给播放线程 (lock 内调用)
+static BOOL publish(KSYCueTimeline* tl) {
+    CueIndex * idx = malloc(sizeof(CueIndex) + sizeof(KSYCue) * tl->cnt);
+    if (idx == NULL) {
+        return NO;
+    }
+    idx->cnt = tl->cnt;
+    if (tl->cnt > 0) {
+        memcpy(idx->cues, tl->all, sizeof(KSYCue) * tl->cnt);
+    }
+    // 先回收播放线程换下的索引, 播放线程只在 retired 为空时才换用新索引
+    free(atomic_exchange_explicit(&tl->retired, NULL, memory_order_acquire));
+    // 还没被取走的上一个索引直接释放
+    free(atomic_exchange_explicit(&tl->pending, idx, memory_order_acq_rel));
+    return YES;
+}
+
+BOOL ksy_cue_set_track(KSYCueTimeline* tl, int trackId, const KSYCue* cues, int nbCue) {
+    if (tl == NULL || nbCue < 0 || (nbCue > 0 && cues == NULL)) {
+        return NO;
+    }
+    pthread_mutex_lock(&tl->lock);
+    // 保留其他曲目的事件点, 加上新的事件点后重新排序
+    KSYCue * all = malloc(sizeof(KSYCue) * (tl->cnt + nbCue + 1));
+    if (all == NULL) {
+        pthread_mutex_unlock(&tl->lock);
+        return NO;
+    }
+    int cnt = 0;
+    for (int i = 0; i < tl->cnt; ++i) {
+        if (tl->all[i].trackId != trackId) {
+            all[cnt++] = tl->all[i];
+        }
+    }
+    for (int i = 0; i < nbCue; ++i) {
+        all[cnt] = cues[i];
+        all[cnt].trackId = trackId;
+        cnt += 1;
+    }
+    qsort(all, cnt, sizeof(KSYCue), sortCue);
+    KSYCue * old    = tl->all;
+    int      oldCnt = tl->cnt;
+    tl->all = all;
+    tl->cnt = cnt;
+    BOOL bOk = publish(tl);
+    if (bOk) {
+        free(old);
+    }
+    else {
+        tl->all = old;
+        tl->cnt = oldCnt;
+        free(all);
+    }
+    pthread_mutex_unlock(&tl->lock);
+    return bOk;
+}
+
+void ksy_cue_clear(KSYCueTimeline* tl) {
+    if (tl == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&tl->lock);
+    tl->cnt = 0;
+    publish(tl);
+    pthread_mutex_unlock(&tl->lock);
+}
+
+int ksy_cue_count(const KSYCueTimeline* tl) {
+    if (tl == NULL) {
+        return 0;
+    }
+    KSYCueTimeline * t = (KSYCueTimeline*)tl;
+    pthread_mutex_lock(&t->lock);
+    int cnt = t->cnt;
+    pthread_mutex_unlock(&t->lock);
+    return cnt;
+}
+
+void ksy_cue_set_lead(KSYCueTimeline* tl, int frames) {
+    if (tl) {
+        atomic_store_explicit(&tl->lead, frames > 0 ? frames : 0, memory_order_relaxed);
+    }
+}
+
+#pragma mark - render thread
+int ksy_cue_advance(KSYCueTimeline* tl, int trackId, int64_t pos, int nbFrame, int outOff) {
+    if (tl == NULL || nbFrame <= 0) {
+        return 0;
+    }
+    // 上一个换下的索引已被回收时才换用新索引, retired 最多只有一个
+    if (atomic_load_explicit(&tl->retired, memory_order_acquire) == NULL) {
+        CueIndex * idx = atomic_exchange_explicit(&tl->pending, NULL, memory_order_acq_rel);
+        if (idx) {
+            atomic_store_explicit(&tl->retired, tl->cur, memory_order_release);
+            tl->cur   = idx;
+            tl->bSync = NO;
+        }
+    }
+    CueIndex * idx = tl->cur;
+    int64_t    beg = pos + atomic_load_explicit(&tl->lead, memory_order_relaxed);
+    int64_t    end = beg + nbFrame;
+    if (idx == NULL || idx->cnt == 0) {
+        tl->bSync = NO;
+        return 0;
+    }
+    if (!tl->bSync || trackId != tl->lastTrack || beg != tl->lastEnd) {
+        tl->cursor = lowerBound(idx, trackId, beg); // 不连续, 跳过的事件点不触发
+        tl->bSync  = YES;
+    }
+    int fired = 0;
+    while (tl->cursor < idx->cnt) {
+        const KSYCue * c = &idx->cues[tl->cursor];
+        if (c->trackId != trackId || c->frame >= end) {
+            break;
+        }
+        tl->cursor += 1;
+        fired      += 1;
+        if (tl->fn) {
+            tl->fn(tl->opaque, c, outOff + (int)(c->frame - beg));
+        }
+    }
+    tl->lastTrack = trackId;
+    tl->lastEnd   = end;
+    return fired;
+}
@@ -0,0 +1,102 @@
+//
+//  KSYAudioDenoise.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** 频域降噪 (谱减/维纳增益)
+
+ 1. 10ms一帧, 50%重叠, 平方根汉宁窗分析和合成, 增益为1时输出与输入(延迟20ms)完全一致
+ 2. 噪声估计: 平滑功率谱的最小值跟踪, 上升速度受限, 适应风扇/空调等平稳噪声
+ 3. 增益: 判决引导(decision-directed)的先验信噪比 + 维纳增益, 按降噪等级设置下限, 抑制音乐噪声
+ 4. 每帧的计算量固定(一次正/逆FFT); 可以设置每帧的时间预算,
+    平均耗时超出预算时直通一段时间后再重试, 不会拖慢采集线程
+ 5. 多声道时用各声道的平均功率估计噪声和增益, 各声道使用相同的增益
+ */
+typedef struct _KSYAudioDenoise KSYAudioDenoise;
+
+/// 降噪等级
+typedef NS_ENUM(int, KSYDenoiseLevel) {
+    /// 关闭 (仍有20ms延迟, 切换等级时不会跳变)
+    KSYDenoiseLevel_Off = 0,
+    /// 低: 最多衰减6dB
+    KSYDenoiseLevel_Low,
+    /// 中: 最多衰减12dB
+    KSYDenoiseLevel_Medium,
+    /// 高: 最多衰减18dB
+    KSYDenoiseLevel_High,
+    /// 最高: 最多衰减25dB, 人声可能有损伤
+    KSYDenoiseLevel_VeryHigh,
+};
+
+/// 处理统计 (处理线程读取)
+typedef struct {
+    /// 最近一帧的处理耗时 (微秒)
+    float   lastUs;
+    /// 平均每帧的处理耗时 (微秒, 指数平滑)
+    float   avgUs;
+    /// 最大的处理耗时 (微秒)
+    float   maxUs;
+    /// 处理的帧数
+    int64_t nbFrame;
+    /// 因超出预算而直通的帧数
+    int64_t nbSkipped;
+    /// 当前是否因超出预算而直通
+    BOOL    bOverBudget;
+    /// 估计的噪声电平 (dBFS)
+    float   noiseDb;
+    /// 最近一帧的衰减量 (dB, <=0)
+    float   reductionDb;
+} KSYDenoiseStat;
+
+/**
+ @abstract  创建
+ @param     rate  采样率 (8000~48000, 10ms为整数帧)
+ @param     chCnt 声道数 (1或2)
+ @return    参数错误时返回NULL
+ */
+KSYAudioDenoise* ksy_denoise_create(int rate, int chCnt);
+
+/**
+ @abstract  销毁
+ */
+void ksy_denoise_destroy(KSYAudioDenoise* dn);
+
+/**
+ @abstract  设置降噪等级, 默认为 KSYDenoiseLevel_Medium (与 process 在同一线程调用)
+ */
+void ksy_denoise_set_level(KSYAudioDenoise* dn, KSYDenoiseLevel level);
+
+/**
+ @abstract  设置每帧的时间预算 (微秒), 0 表示不限制, 默认为0
+ */
+void ksy_denoise_set_budget(KSYAudioDenoise* dn, float usPerFrame);
+
+/**
+ @abstract  处理引入的延迟 (帧数, 即20ms)
+ */
+int ksy_denoise_latency(const KSYAudioDenoise* dn);
+
+/**
+ @abstract  原地处理 float 交织数据, nbFrame 任意
+ */
+void ksy_denoise_process_f32(KSYAudioDenoise* dn, float* pcm, int nbFrame);
+
+/**
+ @abstract  原地处理 S16 交织数据, nbFrame 任意
+ */
+void ksy_denoise_process_s16(KSYAudioDenoise* dn, int16_t* pcm, int nbFrame);
+
+/**
+ @abstract  读取统计信息
+ */
+void ksy_denoise_get_stat(const KSYAudioDenoise* dn, KSYDenoiseStat* stat);
+
+/**
+ @abstract  清空噪声估计和缓冲的数据
+ */
+void ksy_denoise_reset(KSYAudioDenoise* dn);
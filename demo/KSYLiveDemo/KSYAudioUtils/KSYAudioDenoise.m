@@ -0,0 +1,359 @@
+//
+//  KSYAudioDenoise.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioDenoise.h"
+#import "KSYAudioFFT.h"
+#import "KSYAudioKernel.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define DN_MAX_CH       2
+#define DN_IO           256     // S16 转换的块长 (帧)
+#define DN_INIT_FRAMES  20      // 前200ms用平均值初始化噪声估计
+#define DN_PSD_SMOOTH   0.8f    // 功率谱的时间平滑系数
+#define DN_RISE_DB_S    5.0f    // 噪声估计每秒最多上升的dB数
+#define DN_MIN_BIAS     1.5f    // 最小值跟踪的偏差补偿
+#define DN_DD_ALPHA     0.98f   // 判决引导的平滑系数
+#define DN_RETRY_FRAMES 200     // 超出预算后直通2秒再重试
+#define DN_EPS          1e-12f
+
+// 各等级的 (过减因子, 增益下限dB)
+static const float s_levelParam[][2] = {
+    { 1.0f,   0.0f },
+    { 1.0f,  -6.0f },
+    { 1.0f, -12.0f },
+    { 1.3f, -18.0f },
+    { 1.6f, -25.0f },
+};
+
+struct _KSYAudioDenoise {
+    int             rate;
+    int             chCnt;
+    int             hop;        // 10ms 的帧数
+    int             nfft;       // >= 2*hop 的2的整数次幂
+    int             nbBin;      // nfft/2+1
+    KSYAudioFFT *   fft;
+    // 按声道分开的缓冲
+    float *         in[DN_MAX_CH];    // 正在收集的一帧 (hop)
+    float *         prev[DN_MAX_CH];  // 上一帧 (hop)
+    float *         out[DN_MAX_CH];   // 正在输出的一帧 (hop)
+    float *         ola[DN_MAX_CH];   // 重叠相加的尾部 (hop)
+    float *         spec[DN_MAX_CH];  // 频谱 (nfft+2)
+    int             fill;
+    // 共用
+    float *         win;        // 平方根汉宁窗 (2*hop)
+    float *         power;      // 当前帧的功率谱
+    float *         smooth;     // 平滑后的功率谱
+    float *         noise;      // 噪声估计 (最小值跟踪)
+    float *         clean;      // 上一帧估计的纯净语音功率
+    float *         gain;
+    float           winEnergy;
+    float           rise;
+    int             nbAnalyzed;
+    float           overSub;
+    float           floorGain;
+    KSYDenoiseLevel level;
+    // 时间预算
+    float           budgetUs;
+    int             bypassLeft;
+    BOOL            bRetry;     // 下一次计时重新开始平均
+    KSYDenoiseStat  stat;
+    float           io[DN_IO * DN_MAX_CH];
+};
+
+static double nowUs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec * 1e-3;
+}
+
+KSYAudioDenoise* ksy_denoise_create(int rate, int chCnt) {
+    if (rate < 8000 || rate > 48000 || rate % 100 || chCnt < 1 || chCnt > DN_MAX_CH) {
+        return NULL;
+    }
+    KSYAudioDenoise* dn = calloc(1, sizeof(KSYAudioDenoise));
+    if (dn == NULL) {
+        return NULL;
+    }
+    dn->rate  = rate;
+    dn->chCnt = chCnt;
+    dn->hop   = rate / 100;
+    dn->nfft  = 16;
+    while (dn->nfft < 2 * dn->hop) {
+        dn->nfft <<= 1;
+    }
+    dn->nbBin = dn->nfft / 2 + 1;
+    dn->fft   = ksy_fft_create(dn->nfft);
+    BOOL bOK  = dn->fft != NULL;
+    for (int c = 0; c < chCnt; ++c) {
+        dn->in[c]   = calloc(dn->hop, sizeof(float));
+        dn->prev[c] = calloc(dn->hop, sizeof(float));
+        dn->out[c]  = calloc(dn->hop, sizeof(float));
+        dn->ola[c]  = calloc(dn->hop, sizeof(float));
+        dn->spec[c] = calloc(dn->nfft + 2, sizeof(float));
+        bOK = bOK && dn->in[c] && dn->prev[c] && dn->out[c] && dn->ola[c] && dn->spec[c];
+    }
+    dn->win    = calloc(2 * dn->hop, sizeof(float));
+    dn->power  = calloc(dn->nbBin, sizeof(float));
+    dn->smooth = calloc(dn->nbBin, sizeof(float));
+    dn->noise  = calloc(dn->nbBin, sizeof(float));
+    dn->clean  = calloc(dn->nbBin, sizeof(float));
+    dn->gain   = calloc(dn->nbBin, sizeof(float));
+    if (!bOK || !dn->win || !dn->power || !dn->smooth || !dn->noise || !dn->clean || !dn->gain) {
+        ksy_denoise_destroy(dn);
+        return NULL;
+    }
+    // 周期汉宁窗的平方根, 50%重叠时 w^2 相加恒为1
+    const int len = 2 * dn->hop;
+    for (int i = 0; i < len; ++i) {
+        dn->win[i] = (float)sqrt(0.5 - 0.5 * cos(2 * M_PI * i / len));
+        dn->winEnergy += dn->win[i] * dn->win[i];
+    }
+    dn->rise = powf(10.0f, DN_RISE_DB_S / 10.0f / 100.0f);
+    ksy_denoise_set_level(dn, KSYDenoiseLevel_Medium);
+    ksy_denoise_reset(dn);
+    return dn;
+}
+
+void ksy_denoise_destroy(KSYAudioDenoise* dn) {
+    if (dn == NULL) {
+        return;
+    }
+    for (int c = 0; c < DN_MAX_CH; ++c) {
+        free(dn->in[c]);
+        free(dn->prev[c]);
+        free(dn->out[c]);
+        free(dn->ola[c]);
+        free(dn->spec[c]);
+    }
+    free(dn->win);
+    free(dn->power);
+    free(dn->smooth);
+    free(dn->noise);
+    free(dn->clean);
+    free(dn->gain);
+    ksy_fft_destroy(dn->fft);
+    free(dn);
+}
+
+void ksy_denoise_set_level(KSYAudioDenoise* dn, KSYDenoiseLevel level) {
+    if (dn == NULL) {
+        return;
+    }
+    if (level < KSYDenoiseLevel_Off) {
+        level = KSYDenoiseLevel_Off;
+    }
+    if (level > KSYDenoiseLevel_VeryHigh) {
+        level = KSYDenoiseLevel_VeryHigh;
+    }
+    dn->level     = level;
+    dn->overSub   = s_levelParam[level][0];
+    dn->floorGain = powf(10.0f, s_levelParam[level][1] / 20.0f);
+}
+
+void ksy_denoise_set_budget(KSYAudioDenoise* dn, float usPerFrame) {
+    if (dn) {
+        dn->budgetUs   = usPerFrame > 0 ? usPerFrame : 0;
+        dn->bypassLeft = 0;
+        dn->stat.bOverBudget = NO;
+    }
+}
+
+int ksy_denoise_latency(const KSYAudioDenoise* dn) {
+    // 一帧的数据要等下一帧收集完才能重叠相加完成, 再在之后的一帧中输出
+    return dn ? 2 * dn->hop : 0;
+}
+
+void ksy_denoise_get_stat(const KSYAudioDenoise* dn, KSYDenoiseStat* stat) {
+    if (dn && stat) {
+        *stat = dn->stat;
+    }
+}
+
+void ksy_denoise_reset(KSYAudioDenoise* dn) {
+    if (dn == NULL) {
+        return;
+    }
+    for (int c = 0; c < dn->chCnt; ++c) {
+        memset(dn->in[c],   0, sizeof(float) * dn->hop);
+        memset(dn->prev[c], 0, sizeof(float) * dn->hop);
+        memset(dn->out[c],  0, sizeof(float) * dn->hop);
+        memset(dn->ola[c],  0, sizeof(float) * dn->hop);
+    }
+    memset(dn->smooth, 0, sizeof(float) * dn->nbBin);
+    memset(dn->noise,  0, sizeof(float) * dn->nbBin);
+    memset(dn->clean,  0, sizeof(float) * dn->nbBin);
+    for (int k = 0; k < dn->nbBin; ++k) {
+        dn->gain[k] = 1.0f;
+    }
+    dn->fill       = 0;
+    dn->nbAnalyzed = 0;
+    dn->bypassLeft = 0;
+    dn->bRetry     = YES;
+    memset(&dn->stat, 0, sizeof(KSYDenoiseStat));
+    dn->stat.noiseDb = -120.0f;
+}
+
+// 更新噪声估计并计算每个频点的增益
+static void updateGain(KSYAudioDenoise* dn) {
+    const int nb = dn->nbBin;
+    float * P = dn->power;
+    float * S = dn->smooth;
+    float * N = dn->noise;
+    float sumP = 0, sumC = 0, sumN = 0;
+    if (dn->nbAnalyzed == 0) {
+        memcpy(S, P, sizeof(float) * nb);
+    }
+    for (int k = 0; k < nb; ++k) {
+        S[k] = DN_PSD_SMOOTH * S[k] + (1.0f - DN_PSD_SMOOTH) * P[k];
+        if (dn->nbAnalyzed < DN_INIT_FRAMES) {
+            N[k] += (S[k] - N[k]) / (dn->nbAnalyzed + 1);
+        }
+        else {
+            float up = N[k] * dn->rise;
+            N[k] = S[k] < up ? S[k] : up;
+        }
+        float noise = DN_MIN_BIAS * N[k] + DN_EPS;
+        float post  = P[k] / noise;
+        float ml    = post > 1.0f ? post - 1.0f : 0.0f;
+        float prio  = DN_DD_ALPHA * dn->clean[k] / noise + (1.0f - DN_DD_ALPHA) * ml;
+        float g     = prio / (prio + dn->overSub);
+        if (g < dn->floorGain) {
+            g = dn->floorGain;
+        }
+        dn->gain[k]  = g;
+        dn->clean[k] = g * g * P[k];
+        sumP += P[k];
+        sumC += dn->clean[k];
+        sumN += noise;
+    }
+    if (dn->nbAnalyzed < DN_INIT_FRAMES) {
+        ++dn->nbAnalyzed;
+    }
+    dn->stat.noiseDb     = 10.0f * log10f(sumN / nb / dn->winEnergy + DN_EPS);
+    dn->stat.reductionDb = sumP > DN_EPS ? 10.0f * log10f(sumC / sumP + DN_EPS) : 0.0f;
+}
+
+// 分析 [prev, in] 两帧, 输出 prev 对应的一帧
+static void processFrame(KSYAudioDenoise* dn) {
+    const int hop = dn->hop, len = 2 * hop, nb = dn->nbBin, ch = dn->chCnt;
+    const float * w = dn->win;
+    if (dn->level == KSYDenoiseLevel_Off || dn->bypassLeft > 0) {
+        // 直通: 即增益为1时的重叠相加, 与降噪的结果之间切换时不会跳变
+        for (int c = 0; c < ch; ++c) {
+            for (int i = 0; i < hop; ++i) {
+                dn->out[c][i] = dn->ola[c][i] + w[i] * w[i] * dn->prev[c][i];
+                dn->ola[c][i] = w[hop+i] * w[hop+i] * dn->in[c][i];
+            }
+        }
+        if (dn->bypassLeft > 0 && --dn->bypassLeft == 0) {
+            dn->bRetry = YES;
+        }
+        dn->stat.reductionDb = 0;
+        dn->stat.nbSkipped  += dn->level != KSYDenoiseLevel_Off;
+        return;
+    }
+    double t0 = nowUs();
+    memset(dn->power, 0, sizeof(float) * nb);
+    for (int c = 0; c < ch; ++c) {
+        float * x = dn->spec[c];
+        for (int i = 0; i < hop; ++i) {
+            x[i]     = dn->prev[c][i] * w[i];
+            x[hop+i] = dn->in[c][i] * w[hop+i];
+        }
+        memset(x + len, 0, sizeof(float) * (dn->nfft - len));
+        ksy_fft_forward(dn->fft, x, x);
+        for (int k = 0; k < nb; ++k) {
+            dn->power[k] += x[2*k] * x[2*k] + x[2*k+1] * x[2*k+1];
+        }
+    }
+    if (ch > 1) {
+        for (int k = 0; k < nb; ++k) {
+            dn->power[k] *= 1.0f / ch;
+        }
+    }
+    updateGain(dn);
+    for (int c = 0; c < ch; ++c) {
+        float * x = dn->spec[c];
+        for (int k = 0; k < nb; ++k) {
+            x[2*k]   *= dn->gain[k];
+            x[2*k+1] *= dn->gain[k];
+        }
+        ksy_fft_inverse(dn->fft, x, x);
+        for (int i = 0; i < hop; ++i) {
+            dn->out[c][i] = dn->ola[c][i] + x[i] * w[i];
+            dn->ola[c][i] = x[hop+i] * w[hop+i];
+        }
+    }
+    // 统计耗时, 平均值超出预算时直通一段时间
+    float us = (float)(nowUs() - t0);
+    KSYDenoiseStat * st = &dn->stat;
+    st->lastUs = us;
+    st->maxUs  = us > st->maxUs ? us : st->maxUs;
+    if (dn->bRetry) {
+        st->avgUs  = us;
+        dn->bRetry = NO;
+    }
+    else {
+        st->avgUs += 0.05f * (us - st->avgUs);
+    }
+    st->bOverBudget = dn->budgetUs > 0 && st->avgUs > dn->budgetUs;
+    if (st->bOverBudget) {
+        dn->bypassLeft = DN_RETRY_FRAMES;
+    }
+}
+
+void ksy_denoise_process_f32(KSYAudioDenoise* dn, float* pcm, int nbFrame) {
+    if (dn == NULL || pcm == NULL) {
+        return;
+    }
+    const int ch = dn->chCnt, hop = dn->hop;
+    while (nbFrame > 0) {
+        int n = hop - dn->fill;
+        n = nbFrame < n ? nbFrame : n;
+        for (int c = 0; c < ch; ++c) {
+            float * in  = dn->in[c] + dn->fill;
+            float * out = dn->out[c] + dn->fill;
+            for (int i = 0; i < n; ++i) {
+                in[i]          = pcm[i*ch + c];
+                pcm[i*ch + c]  = out[i];
+            }
+        }
+        dn->fill += n;
+        pcm      += n * ch;
+        nbFrame  -= n;
+        if (dn->fill == hop) {
+            processFrame(dn);
+            for (int c = 0; c < ch; ++c) {
+                float * t   = dn->prev[c];
+                dn->prev[c] = dn->in[c];
+                dn->in[c]   = t;
+            }
+            dn->fill = 0;
+            dn->stat.nbFrame++;
+        }
+    }
+}
+
+void ksy_denoise_process_s16(KSYAudioDenoise* dn, int16_t* pcm, int nbFrame) {
+    if (dn == NULL || pcm == NULL) {
+        return;
+    }
+    const int ch = dn->chCnt;
+    while (nbFrame > 0) {
+        int n  = nbFrame < DN_IO ? nbFrame : DN_IO;
+        int ns = n * ch;
+        ksy_s16_to_f32(dn->io, pcm, ns);
+        ksy_denoise_process_f32(dn, dn->io, n);
+        ksy_f32_to_s16(pcm, dn->io, ns);
+        pcm     += ns;
+        nbFrame -= n;
+    }
+}
@@ -0,0 +1,69 @@
+//
+//  KSYAudioDrift.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** 音轨间的时钟漂移估计
+
+ 非主轨(背景音乐/画中画)与主轨(麦克风)的时钟不同源, 长时间推流后缓冲会慢慢堆积或者耗尽.
+ 本模块估计二者的速率比, 用于微调非主轨的重采样比例, 使缓冲长度稳定在目标值附近
+
+ 1. 生产者线程: 用输入数据的时间戳估计输入的实际速率 (前馈部分)
+ 2. 主轨线程: 根据缓冲长度与目标值的偏差, 用PI控制器修正剩余的误差 (反馈部分)
+ 3. 调整量限制在 ±0.5% 以内, 听感上无法察觉
+ 4. 返回的比例 >1 表示输入偏快, 重采样时应多消耗输入数据
+ */
+typedef struct _KSYAudioDrift KSYAudioDrift;
+
+/// 最大调整比例
+#define KSY_DRIFT_MAX_ADJ  0.005
+
+/**
+ @abstract  创建漂移估计器
+ @param     targetFrames 缓冲长度的目标值 (帧)
+ @param     rate         缓冲中数据的采样率
+ */
+KSYAudioDrift* ksy_drift_create(int targetFrames, int rate);
+
+/**
+ @abstract  销毁
+ */
+void ksy_drift_destroy(KSYAudioDrift* drift);
+
+/**
+ @abstract  输入了一段数据 (生产者线程)
+ @param     nbFrame 帧数 (按输入的标称采样率)
+ @param     inRate  输入的标称采样率
+ @param     ptsSec  这段数据的时间戳(秒), 无效时传 NAN
+ @discussion 时间戳不连续 (seek/切歌) 时自动重新开始估计
+ */
+void ksy_drift_input(KSYAudioDrift* drift, int nbFrame, int inRate, double ptsSec);
+
+/**
+ @abstract  从缓冲中取出了一段数据 (主轨线程)
+ @param     fill    取数据之前缓冲中的帧数
+ @param     nbFrame 本次取出的帧数
+ @param     bUnderrun 缓冲中的数据是否不足
+ */
+void ksy_drift_output(KSYAudioDrift* drift, int fill, int nbFrame, BOOL bUnderrun);
+
+/**
+ @abstract  当前估计的速率比 (任意线程)
+ @return    用于乘以重采样步长的比例, 范围为 1 ± KSY_DRIFT_MAX_ADJ
+ */
+double ksy_drift_ratio(const KSYAudioDrift* drift);
+
+/**
+ @abstract  平滑后的缓冲长度 (帧, 任意线程)
+ */
+double ksy_drift_fill(const KSYAudioDrift* drift);
+
+/**
+ @abstract  清空反馈部分的状态 (主轨线程, 如清空缓冲后)
+ */
+void ksy_drift_reset(KSYAudioDrift* drift);
@@ -0,0 +1,136 @@
+//
+//  KSYAudioDrift.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioDrift.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define DRIFT_CACHE_LINE  128
+// 缓冲长度的平滑时间常数 (秒)
+#define DRIFT_FILL_TAU    0.5
+// PI控制器, 误差以秒为单位: 自然频率约0.05rad/s, 阻尼约0.8
+#define DRIFT_KP          0.08
+#define DRIFT_KI          0.0025
+// 时间戳估计速率所需的最短时长 (秒)
+#define DRIFT_FF_MIN_SEC  10.0
+// 时间戳跳变超过此值时重新估计 (秒)
+#define DRIFT_FF_JUMP_SEC 0.2
+
+struct _KSYAudioDrift {
+    // 生产者独占
+    _Alignas(DRIFT_CACHE_LINE) double ptsStart;
+    double          ptsNext;    // 下一段数据期望的时间戳
+    double          framesIn;   // 从 ptsStart 开始输入的帧数
+    _Atomic double  ffRatio;
+    // 主轨线程独占
+    _Alignas(DRIFT_CACHE_LINE) double fillAvg;
+    double          integ;
+    BOOL            bInit;
+    _Atomic double  piAdj;
+    _Atomic double  fillOut;
+    // 只读
+    _Alignas(DRIFT_CACHE_LINE) int target;
+    int             rate;
+};
+
+static inline double clampAdj(double v) {
+    return v > KSY_DRIFT_MAX_ADJ ? KSY_DRIFT_MAX_ADJ :
+          (v < -KSY_DRIFT_MAX_ADJ ? -KSY_DRIFT_MAX_ADJ : v);
+}
+
+KSYAudioDrift* ksy_drift_create(int targetFrames, int rate) {
+    if (targetFrames <= 0 || rate <= 0) {
+        return NULL;
+    }
+    KSYAudioDrift* d = NULL;
+    if (posix_memalign((void**)&d, DRIFT_CACHE_LINE, sizeof(KSYAudioDrift))) {
+        return NULL;
+    }
+    d->target   = targetFrames;
+    d->rate     = rate;
+    d->ptsStart = NAN;
+    d->ptsNext  = NAN;
+    d->framesIn = 0;
+    atomic_init(&d->ffRatio, 1.0);
+    atomic_init(&d->piAdj,   0.0);
+    atomic_init(&d->fillOut, 0.0);
+    ksy_drift_reset(d);
+    return d;
+}
+
+void ksy_drift_destroy(KSYAudioDrift* drift) {
+    free(drift);
+}
+
+void ksy_drift_input(KSYAudioDrift* d, int nbFrame, int inRate, double ptsSec) {
+    if (d == NULL || nbFrame <= 0 || inRate <= 0 || isnan(ptsSec)) {
+        return;
+    }
+    if (isnan(d->ptsStart) || fabs(ptsSec - d->ptsNext) > DRIFT_FF_JUMP_SEC) {
+        d->ptsStart = ptsSec; // 首次输入或时间戳不连续
+        d->framesIn = 0;
+    }
+    double elapsed = ptsSec - d->ptsStart;
+    if (elapsed >= DRIFT_FF_MIN_SEC) {
+        // 时间戳走过elapsed秒时实际输入的帧数, 与标称采样率相比
+        double ratio = d->framesIn / elapsed / inRate;
+        atomic_store_explicit(&d->ffRatio, 1.0 + clampAdj(ratio - 1.0),
+                              memory_order_relaxed);
+    }
+    d->framesIn += nbFrame;
+    d->ptsNext   = ptsSec + (double)nbFrame / inRate;
+}
+
+void ksy_drift_output(KSYAudioDrift* d, int fill, int nbFrame, BOOL bUnderrun) {
+    if (d == NULL || nbFrame <= 0) {
+        return;
+    }
+    double dt = (double)nbFrame / d->rate;
+    if (!d->bInit) {
+        d->fillAvg = fill;
+        d->bInit   = YES;
+    }
+    double a = dt / DRIFT_FILL_TAU;
+    d->fillAvg += (fill - d->fillAvg) * (a > 1.0 ? 1.0 : a);
+    atomic_store_explicit(&d->fillOut, d->fillAvg, memory_order_relaxed);
+    if (bUnderrun) { // 输入中断时冻结积分, 避免积分饱和
+        return;
+    }
+    double err = (d->fillAvg - d->target) / d->rate; // 秒
+    d->integ = clampAdj(d->integ + DRIFT_KI * err * dt);
+    atomic_store_explicit(&d->piAdj, clampAdj(DRIFT_KP * err + d->integ),
+                          memory_order_relaxed);
+}
+
+double ksy_drift_ratio(const KSYAudioDrift* d) {
+    if (d == NULL) {
+        return 1.0;
+    }
+    KSYAudioDrift* dd = (KSYAudioDrift*)d;
+    double ff = atomic_load_explicit(&dd->ffRatio, memory_order_relaxed);
+    double pi = atomic_load_explicit(&dd->piAdj,   memory_order_relaxed);
+    return 1.0 + clampAdj(ff * (1.0 + pi) - 1.0);
+}
+
+double ksy_drift_fill(const KSYAudioDrift* d) {
+    if (d == NULL) {
+        return 0;
+    }
+    return atomic_load_explicit(&((KSYAudioDrift*)d)->fillOut, memory_order_relaxed);
+}
+
+void ksy_drift_reset(KSYAudioDrift* d) {
+    if (d == NULL) {
+        return;
+    }
+    d->bInit   = NO;
+    d->fillAvg = 0;
+    d->integ   = 0;
+    atomic_store_explicit(&d->piAdj, 0.0, memory_order_relaxed);
+}
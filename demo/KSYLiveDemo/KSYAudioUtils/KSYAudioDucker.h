@@ -0,0 +1,78 @@
+//
+//  KSYAudioDucker.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <CoreMedia/CoreMedia.h>
+
+/** 自动闪避: 主播说话时自动压低背景音乐
+
+ 1. 主轨线程(麦克风回调)先调用 processMainTrack: 分析人声, 得到本段的增益曲线
+ 2. 被闪避的 KSYAudioTrackBuffer 设置 ducker 属性后, 在 feedMixer: 中
+    把增益曲线原地应用到即将送入混音器的数据上, 不额外拷贝数据
+ 3. 参数可以在任意线程修改, 下一段主轨数据开始生效
+ */
+@interface KSYAudioDucker : NSObject
+
+/**
+ @abstract  增益下降的时间常数 (毫秒), 默认为10
+ */
+@property (atomic, assign) float attackMs;
+
+/**
+ @abstract  增益恢复的时间常数 (毫秒), 默认为400
+ */
+@property (atomic, assign) float releaseMs;
+
+/**
+ @abstract  人声停止后保持衰减的时长 (毫秒), 默认为300
+ */
+@property (atomic, assign) float holdMs;
+
+/**
+ @abstract  有人声时的增益 (dB), 默认为 -12
+ */
+@property (atomic, assign) float depthDb;
+
+/**
+ @abstract  人声的判定门限 (dBFS), 默认为 -36
+ */
+@property (atomic, assign) float thresholdDb;
+
+/**
+ @abstract  分析主轨数据 (主轨线程, 在各track的 feedMixer: 之前调用)
+ @param     sampleBuffer 主轨数据 (S16交织)
+ @return    NO 表示数据格式不支持, 沿用上一段的增益
+ */
+- (BOOL) processMainTrack:(CMSampleBufferRef)sampleBuffer;
+
+/**
+ @abstract  把本段的增益曲线应用到被闪避的数据上 (主轨线程)
+ @param     pcm     S16 交织数据, 原地修改, 时长应与本段主轨数据相同
+ @param     nbFrame 帧数
+ @param     chCnt   声道数
+ */
+- (void) applyGain:(int16_t*)pcm
+           nbFrame:(int)nbFrame
+             chCnt:(int)chCnt;
+
+/**
+ @abstract  当前的增益 (dB, 任意线程)
+ */
+@property (nonatomic, readonly) float gainDb;
+
+/**
+ @abstract  当前是否判定为有人声 (任意线程)
+ */
+@property (nonatomic, readonly) BOOL bVoice;
+
+/**
+ @abstract  清空状态, 增益回到0dB (主轨线程)
+ */
+- (void) reset;
+
+@end
@@ -0,0 +1,106 @@
+//
+//  KSYAudioDucker.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioDucker.h"
+#import "KSYAudioSidechain.h"
+#include <stdatomic.h>
+
+@interface KSYAudioDucker () {
+    // 主轨线程使用
+    KSYAudioSidechain * _sc;
+    int                 _scRate;
+    // 读数
+    _Atomic float       _gainOut;
+    atomic_bool         _voiceOut;
+}
+@end
+
+@implementation KSYAudioDucker
+
+- (instancetype) init {
+    self = [super init];
+    if (self == nil) {
+        return nil;
+    }
+    _attackMs    = 10.0f;
+    _releaseMs   = 400.0f;
+    _holdMs      = 300.0f;
+    _depthDb     = -12.0f;
+    _thresholdDb = -36.0f;
+    atomic_init(&_gainOut, 0.0f);
+    atomic_init(&_voiceOut, NO);
+    return self;
+}
+
+- (void) dealloc {
+    ksy_sidechain_destroy(_sc);
+}
+
+- (BOOL) processMainTrack:(CMSampleBufferRef)sampleBuffer {
+    if (sampleBuffer == NULL) {
+        return NO;
+    }
+    CMFormatDescriptionRef desc = CMSampleBufferGetFormatDescription(sampleBuffer);
+    const AudioStreamBasicDescription * asbd = desc ?
+        CMAudioFormatDescriptionGetStreamBasicDescription(desc) : NULL;
+    if (asbd == NULL || asbd->mFormatID != kAudioFormatLinearPCM ||
+        asbd->mBitsPerChannel != 16 || asbd->mSampleRate <= 0 ||
+        !(asbd->mFormatFlags & kAudioFormatFlagIsSignedInteger) ||
+        (asbd->mFormatFlags & kAudioFormatFlagIsNonInterleaved)) {
+        return NO;
+    }
+    int rate = (int)asbd->mSampleRate;
+    if (_sc == NULL || rate != _scRate) {
+        ksy_sidechain_destroy(_sc);
+        _sc     = ksy_sidechain_create(rate);
+        _scRate = rate;
+        if (_sc == NULL) {
+            return NO;
+        }
+    }
+    KSYDuckParam param = { self.attackMs, self.releaseMs, self.holdMs,
+                           self.depthDb, self.thresholdDb };
+    ksy_sidechain_set_param(_sc, &param);
+
+    CMBlockBufferRef block = CMSampleBufferGetDataBuffer(sampleBuffer);
+    size_t len = 0;
+    char * data = NULL;
+    int nbFrame = (int)CMSampleBufferGetNumSamples(sampleBuffer);
+    if (block == NULL ||
+        CMBlockBufferGetDataPointer(block, 0, NULL, &len, &data) != kCMBlockBufferNoErr ||
+        len < (size_t)nbFrame * asbd->mBytesPerFrame) {
+        return NO;
+    }
+    ksy_sidechain_analyze_s16(_sc, (const int16_t*)data, nbFrame,
+                              (int)asbd->mChannelsPerFrame);
+    atomic_store(&_gainOut, ksy_sidechain_gain_db(_sc));
+    atomic_store(&_voiceOut, ksy_sidechain_active(_sc));
+    return YES;
+}
+
+- (void) applyGain:(int16_t*)pcm
+           nbFrame:(int)nbFrame
+             chCnt:(int)chCnt {
+    ksy_sidechain_apply_s16(_sc, pcm, nbFrame, chCnt);
+}
+
+- (float) gainDb {
+    return atomic_load(&_gainOut);
+}
+
+- (BOOL) bVoice {
+    return atomic_load(&_voiceOut);
+}
+
+- (void) reset {
+    ksy_sidechain_reset(_sc);
+    atomic_store(&_gainOut, 0.0f);
+    atomic_store(&_voiceOut, NO);
+}
+
+@end
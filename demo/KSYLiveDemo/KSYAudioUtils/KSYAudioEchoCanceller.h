@@ -0,0 +1,98 @@
+//
+//  KSYAudioEchoCanceller.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <CoreMedia/CoreMedia.h>
+#import "KSYAudioAec.h"
+#import "KSYAudioRing.h"
+
+/// 远端参考的最大路数 (如背景音乐 + 画中画播放器)
+#define KSY_AEC_MAX_FAR 2
+
+/** 麦克风回声消除 (基于 KSYAudioAec)
+
+ 用扬声器外放背景音乐/画中画时, 麦克风会再次采集到播放的声音, 混音后听众会听到两遍;
+ 以播放的数据为远端参考, 从麦克风数据中减去估计的回声
+
+ 1. 播放器的 audioDataBlock 中调用 processFarEnd:of: 送入远端参考,
+    转换为单声道并重采样到麦克风的采样率后存入各路的无锁环形缓冲
+ 2. 麦克风的 audioProcessingCallback 中, 在降噪和其他效果之前调用 processAudioSampleBuffer:
+    按麦克风数据的长度从各路缓冲中取出数据相加作为参考, 欠载部分补零
+ 3. 参考缓冲堆积超过 maxLagMs 时丢弃多余的数据, 使参考与麦克风的相对延迟保持在滤波器尾长之内
+ 4. 麦克风须为单声道, S16或float交织数据; 采样率变化时自动重建
+ 5. 输出延迟 latencyMs (一个块长, 约12ms)
+ */
+@interface KSYAudioEchoCanceller : NSObject
+
+/**
+ @abstract  初始化
+ @param     tailMs 回声尾长 (毫秒, 20~500), 越长计算量越大
+ */
+- (instancetype) initWithTailMs:(int)tailMs;
+
+/**
+ @abstract  回声尾长 (毫秒), init 时默认为150
+ */
+@property (nonatomic, readonly) int tailMs;
+
+/**
+ @abstract  参考缓冲允许堆积的最大时长 (毫秒), 默认为60, 任意线程设置
+ */
+@property (atomic, assign) int maxLagMs;
+
+/**
+ @abstract  输入远端参考 (各路的生产者线程)
+ @param     sampleBuffer 播放的音频数据, 支持S16或float, 交织或平面格式
+ @param     idx          参考的路号 (0 ~ KSY_AEC_MAX_FAR-1), 同一路须在同一线程送入
+ @return    NO 表示数据格式不支持或缓冲已满
+ */
+- (BOOL) processFarEnd:(CMSampleBufferRef)sampleBuffer
+                    of:(int)idx;
+
+/**
+ @abstract  处理麦克风数据 (原地修改, 麦克风线程)
+ @return    NO 表示格式不支持 (非单声道/平面格式等), 数据未修改
+ */
+- (BOOL) processAudioSampleBuffer:(CMSampleBufferRef)sampleBuffer;
+
+/**
+ @abstract  清空滤波器和参考缓冲 (麦克风线程), 如切换扬声器和耳机之后
+ */
+- (void) reset;
+
+/**
+ @abstract  引入的延迟 (毫秒, 任意线程)
+ */
+@property (nonatomic, readonly) float latencyMs;
+
+/**
+ @abstract  回声衰减量 ERLE (dB, 任意线程)
+ */
+@property (nonatomic, readonly) float erleDb;
+
+/**
+ @abstract  是否已初步收敛 (任意线程)
+ */
+@property (nonatomic, readonly) BOOL bAdapted;
+
+/**
+ @abstract  平均每块的处理耗时 (微秒, 任意线程)
+ */
+@property (nonatomic, readonly) float avgBlockUs;
+
+/**
+ @abstract  参考缓冲堆积过多而丢弃数据的次数 (任意线程)
+ */
+@property (nonatomic, readonly) int resyncCnt;
+
+/**
+ @abstract  第idx路参考缓冲的统计信息 (任意线程)
+ */
+- (KSYAudioRingStat) farStatOf:(int)idx;
+
+@end
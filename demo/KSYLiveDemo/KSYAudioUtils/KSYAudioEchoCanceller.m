@@ -0,0 +1,349 @@
+//
+//  KSYAudioEchoCanceller.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioEchoCanceller.h"
+#import "KSYAudioConvert.h"
+#import "KSYAudioResampler.h"
+#import "KSYAudioKernel.h"
+#include <stdatomic.h>
+
+#define AEC_FAR_RING_MS   500
+#define AEC_DEFAULT_RATE  44100
+
+// 一路远端参考, 除 ring 外只在该路的生产者线程使用
+typedef struct {
+    KSYAudioRing *      ring;   // 单声道float, 麦克风的采样率
+    KSYAudioResampler * rs;
+    int                 rsInRate;
+    int                 rsOutRate;
+    float               mat[KSY_AUDIO_MAX_CH];
+    int                 matSrcCh;
+    float *             flt;
+    int                 fltCap;
+    float *             rsBuf;
+    int                 rsCap;
+} KSYAecFar;
+
+@interface KSYAudioEchoCanceller () {
+    KSYAecFar           _far[KSY_AEC_MAX_FAR];
+    atomic_int          _farRate;   // 参考需要重采样到的采样率 (麦克风的采样率)
+    // 麦克风线程使用
+    KSYAudioAec *       _aec;
+    int                 _rate;
+    float *             _farBuf;
+    int                 _farCap;
+    float *             _tmpBuf;
+    int                 _tmpCap;
+    float *             _micBuf;
+    int                 _micCap;
+    // 麦克风线程写入, 任意线程读取
+    _Atomic float       _latencyMs;
+    _Atomic float       _erleDb;
+    _Atomic float       _avgUs;
+    atomic_bool         _adapted;
+    atomic_int          _resyncCnt;
+}
+@end
+
+@implementation KSYAudioEchoCanceller
+
+- (instancetype) init {
+    return [self initWithTailMs:150];
+}
+
+- (instancetype) initWithTailMs:(int)tailMs {
+    self = [super init];
+    if (self == nil || tailMs < 20 || tailMs > 500) {
+        return nil;
+    }
+    _tailMs   = tailMs;
+    _maxLagMs = 60;
+    for (int i = 0; i < KSY_AEC_MAX_FAR; ++i) {
+        _far[i].ring = ksy_ring_create(48000 * AEC_FAR_RING_MS / 1000, sizeof(float));
+        if (_far[i].ring == NULL) {
+            return nil;
+        }
+    }
+    atomic_init(&_farRate, AEC_DEFAULT_RATE);
+    atomic_init(&_latencyMs, 0);
+    atomic_init(&_erleDb, 0);
+    atomic_init(&_avgUs, 0);
+    atomic_init(&_adapted, NO);
+    atomic_init(&_resyncCnt, 0);
+    return self;
+}
+
+- (void) dealloc {
+    for (int i = 0; i < KSY_AEC_MAX_FAR; ++i) {
+        ksy_ring_destroy(_far[i].ring);
+        ksy_resampler_destroy(_far[i].rs);
+        free(_far[i].flt);
+        free(_far[i].rsBuf);
+    }
+    ksy_aec_destroy(_aec);
+    free(_farBuf);
+    free(_tmpBuf);
+    free(_micBuf);
+}
+
+static BOOL growBuf(float ** buf, int * cap, int nbFrame) {
+    if (nbFrame <= *cap) {
+        return YES;
+    }
+    float * p = realloc(*buf, sizeof(float) * nbFrame);
+    if (p == NULL) {
+        return NO;
+    }
+    *buf = p;
+    *cap = nbFrame;
+    return YES;
+}
+
+#pragma mark - far end
+- (BOOL) processFarEnd:(CMSampleBufferRef)sampleBuffer
+                    of:(int)idx {
+    if (sampleBuffer == NULL || idx < 0 || idx >= KSY_AEC_MAX_FAR) {
+        return NO;
+    }
+    CMFormatDescriptionRef desc = CMSampleBufferGetFormatDescription(sampleBuffer);
+    const AudioStreamBasicDescription * asbd = desc ?
+        CMAudioFormatDescriptionGetStreamBasicDescription(desc) : NULL;
+    if (asbd == NULL || asbd->mFormatID != kAudioFormatLinearPCM) {
+        return NO;
+    }
+    BOOL bFloat  = (asbd->mFormatFlags & kAudioFormatFlagIsFloat) != 0;
+    BOOL bPlanar = (asbd->mFormatFlags & kAudioFormatFlagIsNonInterleaved) != 0;
+    int sampleFmt = bFloat ? (bPlanar ? KSYSampleFmt_FLTP : KSYSampleFmt_FLT)
+                           : (bPlanar ? KSYSampleFmt_S16P : KSYSampleFmt_S16);
+    int chCnt  = (int)asbd->mChannelsPerFrame;
+    int inRate = (int)asbd->mSampleRate;
+    if ((int)asbd->mBitsPerChannel / 8 != ksy_sample_fmt_size(sampleFmt) ||
+        chCnt <= 0 || chCnt > KSY_AUDIO_MAX_CH || inRate <= 0) {
+        return NO;
+    }
+    struct {
+        AudioBufferList abl;
+        AudioBuffer     more[KSY_AUDIO_MAX_CH-1];
+    } bufList;
+    CMBlockBufferRef block = NULL;
+    OSStatus ret = CMSampleBufferGetAudioBufferListWithRetainedBlockBuffer
+    (sampleBuffer, NULL, &bufList.abl, sizeof(bufList), NULL, NULL,
+     kCMSampleBufferFlag_AudioBufferList_Assure16ByteAlignment, &block);
+    if (ret != noErr) {
+        return NO;
+    }
+    const uint8_t * planes[KSY_AUDIO_MAX_CH] = {0};
+    int nbPlane = bPlanar ? chCnt : 1;
+    BOOL bOK = (int)bufList.abl.mNumberBuffers >= nbPlane;
+    for (int i = 0; bOK && i < nbPlane; ++i) {
+        planes[i] = bufList.abl.mBuffers[i].mData;
+        bOK = planes[i] != NULL;
+    }
+    if (bOK) {
+        bOK = [self writeFar:&_far[idx]
+                        data:planes
+                         fmt:sampleFmt
+                       chCnt:chCnt
+                        rate:inRate
+                     nbFrame:(int)CMSampleBufferGetNumSamples(sampleBuffer)];
+    }
+    CFRelease(block);
+    return bOK;
+}
+
+// 生产者线程: 转为单声道float, 重采样到麦克风的采样率后写入缓冲
+- (BOOL) writeFar:(KSYAecFar*)far
+             data:(const uint8_t* const*)data
+              fmt:(int)fmt
+            chCnt:(int)chCnt
+             rate:(int)inRate
+          nbFrame:(int)len {
+    if (len <= 0) {
+        return YES;
+    }
+    if (chCnt != far->matSrcCh) {
+        ksy_audio_channel_matrix(far->mat, 1, chCnt, NULL, 0);
+        far->matSrcCh = chCnt;
+    }
+    if (!growBuf(&far->flt, &far->fltCap, len)) {
+        return NO;
+    }
+    uint8_t * flt[1] = { (uint8_t*)far->flt };
+    if (ksy_audio_convert(flt, KSYSampleFmt_FLT, 1, data, fmt, chCnt, far->mat, len) != 0) {
+        return NO;
+    }
+    int outRate = atomic_load(&_farRate);
+    if (inRate == outRate) {
+        return ksy_ring_write(far->ring, far->flt, len) == len;
+    }
+    if (far->rs == NULL || inRate != far->rsInRate || outRate != far->rsOutRate) {
+        ksy_resampler_destroy(far->rs);
+        far->rs = ksy_resampler_create(inRate, outRate, 1, KSYResampleQuality_Low);
+        far->rsInRate  = inRate;
+        far->rsOutRate = outRate;
+        if (far->rs == NULL) {
+            return NO;
+        }
+    }
+    int maxOut = ksy_resampler_max_out(far->rs, len);
+    if (!growBuf(&far->rsBuf, &far->rsCap, maxOut)) {
+        return NO;
+    }
+    int nbOut = ksy_resampler_process(far->rs, far->flt, len, far->rsBuf, maxOut);
+    if (nbOut <= 0) {
+        return YES;
+    }
+    return ksy_ring_write(far->ring, far->rsBuf, nbOut) == nbOut;
+}
+
+#pragma mark - mic
+// 麦克风线程: 采样率变化时重建, 并清空按旧采样率缓存的参考
+- (BOOL) prepare:(int)rate {
+    if (_aec && rate == _rate) {
+        return YES;
+    }
+    ksy_aec_destroy(_aec);
+    _aec  = ksy_aec_create(rate, _tailMs);
+    _rate = rate;
+    if (_aec == NULL) {
+        return NO;
+    }
+    atomic_store(&_farRate, rate);
+    for (int i = 0; i < KSY_AEC_MAX_FAR; ++i) {
+        ksy_ring_flush(_far[i].ring);
+    }
+    atomic_store(&_latencyMs, ksy_aec_block_size(_aec) * 1000.0f / rate);
+    return YES;
+}
+
+// 麦克风线程: 取出 n 帧各路参考之和, 欠载部分为静音; 返回 NO 表示所有参考都没有数据
+- (BOOL) readFar:(int)n {
+    int maxLag = (int)((int64_t)_rate * self.maxLagMs / 1000);
+    BOOL bHasFar = NO;
+    memset(_farBuf, 0, sizeof(float) * n);
+    for (int i = 0; i < KSY_AEC_MAX_FAR; ++i) {
+        KSYAudioRing * ring = _far[i].ring;
+        int fill = ksy_ring_fill(ring);
+        if (fill <= 0) {
+            continue;
+        }
+        // 堆积过多: 丢弃最旧的数据, 使参考与麦克风的相对延迟回到尾长之内
+        int excess = fill - n - maxLag;
+        if (excess > 0) {
+            while (excess > 0) {
+                int m = excess < n ? excess : n;
+                excess -= ksy_ring_read(ring, _tmpBuf, m);
+            }
+            atomic_fetch_add(&_resyncCnt, 1);
+        }
+        int got = ksy_ring_read(ring, _tmpBuf, n);
+        for (int k = 0; k < got; ++k) {
+            _farBuf[k] += _tmpBuf[k];
+        }
+        bHasFar = YES;
+    }
+    return bHasFar;
+}
+
+- (BOOL) processF32:(float*)pcm
+            nbFrame:(int)nbFrame
+               rate:(int)rate {
+    if (pcm == NULL || nbFrame <= 0 || ![self prepare:rate] ||
+        !growBuf(&_farBuf, &_farCap, nbFrame) ||
+        !growBuf(&_tmpBuf, &_tmpCap, nbFrame)) {
+        return NO;
+    }
+    BOOL bHasFar = [self readFar:nbFrame];
+    ksy_aec_process_f32(_aec, bHasFar ? _farBuf : NULL, pcm, nbFrame);
+    KSYAecStat st;
+    ksy_aec_get_stat(_aec, &st);
+    atomic_store_explicit(&_erleDb, st.erleDb, memory_order_relaxed);
+    atomic_store_explicit(&_avgUs, st.avgUs, memory_order_relaxed);
+    atomic_store_explicit(&_adapted, st.bAdapted, memory_order_relaxed);
+    return YES;
+}
+
+- (BOOL) processAudioSampleBuffer:(CMSampleBufferRef)sampleBuffer {
+    if (sampleBuffer == NULL) {
+        return NO;
+    }
+    CMFormatDescriptionRef desc = CMSampleBufferGetFormatDescription(sampleBuffer);
+    const AudioStreamBasicDescription * asbd = desc ?
+        CMAudioFormatDescriptionGetStreamBasicDescription(desc) : NULL;
+    if (asbd == NULL || asbd->mFormatID != kAudioFormatLinearPCM ||
+        asbd->mChannelsPerFrame != 1) {
+        return NO;
+    }
+    BOOL bFloat = (asbd->mFormatFlags & kAudioFormatFlagIsFloat) != 0;
+    if ((bFloat && asbd->mBitsPerChannel != 32) ||
+        (!bFloat && asbd->mBitsPerChannel != 16)) {
+        return NO;
+    }
+    CMBlockBufferRef block = CMSampleBufferGetDataBuffer(sampleBuffer);
+    size_t len = 0;
+    char * data = NULL;
+    int nbFrame = (int)CMSampleBufferGetNumSamples(sampleBuffer);
+    if (block == NULL ||
+        CMBlockBufferGetDataPointer(block, 0, NULL, &len, &data) != kCMBlockBufferNoErr ||
+        len < (size_t)nbFrame * asbd->mBytesPerFrame) {
+        return NO;
+    }
+    int rate = (int)asbd->mSampleRate;
+    if (bFloat) {
+        return [self processF32:(float*)data nbFrame:nbFrame rate:rate];
+    }
+    if (!growBuf(&_micBuf, &_micCap, nbFrame)) {
+        return NO;
+    }
+    ksy_s16_to_f32(_micBuf, (const int16_t*)data, nbFrame);
+    if (![self processF32:_micBuf nbFrame:nbFrame rate:rate]) {
+        return NO;
+    }
+    ksy_f32_to_s16((int16_t*)data, _micBuf, nbFrame);
+    return YES;
+}
+
+- (void) reset {
+    for (int i = 0; i < KSY_AEC_MAX_FAR; ++i) {
+        ksy_ring_flush(_far[i].ring);
+    }
+    ksy_aec_reset(_aec);
+    atomic_store(&_erleDb, 0);
+    atomic_store(&_adapted, NO);
+}
+
+#pragma mark - stat
+- (float) latencyMs {
+    return atomic_load(&_latencyMs);
+}
+
+- (float) erleDb {
+    return atomic_load_explicit(&_erleDb, memory_order_relaxed);
+}
+
+- (BOOL) bAdapted {
+    return atomic_load_explicit(&_adapted, memory_order_relaxed);
+}
+
+- (float) avgBlockUs {
+    return atomic_load_explicit(&_avgUs, memory_order_relaxed);
+}
+
+- (int) resyncCnt {
+    return atomic_load(&_resyncCnt);
+}
+
+- (KSYAudioRingStat) farStatOf:(int)idx {
+    KSYAudioRingStat st = {0};
+    if (idx >= 0 && idx < KSY_AEC_MAX_FAR) {
+        ksy_ring_get_stat(_far[idx].ring, &st);
+    }
+    return st;
+}
+
+@end
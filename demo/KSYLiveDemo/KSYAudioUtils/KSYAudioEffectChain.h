@@ -0,0 +1,121 @@
+//
+//  KSYAudioEffectChain.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <CoreMedia/CoreMedia.h>
+#import "KSYAudioFx.h"
+
+/// 内置的效果器类型
+typedef NS_ENUM(NSInteger, KSYAudioFxType) {
+    /// 参数均衡 (参数见 KSYFxEqParam)
+    KSYAudioFxType_EQ = 0,
+    /// 变调/变声 (参数见 KSYFxPitchParam)
+    KSYAudioFxType_Pitch,
+    /// 噪声门 (参数见 KSYFxGateParam)
+    KSYAudioFxType_Gate,
+    /// 混响 (参数见 KSYFxReverbParam)
+    KSYAudioFxType_Reverb,
+    /// 降噪 (参数见 KSYFxDenoiseParam)
+    KSYAudioFxType_Denoise,
+};
+
+/** 音频效果链
+
+ 1. 按加入的顺序对一路音频原地运行一组效果器, 不需要在回调中逐个手动调用
+ 2. 麦克风: 在 audioProcessingCallback 中送入混音器之前调用 processAudioSampleBuffer:
+ 3. 其他track: 设置 KSYAudioTrackBuffer 的 effectChain 属性, 在 feedMixer: 中处理
+ 4. 效果器的参数和旁路开关可以在任意线程设置, 下一块数据开始生效
+ */
+@interface KSYAudioEffectChain : NSObject
+
+/**
+ @abstract  初始化, 每块256帧
+ */
+- (instancetype) init;
+
+/**
+ @abstract  初始化
+ @param     maxFrame 每块的最大帧数 (16~4096)
+ */
+- (instancetype) initWithBlockSize:(int)maxFrame;
+
+/**
+ @abstract  在链尾加入内置效果器
+ @return    效果器的序号, 用于设置参数; -1 表示失败
+ */
+- (int) addEffect:(KSYAudioFxType)type;
+
+/**
+ @abstract  在链尾加入自定义效果器
+ @param     cls 效果器的实现, 需要在效果链的生存期内有效
+ */
+- (int) addEffectClass:(const KSYAudioFxClass*)cls;
+
+/**
+ @abstract  效果器的个数
+ */
+@property (nonatomic, readonly) int count;
+
+/**
+ @abstract  设置第fx个效果器的参数 (任意线程)
+ */
+- (void) setParam:(int)idx
+            value:(float)value
+         ofEffect:(int)fx;
+
+/**
+ @abstract  读取第fx个效果器的参数 (任意线程)
+ */
+- (float) param:(int)idx
+       ofEffect:(int)fx;
+
+/**
+ @abstract  旁路第fx个效果器 (任意线程)
+ */
+- (void) setBypass:(BOOL)bBypass
+          ofEffect:(int)fx;
+
+/**
+ @abstract  原地处理一段音频 (处理线程)
+ @param     sampleBuffer 音频数据, 支持S16或float交织格式
+ @return    NO 表示数据格式不支持
+ */
+- (BOOL) processAudioSampleBuffer:(CMSampleBufferRef)sampleBuffer;
+
+/**
+ @abstract  原地处理S16交织数据 (处理线程)
+ */
+- (BOOL) processS16:(int16_t*)pcm
+            nbFrame:(int)nbFrame
+               rate:(int)rate
+              chCnt:(int)chCnt;
+
+/**
+ @abstract  原地处理float交织数据 (处理线程)
+ */
+- (BOOL) processF32:(float*)pcm
+            nbFrame:(int)nbFrame
+               rate:(int)rate
+              chCnt:(int)chCnt;
+
+/**
+ @abstract  清空所有效果器的内部状态 (处理线程)
+ */
+- (void) reset;
+
+/**
+ @abstract  是否统计各效果器的耗时, 默认为NO; 开启时清空之前的统计
+ */
+@property (nonatomic, assign) BOOL bProfile;
+
+/**
+ @abstract  第fx个效果器平均每块的耗时 (微秒)
+ */
+- (double) usPerBlockOfEffect:(int)fx;
+
+@end
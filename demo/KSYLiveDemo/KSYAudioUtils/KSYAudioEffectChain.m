@@ -0,0 +1,136 @@
+//
+//  KSYAudioEffectChain.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioEffectChain.h"
+#import "KSYAudioFxChain.h"
+
+@interface KSYAudioEffectChain () {
+    KSYAudioFxChain * _chain;
+}
+@end
+
+@implementation KSYAudioEffectChain
+
+- (instancetype) init {
+    return [self initWithBlockSize:256];
+}
+
+- (instancetype) initWithBlockSize:(int)maxFrame {
+    self = [super init];
+    if (self == nil) {
+        return nil;
+    }
+    _chain = ksy_fxchain_create(maxFrame);
+    if (_chain == NULL) {
+        return nil;
+    }
+    return self;
+}
+
+- (void) dealloc {
+    ksy_fxchain_destroy(_chain);
+}
+
+- (int) addEffect:(KSYAudioFxType)type {
+    switch (type) {
+        case KSYAudioFxType_EQ:     return ksy_fxchain_add(_chain, &ksy_fx_eq);
+        case KSYAudioFxType_Pitch:  return ksy_fxchain_add(_chain, &ksy_fx_pitch);
+        case KSYAudioFxType_Gate:   return ksy_fxchain_add(_chain, &ksy_fx_gate);
+        case KSYAudioFxType_Reverb: return ksy_fxchain_add(_chain, &ksy_fx_reverb);
+        case KSYAudioFxType_Denoise:return ksy_fxchain_add(_chain, &ksy_fx_denoise);
+    }
+    return -1;
+}
+
+- (int) addEffectClass:(const KSYAudioFxClass*)cls {
+    return ksy_fxchain_add(_chain, cls);
+}
+
+- (int) count {
+    return ksy_fxchain_count(_chain);
+}
+
+- (void) setParam:(int)idx
+            value:(float)value
+         ofEffect:(int)fx {
+    ksy_fxchain_set_param(_chain, fx, idx, value);
+}
+
+- (float) param:(int)idx
+       ofEffect:(int)fx {
+    return ksy_fxchain_get_param(_chain, fx, idx);
+}
+
+- (void) setBypass:(BOOL)bBypass
+          ofEffect:(int)fx {
+    ksy_fxchain_set_bypass(_chain, fx, bBypass);
+}
+
+- (BOOL) processAudioSampleBuffer:(CMSampleBufferRef)sampleBuffer {
+    if (sampleBuffer == NULL) {
+        return NO;
+    }
+    CMFormatDescriptionRef desc = CMSampleBufferGetFormatDescription(sampleBuffer);
+    const AudioStreamBasicDescription * asbd = desc ?
+        CMAudioFormatDescriptionGetStreamBasicDescription(desc) : NULL;
+    if (asbd == NULL || asbd->mFormatID != kAudioFormatLinearPCM ||
+        (asbd->mFormatFlags & kAudioFormatFlagIsNonInterleaved)) {
+        return NO;
+    }
+    BOOL bFloat = (asbd->mFormatFlags & kAudioFormatFlagIsFloat) != 0;
+    if ((bFloat && asbd->mBitsPerChannel != 32) ||
+        (!bFloat && asbd->mBitsPerChannel != 16)) {
+        return NO;
+    }
+    CMBlockBufferRef block = CMSampleBufferGetDataBuffer(sampleBuffer);
+    size_t len = 0;
+    char * data = NULL;
+    int nbFrame = (int)CMSampleBufferGetNumSamples(sampleBuffer);
+    if (block == NULL ||
+        CMBlockBufferGetDataPointer(block, 0, NULL, &len, &data) != kCMBlockBufferNoErr ||
+        len < (size_t)nbFrame * asbd->mBytesPerFrame) {
+        return NO;
+    }
+    int rate  = (int)asbd->mSampleRate;
+    int chCnt = (int)asbd->mChannelsPerFrame;
+    if (bFloat) {
+        return ksy_fxchain_process_f32(_chain, (float*)data, nbFrame, rate, chCnt);
+    }
+    return ksy_fxchain_process_s16(_chain, (int16_t*)data, nbFrame, rate, chCnt);
+}
+
+- (BOOL) processS16:(int16_t*)pcm
+            nbFrame:(int)nbFrame
+               rate:(int)rate
+              chCnt:(int)chCnt {
+    return ksy_fxchain_process_s16(_chain, pcm, nbFrame, rate, chCnt);
+}
+
+- (BOOL) processF32:(float*)pcm
+            nbFrame:(int)nbFrame
+               rate:(int)rate
+              chCnt:(int)chCnt {
+    return ksy_fxchain_process_f32(_chain, pcm, nbFrame, rate, chCnt);
+}
+
+- (void) reset {
+    ksy_fxchain_reset(_chain);
+}
+
+- (void) setBProfile:(BOOL)bProfile {
+    _bProfile = bProfile;
+    ksy_fxchain_enable_profile(_chain, bProfile);
+}
+
+- (double) usPerBlockOfEffect:(int)fx {
+    int64_t ns = 0, blocks = 0;
+    ksy_fxchain_get_profile(_chain, fx, &ns, &blocks, NULL);
+    return blocks > 0 ? ns / 1000.0 / blocks : 0.0;
+}
+
+@end
@@ -0,0 +1,133 @@
+//
+//  KSYAudioEffectPool.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <CoreMedia/CoreMedia.h>
+#import "KSYAudioOutputStage.h"
+#import "KSYAudioFileCache.h"
+#if USING_DYNAMIC_FRAMEWORK
+#import <libksygpulivedylib/KSYAudioMixer.h>
+#else
+#import <libksygpulive/KSYAudioMixer.h>
+#endif
+
+/** 短音效池 (掌声/礼物等一次性音效)
+
+ 1. 音效预先解码为混音器的输出格式并缓存, 播放时只传递引用, 不拷贝PCM
+ 2. 所有音效混合后占用混音器的一个track, 不受 getMaxMixTrack 的限制
+ 3. 每次只混合正在播放的音效, 耗时与同时播放的个数成正比, 与加载的个数无关
+ 4. playEffect 等控制接口在同一个线程(如主线程)调用; feedMixer 在主轨线程调用
+ 5. 主轨线程不释放内存: 播放结束时已卸载的音效交回控制线程, 在下一次调用控制接口时释放 (KSYAudioVoicePool)
+ 6. 设置 cache 后, 已缓存的音效文件直接内存映射, 不再解码; 未缓存的解码后存入缓存
+ */
+@interface KSYAudioEffectPool : NSObject
+
+/**
+ @abstract  初始化
+ @param     mixer    数据送往的混音器, 为nil时只能通过 render 离线混合
+ @param     trackId  混音器中对应的track
+ @param     maxVoice 最多同时播放的音效个数
+ */
+- (instancetype) initWithMixer:(KSYAudioMixer*)mixer
+                         track:(int)trackId
+                      maxVoice:(int)maxVoice;
+
+/**
+ @abstract  对应混音器中的track
+ */
+@property (nonatomic, readonly) int trackId;
+
+/**
+ @abstract  缓存数据的格式 (即混音器的输出格式)
+ */
+@property (nonatomic, readonly) KSYAudioFormat outFmt;
+
+/**
+ @abstract  加载的音效个数
+ */
+@property (nonatomic, readonly) int effectCount;
+
+/**
+ @abstract  当前正在播放的音效个数 (任意线程)
+ */
+@property (nonatomic, readonly) int activeCount;
+
+/**
+ @abstract  电平统计, 送入混音器的数据同时按 trackId 送给它统计 (可以为nil)
+ */
+@property (nonatomic, weak) KSYAudioOutputStage * outputStage;
+
+/**
+ @abstract  解码缓存 (可以为nil, 在 loadEffectFile 之前设置)
+ */
+@property (nonatomic, strong) KSYAudioFileCache * cache;
+
+/**
+ @abstract  从文件加载音效 (解码并转换为输出格式, 同步, 耗时与文件长度成正比)
+ @param     path 音频文件路径 (mp3/m4a/aac/wav/caf 等)
+ @return    音效的ID, 失败时返回 -1
+ */
+- (int) loadEffectFile:(NSString*)path;
+
+/**
+ @abstract  在后台的串行队列中解码音效文件, 每个文件解码后在主线程加入 (需要主线程为控制线程)
+ @param     paths      音频文件路径
+ @param     completion 全部加入后在主线程调用, ids 与 paths 一一对应, 失败的为 -1
+ @discussion 解码期间可以正常播放已加载的音效
+ */
+- (void) loadEffectFiles:(NSArray<NSString*>*)paths
+              completion:(void(^)(NSArray<NSNumber*>* ids))completion;
+
+/**
+ @abstract  加载PCM数据作为音效
+ @param     pData 原始数据, 平面格式时为各声道的指针
+ @param     len   帧数
+ @param     fmt   原始数据的格式, 支持 S16/S16P/FLT/FLTP, 采样率不同时会重采样
+ @return    音效的ID, 失败时返回 -1
+ */
+- (int) loadEffectData:(uint8_t**)pData
+              nbSample:(int)len
+            withFormat:(KSYAudioFormat*)fmt;
+
+/**
+ @abstract  卸载音效
+ @discussion 正在播放的该音效会继续播放完, 之后释放内存
+ */
+- (void) unloadEffect:(int)effectId;
+
+/**
+ @abstract  播放音效
+ @param     effectId 音效的ID
+ @param     vol      音量 (0.0~1.99)
+ @return    NO 表示ID无效, 或同时播放的音效已达上限
+ */
+- (BOOL) playEffect:(int)effectId
+             volume:(float)vol;
+
+/**
+ @abstract  停止所有正在播放的音效
+ */
+- (void) stopAll;
+
+/**
+ @abstract  混合正在播放的音效 (主轨线程)
+ @param     buf     输出buffer
+ @param     nbFrame 帧数
+ @return    NO 表示没有正在播放的音效, buf 未被写入
+ */
+- (BOOL) render:(int16_t*)buf
+        nbFrame:(int)nbFrame;
+
+/**
+ @abstract  混合正在播放的音效并送入混音器 (主轨线程)
+ @param     mainBuf 即将送入混音器的主轨数据, 用于计算需要的长度和时间戳
+ @return    送入混音器的帧数, 没有正在播放的音效时为0
+ */
+- (int) feedMixer:(CMSampleBufferRef)mainBuf;
+
+@end
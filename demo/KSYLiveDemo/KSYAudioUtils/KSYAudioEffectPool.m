@@ -0,0 +1,288 @@
+//
+//  KSYAudioEffectPool.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioEffectPool.h"
+#import <AudioToolbox/AudioToolbox.h>
+#import "KSYAudioConvert.h"
+#import "KSYAudioResampler.h"
+#import "KSYAudioTrackBuffer.h"
+#import "KSYAudioVoicePool.h"
+
+@interface KSYAudioEffectPool () {
+    KSYVoicePool *     _voicePool;
+    dispatch_queue_t   _loadQueue;
+    NSMutableArray *   _loadIds;    // 主线程使用
+    // 主轨线程使用
+    int16_t *          _mixBuf;
+    int                _mixCap;
+}
+@property (nonatomic, weak) KSYAudioMixer * mixer;
+@end
+
+@implementation KSYAudioEffectPool
+
+- (instancetype) initWithMixer:(KSYAudioMixer*)mixer
+                         track:(int)trackId
+                      maxVoice:(int)maxVoice {
+    self = [super init];
+    if (self == nil || maxVoice <= 0) {
+        return nil;
+    }
+    _mixer    = mixer;
+    _trackId  = trackId;
+    if (mixer) {
+        _outFmt = mixer.outFmt;
+    }
+    if (_outFmt.sampleRate <= 0 || _outFmt.chCnt <= 0) {
+        // 混音器的输出固定为 44.1KHz, 单声道, S16
+        _outFmt.sampleFmt  = KSYSampleFmt_S16;
+        _outFmt.sampleSize = 2;
+        _outFmt.chCnt      = 1;
+        _outFmt.chLayout   = 0x4; // AV_CH_LAYOUT_MONO
+        _outFmt.sampleRate = 44100;
+    }
+    _voicePool = ksy_voice_pool_create(_outFmt.chCnt, maxVoice);
+    if (_voicePool == NULL) {
+        return nil;
+    }
+    // 按约100ms的主轨周期预先分配, 主轨线程中一般不需要再分配
+    ksy_voice_pool_reserve(_voicePool, _outFmt.sampleRate / 10);
+    _loadQueue = dispatch_queue_create("com.ksyun.effectpool", DISPATCH_QUEUE_SERIAL);
+    _loadIds   = [NSMutableArray array];
+    return self;
+}
+
+- (void) dealloc {
+    // 此时两个线程都已不再调用
+    ksy_voice_pool_destroy(_voicePool);
+    free(_mixBuf);
+}
+
+- (int) effectCount {
+    KSYVoicePoolStat st;
+    ksy_voice_pool_get_stat(_voicePool, &st);
+    return st.nbSample;
+}
+
+- (int) activeCount {
+    return ksy_voice_pool_active(_voicePool);
+}
+
+#pragma mark - effect cache
+- (int) addSample:(int16_t*)pcm nbFrame:(int)nbFrame {
+    return [self addSample:pcm nbFrame:nbFrame map:NULL];
+}
+
+// map 不为NULL时 pcm 指向映射的数据, 失败时释放映射而不是 pcm
+- (int) addSample:(int16_t*)pcm nbFrame:(int)nbFrame map:(KSYPcmMap*)map {
+    return ksy_voice_pool_add(_voicePool, pcm, nbFrame, map);
+}
+
+- (int) loadEffectFile:(NSString*)path {
+    KSYPcmMap * map = NULL;
+    int nbFrame = 0;
+    int16_t * pcm = [self decodeFile:path nbFrame:&nbFrame map:&map];
+    return [self addSample:pcm nbFrame:nbFrame map:map];
+}
+
+- (void) loadEffectFiles:(NSArray<NSString*>*)paths
+              completion:(void(^)(NSArray<NSNumber*>* ids))completion {
+    NSArray * list = [paths copy];
+    dispatch_async(_loadQueue, ^{
+        for (NSString * path in list) {
+            KSYPcmMap * map = NULL;
+            int nbFrame = 0;
+            int16_t * pcm = [self decodeFile:path nbFrame:&nbFrame map:&map];
+            // 音效表只在主线程修改
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [self->_loadIds addObject:@([self addSample:pcm nbFrame:nbFrame map:map])];
+            });
+        }
+        dispatch_async(dispatch_get_main_queue(), ^{
+            NSArray * ids = [self->_loadIds copy];
+            [self->_loadIds removeAllObjects];
+            if (completion) {
+                completion(ids);
+            }
+        });
+    });
+}
+
+// 解码音效文件 (任意线程, 不修改音效表)
+// 命中解码缓存时返回映射的数据且 *pMap 不为NULL, 否则返回 malloc 的数据, 失败时返回NULL
+- (int16_t*) decodeFile:(NSString*)path nbFrame:(int*)nbFrame map:(KSYPcmMap**)pMap {
+    KSYAudioFileCache * cache = _cache;
+    KSYPcmMap * map = [cache mapFile:path];
+    *pMap    = NULL;
+    *nbFrame = 0;
+    if (map && map->rate == _outFmt.sampleRate && map->chCnt == _outFmt.chCnt &&
+        map->nbFrame <= INT_MAX) {
+        // 音效在主轨线程中读取, 预先读入整个映射, 避免播放时缺页
+        ksy_pcm_map_prefault(map, 0);
+        *pMap    = map;
+        *nbFrame = (int)map->nbFrame;
+        return (int16_t*)map->pcm;
+    }
+    ksy_pcm_map_release(map);
+    ExtAudioFileRef file = NULL;
+    NSURL * url = [NSURL fileURLWithPath:path];
+    if (ExtAudioFileOpenURL((__bridge CFURLRef)url, &file) != noErr) {
+        return NULL;
+    }
+    // 由ExtAudioFile完成解码/重采样/声道转换
+    int ch = _outFmt.chCnt;
+    AudioStreamBasicDescription asbd = {0};
+    asbd.mSampleRate       = _outFmt.sampleRate;
+    asbd.mFormatID         = kAudioFormatLinearPCM;
+    asbd.mFormatFlags      = kAudioFormatFlagIsSignedInteger | kAudioFormatFlagIsPacked;
+    asbd.mChannelsPerFrame = ch;
+    asbd.mBitsPerChannel   = 16;
+    asbd.mBytesPerFrame    = sizeof(int16_t) * ch;
+    asbd.mFramesPerPacket  = 1;
+    asbd.mBytesPerPacket   = asbd.mBytesPerFrame;
+    if (ExtAudioFileSetProperty(file, kExtAudioFileProperty_ClientDataFormat,
+                                sizeof(asbd), &asbd) != noErr) {
+        ExtAudioFileDispose(file);
+        return NULL;
+    }
+    int       cap = _outFmt.sampleRate; // 按1秒起步, 不够时翻倍
+    int       len = 0;
+    int16_t * pcm = malloc(sizeof(int16_t) * cap * ch);
+    while (pcm) {
+        if (len == cap) {
+            int16_t * p = realloc(pcm, sizeof(int16_t) * cap * 2 * ch);
+            if (p == NULL) {
+                free(pcm);
+                pcm = NULL;
+                break;
+            }
+            pcm  = p;
+            cap *= 2;
+        }
+        UInt32 nb = cap - len;
+        AudioBufferList abl;
+        abl.mNumberBuffers = 1;
+        abl.mBuffers[0].mNumberChannels = ch;
+        abl.mBuffers[0].mDataByteSize   = nb * asbd.mBytesPerFrame;
+        abl.mBuffers[0].mData           = pcm + len*ch;
+        if (ExtAudioFileRead(file, &nb, &abl) != noErr) {
+            free(pcm);
+            pcm = NULL;
+            break;
+        }
+        if (nb == 0) {
+            break;
+        }
+        len += nb;
+    }
+    ExtAudioFileDispose(file);
+    if (pcm && len > 0) {
+        [cache storePcm:pcm nbFrame:len forFile:path];
+    }
+    *nbFrame = len;
+    return pcm;
+}
+
+- (int) loadEffectData:(uint8_t**)pData
+              nbSample:(int)len
+            withFormat:(KSYAudioFormat*)fmt {
+    if (pData == NULL || fmt == NULL || len <= 0 || fmt->sampleRate <= 0) {
+        return -1;
+    }
+    int ch = _outFmt.chCnt;
+    const uint8_t * const * src = (const uint8_t* const*)pData;
+    if (fmt->sampleRate == _outFmt.sampleRate) {
+        int16_t * pcm = malloc(sizeof(int16_t) * len * ch);
+        uint8_t * dst[1] = { (uint8_t*)pcm };
+        if (pcm && ksy_audio_convert(dst, KSYSampleFmt_S16, ch, src,
+                                     fmt->sampleFmt, fmt->chCnt, NULL, len) != 0) {
+            free(pcm);
+            pcm = NULL;
+        }
+        return [self addSample:pcm nbFrame:len];
+    }
+    // 采样率不同: 离线进行高质量重采样, 末尾补零把滤波器中的数据取出
+    KSYAudioResampler * rs = ksy_resampler_create(fmt->sampleRate, _outFmt.sampleRate,
+                                                  ch, KSYResampleQuality_High);
+    int       pad    = 64;
+    int       maxOut = ksy_resampler_max_out(rs, len + pad);
+    float *   flt    = calloc((size_t)(len + pad) * ch, sizeof(float));
+    float *   out    = malloc(sizeof(float) * maxOut * ch);
+    int16_t * pcm    = malloc(sizeof(int16_t) * maxOut * ch);
+    int       nbOut  = 0;
+    uint8_t * fltDst[1] = { (uint8_t*)flt };
+    if (rs && flt && out && pcm &&
+        ksy_audio_convert(fltDst, KSYSampleFmt_FLT, ch, src,
+                          fmt->sampleFmt, fmt->chCnt, NULL, len) == 0) {
+        nbOut = ksy_resampler_process(rs, flt, len + pad, out, maxOut);
+        int expect = (int)(((int64_t)len * _outFmt.sampleRate + fmt->sampleRate - 1)
+                           / fmt->sampleRate);
+        nbOut = nbOut < expect ? nbOut : expect;
+        const uint8_t * rsOut[1] = { (const uint8_t*)out };
+        uint8_t *       dst[1]   = { (uint8_t*)pcm };
+        ksy_audio_convert(dst, KSYSampleFmt_S16, ch, rsOut,
+                          KSYSampleFmt_FLT, ch, NULL, nbOut);
+    }
+    ksy_resampler_destroy(rs);
+    free(flt);
+    free(out);
+    return [self addSample:pcm nbFrame:nbOut];
+}
+
+- (void) unloadEffect:(int)effectId {
+    ksy_voice_pool_remove(_voicePool, effectId);
+}
+
+#pragma mark - control
+- (BOOL) playEffect:(int)effectId
+             volume:(float)vol {
+    return ksy_voice_pool_play(_voicePool, effectId, vol);
+}
+
+- (void) stopAll {
+    ksy_voice_pool_stop_all(_voicePool);
+}
+
+#pragma mark - render
+- (BOOL) render:(int16_t*)buf
+        nbFrame:(int)nbFrame {
+    return ksy_voice_pool_render(_voicePool, buf, nbFrame);
+}
+
+- (int) feedMixer:(CMSampleBufferRef)mainBuf {
+    KSYAudioMixer * mixer = _mixer;
+    if (mainBuf == NULL || mixer == nil) {
+        return 0;
+    }
+    CMFormatDescriptionRef desc = CMSampleBufferGetFormatDescription(mainBuf);
+    const AudioStreamBasicDescription * asbd = desc ?
+        CMAudioFormatDescriptionGetStreamBasicDescription(desc) : NULL;
+    if (asbd == NULL || asbd->mSampleRate <= 0) {
+        return 0;
+    }
+    int64_t nbMain = CMSampleBufferGetNumSamples(mainBuf);
+    int need = (int)((nbMain * _outFmt.sampleRate + (int64_t)asbd->mSampleRate/2)
+                     / (int64_t)asbd->mSampleRate);
+    if (need > _mixCap) {
+        int16_t * p = realloc(_mixBuf, sizeof(int16_t) * need * _outFmt.chCnt);
+        if (p == NULL) {
+            return 0;
+        }
+        _mixBuf = p;
+        _mixCap = need;
+    }
+    if (need <= 0 || ![self render:_mixBuf nbFrame:need]) {
+        return 0;
+    }
+    [_outputStage meterTrack:_trackId data:_mixBuf nbFrame:need format:&_outFmt];
+    ksy_mixer_feed_s16(mixer, _trackId, _mixBuf, need, &_outFmt,
+                       CMSampleBufferGetPresentationTimeStamp(mainBuf));
+    return need;
+}
+
+@end
@@ -0,0 +1,49 @@
+//
+//  KSYAudioFFT.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** 实数FFT
+
+ 1. 长度为2的整数次幂, 内部用 n/2 点复数FFT 加一次拆分实现
+ 2. 旋转因子和位反转表在创建时计算, 变换过程中不分配内存
+ 3. 频谱按 (re, im) 交织存放 n/2+1 个点, DC 和 Nyquist 的虚部为0
+ 4. 一个实例内部有工作区, 不能在多个线程上同时使用
+ */
+typedef struct _KSYAudioFFT KSYAudioFFT;
+
+/**
+ @abstract  创建
+ @param     n 变换长度 (2的整数次幂, 16~8192)
+ @return    参数错误时返回NULL
+ */
+KSYAudioFFT* ksy_fft_create(int n);
+
+/**
+ @abstract  销毁
+ */
+void ksy_fft_destroy(KSYAudioFFT* fft);
+
+/**
+ @abstract  变换长度
+ */
+int ksy_fft_size(const KSYAudioFFT* fft);
+
+/**
+ @abstract  正变换
+ @param     in  n 个实数
+ @param     out n+2 个float, 即 n/2+1 个复数; 可以与 in 为同一块内存(需有 n+2 的空间)
+ */
+void ksy_fft_forward(KSYAudioFFT* fft, const float* in, float* out);
+
+/**
+ @abstract  逆变换 (结果已除以 n)
+ @param     in  n/2+1 个复数
+ @param     out n 个实数; 可以与 in 为同一块内存
+ */
+void ksy_fft_inverse(KSYAudioFFT* fft, const float* in, float* out);
@@ -0,0 +1,161 @@
+//
+//  KSYAudioFFT.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioFFT.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+struct _KSYAudioFFT {
+    int     n;
+    int     m;          // 复数FFT的长度 n/2
+    int *   rev;        // m 点的位反转表
+    float * tw;         // m 点复数FFT的旋转因子 e^{-2πik/m}, k < m/2, 交织
+    float * split;      // 拆分用的旋转因子 e^{-2πik/n}, k <= m/2, 交织
+    float * work;       // m 个复数
+};
+
+KSYAudioFFT* ksy_fft_create(int n) {
+    if (n < 16 || n > 8192 || (n & (n - 1))) {
+        return NULL;
+    }
+    KSYAudioFFT* fft = calloc(1, sizeof(KSYAudioFFT));
+    if (fft == NULL) {
+        return NULL;
+    }
+    int m = n / 2;
+    fft->n     = n;
+    fft->m     = m;
+    fft->rev   = malloc(sizeof(int) * m);
+    fft->tw    = malloc(sizeof(float) * m);
+    fft->split = malloc(sizeof(float) * (m + 2));
+    fft->work  = malloc(sizeof(float) * 2 * m);
+    if (!fft->rev || !fft->tw || !fft->split || !fft->work) {
+        ksy_fft_destroy(fft);
+        return NULL;
+    }
+    int bits = 0;
+    while ((1 << bits) < m) {
+        ++bits;
+    }
+    for (int i = 0; i < m; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        fft->rev[i] = r;
+    }
+    for (int k = 0; k < m / 2; ++k) {
+        fft->tw[2*k]   = (float)cos(2 * M_PI * k / m);
+        fft->tw[2*k+1] = (float)-sin(2 * M_PI * k / m);
+    }
+    for (int k = 0; k <= m / 2; ++k) {
+        fft->split[2*k]   = (float)cos(2 * M_PI * k / n);
+        fft->split[2*k+1] = (float)-sin(2 * M_PI * k / n);
+    }
+    return fft;
+}
+
+void ksy_fft_destroy(KSYAudioFFT* fft) {
+    if (fft) {
+        free(fft->rev);
+        free(fft->tw);
+        free(fft->split);
+        free(fft->work);
+        free(fft);
+    }
+}
+
+int ksy_fft_size(const KSYAudioFFT* fft) {
+    return fft ? fft->n : 0;
+}
+
+// 原地 m 点复数FFT (输入已按位反转排列), inv 为1时旋转因子取共轭
+static void complexFFT(const KSYAudioFFT* fft, float* z, int inv) {
+    const int m = fft->m;
+    const float sgn = inv ? -1.0f : 1.0f;
+    for (int len = 2; len <= m; len <<= 1) {
+        int half = len >> 1, step = m / len;
+        for (int j = 0; j < m; j += len) {
+            for (int k = 0; k < half; ++k) {
+                float wr = fft->tw[2*k*step], wi = sgn * fft->tw[2*k*step+1];
+                float * a = z + 2*(j+k);
+                float * b = z + 2*(j+k+half);
+                float tr = b[0]*wr - b[1]*wi;
+                float ti = b[0]*wi + b[1]*wr;
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+}
+
+void ksy_fft_forward(KSYAudioFFT* fft, const float* in, float* out) {
+    const int m = fft->m;
+    float * z = fft->work;
+    // 偶数点作实部, 奇数点作虚部, 按位反转顺序放入工作区
+    for (int i = 0; i < m; ++i) {
+        int r = fft->rev[i];
+        z[2*r]   = in[2*i];
+        z[2*r+1] = in[2*i+1];
+    }
+    complexFFT(fft, z, 0);
+    // X[k] = E[k] + W^k O[k], E/O 由 Z[k] 与 conj(Z[m-k]) 求得
+    out[0]     = z[0] + z[1];
+    out[1]     = 0.0f;
+    out[2*m]   = z[0] - z[1];
+    out[2*m+1] = 0.0f;
+    for (int k = 1; k <= m / 2; ++k) {
+        int   j  = m - k;
+        float er = 0.5f * (z[2*k]   + z[2*j]);
+        float ei = 0.5f * (z[2*k+1] - z[2*j+1]);
+        float or_ = 0.5f * (z[2*k+1] + z[2*j+1]);
+        float oi = -0.5f * (z[2*k]   - z[2*j]);
+        float wr = fft->split[2*k], wi = fft->split[2*k+1];
+        float tr = or_*wr - oi*wi;
+        float ti = or_*wi + oi*wr;
+        out[2*k]   = er + tr;
+        out[2*k+1] = ei + ti;
+        out[2*j]   = er - tr;      // X[m-k] = conj(E[k] - W^k O[k])
+        out[2*j+1] = -(ei - ti);
+    }
+}
+
+void ksy_fft_inverse(KSYAudioFFT* fft, const float* in, float* out) {
+    const int m = fft->m;
+    float * z = fft->work;
+    // 由 X[k] 还原 Z[k] = E[k] + i O[k], 再做 m 点逆变换
+    for (int k = 0; k <= m / 2; ++k) {
+        int   j  = m - k;
+        float xr = in[2*k], xi = in[2*k+1];
+        float yr = in[2*j], yi = -in[2*j+1];   // conj(X[m-k])
+        float er = 0.5f * (xr + yr), ei = 0.5f * (xi + yi);
+        float dr = 0.5f * (xr - yr), di = 0.5f * (xi - yi);
+        // O[k] = (X[k] - conj(X[m-k])) / 2 * W^{-k}
+        float wr = fft->split[2*k], wi = -fft->split[2*k+1];
+        float or_ = dr*wr - di*wi;
+        float oi = dr*wi + di*wr;
+        int rk = fft->rev[k];
+        z[2*rk]   = er - oi;
+        z[2*rk+1] = ei + or_;
+        if (j != k && j < m) {
+            // Z[m-k] = conj(E[k]) + i conj(O[k])
+            int rj = fft->rev[j];
+            z[2*rj]   = er + oi;
+            z[2*rj+1] = -ei + or_;
+        }
+    }
+    complexFFT(fft, z, 1);
+    const float s = 1.0f / m;
+    for (int i = 0; i < m; ++i) {
+        out[2*i]   = z[2*i]   * s;
+        out[2*i+1] = z[2*i+1] * s;
+    }
+}
@@ -0,0 +1,72 @@
+//
+//  KSYAudioFdnReverb.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** 反馈延迟网络(FDN)混响
+
+ 1. 8条延迟线经 Hadamard 矩阵混合后反馈, 每条线上有一阶低通模拟高频吸收
+ 2. 按块处理: 块长不超过最短的延迟线, 每条线的读写都是连续的,
+    矩阵混合逐列向量化 (见 ksy_hadamard8_f32)
+ 3. 所有内存在创建时一次分配(按最大房间), 处理过程中不分配内存
+ 4. 支持单声道/双声道, S16或float交织数据; 双声道时左右声道取不同的延迟线, 有立体感
+ */
+typedef struct _KSYAudioFdnReverb KSYAudioFdnReverb;
+
+/// 混响参数
+typedef struct {
+    /// 房间大小 (0~1): 同时决定延迟线长度和混响时间 (约0.3~3.5秒)
+    float roomSize;
+    /// 高频阻尼 (0~1): 越大高频衰减越快, 声音越暗
+    float damping;
+    /// 混响声的比例 (0~1)
+    float wet;
+    /// 原声的比例 (0~1)
+    float dry;
+    /// 预延迟 (0~100ms): 原声与混响声之间的间隔
+    float preDelayMs;
+} KSYReverbParam;
+
+/**
+ @abstract  创建混响
+ @param     rate  采样率 (8000~96000)
+ @param     chCnt 声道数 (1或2)
+ @return    参数错误时返回NULL
+ */
+KSYAudioFdnReverb* ksy_fdn_create(int rate, int chCnt);
+
+/**
+ @abstract  销毁
+ */
+void ksy_fdn_destroy(KSYAudioFdnReverb* rv);
+
+/**
+ @abstract  设置参数 (与 process 在同一线程调用)
+ @discussion 房间大小改变时延迟线长度跟着改变, 正在衰减的混响声可能有轻微的不连续
+ */
+void ksy_fdn_set_param(KSYAudioFdnReverb* rv, const KSYReverbParam* param);
+
+/**
+ @abstract  原地处理 S16 交织数据
+ */
+void ksy_fdn_process_s16(KSYAudioFdnReverb* rv, int16_t* pcm, int nbFrame);
+
+/**
+ @abstract  原地处理 float 交织数据
+ */
+void ksy_fdn_process_f32(KSYAudioFdnReverb* rv, float* pcm, int nbFrame);
+
+/**
+ @abstract  清空混响尾音
+ */
+void ksy_fdn_reset(KSYAudioFdnReverb* rv);
+
+/**
+ @abstract  声道数
+ */
+int ksy_fdn_channels(const KSYAudioFdnReverb* rv);
@@ -0,0 +1,238 @@
+//
+//  KSYAudioFdnReverb.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioFdnReverb.h"
+#import "KSYAudioKernel.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define FDN_LINES       8
+#define FDN_BLK         256    // 每次处理的最大帧数
+#define FDN_ALIGN       64
+#define FDN_MAX_PRE_MS  100
+#define FDN_DENORM      1e-18f // 防止尾音衰减到非规格化浮点数
+
+// 48KHz, 房间最大时各延迟线的长度 (互质, 约30~58ms)
+static const int s_baseLen[FDN_LINES] = { 1433, 1601, 1867, 2053, 2251, 2399, 2617, 2797 };
+// 输入注入各延迟线的符号, 使各线的初始状态不相关
+static const float s_inSign[FDN_LINES] = { 1, -1, 1, 1, -1, 1, -1, -1 };
+
+struct _KSYAudioFdnReverb {
+    // 块处理的工作区, 每行按缓存行对齐
+    _Alignas(FDN_ALIGN) float row[FDN_LINES][FDN_BLK];
+    _Alignas(FDN_ALIGN) float in[FDN_BLK];
+    _Alignas(FDN_ALIGN) float wetL[FDN_BLK];
+    _Alignas(FDN_ALIGN) float wetR[FDN_BLK];
+    _Alignas(FDN_ALIGN) float io[FDN_BLK * 2];   // S16 转换后的数据
+    // 各延迟线的参数和状态
+    _Alignas(FDN_ALIGN) float gain[FDN_LINES];
+    float           lp[FDN_LINES];
+    int             len[FDN_LINES];
+    int             minLen;
+    float           lpCoef;
+    float           wet;
+    float           dry;
+    // 延迟线: 8条连续存放, 每条 cap 个float
+    float *         lines;
+    int             cap;
+    int             mask;
+    uint32_t        pos;
+    // 预延迟
+    float *         pre;
+    int             preMask;
+    uint32_t        prePos;
+    int             preLen;
+    int             rate;
+    int             chCnt;
+};
+
+static int roundUpPow2(int n) {
+    int c = 1;
+    while (c < n) {
+        c <<= 1;
+    }
+    return c;
+}
+
+KSYAudioFdnReverb* ksy_fdn_create(int rate, int chCnt) {
+    if (rate < 8000 || rate > 96000 || chCnt < 1 || chCnt > 2) {
+        return NULL;
+    }
+    KSYAudioFdnReverb* rv = NULL;
+    if (posix_memalign((void**)&rv, FDN_ALIGN, sizeof(KSYAudioFdnReverb))) {
+        return NULL;
+    }
+    memset(rv, 0, sizeof(KSYAudioFdnReverb));
+    rv->rate  = rate;
+    rv->chCnt = chCnt;
+    int maxLen = (int)ceil(s_baseLen[FDN_LINES-1] * (double)rate / 48000);
+    rv->cap  = roundUpPow2(maxLen + FDN_BLK);
+    rv->mask = rv->cap - 1;
+    int preCap  = roundUpPow2(rate * FDN_MAX_PRE_MS / 1000 + FDN_BLK);
+    rv->preMask = preCap - 1;
+    if (posix_memalign((void**)&rv->lines, FDN_ALIGN, sizeof(float) * rv->cap * FDN_LINES) ||
+        posix_memalign((void**)&rv->pre, FDN_ALIGN, sizeof(float) * preCap)) {
+        ksy_fdn_destroy(rv);
+        return NULL;
+    }
+    KSYReverbParam def = { 0.5f, 0.5f, 0.3f, 1.0f, 20.0f };
+    ksy_fdn_set_param(rv, &def);
+    ksy_fdn_reset(rv);
+    return rv;
+}
+
+void ksy_fdn_destroy(KSYAudioFdnReverb* rv) {
+    if (rv) {
+        free(rv->lines);
+        free(rv->pre);
+        free(rv);
+    }
+}
+
+void ksy_fdn_reset(KSYAudioFdnReverb* rv) {
+    if (rv == NULL) {
+        return;
+    }
+    memset(rv->lines, 0, sizeof(float) * rv->cap * FDN_LINES);
+    memset(rv->pre, 0, sizeof(float) * (rv->preMask + 1));
+    memset(rv->lp, 0, sizeof(rv->lp));
+    rv->pos    = 0;
+    rv->prePos = 0;
+}
+
+static inline float clamp01(float v) {
+    return v > 1.0f ? 1.0f : (v > 0.0f ? v : 0.0f);
+}
+
+void ksy_fdn_set_param(KSYAudioFdnReverb* rv, const KSYReverbParam* param) {
+    if (rv == NULL || param == NULL) {
+        return;
+    }
+    float  room  = clamp01(param->roomSize);
+    double scale = (0.35 + 0.65 * room) * rv->rate / 48000;
+    double rt60  = 0.3 + 3.2 * room * room;
+    rv->minLen = FDN_BLK;
+    for (int i = 0; i < FDN_LINES; ++i) {
+        rv->len[i]  = (int)lround(s_baseLen[i] * scale);
+        rv->gain[i] = (float)pow(10.0, -3.0 * rv->len[i] / (rt60 * rv->rate));
+        rv->minLen  = rv->len[i] < rv->minLen ? rv->len[i] : rv->minLen;
+    }
+    rv->lpCoef = 1.0f - 0.9f * clamp01(param->damping);
+    rv->wet    = clamp01(param->wet);
+    rv->dry    = clamp01(param->dry);
+    float pre  = param->preDelayMs > 0 ? param->preDelayMs : 0;
+    pre        = pre < FDN_MAX_PRE_MS ? pre : FDN_MAX_PRE_MS;
+    rv->preLen = (int)(pre * rv->rate / 1000);
+}
+
+int ksy_fdn_channels(const KSYAudioFdnReverb* rv) {
+    return rv ? rv->chCnt : 0;
+}
+
+// 处理一块交织的float数据, n 不超过 minLen
+static void processBlock(KSYAudioFdnReverb* rv, float* x, int n) {
+    const int ch   = rv->chCnt;
+    const int mask = rv->mask;
+    // 输入混为单声道, 经过预延迟
+    float * in = rv->in;
+    if (ch == 2) {
+        for (int k = 0; k < n; ++k) {
+            in[k] = 0.5f * (x[2*k] + x[2*k+1]);
+        }
+    }
+    else {
+        memcpy(in, x, sizeof(float) * n);
+    }
+    for (int k = 0; k < n; ++k) {
+        rv->pre[(rv->prePos + k) & rv->preMask] = in[k];
+    }
+    for (int k = 0; k < n; ++k) {
+        in[k] = rv->pre[(rv->prePos + k - rv->preLen) & rv->preMask];
+    }
+    rv->prePos += n;
+    // 读出各延迟线 n 帧之前写入的数据, 并做一阶低通
+    float * rows[FDN_LINES];
+    for (int i = 0; i < FDN_LINES; ++i) {
+        const float * line = rv->lines + (size_t)i * rv->cap;
+        float * r   = rv->row[i];
+        int     off = (int)((rv->pos - rv->len[i]) & mask);
+        int     n0  = rv->cap - off < n ? rv->cap - off : n;
+        memcpy(r, line + off, sizeof(float) * n0);
+        memcpy(r + n0, line, sizeof(float) * (n - n0));
+        float lp = rv->lp[i], c = rv->lpCoef;
+        for (int k = 0; k < n; ++k) {
+            lp  += (r[k] - lp) * c + FDN_DENORM;
+            r[k] = lp;
+        }
+        rv->lp[i] = lp;
+        rows[i]   = r;
+    }
+    // 偶数线输出到左声道, 奇数线输出到右声道
+    for (int k = 0; k < n; ++k) {
+        rv->wetL[k] = 0.5f * (rows[0][k] + rows[2][k] + rows[4][k] + rows[6][k]);
+        rv->wetR[k] = 0.5f * (rows[1][k] + rows[3][k] + rows[5][k] + rows[7][k]);
+    }
+    // 混合矩阵, 乘以衰减系数后加上输入, 写回延迟线
+    ksy_hadamard8_f32(rows, n);
+    for (int i = 0; i < FDN_LINES; ++i) {
+        float * line = rv->lines + (size_t)i * rv->cap;
+        float * r    = rows[i];
+        float   g    = rv->gain[i];
+        float   s    = s_inSign[i] * 0.5f;
+        for (int k = 0; k < n; ++k) {
+            r[k] = r[k] * g + in[k] * s;
+        }
+        int off = (int)(rv->pos & mask);
+        int n0  = rv->cap - off < n ? rv->cap - off : n;
+        memcpy(line + off, r, sizeof(float) * n0);
+        memcpy(line, r + n0, sizeof(float) * (n - n0));
+    }
+    rv->pos += n;
+    // 原声与混响声混合
+    const float wet = rv->wet, dry = rv->dry;
+    if (ch == 2) {
+        for (int k = 0; k < n; ++k) {
+            x[2*k]   = x[2*k]   * dry + rv->wetL[k] * wet;
+            x[2*k+1] = x[2*k+1] * dry + rv->wetR[k] * wet;
+        }
+    }
+    else {
+        for (int k = 0; k < n; ++k) {
+            x[k] = x[k] * dry + 0.5f * (rv->wetL[k] + rv->wetR[k]) * wet;
+        }
+    }
+}
+
+void ksy_fdn_process_f32(KSYAudioFdnReverb* rv, float* pcm, int nbFrame) {
+    if (rv == NULL || pcm == NULL) {
+        return;
+    }
+    while (nbFrame > 0) {
+        int n = nbFrame < rv->minLen ? nbFrame : rv->minLen;
+        processBlock(rv, pcm, n);
+        pcm     += n * rv->chCnt;
+        nbFrame -= n;
+    }
+}
+
+void ksy_fdn_process_s16(KSYAudioFdnReverb* rv, int16_t* pcm, int nbFrame) {
+    if (rv == NULL || pcm == NULL) {
+        return;
+    }
+    const int ch = rv->chCnt;
+    while (nbFrame > 0) {
+        int n  = nbFrame < rv->minLen ? nbFrame : rv->minLen;
+        int ns = n * ch;
+        ksy_s16_to_f32(rv->io, pcm, ns);
+        processBlock(rv, rv->io, n);
+        ksy_f32_to_s16(pcm, rv->io, ns);
+        pcm     += ns;
+        nbFrame -= n;
+    }
+}
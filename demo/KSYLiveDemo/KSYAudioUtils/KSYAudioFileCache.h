@@ -0,0 +1,88 @@
+//
+//  KSYAudioFileCache.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "KSYAudioPcmCache.h"
+#if USING_DYNAMIC_FRAMEWORK
+#import <libksygpulivedylib/KSYAudioMixer.h>
+#else
+#import <libksygpulive/KSYAudioMixer.h>
+#endif
+
+/** 常用背景音乐/音效的解码缓存
+
+ 1. 文件用 ExtAudioFile 解码为混音器的输出格式后存入磁盘 (KSYAudioPcmCache), 以文件内容的哈希为key
+ 2. 再次播放同一文件时直接内存映射缓存, 不需要解码, 可以立即开始
+ 3. 缓存总大小受 budgetMB 限制, 按最近使用时间淘汰
+ 4. 所有接口可以在任意线程调用; cacheFileAsync: 在后台的串行队列中解码
+ */
+@interface KSYAudioFileCache : NSObject
+
+/**
+ @abstract  初始化
+ @param     dir      缓存目录, nil 时使用 defaultDirectory
+ @param     budgetMB 缓存总大小的上限 (MB)
+ @param     fmt      缓存数据的格式 (混音器的输出格式, 只使用采样率和声道数)
+ */
+- (instancetype) initWithDirectory:(NSString*)dir
+                          budgetMB:(int)budgetMB
+                            format:(KSYAudioFormat)fmt;
+
+/**
+ @abstract  默认的缓存目录 (Library/Caches/ksypcm, 系统空间不足时可能被清除)
+ */
++ (NSString*) defaultDirectory;
+
+/**
+ @abstract  缓存数据的格式
+ */
+@property (nonatomic, readonly) KSYAudioFormat fmt;
+
+/**
+ @abstract  缓存总大小的上限 (MB), 减小时立即淘汰
+ */
+@property (nonatomic, assign) int budgetMB;
+
+/**
+ @abstract  映射文件的缓存
+ @return    没有缓存时返回NULL; 返回的映射由调用者用 ksy_pcm_map_release 释放
+ */
+- (KSYPcmMap*) mapFile:(NSString*)path;
+
+/**
+ @abstract  解码文件并存入缓存 (同步, 耗时与文件长度成正比, 不要在主线程调用)
+ @return    已有缓存或存入成功时返回YES
+ */
+- (BOOL) cacheFile:(NSString*)path;
+
+/**
+ @abstract  在后台解码文件并存入缓存, 已在队列中的文件不会重复加入
+ */
+- (void) cacheFileAsync:(NSString*)path;
+
+/**
+ @abstract  存入已解码的数据 (如音效加载时解码的结果)
+ @param     pcm     S16交织, fmt 的格式
+ @param     nbFrame 帧数
+ @param     path    源文件路径 (用于计算key)
+ */
+- (BOOL) storePcm:(const int16_t*)pcm
+          nbFrame:(int64_t)nbFrame
+          forFile:(NSString*)path;
+
+/**
+ @abstract  删除所有缓存
+ */
+- (void) clear;
+
+/**
+ @abstract  统计信息 (命中/未命中/淘汰次数, 缓存大小)
+ */
+@property (nonatomic, readonly) KSYPcmCacheStat stat;
+
+@end
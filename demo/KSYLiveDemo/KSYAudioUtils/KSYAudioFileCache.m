@@ -0,0 +1,162 @@
+//
+//  KSYAudioFileCache.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioFileCache.h"
+#import <AudioToolbox/AudioToolbox.h>
+
+#define FILE_CACHE_CHUNK 8192 // 每次解码的帧数
+
+@interface KSYAudioFileCache () {
+    KSYPcmCache *       _cache;
+    dispatch_queue_t    _queue;
+    NSMutableSet *      _pending;   // @synchronized(_pending)
+}
+@end
+
+@implementation KSYAudioFileCache
+
++ (NSString*) defaultDirectory {
+    NSString * dir = NSSearchPathForDirectoriesInDomains(NSCachesDirectory,
+                                                         NSUserDomainMask, YES).firstObject;
+    return [dir stringByAppendingPathComponent:@"ksypcm"];
+}
+
+- (instancetype) initWithDirectory:(NSString*)dir
+                          budgetMB:(int)budgetMB
+                            format:(KSYAudioFormat)fmt {
+    self = [super init];
+    if (self == nil || fmt.sampleRate <= 0 || fmt.chCnt <= 0 || budgetMB < 0) {
+        return nil;
+    }
+    dir = dir ? dir : [KSYAudioFileCache defaultDirectory];
+    _fmt      = fmt;
+    _budgetMB = budgetMB;
+    _cache    = ksy_pcm_cache_create(dir.fileSystemRepresentation, fmt.sampleRate,
+                                     fmt.chCnt, (int64_t)budgetMB << 20);
+    if (_cache == NULL) {
+        return nil;
+    }
+    _queue   = dispatch_queue_create("com.ksyun.pcmcache", DISPATCH_QUEUE_SERIAL);
+    _pending = [NSMutableSet set];
+    return self;
+}
+
+- (void) dealloc {
+    // 后台队列中的任务持有 self, 此时已全部完成
+    ksy_pcm_cache_destroy(_cache);
+}
+
+- (void) setBudgetMB:(int)budgetMB {
+    _budgetMB = budgetMB;
+    ksy_pcm_cache_set_budget(_cache, (int64_t)budgetMB << 20);
+}
+
+- (KSYPcmCacheStat) stat {
+    KSYPcmCacheStat st = {0};
+    ksy_pcm_cache_get_stat(_cache, &st);
+    return st;
+}
+
+- (KSYPcmMap*) mapFile:(NSString*)path {
+    if (path.length == 0) {
+        return NULL;
+    }
+    return ksy_pcm_cache_open(_cache, path.fileSystemRepresentation);
+}
+
+- (void) clear {
+    ksy_pcm_cache_clear(_cache);
+}
+
+#pragma mark - store
+- (BOOL) storePcm:(const int16_t*)pcm
+          nbFrame:(int64_t)nbFrame
+          forFile:(NSString*)path {
+    if (pcm == NULL || nbFrame <= 0 || path.length == 0) {
+        return NO;
+    }
+    KSYPcmWriter * w = ksy_pcm_cache_begin(_cache, path.fileSystemRepresentation);
+    for (int64_t pos = 0; w && pos < nbFrame; pos += FILE_CACHE_CHUNK) {
+        int n = (int)MIN(nbFrame - pos, FILE_CACHE_CHUNK);
+        if (!ksy_pcm_writer_write(w, pcm + pos * _fmt.chCnt, n)) {
+            ksy_pcm_writer_abort(w);
+            return NO;
+        }
+    }
+    return ksy_pcm_writer_commit(w);
+}
+
+- (BOOL) cacheFile:(NSString*)path {
+    KSYPcmMap * map = [self mapFile:path];
+    if (map) {
+        ksy_pcm_map_release(map);
+        return YES;
+    }
+    ExtAudioFileRef file = NULL;
+    NSURL * url = path.length ? [NSURL fileURLWithPath:path] : nil;
+    if (url == nil || ExtAudioFileOpenURL((__bridge CFURLRef)url, &file) != noErr) {
+        return NO;
+    }
+    // 由ExtAudioFile完成解码/重采样/声道转换
+    int ch = _fmt.chCnt;
+    AudioStreamBasicDescription asbd = {0};
+    asbd.mSampleRate       = _fmt.sampleRate;
+    asbd.mFormatID         = kAudioFormatLinearPCM;
+    asbd.mFormatFlags      = kAudioFormatFlagIsSignedInteger | kAudioFormatFlagIsPacked;
+    asbd.mChannelsPerFrame = ch;
+    asbd.mBitsPerChannel   = 16;
+    asbd.mBytesPerFrame    = sizeof(int16_t) * ch;
+    asbd.mFramesPerPacket  = 1;
+    asbd.mBytesPerPacket   = asbd.mBytesPerFrame;
+    KSYPcmWriter * w   = NULL;
+    int16_t *      pcm = malloc(sizeof(int16_t) * FILE_CACHE_CHUNK * ch);
+    if (pcm && ExtAudioFileSetProperty(file, kExtAudioFileProperty_ClientDataFormat,
+                                       sizeof(asbd), &asbd) == noErr) {
+        w = ksy_pcm_cache_begin(_cache, path.fileSystemRepresentation);
+    }
+    while (w) {
+        UInt32 nb = FILE_CACHE_CHUNK;
+        AudioBufferList abl;
+        abl.mNumberBuffers = 1;
+        abl.mBuffers[0].mNumberChannels = ch;
+        abl.mBuffers[0].mDataByteSize   = nb * asbd.mBytesPerFrame;
+        abl.mBuffers[0].mData           = pcm;
+        if (ExtAudioFileRead(file, &nb, &abl) != noErr ||
+            !ksy_pcm_writer_write(w, pcm, nb)) {
+            ksy_pcm_writer_abort(w);
+            w = NULL;
+            break;
+        }
+        if (nb == 0) {
+            break;
+        }
+    }
+    ExtAudioFileDispose(file);
+    free(pcm);
+    return w ? ksy_pcm_writer_commit(w) : NO;
+}
+
+- (void) cacheFileAsync:(NSString*)path {
+    if (path.length == 0) {
+        return;
+    }
+    @synchronized (_pending) {
+        if ([_pending containsObject:path]) {
+            return;
+        }
+        [_pending addObject:path];
+    }
+    dispatch_async(_queue, ^{
+        [self cacheFile:path];
+        @synchronized (self->_pending) {
+            [self->_pending removeObject:path];
+        }
+    });
+}
+
+@end
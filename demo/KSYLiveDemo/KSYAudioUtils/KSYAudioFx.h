@@ -0,0 +1,123 @@
+//
+//  KSYAudioFx.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** 效果器的统一接口和内置效果器
+
+ 1. 每个效果器实现一组函数 (KSYAudioFxClass), 原地处理一块交织的float数据
+ 2. 所有内存在 create 中分配, process 中不分配内存, 不加锁
+ 3. 参数统一用 (序号, float值) 设置, 由效果链在处理线程上调用
+ 4. 自定义效果器实现同样的接口即可加入效果链 (见 KSYAudioFxChain)
+ */
+
+/// 效果器的最大参数个数
+#define KSY_FX_MAX_PARAM  16
+
+/// 效果器的实现
+typedef struct {
+    /// 名称 (用于统计和调试输出)
+    const char *  name;
+    /// 参数个数 (不超过 KSY_FX_MAX_PARAM)
+    int           nbParam;
+    /// 各参数的默认值
+    const float * defParam;
+    /// 创建实例, 所有内存在此分配; maxFrame 为每次 process 的最大帧数; 不支持的格式返回NULL
+    void* (*create)   (int rate, int chCnt, int maxFrame);
+    /// 销毁实例
+    void  (*destroy)  (void* ctx);
+    /// 设置第idx个参数
+    void  (*set_param)(void* ctx, int idx, float value);
+    /// 原地处理 nbFrame 帧交织数据
+    void  (*process)  (void* ctx, float* pcm, int nbFrame);
+    /// 清空内部状态 (延迟线/包络等)
+    void  (*reset)    (void* ctx);
+} KSYAudioFxClass;
+
+#pragma mark - 参数均衡器
+/// 参数均衡: 低架 + 2段峰值 + 高架, 增益为0dB的段不参与计算
+typedef NS_ENUM(int, KSYFxEqParam) {
+    /// 低架滤波的转折频率 (Hz), 默认100
+    KSYFxEq_LowFreq = 0,
+    /// 低架滤波的增益 (dB, -24~24), 默认0
+    KSYFxEq_LowGain,
+    /// 第1段峰值滤波的中心频率 (Hz), 默认800
+    KSYFxEq_Mid1Freq,
+    /// 第1段峰值滤波的增益 (dB), 默认0
+    KSYFxEq_Mid1Gain,
+    /// 第1段峰值滤波的Q值 (0.1~10), 默认1.0
+    KSYFxEq_Mid1Q,
+    /// 第2段峰值滤波的中心频率 (Hz), 默认3000
+    KSYFxEq_Mid2Freq,
+    /// 第2段峰值滤波的增益 (dB), 默认0
+    KSYFxEq_Mid2Gain,
+    /// 第2段峰值滤波的Q值, 默认1.0
+    KSYFxEq_Mid2Q,
+    /// 高架滤波的转折频率 (Hz), 默认8000
+    KSYFxEq_HighFreq,
+    /// 高架滤波的增益 (dB), 默认0
+    KSYFxEq_HighGain,
+    KSYFxEq_NbParam
+};
+extern const KSYAudioFxClass ksy_fx_eq;
+
+#pragma mark - 变调
+/// 变调不变速 (双读头延迟线, 40ms窗口交叉淡化), 用于变声
+typedef NS_ENUM(int, KSYFxPitchParam) {
+    /// 音高偏移 (半音, -12~12), 默认0
+    KSYFxPitch_Semitone = 0,
+    /// 变调后声音的比例 (0~1), 其余为原声, 默认1
+    KSYFxPitch_Mix,
+    KSYFxPitch_NbParam
+};
+extern const KSYAudioFxClass ksy_fx_pitch;
+
+#pragma mark - 噪声门
+/// 噪声门: 电平低于门限一段时间后衰减到 range
+typedef NS_ENUM(int, KSYFxGateParam) {
+    /// 开启门限 (dBFS), 默认-45
+    KSYFxGate_ThresholdDb = 0,
+    /// 关闭时的增益 (dB, -80~0), 默认-40
+    KSYFxGate_RangeDb,
+    /// 开启的时间常数 (毫秒), 默认2
+    KSYFxGate_AttackMs,
+    /// 关闭的时间常数 (毫秒), 默认120
+    KSYFxGate_ReleaseMs,
+    /// 电平低于门限后保持开启的时长 (毫秒), 默认60
+    KSYFxGate_HoldMs,
+    KSYFxGate_NbParam
+};
+extern const KSYAudioFxClass ksy_fx_gate;
+
+#pragma mark - 混响
+/// 混响 (见 KSYAudioFdnReverb), 参数顺序与 KSYReverbParam 相同, 仅支持1~2声道
+typedef NS_ENUM(int, KSYFxReverbParam) {
+    /// 房间大小 (0~1), 默认0.5
+    KSYFxReverb_RoomSize = 0,
+    /// 高频阻尼 (0~1), 默认0.5
+    KSYFxReverb_Damping,
+    /// 混响声的比例 (0~1), 默认0.3
+    KSYFxReverb_Wet,
+    /// 原声的比例 (0~1), 默认1
+    KSYFxReverb_Dry,
+    /// 预延迟 (0~100毫秒), 默认20
+    KSYFxReverb_PreDelayMs,
+    KSYFxReverb_NbParam
+};
+extern const KSYAudioFxClass ksy_fx_reverb;
+
+#pragma mark - 降噪
+/// 降噪 (见 KSYAudioDenoise), 采样率需为100的整数倍, 有20ms的延迟
+typedef NS_ENUM(int, KSYFxDenoiseParam) {
+    /// 降噪等级 (KSYDenoiseLevel, 0~4), 默认2
+    KSYFxDenoise_Level = 0,
+    /// 每10ms帧的时间预算 (微秒), 0为不限制, 默认0
+    KSYFxDenoise_BudgetUs,
+    KSYFxDenoise_NbParam
+};
+extern const KSYAudioFxClass ksy_fx_denoise;
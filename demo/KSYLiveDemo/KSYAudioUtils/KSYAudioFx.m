@@ -0,0 +1,456 @@
+//
+//  KSYAudioFx.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioFx.h"
+#import "KSYAudioFdnReverb.h"
+#import "KSYAudioDenoise.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define FX_MAX_CH   2
+
+static double timeCoef(double ms, int rate) {
+    return ms > 0 ? 1.0 - exp(-1000.0 / (ms * rate)) : 1.0;
+}
+
+static inline float clampf(float v, float lo, float hi) {
+    return v > hi ? hi : (v > lo ? v : lo);
+}
+
+#pragma mark - EQ
+#define EQ_NB_BAND  4
+
+typedef struct {
+    float b0, b1, b2, a1, a2;
+    float z1[FX_MAX_CH];
+    float z2[FX_MAX_CH];
+    BOOL  bOn;
+} EqBand;
+
+typedef struct {
+    int     rate;
+    int     chCnt;
+    float   param[KSYFxEq_NbParam];
+    BOOL    bDirty;
+    EqBand  band[EQ_NB_BAND];
+} EqCtx;
+
+static const float s_eqDef[KSYFxEq_NbParam] = {
+    100, 0, 800, 0, 1.0f, 3000, 0, 1.0f, 8000, 0
+};
+
+// RBJ Audio EQ Cookbook, type: 0 低架, 1 峰值, 2 高架
+static void eqDesign(EqBand* b, int type, double freq, double gainDb, double q, int rate) {
+    BOOL bOn = fabs(gainDb) >= 0.01;
+    if (!bOn) {
+        if (b->bOn) {
+            memset(b->z1, 0, sizeof(b->z1));
+            memset(b->z2, 0, sizeof(b->z2));
+        }
+        b->bOn = NO;
+        return;
+    }
+    freq = freq < 10 ? 10 : (freq > rate * 0.45 ? rate * 0.45 : freq);
+    double A  = pow(10.0, gainDb / 40);
+    double w  = 2 * M_PI * freq / rate;
+    double cw = cos(w), sw = sin(w);
+    double b0, b1, b2, a0, a1, a2;
+    if (type == 1) {
+        double alpha = sw / (2 * q);
+        b0 = 1 + alpha*A;  b1 = -2*cw;  b2 = 1 - alpha*A;
+        a0 = 1 + alpha/A;  a1 = -2*cw;  a2 = 1 - alpha/A;
+    }
+    else {
+        double alpha = sw / 2 * M_SQRT2; // 斜率 S=1
+        double k = 2 * sqrt(A) * alpha;
+        double s = type == 0 ? 1 : -1;   // 高架把低架公式中 cos 的符号取反
+        b0 =    A*((A+1) - s*(A-1)*cw + k);
+        b1 =  2*s*A*((A-1) - s*(A+1)*cw);
+        b2 =    A*((A+1) - s*(A-1)*cw - k);
+        a0 =       (A+1) + s*(A-1)*cw + k;
+        a1 =   -2*s*((A-1) + s*(A+1)*cw);
+        a2 =       (A+1) + s*(A-1)*cw - k;
+    }
+    b->b0 = (float)(b0/a0);
+    b->b1 = (float)(b1/a0);
+    b->b2 = (float)(b2/a0);
+    b->a1 = (float)(a1/a0);
+    b->a2 = (float)(a2/a0);
+    b->bOn = YES;
+}
+
+static void* eqCreate(int rate, int chCnt, int maxFrame) {
+    if (rate <= 0 || chCnt < 1 || chCnt > FX_MAX_CH) {
+        return NULL;
+    }
+    EqCtx * eq = calloc(1, sizeof(EqCtx));
+    if (eq == NULL) {
+        return NULL;
+    }
+    eq->rate  = rate;
+    eq->chCnt = chCnt;
+    memcpy(eq->param, s_eqDef, sizeof(s_eqDef));
+    eq->bDirty = YES;
+    return eq;
+}
+
+static void eqSetParam(void* ctx, int idx, float value) {
+    EqCtx * eq = ctx;
+    if (idx >= 0 && idx < KSYFxEq_NbParam && eq->param[idx] != value) {
+        eq->param[idx] = value;
+        eq->bDirty = YES;
+    }
+}
+
+static void eqProcess(void* ctx, float* pcm, int nbFrame) {
+    EqCtx * eq = ctx;
+    const float * p = eq->param;
+    if (eq->bDirty) { // 一次处理前只重算一次系数
+        eqDesign(&eq->band[0], 0, p[KSYFxEq_LowFreq],  clampf(p[KSYFxEq_LowGain],  -24, 24), 0, eq->rate);
+        eqDesign(&eq->band[1], 1, p[KSYFxEq_Mid1Freq], clampf(p[KSYFxEq_Mid1Gain], -24, 24),
+                 clampf(p[KSYFxEq_Mid1Q], 0.1f, 10), eq->rate);
+        eqDesign(&eq->band[2], 1, p[KSYFxEq_Mid2Freq], clampf(p[KSYFxEq_Mid2Gain], -24, 24),
+                 clampf(p[KSYFxEq_Mid2Q], 0.1f, 10), eq->rate);
+        eqDesign(&eq->band[3], 2, p[KSYFxEq_HighFreq], clampf(p[KSYFxEq_HighGain], -24, 24), 0, eq->rate);
+        eq->bDirty = NO;
+    }
+    const int ch = eq->chCnt;
+    for (int b = 0; b < EQ_NB_BAND; ++b) {
+        EqBand * f = &eq->band[b];
+        if (!f->bOn) {
+            continue;
+        }
+        // 转置直接II型, 逐段处理整块数据, 系数和状态留在寄存器中
+        for (int c = 0; c < ch; ++c) {
+            float z1 = f->z1[c], z2 = f->z2[c];
+            float * x = pcm + c;
+            for (int i = 0; i < nbFrame; ++i, x += ch) {
+                float in  = *x;
+                float out = f->b0*in + z1;
+                z1 = f->b1*in - f->a1*out + z2;
+                z2 = f->b2*in - f->a2*out;
+                *x = out;
+            }
+            f->z1[c] = z1;
+            f->z2[c] = z2;
+        }
+    }
+}
+
+static void eqReset(void* ctx) {
+    EqCtx * eq = ctx;
+    for (int b = 0; b < EQ_NB_BAND; ++b) {
+        memset(eq->band[b].z1, 0, sizeof(eq->band[b].z1));
+        memset(eq->band[b].z2, 0, sizeof(eq->band[b].z2));
+    }
+}
+
+const KSYAudioFxClass ksy_fx_eq = {
+    "eq", KSYFxEq_NbParam, s_eqDef, eqCreate, free, eqSetParam, eqProcess, eqReset
+};
+
+#pragma mark - pitch
+#define PITCH_WIN_MS  40
+#define PITCH_TAB     512  // 交叉淡化窗的查表精度
+
+typedef struct {
+    int     chCnt;
+    float * buf;      // 各声道的延迟线, 连续存放
+    int     mask;
+    uint32_t pos;
+    float   win;      // 窗口长度(帧)
+    double  phase;    // 读头1在窗口中的位置 (0~1)
+    double  step;     // 每帧 phase 的增量
+    float   mix;
+    float   fade[PITCH_TAB + 1];  // 汉宁窗 0.5-0.5cos(2πp), p 取 0~1
+} PitchCtx;
+
+static const float s_pitchDef[KSYFxPitch_NbParam] = { 0, 1.0f };
+
+static void* pitchCreate(int rate, int chCnt, int maxFrame) {
+    if (rate <= 0 || chCnt < 1 || chCnt > FX_MAX_CH) {
+        return NULL;
+    }
+    PitchCtx * ps = calloc(1, sizeof(PitchCtx));
+    if (ps == NULL) {
+        return NULL;
+    }
+    ps->chCnt = chCnt;
+    ps->win   = (float)rate * PITCH_WIN_MS / 1000;
+    int cap = 1;
+    while (cap < (int)ps->win + 4) {
+        cap <<= 1;
+    }
+    ps->mask = cap - 1;
+    ps->buf  = calloc((size_t)cap * chCnt, sizeof(float));
+    if (ps->buf == NULL) {
+        free(ps);
+        return NULL;
+    }
+    for (int i = 0; i <= PITCH_TAB; ++i) {
+        ps->fade[i] = (float)(0.5 - 0.5 * cos(2 * M_PI * i / PITCH_TAB));
+    }
+    ps->mix = 1.0f;
+    return ps;
+}
+
+static void pitchDestroy(void* ctx) {
+    PitchCtx * ps = ctx;
+    if (ps) {
+        free(ps->buf);
+        free(ps);
+    }
+}
+
+static void pitchSetParam(void* ctx, int idx, float value) {
+    PitchCtx * ps = ctx;
+    if (idx == KSYFxPitch_Semitone) {
+        double ratio = pow(2.0, clampf(value, -12, 12) / 12.0);
+        // 读头相对写头的延迟每帧变化 (1-ratio), 延迟在 [0, win) 内循环
+        ps->step = (1.0 - ratio) / ps->win;
+    }
+    else if (idx == KSYFxPitch_Mix) {
+        ps->mix = clampf(value, 0, 1);
+    }
+}
+
+static inline float pitchTap(const float* line, int mask, uint32_t pos, float d) {
+    int   di = (int)d;
+    float fr = d - di;
+    float a  = line[(pos - di)     & mask];
+    float b  = line[(pos - di - 1) & mask];
+    return a + (b - a) * fr;
+}
+
+static void pitchProcess(void* ctx, float* pcm, int nbFrame) {
+    PitchCtx * ps = ctx;
+    const int ch = ps->chCnt, mask = ps->mask, cap = mask + 1;
+    if (ps->step == 0 || ps->mix == 0) { // 不变调时只更新延迟线
+        for (int i = 0; i < nbFrame; ++i, ++ps->pos) {
+            for (int c = 0; c < ch; ++c) {
+                ps->buf[c*cap + (ps->pos & mask)] = pcm[i*ch + c];
+            }
+        }
+        return;
+    }
+    const float mix = ps->mix, dry = 1.0f - mix;
+    double phase = ps->phase;
+    for (int i = 0; i < nbFrame; ++i, ++ps->pos) {
+        phase += ps->step;
+        phase -= floor(phase);
+        double p2 = phase + 0.5;
+        p2 -= floor(p2);
+        float d1 = (float)(phase * ps->win);
+        float d2 = (float)(p2 * ps->win);
+        // 两个读头相差半个窗口, 汉宁窗交叉淡化, 权重之和为1
+        float g1 = ps->fade[(int)(phase * PITCH_TAB + 0.5)];
+        for (int c = 0; c < ch; ++c) {
+            float * line = ps->buf + c*cap;
+            float * x    = pcm + i*ch + c;
+            line[ps->pos & mask] = *x;
+            float y = g1 * pitchTap(line, mask, ps->pos, d1) +
+                      (1.0f - g1) * pitchTap(line, mask, ps->pos, d2);
+            *x = *x * dry + y * mix;
+        }
+    }
+    ps->phase = phase;
+}
+
+static void pitchReset(void* ctx) {
+    PitchCtx * ps = ctx;
+    memset(ps->buf, 0, sizeof(float) * (ps->mask + 1) * ps->chCnt);
+    ps->phase = 0;
+}
+
+const KSYAudioFxClass ksy_fx_pitch = {
+    "pitch", KSYFxPitch_NbParam, s_pitchDef, pitchCreate, pitchDestroy,
+    pitchSetParam, pitchProcess, pitchReset
+};
+
+#pragma mark - gate
+#define GATE_DET_MS  10.0   // 电平检测的释放时间
+
+typedef struct {
+    int     rate;
+    int     chCnt;
+    float   param[KSYFxGate_NbParam];
+    float   thr;
+    float   range;
+    float   atkCoef;
+    float   relCoef;
+    float   detCoef;
+    int     holdFrames;
+    // 状态
+    float   env;
+    float   gain;
+    int     holdLeft;
+} GateCtx;
+
+static const float s_gateDef[KSYFxGate_NbParam] = { -45, -40, 2, 120, 60 };
+
+static void gateSetParam(void* ctx, int idx, float value) {
+    GateCtx * g = ctx;
+    if (idx < 0 || idx >= KSYFxGate_NbParam) {
+        return;
+    }
+    g->param[idx] = value;
+    g->thr        = powf(10.0f, g->param[KSYFxGate_ThresholdDb] / 20);
+    g->range      = powf(10.0f, clampf(g->param[KSYFxGate_RangeDb], -80, 0) / 20);
+    g->atkCoef    = (float)timeCoef(g->param[KSYFxGate_AttackMs], g->rate);
+    g->relCoef    = (float)timeCoef(g->param[KSYFxGate_ReleaseMs], g->rate);
+    g->holdFrames = (int)(g->param[KSYFxGate_HoldMs] * g->rate / 1000);
+}
+
+static void* gateCreate(int rate, int chCnt, int maxFrame) {
+    if (rate <= 0 || chCnt < 1 || chCnt > FX_MAX_CH) {
+        return NULL;
+    }
+    GateCtx * g = calloc(1, sizeof(GateCtx));
+    if (g == NULL) {
+        return NULL;
+    }
+    g->rate    = rate;
+    g->chCnt   = chCnt;
+    g->detCoef = (float)timeCoef(GATE_DET_MS, rate);
+    memcpy(g->param, s_gateDef, sizeof(s_gateDef));
+    gateSetParam(g, 0, s_gateDef[0]);
+    g->gain = 1.0f;
+    return g;
+}
+
+static void gateProcess(void* ctx, float* pcm, int nbFrame) {
+    GateCtx * g = ctx;
+    const int ch = g->chCnt;
+    float env = g->env, gain = g->gain;
+    int holdLeft = g->holdLeft;
+    for (int i = 0; i < nbFrame; ++i) {
+        float * x = pcm + i*ch;
+        float pk = fabsf(x[0]);
+        for (int c = 1; c < ch; ++c) {
+            pk = fabsf(x[c]) > pk ? fabsf(x[c]) : pk;
+        }
+        // 峰值立即跟随, 下降时平滑
+        env = pk > env ? pk : env + (pk - env) * g->detCoef;
+        if (env > g->thr) {
+            holdLeft = g->holdFrames;
+        }
+        else if (holdLeft > 0) {
+            --holdLeft;
+        }
+        float target = (env > g->thr || holdLeft > 0) ? 1.0f : g->range;
+        gain += (target - gain) * (target > gain ? g->atkCoef : g->relCoef);
+        for (int c = 0; c < ch; ++c) {
+            x[c] *= gain;
+        }
+    }
+    g->env      = env;
+    g->gain     = gain;
+    g->holdLeft = holdLeft;
+}
+
+static void gateReset(void* ctx) {
+    GateCtx * g = ctx;
+    g->env      = 0;
+    g->gain     = 1.0f;
+    g->holdLeft = 0;
+}
+
+const KSYAudioFxClass ksy_fx_gate = {
+    "gate", KSYFxGate_NbParam, s_gateDef, gateCreate, free, gateSetParam, gateProcess, gateReset
+};
+
+#pragma mark - reverb
+typedef struct {
+    KSYAudioFdnReverb * fdn;
+    KSYReverbParam      param;
+    BOOL                bDirty;
+} ReverbCtx;
+
+static const float s_reverbDef[KSYFxReverb_NbParam] = { 0.5f, 0.5f, 0.3f, 1.0f, 20.0f };
+
+static void* reverbCreate(int rate, int chCnt, int maxFrame) {
+    ReverbCtx * rv = calloc(1, sizeof(ReverbCtx));
+    if (rv == NULL) {
+        return NULL;
+    }
+    rv->fdn = ksy_fdn_create(rate, chCnt);
+    if (rv->fdn == NULL) {
+        free(rv);
+        return NULL;
+    }
+    memcpy(&rv->param, s_reverbDef, sizeof(rv->param));
+    return rv;
+}
+
+static void reverbDestroy(void* ctx) {
+    ReverbCtx * rv = ctx;
+    if (rv) {
+        ksy_fdn_destroy(rv->fdn);
+        free(rv);
+    }
+}
+
+static void reverbSetParam(void* ctx, int idx, float value) {
+    ReverbCtx * rv = ctx;
+    if (idx >= 0 && idx < KSYFxReverb_NbParam) {
+        ((float*)&rv->param)[idx] = value; // 参数顺序与 KSYReverbParam 的字段一致
+        rv->bDirty = YES;
+    }
+}
+
+static void reverbProcess(void* ctx, float* pcm, int nbFrame) {
+    ReverbCtx * rv = ctx;
+    if (rv->bDirty) {
+        ksy_fdn_set_param(rv->fdn, &rv->param);
+        rv->bDirty = NO;
+    }
+    ksy_fdn_process_f32(rv->fdn, pcm, nbFrame);
+}
+
+static void reverbReset(void* ctx) {
+    ksy_fdn_reset(((ReverbCtx*)ctx)->fdn);
+}
+
+const KSYAudioFxClass ksy_fx_reverb = {
+    "reverb", KSYFxReverb_NbParam, s_reverbDef, reverbCreate, reverbDestroy,
+    reverbSetParam, reverbProcess, reverbReset
+};
+
+#pragma mark - denoise
+static const float s_denoiseDef[KSYFxDenoise_NbParam] = { KSYDenoiseLevel_Medium, 0 };
+
+static void* denoiseCreate(int rate, int chCnt, int maxFrame) {
+    return ksy_denoise_create(rate, chCnt);
+}
+
+static void denoiseDestroy(void* ctx) {
+    ksy_denoise_destroy(ctx);
+}
+
+static void denoiseSetParam(void* ctx, int idx, float value) {
+    if (idx == KSYFxDenoise_Level) {
+        ksy_denoise_set_level(ctx, (KSYDenoiseLevel)lrintf(value));
+    }
+    else if (idx == KSYFxDenoise_BudgetUs) {
+        ksy_denoise_set_budget(ctx, value);
+    }
+}
+
+static void denoiseProcess(void* ctx, float* pcm, int nbFrame) {
+    ksy_denoise_process_f32(ctx, pcm, nbFrame);
+}
+
+static void denoiseReset(void* ctx) {
+    ksy_denoise_reset(ctx);
+}
+
+const KSYAudioFxClass ksy_fx_denoise = {
+    "denoise", KSYFxDenoise_NbParam, s_denoiseDef, denoiseCreate, denoiseDestroy,
+    denoiseSetParam, denoiseProcess, denoiseReset
+};
@@ -0,0 +1,101 @@
+//
+//  KSYAudioFxChain.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "KSYAudioFx.h"
+
+/** 效果链: 按顺序原地运行一组效果器
+
+ 1. 数据按 maxFrame 分块, S16 输入只转换一次到预分配的float块, 所有效果器在同一块上原地处理
+ 2. 效果器实例在处理线程上按需创建(首次处理或格式变化时), 之后处理过程中不分配内存
+ 3. 参数和旁路开关可以在任意线程设置 (原子变量), 下一块数据开始生效
+ 4. 可以统计每个效果器每块数据的耗时, 用于性能分析
+ */
+typedef struct _KSYAudioFxChain KSYAudioFxChain;
+
+/// 效果链中效果器的最大个数
+#define KSY_FX_CHAIN_MAX  8
+
+/**
+ @abstract  创建效果链
+ @param     maxFrame 每块的最大帧数 (16~4096)
+ */
+KSYAudioFxChain* ksy_fxchain_create(int maxFrame);
+
+/**
+ @abstract  销毁
+ */
+void ksy_fxchain_destroy(KSYAudioFxChain* chain);
+
+/**
+ @abstract  在链尾加入一个效果器 (任意线程, 不能与其他 add 并发)
+ @param     cls 效果器的实现, 需要在效果链的生存期内有效
+ @return    效果器在链中的序号; -1 表示已满或参数错误
+ @discussion 参数取 cls->defParam, 实例在下一次处理时创建
+ */
+int ksy_fxchain_add(KSYAudioFxChain* chain, const KSYAudioFxClass* cls);
+
+/**
+ @abstract  效果器的个数
+ */
+int ksy_fxchain_count(const KSYAudioFxChain* chain);
+
+/**
+ @abstract  第fx个效果器的实现
+ */
+const KSYAudioFxClass* ksy_fxchain_class(const KSYAudioFxChain* chain, int fx);
+
+/**
+ @abstract  设置第fx个效果器的第idx个参数 (任意线程)
+ */
+void ksy_fxchain_set_param(KSYAudioFxChain* chain, int fx, int idx, float value);
+
+/**
+ @abstract  读取参数 (任意线程)
+ */
+float ksy_fxchain_get_param(const KSYAudioFxChain* chain, int fx, int idx);
+
+/**
+ @abstract  旁路第fx个效果器 (任意线程); 旁路期间不处理数据, 恢复时先清空其内部状态
+ */
+void ksy_fxchain_set_bypass(KSYAudioFxChain* chain, int fx, BOOL bBypass);
+
+/**
+ @abstract  原地处理S16交织数据 (处理线程)
+ @param     rate    采样率
+ @param     chCnt   声道数
+ @return    NO 表示部分效果器不支持该格式, 这些效果器被跳过
+ @discussion rate 或 chCnt 与上一次不同时, 重新创建所有效果器实例
+ */
+BOOL ksy_fxchain_process_s16(KSYAudioFxChain* chain, int16_t* pcm, int nbFrame,
+                             int rate, int chCnt);
+
+/**
+ @abstract  原地处理float交织数据 (处理线程), 不经过内部的块缓冲
+ */
+BOOL ksy_fxchain_process_f32(KSYAudioFxChain* chain, float* pcm, int nbFrame,
+                             int rate, int chCnt);
+
+/**
+ @abstract  清空所有效果器的内部状态 (处理线程)
+ */
+void ksy_fxchain_reset(KSYAudioFxChain* chain);
+
+/**
+ @abstract  开始/停止统计耗时 (任意线程), 开始时清空之前的统计
+ */
+void ksy_fxchain_enable_profile(KSYAudioFxChain* chain, BOOL bEnable);
+
+/**
+ @abstract  第fx个效果器的耗时统计 (任意线程)
+ @param     nsTotal 累计耗时 (纳秒)
+ @param     nbBlock 累计处理的块数
+ @param     nbFrame 累计处理的帧数
+ */
+void ksy_fxchain_get_profile(const KSYAudioFxChain* chain, int fx,
+                             int64_t* nsTotal, int64_t* nbBlock, int64_t* nbFrame);
@@ -0,0 +1,314 @@
+//
+//  KSYAudioFxChain.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioFxChain.h"
+#import "KSYAudioKernel.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#define FXC_ALIGN   64
+#define FXC_MAX_CH  8
+
+typedef struct {
+    // 设置线程写入
+    const KSYAudioFxClass * cls;
+    _Atomic float   param[KSY_FX_MAX_PARAM];
+    atomic_uint     version;    // 参数每修改一次加1
+    atomic_bool     bBypass;
+    // 处理线程使用
+    void *          ctx;
+    BOOL            bFailed;    // 当前格式下创建失败, 不再重试
+    unsigned        applied;    // 已应用到实例的参数版本
+    BOOL            bWasBypass;
+    // 统计
+    _Atomic int64_t ns;
+    _Atomic int64_t blocks;
+    _Atomic int64_t frames;
+} FxSlot;
+
+struct _KSYAudioFxChain {
+    FxSlot      slot[KSY_FX_CHAIN_MAX];
+    atomic_int  count;
+    atomic_bool bProfile;
+    int         maxFrame;
+    int         rate;
+    int         chCnt;
+    float *     block;      // maxFrame * FXC_MAX_CH 个float
+};
+
+static int64_t nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+KSYAudioFxChain* ksy_fxchain_create(int maxFrame) {
+    if (maxFrame < 16 || maxFrame > 4096) {
+        return NULL;
+    }
+    KSYAudioFxChain* chain = calloc(1, sizeof(KSYAudioFxChain));
+    if (chain == NULL) {
+        return NULL;
+    }
+    if (posix_memalign((void**)&chain->block, FXC_ALIGN,
+                       sizeof(float) * maxFrame * FXC_MAX_CH)) {
+        free(chain);
+        return NULL;
+    }
+    chain->maxFrame = maxFrame;
+    atomic_init(&chain->count, 0);
+    atomic_init(&chain->bProfile, NO);
+    return chain;
+}
+
+static void destroyInstances(KSYAudioFxChain* chain) {
+    int n = atomic_load(&chain->count);
+    for (int i = 0; i < n; ++i) {
+        FxSlot * s = &chain->slot[i];
+        if (s->ctx) {
+            s->cls->destroy(s->ctx);
+            s->ctx = NULL;
+        }
+        s->bFailed = NO;
+    }
+}
+
+void ksy_fxchain_destroy(KSYAudioFxChain* chain) {
+    if (chain) {
+        destroyInstances(chain);
+        free(chain->block);
+        free(chain);
+    }
+}
+
+int ksy_fxchain_add(KSYAudioFxChain* chain, const KSYAudioFxClass* cls) {
+    if (chain == NULL || cls == NULL || cls->create == NULL ||
+        cls->destroy == NULL || cls->process == NULL ||
+        cls->nbParam < 0 || cls->nbParam > KSY_FX_MAX_PARAM) {
+        return -1;
+    }
+    int n = atomic_load(&chain->count);
+    if (n >= KSY_FX_CHAIN_MAX) {
+        return -1;
+    }
+    FxSlot * s = &chain->slot[n];
+    s->cls = cls;
+    for (int i = 0; i < cls->nbParam; ++i) {
+        atomic_store(&s->param[i], cls->defParam ? cls->defParam[i] : 0.0f);
+    }
+    atomic_store(&s->version, 1);
+    atomic_store(&s->bBypass, NO);
+    // 槽位填好之后再发布, 处理线程看到新的 count 时数据已完整
+    atomic_store_explicit(&chain->count, n + 1, memory_order_release);
+    return n;
+}
+
+int ksy_fxchain_count(const KSYAudioFxChain* chain) {
+    return chain ? atomic_load(&((KSYAudioFxChain*)chain)->count) : 0;
+}
+
+static FxSlot* slotAt(const KSYAudioFxChain* chain, int fx) {
+    if (chain == NULL || fx < 0 || fx >= ksy_fxchain_count(chain)) {
+        return NULL;
+    }
+    return (FxSlot*)&chain->slot[fx];
+}
+
+const KSYAudioFxClass* ksy_fxchain_class(const KSYAudioFxChain* chain, int fx) {
+    FxSlot * s = slotAt(chain, fx);
+    return s ? s->cls : NULL;
+}
+
+void ksy_fxchain_set_param(KSYAudioFxChain* chain, int fx, int idx, float value) {
+    FxSlot * s = slotAt(chain, fx);
+    if (s == NULL || idx < 0 || idx >= s->cls->nbParam) {
+        return;
+    }
+    atomic_store(&s->param[idx], value);
+    atomic_fetch_add(&s->version, 1);
+}
+
+float ksy_fxchain_get_param(const KSYAudioFxChain* chain, int fx, int idx) {
+    FxSlot * s = slotAt(chain, fx);
+    if (s == NULL || idx < 0 || idx >= s->cls->nbParam) {
+        return 0.0f;
+    }
+    return atomic_load(&s->param[idx]);
+}
+
+void ksy_fxchain_set_bypass(KSYAudioFxChain* chain, int fx, BOOL bBypass) {
+    FxSlot * s = slotAt(chain, fx);
+    if (s) {
+        atomic_store(&s->bBypass, bBypass);
+    }
+}
+
+// 处理线程: 按需创建实例并应用参数, 返回NULL表示跳过该效果器
+static void* prepareSlot(KSYAudioFxChain* chain, FxSlot* s) {
+    BOOL bBypass = atomic_load(&s->bBypass);
+    if (bBypass) {
+        s->bWasBypass = YES;
+        return NULL;
+    }
+    if (s->ctx == NULL) {
+        if (s->bFailed) {
+            return NULL;
+        }
+        s->ctx = s->cls->create(chain->rate, chain->chCnt, chain->maxFrame);
+        if (s->ctx == NULL) {
+            s->bFailed = YES;
+            return NULL;
+        }
+        s->applied    = 0;
+        s->bWasBypass = NO;
+    }
+    unsigned ver = atomic_load(&s->version);
+    if (ver != s->applied && s->cls->set_param) {
+        for (int i = 0; i < s->cls->nbParam; ++i) {
+            s->cls->set_param(s->ctx, i, atomic_load(&s->param[i]));
+        }
+    }
+    s->applied = ver;
+    if (s->bWasBypass) { // 旁路期间的状态已过时
+        if (s->cls->reset) {
+            s->cls->reset(s->ctx);
+        }
+        s->bWasBypass = NO;
+    }
+    return s->ctx;
+}
+
+// 格式变化时重建实例; 返回参与处理的效果器个数
+// *nbFx 为链中效果器的个数, *bOK 表示是否全部可用
+static int prepareChain(KSYAudioFxChain* chain, int rate, int chCnt,
+                        void** ctx, int* nbFx, BOOL* bOK) {
+    if (rate != chain->rate || chCnt != chain->chCnt) {
+        destroyInstances(chain);
+        chain->rate  = rate;
+        chain->chCnt = chCnt;
+    }
+    int n = atomic_load_explicit(&chain->count, memory_order_acquire);
+    int nbActive = 0;
+    *nbFx = n;
+    *bOK = YES;
+    for (int i = 0; i < n; ++i) {
+        ctx[i] = prepareSlot(chain, &chain->slot[i]);
+        if (ctx[i]) {
+            ++nbActive;
+        }
+        else if (chain->slot[i].bFailed) {
+            *bOK = NO;
+        }
+    }
+    return nbActive;
+}
+
+static void runBlock(KSYAudioFxChain* chain, void* const* ctx, int n,
+                     float* pcm, int nbFrame, BOOL bProfile) {
+    for (int i = 0; i < n; ++i) {
+        if (ctx[i] == NULL) {
+            continue;
+        }
+        FxSlot * s = &chain->slot[i];
+        if (!bProfile) {
+            s->cls->process(ctx[i], pcm, nbFrame);
+            continue;
+        }
+        int64_t t0 = nowNs();
+        s->cls->process(ctx[i], pcm, nbFrame);
+        atomic_fetch_add_explicit(&s->ns, nowNs() - t0, memory_order_relaxed);
+        atomic_fetch_add_explicit(&s->blocks, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&s->frames, nbFrame, memory_order_relaxed);
+    }
+}
+
+BOOL ksy_fxchain_process_s16(KSYAudioFxChain* chain, int16_t* pcm, int nbFrame,
+                             int rate, int chCnt) {
+    if (chain == NULL || pcm == NULL || nbFrame <= 0 || rate <= 0 ||
+        chCnt < 1 || chCnt > FXC_MAX_CH) {
+        return NO;
+    }
+    void * ctx[KSY_FX_CHAIN_MAX];
+    BOOL bOK = YES;
+    int n = 0;
+    if (prepareChain(chain, rate, chCnt, ctx, &n, &bOK) == 0) {
+        return bOK; // 全部旁路时不做格式转换
+    }
+    BOOL bProfile = atomic_load(&chain->bProfile);
+    while (nbFrame > 0) {
+        int len = nbFrame < chain->maxFrame ? nbFrame : chain->maxFrame;
+        ksy_s16_to_f32(chain->block, pcm, len * chCnt);
+        runBlock(chain, ctx, n, chain->block, len, bProfile);
+        ksy_f32_to_s16(pcm, chain->block, len * chCnt);
+        pcm     += len * chCnt;
+        nbFrame -= len;
+    }
+    return bOK;
+}
+
+BOOL ksy_fxchain_process_f32(KSYAudioFxChain* chain, float* pcm, int nbFrame,
+                             int rate, int chCnt) {
+    if (chain == NULL || pcm == NULL || nbFrame <= 0 || rate <= 0 ||
+        chCnt < 1 || chCnt > FXC_MAX_CH) {
+        return NO;
+    }
+    void * ctx[KSY_FX_CHAIN_MAX];
+    BOOL bOK = YES;
+    int n = 0;
+    if (prepareChain(chain, rate, chCnt, ctx, &n, &bOK) == 0) {
+        return bOK;
+    }
+    BOOL bProfile = atomic_load(&chain->bProfile);
+    while (nbFrame > 0) {
+        int len = nbFrame < chain->maxFrame ? nbFrame : chain->maxFrame;
+        runBlock(chain, ctx, n, pcm, len, bProfile);
+        pcm     += len * chCnt;
+        nbFrame -= len;
+    }
+    return bOK;
+}
+
+void ksy_fxchain_reset(KSYAudioFxChain* chain) {
+    int n = ksy_fxchain_count(chain);
+    for (int i = 0; i < n; ++i) {
+        FxSlot * s = &chain->slot[i];
+        if (s->ctx && s->cls->reset) {
+            s->cls->reset(s->ctx);
+        }
+    }
+}
+
+void ksy_fxchain_enable_profile(KSYAudioFxChain* chain, BOOL bEnable) {
+    if (chain == NULL) {
+        return;
+    }
+    if (bEnable) {
+        for (int i = 0; i < KSY_FX_CHAIN_MAX; ++i) {
+            atomic_store(&chain->slot[i].ns, 0);
+            atomic_store(&chain->slot[i].blocks, 0);
+            atomic_store(&chain->slot[i].frames, 0);
+        }
+    }
+    atomic_store(&chain->bProfile, bEnable);
+}
+
+void ksy_fxchain_get_profile(const KSYAudioFxChain* chain, int fx,
+                             int64_t* nsTotal, int64_t* nbBlock, int64_t* nbFrame) {
+    FxSlot * s = slotAt(chain, fx);
+    if (nsTotal) {
+        *nsTotal = s ? atomic_load(&s->ns) : 0;
+    }
+    if (nbBlock) {
+        *nbBlock = s ? atomic_load(&s->blocks) : 0;
+    }
+    if (nbFrame) {
+        *nbFrame = s ? atomic_load(&s->frames) : 0;
+    }
+}
@@ -0,0 +1,113 @@
+//
+//  KSYAudioKernel.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** 音频处理基础运算 (混音/增益)
+
+ 1. 音量采用Q14定点数表示, 有效范围为 0.0 ~ 1.99
+ 2. S16输出均为饱和运算, 溢出时取 INT16_MAX / INT16_MIN, 不会回绕
+ 3. 根据CPU能力选择实现: arm上使用NEON, x86(模拟器)上运行时检测 AVX2 / SSE2
+ 4. S16运算各个实现的计算结果逐点一致, 可以用 ksy_audio_kernel_force_c 对比验证
+    float运算因累加顺序不同, 各实现间会有舍入误差
+ */
+
+/**
+ @abstract  将一路音频按音量叠加到目标buffer上
+ @param     dst 目标PCM (单声道或交织格式均可)
+ @param     src 被叠加的PCM
+ @param     nbSample 样本个数 (交织格式时为 帧数*声道数)
+ @param     vol 音量比例 (0.0~1.99)
+ @discussion dst[i] = sat16( dst[i] + src[i]*vol )
+ */
+void ksy_mix_s16(int16_t* dst, const int16_t* src, int nbSample, float vol);
+
+/**
+ @abstract  多路音频按各自的音量混合后输出
+ @param     dst  输出PCM
+ @param     srcs 各路输入PCM的指针数组
+ @param     vols 各路的音量
+ @param     nbTrack  输入的路数
+ @param     nbSample 样本个数
+ @discussion 中间结果使用32位累加, 最后只做一次饱和, 避免逐路叠加时的多次削波
+ @discussion dst 可以与 srcs 中的某一路为同一块内存
+ */
+void ksy_mix_tracks_s16(int16_t* dst, const int16_t* const* srcs,
+                        const float* vols, int nbTrack, int nbSample);
+
+/**
+ @abstract  调整一段音频的音量 (原地处理)
+ @param     buf 待处理的PCM
+ @param     nbSample 样本个数
+ @param     vol 音量比例 (0.0~1.99)
+ */
+void ksy_scale_s16(int16_t* buf, int nbSample, float vol);
+
+/**
+ @abstract  同一段数据与两组系数分别求内积 (用于插值滤波)
+ @param     x  输入数据
+ @param     h0 第一组系数
+ @param     h1 第二组系数
+ @param     n  长度
+ @param     s0 输出 sum(x[i]*h0[i])
+ @param     s1 输出 sum(x[i]*h1[i])
+ */
+void ksy_dot2_f32(const float* x, const float* h0, const float* h1, int n,
+                  float* s0, float* s1);
+
+/**
+ @abstract  8行数据逐列做归一化的Hadamard变换 (用于反馈延迟网络的混合矩阵)
+ @param     rows 8行数据的指针, 原地修改
+ @param     n    每行的长度
+ @discussion 每一列的8个值 v 变换为 H8*v/sqrt(8), 能量不变
+ */
+void ksy_hadamard8_f32(float* const* rows, int n);
+
+/**
+ @abstract  S16 转为 float (除以32768)
+ @param     dst 输出, 可以与 src 不重叠的任意内存
+ @param     src 输入
+ @param     nbSample 样本个数
+ */
+void ksy_s16_to_f32(float* dst, const int16_t* src, int nbSample);
+
+/**
+ @abstract  float 转为 S16 (乘以32768, 饱和后就近取整)
+ @param     dst 输出
+ @param     src 输入
+ @param     nbSample 样本个数
+ */
+void ksy_f32_to_s16(int16_t* dst, const float* src, int nbSample);
+
+/**
+ @abstract  互相关 (用于时间伸缩时寻找最相似的位置)
+ @param     ref   参考数据, n 个
+ @param     x     被搜索的数据, 需要 n+nbLag-1 个
+ @param     n     参考数据的长度
+ @param     nbLag 计算的延迟个数
+ @param     out   输出 nbLag 个, out[k] = sum(ref[i]*x[i+k])
+ */
+void ksy_xcorr_f32(const float* ref, const float* x, int n, int nbLag, float* out);
+
+/**
+ @abstract  当前使用的实现的名称 ("neon", "avx2", "sse2", "c")
+ */
+const char* ksy_audio_kernel_name(void);
+
+/**
+ @abstract  强制使用C语言实现 (用于对比性能和结果)
+ @param     bForce YES:使用C实现, NO:恢复自动选择
+ */
+void ksy_audio_kernel_force_c(BOOL bForce);
+
+/**
+ @abstract  指定使用的实现 (用于对比各实现的性能)
+ @param     name 实现的名称 ("c", "sse2", "avx2", "neon"), NULL 为恢复自动选择
+ @return    当前平台不支持该实现时返回NO, 使用的实现不变
+ */
+BOOL ksy_audio_kernel_select(const char* name);
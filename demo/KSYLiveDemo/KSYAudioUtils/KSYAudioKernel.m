@@ -0,0 +1,727 @@
+//
+//  KSYAudioKernel.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioKernel.h"
+#include <pthread.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define KSY_KERNEL_NEON 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KSY_KERNEL_X86  1
+#endif
+
+#define Q14_SHIFT   14
+#define Q14_ROUND   (1 << (Q14_SHIFT-1))
+#define MIX_BLOCK   256  // 多路混合时, 每次累加的样本数
+#define HAD8_NORM   0.35355339059327373f  // 1/sqrt(8)
+#define S16_SCALE   32768.0f
+#define S16_MAXF    32767.0f
+#define S16_MINF    (-32768.0f)
+
+// 8点Hadamard变换的3级蝶形, T为向量类型
+#define HAD8_BUTTERFLY(a, ADD, SUB)                         \
+    for (int h = 1; h < 8; h <<= 1) {                       \
+        for (int j = 0; j < 8; j += h << 1) {               \
+            for (int k = j; k < j + h; ++k) {               \
+                T x = a[k], y = a[k+h];                     \
+                a[k]   = ADD(x, y);                         \
+                a[k+h] = SUB(x, y);                         \
+            }                                               \
+        }                                                   \
+    }
+
+typedef struct {
+    const char * name;
+    // dst = sat16(dst + src*g)
+    void (*mix)  (int16_t* dst, const int16_t* src, int n, int16_t g);
+    // buf = sat16(buf*g)
+    void (*scale)(int16_t* buf, int n, int16_t g);
+    // acc += src*g (每路单独取整)
+    void (*acc)  (int32_t* acc, const int16_t* src, int n, int16_t g);
+    // dst = sat16(acc)
+    void (*pack) (int16_t* dst, const int32_t* acc, int n);
+    // s0 = sum(x*h0), s1 = sum(x*h1)
+    void (*dot2) (const float* x, const float* h0, const float* h1, int n,
+                  float* s0, float* s1);
+    // 8行数据逐列做归一化的Hadamard变换 (原地)
+    void (*had8) (float* const* rows, int n);
+    // dst = src / 32768
+    void (*s2f)  (float* dst, const int16_t* src, int n);
+    // dst = rint(clamp(src * 32768))
+    void (*f2s)  (int16_t* dst, const float* src, int n);
+    // out[k] = sum(ref[i]*x[i+k]), k < nbLag
+    void (*xcorr)(const float* ref, const float* x, int n, int nbLag, float* out);
+} KSYAudioKernelTab;
+
+static inline int16_t sat16(int32_t v) {
+    if (v > INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (v < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return (int16_t)v;
+}
+
+static inline int16_t vol2q14(float vol) {
+    if (!(vol > 0.0f)) { // 包括 NaN
+        return 0;
+    }
+    long g = lrintf(vol * (1 << Q14_SHIFT));
+    return g > INT16_MAX ? INT16_MAX : (int16_t)g;
+}
+
+#pragma mark - C
+static void mix_c(int16_t* dst, const int16_t* src, int n, int16_t g) {
+    for (int i = 0; i < n; ++i) {
+        int16_t t = sat16((src[i]*g + Q14_ROUND) >> Q14_SHIFT);
+        dst[i] = sat16(dst[i] + t);
+    }
+}
+static void scale_c(int16_t* buf, int n, int16_t g) {
+    for (int i = 0; i < n; ++i) {
+        buf[i] = sat16((buf[i]*g + Q14_ROUND) >> Q14_SHIFT);
+    }
+}
+static void acc_c(int32_t* acc, const int16_t* src, int n, int16_t g) {
+    for (int i = 0; i < n; ++i) {
+        acc[i] += (src[i]*g + Q14_ROUND) >> Q14_SHIFT;
+    }
+}
+static void pack_c(int16_t* dst, const int32_t* acc, int n) {
+    for (int i = 0; i < n; ++i) {
+        dst[i] = sat16(acc[i]);
+    }
+}
+static void dot2_c(const float* x, const float* h0, const float* h1, int n,
+                   float* s0, float* s1) {
+    float a = 0.0f, b = 0.0f;
+    for (int i = 0; i < n; ++i) {
+        a += x[i] * h0[i];
+        b += x[i] * h1[i];
+    }
+    *s0 = a;
+    *s1 = b;
+}
+#define ADD_C(x, y) ((x) + (y))
+#define SUB_C(x, y) ((x) - (y))
+static void had8_c(float* const* rows, int n) {
+    typedef float T;
+    for (int i = 0; i < n; ++i) {
+        T a[8];
+        for (int k = 0; k < 8; ++k) {
+            a[k] = rows[k][i];
+        }
+        HAD8_BUTTERFLY(a, ADD_C, SUB_C)
+        for (int k = 0; k < 8; ++k) {
+            rows[k][i] = a[k] * HAD8_NORM;
+        }
+    }
+}
+// 处理各行从 off 开始的尾部数据
+static void had8_tail(float* const* rows, int off, int n) {
+    float * t[8];
+    for (int k = 0; k < 8; ++k) {
+        t[k] = rows[k] + off;
+    }
+    had8_c(t, n - off);
+}
+// 先在float上饱和再取整, 与各SIMD实现的结果一致
+static void s2f_c(float* dst, const int16_t* src, int n) {
+    for (int i = 0; i < n; ++i) {
+        dst[i] = src[i] * (1.0f / S16_SCALE);
+    }
+}
+static void f2s_c(int16_t* dst, const float* src, int n) {
+    for (int i = 0; i < n; ++i) {
+        float v = src[i] * S16_SCALE;
+        v = v > S16_MAXF ? S16_MAXF : (v < S16_MINF ? S16_MINF : v);
+        dst[i] = (int16_t)lrintf(v);
+    }
+}
+static void xcorr_c(const float* ref, const float* x, int n, int nbLag, float* out) {
+    for (int k = 0; k < nbLag; ++k) {
+        float s = 0.0f;
+        for (int i = 0; i < n; ++i) {
+            s += ref[i] * x[i+k];
+        }
+        out[k] = s;
+    }
+}
+// 向量部分之后, ref 从 i0 开始的尾部加到 out[0..3] 上
+static void xcorr4_tail(const float* ref, const float* x, int i0, int n, float* out) {
+    for (int i = i0; i < n; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            out[j] += ref[i] * x[i+j];
+        }
+    }
+}
+static const KSYAudioKernelTab s_tabC = { "c", mix_c, scale_c, acc_c, pack_c, dot2_c, had8_c, s2f_c, f2s_c, xcorr_c };
+
+#pragma mark - NEON
+#if KSY_KERNEL_NEON
+static inline int16x8_t mul_q14_neon(int16x8_t s, int16_t g) {
+    int32x4_t lo = vmull_n_s16(vget_low_s16(s),  g);
+    int32x4_t hi = vmull_n_s16(vget_high_s16(s), g);
+    return vcombine_s16(vqrshrn_n_s32(lo, Q14_SHIFT), vqrshrn_n_s32(hi, Q14_SHIFT));
+}
+static void mix_neon(int16_t* dst, const int16_t* src, int n, int16_t g) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t t = mul_q14_neon(vld1q_s16(src+i), g);
+        vst1q_s16(dst+i, vqaddq_s16(vld1q_s16(dst+i), t));
+    }
+    mix_c(dst+i, src+i, n-i, g);
+}
+static void scale_neon(int16_t* buf, int n, int16_t g) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        vst1q_s16(buf+i, mul_q14_neon(vld1q_s16(buf+i), g));
+    }
+    scale_c(buf+i, n-i, g);
+}
+static void acc_neon(int32_t* acc, const int16_t* src, int n, int16_t g) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t s  = vld1q_s16(src+i);
+        int32x4_t lo = vrshrq_n_s32(vmull_n_s16(vget_low_s16(s),  g), Q14_SHIFT);
+        int32x4_t hi = vrshrq_n_s32(vmull_n_s16(vget_high_s16(s), g), Q14_SHIFT);
+        vst1q_s32(acc+i,   vaddq_s32(vld1q_s32(acc+i),   lo));
+        vst1q_s32(acc+i+4, vaddq_s32(vld1q_s32(acc+i+4), hi));
+    }
+    acc_c(acc+i, src+i, n-i, g);
+}
+static void pack_neon(int16_t* dst, const int32_t* acc, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int16x4_t lo = vqmovn_s32(vld1q_s32(acc+i));
+        int16x4_t hi = vqmovn_s32(vld1q_s32(acc+i+4));
+        vst1q_s16(dst+i, vcombine_s16(lo, hi));
+    }
+    pack_c(dst+i, acc+i, n-i);
+}
+static void dot2_neon(const float* x, const float* h0, const float* h1, int n,
+                      float* s0, float* s1) {
+    float32x4_t a = vdupq_n_f32(0.0f);
+    float32x4_t b = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = vld1q_f32(x+i);
+        a = vmlaq_f32(a, v, vld1q_f32(h0+i));
+        b = vmlaq_f32(b, v, vld1q_f32(h1+i));
+    }
+    float ta, tb;
+    dot2_c(x+i, h0+i, h1+i, n-i, &ta, &tb);
+    float32x2_t sa = vadd_f32(vget_low_f32(a), vget_high_f32(a));
+    float32x2_t sb = vadd_f32(vget_low_f32(b), vget_high_f32(b));
+    *s0 = vget_lane_f32(vpadd_f32(sa, sa), 0) + ta;
+    *s1 = vget_lane_f32(vpadd_f32(sb, sb), 0) + tb;
+}
+static void had8_neon(float* const* rows, int n) {
+    typedef float32x4_t T;
+    const T s = vdupq_n_f32(HAD8_NORM);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        T a[8];
+        for (int k = 0; k < 8; ++k) {
+            a[k] = vld1q_f32(rows[k]+i);
+        }
+        HAD8_BUTTERFLY(a, vaddq_f32, vsubq_f32)
+        for (int k = 0; k < 8; ++k) {
+            vst1q_f32(rows[k]+i, vmulq_f32(a[k], s));
+        }
+    }
+    had8_tail(rows, i, n);
+}
+static void s2f_neon(float* dst, const int16_t* src, int n) {
+    const float32x4_t k = vdupq_n_f32(1.0f / S16_SCALE);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t s = vld1q_s16(src+i);
+        vst1q_f32(dst+i,   vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(s))),  k));
+        vst1q_f32(dst+i+4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(s))), k));
+    }
+    s2f_c(dst+i, src+i, n-i);
+}
+#if defined(__aarch64__)
+static void f2s_neon(int16_t* dst, const float* src, int n) {
+    const float32x4_t k  = vdupq_n_f32(S16_SCALE);
+    const float32x4_t hi = vdupq_n_f32(S16_MAXF);
+    const float32x4_t lo = vdupq_n_f32(S16_MINF);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t a = vminq_f32(vmaxq_f32(vmulq_f32(vld1q_f32(src+i),   k), lo), hi);
+        float32x4_t b = vminq_f32(vmaxq_f32(vmulq_f32(vld1q_f32(src+i+4), k), lo), hi);
+        vst1q_s16(dst+i, vcombine_s16(vmovn_s32(vcvtnq_s32_f32(a)),
+                                      vmovn_s32(vcvtnq_s32_f32(b))));
+    }
+    f2s_c(dst+i, src+i, n-i);
+}
+#else
+// armv7 的NEON没有就近取整的转换指令
+#define f2s_neon f2s_c
+#endif
+// 每次计算4个延迟, ref 只加载一次
+static void xcorr_neon(const float* ref, const float* x, int n, int nbLag, float* out) {
+    int k = 0;
+    for (; k + 4 <= nbLag; k += 4) {
+        const float * p = x + k;
+        float32x4_t a0 = vdupq_n_f32(0.0f), a1 = a0, a2 = a0, a3 = a0;
+        int i = 0;
+        for (; i + 4 <= n; i += 4) {
+            float32x4_t r = vld1q_f32(ref+i);
+            a0 = vmlaq_f32(a0, r, vld1q_f32(p+i));
+            a1 = vmlaq_f32(a1, r, vld1q_f32(p+i+1));
+            a2 = vmlaq_f32(a2, r, vld1q_f32(p+i+2));
+            a3 = vmlaq_f32(a3, r, vld1q_f32(p+i+3));
+        }
+        float32x2_t s01 = vpadd_f32(vadd_f32(vget_low_f32(a0), vget_high_f32(a0)),
+                                    vadd_f32(vget_low_f32(a1), vget_high_f32(a1)));
+        float32x2_t s23 = vpadd_f32(vadd_f32(vget_low_f32(a2), vget_high_f32(a2)),
+                                    vadd_f32(vget_low_f32(a3), vget_high_f32(a3)));
+        vst1q_f32(out+k, vcombine_f32(s01, s23));
+        xcorr4_tail(ref, p, i, n, out+k);
+    }
+    xcorr_c(ref, x+k, n, nbLag-k, out+k);
+}
+static const KSYAudioKernelTab s_tabNeon = { "neon", mix_neon, scale_neon, acc_neon, pack_neon, dot2_neon, had8_neon, s2f_neon, f2s_neon, xcorr_neon };
+#endif
+
+#pragma mark - SSE2 / AVX2
+#if KSY_KERNEL_X86
+// 8个S16与Q14音量相乘, 取整后得到两组32位结果
+static inline void mul_q14_sse2(__m128i s, __m128i g, __m128i* lo, __m128i* hi) {
+    const __m128i rnd = _mm_set1_epi32(Q14_ROUND);
+    __m128i pl = _mm_mullo_epi16(s, g);
+    __m128i ph = _mm_mulhi_epi16(s, g);
+    *lo = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(pl, ph), rnd), Q14_SHIFT);
+    *hi = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(pl, ph), rnd), Q14_SHIFT);
+}
+static void mix_sse2(int16_t* dst, const int16_t* src, int n, int16_t g) {
+    const __m128i vg = _mm_set1_epi16(g);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i lo, hi;
+        mul_q14_sse2(_mm_loadu_si128((const __m128i*)(src+i)), vg, &lo, &hi);
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst+i));
+        _mm_storeu_si128((__m128i*)(dst+i), _mm_adds_epi16(d, _mm_packs_epi32(lo, hi)));
+    }
+    mix_c(dst+i, src+i, n-i, g);
+}
+static void scale_sse2(int16_t* buf, int n, int16_t g) {
+    const __m128i vg = _mm_set1_epi16(g);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i lo, hi;
+        mul_q14_sse2(_mm_loadu_si128((const __m128i*)(buf+i)), vg, &lo, &hi);
+        _mm_storeu_si128((__m128i*)(buf+i), _mm_packs_epi32(lo, hi));
+    }
+    scale_c(buf+i, n-i, g);
+}
+static void acc_sse2(int32_t* acc, const int16_t* src, int n, int16_t g) {
+    const __m128i vg = _mm_set1_epi16(g);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i lo, hi;
+        mul_q14_sse2(_mm_loadu_si128((const __m128i*)(src+i)), vg, &lo, &hi);
+        __m128i a0 = _mm_loadu_si128((const __m128i*)(acc+i));
+        __m128i a1 = _mm_loadu_si128((const __m128i*)(acc+i+4));
+        _mm_storeu_si128((__m128i*)(acc+i),   _mm_add_epi32(a0, lo));
+        _mm_storeu_si128((__m128i*)(acc+i+4), _mm_add_epi32(a1, hi));
+    }
+    acc_c(acc+i, src+i, n-i, g);
+}
+static void pack_sse2(int16_t* dst, const int32_t* acc, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i a0 = _mm_loadu_si128((const __m128i*)(acc+i));
+        __m128i a1 = _mm_loadu_si128((const __m128i*)(acc+i+4));
+        _mm_storeu_si128((__m128i*)(dst+i), _mm_packs_epi32(a0, a1));
+    }
+    pack_c(dst+i, acc+i, n-i);
+}
+static inline float hsum_sse(__m128 v) {
+    __m128 t = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    t = _mm_add_ss(t, _mm_shuffle_ps(t, t, 1));
+    return _mm_cvtss_f32(t);
+}
+static void dot2_sse2(const float* x, const float* h0, const float* h1, int n,
+                      float* s0, float* s1) {
+    __m128 a = _mm_setzero_ps();
+    __m128 b = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_loadu_ps(x+i);
+        a = _mm_add_ps(a, _mm_mul_ps(v, _mm_loadu_ps(h0+i)));
+        b = _mm_add_ps(b, _mm_mul_ps(v, _mm_loadu_ps(h1+i)));
+    }
+    float ta, tb;
+    dot2_c(x+i, h0+i, h1+i, n-i, &ta, &tb);
+    *s0 = hsum_sse(a) + ta;
+    *s1 = hsum_sse(b) + tb;
+}
+static void had8_sse2(float* const* rows, int n) {
+    typedef __m128 T;
+    const T s = _mm_set1_ps(HAD8_NORM);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        T a[8];
+        for (int k = 0; k < 8; ++k) {
+            a[k] = _mm_loadu_ps(rows[k]+i);
+        }
+        HAD8_BUTTERFLY(a, _mm_add_ps, _mm_sub_ps)
+        for (int k = 0; k < 8; ++k) {
+            _mm_storeu_ps(rows[k]+i, _mm_mul_ps(a[k], s));
+        }
+    }
+    had8_tail(rows, i, n);
+}
+static void s2f_sse2(float* dst, const int16_t* src, int n) {
+    const __m128 k = _mm_set1_ps(1.0f / S16_SCALE);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i s  = _mm_loadu_si128((const __m128i*)(src+i));
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+        _mm_storeu_ps(dst+i,   _mm_mul_ps(_mm_cvtepi32_ps(lo), k));
+        _mm_storeu_ps(dst+i+4, _mm_mul_ps(_mm_cvtepi32_ps(hi), k));
+    }
+    s2f_c(dst+i, src+i, n-i);
+}
+static void f2s_sse2(int16_t* dst, const float* src, int n) {
+    const __m128 k  = _mm_set1_ps(S16_SCALE);
+    const __m128 hi = _mm_set1_ps(S16_MAXF);
+    const __m128 lo = _mm_set1_ps(S16_MINF);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src+i),   k), lo), hi);
+        __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src+i+4), k), lo), hi);
+        __m128i p = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128((__m128i*)(dst+i), p);
+    }
+    f2s_c(dst+i, src+i, n-i);
+}
+// 4个累加器转置后相加, 得到4个延迟的结果
+static inline __m128 hsum4_sse(__m128 a0, __m128 a1, __m128 a2, __m128 a3) {
+    _MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+    return _mm_add_ps(_mm_add_ps(a0, a1), _mm_add_ps(a2, a3));
+}
+static void xcorr_sse2(const float* ref, const float* x, int n, int nbLag, float* out) {
+    int k = 0;
+    for (; k + 4 <= nbLag; k += 4) {
+        const float * p = x + k;
+        __m128 a0 = _mm_setzero_ps(), a1 = a0, a2 = a0, a3 = a0;
+        int i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128 r = _mm_loadu_ps(ref+i);
+            a0 = _mm_add_ps(a0, _mm_mul_ps(r, _mm_loadu_ps(p+i)));
+            a1 = _mm_add_ps(a1, _mm_mul_ps(r, _mm_loadu_ps(p+i+1)));
+            a2 = _mm_add_ps(a2, _mm_mul_ps(r, _mm_loadu_ps(p+i+2)));
+            a3 = _mm_add_ps(a3, _mm_mul_ps(r, _mm_loadu_ps(p+i+3)));
+        }
+        _mm_storeu_ps(out+k, hsum4_sse(a0, a1, a2, a3));
+        xcorr4_tail(ref, p, i, n, out+k);
+    }
+    xcorr_c(ref, x+k, n, nbLag-k, out+k);
+}
+static const KSYAudioKernelTab s_tabSse2 = { "sse2", mix_sse2, scale_sse2, acc_sse2, pack_sse2, dot2_sse2, had8_sse2, s2f_sse2, f2s_sse2, xcorr_sse2 };
+
+#define KSY_AVX2 __attribute__((target("avx2")))
+// 调用SSE2实现处理尾部数据前先 zeroupper, 避免AVX/SSE切换的性能损失
+// 16个S16与Q14音量相乘
+// unpack和packs都是在128位的lane内进行的, 两次的交错正好抵消, 结果顺序不变
+KSY_AVX2 static inline __m256i mul_q14_avx2(__m256i s, __m256i g) {
+    const __m256i rnd = _mm256_set1_epi32(Q14_ROUND);
+    __m256i pl = _mm256_mullo_epi16(s, g);
+    __m256i ph = _mm256_mulhi_epi16(s, g);
+    __m256i lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_unpacklo_epi16(pl, ph), rnd), Q14_SHIFT);
+    __m256i hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_unpackhi_epi16(pl, ph), rnd), Q14_SHIFT);
+    return _mm256_packs_epi32(lo, hi);
+}
+KSY_AVX2 static void mix_avx2(int16_t* dst, const int16_t* src, int n, int16_t g) {
+    const __m256i vg = _mm256_set1_epi16(g);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i t = mul_q14_avx2(_mm256_loadu_si256((const __m256i*)(src+i)), vg);
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst+i));
+        _mm256_storeu_si256((__m256i*)(dst+i), _mm256_adds_epi16(d, t));
+    }
+    _mm256_zeroupper();
+    mix_sse2(dst+i, src+i, n-i, g);
+}
+KSY_AVX2 static void scale_avx2(int16_t* buf, int n, int16_t g) {
+    const __m256i vg = _mm256_set1_epi16(g);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i t = mul_q14_avx2(_mm256_loadu_si256((const __m256i*)(buf+i)), vg);
+        _mm256_storeu_si256((__m256i*)(buf+i), t);
+    }
+    _mm256_zeroupper();
+    scale_sse2(buf+i, n-i, g);
+}
+KSY_AVX2 static void acc_avx2(int32_t* acc, const int16_t* src, int n, int16_t g) {
+    const __m256i vg  = _mm256_set1_epi16(g);
+    const __m256i rnd = _mm256_set1_epi32(Q14_ROUND);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i s  = _mm256_loadu_si256((const __m256i*)(src+i));
+        __m256i pl = _mm256_mullo_epi16(s, vg);
+        __m256i ph = _mm256_mulhi_epi16(s, vg);
+        // lo = [0-3, 8-11], hi = [4-7, 12-15]
+        __m256i lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_unpacklo_epi16(pl, ph), rnd), Q14_SHIFT);
+        __m256i hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_unpackhi_epi16(pl, ph), rnd), Q14_SHIFT);
+        __m256i p0 = _mm256_permute2x128_si256(lo, hi, 0x20);
+        __m256i p1 = _mm256_permute2x128_si256(lo, hi, 0x31);
+        __m256i a0 = _mm256_loadu_si256((const __m256i*)(acc+i));
+        __m256i a1 = _mm256_loadu_si256((const __m256i*)(acc+i+8));
+        _mm256_storeu_si256((__m256i*)(acc+i),   _mm256_add_epi32(a0, p0));
+        _mm256_storeu_si256((__m256i*)(acc+i+8), _mm256_add_epi32(a1, p1));
+    }
+    _mm256_zeroupper();
+    acc_sse2(acc+i, src+i, n-i, g);
+}
+KSY_AVX2 static void pack_avx2(int16_t* dst, const int32_t* acc, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i a0 = _mm256_loadu_si256((const __m256i*)(acc+i));
+        __m256i a1 = _mm256_loadu_si256((const __m256i*)(acc+i+8));
+        // packs 结果为 [a0 0-3, a1 0-3, a0 4-7, a1 4-7], 需要重排64位块
+        __m256i p  = _mm256_permute4x64_epi64(_mm256_packs_epi32(a0, a1), 0xD8);
+        _mm256_storeu_si256((__m256i*)(dst+i), p);
+    }
+    _mm256_zeroupper();
+    pack_sse2(dst+i, acc+i, n-i);
+}
+KSY_AVX2 static void dot2_avx2(const float* x, const float* h0, const float* h1, int n,
+                               float* s0, float* s1) {
+    __m256 a = _mm256_setzero_ps();
+    __m256 b = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(x+i);
+        a = _mm256_add_ps(a, _mm256_mul_ps(v, _mm256_loadu_ps(h0+i)));
+        b = _mm256_add_ps(b, _mm256_mul_ps(v, _mm256_loadu_ps(h1+i)));
+    }
+    __m128 a4 = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+    __m128 b4 = _mm_add_ps(_mm256_castps256_ps128(b), _mm256_extractf128_ps(b, 1));
+    _mm256_zeroupper();
+    float ta, tb;
+    dot2_c(x+i, h0+i, h1+i, n-i, &ta, &tb);
+    *s0 = hsum_sse(a4) + ta;
+    *s1 = hsum_sse(b4) + tb;
+}
+KSY_AVX2 static void had8_avx2(float* const* rows, int n) {
+    typedef __m256 T;
+    const T s = _mm256_set1_ps(HAD8_NORM);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        T a[8];
+        for (int k = 0; k < 8; ++k) {
+            a[k] = _mm256_loadu_ps(rows[k]+i);
+        }
+        HAD8_BUTTERFLY(a, _mm256_add_ps, _mm256_sub_ps)
+        for (int k = 0; k < 8; ++k) {
+            _mm256_storeu_ps(rows[k]+i, _mm256_mul_ps(a[k], s));
+        }
+    }
+    _mm256_zeroupper();
+    had8_tail(rows, i, n);
+}
+KSY_AVX2 static void s2f_avx2(float* dst, const int16_t* src, int n) {
+    const __m256 k = _mm256_set1_ps(1.0f / S16_SCALE);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i s = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src+i)));
+        _mm256_storeu_ps(dst+i, _mm256_mul_ps(_mm256_cvtepi32_ps(s), k));
+    }
+    _mm256_zeroupper();
+    s2f_c(dst+i, src+i, n-i);
+}
+KSY_AVX2 static void f2s_avx2(int16_t* dst, const float* src, int n) {
+    const __m256 k  = _mm256_set1_ps(S16_SCALE);
+    const __m256 hi = _mm256_set1_ps(S16_MAXF);
+    const __m256 lo = _mm256_set1_ps(S16_MINF);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src+i),   k), lo), hi);
+        __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src+i+8), k), lo), hi);
+        // packs 在128位的lane内交错, 同 pack_avx2 重排64位块
+        __m256i p = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        _mm256_storeu_si256((__m256i*)(dst+i), _mm256_permute4x64_epi64(p, 0xD8));
+    }
+    _mm256_zeroupper();
+    f2s_sse2(dst+i, src+i, n-i);
+}
+KSY_AVX2 static void xcorr_avx2(const float* ref, const float* x, int n, int nbLag, float* out) {
+    int k = 0;
+    for (; k + 4 <= nbLag; k += 4) {
+        const float * p = x + k;
+        __m256 a0 = _mm256_setzero_ps(), a1 = a0, a2 = a0, a3 = a0;
+        int i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256 r = _mm256_loadu_ps(ref+i);
+            a0 = _mm256_add_ps(a0, _mm256_mul_ps(r, _mm256_loadu_ps(p+i)));
+            a1 = _mm256_add_ps(a1, _mm256_mul_ps(r, _mm256_loadu_ps(p+i+1)));
+            a2 = _mm256_add_ps(a2, _mm256_mul_ps(r, _mm256_loadu_ps(p+i+2)));
+            a3 = _mm256_add_ps(a3, _mm256_mul_ps(r, _mm256_loadu_ps(p+i+3)));
+        }
+        __m128 b0 = _mm_add_ps(_mm256_castps256_ps128(a0), _mm256_extractf128_ps(a0, 1));
+        __m128 b1 = _mm_add_ps(_mm256_castps256_ps128(a1), _mm256_extractf128_ps(a1, 1));
+        __m128 b2 = _mm_add_ps(_mm256_castps256_ps128(a2), _mm256_extractf128_ps(a2, 1));
+        __m128 b3 = _mm_add_ps(_mm256_castps256_ps128(a3), _mm256_extractf128_ps(a3, 1));
+        _mm_storeu_ps(out+k, hsum4_sse(b0, b1, b2, b3));
+        xcorr4_tail(ref, p, i, n, out+k);
+    }
+    _mm256_zeroupper();
+    xcorr_c(ref, x+k, n, nbLag-k, out+k);
+}
+static const KSYAudioKernelTab s_tabAvx2 = { "avx2", mix_avx2, scale_avx2, acc_avx2, pack_avx2, dot2_avx2, had8_avx2, s2f_avx2, f2s_avx2, xcorr_avx2 };
+#endif
+
+#pragma mark - dispatch
+static const KSYAudioKernelTab * s_bestTab = &s_tabC;
+static pthread_once_t            s_selectOnce = PTHREAD_ONCE_INIT;
+static const KSYAudioKernelTab * volatile s_forceTab = NULL;
+
+static void selectKernel(void) {
+#if KSY_KERNEL_NEON
+    s_bestTab = &s_tabNeon;
+#elif KSY_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        s_bestTab = &s_tabAvx2;
+    }
+    else {
+        s_bestTab = &s_tabSse2;
+    }
+#endif
+}
+
+static inline const KSYAudioKernelTab * kernel(void) {
+    pthread_once(&s_selectOnce, selectKernel);
+    const KSYAudioKernelTab * t = s_forceTab;
+    return t ? t : s_bestTab;
+}
+
+#pragma mark - public
+void ksy_mix_s16(int16_t* dst, const int16_t* src, int nbSample, float vol) {
+    if (dst == NULL || src == NULL || nbSample <= 0) {
+        return;
+    }
+    int16_t g = vol2q14(vol);
+    if (g == 0) {
+        return;
+    }
+    kernel()->mix(dst, src, nbSample, g);
+}
+
+void ksy_mix_tracks_s16(int16_t* dst, const int16_t* const* srcs,
+                        const float* vols, int nbTrack, int nbSample) {
+    if (dst == NULL || nbSample <= 0) {
+        return;
+    }
+    const KSYAudioKernelTab * k = kernel();
+    int32_t acc[MIX_BLOCK] __attribute__((aligned(32)));
+    for (int off = 0; off < nbSample; off += MIX_BLOCK) {
+        int len = nbSample - off;
+        if (len > MIX_BLOCK) {
+            len = MIX_BLOCK;
+        }
+        memset(acc, 0, sizeof(int32_t)*len);
+        for (int t = 0; t < nbTrack; ++t) {
+            int16_t g = vol2q14(vols[t]);
+            if (srcs[t] == NULL || g == 0) { // 静音的track不参与计算
+                continue;
+            }
+            k->acc(acc, srcs[t]+off, len, g);
+        }
+        k->pack(dst+off, acc, len);
+    }
+}
+
+void ksy_scale_s16(int16_t* buf, int nbSample, float vol) {
+    if (buf == NULL || nbSample <= 0) {
+        return;
+    }
+    kernel()->scale(buf, nbSample, vol2q14(vol));
+}
+
+void ksy_dot2_f32(const float* x, const float* h0, const float* h1, int n,
+                  float* s0, float* s1) {
+    if (n <= 0) {
+        *s0 = 0.0f;
+        *s1 = 0.0f;
+        return;
+    }
+    kernel()->dot2(x, h0, h1, n, s0, s1);
+}
+
+void ksy_hadamard8_f32(float* const* rows, int n) {
+    if (rows == NULL || n <= 0) {
+        return;
+    }
+    kernel()->had8(rows, n);
+}
+
+void ksy_s16_to_f32(float* dst, const int16_t* src, int nbSample) {
+    if (dst == NULL || src == NULL || nbSample <= 0) {
+        return;
+    }
+    kernel()->s2f(dst, src, nbSample);
+}
+
+void ksy_f32_to_s16(int16_t* dst, const float* src, int nbSample) {
+    if (dst == NULL || src == NULL || nbSample <= 0) {
+        return;
+    }
+    kernel()->f2s(dst, src, nbSample);
+}
+
+void ksy_xcorr_f32(const float* ref, const float* x, int n, int nbLag, float* out) {
+    if (ref == NULL || x == NULL || out == NULL || n <= 0 || nbLag <= 0) {
+        return;
+    }
+    kernel()->xcorr(ref, x, n, nbLag, out);
+}
+
+const char* ksy_audio_kernel_name(void) {
+    return kernel()->name;
+}
+
+void ksy_audio_kernel_force_c(BOOL bForce) {
+    s_forceTab = bForce ? &s_tabC : NULL;
+}
+
+BOOL ksy_audio_kernel_select(const char* name) {
+    if (name == NULL || name[0] == 0) {
+        s_forceTab = NULL;
+        return YES;
+    }
+    pthread_once(&s_selectOnce, selectKernel);
+    const KSYAudioKernelTab * tabs[4] = { &s_tabC };
+    int nb = 1;
+#if KSY_KERNEL_NEON
+    tabs[nb++] = &s_tabNeon;
+#elif KSY_KERNEL_X86
+    tabs[nb++] = &s_tabSse2;
+    if (s_bestTab == &s_tabAvx2) { // 只在CPU支持时可选
+        tabs[nb++] = &s_tabAvx2;
+    }
+#endif
+    for (int i = 0; i < nb; ++i) {
+        if (strcmp(tabs[i]->name, name) == 0) {
+            s_forceTab = tabs[i];
+            return YES;
+        }
+    }
+    return NO;
+}
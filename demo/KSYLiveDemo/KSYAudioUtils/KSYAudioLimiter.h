@@ -0,0 +1,61 @@
+//
+//  KSYAudioLimiter.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** 预读峰值限幅器
+
+ 1. 输出延迟固定为预读的长度, 增益在峰值到达之前已经降到位, 不会削波
+ 2. 增益的下降是平滑的(长度为预读时长的线性过渡), 恢复按释放时间指数回升
+ 3. 各声道使用相同的增益, 不改变声像
+ 4. 原地处理 S16 交织数据
+ */
+typedef struct _KSYAudioLimiter KSYAudioLimiter;
+
+/**
+ @abstract  创建限幅器
+ @param     rate        采样率
+ @param     chCnt       声道数
+ @param     lookaheadMs 预读时长 (1~20ms), 即增加的延迟
+ @param     releaseMs   释放时间 (增益恢复到 1-1/e 所需的时间)
+ @return    参数错误时返回NULL
+ */
+KSYAudioLimiter* ksy_limiter_create(int rate, int chCnt, float lookaheadMs, float releaseMs);
+
+/**
+ @abstract  销毁
+ */
+void ksy_limiter_destroy(KSYAudioLimiter* lim);
+
+/**
+ @abstract  设置门限 (dBFS, 默认 -1.0), 任意线程
+ */
+void ksy_limiter_set_threshold(KSYAudioLimiter* lim, float thresholdDb);
+
+/**
+ @abstract  原地处理
+ @param     pcm     S16 交织数据
+ @param     nbFrame 帧数
+ @discussion 输出相对输入延迟 ksy_limiter_latency 帧
+ */
+void ksy_limiter_process_s16(KSYAudioLimiter* lim, int16_t* pcm, int nbFrame);
+
+/**
+ @abstract  延迟 (帧)
+ */
+int ksy_limiter_latency(const KSYAudioLimiter* lim);
+
+/**
+ @abstract  最近一次 process 中最大的增益衰减 (dB, >=0), 任意线程
+ */
+float ksy_limiter_reduction(const KSYAudioLimiter* lim);
+
+/**
+ @abstract  清空延迟线和增益状态 (与 process 在同一线程调用)
+ */
+void ksy_limiter_reset(KSYAudioLimiter* lim);
@@ -0,0 +1,188 @@
+//
+//  KSYAudioLimiter.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioLimiter.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define LIM_MAX_CH  8
+
+/* 输出第 t 帧时, 送出的是第 t-L 帧输入:
+   1. hold[t] = min(req[t-L .. t]), 滑动最小值 (单调队列)
+   2. box[t]  = mean(hold[t-L+1 .. t]), 每一项都不大于 req[t-L]
+   3. 增益只在 box 回升时按释放时间平滑, 所以始终不大于 req[t-L] */
+struct _KSYAudioLimiter {
+    int             rate;
+    int             chCnt;
+    int             L;          // 预读帧数
+    double          relCoef;
+    _Atomic float   thresh;     // 线性值
+    _Atomic float   outReduction;
+    // 延迟线
+    int16_t *       delay;      // L 帧
+    int             dPos;
+    // 滑动最小值的单调队列, 容量 L+1
+    float *         qVal;
+    uint64_t *      qIdx;
+    int             qHead;
+    int             qLen;
+    uint64_t        n;          // 已处理的帧数
+    // 平滑
+    float *         box;        // L 个 hold 值
+    int             bPos;
+    double          bSum;
+    double          gain;
+};
+
+KSYAudioLimiter* ksy_limiter_create(int rate, int chCnt, float lookaheadMs, float releaseMs) {
+    if (rate <= 0 || chCnt <= 0 || chCnt > LIM_MAX_CH ||
+        !(lookaheadMs >= 1.0f && lookaheadMs <= 20.0f) || !(releaseMs > 0)) {
+        return NULL;
+    }
+    KSYAudioLimiter* lim = calloc(1, sizeof(KSYAudioLimiter));
+    if (lim == NULL) {
+        return NULL;
+    }
+    lim->rate    = rate;
+    lim->chCnt   = chCnt;
+    lim->L       = (int)lroundf(lookaheadMs * rate / 1000.0f);
+    lim->L       = lim->L > 0 ? lim->L : 1;
+    lim->relCoef = 1.0 - exp(-1000.0 / ((double)releaseMs * rate));
+    lim->delay   = malloc(sizeof(int16_t) * lim->L * chCnt);
+    lim->qVal    = malloc(sizeof(float) * (lim->L + 1));
+    lim->qIdx    = malloc(sizeof(uint64_t) * (lim->L + 1));
+    lim->box     = malloc(sizeof(float) * lim->L);
+    if (!lim->delay || !lim->qVal || !lim->qIdx || !lim->box) {
+        ksy_limiter_destroy(lim);
+        return NULL;
+    }
+    atomic_init(&lim->thresh, powf(10.0f, -1.0f / 20.0f));
+    atomic_init(&lim->outReduction, 0.0f);
+    ksy_limiter_reset(lim);
+    return lim;
+}
+
+void ksy_limiter_destroy(KSYAudioLimiter* lim) {
+    if (lim == NULL) {
+        return;
+    }
+    free(lim->delay);
+    free(lim->qVal);
+    free(lim->qIdx);
+    free(lim->box);
+    free(lim);
+}
+
+void ksy_limiter_reset(KSYAudioLimiter* lim) {
+    if (lim == NULL) {
+        return;
+    }
+    memset(lim->delay, 0, sizeof(int16_t) * lim->L * lim->chCnt);
+    for (int i = 0; i < lim->L; ++i) {
+        lim->box[i] = 1.0f;
+    }
+    lim->dPos  = 0;
+    lim->qHead = 0;
+    lim->qLen  = 0;
+    lim->n     = 0;
+    lim->bPos  = 0;
+    lim->bSum  = lim->L;
+    lim->gain  = 1.0;
+}
+
+void ksy_limiter_set_threshold(KSYAudioLimiter* lim, float thresholdDb) {
+    if (lim == NULL || !(thresholdDb <= 0.0f && thresholdDb > -40.0f)) {
+        return;
+    }
+    atomic_store_explicit(&lim->thresh, powf(10.0f, thresholdDb / 20.0f),
+                          memory_order_relaxed);
+}
+
+int ksy_limiter_latency(const KSYAudioLimiter* lim) {
+    return lim ? lim->L : 0;
+}
+
+float ksy_limiter_reduction(const KSYAudioLimiter* lim) {
+    if (lim == NULL) {
+        return 0;
+    }
+    return atomic_load_explicit(&((KSYAudioLimiter*)lim)->outReduction,
+                                memory_order_relaxed);
+}
+
+void ksy_limiter_process_s16(KSYAudioLimiter* lim, int16_t* pcm, int nbFrame) {
+    if (lim == NULL || pcm == NULL || nbFrame <= 0) {
+        return;
+    }
+    const int   ch     = lim->chCnt;
+    const int   L      = lim->L;
+    const int   qCap   = L + 1;
+    const float thresh = atomic_load_explicit(&lim->thresh, memory_order_relaxed) * 32768.0f;
+    float minGain = 1.0f;
+    for (int i = 0; i < nbFrame; ++i) {
+        int16_t * x = pcm + i*ch;
+        // 本帧需要的增益
+        int peak = 0;
+        for (int c = 0; c < ch; ++c) {
+            int a = abs(x[c]);
+            peak  = a > peak ? a : peak;
+        }
+        float req = peak > thresh ? thresh / peak : 1.0f;
+        // 滑动最小值: 去掉队尾更大的值和队首过期的值
+        while (lim->qLen > 0 &&
+               lim->qVal[(lim->qHead + lim->qLen - 1) % qCap] >= req) {
+            lim->qLen -= 1;
+        }
+        int tail = (lim->qHead + lim->qLen) % qCap;
+        lim->qVal[tail] = req;
+        lim->qIdx[tail] = lim->n;
+        lim->qLen += 1;
+        if (lim->qIdx[lim->qHead] + L < lim->n) {
+            lim->qHead = (lim->qHead + 1) % qCap;
+            lim->qLen -= 1;
+        }
+        float hold = lim->qVal[lim->qHead];
+        // 滑动平均, 每转一圈重新求和消除累积误差
+        lim->bSum += (double)hold - lim->box[lim->bPos];
+        lim->box[lim->bPos] = hold;
+        lim->bPos += 1;
+        if (lim->bPos == L) {
+            lim->bPos = 0;
+            lim->bSum = 0;
+            for (int k = 0; k < L; ++k) {
+                lim->bSum += lim->box[k];
+            }
+        }
+        double target = lim->bSum / L;
+        if (target < lim->gain) {
+            lim->gain = target;
+        }
+        else {
+            lim->gain += (target - lim->gain) * lim->relCoef;
+            if (target - lim->gain < 1e-5) { // 不再需要限幅时回到精确的直通
+                lim->gain = target;
+            }
+        }
+        minGain = lim->gain < minGain ? (float)lim->gain : minGain;
+        // 延迟线: 取出L帧之前的数据, 放入当前帧
+        int16_t * d = lim->delay + lim->dPos*ch;
+        for (int c = 0; c < ch; ++c) {
+            int16_t in = x[c];
+            float   y  = (float)(d[c] * lim->gain);
+            int     v  = (int)lrintf(y);
+            x[c] = (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+            d[c] = in;
+        }
+        lim->dPos = lim->dPos + 1 == L ? 0 : lim->dPos + 1;
+        lim->n   += 1;
+    }
+    atomic_store_explicit(&lim->outReduction, minGain < 1.0f ? -20.0f * log10f(minGain) : 0.0f,
+                          memory_order_relaxed);
+}
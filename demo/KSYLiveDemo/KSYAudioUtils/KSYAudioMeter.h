@@ -0,0 +1,77 @@
+//
+//  KSYAudioMeter.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** 响度/电平表 (EBU R128)
+
+ 1. 响度按 ITU-R BS.1770 计算: K加权滤波后的均方值, 单位 LUFS
+ 2. 每100ms更新一次: 瞬时响度(400ms窗), 短期响度(3s窗), 积分响度(双门限)
+ 3. 同时给出未加权的峰值和RMS电平 (dBFS, 400ms窗)
+ 4. 只有一个线程调用 process, 读取结果无锁, 可在任意线程调用
+ */
+typedef struct _KSYAudioMeter KSYAudioMeter;
+
+/// 无信号时的电平值
+#define KSY_METER_FLOOR  (-120.0f)
+
+/// 电平表的读数
+typedef struct {
+    /// 峰值电平 (dBFS), 最近400ms
+    float peak;
+    /// RMS电平 (dBFS), 最近400ms
+    float rms;
+    /// 开始(或reset)以来的最大峰值 (dBFS)
+    float maxPeak;
+    /// 瞬时响度 (LUFS)
+    float momentary;
+    /// 短期响度 (LUFS)
+    float shortTerm;
+    /// 积分响度 (LUFS), 没有超过门限的数据时为 KSY_METER_FLOOR
+    float integrated;
+} KSYAudioLevel;
+
+/**
+ @abstract  创建电平表
+ @param     rate  采样率
+ @param     chCnt 声道数 (1~8, 第4声道之后按环绕声道加权)
+ @return    参数错误时返回NULL
+ */
+KSYAudioMeter* ksy_meter_create(int rate, int chCnt);
+
+/**
+ @abstract  销毁
+ */
+void ksy_meter_destroy(KSYAudioMeter* meter);
+
+/**
+ @abstract  送入数据
+ @param     pcm     S16 交织数据
+ @param     nbFrame 帧数
+ */
+void ksy_meter_process_s16(KSYAudioMeter* meter, const int16_t* pcm, int nbFrame);
+
+/**
+ @abstract  读取当前的读数 (任意线程)
+ */
+void ksy_meter_get(const KSYAudioMeter* meter, KSYAudioLevel* level);
+
+/**
+ @abstract  清空积分响度和最大峰值 (与 process 在同一线程调用)
+ */
+void ksy_meter_reset(KSYAudioMeter* meter);
+
+/**
+ @abstract  采样率
+ */
+int ksy_meter_rate(const KSYAudioMeter* meter);
+
+/**
+ @abstract  声道数
+ */
+int ksy_meter_channels(const KSYAudioMeter* meter);
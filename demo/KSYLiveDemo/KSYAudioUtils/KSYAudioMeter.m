@@ -0,0 +1,287 @@
+//
+//  KSYAudioMeter.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioMeter.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define METER_MAX_CH     8
+#define METER_NB_SUB     30    // 100ms一个子块, 保存3秒
+#define METER_NB_MOMENT  4     // 瞬时响度为4个子块
+#define METER_ABS_GATE   (-70.0)
+#define METER_REL_GATE   (-10.0)
+// 积分响度的直方图: -70 ~ +10 LUFS, 每格0.1LU, 相对门限按格的下沿判断
+#define METER_HIST_MIN   (-70.0)
+#define METER_HIST_STEP  0.1
+#define METER_HIST_BINS  800
+
+typedef struct {
+    double b0, b1, b2, a1, a2;
+} KSYBiquad;
+
+typedef struct {
+    double z1, z2;
+} KSYBiquadState;
+
+typedef struct {
+    double kPow;    // K加权后的均方值, 各声道加权求和
+    double rawPow;  // 未加权的均方值, 各声道平均
+    float  peak;
+} KSYMeterSub;
+
+struct _KSYAudioMeter {
+    int             rate;
+    int             chCnt;
+    int             subLen;      // 子块的帧数
+    double          chWeight[METER_MAX_CH];
+    KSYBiquad       shelf;
+    KSYBiquad       hpf;
+    KSYBiquadState  st[METER_MAX_CH][2];
+    // 当前子块的累加值
+    double          kAcc[METER_MAX_CH];
+    double          rawAcc;
+    float           peakAcc;
+    int             subPos;
+    // 最近的子块
+    KSYMeterSub     sub[METER_NB_SUB];
+    int             subIdx;      // 下一个写入的位置
+    int             subCnt;      // 已有的子块数 (不超过 METER_NB_SUB)
+    uint32_t        hist[METER_HIST_BINS];     // 各格的块数
+    double          histPow[METER_HIST_BINS];  // 各格的块的均方值之和
+    float           maxPeak;
+    // 读数
+    _Atomic float   outPeak;
+    _Atomic float   outRms;
+    _Atomic float   outMaxPeak;
+    _Atomic float   outMomentary;
+    _Atomic float   outShortTerm;
+    _Atomic float   outIntegrated;
+};
+
+static inline float powToDb(double p) {
+    return p > 1e-12 ? (float)(10.0 * log10(p)) : KSY_METER_FLOOR;
+}
+
+static inline float powToLufs(double p) {
+    return p > 1e-12 ? (float)(-0.691 + 10.0 * log10(p)) : KSY_METER_FLOOR;
+}
+
+static inline double biquadRun(const KSYBiquad* f, KSYBiquadState* s, double x) {
+    double y = f->b0 * x + s->z1;
+    s->z1 = f->b1 * x - f->a1 * y + s->z2;
+    s->z2 = f->b2 * x - f->a2 * y;
+    return y;
+}
+
+// BS.1770 的两级K加权滤波器, 按采样率重新推导系数
+static void buildKWeight(KSYAudioMeter* m) {
+    double f0 = 1681.974450955533;
+    double G  = 3.999843853973347;
+    double Q  = 0.7071752369554196;
+    double K  = tan(M_PI * f0 / m->rate);
+    double Vh = pow(10.0, G / 20.0);
+    double Vb = pow(Vh, 0.4996667741545416);
+    double a0 = 1.0 + K / Q + K * K;
+    m->shelf.b0 = (Vh + Vb * K / Q + K * K) / a0;
+    m->shelf.b1 = 2.0 * (K * K - Vh) / a0;
+    m->shelf.b2 = (Vh - Vb * K / Q + K * K) / a0;
+    m->shelf.a1 = 2.0 * (K * K - 1.0) / a0;
+    m->shelf.a2 = (1.0 - K / Q + K * K) / a0;
+
+    f0 = 38.13547087602444;
+    Q  = 0.5003270373238773;
+    K  = tan(M_PI * f0 / m->rate);
+    a0 = 1.0 + K / Q + K * K;
+    m->hpf.b0 = 1.0;
+    m->hpf.b1 = -2.0;
+    m->hpf.b2 = 1.0;
+    m->hpf.a1 = 2.0 * (K * K - 1.0) / a0;
+    m->hpf.a2 = (1.0 - K / Q + K * K) / a0;
+}
+
+KSYAudioMeter* ksy_meter_create(int rate, int chCnt) {
+    if (rate < 8000 || chCnt <= 0 || chCnt > METER_MAX_CH) {
+        return NULL;
+    }
+    KSYAudioMeter* m = calloc(1, sizeof(KSYAudioMeter));
+    if (m == NULL) {
+        return NULL;
+    }
+    m->rate   = rate;
+    m->chCnt  = chCnt;
+    m->subLen = rate / 10;
+    for (int c = 0; c < chCnt; ++c) { // L R C LFE Ls Rs ..., LFE 不计入
+        m->chWeight[c] = c == 3 && chCnt > 4 ? 0.0 : (c >= 4 ? 1.41 : 1.0);
+    }
+    buildKWeight(m);
+    atomic_init(&m->outPeak, KSY_METER_FLOOR);
+    atomic_init(&m->outRms, KSY_METER_FLOOR);
+    atomic_init(&m->outMaxPeak, KSY_METER_FLOOR);
+    atomic_init(&m->outMomentary, KSY_METER_FLOOR);
+    atomic_init(&m->outShortTerm, KSY_METER_FLOOR);
+    atomic_init(&m->outIntegrated, KSY_METER_FLOOR);
+    return m;
+}
+
+void ksy_meter_destroy(KSYAudioMeter* meter) {
+    free(meter);
+}
+
+void ksy_meter_reset(KSYAudioMeter* meter) {
+    if (meter == NULL) {
+        return;
+    }
+    memset(meter->hist, 0, sizeof(meter->hist));
+    memset(meter->histPow, 0, sizeof(meter->histPow));
+    meter->maxPeak = 0;
+    atomic_store_explicit(&meter->outMaxPeak, KSY_METER_FLOOR, memory_order_relaxed);
+    atomic_store_explicit(&meter->outIntegrated, KSY_METER_FLOOR, memory_order_relaxed);
+}
+
+int ksy_meter_rate(const KSYAudioMeter* meter) {
+    return meter ? meter->rate : 0;
+}
+
+int ksy_meter_channels(const KSYAudioMeter* meter) {
+    return meter ? meter->chCnt : 0;
+}
+
+// 最近n个子块的平均值
+static void subAverage(const KSYAudioMeter* m, int n, double* kPow, double* rawPow, float* peak) {
+    n = n < m->subCnt ? n : m->subCnt;
+    double k = 0, r = 0;
+    float  p = 0;
+    for (int i = 1; i <= n; ++i) {
+        const KSYMeterSub* s = &m->sub[(m->subIdx - i + METER_NB_SUB) % METER_NB_SUB];
+        k += s->kPow;
+        r += s->rawPow;
+        p  = s->peak > p ? s->peak : p;
+    }
+    *kPow = n > 0 ? k / n : 0;
+    if (rawPow) {
+        *rawPow = n > 0 ? r / n : 0;
+    }
+    if (peak) {
+        *peak = p;
+    }
+}
+
+// 双门限: 先去掉 -70LUFS 以下的块, 再去掉比剩余均值低 10LU 以上的块
+static double integratedPow(const KSYAudioMeter* m) {
+    double sum = 0;
+    uint64_t cnt = 0;
+    for (int b = 0; b < METER_HIST_BINS; ++b) {
+        sum += m->histPow[b];
+        cnt += m->hist[b];
+    }
+    if (cnt == 0) {
+        return 0;
+    }
+    double relGate = -0.691 + 10.0 * log10(sum / cnt) + METER_REL_GATE;
+    int    first   = (int)floor((relGate - METER_HIST_MIN) / METER_HIST_STEP);
+    first = first < 0 ? 0 : first;
+    sum = 0;
+    cnt = 0;
+    for (int b = first; b < METER_HIST_BINS; ++b) {
+        sum += m->histPow[b];
+        cnt += m->hist[b];
+    }
+    return cnt ? sum / cnt : 0;
+}
+
+// 一个子块结束: 更新各读数
+static void finishSub(KSYAudioMeter* m) {
+    KSYMeterSub* s = &m->sub[m->subIdx];
+    s->kPow = 0;
+    for (int c = 0; c < m->chCnt; ++c) {
+        s->kPow += m->chWeight[c] * m->kAcc[c] / m->subPos;
+        m->kAcc[c] = 0;
+    }
+    s->rawPow  = m->rawAcc / ((double)m->subPos * m->chCnt);
+    s->peak    = m->peakAcc;
+    m->subIdx  = (m->subIdx + 1) % METER_NB_SUB;
+    m->subCnt += m->subCnt < METER_NB_SUB ? 1 : 0;
+    m->rawAcc  = 0;
+    m->peakAcc = 0;
+    m->subPos  = 0;
+
+    double kMoment, rawMoment, kShort;
+    float  peak;
+    subAverage(m, METER_NB_MOMENT, &kMoment, &rawMoment, &peak);
+    subAverage(m, METER_NB_SUB, &kShort, NULL, NULL);
+    if (m->subCnt >= METER_NB_MOMENT) { // 400ms的块, 每100ms一个 (重叠75%)
+        double lufs = -0.691 + 10.0 * log10(kMoment > 1e-20 ? kMoment : 1e-20);
+        if (lufs > METER_ABS_GATE) {
+            int b = (int)((lufs - METER_HIST_MIN) / METER_HIST_STEP);
+            b = b < METER_HIST_BINS ? b : METER_HIST_BINS - 1;
+            m->hist[b]    += 1;
+            m->histPow[b] += kMoment;
+        }
+        atomic_store_explicit(&m->outIntegrated, powToLufs(integratedPow(m)),
+                              memory_order_relaxed);
+    }
+    m->maxPeak = peak > m->maxPeak ? peak : m->maxPeak;
+    atomic_store_explicit(&m->outPeak, powToDb((double)peak * peak), memory_order_relaxed);
+    atomic_store_explicit(&m->outRms, powToDb(rawMoment), memory_order_relaxed);
+    atomic_store_explicit(&m->outMaxPeak, powToDb((double)m->maxPeak * m->maxPeak),
+                          memory_order_relaxed);
+    atomic_store_explicit(&m->outMomentary, powToLufs(kMoment), memory_order_relaxed);
+    atomic_store_explicit(&m->outShortTerm, powToLufs(kShort), memory_order_relaxed);
+}
+
+void ksy_meter_process_s16(KSYAudioMeter* meter, const int16_t* pcm, int nbFrame) {
+    if (meter == NULL || pcm == NULL || nbFrame <= 0) {
+        return;
+    }
+    KSYAudioMeter* m  = meter;
+    const int      ch = m->chCnt;
+    const double   sc = 1.0 / 32768.0;
+    while (nbFrame > 0) {
+        int n = m->subLen - m->subPos;
+        n = n < nbFrame ? n : nbFrame;
+        double raw  = 0;
+        float  peak = m->peakAcc;
+        for (int c = 0; c < ch; ++c) {
+            KSYBiquadState * s0 = &m->st[c][0];
+            KSYBiquadState * s1 = &m->st[c][1];
+            double k = 0;
+            for (int i = 0; i < n; ++i) {
+                double x = pcm[i*ch + c] * sc;
+                double y = biquadRun(&m->hpf, s1, biquadRun(&m->shelf, s0, x));
+                float  a = (float)fabs(x);
+                k    += y * y;
+                raw  += x * x;
+                peak  = a > peak ? a : peak;
+            }
+            m->kAcc[c] += k;
+        }
+        m->rawAcc  += raw;
+        m->peakAcc  = peak;
+        m->subPos  += n;
+        pcm        += n * ch;
+        nbFrame    -= n;
+        if (m->subPos == m->subLen) {
+            finishSub(m);
+        }
+    }
+}
+
+void ksy_meter_get(const KSYAudioMeter* meter, KSYAudioLevel* level) {
+    if (meter == NULL || level == NULL) {
+        return;
+    }
+    KSYAudioMeter* m = (KSYAudioMeter*)meter;
+    level->peak       = atomic_load_explicit(&m->outPeak, memory_order_relaxed);
+    level->rms        = atomic_load_explicit(&m->outRms, memory_order_relaxed);
+    level->maxPeak    = atomic_load_explicit(&m->outMaxPeak, memory_order_relaxed);
+    level->momentary  = atomic_load_explicit(&m->outMomentary, memory_order_relaxed);
+    level->shortTerm  = atomic_load_explicit(&m->outShortTerm, memory_order_relaxed);
+    level->integrated = atomic_load_explicit(&m->outIntegrated, memory_order_relaxed);
+}
@@ -0,0 +1,77 @@
+//
+//  KSYAudioMicMonitor.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "KSYAudioMonitor.h"
+#import "KSYAudioEffectChain.h"
+
+/** 低延迟耳返 (RemoteIO + KSYAudioMonitor)
+
+ 1. 接口与SDK的 KSYMicMonitor 兼容 (start/stop/setVolume:), 另外可以设置IO块长, 读取各部分的延迟
+ 2. 独立的 RemoteIO 单元: 采集回调中做效果处理后写入无锁缓冲, 播放回调读取,
+    两个回调都在系统的IO线程上, 不经过采集模块和混音器
+ 3. IO块长通过 AVAudioSession 的 preferredIOBufferDuration 申请, 实际值由系统决定
+    (会影响同一会话中的采集模块, 块长越小CPU唤醒越频繁)
+ 4. 音频会话须已经是 PlayAndRecord (采集模块启动后即是); 请只在插入耳机时启动, 外放会产生啸叫
+ */
+@interface KSYAudioMicMonitor : NSObject
+
+/**
+ @abstract  申请的IO块长 (毫秒), 默认为5, 在 start 之前设置
+ */
+@property (nonatomic, assign) float preferredIOBufferMs;
+
+/**
+ @abstract  实际的IO块长 (毫秒), start 之后有效
+ */
+@property (nonatomic, readonly) float ioBufferMs;
+
+/**
+ @abstract  采样率, start 时取音频会话当前的采样率
+ */
+@property (nonatomic, readonly) double sampleRate;
+
+/**
+ @abstract  返音的效果链, 在IO线程上处理, 与麦克风推流路径的效果相互独立
+ @discussion 效果器请在 start 之前加入; 参数和旁路开关可以在任意线程设置
+ */
+@property (nonatomic, readonly) KSYAudioEffectChain * effectChain;
+
+/**
+ @abstract  是否对返音做效果处理, 默认为YES (任意线程)
+ */
+@property (atomic, assign) BOOL bEffect;
+
+/**
+ @abstract  是否正在返音
+ */
+@property (nonatomic, readonly) BOOL isRunning;
+
+/**
+ @abstract  启动返音
+ @return    NO 表示音频单元创建或启动失败
+ */
+- (BOOL) start;
+
+/**
+ @abstract  关闭返音
+ */
+- (void) stop;
+
+/**
+ @abstract  设置返音音量 (0~2), 默认为1
+ */
+- (void) setVolume:(Float32)volume;
+
+/**
+ @abstract  延迟和缓冲的统计 (任意线程)
+ @discussion totalMs = 输入(硬件+IO块) + 处理 + 缓冲等待 + 输出(IO块+硬件)
+ */
+@property (nonatomic, readonly) KSYMonitorStat stat;
+
+@end
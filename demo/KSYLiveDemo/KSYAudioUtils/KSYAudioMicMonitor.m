@@ -0,0 +1,214 @@
+//
+//  KSYAudioMicMonitor.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioMicMonitor.h"
+#import <AVFoundation/AVFoundation.h>
+#import <AudioToolbox/AudioToolbox.h>
+#include <mach/mach_time.h>
+#include <stdatomic.h>
+
+#define MON_MAX_FRAMES  4096
+#define MON_BUFFER_MS   100
+
+@interface KSYAudioMicMonitor () {
+    AudioUnit           _unit;
+    KSYAudioMonitor *   _core;
+    float *             _inBuf;     // IO线程: 采集数据
+    double              _tickSec;   // mach_absolute_time 的单位 (秒)
+    float               _volume;
+    atomic_bool         _effect;
+}
+@end
+
+@implementation KSYAudioMicMonitor
+
+- (instancetype) init {
+    self = [super init];
+    if (self == nil) {
+        return nil;
+    }
+    _preferredIOBufferMs = 5;
+    _volume      = 1.0f;
+    _effectChain = [[KSYAudioEffectChain alloc] init];
+    _inBuf       = calloc(MON_MAX_FRAMES, sizeof(float));
+    if (_inBuf == NULL) {
+        return nil;
+    }
+    mach_timebase_info_data_t tb;
+    mach_timebase_info(&tb);
+    _tickSec = (double)tb.numer / tb.denom * 1e-9;
+    atomic_init(&_effect, YES);
+    return self;
+}
+
+- (void) dealloc {
+    [self stop];
+    ksy_monitor_destroy(_core);
+    free(_inBuf);
+}
+
+- (BOOL) bEffect {
+    return atomic_load(&_effect);
+}
+
+- (void) setBEffect:(BOOL)bEffect {
+    atomic_store(&_effect, bEffect);
+}
+
+#pragma mark - IO thread
+static void monitorFx(void* opaque, float* pcm, int nbFrame, int rate) {
+    KSYAudioMicMonitor * mon = (__bridge KSYAudioMicMonitor*)opaque;
+    if (atomic_load_explicit(&mon->_effect, memory_order_relaxed) &&
+        mon->_effectChain.count > 0) {
+        [mon->_effectChain processF32:pcm nbFrame:nbFrame rate:rate chCnt:1];
+    }
+}
+
+static OSStatus onInput(void* inRefCon,
+                        AudioUnitRenderActionFlags* ioActionFlags,
+                        const AudioTimeStamp* inTimeStamp,
+                        UInt32 inBusNumber,
+                        UInt32 inNumberFrames,
+                        AudioBufferList* ioData) {
+    KSYAudioMicMonitor * mon = (__bridge KSYAudioMicMonitor*)inRefCon;
+    double now = mach_absolute_time() * mon->_tickSec;
+    if (inNumberFrames > MON_MAX_FRAMES) {
+        return kAudioUnitErr_TooManyFramesToProcess;
+    }
+    AudioBufferList abl;
+    abl.mNumberBuffers              = 1;
+    abl.mBuffers[0].mNumberChannels = 1;
+    abl.mBuffers[0].mDataByteSize   = inNumberFrames * sizeof(float);
+    abl.mBuffers[0].mData           = mon->_inBuf;
+    OSStatus ret = AudioUnitRender(mon->_unit, ioActionFlags, inTimeStamp,
+                                   inBusNumber, inNumberFrames, &abl);
+    if (ret != noErr) {
+        return ret;
+    }
+    ksy_monitor_capture(mon->_core, mon->_inBuf, (int)inNumberFrames, now);
+    return noErr;
+}
+
+static OSStatus onRender(void* inRefCon,
+                         AudioUnitRenderActionFlags* ioActionFlags,
+                         const AudioTimeStamp* inTimeStamp,
+                         UInt32 inBusNumber,
+                         UInt32 inNumberFrames,
+                         AudioBufferList* ioData) {
+    KSYAudioMicMonitor * mon = (__bridge KSYAudioMicMonitor*)inRefCon;
+    double now = mach_absolute_time() * mon->_tickSec;
+    float * out = ioData->mBuffers[0].mData;
+    if (ksy_monitor_render(mon->_core, out, (int)inNumberFrames, now) == 0) {
+        *ioActionFlags |= kAudioUnitRenderAction_OutputIsSilence;
+    }
+    return noErr;
+}
+
+#pragma mark - control
+- (BOOL) setupUnit {
+    AudioComponentDescription desc = {0};
+    desc.componentType         = kAudioUnitType_Output;
+    desc.componentSubType      = kAudioUnitSubType_RemoteIO;
+    desc.componentManufacturer = kAudioUnitManufacturer_Apple;
+    AudioComponent comp = AudioComponentFindNext(NULL, &desc);
+    if (comp == NULL || AudioComponentInstanceNew(comp, &_unit) != noErr) {
+        _unit = NULL;
+        return NO;
+    }
+    UInt32 one = 1, maxFrames = MON_MAX_FRAMES;
+    AudioStreamBasicDescription fmt = {0};
+    fmt.mSampleRate       = _sampleRate;
+    fmt.mFormatID         = kAudioFormatLinearPCM;
+    fmt.mFormatFlags      = kAudioFormatFlagIsFloat | kAudioFormatFlagIsPacked;
+    fmt.mBytesPerPacket   = sizeof(float);
+    fmt.mFramesPerPacket  = 1;
+    fmt.mBytesPerFrame    = sizeof(float);
+    fmt.mChannelsPerFrame = 1;
+    fmt.mBitsPerChannel   = 32;
+    AURenderCallbackStruct inCb  = { onInput,  (__bridge void*)self };
+    AURenderCallbackStruct outCb = { onRender, (__bridge void*)self };
+    // bus 1 为麦克风, bus 0 为扬声器/耳机
+    OSStatus ret = noErr;
+    ret |= AudioUnitSetProperty(_unit, kAudioOutputUnitProperty_EnableIO,
+                                kAudioUnitScope_Input, 1, &one, sizeof(one));
+    ret |= AudioUnitSetProperty(_unit, kAudioOutputUnitProperty_EnableIO,
+                                kAudioUnitScope_Output, 0, &one, sizeof(one));
+    ret |= AudioUnitSetProperty(_unit, kAudioUnitProperty_StreamFormat,
+                                kAudioUnitScope_Output, 1, &fmt, sizeof(fmt));
+    ret |= AudioUnitSetProperty(_unit, kAudioUnitProperty_StreamFormat,
+                                kAudioUnitScope_Input, 0, &fmt, sizeof(fmt));
+    ret |= AudioUnitSetProperty(_unit, kAudioUnitProperty_MaximumFramesPerSlice,
+                                kAudioUnitScope_Global, 0, &maxFrames, sizeof(maxFrames));
+    ret |= AudioUnitSetProperty(_unit, kAudioOutputUnitProperty_SetInputCallback,
+                                kAudioUnitScope_Global, 1, &inCb, sizeof(inCb));
+    ret |= AudioUnitSetProperty(_unit, kAudioUnitProperty_SetRenderCallback,
+                                kAudioUnitScope_Input, 0, &outCb, sizeof(outCb));
+    if (ret != noErr || AudioUnitInitialize(_unit) != noErr) {
+        AudioComponentInstanceDispose(_unit);
+        _unit = NULL;
+        return NO;
+    }
+    return YES;
+}
+
+- (BOOL) start {
+    if (_unit) {
+        return YES;
+    }
+    AVAudioSession * session = [AVAudioSession sharedInstance];
+    [session setPreferredIOBufferDuration:_preferredIOBufferMs / 1000.0 error:nil];
+    double rate = session.sampleRate;
+    if (_core == NULL || rate != _sampleRate) {
+        ksy_monitor_destroy(_core);
+        _core = ksy_monitor_create((int)rate, MON_BUFFER_MS);
+        if (_core == NULL) {
+            return NO;
+        }
+        ksy_monitor_set_processor(_core, monitorFx, (__bridge void*)self);
+    }
+    _sampleRate = rate;
+    _ioBufferMs = session.IOBufferDuration * 1000;
+    ksy_monitor_reset(_core);
+    ksy_monitor_set_volume(_core, _volume);
+    ksy_monitor_set_device_latency(_core, session.inputLatency, session.outputLatency);
+    if (![self setupUnit]) {
+        return NO;
+    }
+    if (AudioOutputUnitStart(_unit) != noErr) {
+        [self stop];
+        return NO;
+    }
+    return YES;
+}
+
+- (void) stop {
+    if (_unit == NULL) {
+        return;
+    }
+    AudioOutputUnitStop(_unit);
+    AudioUnitUninitialize(_unit);
+    AudioComponentInstanceDispose(_unit);
+    _unit = NULL;
+}
+
+- (BOOL) isRunning {
+    return _unit != NULL;
+}
+
+- (void) setVolume:(Float32)volume {
+    _volume = volume;
+    ksy_monitor_set_volume(_core, volume);
+}
+
+- (KSYMonitorStat) stat {
+    KSYMonitorStat st = {0};
+    ksy_monitor_get_stat(_core, &st);
+    return st;
+}
+
+@end
@@ -0,0 +1,98 @@
+//
+//  KSYAudioMonitor.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** 耳返的核心: 采集回调 -> (效果) -> 无锁环形缓冲 -> 播放回调
+
+ 1. 与平台无关, 只依赖采集/播放两个回调; 两个回调可以在不同线程, 也可以是同一个IO线程
+ 2. 效果在采集回调中处理 (可选), 播放回调只做读取和音量渐变
+ 3. 缓冲的余量自适应: 启动时为0, 每次欠载增加半个播放块, 堆积超过余量时丢弃最旧的数据,
+    两端时钟不同源(如蓝牙/外接声卡)时延迟也不会持续增长
+ 4. 延迟 = 输入(硬件+采集块) + 处理 + 缓冲 + 输出(播放块+硬件), 硬件部分由调用者设置;
+    缓冲部分按两个回调的时间戳计算数据在缓冲中等待的时间, 两个回调的相位差也计算在内
+ 5. 单声道float数据, 采集和播放须为同一采样率
+ */
+typedef struct _KSYAudioMonitor KSYAudioMonitor;
+
+/**
+ @abstract  效果处理回调 (采集线程), 原地处理单声道float数据
+ */
+typedef void (*KSYMonitorProcessFn)(void* opaque, float* pcm, int nbFrame, int rate);
+
+/// 延迟和缓冲的统计 (任意线程读取)
+typedef struct {
+    /// 输入延迟: 硬件 + 采集块 (毫秒)
+    float   inputMs;
+    /// 处理耗时 (毫秒, 平滑)
+    float   processMs;
+    /// 数据在缓冲中的平均等待时间 (毫秒)
+    float   bufferMs;
+    /// 输出延迟: 播放块 + 硬件 (毫秒)
+    float   outputMs;
+    /// 总延迟 (毫秒)
+    float   totalMs;
+    /// 当前的缓冲余量 (帧)
+    int     cushion;
+    /// 欠载次数
+    int64_t underrunCnt;
+    /// 因堆积而丢弃的帧数
+    int64_t dropFrames;
+} KSYMonitorStat;
+
+/**
+ @abstract  创建
+ @param     rate     采样率
+ @param     maxMs    缓冲的容量 (毫秒), 也是余量的上限
+ @return    参数错误时返回NULL
+ */
+KSYAudioMonitor* ksy_monitor_create(int rate, int maxMs);
+
+/**
+ @abstract  销毁 (须保证两个回调都已停止)
+ */
+void ksy_monitor_destroy(KSYAudioMonitor* mon);
+
+/**
+ @abstract  设置效果处理回调 (启动前调用), fn 为NULL时不处理
+ */
+void ksy_monitor_set_processor(KSYAudioMonitor* mon, KSYMonitorProcessFn fn, void* opaque);
+
+/**
+ @abstract  设置音量 (0~2, 任意线程), 播放回调中逐块渐变
+ */
+void ksy_monitor_set_volume(KSYAudioMonitor* mon, float volume);
+
+/**
+ @abstract  设置硬件的输入/输出延迟 (秒, 不含IO块长), 用于计算总延迟
+ */
+void ksy_monitor_set_device_latency(KSYAudioMonitor* mon, double inSec, double outSec);
+
+/**
+ @abstract  采集回调中送入数据
+ @param     timeSec 回调的时间 (秒, 与 render 同一时钟), 小于0时按缓冲长度估计等待时间
+ @return    写入缓冲的帧数, 小于 nbFrame 表示缓冲已满
+ */
+int ksy_monitor_capture(KSYAudioMonitor* mon, float* pcm, int nbFrame, double timeSec);
+
+/**
+ @abstract  播放回调中取出数据, 不足的部分补零
+ @param     timeSec 回调的时间 (秒), 同 ksy_monitor_capture
+ @return    实际取到的帧数
+ */
+int ksy_monitor_render(KSYAudioMonitor* mon, float* out, int nbFrame, double timeSec);
+
+/**
+ @abstract  读取统计信息 (任意线程)
+ */
+void ksy_monitor_get_stat(const KSYAudioMonitor* mon, KSYMonitorStat* stat);
+
+/**
+ @abstract  清空缓冲和统计 (两个回调都停止时调用)
+ */
+void ksy_monitor_reset(KSYAudioMonitor* mon);
@@ -0,0 +1,223 @@
+//
+//  KSYAudioMonitor.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioMonitor.h"
+#import "KSYAudioRing.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MON_SMOOTH  0.05f
+
+struct _KSYAudioMonitor {
+    int                 rate;
+    int                 maxFrame;
+    KSYAudioRing *      ring;
+    KSYMonitorProcessFn fn;
+    void *              opaque;
+    _Atomic float       volume;
+    _Atomic float       inHwMs;
+    _Atomic float       outHwMs;
+    // 采集线程写入
+    _Atomic float       inputMs;
+    _Atomic float       processMs;
+    _Atomic double      wTime;      // 最近一次写入的时间
+    _Atomic int64_t     wFrames;    // 累计写入的帧数 (写入后更新)
+    atomic_int          wBlock;     // 最近一次写入的块长
+    // 播放线程写入
+    _Atomic float       bufferMs;
+    _Atomic float       outputMs;
+    atomic_int          cushion;
+    _Atomic int64_t     underrunCnt;
+    _Atomic int64_t     dropFrames;
+    // 播放线程使用
+    int64_t             rFrames;    // 累计读出的帧数 (含丢弃的)
+    float               curVolume;
+    BOOL                bPriming;
+};
+
+static double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+}
+
+KSYAudioMonitor* ksy_monitor_create(int rate, int maxMs) {
+    if (rate < 8000 || rate > 192000 || maxMs < 10 || maxMs > 1000) {
+        return NULL;
+    }
+    KSYAudioMonitor* mon = calloc(1, sizeof(KSYAudioMonitor));
+    if (mon == NULL) {
+        return NULL;
+    }
+    mon->rate     = rate;
+    mon->maxFrame = (int)((int64_t)rate * maxMs / 1000);
+    mon->ring     = ksy_ring_create(mon->maxFrame * 2, sizeof(float));
+    if (mon->ring == NULL) {
+        free(mon);
+        return NULL;
+    }
+    atomic_init(&mon->volume, 1.0f);
+    atomic_init(&mon->inHwMs, 0);
+    atomic_init(&mon->outHwMs, 0);
+    ksy_monitor_reset(mon);
+    return mon;
+}
+
+void ksy_monitor_destroy(KSYAudioMonitor* mon) {
+    if (mon) {
+        ksy_ring_destroy(mon->ring);
+        free(mon);
+    }
+}
+
+void ksy_monitor_set_processor(KSYAudioMonitor* mon, KSYMonitorProcessFn fn, void* opaque) {
+    if (mon) {
+        mon->fn     = fn;
+        mon->opaque = opaque;
+    }
+}
+
+void ksy_monitor_set_volume(KSYAudioMonitor* mon, float volume) {
+    if (mon) {
+        volume = volume < 0 ? 0 : (volume > 2 ? 2 : volume);
+        atomic_store(&mon->volume, volume);
+    }
+}
+
+void ksy_monitor_set_device_latency(KSYAudioMonitor* mon, double inSec, double outSec) {
+    if (mon) {
+        atomic_store(&mon->inHwMs,  (float)(inSec  * 1000));
+        atomic_store(&mon->outHwMs, (float)(outSec * 1000));
+    }
+}
+
+static void smooth(_Atomic float* v, float x) {
+    float old = atomic_load_explicit(v, memory_order_relaxed);
+    atomic_store_explicit(v, old + MON_SMOOTH * (x - old), memory_order_relaxed);
+}
+
+int ksy_monitor_capture(KSYAudioMonitor* mon, float* pcm, int nbFrame, double timeSec) {
+    if (mon == NULL || pcm == NULL || nbFrame <= 0) {
+        return 0;
+    }
+    float blockMs = nbFrame * 1000.0f / mon->rate;
+    atomic_store_explicit(&mon->inputMs,
+                          atomic_load_explicit(&mon->inHwMs, memory_order_relaxed) + blockMs,
+                          memory_order_relaxed);
+    if (mon->fn) {
+        double t0 = nowMs();
+        mon->fn(mon->opaque, pcm, nbFrame, mon->rate);
+        smooth(&mon->processMs, (float)(nowMs() - t0));
+    }
+    int n = ksy_ring_write(mon->ring, pcm, nbFrame);
+    atomic_store_explicit(&mon->wTime, timeSec, memory_order_relaxed);
+    atomic_store_explicit(&mon->wBlock, nbFrame, memory_order_relaxed);
+    atomic_fetch_add_explicit(&mon->wFrames, n, memory_order_release);
+    return n;
+}
+
+// 播放线程: 即将读出的第一帧在缓冲中已等待的时间 (毫秒);
+// 同一采集块的数据同时写入, 更早的块按块长和采样率向前推算
+static float waitMs(KSYAudioMonitor* mon, int fill, double timeSec) {
+    int64_t wFrames = atomic_load_explicit(&mon->wFrames, memory_order_acquire);
+    double  wTime   = atomic_load_explicit(&mon->wTime, memory_order_relaxed);
+    int     block   = atomic_load_explicit(&mon->wBlock, memory_order_relaxed);
+    if (timeSec < 0 || wTime < 0 || block <= 0 || wFrames <= mon->rFrames) {
+        return fill * 1000.0f / mon->rate;
+    }
+    int64_t older = (wFrames - 1 - mon->rFrames) / block * block;
+    double  ms    = (timeSec - wTime + (double)older / mon->rate) * 1000;
+    return ms > 0 ? (float)ms : 0;
+}
+
+int ksy_monitor_render(KSYAudioMonitor* mon, float* out, int nbFrame, double timeSec) {
+    if (mon == NULL || out == NULL || nbFrame <= 0) {
+        return 0;
+    }
+    atomic_store_explicit(&mon->outputMs,
+                          atomic_load_explicit(&mon->outHwMs, memory_order_relaxed) +
+                          nbFrame * 1000.0f / mon->rate,
+                          memory_order_relaxed);
+    int cushion = atomic_load_explicit(&mon->cushion, memory_order_relaxed);
+    int fill = ksy_ring_fill(mon->ring);
+    // 欠载后先攒够余量再输出, 避免每块都断续
+    if (mon->bPriming) {
+        if (fill < nbFrame + cushion) {
+            memset(out, 0, sizeof(float) * nbFrame);
+            return 0;
+        }
+        mon->bPriming = NO;
+    }
+    // 堆积超过余量一个块以上 (两端时钟不同源): 丢弃最旧的数据回到余量
+    int excess = fill - nbFrame - cushion;
+    if (excess > nbFrame) {
+        int n = ksy_ring_read(mon->ring, NULL, excess);
+        atomic_fetch_add_explicit(&mon->dropFrames, n, memory_order_relaxed);
+        mon->rFrames += n;
+        fill -= n;
+    }
+    if (fill > 0) {
+        smooth(&mon->bufferMs, waitMs(mon, fill, timeSec));
+    }
+    int got = ksy_ring_read(mon->ring, out, nbFrame);
+    mon->rFrames += got;
+    if (got < nbFrame) {
+        memset(out + got, 0, sizeof(float) * (nbFrame - got));
+        atomic_fetch_add_explicit(&mon->underrunCnt, 1, memory_order_relaxed);
+        cushion += nbFrame / 2;
+        cushion  = cushion > mon->maxFrame - nbFrame ? mon->maxFrame - nbFrame : cushion;
+        atomic_store_explicit(&mon->cushion, cushion > 0 ? cushion : 0, memory_order_relaxed);
+        mon->bPriming = YES;
+    }
+    // 音量在一块内线性渐变
+    float vol = atomic_load_explicit(&mon->volume, memory_order_relaxed);
+    float v = mon->curVolume, dv = (vol - v) / nbFrame;
+    for (int i = 0; i < got; ++i) {
+        v += dv;
+        out[i] *= v;
+    }
+    mon->curVolume = got == nbFrame ? vol : v;
+    return got;
+}
+
+void ksy_monitor_get_stat(const KSYAudioMonitor* mon, KSYMonitorStat* stat) {
+    if (mon == NULL || stat == NULL) {
+        return;
+    }
+    KSYAudioMonitor * m = (KSYAudioMonitor*)mon;
+    stat->inputMs     = atomic_load_explicit(&m->inputMs, memory_order_relaxed);
+    stat->processMs   = atomic_load_explicit(&m->processMs, memory_order_relaxed);
+    stat->bufferMs    = atomic_load_explicit(&m->bufferMs, memory_order_relaxed);
+    stat->outputMs    = atomic_load_explicit(&m->outputMs, memory_order_relaxed);
+    stat->totalMs     = stat->inputMs + stat->processMs + stat->bufferMs + stat->outputMs;
+    stat->cushion     = atomic_load_explicit(&m->cushion, memory_order_relaxed);
+    stat->underrunCnt = atomic_load_explicit(&m->underrunCnt, memory_order_relaxed);
+    stat->dropFrames  = atomic_load_explicit(&m->dropFrames, memory_order_relaxed);
+}
+
+void ksy_monitor_reset(KSYAudioMonitor* mon) {
+    if (mon == NULL) {
+        return;
+    }
+    ksy_ring_flush(mon->ring);
+    atomic_store(&mon->inputMs, 0);
+    atomic_store(&mon->processMs, 0);
+    atomic_store(&mon->bufferMs, 0);
+    atomic_store(&mon->outputMs, 0);
+    atomic_store(&mon->cushion, 0);
+    atomic_store(&mon->underrunCnt, 0);
+    atomic_store(&mon->dropFrames, 0);
+    atomic_store(&mon->wTime, -1.0);
+    atomic_store(&mon->wFrames, 0);
+    atomic_store(&mon->wBlock, 0);
+    mon->rFrames   = 0;
+    mon->curVolume = atomic_load(&mon->volume);
+    mon->bPriming  = YES;
+}
@@ -0,0 +1,91 @@
+//
+//  KSYAudioNoiseSuppressor.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <CoreMedia/CoreMedia.h>
+#import "KSYAudioDenoise.h"
+
+/** 麦克风降噪 (基于 KSYAudioDenoise)
+
+ 1. 在 audioProcessingCallback 中, 送入混音器和其他效果之前调用 processAudioSampleBuffer:
+ 2. 支持单声道/双声道, S16或float交织数据; 格式变化时自动重建, 其余时间不分配内存
+ 3. 等级和时间预算可以在任意线程修改, 下一段数据开始生效
+ 4. 处理耗时等统计信息可以在任意线程读取 (如界面的定时器)
+ */
+@interface KSYAudioNoiseSuppressor : NSObject
+
+/**
+ @abstract  降噪等级, 默认为 KSYDenoiseLevel_Medium
+ */
+@property (atomic, assign) KSYDenoiseLevel level;
+
+/**
+ @abstract  每10ms帧的时间预算 (微秒), 0 表示不限制, 默认为2000
+ @discussion 平均耗时超出预算时直通2秒后再重试, 避免拖慢采集线程
+ */
+@property (atomic, assign) float budgetUs;
+
+/**
+ @abstract  引入的延迟 (毫秒)
+ */
+@property (nonatomic, readonly) float latencyMs;
+
+/**
+ @abstract  平均每帧的处理耗时 (微秒, 任意线程)
+ */
+@property (nonatomic, readonly) float avgFrameUs;
+
+/**
+ @abstract  最大的每帧处理耗时 (微秒, 任意线程)
+ */
+@property (nonatomic, readonly) float maxFrameUs;
+
+/**
+ @abstract  当前是否因超出预算而直通 (任意线程)
+ */
+@property (nonatomic, readonly) BOOL bOverBudget;
+
+/**
+ @abstract  估计的噪声电平 (dBFS, 任意线程)
+ */
+@property (nonatomic, readonly) float noiseDb;
+
+/**
+ @abstract  最近一帧的衰减量 (dB, 任意线程)
+ */
+@property (nonatomic, readonly) float reductionDb;
+
+/**
+ @abstract  处理一段音频数据 (原地修改)
+ @param     sampleBuffer 音频数据
+ @return    NO 表示格式不支持 (平面格式, 多于2个声道, 或采样率不是100的整数倍), 数据未修改
+ */
+- (BOOL) processAudioSampleBuffer:(CMSampleBufferRef)sampleBuffer;
+
+/**
+ @abstract  处理一段 S16 交织数据 (原地修改)
+ */
+- (BOOL) processS16:(int16_t*)pcm
+            nbFrame:(int)nbFrame
+               rate:(int)rate
+              chCnt:(int)chCnt;
+
+/**
+ @abstract  处理一段 float 交织数据 (原地修改)
+ */
+- (BOOL) processF32:(float*)pcm
+            nbFrame:(int)nbFrame
+               rate:(int)rate
+              chCnt:(int)chCnt;
+
+/**
+ @abstract  清空噪声估计和统计信息 (与 process 在同一线程调用)
+ */
+- (void) reset;
+
+@end
@@ -0,0 +1,178 @@
+//
+//  KSYAudioNoiseSuppressor.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioNoiseSuppressor.h"
+#include <stdatomic.h>
+
+@interface KSYAudioNoiseSuppressor () {
+    // 处理线程使用
+    KSYAudioDenoise *   _dn;
+    int                 _rate;
+    int                 _chCnt;
+    KSYDenoiseLevel     _curLevel;
+    float               _curBudget;
+    // 处理线程写入, 任意线程读取
+    _Atomic float       _latencyMs;
+    _Atomic float       _avgUs;
+    _Atomic float       _maxUs;
+    _Atomic float       _noiseDb;
+    _Atomic float       _reductionDb;
+    atomic_bool         _overBudget;
+}
+@end
+
+@implementation KSYAudioNoiseSuppressor
+
+- (instancetype) init {
+    self = [super init];
+    if (self == nil) {
+        return nil;
+    }
+    _level    = KSYDenoiseLevel_Medium;
+    _budgetUs = 2000;
+    atomic_init(&_latencyMs, 0);
+    atomic_init(&_avgUs, 0);
+    atomic_init(&_maxUs, 0);
+    atomic_init(&_noiseDb, -120);
+    atomic_init(&_reductionDb, 0);
+    atomic_init(&_overBudget, NO);
+    return self;
+}
+
+- (void) dealloc {
+    ksy_denoise_destroy(_dn);
+}
+
+// 处理线程: 格式变化时重建, 参数变化时更新
+- (BOOL) prepare:(int)rate chCnt:(int)chCnt {
+    BOOL bNew = NO;
+    if (_dn == NULL || rate != _rate || chCnt != _chCnt) {
+        ksy_denoise_destroy(_dn);
+        _dn    = ksy_denoise_create(rate, chCnt);
+        _rate  = rate;
+        _chCnt = chCnt;
+        if (_dn == NULL) {
+            return NO;
+        }
+        atomic_store(&_latencyMs, ksy_denoise_latency(_dn) * 1000.0f / rate);
+        bNew = YES;
+    }
+    KSYDenoiseLevel level = self.level;
+    float budget = self.budgetUs;
+    if (bNew || level != _curLevel) {
+        ksy_denoise_set_level(_dn, level);
+        _curLevel = level;
+    }
+    if (bNew || budget != _curBudget) {
+        ksy_denoise_set_budget(_dn, budget);
+        _curBudget = budget;
+    }
+    return YES;
+}
+
+// 处理线程: 发布统计信息
+- (void) publishStat {
+    KSYDenoiseStat st;
+    ksy_denoise_get_stat(_dn, &st);
+    atomic_store_explicit(&_avgUs, st.avgUs, memory_order_relaxed);
+    atomic_store_explicit(&_maxUs, st.maxUs, memory_order_relaxed);
+    atomic_store_explicit(&_noiseDb, st.noiseDb, memory_order_relaxed);
+    atomic_store_explicit(&_reductionDb, st.reductionDb, memory_order_relaxed);
+    atomic_store_explicit(&_overBudget, st.bOverBudget, memory_order_relaxed);
+}
+
+- (BOOL) processS16:(int16_t*)pcm
+            nbFrame:(int)nbFrame
+               rate:(int)rate
+              chCnt:(int)chCnt {
+    if (pcm == NULL || nbFrame <= 0 || ![self prepare:rate chCnt:chCnt]) {
+        return NO;
+    }
+    ksy_denoise_process_s16(_dn, pcm, nbFrame);
+    [self publishStat];
+    return YES;
+}
+
+- (BOOL) processF32:(float*)pcm
+            nbFrame:(int)nbFrame
+               rate:(int)rate
+              chCnt:(int)chCnt {
+    if (pcm == NULL || nbFrame <= 0 || ![self prepare:rate chCnt:chCnt]) {
+        return NO;
+    }
+    ksy_denoise_process_f32(_dn, pcm, nbFrame);
+    [self publishStat];
+    return YES;
+}
+
+- (BOOL) processAudioSampleBuffer:(CMSampleBufferRef)sampleBuffer {
+    if (sampleBuffer == NULL) {
+        return NO;
+    }
+    CMFormatDescriptionRef desc = CMSampleBufferGetFormatDescription(sampleBuffer);
+    const AudioStreamBasicDescription * asbd = desc ?
+        CMAudioFormatDescriptionGetStreamBasicDescription(desc) : NULL;
+    if (asbd == NULL || asbd->mFormatID != kAudioFormatLinearPCM ||
+        (asbd->mFormatFlags & kAudioFormatFlagIsNonInterleaved)) {
+        return NO;
+    }
+    BOOL bFloat = (asbd->mFormatFlags & kAudioFormatFlagIsFloat) != 0;
+    if ((bFloat && asbd->mBitsPerChannel != 32) ||
+        (!bFloat && asbd->mBitsPerChannel != 16)) {
+        return NO;
+    }
+    CMBlockBufferRef block = CMSampleBufferGetDataBuffer(sampleBuffer);
+    size_t len = 0;
+    char * data = NULL;
+    int nbFrame = (int)CMSampleBufferGetNumSamples(sampleBuffer);
+    if (block == NULL ||
+        CMBlockBufferGetDataPointer(block, 0, NULL, &len, &data) != kCMBlockBufferNoErr ||
+        len < (size_t)nbFrame * asbd->mBytesPerFrame) {
+        return NO;
+    }
+    int rate  = (int)asbd->mSampleRate;
+    int chCnt = (int)asbd->mChannelsPerFrame;
+    if (bFloat) {
+        return [self processF32:(float*)data nbFrame:nbFrame rate:rate chCnt:chCnt];
+    }
+    return [self processS16:(int16_t*)data nbFrame:nbFrame rate:rate chCnt:chCnt];
+}
+
+- (void) reset {
+    ksy_denoise_reset(_dn);
+    if (_dn) {
+        [self publishStat];
+    }
+}
+
+#pragma mark - stat
+- (float) latencyMs {
+    return atomic_load(&_latencyMs);
+}
+
+- (float) avgFrameUs {
+    return atomic_load_explicit(&_avgUs, memory_order_relaxed);
+}
+
+- (float) maxFrameUs {
+    return atomic_load_explicit(&_maxUs, memory_order_relaxed);
+}
+
+- (BOOL) bOverBudget {
+    return atomic_load_explicit(&_overBudget, memory_order_relaxed);
+}
+
+- (float) noiseDb {
+    return atomic_load_explicit(&_noiseDb, memory_order_relaxed);
+}
+
+- (float) reductionDb {
+    return atomic_load_explicit(&_reductionDb, memory_order_relaxed);
+}
+
+@end
@@ -0,0 +1,113 @@
+//
+//  KSYAudioOutputStage.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <CoreMedia/CoreMedia.h>
+#import "KSYAudioMeter.h"
+#import "KSYAudioLimiter.h"
+#if USING_DYNAMIC_FRAMEWORK
+#import <libksygpulivedylib/KSYAudioMixer.h>
+#else
+#import <libksygpulive/KSYAudioMixer.h>
+#endif
+
+/// 可以单独统计电平的track数
+#define KSY_METER_MAX_TRACK  8
+
+/** 混音输出的后处理: 限幅 + 响度表
+
+ 1. 在混音器的 audioProcessingCallback 中原地处理混音结果, 再送入推流模块
+ 2. 预读限幅器避免背景音乐和人声同时很大时的削波, 固定增加 lookaheadMs 的延迟
+ 3. 响度表按 EBU R128 统计混音结果, 另外可以统计各个track送入混音器的数据
+ 4. 读数和设置都是无锁的, 可以在任意线程调用
+ */
+@interface KSYAudioOutputStage : NSObject
+
+/**
+ @abstract  初始化
+ @param     fmt         混音结果的格式 (即混音器的 outFmt, 需为S16交织)
+ @param     lookaheadMs 限幅器的预读时长 (1~20ms), 即增加的延迟
+ */
+- (instancetype) initWithFormat:(KSYAudioFormat)fmt
+                    lookaheadMs:(float)lookaheadMs;
+
+/**
+ @abstract  混音结果的格式
+ */
+@property (nonatomic, readonly) KSYAudioFormat fmt;
+
+/**
+ @abstract  是否开启限幅, 默认为YES (任意线程)
+ @discussion 关闭后仍然经过延迟线, 保持输出延迟不变
+ */
+@property (atomic, assign) BOOL limiterEnable;
+
+/**
+ @abstract  限幅的门限 (dBFS), 默认为 -1.0 (任意线程)
+ */
+@property (atomic, assign) float threshold;
+
+/**
+ @abstract  限幅器增加的延迟 (毫秒)
+ */
+@property (nonatomic, readonly) float latencyMs;
+
+/**
+ @abstract  处理混音结果 (混音器的输出线程)
+ @param     sampleBuffer 混音器输出的数据, 原地修改
+ @return    NO 表示数据格式与 fmt 不符, 未做处理
+ */
+- (BOOL) processAudioSampleBuffer:(CMSampleBufferRef)sampleBuffer;
+
+/**
+ @abstract  处理混音结果 (混音器的输出线程)
+ @param     pcm     S16 交织数据, 原地修改
+ @param     nbFrame 帧数
+ @discussion 可用于离线处理PCM文件
+ */
+- (void) processAudioData:(int16_t*)pcm
+                  nbFrame:(int)nbFrame;
+
+/**
+ @abstract  混音结果的电平和响度 (任意线程)
+ */
+@property (nonatomic, readonly) KSYAudioLevel level;
+
+/**
+ @abstract  最近一次处理时限幅器的最大增益衰减 (dB, 任意线程)
+ */
+@property (nonatomic, readonly) float gainReduction;
+
+/**
+ @abstract  统计某个track送入混音器的数据 (该track的数据线程)
+ @param     trackId      track编号 (0 ~ KSY_METER_MAX_TRACK-1)
+ @param     sampleBuffer 音频数据 (S16交织)
+ @discussion 每个track第一次送入数据时按其格式创建电平表, 之后格式不同的数据被忽略
+ */
+- (void) meterTrack:(int)trackId
+       sampleBuffer:(CMSampleBufferRef)sampleBuffer;
+
+/**
+ @abstract  统计某个track送入混音器的数据 (该track的数据线程)
+ @param     trackId track编号 (0 ~ KSY_METER_MAX_TRACK-1)
+ @param     pcm     S16 交织数据
+ @param     nbFrame 帧数
+ @param     fmt     数据的格式
+ */
+- (void) meterTrack:(int)trackId
+               data:(const int16_t*)pcm
+            nbFrame:(int)nbFrame
+             format:(const KSYAudioFormat*)fmt;
+
+/**
+ @abstract  某个track的电平 (任意线程)
+ @discussion 该track没有数据时各项均为 KSY_METER_FLOOR
+ */
+- (KSYAudioLevel) levelOfTrack:(int)trackId;
+
+@end
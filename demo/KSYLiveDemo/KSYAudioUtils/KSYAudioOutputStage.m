@@ -0,0 +1,169 @@
+//
+//  KSYAudioOutputStage.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioOutputStage.h"
+#import "KSYAudioConvert.h"
+#include <stdatomic.h>
+
+// 释放时间: 足够长以免低频上出现增益调制
+#define STAGE_RELEASE_MS  150.0f
+
+// 取出 S16 交织的数据, 不连续或格式不符时返回NO
+static BOOL getS16(CMSampleBufferRef buf, int16_t** pcm, int* nbFrame,
+                   int* rate, int* chCnt) {
+    CMFormatDescriptionRef desc = CMSampleBufferGetFormatDescription(buf);
+    const AudioStreamBasicDescription * asbd = desc ?
+        CMAudioFormatDescriptionGetStreamBasicDescription(desc) : NULL;
+    if (asbd == NULL || asbd->mFormatID != kAudioFormatLinearPCM ||
+        asbd->mBitsPerChannel != 16 ||
+        !(asbd->mFormatFlags & kAudioFormatFlagIsSignedInteger) ||
+        (asbd->mFormatFlags & kAudioFormatFlagIsNonInterleaved)) {
+        return NO;
+    }
+    CMBlockBufferRef block = CMSampleBufferGetDataBuffer(buf);
+    size_t len = 0;
+    char * data = NULL;
+    if (block == NULL ||
+        CMBlockBufferGetDataPointer(block, 0, NULL, &len, &data) != kCMBlockBufferNoErr) {
+        return NO;
+    }
+    int n = (int)CMSampleBufferGetNumSamples(buf);
+    if (len < (size_t)n * asbd->mBytesPerFrame) { // 数据不连续
+        return NO;
+    }
+    *pcm     = (int16_t*)data;
+    *nbFrame = n;
+    *rate    = (int)asbd->mSampleRate;
+    *chCnt   = (int)asbd->mChannelsPerFrame;
+    return YES;
+}
+
+@interface KSYAudioOutputStage () {
+    KSYAudioLimiter *          _limiter;
+    KSYAudioMeter *            _meter;
+    float                      _curThresh; // 输出线程: 限幅器当前使用的门限
+    _Atomic(KSYAudioMeter *)   _trackMeters[KSY_METER_MAX_TRACK];
+}
+@end
+
+@implementation KSYAudioOutputStage
+
+- (instancetype) initWithFormat:(KSYAudioFormat)fmt
+                    lookaheadMs:(float)lookaheadMs {
+    self = [super init];
+    if (self == nil || fmt.sampleFmt != KSYSampleFmt_S16) {
+        return nil;
+    }
+    _fmt     = fmt;
+    _limiter = ksy_limiter_create(fmt.sampleRate, fmt.chCnt, lookaheadMs, STAGE_RELEASE_MS);
+    _meter   = ksy_meter_create(fmt.sampleRate, fmt.chCnt);
+    if (_limiter == NULL || _meter == NULL) {
+        return nil;
+    }
+    for (int i = 0; i < KSY_METER_MAX_TRACK; ++i) {
+        atomic_init(&_trackMeters[i], NULL);
+    }
+    _limiterEnable = YES;
+    _threshold     = -1.0f;
+    _curThresh     = -1.0f;
+    _latencyMs     = ksy_limiter_latency(_limiter) * 1000.0f / fmt.sampleRate;
+    return self;
+}
+
+- (void) dealloc {
+    ksy_limiter_destroy(_limiter);
+    ksy_meter_destroy(_meter);
+    for (int i = 0; i < KSY_METER_MAX_TRACK; ++i) {
+        ksy_meter_destroy(atomic_load(&_trackMeters[i]));
+    }
+}
+
+#pragma mark - mix bus
+- (void) processAudioData:(int16_t*)pcm
+                  nbFrame:(int)nbFrame {
+    // 关闭限幅时门限为0dBFS, S16数据不会超过, 限幅器即为纯延迟
+    float thresh = self.limiterEnable ? self.threshold : 0.0f;
+    if (thresh != _curThresh) {
+        ksy_limiter_set_threshold(_limiter, thresh);
+        _curThresh = thresh;
+    }
+    ksy_limiter_process_s16(_limiter, pcm, nbFrame);
+    ksy_meter_process_s16(_meter, pcm, nbFrame);
+}
+
+- (BOOL) processAudioSampleBuffer:(CMSampleBufferRef)sampleBuffer {
+    int16_t * pcm = NULL;
+    int nbFrame = 0, rate = 0, chCnt = 0;
+    if (sampleBuffer == NULL ||
+        !getS16(sampleBuffer, &pcm, &nbFrame, &rate, &chCnt) ||
+        rate != _fmt.sampleRate || chCnt != _fmt.chCnt) {
+        return NO;
+    }
+    [self processAudioData:pcm nbFrame:nbFrame];
+    return YES;
+}
+
+- (KSYAudioLevel) level {
+    KSYAudioLevel lv;
+    ksy_meter_get(_meter, &lv);
+    return lv;
+}
+
+- (float) gainReduction {
+    return ksy_limiter_reduction(_limiter);
+}
+
+#pragma mark - tracks
+- (void) meterTrack:(int)trackId
+               data:(const int16_t*)pcm
+            nbFrame:(int)nbFrame
+             format:(const KSYAudioFormat*)fmt {
+    if (trackId < 0 || trackId >= KSY_METER_MAX_TRACK || pcm == NULL ||
+        fmt == NULL || fmt->sampleFmt != KSYSampleFmt_S16) {
+        return;
+    }
+    KSYAudioMeter * m = atomic_load_explicit(&_trackMeters[trackId], memory_order_acquire);
+    if (m == NULL) {
+        m = ksy_meter_create(fmt->sampleRate, fmt->chCnt);
+        KSYAudioMeter * expect = NULL;
+        if (m == NULL ||
+            !atomic_compare_exchange_strong_explicit(&_trackMeters[trackId], &expect, m,
+                                                     memory_order_acq_rel,
+                                                     memory_order_acquire)) {
+            ksy_meter_destroy(m);
+            return;
+        }
+    }
+    if (ksy_meter_rate(m) != fmt->sampleRate || ksy_meter_channels(m) != fmt->chCnt) {
+        return;
+    }
+    ksy_meter_process_s16(m, pcm, nbFrame);
+}
+
+- (void) meterTrack:(int)trackId
+       sampleBuffer:(CMSampleBufferRef)sampleBuffer {
+    int16_t * pcm = NULL;
+    int nbFrame = 0, rate = 0, chCnt = 0;
+    if (sampleBuffer == NULL ||
+        !getS16(sampleBuffer, &pcm, &nbFrame, &rate, &chCnt)) {
+        return;
+    }
+    KSYAudioFormat fmt = { KSYSampleFmt_S16, 2, chCnt, 0, rate };
+    [self meterTrack:trackId data:pcm nbFrame:nbFrame format:&fmt];
+}
+
+- (KSYAudioLevel) levelOfTrack:(int)trackId {
+    KSYAudioLevel lv = { KSY_METER_FLOOR, KSY_METER_FLOOR, KSY_METER_FLOOR,
+                         KSY_METER_FLOOR, KSY_METER_FLOOR, KSY_METER_FLOOR };
+    if (trackId >= 0 && trackId < KSY_METER_MAX_TRACK) {
+        ksy_meter_get(atomic_load_explicit(&_trackMeters[trackId], memory_order_acquire), &lv);
+    }
+    return lv;
+}
+
+@end
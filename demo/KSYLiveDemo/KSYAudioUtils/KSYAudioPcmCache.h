@@ -0,0 +1,122 @@
+//
+//  KSYAudioPcmCache.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** 解码后PCM的磁盘缓存
+
+ 1. 以源文件内容的哈希为key, 文件改名/移动后仍能命中, 内容改变后不会误用旧数据
+ 2. 缓存文件为固定格式 (创建时指定采样率和声道数, S16交织), 读取时内存映射, 不需要解码和拷贝
+ 3. 总大小超过预算时按最近使用时间(LRU)删除, 命中时更新使用时间
+ 4. 写入先写临时文件, 完成后改名, 读取方不会看到写了一半的数据
+ 5. 可以在任意线程调用; 已映射的数据在被删除后仍然有效, 直到释放映射
+ 6. 纯C实现, 解码由调用者完成 (如 ExtAudioFile), 可以在Linux上测试
+ */
+typedef struct _KSYPcmCache KSYPcmCache;
+
+/// 缓存数据的内存映射
+typedef struct {
+    /// PCM数据 (S16交织, 只读)
+    const int16_t * pcm;
+    /// 帧数
+    int64_t         nbFrame;
+    int             rate;
+    int             chCnt;
+    /// 以下内部使用
+    void *          base;
+    size_t          mapLen;
+} KSYPcmMap;
+
+/// 写入缓存的句柄
+typedef struct _KSYPcmWriter KSYPcmWriter;
+
+/// 统计信息
+typedef struct {
+    /// 缓存的文件个数和总字节数 (最近一次整理时)
+    int     nbEntry;
+    int64_t bytes;
+    /// 大小预算 (字节)
+    int64_t budget;
+    int64_t hitCnt;
+    int64_t missCnt;
+    /// 因超出预算删除的个数
+    int64_t evictCnt;
+} KSYPcmCacheStat;
+
+/**
+ @abstract  创建, 目录不存在时创建目录, 并删除上次残留的临时文件
+ @param     dir    缓存目录
+ @param     rate   缓存数据的采样率
+ @param     chCnt  缓存数据的声道数
+ @param     budget 缓存总大小的上限 (字节)
+ @return    目录无法创建或参数错误时返回NULL
+ */
+KSYPcmCache* ksy_pcm_cache_create(const char* dir, int rate, int chCnt, int64_t budget);
+
+void ksy_pcm_cache_destroy(KSYPcmCache* cache);
+
+/**
+ @abstract  修改大小预算, 超出时立即删除最久未使用的缓存
+ */
+void ksy_pcm_cache_set_budget(KSYPcmCache* cache, int64_t budget);
+
+/**
+ @abstract  计算源文件的key (内容哈希)
+ @discussion 路径/大小/修改时间不变时使用上次的结果, 不重新读取文件
+ @return    文件无法读取时返回NO
+ */
+BOOL ksy_pcm_cache_key(KSYPcmCache* cache, const char* srcPath, uint64_t* key);
+
+/**
+ @abstract  查找源文件的缓存, 找到时映射到内存, 并更新使用时间
+ @return    没有缓存或缓存已损坏时返回NULL (损坏的缓存会被删除)
+ */
+KSYPcmMap* ksy_pcm_cache_open(KSYPcmCache* cache, const char* srcPath);
+
+/**
+ @abstract  预先读入映射的前 nbFrame 帧, 避免在实时线程中缺页 (<=0 时为全部)
+ */
+void ksy_pcm_map_prefault(const KSYPcmMap* map, int64_t nbFrame);
+
+/**
+ @abstract  释放映射 (NULL时无操作)
+ */
+void ksy_pcm_map_release(KSYPcmMap* map);
+
+/**
+ @abstract  开始写入源文件的缓存
+ @return    源文件无法读取时返回NULL
+ */
+KSYPcmWriter* ksy_pcm_cache_begin(KSYPcmCache* cache, const char* srcPath);
+
+/**
+ @abstract  写入解码后的数据 (S16交织, 创建缓存时的格式)
+ @return    写入失败时返回NO, 之后只能 abort
+ */
+BOOL ksy_pcm_writer_write(KSYPcmWriter* w, const int16_t* pcm, int nbFrame);
+
+/**
+ @abstract  完成写入, 加入缓存并按预算整理, 释放句柄
+ @return    NO 表示写入失败, 没有数据, 或单个文件就超出了预算
+ */
+BOOL ksy_pcm_writer_commit(KSYPcmWriter* w);
+
+/**
+ @abstract  放弃写入, 删除临时文件, 释放句柄
+ */
+void ksy_pcm_writer_abort(KSYPcmWriter* w);
+
+/**
+ @abstract  删除所有缓存
+ */
+void ksy_pcm_cache_clear(KSYPcmCache* cache);
+
+/**
+ @abstract  读取统计信息
+ */
+void ksy_pcm_cache_get_stat(KSYPcmCache* cache, KSYPcmCacheStat* stat);
@@ -0,0 +1,510 @@
+//
+//  KSYAudioPcmCache.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioPcmCache.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define PCM_MAGIC       "KPCM"
+#define PCM_VERSION     1
+#define PCM_HDR_SIZE    32
+#define PCM_KEY_MEMO    64      // 记住的源文件key个数
+#define PCM_HASH_CHUNK  65536
+#define PCM_PAGE        4096
+
+#ifdef __APPLE__
+#define ST_MTIME_NS(st) ((int64_t)(st).st_mtimespec.tv_sec * 1000000000 + (st).st_mtimespec.tv_nsec)
+#else
+#define ST_MTIME_NS(st) ((int64_t)(st).st_mtim.tv_sec * 1000000000 + (st).st_mtim.tv_nsec)
+#endif
+
+// 缓存文件头, 之后为 S16 交织数据
+typedef struct {
+    char        magic[4];
+    uint32_t    version;
+    uint32_t    rate;
+    uint32_t    chCnt;
+    int64_t     nbFrame;
+    uint64_t    key;
+} PcmHeader;
+
+// 源文件 -> key, 文件不变时不重新计算哈希
+typedef struct {
+    char *      path;
+    int64_t     size;
+    int64_t     mtime;
+    uint64_t    key;
+    uint64_t    useSeq;
+} KeyMemo;
+
+struct _KSYPcmCache {
+    char *          dir;
+    int             rate;
+    int             chCnt;
+    pthread_mutex_t lock;
+    // lock 保护
+    int64_t         budget;
+    KeyMemo         memo[PCM_KEY_MEMO];
+    uint64_t        useSeq;
+    KSYPcmCacheStat stat;
+};
+
+struct _KSYPcmWriter {
+    KSYPcmCache *   cache;
+    uint64_t        key;
+    char            tmp[PATH_MAX];
+    FILE *          fp;
+    int64_t         nbFrame;
+    BOOL            bErr;
+};
+
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// 按8字节处理的内容哈希, 比逐字节的FNV快, 几MB的压缩文件只需几毫秒
+static BOOL hashFile(const char* path, int64_t* size, uint64_t* key) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NO;
+    }
+    uint64_t * buf = malloc(PCM_HASH_CHUNK);
+    uint64_t   h   = 0x9e3779b97f4a7c15ULL;
+    int64_t    len = 0;
+    ssize_t    n   = 0;
+    while (buf && (n = read(fd, buf, PCM_HASH_CHUNK)) > 0) {
+        size_t nbWord = (size_t)n / 8;
+        size_t rem    = (size_t)n % 8;
+        if (rem) { // 只有文件末尾会不满8字节
+            memset((uint8_t*)buf + n, 0, 8 - rem);
+            nbWord += 1;
+        }
+        for (size_t i = 0; i < nbWord; ++i) {
+            h = (h ^ mix64(buf[i])) * 0x9e3779b97f4a7c15ULL;
+            h = (h << 29) | (h >> 35);
+        }
+        len += n;
+    }
+    close(fd);
+    free(buf);
+    if (buf == NULL || n < 0) {
+        return NO;
+    }
+    *size = len;
+    *key  = mix64(h ^ (uint64_t)len);
+    return YES;
+}
+
+static void entryPath(const KSYPcmCache* cache, uint64_t key, char* path) {
+    snprintf(path, PATH_MAX, "%s/%016llx-%d-%d.pcm", cache->dir,
+             (unsigned long long)key, cache->rate, cache->chCnt);
+}
+
+static BOOL isEntry(const char* name) {
+    size_t len = strlen(name);
+    return len > 4 && strcmp(name + len - 4, ".pcm") == 0;
+}
+
+static BOOL makeDirs(const char* dir) {
+    char path[PATH_MAX];
+    if (snprintf(path, sizeof(path), "%s", dir) >= (int)sizeof(path)) {
+        return NO;
+    }
+    for (char* p = path + 1; *p; ++p) {
+        if (*p == '/') {
+            *p = 0;
+            if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+                return NO;
+            }
+            *p = '/';
+        }
+    }
+    return mkdir(path, 0755) == 0 || errno == EEXIST;
+}
+
+#pragma mark - LRU
+typedef struct {
+    char        name[NAME_MAX + 1];
+    int64_t     size;
+    int64_t     mtime;
+} PcmEntry;
+
+static int cmpEntry(const void* a, const void* b) {
+    const PcmEntry* x = a;
+    const PcmEntry* y = b;
+    return x->mtime < y->mtime ? -1 : (x->mtime > y->mtime ? 1 : 0);
+}
+
+// 统计目录中的缓存, 超出预算时从最久未使用的开始删除 (持有lock)
+static void trimLocked(KSYPcmCache* cache, int64_t budget) {
+    DIR * d = opendir(cache->dir);
+    if (d == NULL) {
+        return;
+    }
+    PcmEntry * list = NULL;
+    int cnt = 0, cap = 0;
+    int64_t total = 0;
+    struct dirent * de;
+    char path[PATH_MAX];
+    while ((de = readdir(d)) != NULL) {
+        struct stat st;
+        snprintf(path, sizeof(path), "%s/%s", cache->dir, de->d_name);
+        if (!isEntry(de->d_name) || stat(path, &st) != 0) {
+            continue;
+        }
+        if (cnt == cap) {
+            int newCap = cap ? cap*2 : 32;
+            PcmEntry * p = realloc(list, sizeof(PcmEntry) * newCap);
+            if (p == NULL) {
+                break;
+            }
+            list = p;
+            cap  = newCap;
+        }
+        snprintf(list[cnt].name, sizeof(list[cnt].name), "%s", de->d_name);
+        list[cnt].size  = st.st_size;
+        list[cnt].mtime = ST_MTIME_NS(st);
+        total += st.st_size;
+        cnt   += 1;
+    }
+    closedir(d);
+    if (total > budget && cnt > 0) {
+        qsort(list, cnt, sizeof(PcmEntry), cmpEntry);
+    }
+    int nbLeft = cnt;
+    for (int i = 0; i < cnt && total > budget; ++i) {
+        snprintf(path, sizeof(path), "%s/%s", cache->dir, list[i].name);
+        if (unlink(path) == 0) {
+            total  -= list[i].size;
+            nbLeft -= 1;
+            cache->stat.evictCnt += 1;
+        }
+    }
+    free(list);
+    cache->stat.nbEntry = nbLeft;
+    cache->stat.bytes   = total;
+}
+
+#pragma mark - cache
+KSYPcmCache* ksy_pcm_cache_create(const char* dir, int rate, int chCnt, int64_t budget) {
+    if (dir == NULL || rate <= 0 || chCnt <= 0 || budget < 0 || !makeDirs(dir)) {
+        return NULL;
+    }
+    KSYPcmCache * cache = calloc(1, sizeof(KSYPcmCache));
+    if (cache == NULL) {
+        return NULL;
+    }
+    cache->dir = strdup(dir);
+    if (cache->dir == NULL) {
+        free(cache);
+        return NULL;
+    }
+    cache->rate   = rate;
+    cache->chCnt  = chCnt;
+    cache->budget = budget;
+    cache->stat.budget = budget;
+    pthread_mutex_init(&cache->lock, NULL);
+    // 上次异常退出时残留的临时文件
+    DIR * d = opendir(dir);
+    struct dirent * de;
+    char path[PATH_MAX];
+    while (d && (de = readdir(d)) != NULL) {
+        if (strncmp(de->d_name, ".tmp", 4) == 0) {
+            snprintf(path, sizeof(path), "%s/%s", dir, de->d_name);
+            unlink(path);
+        }
+    }
+    if (d) {
+        closedir(d);
+    }
+    pthread_mutex_lock(&cache->lock);
+    trimLocked(cache, budget);
+    pthread_mutex_unlock(&cache->lock);
+    return cache;
+}
+
+void ksy_pcm_cache_destroy(KSYPcmCache* cache) {
+    if (cache == NULL) {
+        return;
+    }
+    for (int i = 0; i < PCM_KEY_MEMO; ++i) {
+        free(cache->memo[i].path);
+    }
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->dir);
+    free(cache);
+}
+
+void ksy_pcm_cache_set_budget(KSYPcmCache* cache, int64_t budget) {
+    if (cache == NULL || budget < 0) {
+        return;
+    }
+    pthread_mutex_lock(&cache->lock);
+    cache->budget      = budget;
+    cache->stat.budget = budget;
+    trimLocked(cache, budget);
+    pthread_mutex_unlock(&cache->lock);
+}
+
+BOOL ksy_pcm_cache_key(KSYPcmCache* cache, const char* srcPath, uint64_t* key) {
+    struct stat st;
+    if (cache == NULL || srcPath == NULL || key == NULL || stat(srcPath, &st) != 0) {
+        return NO;
+    }
+    int64_t mtime = ST_MTIME_NS(st);
+    pthread_mutex_lock(&cache->lock);
+    for (int i = 0; i < PCM_KEY_MEMO; ++i) {
+        KeyMemo * m = &cache->memo[i];
+        if (m->path && m->size == st.st_size && m->mtime == mtime &&
+            strcmp(m->path, srcPath) == 0) {
+            m->useSeq = ++cache->useSeq;
+            *key = m->key;
+            pthread_mutex_unlock(&cache->lock);
+            return YES;
+        }
+    }
+    pthread_mutex_unlock(&cache->lock);
+    // 读文件时不持有锁
+    int64_t size = 0;
+    if (!hashFile(srcPath, &size, key)) {
+        return NO;
+    }
+    char * path = strdup(srcPath);
+    if (path == NULL) {
+        return YES;
+    }
+    pthread_mutex_lock(&cache->lock);
+    KeyMemo * slot = &cache->memo[0];
+    for (int i = 0; i < PCM_KEY_MEMO; ++i) {
+        KeyMemo * m = &cache->memo[i];
+        if (m->path && strcmp(m->path, srcPath) == 0) { // 同一路径的旧结果
+            slot = m;
+            break;
+        }
+        if (m->useSeq < slot->useSeq) {
+            slot = m;
+        }
+    }
+    free(slot->path);
+    slot->path   = path;
+    slot->size   = size;
+    slot->mtime  = mtime;
+    slot->key    = *key;
+    slot->useSeq = ++cache->useSeq;
+    pthread_mutex_unlock(&cache->lock);
+    return YES;
+}
+
+static void countLookup(KSYPcmCache* cache, BOOL bHit) {
+    pthread_mutex_lock(&cache->lock);
+    if (bHit) {
+        cache->stat.hitCnt += 1;
+    }
+    else {
+        cache->stat.missCnt += 1;
+    }
+    pthread_mutex_unlock(&cache->lock);
+}
+
+KSYPcmMap* ksy_pcm_cache_open(KSYPcmCache* cache, const char* srcPath) {
+    uint64_t key = 0;
+    if (!ksy_pcm_cache_key(cache, srcPath, &key)) {
+        return NULL;
+    }
+    char path[PATH_MAX];
+    entryPath(cache, key, path);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        countLookup(cache, NO);
+        return NULL;
+    }
+    struct stat st;
+    void * base = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > PCM_HDR_SIZE) {
+        base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    if (base == MAP_FAILED) {
+        close(fd);
+        countLookup(cache, NO);
+        return NULL;
+    }
+    PcmHeader hdr;
+    memcpy(&hdr, base, sizeof(hdr));
+    int64_t expect = PCM_HDR_SIZE + hdr.nbFrame * hdr.chCnt * (int64_t)sizeof(int16_t);
+    KSYPcmMap * map = NULL;
+    if (memcmp(hdr.magic, PCM_MAGIC, 4) == 0 && hdr.version == PCM_VERSION &&
+        hdr.rate == (uint32_t)cache->rate && hdr.chCnt == (uint32_t)cache->chCnt &&
+        hdr.key == key && hdr.nbFrame > 0 && expect == st.st_size) {
+        map = malloc(sizeof(KSYPcmMap));
+    }
+    if (map == NULL) { // 损坏的缓存 (如写入时空间不足)
+        munmap(base, (size_t)st.st_size);
+        close(fd);
+        unlink(path);
+        countLookup(cache, NO);
+        return NULL;
+    }
+    futimens(fd, NULL); // 更新使用时间, 用于LRU
+    close(fd);
+    madvise(base, (size_t)st.st_size, MADV_SEQUENTIAL);
+    map->pcm     = (const int16_t*)((const uint8_t*)base + PCM_HDR_SIZE);
+    map->nbFrame = hdr.nbFrame;
+    map->rate    = cache->rate;
+    map->chCnt   = cache->chCnt;
+    map->base    = base;
+    map->mapLen  = (size_t)st.st_size;
+    countLookup(cache, YES);
+    return map;
+}
+
+void ksy_pcm_map_prefault(const KSYPcmMap* map, int64_t nbFrame) {
+    if (map == NULL) {
+        return;
+    }
+    size_t len = map->mapLen;
+    if (nbFrame > 0 && nbFrame < map->nbFrame) {
+        len = PCM_HDR_SIZE + (size_t)nbFrame * map->chCnt * sizeof(int16_t);
+    }
+    const volatile uint8_t * p = map->base;
+    uint8_t sum = 0;
+    for (size_t off = 0; off < len; off += PCM_PAGE) {
+        sum += p[off];
+    }
+    (void)sum;
+}
+
+void ksy_pcm_map_release(KSYPcmMap* map) {
+    if (map == NULL) {
+        return;
+    }
+    munmap(map->base, map->mapLen);
+    free(map);
+}
+
+#pragma mark - writer
+KSYPcmWriter* ksy_pcm_cache_begin(KSYPcmCache* cache, const char* srcPath) {
+    uint64_t key = 0;
+    if (!ksy_pcm_cache_key(cache, srcPath, &key)) {
+        return NULL;
+    }
+    KSYPcmWriter * w = calloc(1, sizeof(KSYPcmWriter));
+    if (w == NULL) {
+        return NULL;
+    }
+    w->cache = cache;
+    w->key   = key;
+    snprintf(w->tmp, sizeof(w->tmp), "%s/.tmpXXXXXX", cache->dir);
+    int fd = mkstemp(w->tmp);
+    w->fp = fd >= 0 ? fdopen(fd, "wb") : NULL;
+    if (w->fp == NULL) {
+        if (fd >= 0) {
+            close(fd);
+            unlink(w->tmp);
+        }
+        free(w);
+        return NULL;
+    }
+    // 先占位, 提交时写入帧数
+    uint8_t hdr[PCM_HDR_SIZE] = {0};
+    w->bErr = fwrite(hdr, 1, PCM_HDR_SIZE, w->fp) != PCM_HDR_SIZE;
+    return w;
+}
+
+BOOL ksy_pcm_writer_write(KSYPcmWriter* w, const int16_t* pcm, int nbFrame) {
+    if (w == NULL || w->bErr || pcm == NULL || nbFrame < 0) {
+        return NO;
+    }
+    size_t ch = w->cache->chCnt;
+    if (fwrite(pcm, sizeof(int16_t) * ch, nbFrame, w->fp) != (size_t)nbFrame) {
+        w->bErr = YES;
+        return NO;
+    }
+    w->nbFrame += nbFrame;
+    return YES;
+}
+
+void ksy_pcm_writer_abort(KSYPcmWriter* w) {
+    if (w == NULL) {
+        return;
+    }
+    if (w->fp) {
+        fclose(w->fp);
+    }
+    unlink(w->tmp);
+    free(w);
+}
+
+BOOL ksy_pcm_writer_commit(KSYPcmWriter* w) {
+    if (w == NULL) {
+        return NO;
+    }
+    KSYPcmCache * cache = w->cache;
+    int64_t size = PCM_HDR_SIZE + w->nbFrame * cache->chCnt * (int64_t)sizeof(int16_t);
+    PcmHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, PCM_MAGIC, 4);
+    hdr.version = PCM_VERSION;
+    hdr.rate    = cache->rate;
+    hdr.chCnt   = cache->chCnt;
+    hdr.nbFrame = w->nbFrame;
+    hdr.key     = w->key;
+    BOOL bOk = !w->bErr && w->nbFrame > 0 &&
+               fseek(w->fp, 0, SEEK_SET) == 0 &&
+               fwrite(&hdr, sizeof(hdr), 1, w->fp) == 1;
+    bOk = (fclose(w->fp) == 0) && bOk;
+    w->fp = NULL;
+    pthread_mutex_lock(&cache->lock);
+    bOk = bOk && size <= cache->budget;
+    char path[PATH_MAX];
+    entryPath(cache, w->key, path);
+    if (bOk && rename(w->tmp, path) == 0) {
+        utimensat(AT_FDCWD, path, NULL, 0); // 新加入的最后删除
+        trimLocked(cache, cache->budget);
+    }
+    else {
+        bOk = NO;
+    }
+    pthread_mutex_unlock(&cache->lock);
+    ksy_pcm_writer_abort(w);
+    return bOk;
+}
+
+#pragma mark - misc
+void ksy_pcm_cache_clear(KSYPcmCache* cache) {
+    if (cache == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&cache->lock);
+    int64_t evictCnt = cache->stat.evictCnt;
+    trimLocked(cache, 0);
+    cache->stat.evictCnt = evictCnt;
+    pthread_mutex_unlock(&cache->lock);
+}
+
+void ksy_pcm_cache_get_stat(KSYPcmCache* cache, KSYPcmCacheStat* stat) {
+    if (cache == NULL || stat == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&cache->lock);
+    *stat = cache->stat;
+    pthread_mutex_unlock(&cache->lock);
+}
@@ -0,0 +1,92 @@
+//
+//  KSYAudioResampler.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** 多相加窗sinc重采样
+
+ 1. 滤波器预先计算为多相系数表, 相位之间线性插值, 支持任意的采样率比例
+ 2. 内积运算使用 KSYAudioKernel 中的SIMD实现
+ 3. 每个实例保存各声道的历史数据, 输入任意长度的数据, 输出都是连续的, 不会有咔哒声
+ 4. 输入输出均为交织的float数据
+ */
+typedef struct _KSYAudioResampler KSYAudioResampler;
+
+/// 重采样质量
+typedef NS_ENUM(int, KSYResampleQuality) {
+    /// 16阶, 适合低端设备, 通带约到 0.85*奈奎斯特频率
+    KSYResampleQuality_Low = 0,
+    /// 32阶, 通带约到 0.91*奈奎斯特频率
+    KSYResampleQuality_Medium,
+    /// 64阶, 通带约到 0.95*奈奎斯特频率
+    KSYResampleQuality_High,
+};
+
+/**
+ @abstract  创建重采样器
+ @param     inRate  输入采样率
+ @param     outRate 输出采样率
+ @param     chCnt   声道数
+ @param     quality 质量
+ @return    参数错误时返回NULL
+ */
+KSYAudioResampler* ksy_resampler_create(int inRate, int outRate, int chCnt,
+                                        KSYResampleQuality quality);
+
+/**
+ @abstract  销毁重采样器
+ */
+void ksy_resampler_destroy(KSYAudioResampler* rs);
+
+/**
+ @abstract  微调重采样比例 (用于补偿时钟漂移)
+ @param     ratio 实际步长与标称步长之比, >1 时每个输出帧消耗更多的输入; 有效范围 0.9~1.1
+ @discussion 只改变之后输出的帧的步长, 不会引起不连续
+ */
+void ksy_resampler_set_ratio(KSYAudioResampler* rs, double ratio);
+
+/**
+ @abstract  改变输入输出采样率 (如变调时连续改变比例)
+ @discussion 保留历史数据和当前位置, 输出连续; 重新计算滤波器系数, 不要频繁调用
+             (已用 ksy_resampler_prepare_rates 预先计算且比例在范围内时, 只切换系数, 可以频繁调用)
+ @discussion 之前 ksy_resampler_set_ratio 的微调被清除
+ */
+void ksy_resampler_set_rates(KSYAudioResampler* rs, int inRate, int outRate);
+
+/**
+ @abstract  预先计算一组滤波器, 之后 ksy_resampler_set_rates 不再重新计算系数 (在开始处理之前调用)
+ @param     maxRatio 输入/输出采样率之比的上限 (>1)
+ @param     nbBand   组数 (2~64), 第i组的截止频率对应比例 maxRatio^(i/(nbBand-1))
+ @return    失败时返回NO, set_rates 仍按原来的方式重新计算
+ @discussion 比例不大于1时用第0组 (与重新计算的系数相同); 大于1时用比例不小于它的最近一组,
+             截止频率最多低一组, 不会混叠; 超过 maxRatio 时仍重新计算
+ @discussion 占用 nbBand 倍的系数内存 (Medium 每组约16KB)
+ */
+BOOL ksy_resampler_prepare_rates(KSYAudioResampler* rs, double maxRatio, int nbBand);
+
+/**
+ @abstract  输入nbIn帧时, 最多可能输出的帧数 (用于分配输出buffer)
+ */
+int ksy_resampler_max_out(const KSYAudioResampler* rs, int nbIn);
+
+/**
+ @abstract  重采样
+ @param     in     输入数据 (交织)
+ @param     nbIn   输入帧数
+ @param     out    输出数据 (交织)
+ @param     maxOut 输出buffer的容量(帧), 应不小于 ksy_resampler_max_out(nbIn)
+ @return    输出的帧数
+ @discussion 输出相对输入有 (阶数/2) 帧左右的延迟
+ */
+int ksy_resampler_process(KSYAudioResampler* rs, const float* in, int nbIn,
+                          float* out, int maxOut);
+
+/**
+ @abstract  清空历史数据 (如切换音源或seek之后)
+ */
+void ksy_resampler_reset(KSYAudioResampler* rs);
@@ -0,0 +1,269 @@
+//
+//  KSYAudioResampler.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioResampler.h"
+#import "KSYAudioKernel.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define RS_MAX_CH   8
+#define RS_CHUNK    1024  // 每次放入历史buffer的最大帧数
+#define RS_FRAC     32    // 位置的小数部分位数
+
+typedef struct {
+    int     taps;    // 每个相位的系数个数
+    int     phases;  // 相位数
+    double  beta;    // kaiser窗参数
+    double  cutoff;  // 截止频率 (相对奈奎斯特频率)
+} KSYResampleParam;
+
+static const KSYResampleParam s_params[] = {
+    { 16,  64,  6.0, 0.85 },
+    { 32, 128,  8.0, 0.91 },
+    { 64, 256, 10.0, 0.95 },
+};
+
+struct _KSYAudioResampler {
+    int         inRate;
+    int         outRate;
+    int         chCnt;
+    int         taps;
+    int         phases;
+    const KSYResampleParam * prm;
+    float *     table;       // 当前使用的系数, (phases+1) * taps
+    float *     own;         // 重新计算的系数
+    float *     bank;        // 预先计算的各组系数 (ksy_resampler_prepare_rates)
+    int         nbBand;
+    double      bankMax;
+    uint64_t    baseStep;    // 标称的步长
+    uint64_t    step;        // 每个输出帧前进的输入帧数, 32.32 定点
+    uint64_t    pos;         // 下一个输出帧在历史buffer中的位置, 32.32 定点
+    float *     buf[RS_MAX_CH];
+    int         bufLen;      // 历史buffer中的帧数
+    int         bufCap;
+};
+
+// 第一类零阶修正贝塞尔函数
+static double besselI0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 50; ++k) {
+        term *= (x / (2.0*k)) * (x / (2.0*k));
+        sum  += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+// 第p个相位的系数: h(p/phases + taps/2 - 1 - j), fc 为相对奈奎斯特频率的截止频率
+static void buildTable(const KSYAudioResampler* rs, float* table, double fc) {
+    const KSYResampleParam * prm = rs->prm;
+    double half = rs->taps / 2.0;
+    double i0b  = besselI0(prm->beta);
+    for (int p = 0; p <= rs->phases; ++p) {
+        float * row = table + p*rs->taps;
+        double  sum = 0.0;
+        for (int j = 0; j < rs->taps; ++j) {
+            double t = (double)p / rs->phases + half - 1 - j;
+            double x = t / half;
+            double w = fabs(x) >= 1.0 ? 0.0 : besselI0(prm->beta*sqrt(1.0 - x*x)) / i0b;
+            double s = t == 0.0 ? 1.0 : sin(M_PI*fc*t) / (M_PI*fc*t);
+            row[j] = (float)(fc * s * w);
+            sum   += row[j];
+        }
+        for (int j = 0; j < rs->taps; ++j) { // 每个相位的直流增益归一
+            row[j] = (float)(row[j] / sum);
+        }
+    }
+}
+
+// 按当前采样率选用预先计算的系数, 或者重新计算
+static void updateTable(KSYAudioResampler* rs) {
+    double ratio = (double)rs->inRate / rs->outRate;
+    if (rs->bank && ratio <= rs->bankMax) {
+        int band = 0;
+        if (ratio > 1.0) { // 取比例不小于 ratio 的一组, 误差留给浮点舍入
+            band = (int)ceil(log(ratio) / log(rs->bankMax) * (rs->nbBand - 1) - 1e-9);
+        }
+        rs->table = rs->bank + (size_t)band * (rs->phases+1) * rs->taps;
+        return;
+    }
+    double fc = rs->prm->cutoff;
+    if (ratio > 1.0) { // 降采样时截止频率随之降低
+        fc *= (double)rs->outRate / rs->inRate;
+    }
+    buildTable(rs, rs->own, fc);
+    rs->table = rs->own;
+}
+
+KSYAudioResampler* ksy_resampler_create(int inRate, int outRate, int chCnt,
+                                        KSYResampleQuality quality) {
+    if (inRate <= 0 || outRate <= 0 || chCnt <= 0 || chCnt > RS_MAX_CH ||
+        quality < KSYResampleQuality_Low || quality > KSYResampleQuality_High) {
+        return NULL;
+    }
+    const KSYResampleParam * prm = &s_params[quality];
+    KSYAudioResampler* rs = calloc(1, sizeof(KSYAudioResampler));
+    if (rs == NULL) {
+        return NULL;
+    }
+    rs->inRate  = inRate;
+    rs->outRate = outRate;
+    rs->chCnt   = chCnt;
+    rs->taps    = prm->taps;
+    rs->phases  = prm->phases;
+    rs->prm     = prm;
+    rs->baseStep = ((uint64_t)inRate << RS_FRAC) / outRate;
+    rs->step    = rs->baseStep;
+    rs->bufCap  = rs->taps + RS_CHUNK;
+    rs->own     = malloc(sizeof(float) * (rs->phases+1) * rs->taps);
+    BOOL bOK    = rs->own != NULL;
+    for (int c = 0; c < chCnt && bOK; ++c) {
+        rs->buf[c] = malloc(sizeof(float) * rs->bufCap);
+        bOK = rs->buf[c] != NULL;
+    }
+    if (!bOK) {
+        ksy_resampler_destroy(rs);
+        return NULL;
+    }
+    updateTable(rs);
+    ksy_resampler_reset(rs);
+    return rs;
+}
+
+void ksy_resampler_destroy(KSYAudioResampler* rs) {
+    if (rs == NULL) {
+        return;
+    }
+    for (int c = 0; c < rs->chCnt; ++c) {
+        free(rs->buf[c]);
+    }
+    free(rs->own);
+    free(rs->bank);
+    free(rs);
+}
+
+void ksy_resampler_reset(KSYAudioResampler* rs) {
+    if (rs == NULL) {
+        return;
+    }
+    // 前面补 taps/2-1 个0, 使第一个输出帧对齐第一个输入帧
+    rs->bufLen = rs->taps/2 - 1;
+    for (int c = 0; c < rs->chCnt; ++c) {
+        memset(rs->buf[c], 0, sizeof(float) * rs->bufLen);
+    }
+    rs->pos = 0;
+}
+
+void ksy_resampler_set_ratio(KSYAudioResampler* rs, double ratio) {
+    if (rs == NULL || !(ratio > 0.9 && ratio < 1.1)) {
+        return;
+    }
+    rs->step = (uint64_t)llround(rs->baseStep * ratio);
+}
+
+void ksy_resampler_set_rates(KSYAudioResampler* rs, int inRate, int outRate) {
+    if (rs == NULL || inRate <= 0 || outRate <= 0 ||
+        (inRate == rs->inRate && outRate == rs->outRate)) {
+        return;
+    }
+    // 历史数据和当前位置不变, 之后的输出帧按新的步长和滤波器计算
+    rs->inRate   = inRate;
+    rs->outRate  = outRate;
+    rs->baseStep = ((uint64_t)inRate << RS_FRAC) / outRate;
+    rs->step     = rs->baseStep;
+    updateTable(rs);
+}
+
+BOOL ksy_resampler_prepare_rates(KSYAudioResampler* rs, double maxRatio, int nbBand) {
+    if (rs == NULL || !(maxRatio > 1.0) || nbBand < 2 || nbBand > 64) {
+        return NO;
+    }
+    size_t  size = (size_t)(rs->phases+1) * rs->taps;
+    float * bank = malloc(sizeof(float) * size * nbBand);
+    if (bank == NULL) {
+        return NO;
+    }
+    for (int i = 0; i < nbBand; ++i) {
+        double ratio = pow(maxRatio, (double)i / (nbBand - 1));
+        buildTable(rs, bank + size * i, rs->prm->cutoff / ratio);
+    }
+    free(rs->bank);
+    rs->bank    = bank;
+    rs->nbBand  = nbBand;
+    rs->bankMax = maxRatio;
+    updateTable(rs);
+    return YES;
+}
+
+int ksy_resampler_max_out(const KSYAudioResampler* rs, int nbIn) {
+    if (rs == NULL || nbIn <= 0) {
+        return 0;
+    }
+    // 历史数据中最多还有 taps 帧未输出
+    return (int)(((uint64_t)(nbIn + rs->taps) << RS_FRAC) / rs->step) + 2;
+}
+
+int ksy_resampler_process(KSYAudioResampler* rs, const float* in, int nbIn,
+                          float* out, int maxOut) {
+    if (rs == NULL || in == NULL || out == NULL || nbIn < 0) {
+        return 0;
+    }
+    const int   ch     = rs->chCnt;
+    const int   taps   = rs->taps;
+    const float fscale = 1.0f / 4294967296.0f;
+    int nbOut = 0;
+    while (nbIn > 0) {
+        // 放入一段输入 (转为平面格式)
+        int n = rs->bufCap - rs->bufLen;
+        n = n < nbIn ? n : nbIn;
+        if (n <= 0) { // 输出buffer不足, 历史buffer已满
+            break;
+        }
+        for (int c = 0; c < ch; ++c) {
+            float * b = rs->buf[c] + rs->bufLen;
+            for (int i = 0; i < n; ++i) {
+                b[i] = in[i*ch + c];
+            }
+        }
+        rs->bufLen += n;
+        in   += n*ch;
+        nbIn -= n;
+        // 生成输出
+        while ((int)(rs->pos >> RS_FRAC) + taps <= rs->bufLen && nbOut < maxOut) {
+            int      idx  = (int)(rs->pos >> RS_FRAC);
+            uint64_t pf   = (rs->pos & 0xFFFFFFFFu) * (uint64_t)rs->phases;
+            int      p    = (int)(pf >> RS_FRAC);
+            float    t    = (float)(pf & 0xFFFFFFFFu) * fscale;
+            const float * h0 = rs->table + p*taps;
+            const float * h1 = h0 + taps;
+            float * o = out + nbOut*ch;
+            for (int c = 0; c < ch; ++c) {
+                float a, b;
+                ksy_dot2_f32(rs->buf[c] + idx, h0, h1, taps, &a, &b);
+                o[c] = a + (b - a) * t;
+            }
+            nbOut   += 1;
+            rs->pos += rs->step;
+        }
+        // 丢弃不再需要的历史数据
+        int drop = (int)(rs->pos >> RS_FRAC);
+        drop = drop < rs->bufLen ? drop : rs->bufLen;
+        if (drop > 0) {
+            for (int c = 0; c < ch; ++c) {
+                memmove(rs->buf[c], rs->buf[c] + drop,
+                        sizeof(float) * (rs->bufLen - drop));
+            }
+            rs->bufLen -= drop;
+            rs->pos    -= (uint64_t)drop << RS_FRAC;
+        }
+    }
+    return nbOut;
+}
@@ -0,0 +1,73 @@
+//
+//  KSYAudioRing.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** 单生产者/单消费者 无锁PCM环形缓冲
+
+ 1. 只允许一个线程写入 (生产者), 一个线程读取 (消费者), 两端都不加锁
+ 2. 容量以帧为单位 (一帧 = 各声道一个样本), 创建时向上取整为2的幂
+ 3. 读写位置分别独占缓存行, 避免两个线程间的伪共享
+ 4. 写满时丢弃多余的数据 (计入溢出), 读不足时返回已有数据 (计入欠载)
+ */
+typedef struct _KSYAudioRing KSYAudioRing;
+
+/** 环形缓冲的统计信息 (任意线程可读) */
+typedef struct _KSYAudioRingStat {
+    int      capacity;      // 容量(帧)
+    int      fill;          // 当前缓存的帧数
+    int      highWater;     // 缓存帧数的历史最大值
+    int64_t  underrunCnt;   // 读取时数据不足的次数
+    int64_t  overrunFrames; // 写入时因缓冲已满而丢弃的帧数
+    int64_t  writeFrames;   // 累计写入的帧数
+    int64_t  readFrames;    // 累计读出的帧数
+} KSYAudioRingStat;
+
+/**
+ @abstract  创建环形缓冲
+ @param     nbFrame   最少能缓存的帧数
+ @param     frameSize 每帧的字节数 (如单声道S16为2)
+ @return    失败时返回NULL
+ */
+KSYAudioRing* ksy_ring_create(int nbFrame, int frameSize);
+
+/**
+ @abstract  销毁环形缓冲 (须保证读写两端都已停止)
+ */
+void ksy_ring_destroy(KSYAudioRing* ring);
+
+/**
+ @abstract  写入数据 (仅限生产者线程)
+ @param     data    待写入的数据
+ @param     nbFrame 帧数
+ @return    实际写入的帧数, 不足nbFrame时剩余部分被丢弃
+ */
+int ksy_ring_write(KSYAudioRing* ring, const void* data, int nbFrame);
+
+/**
+ @abstract  读取数据 (仅限消费者线程)
+ @param     data    输出buffer, 为NULL时仅丢弃数据
+ @param     nbFrame 希望读取的帧数
+ @return    实际读取的帧数
+ */
+int ksy_ring_read(KSYAudioRing* ring, void* data, int nbFrame);
+
+/**
+ @abstract  丢弃所有缓存的数据 (仅限消费者线程)
+ */
+void ksy_ring_flush(KSYAudioRing* ring);
+
+/**
+ @abstract  当前缓存的帧数 (任意线程)
+ */
+int ksy_ring_fill(const KSYAudioRing* ring);
+
+/**
+ @abstract  获取统计信息 (任意线程)
+ */
+void ksy_ring_get_stat(const KSYAudioRing* ring, KSYAudioRingStat* stat);
@@ -0,0 +1,189 @@
+//
+//  KSYAudioRing.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioRing.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+// arm64 的部分设备上缓存行为128字节, 统一按128对齐
+#define RING_CACHE_LINE  128
+#define RING_MAX_FRAMES  (1 << 24)
+
+struct _KSYAudioRing {
+    // 生产者独占
+    _Alignas(RING_CACHE_LINE) _Atomic uint64_t wPos;
+    uint64_t               rPosCache; // 生产者看到的读位置
+    _Atomic int            highWater;
+    _Atomic int64_t        overrunFrames;
+    // 消费者独占
+    _Alignas(RING_CACHE_LINE) _Atomic uint64_t rPos;
+    uint64_t               wPosCache; // 消费者看到的写位置
+    _Atomic int64_t        underrunCnt;
+    // 创建后只读
+    _Alignas(RING_CACHE_LINE) uint8_t * buf;
+    int                    capacity;
+    int                    mask;
+    int                    frameSize;
+};
+
+static int roundUpPow2(int n) {
+    int c = 1;
+    while (c < n) {
+        c <<= 1;
+    }
+    return c;
+}
+
+KSYAudioRing* ksy_ring_create(int nbFrame, int frameSize) {
+    if (nbFrame <= 0 || nbFrame > RING_MAX_FRAMES || frameSize <= 0) {
+        return NULL;
+    }
+    KSYAudioRing* ring = NULL;
+    if (posix_memalign((void**)&ring, RING_CACHE_LINE, sizeof(KSYAudioRing))) {
+        return NULL;
+    }
+    memset(ring, 0, sizeof(KSYAudioRing));
+    ring->capacity  = roundUpPow2(nbFrame);
+    ring->mask      = ring->capacity - 1;
+    ring->frameSize = frameSize;
+    if (posix_memalign((void**)&ring->buf, RING_CACHE_LINE,
+                       (size_t)ring->capacity * frameSize)) {
+        free(ring);
+        return NULL;
+    }
+    memset(ring->buf, 0, (size_t)ring->capacity * frameSize);
+    atomic_init(&ring->wPos, 0);
+    atomic_init(&ring->rPos, 0);
+    atomic_init(&ring->highWater, 0);
+    atomic_init(&ring->overrunFrames, 0);
+    atomic_init(&ring->underrunCnt, 0);
+    return ring;
+}
+
+void ksy_ring_destroy(KSYAudioRing* ring) {
+    if (ring) {
+        free(ring->buf);
+        free(ring);
+    }
+}
+
+int ksy_ring_write(KSYAudioRing* ring, const void* data, int nbFrame) {
+    if (ring == NULL || data == NULL || nbFrame <= 0) {
+        return 0;
+    }
+    uint64_t w = atomic_load_explicit(&ring->wPos, memory_order_relaxed);
+    uint64_t r = ring->rPosCache;
+    if (ring->capacity - (int)(w - r) < nbFrame) { // 缓存的读位置可能过期
+        r = atomic_load_explicit(&ring->rPos, memory_order_acquire);
+        ring->rPosCache = r;
+    }
+    int space = ring->capacity - (int)(w - r);
+    int n = nbFrame < space ? nbFrame : space;
+    if (n < nbFrame) {
+        atomic_fetch_add_explicit(&ring->overrunFrames, nbFrame - n,
+                                  memory_order_relaxed);
+    }
+    if (n <= 0) {
+        return 0;
+    }
+    int off   = (int)(w & ring->mask);
+    int first = ring->capacity - off;
+    if (first > n) {
+        first = n;
+    }
+    const uint8_t* src = (const uint8_t*)data;
+    memcpy(ring->buf + (size_t)off*ring->frameSize, src, (size_t)first*ring->frameSize);
+    if (n > first) {
+        memcpy(ring->buf, src + (size_t)first*ring->frameSize,
+               (size_t)(n-first)*ring->frameSize);
+    }
+    atomic_store_explicit(&ring->wPos, w + n, memory_order_release);
+    int fill = (int)(w + n - r);
+    if (fill > atomic_load_explicit(&ring->highWater, memory_order_relaxed)) {
+        // 缓存的读位置偏旧会高估长度, 刷新后再记录
+        r = atomic_load_explicit(&ring->rPos, memory_order_acquire);
+        ring->rPosCache = r;
+        fill = (int)(w + n - r);
+        if (fill > atomic_load_explicit(&ring->highWater, memory_order_relaxed)) {
+            atomic_store_explicit(&ring->highWater, fill, memory_order_relaxed);
+        }
+    }
+    return n;
+}
+
+int ksy_ring_read(KSYAudioRing* ring, void* data, int nbFrame) {
+    if (ring == NULL || nbFrame <= 0) {
+        return 0;
+    }
+    uint64_t r = atomic_load_explicit(&ring->rPos, memory_order_relaxed);
+    uint64_t w = ring->wPosCache;
+    if ((int)(w - r) < nbFrame) { // 缓存的写位置可能过期
+        w = atomic_load_explicit(&ring->wPos, memory_order_acquire);
+        ring->wPosCache = w;
+    }
+    int avail = (int)(w - r);
+    int n = nbFrame < avail ? nbFrame : avail;
+    if (n < nbFrame) {
+        atomic_fetch_add_explicit(&ring->underrunCnt, 1, memory_order_relaxed);
+    }
+    if (n <= 0) {
+        return 0;
+    }
+    if (data) {
+        int off   = (int)(r & ring->mask);
+        int first = ring->capacity - off;
+        if (first > n) {
+            first = n;
+        }
+        uint8_t* dst = (uint8_t*)data;
+        memcpy(dst, ring->buf + (size_t)off*ring->frameSize, (size_t)first*ring->frameSize);
+        if (n > first) {
+            memcpy(dst + (size_t)first*ring->frameSize, ring->buf,
+                   (size_t)(n-first)*ring->frameSize);
+        }
+    }
+    atomic_store_explicit(&ring->rPos, r + n, memory_order_release);
+    return n;
+}
+
+void ksy_ring_flush(KSYAudioRing* ring) {
+    if (ring == NULL) {
+        return;
+    }
+    uint64_t w = atomic_load_explicit(&ring->wPos, memory_order_acquire);
+    ring->wPosCache = w;
+    atomic_store_explicit(&ring->rPos, w, memory_order_release);
+}
+
+int ksy_ring_fill(const KSYAudioRing* ring) {
+    if (ring == NULL) {
+        return 0;
+    }
+    // 先读 rPos 再读 wPos, 保证 w >= r
+    uint64_t r = atomic_load_explicit(&((KSYAudioRing*)ring)->rPos, memory_order_acquire);
+    uint64_t w = atomic_load_explicit(&((KSYAudioRing*)ring)->wPos, memory_order_acquire);
+    int fill = (int)(w - r);
+    return fill > ring->capacity ? ring->capacity : fill;
+}
+
+void ksy_ring_get_stat(const KSYAudioRing* ring, KSYAudioRingStat* stat) {
+    if (ring == NULL || stat == NULL) {
+        return;
+    }
+    KSYAudioRing* rb = (KSYAudioRing*)ring;
+    uint64_t r = atomic_load_explicit(&rb->rPos, memory_order_acquire);
+    uint64_t w = atomic_load_explicit(&rb->wPos, memory_order_acquire);
+    stat->capacity      = ring->capacity;
+    stat->fill          = (int)(w - r);
+    stat->highWater     = atomic_load_explicit(&rb->highWater, memory_order_relaxed);
+    stat->underrunCnt   = atomic_load_explicit(&rb->underrunCnt, memory_order_relaxed);
+    stat->overrunFrames = atomic_load_explicit(&rb->overrunFrames, memory_order_relaxed);
+    stat->writeFrames   = (int64_t)w;
+    stat->readFrames    = (int64_t)r;
+}
@@ -0,0 +1,73 @@
+//
+//  KSYAudioRoomReverb.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <CoreMedia/CoreMedia.h>
+
+/** 参数连续可调的混响 (基于 KSYAudioFdnReverb)
+
+ 1. 与 SDK 中 KSYAudioReverb 的用法相同, 在麦克风回调中调用 processAudioSampleBuffer:
+ 2. 支持单声道/双声道, S16或float交织数据; 格式变化时自动重建, 其余时间不分配内存
+ 3. 参数可以在任意线程修改, 下一段数据开始生效
+ */
+@interface KSYAudioRoomReverb : NSObject
+
+/**
+ @abstract  房间大小 (0~1), 默认为0.5
+ */
+@property (atomic, assign) float roomSize;
+
+/**
+ @abstract  高频阻尼 (0~1), 默认为0.5
+ */
+@property (atomic, assign) float damping;
+
+/**
+ @abstract  混响声的比例 (0~1), 默认为0.3
+ */
+@property (atomic, assign) float wet;
+
+/**
+ @abstract  原声的比例 (0~1), 默认为1.0
+ */
+@property (atomic, assign) float dry;
+
+/**
+ @abstract  预延迟 (0~100毫秒), 默认为20
+ */
+@property (atomic, assign) float preDelayMs;
+
+/**
+ @abstract  处理一段音频数据, 添加混响 (原地修改)
+ @param     sampleBuffer 音频数据
+ @return    NO 表示格式不支持 (平面格式或多于2个声道), 数据未修改
+ */
+- (BOOL) processAudioSampleBuffer:(CMSampleBufferRef)sampleBuffer;
+
+/**
+ @abstract  处理一段 S16 交织数据 (原地修改)
+ */
+- (BOOL) processS16:(int16_t*)pcm
+            nbFrame:(int)nbFrame
+               rate:(int)rate
+              chCnt:(int)chCnt;
+
+/**
+ @abstract  处理一段 float 交织数据 (原地修改)
+ */
+- (BOOL) processF32:(float*)pcm
+            nbFrame:(int)nbFrame
+               rate:(int)rate
+              chCnt:(int)chCnt;
+
+/**
+ @abstract  清空混响尾音 (与 process 在同一线程调用)
+ */
+- (void) reset;
+
+@end
@@ -0,0 +1,121 @@
+//
+//  KSYAudioRoomReverb.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioRoomReverb.h"
+#import "KSYAudioFdnReverb.h"
+
+@interface KSYAudioRoomReverb () {
+    // 处理线程使用
+    KSYAudioFdnReverb * _fdn;
+    int                 _rate;
+    int                 _chCnt;
+    KSYReverbParam      _curParam;
+}
+@end
+
+@implementation KSYAudioRoomReverb
+
+- (instancetype) init {
+    self = [super init];
+    if (self == nil) {
+        return nil;
+    }
+    _roomSize   = 0.5f;
+    _damping    = 0.5f;
+    _wet        = 0.3f;
+    _dry        = 1.0f;
+    _preDelayMs = 20.0f;
+    return self;
+}
+
+- (void) dealloc {
+    ksy_fdn_destroy(_fdn);
+}
+
+// 处理线程: 格式变化时重建, 参数变化时更新
+- (BOOL) prepare:(int)rate chCnt:(int)chCnt {
+    BOOL bNew = NO;
+    if (_fdn == NULL || rate != _rate || chCnt != _chCnt) {
+        ksy_fdn_destroy(_fdn);
+        _fdn   = ksy_fdn_create(rate, chCnt);
+        _rate  = rate;
+        _chCnt = chCnt;
+        if (_fdn == NULL) {
+            return NO;
+        }
+        bNew = YES;
+    }
+    KSYReverbParam param = { self.roomSize, self.damping, self.wet,
+                             self.dry, self.preDelayMs };
+    if (bNew || memcmp(&param, &_curParam, sizeof(param)) != 0) {
+        ksy_fdn_set_param(_fdn, &param);
+        _curParam = param;
+    }
+    return YES;
+}
+
+- (BOOL) processS16:(int16_t*)pcm
+            nbFrame:(int)nbFrame
+               rate:(int)rate
+              chCnt:(int)chCnt {
+    if (pcm == NULL || nbFrame <= 0 || ![self prepare:rate chCnt:chCnt]) {
+        return NO;
+    }
+    ksy_fdn_process_s16(_fdn, pcm, nbFrame);
+    return YES;
+}
+
+- (BOOL) processF32:(float*)pcm
+            nbFrame:(int)nbFrame
+               rate:(int)rate
+              chCnt:(int)chCnt {
+    if (pcm == NULL || nbFrame <= 0 || ![self prepare:rate chCnt:chCnt]) {
+        return NO;
+    }
+    ksy_fdn_process_f32(_fdn, pcm, nbFrame);
+    return YES;
+}
+
+- (BOOL) processAudioSampleBuffer:(CMSampleBufferRef)sampleBuffer {
+    if (sampleBuffer == NULL) {
+        return NO;
+    }
+    CMFormatDescriptionRef desc = CMSampleBufferGetFormatDescription(sampleBuffer);
+    const AudioStreamBasicDescription * asbd = desc ?
+        CMAudioFormatDescriptionGetStreamBasicDescription(desc) : NULL;
+    if (asbd == NULL || asbd->mFormatID != kAudioFormatLinearPCM ||
+        (asbd->mFormatFlags & kAudioFormatFlagIsNonInterleaved)) {
+        return NO;
+    }
+    BOOL bFloat = (asbd->mFormatFlags & kAudioFormatFlagIsFloat) != 0;
+    if ((bFloat && asbd->mBitsPerChannel != 32) ||
+        (!bFloat && asbd->mBitsPerChannel != 16)) {
+        return NO;
+    }
+    CMBlockBufferRef block = CMSampleBufferGetDataBuffer(sampleBuffer);
+    size_t len = 0;
+    char * data = NULL;
+    int nbFrame = (int)CMSampleBufferGetNumSamples(sampleBuffer);
+    if (block == NULL ||
+        CMBlockBufferGetDataPointer(block, 0, NULL, &len, &data) != kCMBlockBufferNoErr ||
+        len < (size_t)nbFrame * asbd->mBytesPerFrame) {
+        return NO;
+    }
+    int rate  = (int)asbd->mSampleRate;
+    int chCnt = (int)asbd->mChannelsPerFrame;
+    if (bFloat) {
+        return [self processF32:(float*)data nbFrame:nbFrame rate:rate chCnt:chCnt];
+    }
+    return [self processS16:(int16_t*)data nbFrame:nbFrame rate:rate chCnt:chCnt];
+}
+
+- (void) reset {
+    ksy_fdn_reset(_fdn);
+}
+
+@end
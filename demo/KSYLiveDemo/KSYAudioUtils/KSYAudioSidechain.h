@@ -0,0 +1,91 @@
+//
+//  KSYAudioSidechain.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** 侧链闪避的增益计算
+
+ 1. 分析主轨(人声)的包络, 电平超过门限时判定为有人声, 人声停止后保持 holdMs
+ 2. 有人声时目标增益为 depthDb, 否则为 0dB; 增益逐个采样按 attack/release 平滑
+ 3. 每次分析得到与主轨数据等长的增益曲线, 之后可以应用到任意个被闪避的track上
+    (按时长对齐, 被闪避的track可以有不同的帧数和声道数)
+ 4. 所有接口在同一个线程(主轨线程)调用
+ */
+typedef struct _KSYAudioSidechain KSYAudioSidechain;
+
+/// 闪避参数
+typedef struct {
+    /// 增益下降的时间常数 (毫秒)
+    float attackMs;
+    /// 增益恢复的时间常数 (毫秒)
+    float releaseMs;
+    /// 人声停止后保持衰减的时长 (毫秒), 避免字间的停顿造成增益起伏
+    float holdMs;
+    /// 有人声时的增益 (dB, <=0)
+    float depthDb;
+    /// 人声的判定门限 (dBFS)
+    float thresholdDb;
+} KSYDuckParam;
+
+/**
+ @abstract  创建
+ @param     rate 主轨的采样率
+ @return    参数错误时返回NULL
+ */
+KSYAudioSidechain* ksy_sidechain_create(int rate);
+
+/**
+ @abstract  销毁
+ */
+void ksy_sidechain_destroy(KSYAudioSidechain* sc);
+
+/**
+ @abstract  设置参数 (下一次分析时生效)
+ */
+void ksy_sidechain_set_param(KSYAudioSidechain* sc, const KSYDuckParam* param);
+
+/**
+ @abstract  分析一段主轨数据, 生成增益曲线
+ @param     pcm     S16 交织数据
+ @param     nbFrame 帧数
+ @param     chCnt   声道数
+ @return    曲线的长度, 失败时返回0
+ */
+int ksy_sidechain_analyze_s16(KSYAudioSidechain* sc, const int16_t* pcm,
+                              int nbFrame, int chCnt);
+
+/**
+ @abstract  把最近一次的增益曲线应用到一段数据上 (原地修改)
+ @param     pcm     S16 交织数据, 时长应与分析的主轨数据相同
+ @param     nbFrame 帧数
+ @param     chCnt   声道数
+ */
+void ksy_sidechain_apply_s16(const KSYAudioSidechain* sc, int16_t* pcm,
+                             int nbFrame, int chCnt);
+
+/**
+ @abstract  最近一次的增益曲线
+ @param     len 输出曲线的长度
+ @return    线性增益
+ */
+const float* ksy_sidechain_curve(const KSYAudioSidechain* sc, int* len);
+
+/**
+ @abstract  当前增益 (dB)
+ */
+float ksy_sidechain_gain_db(const KSYAudioSidechain* sc);
+
+/**
+ @abstract  当前是否判定为有人声 (含保持时间)
+ */
+BOOL ksy_sidechain_active(const KSYAudioSidechain* sc);
+
+/**
+ @abstract  清空状态, 增益回到 0dB
+ */
+void ksy_sidechain_reset(KSYAudioSidechain* sc);
@@ -0,0 +1,172 @@
+//
+//  KSYAudioSidechain.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioSidechain.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define SC_ENV_MS  10.0   // 包络(均方值)的平滑时间
+#define SC_BLK_MS  1      // 每隔1ms判定一次是否有人声
+
+struct _KSYAudioSidechain {
+    int         rate;
+    int         blkLen;
+    // 参数换算后的值
+    KSYDuckParam param;
+    double      envCoef;
+    double      atkCoef;
+    double      relCoef;
+    double      thrPow;
+    double      depth;
+    int         holdFrames;
+    // 状态
+    double      env;
+    double      gain;
+    int         blkPos;
+    int         holdLeft;
+    // 最近一次的增益曲线
+    float *     curve;
+    int         curveLen;
+    int         curveCap;
+    BOOL        bUnity;   // 曲线全部为1, 应用时跳过
+};
+
+static double timeCoef(double ms, int rate) {
+    return ms > 0 ? 1.0 - exp(-1000.0 / (ms * rate)) : 1.0;
+}
+
+KSYAudioSidechain* ksy_sidechain_create(int rate) {
+    if (rate <= 0) {
+        return NULL;
+    }
+    KSYAudioSidechain* sc = calloc(1, sizeof(KSYAudioSidechain));
+    if (sc == NULL) {
+        return NULL;
+    }
+    sc->rate    = rate;
+    sc->blkLen  = rate * SC_BLK_MS / 1000;
+    sc->blkLen  = sc->blkLen > 0 ? sc->blkLen : 1;
+    sc->envCoef = timeCoef(SC_ENV_MS, rate);
+    KSYDuckParam def = { 10.0f, 400.0f, 300.0f, -12.0f, -36.0f };
+    ksy_sidechain_set_param(sc, &def);
+    ksy_sidechain_reset(sc);
+    return sc;
+}
+
+void ksy_sidechain_destroy(KSYAudioSidechain* sc) {
+    if (sc) {
+        free(sc->curve);
+        free(sc);
+    }
+}
+
+void ksy_sidechain_set_param(KSYAudioSidechain* sc, const KSYDuckParam* param) {
+    if (sc == NULL || param == NULL ||
+        memcmp(&sc->param, param, sizeof(KSYDuckParam)) == 0) {
+        return;
+    }
+    sc->param      = *param;
+    sc->atkCoef    = timeCoef(param->attackMs, sc->rate);
+    sc->relCoef    = timeCoef(param->releaseMs, sc->rate);
+    sc->holdFrames = (int)(param->holdMs * sc->rate / 1000.0f);
+    sc->thrPow     = pow(10.0, param->thresholdDb / 10.0);
+    sc->depth      = pow(10.0, (param->depthDb < 0 ? param->depthDb : 0) / 20.0);
+}
+
+void ksy_sidechain_reset(KSYAudioSidechain* sc) {
+    if (sc == NULL) {
+        return;
+    }
+    sc->env      = 0;
+    sc->gain     = 1.0;
+    sc->blkPos   = 0;
+    sc->holdLeft = 0;
+    sc->curveLen = 0;
+    sc->bUnity   = YES;
+}
+
+int ksy_sidechain_analyze_s16(KSYAudioSidechain* sc, const int16_t* pcm,
+                              int nbFrame, int chCnt) {
+    if (sc == NULL || pcm == NULL || nbFrame <= 0 || chCnt <= 0) {
+        return 0;
+    }
+    if (nbFrame > sc->curveCap) {
+        float * p = realloc(sc->curve, sizeof(float) * nbFrame);
+        if (p == NULL) {
+            return 0;
+        }
+        sc->curve    = p;
+        sc->curveCap = nbFrame;
+    }
+    const double sc2 = 1.0 / (32768.0 * 32768.0 * chCnt);
+    BOOL bUnity = YES;
+    for (int i = 0; i < nbFrame; ++i) {
+        const int16_t * x = pcm + i*chCnt;
+        double p = 0;
+        for (int c = 0; c < chCnt; ++c) {
+            p += (double)x[c] * x[c];
+        }
+        sc->env += (p * sc2 - sc->env) * sc->envCoef;
+        if (++sc->blkPos >= sc->blkLen) {
+            sc->blkPos = 0;
+            if (sc->env > sc->thrPow) {
+                sc->holdLeft = sc->holdFrames + sc->blkLen;
+            }
+            else if (sc->holdLeft > 0) {
+                sc->holdLeft -= sc->blkLen;
+            }
+        }
+        double target = sc->holdLeft > 0 ? sc->depth : 1.0;
+        if (sc->gain != target) {
+            double coef = target < sc->gain ? sc->atkCoef : sc->relCoef;
+            sc->gain += (target - sc->gain) * coef;
+            if (fabs(target - sc->gain) < 1e-5) {
+                sc->gain = target;
+            }
+        }
+        sc->curve[i] = (float)sc->gain;
+        bUnity = bUnity && sc->gain == 1.0;
+    }
+    sc->curveLen = nbFrame;
+    sc->bUnity   = bUnity;
+    return nbFrame;
+}
+
+void ksy_sidechain_apply_s16(const KSYAudioSidechain* sc, int16_t* pcm,
+                             int nbFrame, int chCnt) {
+    if (sc == NULL || pcm == NULL || nbFrame <= 0 || chCnt <= 0 ||
+        sc->curveLen <= 0 || sc->bUnity) {
+        return;
+    }
+    // 按时长对齐: 第i帧对应曲线上的 i*curveLen/nbFrame
+    int64_t step = ((int64_t)sc->curveLen << 16) / nbFrame;
+    int64_t pos  = 0;
+    for (int i = 0; i < nbFrame; ++i, pos += step) {
+        float     g = sc->curve[pos >> 16];
+        int16_t * x = pcm + i*chCnt;
+        for (int c = 0; c < chCnt; ++c) {
+            x[c] = (int16_t)lrintf(x[c] * g);
+        }
+    }
+}
+
+const float* ksy_sidechain_curve(const KSYAudioSidechain* sc, int* len) {
+    if (len) {
+        *len = sc ? sc->curveLen : 0;
+    }
+    return sc ? sc->curve : NULL;
+}
+
+float ksy_sidechain_gain_db(const KSYAudioSidechain* sc) {
+    return sc ? (float)(20.0 * log10(sc->gain)) : 0.0f;
+}
+
+BOOL ksy_sidechain_active(const KSYAudioSidechain* sc) {
+    return sc ? sc->holdLeft > 0 : NO;
+}
@@ -0,0 +1,76 @@
+//
+//  KSYAudioTimeStretch.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** 变速/变调 (WSOLA时间伸缩 + 重采样)
+
+ 1. 变速不变调: WSOLA, 每段40ms, 在15ms的范围内用互相关 (ksy_xcorr_f32, SIMD) 找到与上一段结尾
+    最相似的位置, 8ms交叉淡化后拼接
+ 2. 变调不变速: 先按音高比例重采样 (KSYAudioResampler), 再用WSOLA伸缩回原来的时长;
+    重采样的滤波器按半音在创建时预先计算, 改变音高时处理线程不计算系数
+ 3. 拉取方式: 需要输入时调用读取回调, 输出的帧数等于请求的帧数 (输入不足时除外), 输出连续
+ 4. 参数可以在任意线程随时修改, 在下一段(最长40ms)生效
+ 5. 速度为1且不变调时直通, 不增加延迟和CPU; 一旦开始处理, 直到 reset 之前都保持处理, 避免切换时不连续
+ 6. 数据为float交织格式
+ */
+typedef struct _KSYAudioTimeStretch KSYAudioTimeStretch;
+
+/**
+ @abstract  读取输入的回调
+ @return    读到的帧数, 小于 nbFrame 时本次处理结束
+ */
+typedef int (*KSYStretchReadFn)(void* ctx, float* buf, int nbFrame);
+
+/**
+ @abstract  创建
+ @param     rate  采样率
+ @param     chCnt 声道数 (1~8)
+ @return    参数错误时返回NULL
+ */
+KSYAudioTimeStretch* ksy_stretch_create(int rate, int chCnt);
+
+void ksy_stretch_destroy(KSYAudioTimeStretch* st);
+
+/**
+ @abstract  设置速度 (0.5~2.0, 1.0为原速; 任意线程)
+ */
+void ksy_stretch_set_tempo(KSYAudioTimeStretch* st, float tempo);
+float ksy_stretch_get_tempo(const KSYAudioTimeStretch* st);
+
+/**
+ @abstract  设置音高 (半音, -12~12, 0为原调; 任意线程)
+ */
+void ksy_stretch_set_pitch(KSYAudioTimeStretch* st, float semitone);
+float ksy_stretch_get_pitch(const KSYAudioTimeStretch* st);
+
+/**
+ @abstract  是否正在处理 (NO 表示直通)
+ */
+BOOL ksy_stretch_is_active(const KSYAudioTimeStretch* st);
+
+/**
+ @abstract  输出处理后的数据 (处理线程)
+ @param     read 读取输入的回调
+ @param     ctx  回调的参数
+ @param     out  输出buffer
+ @param     nbFrame 输出的帧数
+ @return    输出的帧数, 输入不足时小于 nbFrame
+ */
+int ksy_stretch_process(KSYAudioTimeStretch* st, KSYStretchReadFn read, void* ctx,
+                        float* out, int nbFrame);
+
+/**
+ @abstract  已读入但还未输出的输入帧数 (处理线程)
+ */
+int ksy_stretch_buffered(const KSYAudioTimeStretch* st);
+
+/**
+ @abstract  清空缓存的数据, 回到直通 (处理线程, 如定位之后)
+ */
+void ksy_stretch_reset(KSYAudioTimeStretch* st);
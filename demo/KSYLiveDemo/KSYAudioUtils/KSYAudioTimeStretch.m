@@ -0,0 +1,354 @@
+//
+//  KSYAudioTimeStretch.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioTimeStretch.h"
+#import "KSYAudioKernel.h"
+#import "KSYAudioResampler.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define ST_SEQ_MS       40      // 每段的长度
+#define ST_SEEK_MS      15      // 寻找拼接位置的范围
+#define ST_OVL_MS       8       // 交叉淡化的长度
+#define ST_RAW_CHUNK    1024    // 每次读取输入的最大帧数
+#define ST_HIST         64      // 直通时保留的输入, 开始处理时用来预热重采样器 (不小于滤波器阶数)
+#define ST_MAX_CH       8
+#define ST_MIN_TEMPO    0.5f
+#define ST_MAX_TEMPO    2.0f
+#define ST_MAX_SEMI     12.0f
+
+struct _KSYAudioTimeStretch {
+    int                 rate;
+    int                 chCnt;
+    int                 seq;
+    int                 seek;
+    int                 ovl;
+    _Atomic float       tempo;
+    _Atomic float       semi;
+    // 处理线程使用
+    BOOL                bActive;
+    float               curSemi;    // 重采样器当前的音高
+    float               curRatio;   // 2^(curSemi/12)
+    int                 discard;    // 预热重采样器时, 还需丢弃的输出帧数
+    KSYAudioResampler * rs;
+    float *             raw;        // 读取的输入
+    float *             hist;       // 直通时最近的输入
+    int                 histLen;
+    float *             in;         // 重采样后, WSOLA的输入
+    int                 inLen;
+    int                 inCap;
+    double              posFrac;    // 下一段位置的小数部分
+    float *             tail;       // 上一段之后的 ovl 帧, 用于交叉淡化
+    float *             tailMono;
+    BOOL                bTail;
+    float *             mono;       // 搜索范围内的单声道数据
+    float *             corr;
+    float *             out;        // 一段的输出
+    int                 outLen;
+    int                 outOff;
+};
+
+static float clampf(float v, float lo, float hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+KSYAudioTimeStretch* ksy_stretch_create(int rate, int chCnt) {
+    if (rate < 8000 || chCnt <= 0 || chCnt > ST_MAX_CH) {
+        return NULL;
+    }
+    KSYAudioTimeStretch * st = calloc(1, sizeof(KSYAudioTimeStretch));
+    if (st == NULL) {
+        return NULL;
+    }
+    st->rate  = rate;
+    st->chCnt = chCnt;
+    st->seq   = rate * ST_SEQ_MS  / 1000;
+    st->seek  = rate * ST_SEEK_MS / 1000;
+    st->ovl   = rate * ST_OVL_MS  / 1000;
+    // 最多需要: 一段加搜索范围, 或最快速度时一段消耗的输入, 再加一次读取的重采样输出
+    int maxSkip = (int)ceil((st->seq - st->ovl) * ST_MAX_TEMPO * 2.0) + 1;
+    int need    = st->seek + st->seq > maxSkip ? st->seek + st->seq : maxSkip;
+    st->inCap   = need + ST_RAW_CHUNK * 2 + ST_HIST + 64;
+    st->rs       = ksy_resampler_create(rate, rate, chCnt, KSYResampleQuality_Medium);
+    st->raw      = malloc(sizeof(float) * ST_RAW_CHUNK * chCnt);
+    st->hist     = malloc(sizeof(float) * ST_HIST * chCnt);
+    st->in       = malloc(sizeof(float) * st->inCap * chCnt);
+    st->tail     = malloc(sizeof(float) * st->ovl * chCnt);
+    st->tailMono = malloc(sizeof(float) * st->ovl);
+    st->mono     = malloc(sizeof(float) * (st->seek + st->ovl));
+    st->corr     = malloc(sizeof(float) * st->seek);
+    st->out      = malloc(sizeof(float) * st->seq * chCnt);
+    // 每个半音一组滤波器, 处理线程改变音高时只切换系数
+    BOOL bBank   = ksy_resampler_prepare_rates(st->rs, pow(2.0, ST_MAX_SEMI / 12.0),
+                                               (int)ST_MAX_SEMI + 1);
+    if (!bBank || st->rs == NULL || st->raw == NULL || st->hist == NULL || st->in == NULL ||
+        st->tail == NULL || st->tailMono == NULL || st->mono == NULL ||
+        st->corr == NULL || st->out == NULL) {
+        ksy_stretch_destroy(st);
+        return NULL;
+    }
+    atomic_init(&st->tempo, 1.0f);
+    atomic_init(&st->semi, 0.0f);
+    ksy_stretch_reset(st);
+    return st;
+}
+
+void ksy_stretch_destroy(KSYAudioTimeStretch* st) {
+    if (st == NULL) {
+        return;
+    }
+    ksy_resampler_destroy(st->rs);
+    free(st->raw);
+    free(st->hist);
+    free(st->in);
+    free(st->tail);
+    free(st->tailMono);
+    free(st->mono);
+    free(st->corr);
+    free(st->out);
+    free(st);
+}
+
+void ksy_stretch_set_tempo(KSYAudioTimeStretch* st, float tempo) {
+    if (st && tempo == tempo) {
+        atomic_store_explicit(&st->tempo, clampf(tempo, ST_MIN_TEMPO, ST_MAX_TEMPO),
+                              memory_order_relaxed);
+    }
+}
+
+float ksy_stretch_get_tempo(const KSYAudioTimeStretch* st) {
+    KSYAudioTimeStretch * s = (KSYAudioTimeStretch*)st;
+    return s ? atomic_load_explicit(&s->tempo, memory_order_relaxed) : 1.0f;
+}
+
+void ksy_stretch_set_pitch(KSYAudioTimeStretch* st, float semitone) {
+    if (st && semitone == semitone) {
+        atomic_store_explicit(&st->semi, clampf(semitone, -ST_MAX_SEMI, ST_MAX_SEMI),
+                              memory_order_relaxed);
+    }
+}
+
+float ksy_stretch_get_pitch(const KSYAudioTimeStretch* st) {
+    KSYAudioTimeStretch * s = (KSYAudioTimeStretch*)st;
+    return s ? atomic_load_explicit(&s->semi, memory_order_relaxed) : 0.0f;
+}
+
+BOOL ksy_stretch_is_active(const KSYAudioTimeStretch* st) {
+    return st ? st->bActive : NO;
+}
+
+int ksy_stretch_buffered(const KSYAudioTimeStretch* st) {
+    if (st == NULL || !st->bActive) {
+        return 0;
+    }
+    float tempo = ksy_stretch_get_tempo(st);
+    return (int)(st->inLen * st->curRatio + (st->outLen - st->outOff) * tempo + st->ovl);
+}
+
+void ksy_stretch_reset(KSYAudioTimeStretch* st) {
+    if (st == NULL) {
+        return;
+    }
+    st->bActive  = NO;
+    st->histLen  = 0;
+    st->inLen    = 0;
+    st->outLen   = 0;
+    st->outOff   = 0;
+    st->bTail    = NO;
+    st->posFrac  = 0;
+    st->discard  = 0;
+    st->curSemi  = 0;
+    st->curRatio = 1.0f;
+}
+
+#pragma mark - internal
+// 直通时保留最近的 ST_HIST 帧
+static void keepHist(KSYAudioTimeStretch* st, const float* pcm, int n) {
+    int ch = st->chCnt;
+    if (n >= ST_HIST) {
+        memcpy(st->hist, pcm + (size_t)(n - ST_HIST) * ch, sizeof(float) * ST_HIST * ch);
+        st->histLen = ST_HIST;
+        return;
+    }
+    int keep = st->histLen + n > ST_HIST ? ST_HIST - n : st->histLen;
+    memmove(st->hist, st->hist + (size_t)(st->histLen - keep) * ch, sizeof(float) * keep * ch);
+    memcpy(st->hist + (size_t)keep * ch, pcm, sizeof(float) * n * ch);
+    st->histLen = keep + n;
+}
+
+// 重采样后放入WSOLA的输入, 丢弃预热产生的输出
+static void feed(KSYAudioTimeStretch* st, const float* pcm, int n) {
+    int ch = st->chCnt;
+    float * dst = st->in + (size_t)st->inLen * ch;
+    int m = ksy_resampler_process(st->rs, pcm, n, dst, st->inCap - st->inLen);
+    if (st->discard > 0) {
+        int d = st->discard < m ? st->discard : m;
+        memmove(dst, dst + (size_t)d * ch, sizeof(float) * (m - d) * ch);
+        st->discard -= d;
+        m -= d;
+    }
+    st->inLen += m;
+}
+
+// 从直通切换到处理: 用最近的输入预热重采样器 (1:1时输出与输入逐帧对应), 再丢弃这些输出
+static void activate(KSYAudioTimeStretch* st) {
+    ksy_resampler_reset(st->rs);
+    ksy_resampler_set_rates(st->rs, st->rate, st->rate);
+    st->curSemi  = 0;
+    st->curRatio = 1.0f;
+    st->inLen    = 0;
+    st->outLen   = 0;
+    st->outOff   = 0;
+    st->bTail    = NO;
+    st->posFrac  = 0;
+    st->discard  = st->histLen;
+    st->bActive  = YES;
+    if (st->histLen > 0) {
+        feed(st, st->hist, st->histLen);
+    }
+}
+
+static void toMono(const float* pcm, int ch, int n, float* mono) {
+    if (ch == 1) {
+        memcpy(mono, pcm, sizeof(float) * n);
+        return;
+    }
+    float k = 1.0f / ch;
+    for (int i = 0; i < n; ++i) {
+        float s = 0.0f;
+        for (int c = 0; c < ch; ++c) {
+            s += pcm[i*ch + c];
+        }
+        mono[i] = s * k;
+    }
+}
+
+// 在 [0, seek) 中找与 tail 归一化互相关最大的位置
+static int bestOffset(KSYAudioTimeStretch* st) {
+    int seek = st->seek, ovl = st->ovl;
+    toMono(st->in, st->chCnt, seek + ovl - 1, st->mono);
+    ksy_xcorr_f32(st->tailMono, st->mono, ovl, seek, st->corr);
+    const float * m = st->mono;
+    double e = 0.0;
+    for (int i = 0; i < ovl; ++i) {
+        e += m[i] * m[i];
+    }
+    int    best  = 0;
+    double score = -1e30;
+    for (int k = 0; k < seek; ++k) {
+        double s = st->corr[k] / sqrt(e + 1e-9);
+        if (s > score) {
+            score = s;
+            best  = k;
+        }
+        if (k + 1 < seek) { // 滑动窗口的能量
+            e += (double)m[k + ovl] * m[k + ovl] - (double)m[k] * m[k];
+            e  = e > 0.0 ? e : 0.0;
+        }
+    }
+    return best;
+}
+
+// 输出一段 (seq-ovl 帧), 消耗 skip 帧输入
+static void wsolaStep(KSYAudioTimeStretch* st, double skip) {
+    int ch = st->chCnt, seq = st->seq, ovl = st->ovl;
+    int k = 0;
+    float * out = st->out;
+    if (st->bTail) {
+        k = bestOffset(st);
+        const float * src = st->in + (size_t)k * ch;
+        for (int i = 0; i < ovl; ++i) {
+            float w = (i + 0.5f) / ovl;
+            for (int c = 0; c < ch; ++c) {
+                out[i*ch + c] = st->tail[i*ch + c] + (src[i*ch + c] - st->tail[i*ch + c]) * w;
+            }
+        }
+        memcpy(out + (size_t)ovl * ch, src + (size_t)ovl * ch, sizeof(float) * (seq - 2*ovl) * ch);
+    }
+    else {
+        memcpy(out, st->in, sizeof(float) * (seq - ovl) * ch);
+    }
+    const float * next = st->in + (size_t)(k + seq - ovl) * ch;
+    memcpy(st->tail, next, sizeof(float) * ovl * ch);
+    toMono(next, ch, ovl, st->tailMono);
+    st->bTail  = YES;
+    st->outLen = seq - ovl;
+    st->outOff = 0;
+    // 按标称速度前进, 偏移只影响本段从哪里取, 长期的速度不变
+    st->posFrac += skip;
+    int n = (int)st->posFrac;
+    st->posFrac -= n;
+    memmove(st->in, st->in + (size_t)n * ch, sizeof(float) * (st->inLen - n) * ch);
+    st->inLen -= n;
+}
+
+#pragma mark - process
+int ksy_stretch_process(KSYAudioTimeStretch* st, KSYStretchReadFn read, void* ctx,
+                        float* out, int nbFrame) {
+    if (st == NULL || read == NULL || out == NULL || nbFrame <= 0) {
+        return 0;
+    }
+    int  ch   = st->chCnt;
+    int  got  = 0;
+    BOOL bDry = NO;
+    while (got < nbFrame) {
+        if (st->outOff < st->outLen) {
+            int n = st->outLen - st->outOff;
+            n = n < nbFrame - got ? n : nbFrame - got;
+            memcpy(out + (size_t)got * ch, st->out + (size_t)st->outOff * ch,
+                   sizeof(float) * n * ch);
+            st->outOff += n;
+            got        += n;
+            continue;
+        }
+        float tempo = atomic_load_explicit(&st->tempo, memory_order_relaxed);
+        float semi  = atomic_load_explicit(&st->semi, memory_order_relaxed);
+        if (!st->bActive) {
+            if (tempo == 1.0f && semi == 0.0f) { // 直通
+                int want = nbFrame - got;
+                int n    = read(ctx, out + (size_t)got * ch, want);
+                if (n > 0) {
+                    keepHist(st, out + (size_t)got * ch, n);
+                    got += n;
+                }
+                if (n < want) {
+                    break;
+                }
+                continue;
+            }
+            activate(st);
+        }
+        if (st->discard == 0 && semi != st->curSemi) { // 预热完成后再改变音高, 不重新计算系数
+            st->curSemi  = semi;
+            st->curRatio = powf(2.0f, semi / 12.0f);
+            ksy_resampler_set_rates(st->rs, (int)lrintf(st->rate * st->curRatio), st->rate);
+        }
+        double skip = (st->seq - st->ovl) * (double)tempo / st->curRatio;
+        int    need = (int)(st->posFrac + skip);
+        need = need > st->seek + st->seq ? need : st->seek + st->seq;
+        while (st->inLen < need && !bDry) {
+            int want = (int)ceilf((need - st->inLen + st->discard) * st->curRatio) + 8;
+            want = want < ST_RAW_CHUNK ? want : ST_RAW_CHUNK;
+            while (want > 1 && ksy_resampler_max_out(st->rs, want) > st->inCap - st->inLen) {
+                want /= 2;
+            }
+            int n = read(ctx, st->raw, want);
+            if (n > 0) {
+                feed(st, st->raw, n);
+            }
+            bDry = n < want; // 本次不再读取, 避免重复计为欠载
+        }
+        if (st->inLen < need) {
+            break;
+        }
+        wsolaStep(st, skip);
+    }
+    return got;
+}
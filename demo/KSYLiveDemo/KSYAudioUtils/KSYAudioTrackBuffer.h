@@ -0,0 +1,163 @@
+//
+//  KSYAudioTrackBuffer.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <CoreMedia/CoreMedia.h>
+#import "KSYAudioOutputStage.h"
+#import "KSYAudioDucker.h"
+#import "KSYAudioEffectChain.h"
+#import "KSYAudioRing.h"
+#import "KSYAudioResampler.h"
+#if USING_DYNAMIC_FRAMEWORK
+#import <libksygpulivedylib/KSYAudioMixer.h>
+#else
+#import <libksygpulive/KSYAudioMixer.h>
+#endif
+
+/**
+ @abstract  混音器 processAudioData: 的长度参数是否以字节为单位, 默认为1 (以字节为单位)
+ @discussion 按 KSYAudioMixer.h 的文档 ("数据的长度，单位为字节") 传入字节数;
+             该单位尚未在设备上验证, 如果设备上确认为帧数, 定义为0即可;
+             demo 中所有非主轨的输入都经过 ksy_mixer_feed_s16, 只需要修改这一处
+ */
+#ifndef KSY_MIXER_LEN_IN_BYTES
+#define KSY_MIXER_LEN_IN_BYTES  1
+#endif
+
+/**
+ @abstract  把S16交织的数据送入混音器的一个track (主轨线程)
+ @param     pcm     数据, 格式为 fmt (即混音器的输出格式)
+ @param     nbFrame 帧数
+ @discussion KSYAudioTrackBuffer / KSYAudioEffectPool / KSYAudioBgmStream 共用
+ */
+BOOL ksy_mixer_feed_s16(KSYAudioMixer* mixer, int trackId, int16_t* pcm, int nbFrame,
+                        KSYAudioFormat* fmt, CMTime pts);
+
+/** 混音器非主轨输入的缓冲
+
+ 1. 生产者线程(背景音乐/播放器的回调)调用 processAudioSampleBuffer:
+    数据转换为混音器的输出格式后存入无锁环形缓冲, 不会阻塞在混音器内部的锁上
+ 2. 主轨线程(麦克风回调)在送入主轨数据之前调用 feedMixer:
+    按主轨数据的时长从缓冲中取出数据送入混音器
+ 3. 混音器内部各路的buffer因此只在主轨线程上读写, 长度保持在一次输出左右
+ 4. 采样格式/声道映射/声像在入队前一次转换完成, 混音器内部不再对该路做格式转换
+ 5. 采样率与混音器输出不一致的数据, 在入队前用多相滤波器重采样, 各路的滤波器状态独立
+ 6. 设置 targetMs 后, 根据时间戳和缓冲长度估计与主轨的时钟漂移, 微调重采样比例,
+    使缓冲长度稳定在目标值附近, 不会周期性地堆积丢弃或欠载补零
+ */
+@interface KSYAudioTrackBuffer : NSObject
+
+/**
+ @abstract  初始化
+ @param     mixer    数据送往的混音器
+ @param     trackId  混音器中对应的track
+ @param     ms       缓冲的容量 (毫秒)
+ */
+- (instancetype) initWithMixer:(KSYAudioMixer*)mixer
+                         track:(int)trackId
+                      bufferMs:(int)ms;
+
+/**
+ @abstract  对应混音器中的track
+ */
+@property (nonatomic, readonly) int trackId;
+
+/**
+ @abstract  缓冲中数据的格式 (即混音器的输出格式)
+ */
+@property (nonatomic, readonly) KSYAudioFormat outFmt;
+
+/**
+ @abstract  声像 (-1.0 全左 ~ 0 居中 ~ 1.0 全右), 默认为0
+ @discussion 仅在输出为双声道时生效, 可以在任意线程设置
+ */
+@property (atomic, assign) float pan;
+
+/**
+ @abstract  重采样的质量, 默认为 KSYResampleQuality_Medium
+ @discussion 仅在输入采样率与输出不一致时使用, 可以在任意线程设置
+ */
+@property (atomic, assign) KSYResampleQuality quality;
+
+/**
+ @abstract  时钟漂移补偿的目标缓冲长度 (毫秒), 默认为0(不补偿)
+ @discussion 请在开始输入数据之前设置; 开启后即使采样率相同也会经过重采样
+ @discussion 缓冲达到目标长度之后才开始向混音器送数据, 即该路会有 targetMs 的延迟
+ */
+@property (nonatomic, assign) int targetMs;
+
+/**
+ @abstract  当前的漂移补偿比例 (>1 表示该路的时钟偏快), 任意线程
+ */
+@property (nonatomic, readonly) double driftRatio;
+
+/**
+ @abstract  设置声道映射 (任意线程)
+ @param     chMap 输出的第i个声道取输入的第chMap[i]个声道, -1 表示静音
+ @param     cnt   chMap 的长度, 应与输出声道数相同; 为0时恢复默认映射
+ @discussion 默认映射: 声道数相同时一一对应, 输出单声道时取各声道平均
+ */
+- (void) setChannelMap:(const int*)chMap
+                 count:(int)cnt;
+
+/**
+ @abstract  输入音频数据 (生产者线程)
+ @param     sampleBuffer 音频数据, 支持S16或float, 交织或平面格式
+ @return    NO 表示数据格式不支持或缓冲已满, 部分数据被丢弃
+ */
+- (BOOL) processAudioSampleBuffer:(CMSampleBufferRef)sampleBuffer;
+
+/**
+ @abstract  输入音频PCM (生产者线程)
+ @param     pData 原始数据, 平面格式时为各声道的指针
+ @param     len   帧数
+ @param     fmt   原始数据的格式, 支持 S16/S16P/FLT/FLTP
+ @param     pts   原始数据的时间戳, 用于估计时钟漂移, 可以为 kCMTimeInvalid
+ @return    NO 表示数据格式不支持或缓冲已满
+ @discussion 与 KSYAudioMixer 的同名接口用法相同, 可以直接送入合成的PCM进行测试
+ */
+- (BOOL) processAudioData:(uint8_t**)pData
+                 nbSample:(int)len
+               withFormat:(KSYAudioFormat*)fmt
+                 timeinfo:(CMTime)pts;
+
+/**
+ @abstract  从缓冲中取出数据送入混音器 (主轨线程)
+ @param     mainBuf 即将送入混音器的主轨数据, 用于计算需要的长度和时间戳
+ @return    送入混音器的帧数
+ */
+- (int) feedMixer:(CMSampleBufferRef)mainBuf;
+
+/**
+ @abstract  丢弃缓冲中的数据 (主轨线程)
+ */
+- (void) flush;
+
+/**
+ @abstract  效果链, 不为nil时送入混音器之前原地处理该路数据 (可以为nil, 任意线程设置)
+ @discussion 在闪避和电平统计之前处理, 数据格式为混音器的输出格式
+ */
+@property (nonatomic, weak) KSYAudioEffectChain * effectChain;
+
+/**
+ @abstract  闪避, 不为nil时按主轨的人声压低该路 (可以为nil, 任意线程设置)
+ @discussion 主轨线程需要先调用 ducker 的 processMainTrack: 再调用 feedMixer:
+ */
+@property (nonatomic, weak) KSYAudioDucker * ducker;
+
+/**
+ @abstract  电平统计, 送入混音器的数据同时按 trackId 送给它统计 (可以为nil)
+ */
+@property (nonatomic, weak) KSYAudioOutputStage * outputStage;
+
+/**
+ @abstract  缓冲的统计信息: 当前长度/最大长度/欠载次数等 (任意线程)
+ */
+@property (nonatomic, readonly) KSYAudioRingStat stat;
+
+@end
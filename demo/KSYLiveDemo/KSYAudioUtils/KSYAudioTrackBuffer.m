@@ -0,0 +1,373 @@
+//
+//  KSYAudioTrackBuffer.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioTrackBuffer.h"
+#import "KSYAudioConvert.h"
+#import "KSYAudioResampler.h"
+#import "KSYAudioDrift.h"
+#include <stdatomic.h>
+
+@interface KSYAudioTrackBuffer () {
+    KSYAudioRing *  _ring;
+    // 声道映射和声像, 由 @synchronized(self) 保护
+    int             _chMap[KSY_AUDIO_MAX_CH];
+    int             _chMapCnt;
+    float           _pan;
+    atomic_int      _matDirty;
+    // 生产者线程使用
+    float           _mat[KSY_AUDIO_MAX_CH*KSY_AUDIO_MAX_CH];
+    int             _matSrcCh; // _mat 对应的输入声道数
+    int16_t *       _cvtBuf;
+    int             _cvtCap;   // 帧
+    // 采样率与输出不同时的重采样
+    KSYAudioResampler * _resampler;
+    int             _rsInRate;
+    int             _rsQuality;
+    atomic_int      _quality;
+    float *         _fltBuf;   // 转换后待重采样的数据
+    int             _fltCap;
+    float *         _rsBuf;    // 重采样的输出
+    int             _rsCap;
+    // 时钟漂移补偿, 为NULL时不补偿
+    KSYAudioDrift * _drift;
+    int             _targetFrames;
+    BOOL            _bPriming; // 主轨线程: 等待缓冲达到目标长度
+    // 主轨线程使用
+    int16_t *       _readBuf;
+    int             _readCap;  // 帧
+}
+@property (nonatomic, weak) KSYAudioMixer * mixer;
+@end
+
+BOOL ksy_mixer_feed_s16(KSYAudioMixer* mixer, int trackId, int16_t* pcm, int nbFrame,
+                        KSYAudioFormat* fmt, CMTime pts) {
+    if (mixer == nil || pcm == NULL || nbFrame <= 0) {
+        return NO;
+    }
+    uint8_t * pData[1] = { (uint8_t*)pcm };
+#if KSY_MIXER_LEN_IN_BYTES
+    int len = nbFrame * fmt->chCnt * (int)sizeof(int16_t);
+#else
+    int len = nbFrame;
+#endif
+    return [mixer processAudioData:pData
+                          nbSample:len
+                        withFormat:fmt
+                          timeinfo:pts
+                                of:trackId];
+}
+
+@implementation KSYAudioTrackBuffer
+
+- (instancetype) initWithMixer:(KSYAudioMixer*)mixer
+                         track:(int)trackId
+                      bufferMs:(int)ms {
+    self = [super init];
+    if (self == nil || mixer == nil) {
+        return nil;
+    }
+    _mixer   = mixer;
+    _trackId = trackId;
+    _outFmt  = mixer.outFmt;
+    if (_outFmt.sampleRate <= 0 || _outFmt.chCnt <= 0) {
+        // 混音器的输出固定为 44.1KHz, 单声道, S16
+        _outFmt.sampleFmt  = KSYSampleFmt_S16;
+        _outFmt.sampleSize = 2;
+        _outFmt.chCnt      = 1;
+        _outFmt.chLayout   = 0x4; // AV_CH_LAYOUT_MONO
+        _outFmt.sampleRate = 44100;
+    }
+    if (_outFmt.sampleFmt != KSYSampleFmt_S16 ||
+        _outFmt.chCnt > KSY_AUDIO_MAX_CH) {
+        return nil;
+    }
+    int nbFrame = (int)((int64_t)_outFmt.sampleRate * ms / 1000);
+    _ring = ksy_ring_create(nbFrame, sizeof(int16_t)*_outFmt.chCnt);
+    if (_ring == NULL) {
+        return nil;
+    }
+    atomic_init(&_matDirty, 1);
+    atomic_init(&_quality, KSYResampleQuality_Medium);
+    return self;
+}
+
+- (void) dealloc {
+    ksy_ring_destroy(_ring);
+    ksy_resampler_destroy(_resampler);
+    ksy_drift_destroy(_drift);
+    free(_fltBuf);
+    free(_rsBuf);
+    free(_cvtBuf);
+    free(_readBuf);
+}
+
+static BOOL growBuf(void * buf, int * cap, int nbFrame, size_t frameSize) {
+    if (nbFrame <= *cap) {
+        return YES;
+    }
+    void * p = realloc(*(void**)buf, frameSize * nbFrame);
+    if (p == NULL) {
+        return NO;
+    }
+    *(void**)buf = p;
+    *cap = nbFrame;
+    return YES;
+}
+
+#pragma mark - channel map / pan
+- (float) pan {
+    @synchronized (self) {
+        return _pan;
+    }
+}
+
+- (void) setPan:(float)pan {
+    @synchronized (self) {
+        _pan = pan;
+    }
+    atomic_store(&_matDirty, 1);
+}
+
+- (void) setChannelMap:(const int*)chMap
+                 count:(int)cnt {
+    @synchronized (self) {
+        _chMapCnt = 0;
+        if (chMap && cnt == _outFmt.chCnt) {
+            memcpy(_chMap, chMap, sizeof(int)*cnt);
+            _chMapCnt = cnt;
+        }
+    }
+    atomic_store(&_matDirty, 1);
+}
+
+// 生产者线程: 输入声道数或设置变化时重新生成转换矩阵
+- (void) updateMatrix:(int)srcCh {
+    if (srcCh == _matSrcCh && atomic_load(&_matDirty) == 0) {
+        return;
+    }
+    atomic_store(&_matDirty, 0);
+    @synchronized (self) {
+        ksy_audio_channel_matrix(_mat, _outFmt.chCnt, srcCh,
+                                 _chMapCnt ? _chMap : NULL, _pan);
+    }
+    _matSrcCh = srcCh;
+}
+
+- (void) setTargetMs:(int)targetMs {
+    ksy_drift_destroy(_drift);
+    _drift    = NULL;
+    _targetMs = targetMs;
+    if (targetMs > 0) {
+        _targetFrames = (int)((int64_t)_outFmt.sampleRate * targetMs / 1000);
+        _drift    = ksy_drift_create(_targetFrames, _outFmt.sampleRate);
+        _bPriming = YES;
+    }
+}
+
+- (double) driftRatio {
+    return ksy_drift_ratio(_drift);
+}
+
+- (KSYResampleQuality) quality {
+    return (KSYResampleQuality)atomic_load(&_quality);
+}
+
+- (void) setQuality:(KSYResampleQuality)quality {
+    atomic_store(&_quality, quality);
+}
+
+// 生产者线程: 输入采样率或质量变化时重新创建重采样器
+- (BOOL) updateResampler:(int)inRate {
+    int quality = atomic_load(&_quality);
+    if (_resampler && inRate == _rsInRate && quality == _rsQuality) {
+        return YES;
+    }
+    ksy_resampler_destroy(_resampler);
+    _resampler = ksy_resampler_create(inRate, _outFmt.sampleRate,
+                                      _outFmt.chCnt, quality);
+    _rsInRate  = inRate;
+    _rsQuality = quality;
+    return _resampler != NULL;
+}
+
+#pragma mark - producer
+- (BOOL) processAudioSampleBuffer:(CMSampleBufferRef)sampleBuffer {
+    KSYAudioMixer * mixer = _mixer;
+    if (sampleBuffer == NULL || mixer == nil) {
+        return NO;
+    }
+    CMFormatDescriptionRef desc = CMSampleBufferGetFormatDescription(sampleBuffer);
+    const AudioStreamBasicDescription * asbd = desc ?
+        CMAudioFormatDescriptionGetStreamBasicDescription(desc) : NULL;
+    if (asbd == NULL) {
+        return NO;
+    }
+    BOOL bFloat  = (asbd->mFormatFlags & kAudioFormatFlagIsFloat) != 0;
+    BOOL bPlanar = (asbd->mFormatFlags & kAudioFormatFlagIsNonInterleaved) != 0;
+    KSYAudioFormat fmt = {0};
+    fmt.sampleFmt  = bFloat ? (bPlanar ? KSYSampleFmt_FLTP : KSYSampleFmt_FLT)
+                            : (bPlanar ? KSYSampleFmt_S16P : KSYSampleFmt_S16);
+    fmt.sampleSize = (int)asbd->mBitsPerChannel / 8;
+    fmt.chCnt      = (int)asbd->mChannelsPerFrame;
+    fmt.sampleRate = (int)asbd->mSampleRate;
+    BOOL bSupport = asbd->mFormatID == kAudioFormatLinearPCM &&
+                    fmt.sampleSize == ksy_sample_fmt_size(fmt.sampleFmt) &&
+                    fmt.chCnt > 0 && fmt.chCnt <= KSY_AUDIO_MAX_CH &&
+                    fmt.sampleRate > 0;
+    if (!bSupport) { // 不能交给混音器: 生产者线程不访问混音器
+        return NO;
+    }
+    struct {
+        AudioBufferList abl;
+        AudioBuffer     more[KSY_AUDIO_MAX_CH-1];
+    } bufList;
+    CMBlockBufferRef block = NULL;
+    OSStatus ret = CMSampleBufferGetAudioBufferListWithRetainedBlockBuffer
+    (sampleBuffer, NULL, &bufList.abl, sizeof(bufList), NULL, NULL,
+     kCMSampleBufferFlag_AudioBufferList_Assure16ByteAlignment, &block);
+    if (ret != noErr) {
+        return NO;
+    }
+    uint8_t * planes[KSY_AUDIO_MAX_CH] = {0};
+    int nbPlane = bPlanar ? fmt.chCnt : 1;
+    for (int i = 0; i < nbPlane && i < (int)bufList.abl.mNumberBuffers; ++i) {
+        planes[i] = bufList.abl.mBuffers[i].mData;
+    }
+    BOOL bOK = [self processAudioData:planes
+                             nbSample:(int)CMSampleBufferGetNumSamples(sampleBuffer)
+                           withFormat:&fmt
+                             timeinfo:CMSampleBufferGetPresentationTimeStamp(sampleBuffer)];
+    CFRelease(block);
+    return bOK;
+}
+
+- (BOOL) processAudioData:(uint8_t**)pData
+                 nbSample:(int)len
+               withFormat:(KSYAudioFormat*)fmt
+                 timeinfo:(CMTime)pts {
+    if (pData == NULL || fmt == NULL || len <= 0 ||
+        !ksy_sample_fmt_valid(fmt->sampleFmt) ||
+        fmt->chCnt <= 0 || fmt->chCnt > KSY_AUDIO_MAX_CH ||
+        fmt->sampleRate <= 0) {
+        return NO;
+    }
+    int nbPlane = ksy_sample_fmt_planar(fmt->sampleFmt) ? fmt->chCnt : 1;
+    for (int i = 0; i < nbPlane; ++i) {
+        if (pData[i] == NULL) {
+            return NO;
+        }
+    }
+    [self updateMatrix:fmt->chCnt];
+    int outCh = _outFmt.chCnt;
+    if (_drift) {
+        double ptsSec = CMTIME_IS_NUMERIC(pts) ? CMTimeGetSeconds(pts) : NAN;
+        ksy_drift_input(_drift, len, fmt->sampleRate, ptsSec);
+    }
+    if (fmt->sampleRate == _outFmt.sampleRate && _drift == NULL) {
+        if (!growBuf(&_cvtBuf, &_cvtCap, len, sizeof(int16_t)*outCh)) {
+            return NO;
+        }
+        uint8_t * dst[1] = { (uint8_t*)_cvtBuf };
+        if (ksy_audio_convert(dst, _outFmt.sampleFmt, outCh,
+                              (const uint8_t* const*)pData, fmt->sampleFmt,
+                              fmt->chCnt, _mat, len) != 0) {
+            return NO;
+        }
+        return ksy_ring_write(_ring, _cvtBuf, len) == len;
+    }
+    // 采样率不同或需要补偿漂移: 转为float并映射声道 -> 重采样 -> 转为S16
+    if (![self updateResampler:fmt->sampleRate]) {
+        return NO;
+    }
+    if (_drift) {
+        ksy_resampler_set_ratio(_resampler, ksy_drift_ratio(_drift));
+    }
+    int maxOut = ksy_resampler_max_out(_resampler, len);
+    if (!growBuf(&_fltBuf, &_fltCap, len,    sizeof(float)*outCh) ||
+        !growBuf(&_rsBuf,  &_rsCap,  maxOut, sizeof(float)*outCh) ||
+        !growBuf(&_cvtBuf, &_cvtCap, maxOut, sizeof(int16_t)*outCh)) {
+        return NO;
+    }
+    uint8_t * flt[1] = { (uint8_t*)_fltBuf };
+    if (ksy_audio_convert(flt, KSYSampleFmt_FLT, outCh,
+                          (const uint8_t* const*)pData, fmt->sampleFmt,
+                          fmt->chCnt, _mat, len) != 0) {
+        return NO;
+    }
+    int nbOut = ksy_resampler_process(_resampler, _fltBuf, len, _rsBuf, maxOut);
+    if (nbOut <= 0) {
+        return YES;
+    }
+    const uint8_t * rs[1] = { (const uint8_t*)_rsBuf };
+    uint8_t *       dst[1] = { (uint8_t*)_cvtBuf };
+    ksy_audio_convert(dst, _outFmt.sampleFmt, outCh,
+                      rs, KSYSampleFmt_FLT, outCh, NULL, nbOut);
+    return ksy_ring_write(_ring, _cvtBuf, nbOut) == nbOut;
+}
+
+#pragma mark - consumer
+- (int) feedMixer:(CMSampleBufferRef)mainBuf {
+    KSYAudioMixer * mixer = _mixer;
+    if (mainBuf == NULL || mixer == nil) {
+        return 0;
+    }
+    CMFormatDescriptionRef desc = CMSampleBufferGetFormatDescription(mainBuf);
+    const AudioStreamBasicDescription * asbd = desc ?
+        CMAudioFormatDescriptionGetStreamBasicDescription(desc) : NULL;
+    if (asbd == NULL || asbd->mSampleRate <= 0) {
+        return 0;
+    }
+    // 主轨数据的时长, 换算为混音器输出的帧数
+    int64_t nbMain = CMSampleBufferGetNumSamples(mainBuf);
+    int need = (int)((nbMain * _outFmt.sampleRate + (int64_t)asbd->mSampleRate/2)
+                     / (int64_t)asbd->mSampleRate);
+    if (need <= 0 ||
+        !growBuf(&_readBuf, &_readCap, need, sizeof(int16_t)*_outFmt.chCnt)) {
+        return 0;
+    }
+    int fill = ksy_ring_fill(_ring);
+    if (_drift && _bPriming) { // 启动或断流后, 先攒够目标长度再输出
+        if (fill < _targetFrames) {
+            return 0;
+        }
+        _bPriming = NO;
+    }
+    int n = ksy_ring_read(_ring, _readBuf, need);
+    if (_drift) {
+        ksy_drift_output(_drift, fill, need, n < need);
+        _bPriming = (n <= 0);
+    }
+    if (n <= 0) {
+        return 0;
+    }
+    [_effectChain processS16:_readBuf
+                     nbFrame:n
+                        rate:_outFmt.sampleRate
+                       chCnt:_outFmt.chCnt];
+    [_ducker applyGain:_readBuf nbFrame:n chCnt:_outFmt.chCnt];
+    [_outputStage meterTrack:_trackId data:_readBuf nbFrame:n format:&_outFmt];
+    ksy_mixer_feed_s16(mixer, _trackId, _readBuf, n, &_outFmt,
+                       CMSampleBufferGetPresentationTimeStamp(mainBuf));
+    return n;
+}
+
+- (void) flush {
+    ksy_ring_flush(_ring);
+    if (_drift) {
+        ksy_drift_reset(_drift);
+        _bPriming = YES;
+    }
+}
+
+- (KSYAudioRingStat) stat {
+    KSYAudioRingStat st = {0};
+    ksy_ring_get_stat(_ring, &st);
+    return st;
+}
+
+@end
@@ -0,0 +1,106 @@
+//
+//  KSYAudioVoicePool.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "KSYAudioPcmCache.h"
+
+/** 短音效的播放核心 (KSYAudioEffectPool 的实时部分)
+
+ 1. 音效为S16交织的PCM, 由音效表和正在播放的音效共同引用计数, 播放时只传递引用
+ 2. 控制线程 -> 主轨线程: 播放/停止命令经过无锁命令队列传递
+ 3. 主轨线程 -> 控制线程: 主轨线程释放最后一个引用时不 free/munmap,
+    经过反向队列交回控制线程, 在下一次调用控制接口 (或 collect) 时释放
+ 4. 每次只混合正在播放的音效, 耗时与同时播放的个数成正比, 与加载的个数无关
+ 5. 除 render 外的接口在同一个线程 (控制线程) 调用; render 在主轨线程调用
+ 6. 纯C实现, 可以在Linux上测试
+ */
+typedef struct _KSYVoicePool KSYVoicePool;
+
+/** 统计信息 */
+typedef struct {
+    /// 加载的音效个数 (包括已卸载的位置)
+    int     nbSample;
+    /// 正在播放的个数 (最近一次 render 时)
+    int     nbActive;
+    /// 等待控制线程释放的音效个数
+    int     nbPending;
+    /// 控制线程释放的音效个数 (累计)
+    int64_t freedCnt;
+    /// 主轨线程交回控制线程释放的个数 (累计)
+    int64_t deferredCnt;
+    /// 主轨线程直接释放的个数 (反向队列已满, 正常为0)
+    int64_t renderFreeCnt;
+    /// 超过同时播放上限而丢弃的播放命令
+    int64_t droppedCnt;
+} KSYVoicePoolStat;
+
+/**
+ @abstract  创建
+ @param     chCnt    声道数
+ @param     maxVoice 最多同时播放的音效个数
+ @return    失败时返回NULL
+ */
+KSYVoicePool* ksy_voice_pool_create(int chCnt, int maxVoice);
+
+/**
+ @abstract  销毁 (须保证两个线程都已不再调用), 释放所有音效
+ */
+void ksy_voice_pool_destroy(KSYVoicePool* pool);
+
+/**
+ @abstract  加入音效 (控制线程), 接管 pcm 或 map 的所有权
+ @param     pcm     S16交织数据, map 不为NULL时指向映射的数据
+ @param     nbFrame 帧数
+ @param     map     数据来自解码缓存时的映射, 否则为NULL (pcm 由 free 释放)
+ @return    音效的ID, 失败时返回 -1 (已释放数据)
+ */
+int ksy_voice_pool_add(KSYVoicePool* pool, int16_t* pcm, int nbFrame, KSYPcmMap* map);
+
+/**
+ @abstract  卸载音效 (控制线程), 正在播放的该音效会继续播放完
+ */
+void ksy_voice_pool_remove(KSYVoicePool* pool, int sampleId);
+
+/**
+ @abstract  播放音效 (控制线程)
+ @return    NO 表示ID无效, 或命令队列已满
+ */
+BOOL ksy_voice_pool_play(KSYVoicePool* pool, int sampleId, float vol);
+
+/**
+ @abstract  停止所有正在播放的音效 (控制线程)
+ */
+void ksy_voice_pool_stop_all(KSYVoicePool* pool);
+
+/**
+ @abstract  释放主轨线程交回的音效 (控制线程), 其他控制接口也会调用
+ */
+void ksy_voice_pool_collect(KSYVoicePool* pool);
+
+/**
+ @abstract  混合正在播放的音效 (主轨线程), 不分配和释放内存
+ @param     buf     输出 nbFrame 帧
+ @param     nbFrame 帧数, 不超过 maxFrame 时不分配内存
+ @return    NO 表示没有正在播放的音效, buf 未被写入
+ */
+BOOL ksy_voice_pool_render(KSYVoicePool* pool, int16_t* buf, int nbFrame);
+
+/**
+ @abstract  预先分配 render 需要的缓冲 (控制线程, 在开始 render 之前调用)
+ */
+BOOL ksy_voice_pool_reserve(KSYVoicePool* pool, int maxFrame);
+
+/**
+ @abstract  正在播放的个数 (任意线程)
+ */
+int ksy_voice_pool_active(const KSYVoicePool* pool);
+
+/**
+ @abstract  读取统计信息 (控制线程)
+ */
+void ksy_voice_pool_get_stat(const KSYVoicePool* pool, KSYVoicePoolStat* stat);
@@ -0,0 +1,321 @@
+//
+//  KSYAudioVoicePool.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYAudioVoicePool.h"
+#import "KSYAudioKernel.h"
+#import "KSYAudioRing.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 解码后的音效, 由音效表和正在播放的音效共同引用
+typedef struct {
+    const int16_t * pcm;
+    int             nbFrame;
+    KSYPcmMap *     map;    // 来自解码缓存时不为NULL, pcm 指向映射的数据
+    atomic_int      refCnt;
+} KSYVoiceSample;
+
+typedef enum {
+    KSYVoiceCmd_Play = 0,
+    KSYVoiceCmd_StopAll,
+} KSYVoiceCmdType;
+
+// 控制线程 -> 主轨线程的命令
+typedef struct {
+    KSYVoiceCmdType   type;
+    KSYVoiceSample *  sample;
+    float             vol;
+} KSYVoiceCmd;
+
+// 正在播放的音效
+typedef struct {
+    KSYVoiceSample *  sample;
+    int               pos;
+    float             vol;
+} KSYVoice;
+
+struct _KSYVoicePool {
+    int                 chCnt;
+    int                 maxVoice;
+    // 控制线程使用
+    KSYVoiceSample **   samples;
+    int                 nbSample;
+    int                 sampleCap;
+    int64_t             freedCnt;
+    KSYAudioRing *      cmdRing;
+    KSYAudioRing *      freeRing;   // 主轨线程 -> 控制线程: 待释放的音效
+    // 主轨线程使用
+    KSYVoice *          voices;
+    int                 nbActive;
+    const int16_t **    srcs;
+    float *             vols;
+    int16_t *           tailBuf;    // 即将结束的音效补零后的数据
+    int                 tailCap;    // 每个音效的帧数
+    atomic_int          activeOut;
+    atomic_llong        deferredCnt;
+    atomic_llong        renderFreeCnt;
+    atomic_llong        droppedCnt;
+};
+
+static void sampleFree(KSYVoiceSample* s) {
+    if (s->map) {
+        ksy_pcm_map_release(s->map);
+    }
+    else {
+        free((void*)s->pcm);
+    }
+    free(s);
+}
+
+// 控制线程释放引用
+static void sampleRelease(KSYVoicePool* pool, KSYVoiceSample* s) {
+    if (s && atomic_fetch_sub(&s->refCnt, 1) == 1) {
+        sampleFree(s);
+        pool->freedCnt += 1;
+    }
+}
+
+// 主轨线程释放引用: 最后一个引用交回控制线程释放
+static void sampleReleaseDeferred(KSYVoicePool* pool, KSYVoiceSample* s) {
+    if (s && atomic_fetch_sub(&s->refCnt, 1) == 1) {
+        if (ksy_ring_write(pool->freeRing, &s, 1) == 1) {
+            atomic_fetch_add(&pool->deferredCnt, 1);
+        }
+        else {
+            sampleFree(s); // 容量足够, 不应发生
+            atomic_fetch_add(&pool->renderFreeCnt, 1);
+        }
+    }
+}
+
+KSYVoicePool* ksy_voice_pool_create(int chCnt, int maxVoice) {
+    if (chCnt <= 0 || maxVoice <= 0) {
+        return NULL;
+    }
+    KSYVoicePool * pool = calloc(1, sizeof(KSYVoicePool));
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->chCnt    = chCnt;
+    pool->maxVoice = maxVoice;
+    pool->cmdRing  = ksy_ring_create(maxVoice*2 + 16, sizeof(KSYVoiceCmd));
+    pool->voices   = calloc(maxVoice, sizeof(KSYVoice));
+    pool->srcs     = calloc(maxVoice, sizeof(int16_t*));
+    pool->vols     = calloc(maxVoice, sizeof(float));
+    atomic_init(&pool->activeOut, 0);
+    atomic_init(&pool->deferredCnt, 0);
+    atomic_init(&pool->renderFreeCnt, 0);
+    atomic_init(&pool->droppedCnt, 0);
+    if (pool->cmdRing == NULL || pool->voices == NULL || pool->srcs == NULL || pool->vols == NULL) {
+        ksy_voice_pool_destroy(pool);
+        return NULL;
+    }
+    // 主轨线程持有的引用不超过 命令队列的容量 + 同时播放的个数, 控制接口每次调用时都会取空
+    KSYAudioRingStat st;
+    ksy_ring_get_stat(pool->cmdRing, &st);
+    pool->freeRing = ksy_ring_create(st.capacity + maxVoice, sizeof(KSYVoiceSample*));
+    if (pool->freeRing == NULL) {
+        ksy_voice_pool_destroy(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+void ksy_voice_pool_destroy(KSYVoicePool* pool) {
+    if (pool == NULL) {
+        return;
+    }
+    // 此时两个线程都已不再调用
+    KSYVoiceCmd cmd;
+    while (ksy_ring_fill(pool->cmdRing) > 0 && ksy_ring_read(pool->cmdRing, &cmd, 1) == 1) {
+        sampleRelease(pool, cmd.sample);
+    }
+    for (int i = 0; i < pool->nbActive; ++i) {
+        sampleRelease(pool, pool->voices[i].sample);
+    }
+    for (int i = 0; i < pool->nbSample; ++i) {
+        sampleRelease(pool, pool->samples[i]);
+    }
+    ksy_voice_pool_collect(pool);
+    ksy_ring_destroy(pool->cmdRing);
+    ksy_ring_destroy(pool->freeRing);
+    free(pool->samples);
+    free(pool->voices);
+    free(pool->srcs);
+    free(pool->vols);
+    free(pool->tailBuf);
+    free(pool);
+}
+
+void ksy_voice_pool_collect(KSYVoicePool* pool) {
+    KSYVoiceSample * s = NULL;
+    while (ksy_ring_fill(pool->freeRing) > 0 && ksy_ring_read(pool->freeRing, &s, 1) == 1) {
+        sampleFree(s);
+        pool->freedCnt += 1;
+    }
+}
+
+#pragma mark - control
+// 失败时释放数据: map 不为NULL时释放映射, 否则释放 pcm
+static int addFail(int16_t* pcm, KSYPcmMap* map) {
+    if (map) {
+        ksy_pcm_map_release(map);
+    }
+    else {
+        free(pcm);
+    }
+    return -1;
+}
+
+int ksy_voice_pool_add(KSYVoicePool* pool, int16_t* pcm, int nbFrame, KSYPcmMap* map) {
+    ksy_voice_pool_collect(pool);
+    if (pcm == NULL || nbFrame <= 0) {
+        return addFail(pcm, map);
+    }
+    if (pool->nbSample >= pool->sampleCap) {
+        int cap = pool->sampleCap ? pool->sampleCap*2 : 16;
+        KSYVoiceSample ** p = realloc(pool->samples, sizeof(KSYVoiceSample*)*cap);
+        if (p == NULL) {
+            return addFail(pcm, map);
+        }
+        memset(p + pool->sampleCap, 0, sizeof(KSYVoiceSample*)*(cap - pool->sampleCap));
+        pool->samples   = p;
+        pool->sampleCap = cap;
+    }
+    KSYVoiceSample * s = malloc(sizeof(KSYVoiceSample));
+    if (s == NULL) {
+        return addFail(pcm, map);
+    }
+    s->pcm     = pcm;
+    s->nbFrame = nbFrame;
+    s->map     = map;
+    atomic_init(&s->refCnt, 1);
+    pool->samples[pool->nbSample] = s;
+    return pool->nbSample++;
+}
+
+void ksy_voice_pool_remove(KSYVoicePool* pool, int sampleId) {
+    if (sampleId < 0 || sampleId >= pool->nbSample || pool->samples[sampleId] == NULL) {
+        return;
+    }
+    sampleRelease(pool, pool->samples[sampleId]);
+    pool->samples[sampleId] = NULL;
+    ksy_voice_pool_collect(pool);
+}
+
+BOOL ksy_voice_pool_play(KSYVoicePool* pool, int sampleId, float vol) {
+    ksy_voice_pool_collect(pool);
+    if (sampleId < 0 || sampleId >= pool->nbSample || pool->samples[sampleId] == NULL) {
+        return NO;
+    }
+    KSYVoiceCmd cmd = { KSYVoiceCmd_Play, pool->samples[sampleId], vol };
+    atomic_fetch_add(&cmd.sample->refCnt, 1);
+    if (ksy_ring_write(pool->cmdRing, &cmd, 1) != 1) {
+        sampleRelease(pool, cmd.sample);
+        return NO;
+    }
+    return YES;
+}
+
+void ksy_voice_pool_stop_all(KSYVoicePool* pool) {
+    ksy_voice_pool_collect(pool);
+    KSYVoiceCmd cmd = { KSYVoiceCmd_StopAll, NULL, 0 };
+    ksy_ring_write(pool->cmdRing, &cmd, 1);
+}
+
+BOOL ksy_voice_pool_reserve(KSYVoicePool* pool, int maxFrame) {
+    if (maxFrame <= pool->tailCap) {
+        return YES;
+    }
+    int16_t * p = realloc(pool->tailBuf, sizeof(int16_t) * maxFrame * pool->chCnt * pool->maxVoice);
+    if (p == NULL) {
+        return NO;
+    }
+    pool->tailBuf = p;
+    pool->tailCap = maxFrame;
+    return YES;
+}
+
+int ksy_voice_pool_active(const KSYVoicePool* pool) {
+    return atomic_load(&((KSYVoicePool*)pool)->activeOut);
+}
+
+void ksy_voice_pool_get_stat(const KSYVoicePool* pool, KSYVoicePoolStat* stat) {
+    KSYVoicePool * p = (KSYVoicePool*)pool;
+    stat->nbSample      = p->nbSample;
+    stat->nbActive      = atomic_load(&p->activeOut);
+    stat->nbPending     = ksy_ring_fill(p->freeRing);
+    stat->freedCnt      = p->freedCnt;
+    stat->deferredCnt   = atomic_load(&p->deferredCnt);
+    stat->renderFreeCnt = atomic_load(&p->renderFreeCnt);
+    stat->droppedCnt    = atomic_load(&p->droppedCnt);
+}
+
+#pragma mark - render
+static void processCmds(KSYVoicePool* pool) {
+    int nbCmd = ksy_ring_fill(pool->cmdRing);
+    KSYVoiceCmd cmd;
+    for (int i = 0; i < nbCmd && ksy_ring_read(pool->cmdRing, &cmd, 1) == 1; ++i) {
+        if (cmd.type == KSYVoiceCmd_StopAll) {
+            for (int v = 0; v < pool->nbActive; ++v) {
+                sampleReleaseDeferred(pool, pool->voices[v].sample);
+            }
+            pool->nbActive = 0;
+        }
+        else if (pool->nbActive < pool->maxVoice) {
+            KSYVoice voice = { cmd.sample, 0, cmd.vol };
+            pool->voices[pool->nbActive++] = voice;
+        }
+        else { // 超过同时播放的上限, 丢弃
+            sampleReleaseDeferred(pool, cmd.sample);
+            atomic_fetch_add(&pool->droppedCnt, 1);
+        }
+    }
+}
+
+BOOL ksy_voice_pool_render(KSYVoicePool* pool, int16_t* buf, int nbFrame) {
+    processCmds(pool);
+    if (pool->nbActive == 0 || buf == NULL || nbFrame <= 0) {
+        atomic_store(&pool->activeOut, pool->nbActive);
+        return NO;
+    }
+    if (!ksy_voice_pool_reserve(pool, nbFrame)) { // 超过预先分配的长度
+        return NO;
+    }
+    int ch     = pool->chCnt;
+    int nbTail = 0;
+    for (int v = 0; v < pool->nbActive; ++v) {
+        KSYVoice       * voice = &pool->voices[v];
+        KSYVoiceSample * s     = voice->sample;
+        const int16_t  * pcm   = s->pcm + (size_t)voice->pos * ch;
+        int remain = s->nbFrame - voice->pos;
+        if (remain >= nbFrame) { // 直接引用缓存中的数据
+            pool->srcs[v] = pcm;
+        }
+        else {
+            int16_t * tail = pool->tailBuf + (size_t)nbTail * pool->tailCap * ch;
+            memcpy(tail, pcm, sizeof(int16_t) * remain * ch);
+            memset(tail + remain*ch, 0, sizeof(int16_t) * (nbFrame - remain) * ch);
+            pool->srcs[v] = tail;
+            nbTail       += 1;
+        }
+        pool->vols[v] = voice->vol;
+        voice->pos   += nbFrame;
+    }
+    ksy_mix_tracks_s16(buf, pool->srcs, pool->vols, pool->nbActive, nbFrame * ch);
+    // 移除播放完的音效 (与最后一个交换)
+    for (int v = pool->nbActive - 1; v >= 0; --v) {
+        if (pool->voices[v].pos >= pool->voices[v].sample->nbFrame) {
+            sampleReleaseDeferred(pool, pool->voices[v].sample);
+            pool->voices[v] = pool->voices[--pool->nbActive];
+        }
+    }
+    atomic_store(&pool->activeOut, pool->nbActive);
+    return YES;
+}
@@ -29,6 +29,11 @@
 @property UISegmentedControl  * micInput;
 @property UILabel       * lblMuteSt;
 @property UISwitch      * muteStream;
+@property UILabel       * lblDuck;
+@property UISwitch      * duckBgm;   // 说话时自动压低背景音乐
+@property UISegmentedControl  * denoise;   // 麦克风降噪等级 (KSYDenoiseLevel)
+@property UILabel       * lblAec;
+@property UISwitch      * aec;       // 消除麦克风中外放的背景音乐/画中画
 
 // get value from UI ( micInput )
 @property (atomic, readwrite) KSYMicType    micType;
@@ -28,6 +28,12 @@
     [self initMicInput];
     _lblMuteSt       = [self addLable:@"静音推流"];
     _muteStream      = [self addSwitch:NO];
+    _lblDuck         = [self addLable:@"人声闪避"];
+    _duckBgm         = [self addSwitch:NO];
+    _denoise = [self addSegCtrlWithItems:@[ @"降噪关", @"低", @"中", @"高", @"最高"]];
+    _denoise.selectedSegmentIndex = 0;
+    _lblAec          = [self addLable:@"回声消除"];
+    _aec             = [self addSwitch:NO];
     return self;
 }
 - (void)layoutUI{
@@ -42,9 +48,10 @@
     
     [self putRow1:_lblDesc];
     [self putRow1:_micInput];
-    id nu = [NSNull null];
-    [self putRow:@[nu,nu,
+    [self putRow:@[_lblDuck,_duckBgm,
                    _lblMuteSt,_muteStream] ];
+    [self putRow1:_denoise];
+    [self putRow:@[_lblAec, _aec] ];
     
 }
 - (void) initMicInput {
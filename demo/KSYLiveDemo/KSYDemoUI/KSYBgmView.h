@@ -17,9 +17,17 @@
 @property KSYNameSlider * volumSl;
 @property UIButton * nextBtn;
 @property UIButton * muteBtn;
+// 流式解码 (仅推流): 开关/单曲循环/定位/变速/变调
+@property UISwitch * streamSw;
+@property UISwitch * loopSw;
+@property KSYNameSlider * seekSl;
+@property KSYNameSlider * tempoSl;
+@property KSYNameSlider * pitchSl;
 
 // 当前播放的背景音乐的路径
 @property NSString* bgmPath;
+// 目录下所有背景音乐的路径
+@property (readonly) NSArray* bgmFiles;
 // bgmStatus string
 @property NSString* bgmStatus;
 
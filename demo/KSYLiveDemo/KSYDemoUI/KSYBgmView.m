@@ -15,6 +15,8 @@
     int       _bgmIdx;  // 当前正在播放的音乐文件的索引
     UILabel * _bgmTitle;
     NSString* _bgmFileInfo;
+    UILabel * _lblStream;
+    UILabel * _lblLoop;
 }
 @end
 
@@ -31,6 +33,13 @@
     _volumSl    = [self addSliderName:@"音量" From:0 To:100 Init:50];
     _volumSl.slider.value = 50;
     _nextBtn    = [self addButton:@"下一首"];
+    _lblStream  = [self addLable:@"流式解码"];
+    _streamSw   = [self addSwitch:NO];
+    _lblLoop    = [self addLable:@"单曲循环"];
+    _loopSw     = [self addSwitch:NO];
+    _seekSl     = [self addSliderName:@"定位" From:0 To:100 Init:0];
+    _tempoSl    = [self addSliderName:@"速度" From:0.5 To:2.0 Init:1.0];
+    _pitchSl    = [self addSliderName:@"音高" From:-12 To:12 Init:0];
     _bgmStatus  = @"idle";
     _bgmPattern = @[@".mp3", @".m4a", @".aac"];
     [self loadBgmFiles];
@@ -45,6 +54,10 @@
     [self putRow1:_bgmTitle];
     [self putRow:@[_playBtn,_pauseBtn, _stopBtn, _nextBtn] ];
     [self putRow1:_volumSl];
+    [self putRow:@[_lblStream, _streamSw, _lblLoop, _loopSw] ];
+    [self putRow1:_seekSl];
+    [self putRow1:_tempoSl];
+    [self putRow1:_pitchSl];
 }
 
 - (void) loadBgmFiles{
@@ -66,6 +79,13 @@
     [self nextFile];
     NSLog(@"find %lu bgm files", (unsigned long)[_bgmList count]);
 }
+- (NSArray*) bgmFiles{
+    NSMutableArray * files = [NSMutableArray array];
+    for (NSString * name in _bgmList) {
+        [files addObject:[_bgmDir stringByAppendingString:name]];
+    }
+    return files;
+}
 - (void) nextFile{
     NSInteger cnt =[_bgmList count];
     if (cnt == 0) { // no file
@@ -7,13 +7,52 @@
 //
 
 #import "KSYBlockDemoVC.h"
+#import "KSYAudioTrackBuffer.h"
+#import "KSYAudioEffectPool.h"
+#import "KSYAudioOutputStage.h"
+#import "KSYAudioDucker.h"
+#import "KSYAudioEffectChain.h"
+#import "KSYAudioNoiseSuppressor.h"
+#import "KSYAudioEchoCanceller.h"
+#import "KSYAudioBgmStream.h"
+#import "KSYAudioFileCache.h"
+#import "KSYMediaPipeline.h"
 
 @interface KSYBlockDemoVC()
 
 @property (nonatomic, retain) KSYMoviePlayerController *player;
 @property KSYGPUStreamer     * gpuStreamer;
 @property GPUImageCropFilter * cropfilter;
+// 推流画面的缩放 (分辨率档位, 只影响推流, 预览不变)
+@property GPUImageFilter     * scaleFilter;
 @property GPUImageView       * preview;
+// 背景音乐和画中画的音频缓冲, 在麦克风线程上送入混音器
+@property KSYAudioTrackBuffer * bgmBuf;
+@property KSYAudioTrackBuffer * pipBuf;
+// 流式解码的背景音乐 (打开"流式解码"时代替bgmPlayer, 与bgmBuf共用track)
+@property KSYAudioBgmStream   * bgmStream;
+// 流式解码的曲目的歌词 (曲目id -> 各行歌词), 与音乐文件同名的 .lrc
+@property NSMutableDictionary * lyrics;
+// 背景音乐和音效解码后的PCM缓存, 再次使用时直接内存映射
+@property KSYAudioFileCache   * pcmCache;
+// 短音效, 所有音效混合后占用一个track
+@property KSYAudioEffectPool  * effectPool;
+@property (nonatomic, assign) int effectTrack;
+// 混音结果的限幅和响度统计
+@property KSYAudioOutputStage * outStage;
+// 混音结果的处理图: 限幅 -> 推流
+@property KSYMediaPipeline    * audioOut;
+// 混音结果送入处理图失败 (入口队列满) 的次数, 即推流中丢失的音频块
+@property int64_t               mixDropCnt;
+// 说话时压低背景音乐
+@property KSYAudioDucker      * ducker;
+// 麦克风的效果链: 噪声门 -> 均衡 -> 变调
+@property KSYAudioEffectChain * micFx;
+@property (nonatomic, assign) int micPitchFx;
+// 麦克风降噪, 在其他效果之前
+@property KSYAudioNoiseSuppressor * micNs;
+// 回声消除, 以背景音乐(0)和画中画(1)的播放数据为参考, 在降噪之前
+@property KSYAudioEchoCanceller * aec;
 @end
 
 @implementation KSYBlockDemoVC
@@ -32,6 +71,7 @@
     _gpuStreamer = [[KSYGPUStreamer alloc] initWithDefaultCfg];
     self.streamerBase = _gpuStreamer.streamerBase;
     [self setStreamerCfg];
+    [self setupLadder];
     // 创建 预览模块, 并放到视图底部
     _preview = [[GPUImageView alloc] init];
     _preview.frame = self.view.frame;
@@ -136,48 +176,272 @@
         src = self.pipFilter;
     }
     [src     addTarget:_preview];
+    if (_scaleFilter){
+        [_scaleFilter removeAllTargets];
+        [src addTarget:_scaleFilter];
+        src = _scaleFilter;
+    }
     [src     addTarget:_gpuStreamer];
 }
+
+#pragma mark - resolution ladder
+- (CGSize) streamSize {
+    switch ([self.presetCfgView resolution]) {
+        case KSYVideoDimension_16_9__1280x720:
+            return CGSizeMake(1280, 720);
+        case KSYVideoDimension_16_9__960x540:
+            return CGSizeMake(960, 540);
+        case KSYVideoDimension_4_3__640x480:
+            return CGSizeMake(640, 480);
+        default:
+            return CGSizeMake(640, 360);
+    }
+}
+// 码率低时降低推流的分辨率和帧率: 低档位的码率范围与高档位重叠, 切换有滞后
+// 默认关闭: 推流中改变分辨率的效果尚未在设备上验证 (见 applyRung:)
+- (void) setupLadder {
+    if (self.bwAdapter == nil || ![self.presetCfgView videoLadder]) {
+        return;
+    }
+    CGSize sz   = [self streamSize];
+    int    w    = sz.width, h = sz.height;
+    int    fps  = [self.presetCfgView frameRate];
+    int    kbps = self.streamerBase.videoMaxBitrate;
+    KSYLadderRung rungs[] = {
+        { (w/2)   & ~3, (h/2)   & ~3, MAX(fps*2/3, 1), 0,      kbps*2/5 },
+        { (w*2/3) & ~3, (h*2/3) & ~3, fps,             kbps/4, kbps*2/3 },
+        { w,            h,            fps,             kbps/2, kbps     },
+    };
+    int nbRung = sizeof(rungs) / sizeof(rungs[0]);
+    if (![self.bwAdapter setLadder:rungs count:nbRung initRung:nbRung - 1]) {
+        return;
+    }
+    _scaleFilter = [[GPUImageFilter alloc] init];
+    __weak KSYBlockDemoVC * vc = self;
+    self.bwAdapter.onRungChange = ^(const KSYLadderRung* rung){
+        [vc applyRung:rung];
+    };
+}
+// 未经设备验证: 推流中 forceProcessingAtSize 改变分辨率后, 编码器是否重建并从关键帧开始,
+// 以及切换是否与关键帧对齐, 都需要在设备上用播放端确认
+- (void) applyRung:(const KSYLadderRung*)rung {
+    UIInterfaceOrientation orien = [[UIApplication sharedApplication] statusBarOrientation];
+    CGSize sz = CGSizeMake(rung->width, rung->height);
+    if (orien == UIInterfaceOrientationPortrait ||
+        orien == UIInterfaceOrientationPortraitUpsideDown) {
+        sz = CGSizeMake(rung->height, rung->width);
+    }
+    [_scaleFilter forceProcessingAtSize:sz];
+    self.capDev.frameRate = rung->fps;
+}
 - (void) setupAudioPath {
     __weak KSYBlockDemoVC * vc = self;
-    //采集设备的麦克风音频数据, 通过混响处理后, 送入混音器
+    //采集设备的麦克风音频数据, 经过降噪/效果/混响处理后, 送入混音器
     self.micTrack = 0;
     self.capDev.audioProcessingCallback = ^(CMSampleBufferRef buf){
         if (![vc.streamerBase isStreaming]){
+            [vc.bgmBuf flush];
+            [vc.pipBuf flush];
+            [vc.ducker reset];
             return;
         }
+        [vc.aec processAudioSampleBuffer:buf];
+        if (vc.micNs.level != KSYDenoiseLevel_Off) {
+            [vc.micNs processAudioSampleBuffer:buf];
+        }
+        [vc.micFx processAudioSampleBuffer:buf];
         if (vc.reverb){
             [vc.reverb processAudioSampleBuffer:buf];
         }
+        else if (vc.roomReverb){
+            [vc.roomReverb processAudioSampleBuffer:buf];
+        }
+        [vc.outStage meterTrack:vc.micTrack sampleBuffer:buf];
+        [vc.ducker processMainTrack:buf];
+        // 先取出其他track对应时长的数据, 再送入主轨触发混音
+        [vc.bgmBuf feedMixer:buf];
+        [vc.bgmStream feedMixer:buf];
+        [vc.pipBuf feedMixer:buf];
+        [vc.effectPool feedMixer:buf];
         [vc.aMixer processAudioSampleBuffer:buf of:vc.micTrack];
     };
-    //背景音乐播放,音乐数据送入混音器
+    if (self.audioMixerView.aec.isOn) {
+        self.aec = [[KSYAudioEchoCanceller alloc] init];
+    }
+    self.micNs = [[KSYAudioNoiseSuppressor alloc] init];
+    self.micNs.level = (KSYDenoiseLevel)self.audioMixerView.denoise.selectedSegmentIndex;
+    self.micFx = [[KSYAudioEffectChain alloc] init];
+    [self.micFx addEffect:KSYAudioFxType_Gate];
+    [self.micFx addEffect:KSYAudioFxType_EQ];
+    self.micPitchFx = [self.micFx addEffect:KSYAudioFxType_Pitch];
+    //背景音乐播放,音乐数据经缓冲送入混音器
     self.bgmTrack = 1;
+    self.bgmBuf = [[KSYAudioTrackBuffer alloc] initWithMixer:self.aMixer
+                                                       track:self.bgmTrack
+                                                    bufferMs:500];
+    self.bgmBuf.targetMs = 100;
+    self.ducker = [[KSYAudioDucker alloc] init];
+    self.pcmCache = [[KSYAudioFileCache alloc] initWithDirectory:nil
+                                                        budgetMB:200
+                                                          format:self.aMixer.outFmt];
+    self.bgmStream = [[KSYAudioBgmStream alloc] initWithMixer:self.aMixer
+                                                        track:self.bgmTrack
+                                                  readAheadMs:2000];
+    self.bgmStream.cache = self.pcmCache;
+    self.bgmStream.onEvent = ^(KSYBgmEvent event, int trackId) {
+        if (event == KSYBgmEvent_TrackStart) {
+            vc.ksyBgmView.bgmStatus = [NSString stringWithFormat:@"stream #%d", trackId];
+        }
+        else if (event == KSYBgmEvent_QueueEnd) {
+            vc.ksyBgmView.bgmStatus = @"idle";
+        }
+    };
+    self.lyrics = [NSMutableDictionary dictionary];
+    self.bgmStream.onCue = ^(int trackId, int tag) {
+        NSArray * lines = vc.lyrics[@(trackId)];
+        if ((NSUInteger)tag < lines.count) {
+            vc.ksyBgmView.bgmStatus = [NSString stringWithFormat:@"#%d %@", trackId, lines[tag]];
+        }
+    };
+    if (self.audioMixerView.duckBgm.isOn) {
+        self.bgmBuf.ducker    = self.ducker;
+        self.bgmStream.ducker = self.ducker;
+    }
     self.bgmPlayer.audioDataBlock = ^(CMSampleBufferRef buf){
         if (![vc.streamerBase isStreaming]){
             return;
         }
-        [vc.aMixer processAudioSampleBuffer:buf of:vc.bgmTrack];
+        [vc.aec processFarEnd:buf of:0];
+        [vc.bgmBuf processAudioSampleBuffer:buf];
+    };
+    // bgmPlayer 与 bgmStream 送入同一个track, 切换"流式解码"时停止另一个
+    self.ksyBgmView.onSwitchBlock = ^(id sender) {
+        [vc onBgmSwitch:sender];
     };
     // pip
+    self.pipTrack = 2;
+    self.pipBuf = [[KSYAudioTrackBuffer alloc] initWithMixer:self.aMixer
+                                                       track:self.pipTrack
+                                                    bufferMs:500];
+    self.pipBuf.targetMs = 100;
+    // 音效: 在后台加载 Documents/effects 目录下的文件
+    self.effectTrack = 3;
+    if (self.effectTrack < [self.aMixer getMaxMixTrack]) {
+        self.effectPool = [[KSYAudioEffectPool alloc] initWithMixer:self.aMixer
+                                                              track:self.effectTrack
+                                                           maxVoice:8];
+    }
+    else {
+        NSLog(@"mixer supports %d tracks, effects disabled", [self.aMixer getMaxMixTrack]);
+    }
+    self.effectPool.cache = self.pcmCache;
+    NSString * dir = [NSHomeDirectory() stringByAppendingString:@"/Documents/effects/"];
+    NSMutableArray * paths = [NSMutableArray array];
+    for (NSString * name in [[NSFileManager defaultManager] contentsOfDirectoryAtPath:dir
+                                                                                error:nil]) {
+        [paths addObject:[dir stringByAppendingString:name]];
+    }
+    [self.effectPool loadEffectFiles:paths completion:^(NSArray<NSNumber *> *ids) {
+        NSLog(@"%d effects loaded", vc.effectPool.effectCount);
+    }];
     
-    
-    // 混音结果送入streamer
-    self.aMixer.audioProcessingCallback = ^(CMSampleBufferRef buf){
+    // 混音结果经过限幅后送入streamer
+    self.outStage = [[KSYAudioOutputStage alloc] initWithFormat:self.aMixer.outFmt
+                                                    lookaheadMs:5];
+    self.bgmBuf.outputStage     = self.outStage;
+    self.bgmStream.outputStage  = self.outStage;
+    self.pipBuf.outputStage     = self.outStage;
+    self.effectPool.outputStage = self.outStage;
+    // 限幅和推流是处理图中的节点, 在调度线程上执行, 混音线程只把数据放入队列
+    self.audioOut = [[KSYMediaPipeline alloc] initWithThreads:1];
+    KSYMediaNode * mixOut = [self.audioOut addInput:@"mixer"
+                                               type:KSYMediaType_Audio
+                                           capacity:16];
+    KSYMediaNode * limit  = [self.audioOut addStage:@"outStage"
+                                               type:KSYMediaType_Audio
+                                              block:^(CMSampleBufferRef buf){
+        [vc.outStage processAudioSampleBuffer:buf];
+    }];
+    KSYMediaNode * push   = [self.audioOut addSink:@"streamer"
+                                              type:KSYMediaType_Audio
+                                             block:^(CMSampleBufferRef buf){
         [vc.streamerBase processAudioSampleBuffer:buf];
+    }];
+    // 推流偶尔的停顿由队列吸收: 32个混音周期 (1024帧时约0.7秒), 而不是让混音线程等待
+    [self.audioOut connect:mixOut port:0 to:limit port:0 capacity:32];
+    [self.audioOut connect:limit  port:0 to:push  port:0 capacity:4];
+    [self.audioOut start];
+    // 混音回调在采集线程上, 不能等待: 队列满时丢弃并计数
+    self.aMixer.audioProcessingCallback = ^(CMSampleBufferRef buf){
+        if (![vc.audioOut pushSampleBuffer:buf to:mixOut]) {
+            vc.mixDropCnt += 1;
+        }
     };
     // mixer 的主通道为麦克风,时间戳以住通道为准
     self.aMixer.mainTrack = self.micTrack;
     [self.aMixer setTrack:self.micTrack enable:YES];
     [self.aMixer setTrack:self.bgmTrack enable:YES];
     [self.aMixer setTrack:self.pipTrack enable:YES];
+    if (self.effectPool) {
+        [self.aMixer setTrack:self.effectTrack enable:YES];
+    }
     
     // default volume
     [self.aMixer setMixVolume:1.0 of:self.micTrack];
     [self.aMixer setMixVolume:0.2 of:self.bgmTrack];
     [self.aMixer setMixVolume:1.0 of:self.pipTrack];
+    if (self.effectPool) {
+        [self.aMixer setMixVolume:1.0 of:self.effectTrack];
+    }
     self.audioMixerView.bgmVol.slider.value = 0.2;
 }
+- (void)onTimer:(NSTimer *)theTimer{
+    [super onTimer:theTimer];
+    if (self.streamerBase.streamState != KSYStreamStateConnected ) {
+        return;
+    }
+    KSYAudioRingStat bgm = self.bgmBuf.stat;
+    KSYAudioRingStat pip = self.pipBuf.stat;
+    NSString* bufStat = [NSString stringWithFormat:@"\n音频缓冲 bgm %d/%d 欠载%lld x%.4f | pip %d/%d 欠载%lld x%.4f",
+                         bgm.fill, bgm.highWater, bgm.underrunCnt, self.bgmBuf.driftRatio,
+                         pip.fill, pip.highWater, pip.underrunCnt, self.pipBuf.driftRatio];
+    KSYAudioLevel mix = self.outStage.level;
+    KSYAudioLevel mic = [self.outStage levelOfTrack:self.micTrack];
+    KSYAudioLevel bgmLv = [self.outStage levelOfTrack:self.bgmTrack];
+    NSString* lvStat = [NSString stringWithFormat:@"\n响度 M%.1f S%.1f I%.1f LUFS 峰值%.1f 限幅%.1fdB | mic %.1f bgm %.1f dBFS 闪避%.1fdB",
+                        mix.momentary, mix.shortTerm, mix.integrated, mix.peak,
+                        self.outStage.gainReduction, mic.peak, bgmLv.peak, self.ducker.gainDb];
+    if (self.micNs.level != KSYDenoiseLevel_Off) {
+        lvStat = [lvStat stringByAppendingFormat:@"\n降噪 %.0fus/帧 (最大%.0f)%@ 噪声%.1fdB 衰减%.1fdB",
+                  self.micNs.avgFrameUs, self.micNs.maxFrameUs,
+                  self.micNs.bOverBudget ? @" 超时直通" : @"",
+                  self.micNs.noiseDb, self.micNs.reductionDb];
+    }
+    KSYAudioBgmStream * bgm = self.bgmStream;
+    if (bgm.curTrack >= 0) {
+        KSYBgmStat st = bgm.stat;
+        lvStat = [lvStat stringByAppendingFormat:@"\n流式背景音乐 %.1f/%.1fs 预读%.0fms 解码CPU %.2f%% 欠载%lld 列表%d",
+                  bgm.position, bgm.duration, st.fillMs, st.cpuPercent,
+                  st.underrunCnt, st.queued];
+        KSYPcmCacheStat cst = self.pcmCache.stat;
+        lvStat = [lvStat stringByAppendingFormat:@"\nPCM缓存 %d个 %.1fMB 命中%lld 未命中%lld 淘汰%lld",
+                  cst.nbEntry, cst.bytes / 1048576.0, cst.hitCnt, cst.missCnt, cst.evictCnt];
+        if (bgm.duration > 0) {
+            self.ksyBgmView.progressV.progress = bgm.position / bgm.duration;
+        }
+    }
+    KSYAudioEchoCanceller * aec = self.aec;
+    if (aec) {
+        lvStat = [lvStat stringByAppendingFormat:@"\n回声消除 ERLE %.1fdB%@ %.0fus/块 延迟%.0fms 重同步%d",
+                  aec.erleDb, aec.bAdapted ? @"" : @" 收敛中",
+                  aec.avgBlockUs, aec.latencyMs, aec.resyncCnt];
+    }
+    lvStat = [lvStat stringByAppendingFormat:@"\n处理图 混音丢弃%lld\n%@",
+              self.mixDropCnt, self.audioOut.statString];
+    UILabel *stat = self.ctrlView.lblStat;
+    stat.text = [[stat.text stringByAppendingString:bufStat] stringByAppendingString:lvStat];
+}
+
 #pragma mark - basic ctrl
 - (void) onFlash {
     [self.capDev toggleTorch];
@@ -216,6 +480,34 @@
 }
 
 // volume change
+- (void)onAMixerSwitch:(UISwitch *)sw {
+    [super onAMixerSwitch:sw];
+    if (sw == self.audioMixerView.duckBgm) {
+        self.bgmBuf.ducker    = sw.isOn ? self.ducker : nil;
+        self.bgmStream.ducker = sw.isOn ? self.ducker : nil;
+    }
+    else if (sw == self.audioMixerView.aec) {
+        // 各线程只读取一次属性, 切换时整体替换即可
+        self.aec = sw.isOn ? [[KSYAudioEchoCanceller alloc] init] : nil;
+    }
+}
+
+- (void)onAMixerSegCtrl:(UISegmentedControl *)seg {
+    [super onAMixerSegCtrl:seg];
+    if (seg == self.audioMixerView.denoise) {
+        self.micNs.level = (KSYDenoiseLevel)seg.selectedSegmentIndex;
+    }
+}
+
+- (void)onReverbSlider:(KSYNameSlider *)slider {
+    [super onReverbSlider:slider];
+    if (slider == self.reverbView.pitch) {
+        [self.micFx setParam:KSYFxPitch_Semitone
+                       value:slider.slider.value
+                    ofEffect:self.micPitchFx];
+    }
+}
+
 - (void)onAMixerSlider:(KSYNameSlider *)slider {
     float val = 0.0;
     if ([slider isKindOfClass:[KSYNameSlider class]]) {
@@ -251,7 +543,11 @@
             [vc.yuvInput processPixelBuffer:buf time:CMTimeMake(2, 10)];
         };
         self.player.audioDataBlock = ^(CMSampleBufferRef buf){
-            [vc.aMixer processAudioSampleBuffer:buf of:vc.pipTrack];
+            if (![vc.streamerBase isStreaming]){
+                return;
+            }
+            [vc.aec processFarEnd:buf of:1];
+            [vc.pipBuf processAudioSampleBuffer:buf];
         };
         //pipFilter
         CGRect rect = CGRectMake(0.6, 0.6, 0.3, 0.3);
@@ -269,6 +565,93 @@
     [self.capDev setAVAudioSessionOption];
 }
 
+#pragma mark - bgm
+// 打开"流式解码"时, 背景音乐由 bgmStream 解码后直接送入混音器
+- (void)onBgmBtnPress:(UIButton *)btn{
+    KSYBgmView * view = self.ksyBgmView;
+    if (!view.streamSw.isOn) {
+        [super onBgmBtnPress:btn];
+        return;
+    }
+    if (btn == view.playBtn){
+        // 从当前文件开始, 目录下的其他文件依次加入播放列表
+        NSArray * files = view.bgmFiles;
+        NSUInteger start = view.bgmPath ? [files indexOfObject:view.bgmPath] : 0;
+        start = (start == NSNotFound) ? 0 : start;
+        [self.bgmStream stop];
+        [self.bgmStream clearCues];
+        [self.lyrics removeAllObjects];
+        for (NSUInteger i = 0; i < files.count; ++i) {
+            NSString * file = files[(start + i) % files.count];
+            int tid = [self.bgmStream enqueueFile:file
+                                             loop:view.loopSw.isOn];
+            NSString * lrc = [NSString stringWithContentsOfFile:[[file stringByDeletingPathExtension]
+                                                                 stringByAppendingPathExtension:@"lrc"]
+                                                       encoding:NSUTF8StringEncoding
+                                                          error:nil];
+            NSArray * lines = (tid >= 0 && lrc) ? [self.bgmStream setLrc:lrc forTrack:tid] : nil;
+            if (lines) {
+                self.lyrics[@(tid)] = lines;
+            }
+        }
+    }
+    else if (btn == view.pauseBtn){
+        if (self.bgmStream.bPaused) {
+            [self.bgmStream resume];
+        }
+        else {
+            [self.bgmStream pause];
+        }
+    }
+    else if (btn == view.stopBtn){
+        [self.bgmStream stop];
+    }
+    else if (btn == view.nextBtn){
+        [self.bgmStream skip];
+    }
+}
+
+- (void)onBgmSwitch:(UISwitch *)sw{
+    if (sw != self.ksyBgmView.streamSw) {
+        return;
+    }
+    if (sw.isOn) {
+        // bgmBuf 中剩余的数据(不超过 targetMs)在主轨线程中自然播完
+        KSYBgmPlayerState state = self.bgmPlayer.bgmPlayerState;
+        if (state == KSYBgmPlayerStatePlaying || state == KSYBgmPlayerStatePaused) {
+            [self.bgmPlayer stopPlayBgm];
+        }
+    }
+    else {
+        [self.bgmStream stop];
+    }
+}
+
+- (void)onBgmVolume:(id)sl{
+    if (sl == self.ksyBgmView.seekSl) {
+        [self.bgmStream seekTo:self.bgmStream.duration * self.ksyBgmView.seekSl.normalValue];
+        return;
+    }
+    if (sl == self.ksyBgmView.tempoSl) {
+        self.bgmStream.tempo = self.ksyBgmView.tempoSl.slider.value;
+        return;
+    }
+    if (sl == self.ksyBgmView.pitchSl) {
+        self.bgmStream.pitch = self.ksyBgmView.pitchSl.slider.value;
+        return;
+    }
+    [super onBgmVolume:sl];
+}
+
+- (void)onPlayEffect{
+    // 依次播放加载的音效
+    static int idx = 0;
+    int cnt = self.effectPool.effectCount;
+    if (cnt > 0) {
+        [self.effectPool playEffect:(idx++) % cnt volume:1.0];
+    }
+}
+
 - (void)onPipPlay{
     [self setupPip];
     [self.player play];
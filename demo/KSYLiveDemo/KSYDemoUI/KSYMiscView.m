@@ -21,6 +21,8 @@
     _btn0  = [self addButton:@"str截图为文件"];
     _btn1  = [self addButton:@"str截图为UIImage"];
     _btn2  = [self addButton:@"filter截图"];
+    _btn3  = [self addButton:@"音频性能测试"];
+    _btn4  = [self addButton:@"播放音效"];
     return self;
 }
 - (void)layoutUI{
@@ -29,6 +31,8 @@
     [self putRow3:_btn0
               and:_btn1
               and:_btn2];
+    [self putRow2:_btn3
+              and:_btn4];
 }
 
 @end
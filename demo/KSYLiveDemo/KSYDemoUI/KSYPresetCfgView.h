@@ -44,6 +44,10 @@
 @property KSYNameSlider      *videoKbpsUI;
 @property UILabel            *lblAudioKbpsUI; //
 @property UISegmentedControl *audioKbpsUI; //
+@property UILabel            *lblBwEstimatorUI; //
+@property UISegmentedControl *bwEstimatorUI; // 码率估计
+@property UILabel            *lblVideoLadderUI; //
+@property UISegmentedControl *videoLadderUI; // 分辨率档位
 // get config data
 - (NSString*) hostUrl;
 - (KSYVideoDimension) resolution;
@@ -53,6 +57,10 @@
 - (KSYAudioCodec) audioCodec;
 - (int) videoKbps;
 - (int) audioKbps;
+// 0: SDK内置的估计 1: AIMD 2: 延迟梯度 (KSYBwEstimator)
+- (int) bwEstimator;
+// 按码率切换推流分辨率/帧率 (需要选择 AIMD 或 延迟梯度), 默认关闭
+- (BOOL) videoLadder;
 
 @end
 
@@ -62,6 +62,10 @@
     _lblAudioKbpsUI= [self addLable:@"音频kbps"];
     _audioKbpsUI  = [self addSegCtrlWithItems:@[@"12",@"24",@"32", @"48", @"64", @"128"]];
     _audioKbpsUI.selectedSegmentIndex = 2;
+    _lblBwEstimatorUI = [self addLable:@"码率估计"];
+    _bwEstimatorUI = [self addSegCtrlWithItems:@[@"SDK",@"AIMD",@"延迟梯度"]];
+    _lblVideoLadderUI = [self addLable:@"分辨率档位"];
+    _videoLadderUI = [self addSegCtrlWithItems:@[@"关闭",@"开启"]];
     _demoLable    = [self addLable:@"选择demo开始"];
     _demoLable.textAlignment = NSTextAlignmentCenter;
     return self;
@@ -81,6 +85,8 @@
     [self putLable:_lblAudioCodecUI andView:_audioCodecUI];
     [self putRow1:_videoKbpsUI];
     [self putLable:_lblAudioKbpsUI andView:_audioKbpsUI];
+    [self putLable:_lblBwEstimatorUI andView:_bwEstimatorUI];
+    [self putLable:_lblVideoLadderUI andView:_videoLadderUI];
     
     [self putRow1:_demoLable];
     self.btnH= (self.height - self.yPos - self.gap*2)/2;
@@ -157,4 +163,12 @@
     return aKbps;
 }
 
+- (int) bwEstimator {
+    return (int)_bwEstimatorUI.selectedSegmentIndex;
+}
+
+- (BOOL) videoLadder {
+    return _videoLadderUI.selectedSegmentIndex == 1;
+}
+
 @end
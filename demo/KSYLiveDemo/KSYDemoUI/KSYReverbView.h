@@ -8,8 +8,20 @@
 
 #import "KSYUIView.h"
 
+@class KSYNameSlider;
+
 @interface KSYReverbView : KSYUIView
 
 @property UISegmentedControl  * reverbType;
+// 以下参数只对"自定义"类型有效
+@property KSYNameSlider * roomSize;
+@property KSYNameSlider * damping;
+@property KSYNameSlider * wetLevel;
+@property KSYNameSlider * preDelay;
+// 变调 (半音, -12~12), 与混响类型无关
+@property KSYNameSlider * pitch;
+
+// 最后一项为参数可调的自定义混响
+@property (nonatomic, readonly) BOOL bCustom;
 
 @end
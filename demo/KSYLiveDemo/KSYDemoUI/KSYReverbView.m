@@ -7,6 +7,7 @@
 //
 
 #import "KSYReverbView.h"
+#import "KSYNameSlider.h"
 @interface KSYReverbView () {
     UILabel * _title;
 }
@@ -15,12 +16,25 @@
 - (id)init{
     self = [super init];
     _title = [self addLable:@"选择混响类型"];
-    _reverbType = [self addSegCtrlWithItems:@[@"关闭", @"录影棚",@"演唱会",@"KTV",@"小舞台"]];
+    _reverbType = [self addSegCtrlWithItems:@[@"关闭", @"录影棚",@"演唱会",@"KTV",@"小舞台",@"自定义"]];
+    _roomSize = [self addSliderName:@"房间大小" From:0.0 To:1.0 Init:0.5];
+    _damping  = [self addSliderName:@"高频阻尼" From:0.0 To:1.0 Init:0.5];
+    _wetLevel = [self addSliderName:@"混响比例" From:0.0 To:1.0 Init:0.3];
+    _preDelay = [self addSliderName:@"预延迟ms" From:0.0 To:100.0 Init:20.0];
+    _pitch    = [self addSliderName:@"变调" From:-12.0 To:12.0 Init:0.0];
     return self;
 }
 - (void)layoutUI{
     [super layoutUI];
     [self putRow1:_title];
     [self putRow1:_reverbType];
+    [self putRow1:_roomSize];
+    [self putRow1:_damping];
+    [self putRow1:_wetLevel];
+    [self putRow1:_preDelay];
+    [self putRow1:_pitch];
+}
+- (BOOL)bCustom {
+    return _reverbType.selectedSegmentIndex == _reverbType.numberOfSegments-1;
 }
 @end
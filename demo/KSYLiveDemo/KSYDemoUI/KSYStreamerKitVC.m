@@ -8,6 +8,7 @@
 
 #import "KSYStreamerKitVC.h"
 #import <GPUImage/GPUImage.h>
+#import "KSYAudioMicMonitor.h"
 #if USING_DYNAMIC_FRAMEWORK
 #import <libksygpulivedylib/libksygpulivedylib.h>
 #import <libksygpulivedylib/libksygpulive.h>
@@ -90,6 +91,8 @@
 // status monitor
 @property NSTimer *timer;
 @property KSYAudioReverb*  audioReverb;
+// 低延迟耳返 (代替 kit.micMonitor), 返音带混响
+@property KSYAudioMicMonitor * micMonitor;
 @end
 
 
@@ -125,8 +128,10 @@ void processVideo (CMSampleBufferRef sampleBuffer) {
     _previewMirrored = NO;
     _streamerMirrored = NO;
     _audioReverb = nil;
+    _micMonitor = [[KSYAudioMicMonitor alloc] init];
+    [_micMonitor.effectChain addEffect:KSYAudioFxType_Reverb];
     if([KSYMicMonitor isHeadsetPluggedIn]){
-        [_kit.micMonitor start];
+        [_micMonitor start];
     }
     NSLog(@"version: %@", [_kit getKSYVersion]);
 }
@@ -506,7 +511,7 @@ void processVideo (CMSampleBufferRef sampleBuffer) {
     [_kit.player stop];
     [_kit.bgmPlayer stopPlayBgm];
     [_kit.streamerBase stopStream];
-    [_kit.micMonitor stop];
+    [_micMonitor stop];
     [_kit stopPreview];
     [self rmObservers];  // need remove observers to dealloc
     [self dismissViewControllerAnimated:FALSE completion:nil];
@@ -750,7 +755,7 @@ void processVideo (CMSampleBufferRef sampleBuffer) {
     }
     else if (sender == _micVolS) {
         [_kit.audioMixer setMixVolume:_micVolS.value of:_kit.micTrack];
-        [_kit.micMonitor setVolume:_micVolS.value];
+        [_micMonitor setVolume:_micVolS.value];
     }
 }
 
@@ -861,6 +866,13 @@ void processVideo (CMSampleBufferRef sampleBuffer) {
         _stat.text = [ _stat.text  stringByAppendingString:statefps  ];
         _stat.text = [ _stat.text  stringByAppendingString:statedrop ];
         _stat.text = [ _stat.text  stringByAppendingString:netEvent  ];
+        if (_micMonitor.isRunning) {
+            KSYMonitorStat mon = _micMonitor.stat;
+            NSString* monStat = [NSString stringWithFormat:@"耳返 %.1fms = 输入%.1f + 处理%.2f + 缓冲%.1f + 输出%.1f | 欠载%lld\n",
+                                 mon.totalMs, mon.inputMs, mon.processMs, mon.bufferMs,
+                                 mon.outputMs, mon.underrunCnt];
+            _stat.text = [ _stat.text  stringByAppendingString:monStat ];
+        }
         
         
         if (_netTimeOut == 0) {
@@ -19,6 +19,9 @@
 #import "KSYAudioMixerView.h"
 #import "KSYReverbView.h"
 #import "KSYMiscView.h"
+#import "KSYAudioRoomReverb.h"
+#import "KSYBwAdapter.h"
+#import "KSYStreamReconnector.h"
 #if USING_DYNAMIC_FRAMEWORK
 #import <libksygpulivedylib/libksygpulivedylib.h>
 #import <libksygpulivedylib/libksygpuimage.h>
@@ -58,10 +61,16 @@ typedef struct _StreamState {
 @property (nonatomic, retain) GPUImageFilter*    filter;
 @property (nonatomic, retain) KSYBgmPlayer*      bgmPlayer;
 @property (nonatomic, retain) KSYAudioReverb*    reverb;
+// 参数可调的混响 (选择"自定义"类型时有效, 与 reverb 二选一)
+@property (nonatomic, retain) KSYAudioRoomReverb* roomReverb;
 // 画中画
 @property (nonatomic, retain) KSYGPUYUVInput           *yuvInput;
 @property (nonatomic, retain) KSYGPUPipBlendFilter     *pipFilter;
 @property(nonatomic, retain)  GPUImagePicture          *bgPic;
+// 可替换的码率估计 (预设中选择"SDK"时为nil)
+@property (nonatomic, retain) KSYBwAdapter*      bwAdapter;
+// 断线重连 (退避 + 网络探测)
+@property (nonatomic, retain) KSYStreamReconnector* reconnector;
 
 
 
@@ -104,8 +113,14 @@ typedef struct _StreamState {
 // audio mixer
 - (void)onAMixerSwitch:(UISwitch *)sw;
 - (void)onAMixerSlider:(KSYNameSlider *)slider;
+- (void)onAMixerSegCtrl:(UISegmentedControl *)seg;
 // 选择混响类型
 - (void)onReverbType:(UISegmentedControl *)seg;
+// 调整自定义混响的参数
+- (void)onReverbSlider:(KSYNameSlider *)slider;
+// bgm
+- (void)onBgmBtnPress:(UIButton *)btn;
+- (void)onBgmVolume:(id)sl;
 //pip
 - (void)onPipStop;
 @end
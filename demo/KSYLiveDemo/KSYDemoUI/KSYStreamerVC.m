@@ -18,6 +18,8 @@
 #import "KSYPipView.h"
 #import "KSYNameSlider.h"
 #import "KSYReverbView.h"
+#import "KSYAudioKernel.h"
+#import "KSYAudioFdnReverb.h"
 
 @interface KSYStreamerVC () {
     StreamState _lastStD;
@@ -98,6 +100,9 @@
     _reverbView.onSegCtrlBlock = ^(id sender){
         [weakself onReverbType:sender];
     };
+    _reverbView.onSliderBlock = ^(id sender){
+        [weakself onReverbSlider:sender];
+    };
     //混音实现
     _audioMixerView.onSegCtrlBlock=^(id sender){
         [weakself onAMixerSegCtrl:sender];
@@ -252,6 +257,27 @@
     else {
         [self defaultStramCfg];
     }
+    // SDK内置的估计仍然生效, bwAdapter 通过 videoMaxBitrate 限制它的上调
+    switch ([_presetCfgView bwEstimator]) {
+        case 1:
+            _bwAdapter = [[KSYBwAdapter alloc] initWithStreamer:_streamerBase
+                                                      estimator:&ksy_bwe_aimd];
+            break;
+        case 2:
+            _bwAdapter = [[KSYBwAdapter alloc] initWithStreamer:_streamerBase
+                                                      estimator:&ksy_bwe_delay];
+            break;
+        default:
+            _bwAdapter = nil;
+            break;
+    }
+    _reconnector = [[KSYStreamReconnector alloc] initWithStreamer:_streamerBase];
+    _reconnector.hostURL = _hostURL;
+    __weak KSYStreamerVC * vc = self;
+    _reconnector.onGiveUp = ^(KSYStreamErrorCode errCode) {
+        vc.ctrlView.lblStat.text = [NSString stringWithFormat:@"%@\n重连失败",
+                                          [vc.streamerBase getCurKSYStreamErrorCodeName]];
+    };
 }
 
 #pragma mark -  state change
@@ -291,23 +317,20 @@
 - (void) onStreamStateChange :(NSNotification *)notification{
     NSLog(@"stream State %@", [_streamerBase getCurStreamStateName]);
     _ctrlView.lblStat.text = [_streamerBase getCurStreamStateName];
+    [_reconnector onStreamStateChange];
     if(_streamerBase.streamState == KSYStreamStateError) {
         [self onStreamError:_streamerBase.streamErrorCode];
     }
     else if (_streamerBase.streamState == KSYStreamStateConnecting) {
         [self initStreamStat]; // 尝试开始连接时,重置统计数据
+        [_bwAdapter reset];
     }
 }
 
 - (void) onStreamError:(KSYStreamErrorCode) errCode{
     _ctrlView.lblStat.text  = [_streamerBase getCurKSYStreamErrorCodeName];
-    if (errCode == KSYStreamErrorCode_CONNECT_BREAK) {
-        // Reconnect
-        dispatch_time_t delay = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(1 * NSEC_PER_SEC));
-        dispatch_after(delay, dispatch_get_main_queue(), ^{
-            [_streamerBase startStream:self.hostURL];
-        });
-    }
+    // 网络类的错误按退避时间重连, 网络恢复 (能连上服务器) 后才重新推流
+    [_reconnector retryOnError:errCode];
 }
 - (void) onPipPlayerNotify:(NSNotification *)notification{ // see blk/kit
 }
@@ -342,6 +365,13 @@
         stat.text = [ stat.text  stringByAppendingString:statefps  ];
         stat.text = [ stat.text  stringByAppendingString:statedrop ];
         stat.text = [ stat.text  stringByAppendingString:netEvent  ];
+        if (_bwAdapter) {
+            [_bwAdapter tick];
+            stat.text = [ stat.text  stringByAppendingFormat:@"\n%@", _bwAdapter.statString];
+        }
+        if (_reconnector.stat.retryCnt > 0) {
+            stat.text = [ stat.text  stringByAppendingFormat:@"\n%@", _reconnector.statString];
+        }
     }
     if (_bgmPlayer && _bgmPlayer.bgmPlayerState ==KSYBgmPlayerStatePlaying ) {
         _ksyBgmView.progressV.progress = _bgmPlayer.bgmProcess;
@@ -542,11 +572,28 @@
     int t = (int)_reverbView.reverbType.selectedSegmentIndex;
     if (t == 0){
         _reverb = nil;
+        _roomReverb = nil;
+    }
+    else if (_reverbView.bCustom) {
+        _reverb = nil;
+        _roomReverb = [[KSYAudioRoomReverb alloc] init];
+        [self onReverbSlider:nil];
     }
     else {
+        _roomReverb = nil;
         _reverb = [[ KSYAudioReverb alloc] initWithType:t];
     }
 }
+- (void)onReverbSlider:(KSYNameSlider *)slider{
+    KSYAudioRoomReverb * rv = _roomReverb;
+    if (rv == nil){
+        return;
+    }
+    rv.roomSize   = _reverbView.roomSize.normalValue;
+    rv.damping    = _reverbView.damping.normalValue;
+    rv.wet        = _reverbView.wetLevel.normalValue;
+    rv.preDelayMs = _reverbView.preDelay.slider.value;
+}
 
 #pragma mark - misc features
 - (void)onMiscBtns:(id)sender {
@@ -565,6 +612,72 @@
         [self saveImage: _filter.imageFromCurrentFramebuffer
                      to: @"snap2.png" ];
     }
+    else if (sender == _miscView.btn3) {
+        [self onAudioBench];
+    }
+    else if (sender == _miscView.btn4) {
+        [self onPlayEffect];
+    }
+}
+- (void)onPlayEffect{ // see block
+}
+
+// 只能在设备上运行的性能测试 (纯C模块的测试见 tools/*bench)
+- (void)onAudioBench {
+    // 测试会占满一个核, 采集或推流时结果不可信, 也会影响正在处理的音频
+    if (_capDev.isRunning ||
+        (_streamerBase && _streamerBase.streamState != KSYStreamStateIdle)) {
+        NSLog(@"audio bench: stop capture and streaming first");
+        return;
+    }
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0), ^{
+        [self benchReverb];
+    });
+}
+
+// 对比SDK的各混响预设与自定义混响的速度 (单位: 每个样本的纳秒数)
+// SDK的预设只能在设备上运行; 自定义混响的RT60, 一致性和速度见 tools/fxbench (fxbench -T)
+// 只测当前选中的内核: 内核选择是全局的, 切换会影响其它正在使用的模块, C与SIMD的对比见 fxbench -T
+- (void)benchReverb {
+    const int nbSample = 1024, nbLoop = 2000;
+    const int rate = 44100;
+    int16_t * s16 = malloc(sizeof(int16_t)*nbSample*2);
+    float   * f32 = malloc(sizeof(float)*nbSample*2);
+    for (int i = 0; i < nbSample*2; ++i) {
+        s16[i] = (int16_t)(arc4random() & 0x3fff);
+        f32[i] = s16[i] / 32768.0f;
+    }
+    for (int t = 1; t <= 4; ++t) { // 录影棚, 演唱会, KTV, 小舞台: 仅支持单声道S16
+        KSYAudioReverb * rv = [[KSYAudioReverb alloc] initWithType:t];
+        double t0 = [[NSDate date] timeIntervalSince1970];
+        for (int l = 0; l < nbLoop; ++l) {
+            [rv ReverbWithSrc:s16 nbSample:nbSample];
+        }
+        double dt = [[NSDate date] timeIntervalSince1970] - t0;
+        NSLog(@"reverb preset %d mono s16: %.1f ns/sample", t, dt*1e9/nbSample/nbLoop);
+    }
+    KSYReverbParam param = { 0.8f, 0.5f, 0.3f, 1.0f, 20.0f };
+    KSYAudioFdnReverb * mono   = ksy_fdn_create(rate, 1);
+    KSYAudioFdnReverb * stereo = ksy_fdn_create(rate, 2);
+    ksy_fdn_set_param(mono, &param);
+    ksy_fdn_set_param(stereo, &param);
+    double t0 = [[NSDate date] timeIntervalSince1970];
+    for (int l = 0; l < nbLoop; ++l) {
+        ksy_fdn_process_s16(mono, s16, nbSample);
+    }
+    double dtMono = [[NSDate date] timeIntervalSince1970] - t0;
+    t0 = [[NSDate date] timeIntervalSince1970];
+    for (int l = 0; l < nbLoop; ++l) {
+        ksy_fdn_process_f32(stereo, f32, nbSample/2);
+    }
+    double dtStereo = [[NSDate date] timeIntervalSince1970] - t0;
+    NSLog(@"reverb fdn[%s] mono s16: %.1f ns/sample, stereo f32: %.1f ns/sample",
+          ksy_audio_kernel_name(), dtMono*1e9/nbSample/nbLoop,
+          dtStereo*1e9/nbSample/nbLoop);
+    ksy_fdn_destroy(mono);
+    ksy_fdn_destroy(stereo);
+    free(s16);
+    free(f32);
 }
 
 - (void)onSnapshot:(id)sender {
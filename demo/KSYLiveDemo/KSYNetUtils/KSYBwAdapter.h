@@ -0,0 +1,98 @@
+//
+//  KSYBwAdapter.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "KSYBwEstimator.h"
+#import "KSYVideoLadder.h"
+
+#if USING_DYNAMIC_FRAMEWORK
+#import <libksygpulivedylib/KSYStreamerBase.h>
+#else
+#import <libksygpulive/KSYStreamerBase.h>
+#endif
+
+/** 用可替换的带宽估计 (KSYBwEstimator) 调节推流的视频码率
+
+ 1. 每秒调用一次 tick, 读取推流模块的统计 (已上传的数据量, 编码码率, 丢帧数), 推算发送队列的积压后更新估计
+ 2. 推流模块自身的码率调节不能替换, 这里把视频码率的上限 (videoMaxBitrate) 设为估计的目标码率,
+    推流模块在 [videoMinBitrate, 目标码率] 之间继续调节
+ 3. 推流模块没有给出 RTT 和发送队列的延迟, 只能由计数推算; 有更准确的数据时可以直接调用 ksy_bwc_update
+ 4. 开始推流/重连时调用 reset, 目标码率回到起始码率
+ 5. 可选的分辨率/帧率档位 (KSYVideoLadder): 按目标码率和CPU占用切换, 码率上限不超过当前档位的 maxKbps,
+    档位的应用 (缩放/采集帧率) 由 onRungChange 完成; 推流中改变分辨率时编码器的行为 (是否从关键帧开始) 尚未在设备上验证
+ 6. 在主线程使用
+ */
+@interface KSYBwAdapter : NSObject
+
+/**
+ @abstract  初始化, 码率范围和起始码率取自 streamer 当前的设置 (需要在设置推流参数之后)
+ @param     streamer 推流模块
+ @param     cls      估计器, 如 &ksy_bwe_delay
+ */
+- (instancetype) initWithStreamer:(KSYStreamerBase*)streamer
+                        estimator:(const KSYBwEstimatorClass*)cls;
+
+/**
+ @abstract  估计器的名称
+ */
+@property (nonatomic, readonly) NSString * name;
+
+/**
+ @abstract  设置估计器的参数 (如 KSYBweDelay_HighMs)
+ */
+- (void) setParam:(int)idx value:(float)value;
+
+/**
+ @abstract  重新开始 (开始推流/重连时)
+ */
+- (void) reset;
+
+/**
+ @abstract  输入一次推流模块的统计并应用新的目标码率 (推流中每秒调用一次)
+ @return    视频的目标码率 (kbps)
+ */
+- (int) tick;
+
+#pragma mark - ladder
+/**
+ @abstract  设置分辨率/帧率的档位 (推流开始之前)
+ @param     rungs    档位 (从低到高, 见 ksy_ladder_create)
+ @param     nbRung   档位个数
+ @param     initRung 开始推流/重连时的档位
+ @return    档位不合法时返回NO
+ */
+- (BOOL) setLadder:(const KSYLadderRung*)rungs
+             count:(int)nbRung
+          initRung:(int)initRung;
+
+/**
+ @abstract  切换档位时的回调 (主线程), 需要在这里把推流的画面缩放到新的分辨率和帧率
+ */
+@property (nonatomic, copy) void (^onRungChange)(const KSYLadderRung* rung);
+
+/**
+ @abstract  当前档位, 没有设置档位时为NULL
+ */
+@property (nonatomic, readonly) const KSYLadderRung* rung;
+
+/**
+ @abstract  最近一次采样的CPU占用 (本进程所有线程, 0~1)
+ */
+@property (nonatomic, readonly) float cpuLoad;
+
+/**
+ @abstract  统计信息
+ */
+@property (nonatomic, readonly) KSYBwStat stat;
+
+/**
+ @abstract  统计信息 (一行)
+ */
+@property (nonatomic, readonly) NSString * statString;
+
+@end
@@ -0,0 +1,183 @@
+//
+//  KSYBwAdapter.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <mach/mach.h>
+#import "KSYBwAdapter.h"
+
+#define KSY_BWA_MIN_KBPS  100   // 推流模块没有设置码率下限时使用
+
+@interface KSYBwAdapter () {
+    KSYBwControl *      _ctrl;
+    const char *        _name;
+    int                 _initKbps;
+    int                 _appliedKbps;   // 最近一次写入 videoMaxBitrate 的值
+    KSYVideoLadder *    _ladder;
+    int                 _initRung;
+    int                 _curRung;
+}
+@property (nonatomic, weak) KSYStreamerBase * streamer;
+@end
+
+@implementation KSYBwAdapter
+
+// 编码器的占用拿不到, 用本进程所有线程的CPU占用代替 (按核数归一化)
+static float processCpuLoad(void) {
+    thread_act_array_t      threads;
+    mach_msg_type_number_t  nbThread = 0;
+    if (task_threads(mach_task_self(), &threads, &nbThread) != KERN_SUCCESS) {
+        return -1;
+    }
+    float usage = 0;
+    for (mach_msg_type_number_t i = 0; i < nbThread; ++i) {
+        thread_basic_info_data_t info;
+        mach_msg_type_number_t   cnt = THREAD_BASIC_INFO_COUNT;
+        if (thread_info(threads[i], THREAD_BASIC_INFO, (thread_info_t)&info, &cnt) == KERN_SUCCESS &&
+            !(info.flags & TH_FLAGS_IDLE)) {
+            usage += info.cpu_usage / (float)TH_USAGE_SCALE;
+        }
+        mach_port_deallocate(mach_task_self(), threads[i]);
+    }
+    vm_deallocate(mach_task_self(), (vm_address_t)threads, sizeof(thread_t) * nbThread);
+    NSUInteger nbCore = [[NSProcessInfo processInfo] activeProcessorCount];
+    return usage / (nbCore ? nbCore : 1);
+}
+
+- (instancetype) initWithStreamer:(KSYStreamerBase*)streamer
+                        estimator:(const KSYBwEstimatorClass*)cls {
+    self = [super init];
+    if (self == nil || streamer == nil || cls == NULL) {
+        return nil;
+    }
+    int maxKbps = streamer.videoMaxBitrate;
+    int minKbps = streamer.videoMinBitrate;
+    if (minKbps <= 0) {
+        minKbps = MIN(KSY_BWA_MIN_KBPS, maxKbps);
+    }
+    _initKbps = streamer.videoInitBitrate > 0 ? streamer.videoInitBitrate : maxKbps;
+    _ctrl = ksy_bwc_create(cls, minKbps, maxKbps, _initKbps, streamer.audiokBPS);
+    if (_ctrl == NULL) {
+        return nil;
+    }
+    _name        = cls->name;
+    _appliedKbps = maxKbps;
+    _streamer    = streamer;
+    return self;
+}
+
+- (void) dealloc {
+    ksy_bwc_destroy(_ctrl);
+    ksy_ladder_destroy(_ladder);
+}
+
+- (NSString*) name {
+    return [NSString stringWithUTF8String:_name];
+}
+
+- (void) setParam:(int)idx value:(float)value {
+    ksy_bwc_set_param(_ctrl, idx, value);
+}
+
+- (void) reset {
+    ksy_bwc_reset(_ctrl, _initKbps);
+    ksy_ladder_reset(_ladder, _initRung);
+    [self applyRung];
+    [self applyTarget];
+}
+
+- (void) applyTarget {
+    KSYBwStat st;
+    ksy_bwc_get_stat(_ctrl, &st);
+    int kbps = st.targetKbps;
+    const KSYLadderRung * r = self.rung;
+    if (r && kbps > r->maxKbps) {
+        kbps = r->maxKbps; // 低分辨率用不了太高的码率
+    }
+    if (kbps != _appliedKbps) {
+        // 推流模块的码率调节以 videoMaxBitrate 为上限
+        _streamer.videoMaxBitrate = kbps;
+        _appliedKbps = kbps;
+    }
+}
+
+- (void) applyRung {
+    KSYLadderStat st;
+    if (_ladder == NULL) {
+        return;
+    }
+    ksy_ladder_get_stat(_ladder, &st);
+    if (st.rung != _curRung) {
+        _curRung = st.rung;
+        if (_onRungChange) {
+            _onRungChange(ksy_ladder_rung(_ladder, _curRung));
+        }
+    }
+}
+
+- (int) tick {
+    KSYStreamerBase * streamer = _streamer;
+    if (streamer == nil || streamer.streamState != KSYStreamStateConnected) {
+        return self.stat.targetKbps;
+    }
+    float offered = streamer.encodeAKbps + streamer.encodeVKbps;
+    double tMs = [[NSDate date] timeIntervalSince1970] * 1000;
+    int target = ksy_bwc_feed(_ctrl, tMs, streamer.uploadedKByte, offered,
+                              streamer.droppedVideoFrames, 0);
+    if (_ladder) {
+        _cpuLoad = processCpuLoad();
+        ksy_ladder_update(_ladder, tMs, target, _cpuLoad);
+        [self applyRung];
+    }
+    [self applyTarget];
+    return target;
+}
+
+#pragma mark - ladder
+- (BOOL) setLadder:(const KSYLadderRung*)rungs
+             count:(int)nbRung
+          initRung:(int)initRung {
+    KSYVideoLadder * ladder = ksy_ladder_create(rungs, nbRung, initRung);
+    if (ladder == NULL) {
+        return NO;
+    }
+    ksy_ladder_destroy(_ladder);
+    _ladder = ladder;
+    KSYLadderStat st;
+    ksy_ladder_get_stat(_ladder, &st);
+    _initRung = st.rung;
+    _curRung  = st.rung;
+    [self applyTarget];
+    return YES;
+}
+
+- (const KSYLadderRung*) rung {
+    return _ladder ? ksy_ladder_rung(_ladder, _curRung) : NULL;
+}
+
+- (KSYBwStat) stat {
+    KSYBwStat st;
+    ksy_bwc_get_stat(_ctrl, &st);
+    return st;
+}
+
+- (NSString*) statString {
+    KSYBwStat st = self.stat;
+    NSString * str = [NSString stringWithFormat:@"码率估计 %s 目标%dkbps 估计%.0f 吞吐%.0f 积压%.0fms | %d raise | %d drop",
+                      _name, st.targetKbps, st.estimateKbps, st.sentKbps,
+                      st.queueDelayMs, st.raiseCnt, st.dropCnt];
+    const KSYLadderRung * r = self.rung;
+    if (r) {
+        KSYLadderStat ls;
+        ksy_ladder_get_stat(_ladder, &ls);
+        str = [str stringByAppendingFormat:@"\n档位 %dx%d@%d CPU %.0f%% | 升%d 降%d (CPU %d)",
+               r->width, r->height, r->fps, _cpuLoad * 100,
+               ls.upCnt, ls.bwDownCnt + ls.cpuDownCnt, ls.cpuDownCnt];
+    }
+    return str;
+}
+
+@end
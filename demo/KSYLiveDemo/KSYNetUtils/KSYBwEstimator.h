@@ -0,0 +1,159 @@
+//
+//  KSYBwEstimator.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** 可替换的带宽估计 (推流码率自适应)
+
+ 1. 每个估计器实现一组函数 (KSYBwEstimatorClass), 根据网络采样给出可用的总码率 (音频+视频)
+ 2. 采样包括: 实际发出的码率 (吞吐), 编码输出的码率, 发送队列的延迟, RTT, 发送端丢帧
+ 3. 控制器 (KSYBwControl) 扣除音频码率, 把结果限制在 [min, max] 内作为视频的目标码率
+ 4. 只有累计计数时 (如 KSYStreamerBase 的 uploadedKByte), 用 ksy_bwc_feed 由编码和发送的差推算队列积压
+ 5. 内置两种: AIMD (丢帧/积压严重时降低, 否则缓慢上调, 与SDK内置的调节方式类似) 和
+    延迟梯度 (队列延迟的变化趋势判断拥塞, 按实测吞吐降低, 窗口内最大吞吐限制上调)
+ 6. 与平台无关, 不加锁, 在同一个线程调用; 可以用带宽轨迹离线仿真 (见 tools/bwsim)
+ */
+
+/// 估计器的最大参数个数
+#define KSY_BWE_MAX_PARAM  8
+
+/// 一次网络采样 (一个统计区间)
+typedef struct {
+    /// 采样时间 (毫秒)
+    double  tMs;
+    /// 区间长度 (毫秒)
+    float   intervalMs;
+    /// 区间内实际发出的码率 (kbps)
+    float   sentKbps;
+    /// 区间内编码器输出的码率 (kbps, 音频+视频)
+    float   offeredKbps;
+    /// 发送队列的延迟 (毫秒), <0 表示未知
+    float   queueDelayMs;
+    /// 往返时间 (毫秒), <=0 表示未知
+    float   rttMs;
+    /// 区间内发送端丢弃的帧数
+    int     droppedFrames;
+} KSYBwSample;
+
+/// 估计器的实现
+typedef struct {
+    /// 名称
+    const char *  name;
+    /// 参数个数 (不超过 KSY_BWE_MAX_PARAM)
+    int           nbParam;
+    /// 各参数的默认值
+    const float * defParam;
+    /// 创建实例
+    void* (*create)   (void);
+    /// 销毁实例
+    void  (*destroy)  (void* ctx);
+    /// 设置第idx个参数
+    void  (*set_param)(void* ctx, int idx, float value);
+    /// 重新开始 (开始推流/重连), initKbps 为起始的总码率
+    void  (*reset)    (void* ctx, float initKbps);
+    /// 根据新的采样给出可用的总码率 (kbps); curKbps 为当前的总目标码率
+    float (*update)   (void* ctx, const KSYBwSample* s, float curKbps);
+} KSYBwEstimatorClass;
+
+#pragma mark - AIMD
+/// AIMD: 丢帧或积压超过门限时乘性降低, 一段时间没有拥塞后按比例上调
+typedef NS_ENUM(int, KSYBweAimdParam) {
+    /// 每秒上调的比例, 默认0.05
+    KSYBweAimd_IncRatio = 0,
+    /// 降低时乘的系数, 默认0.75
+    KSYBweAimd_DecRatio,
+    /// 视为拥塞的队列延迟 (毫秒), 默认1000
+    KSYBweAimd_HighMs,
+    /// 降低后多久才能上调 (毫秒), 默认3000
+    KSYBweAimd_HoldMs,
+    KSYBweAimd_NbParam
+};
+extern const KSYBwEstimatorClass ksy_bwe_aimd;
+
+#pragma mark - 延迟梯度
+/// 延迟梯度 (类似GCC的趋势线 + 自适应门限, 类似BBR用窗口内最大吞吐作为瓶颈带宽的估计)
+typedef NS_ENUM(int, KSYBweDelayParam) {
+    /// 拥塞时按实测吞吐降低的系数, 默认0.85
+    KSYBweDelay_Beta = 0,
+    /// 远离上次拥塞点时每秒上调的比例, 默认0.08
+    KSYBweDelay_IncRatio,
+    /// 接近上次拥塞点时每秒上调的码率 (kbps), 默认40
+    KSYBweDelay_AddKbps,
+    /// 不论趋势, 队列延迟超过此值即视为拥塞 (毫秒), 默认400
+    KSYBweDelay_HighMs,
+    /// 拥塞后希望排空到的队列延迟 (毫秒), 默认150
+    KSYBweDelay_TargetMs,
+    /// 瓶颈带宽估计的窗口 (毫秒), 默认10000
+    KSYBweDelay_WindowMs,
+    KSYBweDelay_NbParam
+};
+extern const KSYBwEstimatorClass ksy_bwe_delay;
+
+#pragma mark - 控制器
+typedef struct _KSYBwControl KSYBwControl;
+
+/// 控制器的统计
+typedef struct {
+    /// 视频的目标码率 (kbps)
+    int     targetKbps;
+    /// 估计器最近一次给出的总码率 (kbps)
+    float   estimateKbps;
+    /// 最近一次采样的吞吐和队列延迟
+    float   sentKbps;
+    float   queueDelayMs;
+    /// 目标码率上调/下调的次数
+    int     raiseCnt;
+    int     dropCnt;
+} KSYBwStat;
+
+/**
+ @abstract  创建
+ @param     cls       估计器
+ @param     minKbps   视频码率下限
+ @param     maxKbps   视频码率上限
+ @param     initKbps  视频的起始码率
+ @param     audioKbps 音频码率 (从估计的总码率中扣除)
+ */
+KSYBwControl* ksy_bwc_create(const KSYBwEstimatorClass* cls, int minKbps, int maxKbps,
+                             int initKbps, int audioKbps);
+
+void ksy_bwc_destroy(KSYBwControl* c);
+
+/**
+ @abstract  设置估计器的第idx个参数
+ */
+void ksy_bwc_set_param(KSYBwControl* c, int idx, float value);
+
+/**
+ @abstract  重新开始 (开始推流/重连), 目标码率回到 initKbps
+ */
+void ksy_bwc_reset(KSYBwControl* c, int initKbps);
+
+/**
+ @abstract  输入一次采样
+ @return    视频的目标码率 (kbps, 在 [min, max] 内)
+ */
+int ksy_bwc_update(KSYBwControl* c, const KSYBwSample* s);
+
+/**
+ @abstract  只有累计计数时输入 (如每秒读取一次推流模块的统计)
+ @param     tMs         当前时间 (毫秒)
+ @param     sentKByte   累计发出的数据量 (KB)
+ @param     offeredKbps 编码器当前的输出码率 (kbps, 音频+视频)
+ @param     droppedCnt  累计丢弃的帧数
+ @param     rttMs       往返时间, <=0 表示未知
+ @discussion 队列积压按 (编码输出 - 实际发出) 累计推算, 发出大于编码时视为已排空; 第一次调用只记录计数
+ @return    视频的目标码率 (kbps)
+ */
+int ksy_bwc_feed(KSYBwControl* c, double tMs, int64_t sentKByte, float offeredKbps,
+                 int droppedCnt, float rttMs);
+
+/**
+ @abstract  统计信息
+ */
+void ksy_bwc_get_stat(const KSYBwControl* c, KSYBwStat* stat);
@@ -0,0 +1,352 @@
+//
+//  KSYBwEstimator.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYBwEstimator.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TREND_WIN       8       // 趋势线的采样个数
+#define MAXBW_WIN       64      // 瓶颈带宽窗口最多保存的采样个数
+#define DRAIN_SEC       2.0f    // 拥塞后排空积压的时间
+#define FEED_DEADZONE   0.05f   // 推算积压时忽略的编码/发出码率的相对差
+#define FEED_DECAY_SEC  10.0f   // 推算的积压的衰减时间常数
+
+static float clampf(float v, float lo, float hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+static float intervalSec(const KSYBwSample* s) {
+    return s->intervalMs > 0 ? s->intervalMs / 1000.0f : 1.0f;
+}
+
+#pragma mark - AIMD
+typedef struct {
+    float   param[KSYBweAimd_NbParam];
+    double  holdUntil;  // 此前不上调 (毫秒)
+} AimdCtx;
+
+static const float s_aimdDef[KSYBweAimd_NbParam] = { 0.05f, 0.75f, 1000, 3000 };
+
+static void* aimdCreate(void) {
+    AimdCtx * a = calloc(1, sizeof(AimdCtx));
+    if (a) {
+        memcpy(a->param, s_aimdDef, sizeof(s_aimdDef));
+    }
+    return a;
+}
+
+static void aimdSetParam(void* ctx, int idx, float value) {
+    AimdCtx * a = ctx;
+    if (idx >= 0 && idx < KSYBweAimd_NbParam) {
+        a->param[idx] = value;
+    }
+}
+
+static void aimdReset(void* ctx, float initKbps) {
+    AimdCtx * a = ctx;
+    (void)initKbps;
+    a->holdUntil = 0;
+}
+
+static float aimdUpdate(void* ctx, const KSYBwSample* s, float curKbps) {
+    AimdCtx * a = ctx;
+    BOOL bCongest = s->droppedFrames > 0 ||
+                    (s->queueDelayMs >= 0 && s->queueDelayMs > a->param[KSYBweAimd_HighMs]);
+    if (s->tMs < a->holdUntil) {
+        return curKbps; // 上次调整的效果还没体现出来
+    }
+    if (bCongest) {
+        a->holdUntil = s->tMs + a->param[KSYBweAimd_HoldMs];
+        return curKbps * a->param[KSYBweAimd_DecRatio];
+    }
+    return curKbps * (1 + a->param[KSYBweAimd_IncRatio] * intervalSec(s));
+}
+
+const KSYBwEstimatorClass ksy_bwe_aimd = {
+    "aimd", KSYBweAimd_NbParam, s_aimdDef, aimdCreate, free, aimdSetParam, aimdReset, aimdUpdate
+};
+
+#pragma mark - delay gradient
+typedef struct {
+    float   param[KSYBweDelay_NbParam];
+    BOOL    bFirst;
+    float   smooth;             // 平滑的队列延迟 (毫秒)
+    double  winT[TREND_WIN];    // 趋势线的采样 (秒, 毫秒)
+    float   winD[TREND_WIN];
+    int     winCnt;
+    int     winPos;
+    float   thr;                // 自适应门限 (毫秒/秒)
+    float   lastDecKbps;        // 上次拥塞时的吞吐, <=0 表示没有
+    float   minRtt;
+    double  bwT[MAXBW_WIN];     // 瓶颈带宽窗口: 采样时间和吞吐
+    float   bwK[MAXBW_WIN];
+    int     bwCnt;
+    int     bwPos;
+    float   trend;              // 最近的趋势 (毫秒/秒), 用于调试
+} DelayCtx;
+
+static const float s_delayDef[KSYBweDelay_NbParam] = { 0.85f, 0.08f, 40, 400, 150, 10000 };
+
+static void delayReset(void* ctx, float initKbps) {
+    DelayCtx * d = ctx;
+    (void)initKbps;
+    d->bFirst      = YES;
+    d->smooth      = 0;
+    d->winCnt      = 0;
+    d->winPos      = 0;
+    d->thr         = 60;
+    d->lastDecKbps = 0;
+    d->minRtt      = 0;
+    d->bwCnt       = 0;
+    d->bwPos       = 0;
+    d->trend       = 0;
+}
+
+static void* delayCreate(void) {
+    DelayCtx * d = calloc(1, sizeof(DelayCtx));
+    if (d) {
+        memcpy(d->param, s_delayDef, sizeof(s_delayDef));
+        delayReset(d, 0);
+    }
+    return d;
+}
+
+static void delaySetParam(void* ctx, int idx, float value) {
+    DelayCtx * d = ctx;
+    if (idx >= 0 && idx < KSYBweDelay_NbParam) {
+        d->param[idx] = value;
+    }
+}
+
+// 窗口内 (时间, 平滑延迟) 的最小二乘斜率
+static float trendSlope(const DelayCtx* d) {
+    if (d->winCnt < 2) {
+        return 0;
+    }
+    double mt = 0, md = 0;
+    for (int i = 0; i < d->winCnt; ++i) {
+        mt += d->winT[i];
+        md += d->winD[i];
+    }
+    mt /= d->winCnt;
+    md /= d->winCnt;
+    double num = 0, den = 0;
+    for (int i = 0; i < d->winCnt; ++i) {
+        num += (d->winT[i] - mt) * (d->winD[i] - md);
+        den += (d->winT[i] - mt) * (d->winT[i] - mt);
+    }
+    return den > 0 ? (float)(num / den) : 0;
+}
+
+// 窗口内的最大吞吐
+static float maxSent(DelayCtx* d, double tMs, float sentKbps) {
+    d->bwT[d->bwPos] = tMs;
+    d->bwK[d->bwPos] = sentKbps;
+    d->bwPos = (d->bwPos + 1) % MAXBW_WIN;
+    d->bwCnt = d->bwCnt < MAXBW_WIN ? d->bwCnt + 1 : MAXBW_WIN;
+    float m = 0;
+    for (int i = 0; i < d->bwCnt; ++i) {
+        if (tMs - d->bwT[i] <= d->param[KSYBweDelay_WindowMs] && d->bwK[i] > m) {
+            m = d->bwK[i];
+        }
+    }
+    return m;
+}
+
+static float delayUpdate(void* ctx, const KSYBwSample* s, float curKbps) {
+    DelayCtx * d  = ctx;
+    float      dt = intervalSec(s);
+    float      qd = s->queueDelayMs;
+    if (qd < 0 && s->rttMs > 0) { // 没有队列延迟时用 RTT 的增加量
+        d->minRtt = (d->minRtt <= 0 || s->rttMs < d->minRtt) ? s->rttMs : d->minRtt;
+        qd = s->rttMs - d->minRtt;
+    }
+    BOOL bDelay = qd >= 0;
+    qd = bDelay ? qd : 0;
+    // 采样间隔较长 (如每秒一次), 平滑比GCC的0.9轻
+    d->smooth = d->bFirst ? qd : 0.6f * d->smooth + 0.4f * qd;
+    d->bFirst = NO;
+    d->winT[d->winPos] = s->tMs / 1000.0;
+    d->winD[d->winPos] = d->smooth;
+    d->winPos = (d->winPos + 1) % TREND_WIN;
+    d->winCnt = d->winCnt < TREND_WIN ? d->winCnt + 1 : TREND_WIN;
+    float trend = bDelay ? trendSlope(d) * d->winCnt / TREND_WIN : 0;
+    d->trend = trend;
+    // 自适应门限: 趋势大于门限时缓慢升高, 小于时较快降低, 离群值不参与
+    float diff = fabsf(trend) - d->thr;
+    if (diff < 150) {
+        float k = diff > 0 ? 0.1f : 0.4f;
+        d->thr = clampf(d->thr + k * clampf(dt, 0, 1) * diff, 20, 1000);
+    }
+    float bwMax = maxSent(d, s->tMs, s->sentKbps);
+    // 队列在排空时即使延迟还高也不再降低, 避免按已经降低的吞吐反复降低
+    BOOL bUnder = trend < -d->thr;
+    BOOL bOver  = (trend > d->thr && d->smooth > 30) || s->droppedFrames > 0 ||
+                  (!bUnder && qd > d->param[KSYBweDelay_HighMs]);
+    float est = curKbps;
+    if (bOver) {
+        // 按实测吞吐降低, 另外留出余量在 DRAIN_SEC 内把积压排空到 TargetMs
+        float extra = fmaxf(qd - d->param[KSYBweDelay_TargetMs], 0) / 1000 / DRAIN_SEC;
+        float ratio = fmaxf(d->param[KSYBweDelay_Beta] - extra, 0.5f);
+        if (s->sentKbps > 1) {
+            est = fminf(curKbps, ratio * s->sentKbps);
+        }
+        d->lastDecKbps = s->sentKbps;
+    }
+    else if (!bUnder) { // 队列在排空时保持
+        if (d->lastDecKbps > 0 && curKbps > 1.15f * d->lastDecKbps) {
+            d->lastDecKbps = 0; // 已经越过上次的拥塞点, 带宽可能变大了
+        }
+        // 从下方接近上次的拥塞点时线性上调, 远离时按比例上调
+        BOOL bNear = d->lastDecKbps > 0 && curKbps > 0.85f * d->lastDecKbps;
+        if (bNear) {
+            est = curKbps + d->param[KSYBweDelay_AddKbps] * dt;
+        }
+        else {
+            est = curKbps * powf(1 + d->param[KSYBweDelay_IncRatio], dt);
+        }
+        // 吞吐的尖峰不会带来跳变: 上调的速度有限, 且不超过窗口内最大吞吐的1.5倍
+        float cap = bwMax * 1.5f + d->param[KSYBweDelay_AddKbps];
+        est = fminf(est, fmaxf(curKbps, cap));
+    }
+    return est;
+}
+
+const KSYBwEstimatorClass ksy_bwe_delay = {
+    "delay", KSYBweDelay_NbParam, s_delayDef, delayCreate, free, delaySetParam, delayReset, delayUpdate
+};
+
+#pragma mark - control
+struct _KSYBwControl {
+    const KSYBwEstimatorClass * cls;
+    void *      ctx;
+    int         minKbps;
+    int         maxKbps;
+    int         audioKbps;
+    KSYBwStat   stat;
+    // ksy_bwc_feed
+    BOOL        bFed;
+    double      lastT;
+    int64_t     lastKByte;
+    int         lastDrop;
+    float       backlogKbit;    // 推算的发送队列积压
+};
+
+KSYBwControl* ksy_bwc_create(const KSYBwEstimatorClass* cls, int minKbps, int maxKbps,
+                             int initKbps, int audioKbps) {
+    if (cls == NULL || minKbps < 0 || maxKbps <= 0 || minKbps > maxKbps) {
+        return NULL;
+    }
+    KSYBwControl * c = calloc(1, sizeof(KSYBwControl));
+    if (c == NULL) {
+        return NULL;
+    }
+    c->cls = cls;
+    c->ctx = cls->create();
+    if (c->ctx == NULL) {
+        free(c);
+        return NULL;
+    }
+    c->minKbps   = minKbps;
+    c->maxKbps   = maxKbps;
+    c->audioKbps = audioKbps > 0 ? audioKbps : 0;
+    ksy_bwc_reset(c, initKbps);
+    return c;
+}
+
+void ksy_bwc_destroy(KSYBwControl* c) {
+    if (c) {
+        c->cls->destroy(c->ctx);
+        free(c);
+    }
+}
+
+void ksy_bwc_set_param(KSYBwControl* c, int idx, float value) {
+    if (c) {
+        c->cls->set_param(c->ctx, idx, value);
+    }
+}
+
+void ksy_bwc_reset(KSYBwControl* c, int initKbps) {
+    if (c == NULL) {
+        return;
+    }
+    int target = (int)clampf(initKbps, c->minKbps, c->maxKbps);
+    memset(&c->stat, 0, sizeof(c->stat));
+    c->stat.targetKbps   = target;
+    c->stat.estimateKbps = target + c->audioKbps;
+    c->stat.queueDelayMs = -1;
+    c->bFed        = NO;
+    c->backlogKbit = 0;
+    c->cls->reset(c->ctx, target + c->audioKbps);
+}
+
+int ksy_bwc_update(KSYBwControl* c, const KSYBwSample* s) {
+    if (c == NULL || s == NULL) {
+        return 0;
+    }
+    float total = c->cls->update(c->ctx, s, c->stat.targetKbps + c->audioKbps);
+    int   prev  = c->stat.targetKbps;
+    int   video = (int)lrintf(clampf(total - c->audioKbps, c->minKbps, c->maxKbps));
+    c->stat.estimateKbps = total;
+    c->stat.sentKbps     = s->sentKbps;
+    c->stat.queueDelayMs = s->queueDelayMs;
+    c->stat.targetKbps   = video;
+    c->stat.raiseCnt    += video > prev;
+    c->stat.dropCnt     += video < prev;
+    return video;
+}
+
+int ksy_bwc_feed(KSYBwControl* c, double tMs, int64_t sentKByte, float offeredKbps,
+                 int droppedCnt, float rttMs) {
+    if (c == NULL) {
+        return 0;
+    }
+    if (!c->bFed || tMs <= c->lastT) {
+        if (!c->bFed) {
+            c->bFed      = YES;
+            c->lastT     = tMs;
+            c->lastKByte = sentKByte;
+            c->lastDrop  = droppedCnt;
+        }
+        return c->stat.targetKbps;
+    }
+    KSYBwSample s = {0};
+    s.tMs           = tMs;
+    s.intervalMs    = (float)(tMs - c->lastT);
+    s.sentKbps      = (float)((sentKByte - c->lastKByte) * 8 * 1000 / (tMs - c->lastT));
+    s.offeredKbps   = offeredKbps;
+    s.rttMs         = rttMs;
+    s.droppedFrames = droppedCnt - c->lastDrop;
+    // 编码比发出的多的部分积压在发送队列中; 两个计数的口径 (协议开销, KB的定义) 不完全一致,
+    // 差别在 FEED_DEADZONE 以内时不计入, 并且积压随时间衰减, 避免误差累积
+    float dt     = s.intervalMs / 1000;
+    float excess = offeredKbps - s.sentKbps;
+    if (excess > 0 && excess < offeredKbps * FEED_DEADZONE) {
+        excess = 0;
+    }
+    c->backlogKbit += excess * dt;
+    c->backlogKbit *= expf(-dt / FEED_DECAY_SEC);
+    c->backlogKbit  = c->backlogKbit > 0 ? c->backlogKbit : 0;
+    if (s.droppedFrames > 0) { // 丢帧时积压的大小未知, 按减半估计
+        c->backlogKbit *= 0.5f;
+    }
+    s.queueDelayMs  = s.sentKbps > 1 ? c->backlogKbit / s.sentKbps * 1000
+                                     : (c->backlogKbit > 0 ? 10000 : 0);
+    c->lastT     = tMs;
+    c->lastKByte = sentKByte;
+    c->lastDrop  = droppedCnt;
+    return ksy_bwc_update(c, &s);
+}
+
+void ksy_bwc_get_stat(const KSYBwControl* c, KSYBwStat* stat) {
+    if (c && stat) {
+        *stat = c->stat;
+    }
+}
@@ -0,0 +1,122 @@
+//
+//  KSYReconnect.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** 断线重连的基础部件 (与平台无关的C接口)
+
+ 1. 地址缓存 (KSYHostCache): 域名解析的结果和推流成功时的服务器IP, 按 TTL 过期;
+    DNS失败时可以继续使用过期的地址
+ 2. 并行连接 (ksy_tcp_race): 对多个地址错开发起TCP连接, 返回最先连上的地址, 用于选择服务器和判断网络是否恢复
+ 3. 重连策略 (KSYReconnPolicy): 指数退避加随机抖动, 连接稳定一段时间后退避复位, 可以限制连续失败的次数
+ 4. 地址缓存可以在任意线程使用 (内部加锁); 重连策略不加锁, 在同一个线程调用
+ 5. 可以用本地的TCP服务/代理离线测试 (见 tools/reconnbench)
+ */
+
+/// 地址字符串的最大长度 (含IPv6)
+#define KSY_IP_LEN      64
+/// 每个域名最多缓存的地址个数
+#define KSY_HOST_MAX_IP 8
+
+#pragma mark - 地址缓存
+typedef struct _KSYHostCache KSYHostCache;
+
+/**
+ @abstract  创建
+ @param     ttlMs  地址的有效时间 (毫秒)
+ */
+KSYHostCache* ksy_hostcache_create(int ttlMs);
+
+void ksy_hostcache_destroy(KSYHostCache* c);
+
+/**
+ @abstract  解析域名并更新缓存 (阻塞, 在后台线程调用); host 为IP时直接缓存
+ @return    解析到的地址个数, 失败返回-1 (原有的缓存保留)
+ */
+int ksy_hostcache_resolve(KSYHostCache* c, const char* host, double nowMs);
+
+/**
+ @abstract  记录一个可用的地址 (如推流成功时的服务器IP), 放在最前面, 刷新有效时间
+ */
+void ksy_hostcache_add(KSYHostCache* c, const char* host, const char* ip, double nowMs);
+
+/**
+ @abstract  取出缓存的地址 (可用的在前)
+ @param     bAllowStale 是否返回已过期的地址
+ @return    地址个数, 没有 (或已过期) 时返回0
+ */
+int ksy_hostcache_get(KSYHostCache* c, const char* host, double nowMs, BOOL bAllowStale,
+                      char ips[][KSY_IP_LEN], int maxNb);
+
+#pragma mark - 并行连接
+/**
+ @abstract  对多个地址发起TCP连接, 每隔 staggerMs 增加一个 (前一个失败时立即开始下一个)
+ @param     ips       地址 (IPv4/IPv6)
+ @param     nb        地址个数
+ @param     port      端口
+ @param     timeoutMs 总的超时时间
+ @param     staggerMs 相邻两次发起连接的间隔
+ @param     connMs    连上时的耗时 (可以为NULL)
+ @return    最先连上的地址的下标, 都失败或超时返回-1 (所有连接在返回前关闭)
+ */
+int ksy_tcp_race(const char ips[][KSY_IP_LEN], int nb, int port,
+                 int timeoutMs, int staggerMs, float* connMs);
+
+#pragma mark - 重连策略
+typedef NS_ENUM(int, KSYReconnParam) {
+    /// 第一次重试前的等待 (毫秒), 默认300
+    KSYReconn_InitDelayMs = 0,
+    /// 最长的等待 (毫秒), 默认8000
+    KSYReconn_MaxDelayMs,
+    /// 随机抖动的比例 (等待时间 ±), 默认0.2
+    KSYReconn_Jitter,
+    /// 连接保持多久后退避复位 (毫秒), 默认10000
+    KSYReconn_StableMs,
+    /// 连续失败多少次后放弃, 0为不限, 默认0
+    KSYReconn_MaxRetry,
+    KSYReconn_NbParam
+};
+
+/// 重连的统计
+typedef struct {
+    /// 连续失败的次数 (连接稳定后清0)
+    int     failCnt;
+    /// 累计的重连次数/成功的次数
+    int     retryCnt;
+    int     successCnt;
+    /// 最近一次断开到重新连上的时间 (毫秒)
+    float   lastOutageMs;
+    /// 最近一次的等待时间 (毫秒)
+    float   lastDelayMs;
+} KSYReconnStat;
+
+typedef struct _KSYReconnPolicy KSYReconnPolicy;
+
+KSYReconnPolicy* ksy_reconn_create(uint32_t seed);
+
+void ksy_reconn_destroy(KSYReconnPolicy* p);
+
+void ksy_reconn_set_param(KSYReconnPolicy* p, int idx, float value);
+
+/**
+ @abstract  连接成功
+ */
+void ksy_reconn_on_connected(KSYReconnPolicy* p, double nowMs);
+
+/**
+ @abstract  连接断开或一次重试失败
+ @return    下次重试前的等待时间 (毫秒), 放弃时返回-1
+ */
+int ksy_reconn_on_failure(KSYReconnPolicy* p, double nowMs);
+
+/**
+ @abstract  停止重连 (用户停止推流), 下次失败时从头开始
+ */
+void ksy_reconn_reset(KSYReconnPolicy* p);
+
+void ksy_reconn_get_stat(const KSYReconnPolicy* p, KSYReconnStat* stat);
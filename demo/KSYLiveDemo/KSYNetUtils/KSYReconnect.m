@@ -0,0 +1,385 @@
+//
+//  KSYReconnect.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYReconnect.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#define HOST_LEN        256
+#define MAX_HOST        8   // 缓存的域名个数
+
+static double monoMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+#pragma mark - host cache
+typedef struct {
+    char    host[HOST_LEN];
+    int     nb;
+    char    ips[KSY_HOST_MAX_IP][KSY_IP_LEN];
+    double  expire[KSY_HOST_MAX_IP];
+    double  lastUse;
+} HostEntry;
+
+struct _KSYHostCache {
+    pthread_mutex_t lock;
+    int             ttlMs;
+    HostEntry       hosts[MAX_HOST];
+};
+
+KSYHostCache* ksy_hostcache_create(int ttlMs) {
+    KSYHostCache * c = calloc(1, sizeof(KSYHostCache));
+    if (c == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&c->lock, NULL);
+    c->ttlMs = ttlMs > 0 ? ttlMs : 0;
+    return c;
+}
+
+void ksy_hostcache_destroy(KSYHostCache* c) {
+    if (c) {
+        pthread_mutex_destroy(&c->lock);
+        free(c);
+    }
+}
+
+// 查找域名, bCreate 时没有则占用最久未用的一项 (已加锁)
+static HostEntry* findHost(KSYHostCache* c, const char* host, BOOL bCreate, double nowMs) {
+    HostEntry * lru = c->hosts;
+    for (int i = 0; i < MAX_HOST; ++i) {
+        HostEntry * e = c->hosts + i;
+        if (e->host[0] && strcmp(e->host, host) == 0) {
+            e->lastUse = nowMs;
+            return e;
+        }
+        if (!e->host[0] || (lru->host[0] && e->lastUse < lru->lastUse)) {
+            lru = e;
+        }
+    }
+    if (!bCreate || strlen(host) >= HOST_LEN) {
+        return NULL;
+    }
+    memset(lru, 0, sizeof(HostEntry));
+    strcpy(lru->host, host);
+    lru->lastUse = nowMs;
+    return lru;
+}
+
+static int findIp(const HostEntry* e, const char* ip) {
+    for (int i = 0; i < e->nb; ++i) {
+        if (strcmp(e->ips[i], ip) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 把地址放到第pos个位置 (已有的移动过去, 没有的插入, 满时丢掉最后一个)
+static void placeIp(HostEntry* e, const char* ip, double expire, int pos) {
+    int idx = findIp(e, ip);
+    if (idx < 0) {
+        idx = e->nb < KSY_HOST_MAX_IP ? e->nb++ : KSY_HOST_MAX_IP - 1;
+    }
+    pos = pos < idx ? pos : idx;
+    memmove(e->ips + pos + 1, e->ips + pos, sizeof(e->ips[0]) * (idx - pos));
+    memmove(e->expire + pos + 1, e->expire + pos, sizeof(e->expire[0]) * (idx - pos));
+    snprintf(e->ips[pos], KSY_IP_LEN, "%s", ip);
+    e->expire[pos] = expire;
+}
+
+int ksy_hostcache_resolve(KSYHostCache* c, const char* host, double nowMs) {
+    if (c == NULL || host == NULL || host[0] == 0) {
+        return -1;
+    }
+    struct addrinfo hints, *res = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, NULL, &hints, &res) != 0 || res == NULL) {
+        return -1;
+    }
+    char   ips[KSY_HOST_MAX_IP][KSY_IP_LEN];
+    int    nb = 0;
+    for (struct addrinfo * ai = res; ai && nb < KSY_HOST_MAX_IP; ai = ai->ai_next) {
+        const void * addr = NULL;
+        if (ai->ai_family == AF_INET) {
+            addr = &((struct sockaddr_in*)ai->ai_addr)->sin_addr;
+        }
+        else if (ai->ai_family == AF_INET6) {
+            addr = &((struct sockaddr_in6*)ai->ai_addr)->sin6_addr;
+        }
+        if (addr && inet_ntop(ai->ai_family, addr, ips[nb], KSY_IP_LEN)) {
+            BOOL bDup = NO;
+            for (int i = 0; i < nb; ++i) {
+                bDup |= strcmp(ips[i], ips[nb]) == 0;
+            }
+            nb += !bDup;
+        }
+    }
+    freeaddrinfo(res);
+    if (nb == 0) {
+        return -1;
+    }
+    pthread_mutex_lock(&c->lock);
+    HostEntry * e = findHost(c, host, YES, nowMs);
+    if (e) {
+        // 解析结果替换原有的地址, 但之前用过的地址 (第一个) 仍在结果中时保持在最前
+        char prefer[KSY_IP_LEN];
+        snprintf(prefer, sizeof(prefer), "%s", e->nb ? e->ips[0] : "");
+        e->nb = 0;
+        for (int i = 0; i < nb; ++i) {
+            placeIp(e, ips[i], nowMs + c->ttlMs, e->nb);
+        }
+        int idx = prefer[0] ? findIp(e, prefer) : -1;
+        if (idx > 0) {
+            placeIp(e, prefer, nowMs + c->ttlMs, 0);
+        }
+    }
+    pthread_mutex_unlock(&c->lock);
+    return nb;
+}
+
+void ksy_hostcache_add(KSYHostCache* c, const char* host, const char* ip, double nowMs) {
+    if (c == NULL || host == NULL || ip == NULL || ip[0] == 0) {
+        return;
+    }
+    pthread_mutex_lock(&c->lock);
+    HostEntry * e = findHost(c, host, YES, nowMs);
+    if (e) {
+        placeIp(e, ip, nowMs + c->ttlMs, 0);
+    }
+    pthread_mutex_unlock(&c->lock);
+}
+
+int ksy_hostcache_get(KSYHostCache* c, const char* host, double nowMs, BOOL bAllowStale,
+                      char ips[][KSY_IP_LEN], int maxNb) {
+    if (c == NULL || host == NULL || ips == NULL) {
+        return 0;
+    }
+    int nb = 0;
+    pthread_mutex_lock(&c->lock);
+    HostEntry * e = findHost(c, host, NO, nowMs);
+    // 先取未过期的, 再取过期的, 各自保持原来的顺序
+    for (int pass = 0; e && pass < (bAllowStale ? 2 : 1); ++pass) {
+        for (int i = 0; i < e->nb && nb < maxNb; ++i) {
+            BOOL bValid = e->expire[i] > nowMs;
+            if (bValid == (pass == 0)) {
+                snprintf(ips[nb++], KSY_IP_LEN, "%s", e->ips[i]);
+            }
+        }
+    }
+    pthread_mutex_unlock(&c->lock);
+    return nb;
+}
+
+#pragma mark - tcp race
+static int startConnect(const char* ip, int port, BOOL* bDone) {
+    struct addrinfo hints, *res = NULL;
+    char   portStr[16];
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags    = AI_NUMERICHOST | AI_NUMERICSERV;
+    snprintf(portStr, sizeof(portStr), "%d", port);
+    *bDone = NO;
+    if (getaddrinfo(ip, portStr, &hints, &res) != 0 || res == NULL) {
+        return -1;
+    }
+    int fd = socket(res->ai_family, SOCK_STREAM, 0);
+    if (fd >= 0) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        if (connect(fd, res->ai_addr, res->ai_addrlen) == 0) {
+            *bDone = YES;
+        }
+        else if (errno != EINPROGRESS) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+int ksy_tcp_race(const char ips[][KSY_IP_LEN], int nb, int port,
+                 int timeoutMs, int staggerMs, float* connMs) {
+    if (ips == NULL || nb <= 0 || port <= 0) {
+        return -1;
+    }
+    int     fds[KSY_HOST_MAX_IP];
+    int     winner = -1, next = 0, active = 0;
+    double  t0 = monoMs(), nextStart = t0;
+    nb = nb < KSY_HOST_MAX_IP ? nb : KSY_HOST_MAX_IP;
+    for (int i = 0; i < nb; ++i) {
+        fds[i] = -1;
+    }
+    while (winner < 0) {
+        double now = monoMs();
+        if (now - t0 >= timeoutMs) {
+            break;
+        }
+        if (next < nb && (now >= nextStart || active == 0)) {
+            BOOL bDone = NO;
+            fds[next] = startConnect(ips[next], port, &bDone);
+            if (bDone) {
+                winner = next;
+            }
+            active   += fds[next] >= 0;
+            nextStart = fds[next] >= 0 ? now + staggerMs : now; // 立即失败时不用等
+            next     += 1;
+            continue;
+        }
+        if (active == 0) {
+            break; // 都失败了
+        }
+        struct pollfd pfd[KSY_HOST_MAX_IP];
+        int           idx[KSY_HOST_MAX_IP], np = 0;
+        for (int i = 0; i < next; ++i) {
+            if (fds[i] >= 0) {
+                pfd[np].fd      = fds[i];
+                pfd[np].events  = POLLOUT;
+                pfd[np].revents = 0;
+                idx[np++] = i;
+            }
+        }
+        double wait = t0 + timeoutMs - now;
+        if (next < nb && nextStart - now < wait) {
+            wait = nextStart - now;
+        }
+        if (poll(pfd, np, (int)ceil(wait)) <= 0) {
+            continue;
+        }
+        for (int k = 0; k < np && winner < 0; ++k) {
+            if (pfd[k].revents == 0) {
+                continue;
+            }
+            int       err = 0;
+            socklen_t len = sizeof(err);
+            if (getsockopt(pfd[k].fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err == 0) {
+                winner = idx[k];
+            }
+            else {
+                close(fds[idx[k]]);
+                fds[idx[k]] = -1;
+                active   -= 1;
+                nextStart = now;
+            }
+        }
+    }
+    if (connMs) {
+        *connMs = winner >= 0 ? (float)(monoMs() - t0) : -1;
+    }
+    for (int i = 0; i < next; ++i) {
+        if (fds[i] >= 0) {
+            close(fds[i]);
+        }
+    }
+    return winner;
+}
+
+#pragma mark - reconnect policy
+struct _KSYReconnPolicy {
+    float           param[KSYReconn_NbParam];
+    uint32_t        seed;
+    double          connectedAt;    // <0 表示未连接
+    double          outageStart;    // <0 表示没有断开
+    KSYReconnStat   stat;
+};
+
+static const float s_reconnDef[KSYReconn_NbParam] = { 300, 8000, 0.2f, 10000, 0 };
+
+static float urand(uint32_t* seed) {
+    *seed = *seed * 1664525u + 1013904223u;
+    return (*seed >> 8) / 16777216.0f;
+}
+
+KSYReconnPolicy* ksy_reconn_create(uint32_t seed) {
+    KSYReconnPolicy * p = calloc(1, sizeof(KSYReconnPolicy));
+    if (p == NULL) {
+        return NULL;
+    }
+    memcpy(p->param, s_reconnDef, sizeof(s_reconnDef));
+    p->seed = seed ? seed : 1;
+    ksy_reconn_reset(p);
+    return p;
+}
+
+void ksy_reconn_destroy(KSYReconnPolicy* p) {
+    free(p);
+}
+
+void ksy_reconn_set_param(KSYReconnPolicy* p, int idx, float value) {
+    if (p && idx >= 0 && idx < KSYReconn_NbParam) {
+        p->param[idx] = value;
+    }
+}
+
+void ksy_reconn_reset(KSYReconnPolicy* p) {
+    if (p == NULL) {
+        return;
+    }
+    p->stat.failCnt = 0;
+    p->connectedAt  = -1;
+    p->outageStart  = -1;
+}
+
+void ksy_reconn_on_connected(KSYReconnPolicy* p, double nowMs) {
+    if (p == NULL) {
+        return;
+    }
+    p->connectedAt = nowMs;
+    if (p->outageStart >= 0) {
+        p->stat.lastOutageMs = (float)(nowMs - p->outageStart);
+        p->stat.successCnt  += 1;
+        p->outageStart       = -1;
+    }
+}
+
+int ksy_reconn_on_failure(KSYReconnPolicy* p, double nowMs) {
+    if (p == NULL) {
+        return -1;
+    }
+    // 连上后很快又断开的不算恢复, 继续退避
+    if (p->connectedAt >= 0 && nowMs - p->connectedAt >= p->param[KSYReconn_StableMs]) {
+        p->stat.failCnt = 0;
+    }
+    p->connectedAt = -1;
+    if (p->outageStart < 0) {
+        p->outageStart = nowMs;
+    }
+    p->stat.failCnt += 1;
+    int maxRetry = (int)p->param[KSYReconn_MaxRetry];
+    if (maxRetry > 0 && p->stat.failCnt > maxRetry) {
+        return -1;
+    }
+    int   exp   = p->stat.failCnt - 1 < 16 ? p->stat.failCnt - 1 : 16;
+    float delay = fminf(p->param[KSYReconn_InitDelayMs] * (float)(1 << exp), p->param[KSYReconn_MaxDelayMs]);
+    delay *= 1 + p->param[KSYReconn_Jitter] * (2 * urand(&p->seed) - 1);
+    p->stat.retryCnt   += 1;
+    p->stat.lastDelayMs = delay;
+    return (int)lrintf(delay);
+}
+
+void ksy_reconn_get_stat(const KSYReconnPolicy* p, KSYReconnStat* stat) {
+    if (p && stat) {
+        *stat = p->stat;
+    }
+}
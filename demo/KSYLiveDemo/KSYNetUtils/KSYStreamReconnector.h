@@ -0,0 +1,95 @@
+//
+//  KSYStreamReconnector.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "KSYReconnect.h"
+
+#if USING_DYNAMIC_FRAMEWORK
+#import <libksygpulivedylib/KSYStreamerBase.h>
+#else
+#import <libksygpulive/KSYStreamerBase.h>
+#endif
+
+/// 重连时推流地址中是否使用IP
+typedef NS_ENUM(NSInteger, KSYReconnectIPMode) {
+    /// 只在DNS解析失败时使用缓存的IP
+    KSYReconnectIP_OnDnsFailure = 0,
+    /// 总是使用探测到的最快的IP (服务端需要能处理IP形式的推流地址)
+    KSYReconnectIP_Always,
+    /// 不使用IP, 只做网络探测和退避
+    KSYReconnectIP_Never,
+};
+
+/** 推流断开后的自动重连 (代替固定间隔的重试)
+
+ 1. 设置推流地址后在后台预先解析域名; 推流成功时记录服务器的IP (rtmpHostIP), 缓存的地址在DNS失败时继续使用
+ 2. 出错后按退避时间 (KSYReconnParam) 等待, 然后对缓存的地址并行发起TCP连接, 有地址能连上时才重新开始推流,
+    网络没有恢复时不反复启动推流模块
+ 3. 只对网络类的错误重连 (连接失败/断开, DNS失败, 发送阻塞), 鉴权/参数类的错误直接返回
+ 4. 推流停止 (Idle) 时取消还没有执行的重连
+ 5. 在主线程调用, 解析和探测在后台队列执行
+ */
+@interface KSYStreamReconnector : NSObject
+
+/**
+ @abstract  初始化
+ */
+- (instancetype) initWithStreamer:(KSYStreamerBase*)streamer;
+
+/**
+ @abstract  推流地址, 设置后在后台解析域名
+ */
+@property (nonatomic, copy) NSURL * hostURL;
+
+/**
+ @abstract  推流地址中是否使用IP, 默认 KSYReconnectIP_OnDnsFailure
+ */
+@property (nonatomic, assign) KSYReconnectIPMode ipMode;
+
+/**
+ @abstract  探测的超时时间 (毫秒), 默认3000
+ */
+@property (nonatomic, assign) int probeTimeoutMs;
+
+/**
+ @abstract  设置重连策略的参数 (如 KSYReconn_MaxRetry)
+ */
+- (void) setParam:(int)idx value:(float)value;
+
+/**
+ @abstract  推流状态变化时调用 (KSYStreamStateDidChangeNotification)
+ */
+- (void) onStreamStateChange;
+
+/**
+ @abstract  推流出错时调用
+ @return    已安排重连返回YES; 不可重连的错误或已放弃时返回NO
+ */
+- (BOOL) retryOnError:(KSYStreamErrorCode)errCode;
+
+/**
+ @abstract  取消还没有执行的重连, 退避复位
+ */
+- (void) cancel;
+
+/**
+ @abstract  连续失败超过 KSYReconn_MaxRetry 次放弃时的回调 (主线程)
+ */
+@property (nonatomic, copy) void (^onGiveUp)(KSYStreamErrorCode errCode);
+
+/**
+ @abstract  统计信息
+ */
+@property (nonatomic, readonly) KSYReconnStat stat;
+
+/**
+ @abstract  统计信息 (一行)
+ */
+@property (nonatomic, readonly) NSString * statString;
+
+@end
@@ -0,0 +1,201 @@
+//
+//  KSYStreamReconnector.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <arpa/inet.h>
+#import "KSYStreamReconnector.h"
+
+#define KSY_RTMP_PORT       1935
+#define KSY_HOST_TTL_MS     (10 * 60 * 1000)
+#define KSY_PROBE_STAGGER   250     // 相邻两个地址发起连接的间隔 (毫秒)
+
+@interface KSYStreamReconnector () {
+    KSYHostCache *      _cache;
+    KSYReconnPolicy *   _policy;
+    dispatch_queue_t    _queue;         // 解析和探测
+    int                 _generation;    // cancel 后之前安排的重连不再执行
+    KSYStreamErrorCode  _lastErr;
+    NSString *          _lastIP;        // 最近一次使用的地址
+}
+@property (nonatomic, weak) KSYStreamerBase * streamer;
+@end
+
+@implementation KSYStreamReconnector
+
+static double nowMs(void) {
+    return [[NSDate date] timeIntervalSince1970] * 1000;
+}
+
+static BOOL isIPAddress(NSString* host) {
+    struct in6_addr addr;
+    return inet_pton(AF_INET, host.UTF8String, &addr) == 1 ||
+           inet_pton(AF_INET6, host.UTF8String, &addr) == 1;
+}
+
+- (instancetype) initWithStreamer:(KSYStreamerBase*)streamer {
+    self = [super init];
+    if (self == nil || streamer == nil) {
+        return nil;
+    }
+    _cache  = ksy_hostcache_create(KSY_HOST_TTL_MS);
+    _policy = ksy_reconn_create((uint32_t)arc4random());
+    if (_cache == NULL || _policy == NULL) {
+        return nil;
+    }
+    _queue          = dispatch_queue_create("com.ksyun.reconnect", DISPATCH_QUEUE_SERIAL);
+    _streamer       = streamer;
+    _ipMode         = KSYReconnectIP_OnDnsFailure;
+    _probeTimeoutMs = 3000;
+    _lastErr        = KSYStreamErrorCode_NONE;
+    return self;
+}
+
+- (void) dealloc {
+    // 后台队列上的任务持有 self, 执行完之后才会走到这里
+    ksy_hostcache_destroy(_cache);
+    ksy_reconn_destroy(_policy);
+}
+
+- (void) setHostURL:(NSURL*)hostURL {
+    _hostURL = [hostURL copy];
+    NSString * host = _hostURL.host;
+    if (host.length == 0 || isIPAddress(host)) {
+        return;
+    }
+    dispatch_async(_queue, ^{
+        ksy_hostcache_resolve(_cache, host.UTF8String, nowMs());
+    });
+}
+
+- (void) setParam:(int)idx value:(float)value {
+    ksy_reconn_set_param(_policy, idx, value);
+}
+
+- (void) onStreamStateChange {
+    KSYStreamerBase * streamer = _streamer;
+    if (streamer.streamState == KSYStreamStateConnected) {
+        ksy_reconn_on_connected(_policy, nowMs());
+        NSString * ip   = streamer.rtmpHostIP;
+        NSString * host = _hostURL.host;
+        if (ip.length && host.length) {
+            ksy_hostcache_add(_cache, host.UTF8String, ip.UTF8String, nowMs());
+        }
+        _lastErr = KSYStreamErrorCode_NONE;
+    }
+    else if (streamer.streamState == KSYStreamStateIdle) {
+        [self cancel]; // 停止推流
+    }
+}
+
+- (void) cancel {
+    _generation += 1;
+    ksy_reconn_reset(_policy);
+}
+
+static BOOL isRetryable(KSYStreamErrorCode errCode) {
+    switch (errCode) {
+        case KSYStreamErrorCode_CONNECT_FAILED:
+        case KSYStreamErrorCode_CONNECT_BREAK:
+        case KSYStreamErrorCode_FRAMES_THRESHOLD:
+        case KSYStreamErrorCode_DNS_Parse_failed:
+        case KSYStreamErrorCode_Connect_Server_failed:
+            return YES;
+        default:
+            return NO;
+    }
+}
+
+- (BOOL) retryOnError:(KSYStreamErrorCode)errCode {
+    if (!isRetryable(errCode) || _hostURL == nil) {
+        return NO;
+    }
+    _lastErr = errCode;
+    return [self scheduleRetry];
+}
+
+// 按退避时间安排下一次尝试 (主线程)
+- (BOOL) scheduleRetry {
+    int delayMs = ksy_reconn_on_failure(_policy, nowMs());
+    if (delayMs < 0) {
+        if (_onGiveUp) {
+            _onGiveUp(_lastErr);
+        }
+        return NO;
+    }
+    // 后台队列只使用这里取出的值
+    int        gen        = _generation;
+    NSURL *    url        = _hostURL;
+    BOOL       bDnsFailed = _lastErr == KSYStreamErrorCode_DNS_Parse_failed;
+    dispatch_time_t t = dispatch_time(DISPATCH_TIME_NOW, (int64_t)delayMs * NSEC_PER_MSEC);
+    dispatch_after(t, _queue, ^{
+        [self probe:url dnsFailed:bDnsFailed generation:gen];
+    });
+    return YES;
+}
+
+// 后台队列: 取出/解析地址, 探测能否连上, 能连上时回到主线程开始推流
+- (void) probe:(NSURL*)url dnsFailed:(BOOL)bDnsFailed generation:(int)gen {
+    NSString * host = url.host;
+    int        port = url.port ? url.port.intValue : KSY_RTMP_PORT;
+    char       ips[KSY_HOST_MAX_IP][KSY_IP_LEN];
+    int        nb   = 0;
+    if (isIPAddress(host)) {
+        snprintf(ips[0], KSY_IP_LEN, "%s", host.UTF8String);
+        nb = 1;
+    }
+    else {
+        nb = ksy_hostcache_get(_cache, host.UTF8String, nowMs(), NO, ips, KSY_HOST_MAX_IP);
+        if (nb == 0) { // 没有或已过期: 重新解析, 失败时用过期的地址
+            bDnsFailed |= ksy_hostcache_resolve(_cache, host.UTF8String, nowMs()) < 0;
+            nb = ksy_hostcache_get(_cache, host.UTF8String, nowMs(), YES, ips, KSY_HOST_MAX_IP);
+        }
+    }
+    float connMs = -1;
+    int   win    = nb > 0 ? ksy_tcp_race((const char (*)[KSY_IP_LEN])ips, nb, port,
+                                         _probeTimeoutMs, KSY_PROBE_STAGGER, &connMs) : -1;
+    NSString * ip = win >= 0 ? [NSString stringWithUTF8String:ips[win]] : nil;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        KSYStreamerBase * streamer = _streamer;
+        if (gen != _generation || streamer.streamState != KSYStreamStateError) {
+            return; // 已取消, 或已经重新开始推流
+        }
+        if (ip == nil) {
+            [self scheduleRetry]; // 网络没有恢复, 继续等待
+            return;
+        }
+        BOOL bUseIP = _ipMode == KSYReconnectIP_Always ||
+                      (_ipMode == KSYReconnectIP_OnDnsFailure && bDnsFailed);
+        _lastIP = ip;
+        [streamer startStream:bUseIP ? [self url:url withIP:ip] : url];
+    });
+}
+
+- (NSURL*) url:(NSURL*)url withIP:(NSString*)ip {
+    NSURLComponents * comp = [NSURLComponents componentsWithURL:url resolvingAgainstBaseURL:NO];
+    if ([ip rangeOfString:@":"].location != NSNotFound) {
+        comp.percentEncodedHost = [NSString stringWithFormat:@"[%@]", ip];
+    }
+    else {
+        comp.host = ip;
+    }
+    return comp.URL ? comp.URL : url;
+}
+
+- (KSYReconnStat) stat {
+    KSYReconnStat st;
+    ksy_reconn_get_stat(_policy, &st);
+    return st;
+}
+
+- (NSString*) statString {
+    KSYReconnStat st = self.stat;
+    return [NSString stringWithFormat:@"重连 %d/%d 中断%.1fs 等待%.1fs %@",
+            st.successCnt, st.retryCnt, st.lastOutageMs / 1000, st.lastDelayMs / 1000,
+            _lastIP ? _lastIP : @""];
+}
+
+@end
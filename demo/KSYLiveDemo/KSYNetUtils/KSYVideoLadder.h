@@ -0,0 +1,121 @@
+//
+//  KSYVideoLadder.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** 推流分辨率/帧率的档位切换 (与码率自适应配合)
+
+ 1. 档位 (KSYLadderRung) 为 (分辨率, 帧率, 适用的码率范围), 从低到高排列, 相邻档位的码率范围可以重叠
+ 2. 输入为带宽估计给出的目标码率和CPU占用, 输出当前的档位
+ 3. 目标码率低于当前档位的下限, 或CPU占用过高, 持续 DownHoldMs 后降档 (码率不足时直接降到合适的档位)
+ 4. 目标码率高于上一档的下限 (留出 UpMargin 的余量) 且CPU空闲, 持续 UpHoldMs 后升一档; 两次切换至少间隔 MinDwellMs
+ 5. 升档后很快又降回时, 下次升档等待的时间加倍 (最多 MaxUpHoldMs), 避免在两档之间来回切换
+ 6. 与平台无关, 不加锁, 在同一个线程调用; 可以用合成的带宽和CPU输入离线测试 (见 tools/ladderbench)
+ */
+
+/// 最多的档位个数
+#define KSY_LADDER_MAX_RUNG  8
+
+/// 一个档位
+typedef struct {
+    /// 编码的宽高 (横屏方向)
+    int     width;
+    int     height;
+    /// 帧率
+    int     fps;
+    /// 适用的视频码率范围 (kbps)
+    int     minKbps;
+    int     maxKbps;
+} KSYLadderRung;
+
+/// 参数
+typedef NS_ENUM(int, KSYLadderParam) {
+    /// 降档前条件需要持续的时间 (毫秒), 默认2000
+    KSYLadder_DownHoldMs = 0,
+    /// 升档前条件需要持续的时间 (毫秒), 默认8000
+    KSYLadder_UpHoldMs,
+    /// 升档等待时间加倍的上限 (毫秒), 默认64000
+    KSYLadder_MaxUpHoldMs,
+    /// 两次切换的最小间隔 (毫秒), 默认4000
+    KSYLadder_MinDwellMs,
+    /// 升档时目标码率需要高出上一档下限的比例, 默认0.15
+    KSYLadder_UpMargin,
+    /// CPU占用高于此值时降档 (0~1), 默认0.85
+    KSYLadder_CpuHigh,
+    /// CPU占用低于此值时才升档 (0~1), 默认0.6
+    KSYLadder_CpuLow,
+    KSYLadder_NbParam
+};
+
+/// 最近一次切换的原因
+typedef NS_ENUM(int, KSYLadderReason) {
+    KSYLadderReason_None = 0,
+    /// 码率不足降档
+    KSYLadderReason_Bandwidth,
+    /// CPU占用过高降档
+    KSYLadderReason_Cpu,
+    /// 升档
+    KSYLadderReason_Up,
+};
+
+/// 统计
+typedef struct {
+    /// 当前档位
+    int             rung;
+    /// 最近一次切换的原因和时间 (毫秒)
+    KSYLadderReason reason;
+    double          switchMs;
+    /// 升档/码率不足降档/CPU过高降档的次数
+    int             upCnt;
+    int             bwDownCnt;
+    int             cpuDownCnt;
+    /// 当前升档需要等待的时间 (毫秒)
+    float           upHoldMs;
+} KSYLadderStat;
+
+typedef struct _KSYVideoLadder KSYVideoLadder;
+
+/**
+ @abstract  创建
+ @param     rungs    档位 (从低到高, minKbps 递增), 会被复制
+ @param     nbRung   档位个数 (1~KSY_LADDER_MAX_RUNG)
+ @param     initRung 起始的档位
+ */
+KSYVideoLadder* ksy_ladder_create(const KSYLadderRung* rungs, int nbRung, int initRung);
+
+void ksy_ladder_destroy(KSYVideoLadder* l);
+
+/**
+ @abstract  设置参数 (KSYLadderParam)
+ */
+void ksy_ladder_set_param(KSYVideoLadder* l, int idx, float value);
+
+/**
+ @abstract  重新开始 (开始推流/重连), 回到 initRung
+ */
+void ksy_ladder_reset(KSYVideoLadder* l, int initRung);
+
+/**
+ @abstract  输入一次采样
+ @param     tMs         当前时间 (毫秒)
+ @param     targetKbps  带宽估计给出的视频目标码率
+ @param     cpuLoad     CPU占用 (0~1), <0 表示未知 (只按码率切换)
+ @return    当前的档位
+ */
+int ksy_ladder_update(KSYVideoLadder* l, double tMs, float targetKbps, float cpuLoad);
+
+/**
+ @abstract  档位个数和第idx个档位
+ */
+int ksy_ladder_count(const KSYVideoLadder* l);
+const KSYLadderRung* ksy_ladder_rung(const KSYVideoLadder* l, int idx);
+
+/**
+ @abstract  统计信息
+ */
+void ksy_ladder_get_stat(const KSYVideoLadder* l, KSYLadderStat* stat);
@@ -0,0 +1,160 @@
+//
+//  KSYVideoLadder.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYVideoLadder.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct _KSYVideoLadder {
+    KSYLadderRung   rungs[KSY_LADDER_MAX_RUNG];
+    int             nbRung;
+    float           param[KSYLadder_NbParam];
+    KSYLadderStat   stat;
+    BOOL            bStarted;
+    // 各条件开始成立的时间 (毫秒), <0 表示不成立
+    double          bwLowSince;
+    double          cpuHighSince;
+    double          upSince;
+    double          lastUpMs;       // 最近一次升档的时间, <0 表示还没有升过
+};
+
+static const float s_ladderDef[KSYLadder_NbParam] = { 2000, 8000, 64000, 4000, 0.15f, 0.85f, 0.6f };
+
+static double since(double start, BOOL bCond, double tMs) {
+    if (!bCond) {
+        return -1;
+    }
+    return start < 0 ? tMs : start;
+}
+
+KSYVideoLadder* ksy_ladder_create(const KSYLadderRung* rungs, int nbRung, int initRung) {
+    if (rungs == NULL || nbRung <= 0 || nbRung > KSY_LADDER_MAX_RUNG) {
+        return NULL;
+    }
+    for (int i = 0; i < nbRung; ++i) {
+        const KSYLadderRung * r = rungs + i;
+        if (r->width <= 0 || r->height <= 0 || r->fps <= 0 || r->minKbps > r->maxKbps ||
+            (i > 0 && r->minKbps < rungs[i-1].minKbps)) {
+            return NULL;
+        }
+    }
+    KSYVideoLadder * l = calloc(1, sizeof(KSYVideoLadder));
+    if (l == NULL) {
+        return NULL;
+    }
+    memcpy(l->rungs, rungs, sizeof(KSYLadderRung) * nbRung);
+    memcpy(l->param, s_ladderDef, sizeof(s_ladderDef));
+    l->nbRung = nbRung;
+    ksy_ladder_reset(l, initRung);
+    return l;
+}
+
+void ksy_ladder_destroy(KSYVideoLadder* l) {
+    free(l);
+}
+
+void ksy_ladder_set_param(KSYVideoLadder* l, int idx, float value) {
+    if (l && idx >= 0 && idx < KSYLadder_NbParam) {
+        l->param[idx] = value;
+    }
+}
+
+void ksy_ladder_reset(KSYVideoLadder* l, int initRung) {
+    if (l == NULL) {
+        return;
+    }
+    memset(&l->stat, 0, sizeof(l->stat));
+    l->stat.rung     = initRung < 0 ? 0 : (initRung >= l->nbRung ? l->nbRung - 1 : initRung);
+    l->stat.upHoldMs = l->param[KSYLadder_UpHoldMs];
+    l->bStarted      = NO;
+    l->bwLowSince    = -1;
+    l->cpuHighSince  = -1;
+    l->upSince       = -1;
+    l->lastUpMs      = -1;
+}
+
+// 码率可以支持的最高档位 (不高于cur)
+static int fitRung(const KSYVideoLadder* l, int cur, float kbps) {
+    int i = cur;
+    while (i > 0 && l->rungs[i].minKbps > kbps) {
+        --i;
+    }
+    return i;
+}
+
+static void switchTo(KSYVideoLadder* l, int next, KSYLadderReason reason, double tMs) {
+    float base = l->param[KSYLadder_UpHoldMs];
+    if (reason == KSYLadderReason_Up) {
+        l->lastUpMs = tMs;
+        l->stat.upCnt += 1;
+    }
+    else {
+        // 升档后不久又降回: 说明升档太早, 下次多等一段时间
+        BOOL bFailedUp = l->lastUpMs >= 0 && tMs - l->lastUpMs < 2 * l->stat.upHoldMs;
+        l->stat.upHoldMs = bFailedUp ? fminf(2 * l->stat.upHoldMs, l->param[KSYLadder_MaxUpHoldMs]) : base;
+        l->stat.bwDownCnt  += reason == KSYLadderReason_Bandwidth;
+        l->stat.cpuDownCnt += reason == KSYLadderReason_Cpu;
+    }
+    l->stat.rung     = next;
+    l->stat.reason   = reason;
+    l->stat.switchMs = tMs;
+    l->bwLowSince    = -1;
+    l->cpuHighSince  = -1;
+    l->upSince       = -1;
+}
+
+int ksy_ladder_update(KSYVideoLadder* l, double tMs, float targetKbps, float cpuLoad) {
+    if (l == NULL) {
+        return 0;
+    }
+    int cur = l->stat.rung;
+    if (!l->bStarted) {
+        l->bStarted      = YES;
+        l->stat.switchMs = tMs;
+    }
+    BOOL bCpuKnown = cpuLoad >= 0;
+    BOOL bBwLow    = cur > 0 && targetKbps < l->rungs[cur].minKbps;
+    BOOL bCpuHigh  = cur > 0 && bCpuKnown && cpuLoad > l->param[KSYLadder_CpuHigh];
+    BOOL bCanUp    = cur < l->nbRung - 1 &&
+                     targetKbps >= l->rungs[cur+1].minKbps * (1 + l->param[KSYLadder_UpMargin]) &&
+                     (!bCpuKnown || cpuLoad < l->param[KSYLadder_CpuLow]);
+    l->bwLowSince   = since(l->bwLowSince,   bBwLow,   tMs);
+    l->cpuHighSince = since(l->cpuHighSince, bCpuHigh, tMs);
+    l->upSince      = since(l->upSince,      bCanUp,   tMs);
+
+    float downHold = l->param[KSYLadder_DownHoldMs];
+    if (bBwLow && tMs - l->bwLowSince >= downHold) {
+        switchTo(l, fitRung(l, cur - 1, targetKbps), KSYLadderReason_Bandwidth, tMs);
+    }
+    else if (bCpuHigh && tMs - l->cpuHighSince >= downHold) {
+        switchTo(l, cur - 1, KSYLadderReason_Cpu, tMs);
+    }
+    else if (bCanUp && tMs - l->upSince >= l->stat.upHoldMs &&
+             tMs - l->stat.switchMs >= l->param[KSYLadder_MinDwellMs]) {
+        switchTo(l, cur + 1, KSYLadderReason_Up, tMs);
+    }
+    return l->stat.rung;
+}
+
+int ksy_ladder_count(const KSYVideoLadder* l) {
+    return l ? l->nbRung : 0;
+}
+
+const KSYLadderRung* ksy_ladder_rung(const KSYVideoLadder* l, int idx) {
+    if (l == NULL || idx < 0 || idx >= l->nbRung) {
+        return NULL;
+    }
+    return l->rungs + idx;
+}
+
+void ksy_ladder_get_stat(const KSYVideoLadder* l, KSYLadderStat* stat) {
+    if (l && stat) {
+        *stat = l->stat;
+    }
+}
@@ -0,0 +1,231 @@
+//
+//  KSYMediaGraph.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/** 音视频处理图: 节点 + 有界队列 + 调度线程池
+
+ 1. 节点有类型确定的输入/输出端口 (音频或视频), 端口之间用有界队列 (KSYAudioRing, 存放包的指针) 连接,
+    一个输出端口可以连接多个输入端口 (包引用计数, 不拷贝)
+ 2. 调度线程池中的线程轮流执行可运行的节点, 同一节点同一时刻只在一个线程上执行, 节点不需要加锁
+ 3. 背压: 输出队列有一个已满时节点不运行, 数据积压时上游自动停下, 而不是无限制地在回调中堆积;
+    外部线程 (如采集回调) 注入的数据在入口队列满时丢弃并计数, 不会阻塞调用者;
+    不能丢弃的数据 (如推流的音频) 用 ksy_graph_inject_wait, 等待有限的时间后才丢弃
+ 4. 每个节点统计: 处理的包数, 处理耗时, 在输入队列中的等待时间, 从进入图到该节点的延迟
+ 5. 数据源结束后结束标记沿边传递, 全部节点结束后 ksy_graph_wait 返回
+ 6. 与平台无关 (只依赖pthread), 可以在Linux上用文件作为源和输出离线运行
+ */
+typedef struct _KSYMediaGraph KSYMediaGraph;
+typedef struct _KSYMediaNode  KSYMediaNode;
+
+#define KSY_GRAPH_MAX_THREAD    8
+#define KSY_GRAPH_MAX_NODE      32
+#define KSY_NODE_MAX_PORT       4
+#define KSY_NODE_MAX_FANOUT     4
+
+/// 数据类型
+typedef NS_ENUM(int, KSYMediaType) {
+    KSYMediaType_Audio = 0,
+    KSYMediaType_Video,
+};
+
+/// 数据包 (音频为float交织, 视频为I420; 或者只携带外部数据, 如CMSampleBufferRef)
+typedef struct _KSYMediaPacket {
+    KSYMediaType    type;
+    /// 时间戳 (微秒)
+    int64_t         pts;
+    /// 进入图的时间 (单调时钟, 纳秒), 用于统计延迟, 派生的包沿用
+    int64_t         tOrigin;
+    /// 进入当前队列的时间 (纳秒)
+    int64_t         tPush;
+    /// 音频
+    int             rate;
+    int             chCnt;
+    int             nbFrame;
+    float *         pcm;
+    /// 视频
+    int             width;
+    int             height;
+    uint8_t *       plane[3];
+    int             stride[3];
+    /// 外部数据, 包释放时调用 release
+    void *          opaque;
+    void            (*release)(void* opaque);
+    /// 引用计数 (内部使用)
+    _Atomic int     ref;
+} KSYMediaPacket;
+
+/**
+ @abstract  创建音频包 (pcm 未初始化)
+ */
+KSYMediaPacket* ksy_packet_audio(int rate, int chCnt, int nbFrame);
+
+/**
+ @abstract  创建视频包 (I420, 宽高为偶数, 数据未初始化)
+ */
+KSYMediaPacket* ksy_packet_video(int width, int height);
+
+/**
+ @abstract  创建只携带外部数据的包
+ @param     release 包释放时调用 (可以为NULL)
+ */
+KSYMediaPacket* ksy_packet_wrap(KSYMediaType type, void* opaque, void (*release)(void* opaque));
+
+KSYMediaPacket* ksy_packet_retain(KSYMediaPacket* pkt);
+void ksy_packet_release(KSYMediaPacket* pkt);
+
+/**
+ @abstract  原地修改之前调用: 包被多个节点共享时拷贝一份
+ @return    可以修改的包, 原来的引用已转移; 只携带外部数据的包不能拷贝, 返回NULL, 引用仍由调用者持有
+ */
+KSYMediaPacket* ksy_packet_writable(KSYMediaPacket* pkt);
+
+/// 节点处理的结果
+typedef NS_ENUM(int, KSYNodeResult) {
+    /// 处理了数据 (取出或输出了包)
+    KSYNode_Ok = 0,
+    /// 没有可做的事情, 等输入或输出空间变化后再调用
+    KSYNode_Again,
+    /// 节点结束 (如文件读完), 输出端口标记为结束
+    KSYNode_End,
+};
+
+/// 节点的描述
+typedef struct {
+    const char *    name;
+    int             nbIn;
+    int             nbOut;
+    KSYMediaType    inType[KSY_NODE_MAX_PORT];
+    KSYMediaType    outType[KSY_NODE_MAX_PORT];
+    void *          ctx;
+    /// 处理 (调度线程); 用 ksy_node_pop/ksy_node_push 取出和输出包
+    KSYNodeResult   (*process)(KSYMediaNode* node, void* ctx);
+    /// 销毁时释放 ctx (可以为NULL)
+    void            (*destroy)(void* ctx);
+} KSYNodeDesc;
+
+/// 节点的统计信息
+typedef struct {
+    const char *    name;
+    int64_t         calls;      // process 调用次数
+    int64_t         pktIn;      // 取出的包数
+    int64_t         pktOut;     // 输出的包数
+    int64_t         dropCnt;    // 入口队列满时丢弃的包数
+    int64_t         blockCnt;   // 入口队列满, 注入时等待的次数 (ksy_graph_inject_wait)
+    double          busyMs;     // 累计处理耗时
+    float           waitMs;     // 包在输入队列中的平均等待时间 (平滑)
+    float           latencyMs;  // 包从进入图到被该节点取出的平均延迟 (平滑)
+    float           maxLatencyMs;
+    int             queued;     // 输入队列中的包数
+    BOOL            bDone;
+} KSYNodeStat;
+
+#pragma mark - graph
+/**
+ @abstract  创建
+ @param     nbThread 调度线程数 (1~KSY_GRAPH_MAX_THREAD)
+ */
+KSYMediaGraph* ksy_graph_create(int nbThread);
+
+/**
+ @abstract  停止调度线程, 销毁全部节点, 释放队列中的包
+ */
+void ksy_graph_destroy(KSYMediaGraph* g);
+
+/**
+ @abstract  添加节点 (start 之前)
+ @return    失败 (节点数或端口数超出) 时返回NULL, 并调用 desc->destroy
+ */
+KSYMediaNode* ksy_graph_add_node(KSYMediaGraph* g, const KSYNodeDesc* desc);
+
+/**
+ @abstract  添加外部输入节点 (start 之前), 由 ksy_graph_inject 注入数据, 从输出端口0原样输出
+ @param     capacity 入口队列的长度 (包)
+ */
+KSYMediaNode* ksy_graph_add_input(KSYMediaGraph* g, const char* name, KSYMediaType type, int capacity);
+
+/**
+ @abstract  连接两个节点的端口 (start 之前), 类型须一致; 每个输入端口只能连接一次
+ @param     capacity 队列的长度 (包)
+ */
+BOOL ksy_graph_connect(KSYMediaGraph* g, KSYMediaNode* src, int outPort,
+                       KSYMediaNode* dst, int inPort, int capacity);
+
+/**
+ @abstract  启动调度线程; 未连接的端口视为错误
+ */
+BOOL ksy_graph_start(KSYMediaGraph* g);
+
+/**
+ @abstract  等待全部节点结束
+ @param     timeoutMs 超时 (毫秒), <0 表示一直等待
+ @return    全部结束时返回YES
+ */
+BOOL ksy_graph_wait(KSYMediaGraph* g, int timeoutMs);
+
+/**
+ @abstract  停止调度线程 (不等待节点结束, 队列中的数据保留到销毁)
+ */
+void ksy_graph_stop(KSYMediaGraph* g);
+
+/**
+ @abstract  向外部输入节点注入一个包 (任意一个固定的线程, 不阻塞)
+ @param     pkt 引用转移给图; 入口队列已满或已结束时丢弃 (计入 dropCnt)
+ @return    是否进入队列
+ */
+BOOL ksy_graph_inject(KSYMediaNode* input, KSYMediaPacket* pkt);
+
+/**
+ @abstract  向外部输入节点注入一个包, 入口队列满时等待下游取出 (任意一个固定的线程)
+ @param     timeoutMs 最长等待时间 (毫秒), 超时后仍然满时丢弃 (计入 dropCnt); <=0 时与 inject 相同
+ @return    是否进入队列
+ @discussion 等待即背压: 调用者 (如混音线程) 被下游拖慢, 而不是丢失数据; 等待的次数计入 blockCnt
+ */
+BOOL ksy_graph_inject_wait(KSYMediaNode* input, KSYMediaPacket* pkt, int timeoutMs);
+
+/**
+ @abstract  外部输入结束 (与 inject 同一线程)
+ */
+void ksy_graph_end_input(KSYMediaNode* input);
+
+/**
+ @abstract  节点数和各节点的统计 (任意线程)
+ */
+int ksy_graph_node_count(const KSYMediaGraph* g);
+void ksy_graph_node_stat(const KSYMediaGraph* g, int idx, KSYNodeStat* stat);
+
+#pragma mark - node (process 中调用)
+/**
+ @abstract  输入端口中的包数
+ */
+int ksy_node_available(KSYMediaNode* node, int inPort);
+
+/**
+ @abstract  输入端口是否已结束 (上游结束且队列已空)
+ */
+BOOL ksy_node_ended(KSYMediaNode* node, int inPort);
+
+/**
+ @abstract  取出一个包, 没有时返回NULL; 调用者负责 release
+ */
+KSYMediaPacket* ksy_node_pop(KSYMediaNode* node, int inPort);
+
+/**
+ @abstract  输出端口是否还能输出一个包 (所有下游队列都未满)
+ */
+BOOL ksy_node_can_push(KSYMediaNode* node, int outPort);
+
+/**
+ @abstract  输出一个包, 引用转移; 下游队列满时 (调用前应检查 can_push) 丢弃
+ */
+void ksy_node_push(KSYMediaNode* node, int outPort, KSYMediaPacket* pkt);
+
+/**
+ @abstract  单调时钟 (纳秒)
+ */
+int64_t ksy_graph_now_ns(void);
@@ -0,0 +1,694 @@
+//
+//  KSYMediaGraph.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYMediaGraph.h"
+#import "KSYAudioRing.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#define GRAPH_MAX_EDGE      (KSY_GRAPH_MAX_NODE * KSY_NODE_MAX_PORT)
+#define GRAPH_SMOOTH        0.05f
+#define PKT_HDR_SIZE        ((sizeof(KSYMediaPacket) + 31) & ~(size_t)31)
+
+// 两个端口之间的有界队列, 存放包的指针 (单生产者/单消费者)
+typedef struct {
+    KSYAudioRing *  q;
+    int             cap;
+    KSYMediaNode *  src;        // NULL 表示外部输入
+    KSYMediaNode *  dst;
+    atomic_bool     bEnd;       // 上游已结束, 不再写入
+    atomic_bool     bClosed;    // 下游已结束, 写入的包直接释放
+} GraphEdge;
+
+struct _KSYMediaNode {
+    KSYMediaGraph * g;
+    KSYNodeDesc     desc;
+    char            name[32];
+    GraphEdge *     in[KSY_NODE_MAX_PORT];
+    GraphEdge *     out[KSY_NODE_MAX_PORT][KSY_NODE_MAX_FANOUT];
+    int             nbFan[KSY_NODE_MAX_PORT];
+    atomic_bool     bBusy;      // 正在某个调度线程上执行
+    atomic_bool     bDone;
+    atomic_int      idleSeq;    // 上次没有进展时图的事件序号, 序号不变时不再调用
+    BOOL            bProgress;  // 本次调用中取出或输出过包 (执行中的线程使用)
+    // 统计
+    _Atomic int64_t calls;
+    _Atomic int64_t pktIn;
+    _Atomic int64_t pktOut;
+    _Atomic int64_t dropCnt;
+    _Atomic int64_t blockCnt;
+    _Atomic int64_t busyNs;
+    _Atomic float   waitMs;
+    _Atomic float   latencyMs;
+    _Atomic float   maxLatencyMs;
+};
+
+struct _KSYMediaGraph {
+    int                 nbThread;
+    pthread_t           thread[KSY_GRAPH_MAX_THREAD];
+    int                 nbStarted;
+    KSYMediaNode *      nodes[KSY_GRAPH_MAX_NODE];
+    int                 nbNode;
+    GraphEdge *         edges[GRAPH_MAX_EDGE];
+    int                 nbEdge;
+    pthread_mutex_t     lock;
+    pthread_cond_t      cond;       // 没有可运行的节点时等待事件
+    pthread_cond_t      doneCond;
+    atomic_int          seq;        // 事件序号: 队列有变化/节点结束时加1
+    atomic_int          next;       // 下次从该节点开始查找, 各节点轮流运行
+    atomic_int          nbDone;
+    atomic_bool         bQuit;
+};
+
+int64_t ksy_graph_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// 条件变量的超时按单调时钟计算, 不受系统时间调整的影响
+static void condInit(pthread_cond_t* cond) {
+#if defined(__APPLE__)
+    pthread_cond_init(cond, NULL); // Darwin 没有 pthread_condattr_setclock, 等待时用相对时间
+#else
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+#endif
+}
+
+// 等待到单调时钟的 untilNs (ksy_graph_now_ns), 超时返回 ETIMEDOUT
+static int condWaitUntil(pthread_cond_t* cond, pthread_mutex_t* lock, int64_t untilNs) {
+    int64_t now = ksy_graph_now_ns();
+    if (now >= untilNs) {
+        return ETIMEDOUT;
+    }
+#if defined(__APPLE__)
+    int64_t rel = untilNs - now;
+    struct timespec ts = { (time_t)(rel / 1000000000), (long)(rel % 1000000000) };
+    return pthread_cond_timedwait_relative_np(cond, lock, &ts);
+#else
+    struct timespec ts = { (time_t)(untilNs / 1000000000), (long)(untilNs % 1000000000) };
+    return pthread_cond_timedwait(cond, lock, &ts);
+#endif
+}
+
+#pragma mark - packet
+static KSYMediaPacket* allocPacket(KSYMediaType type, size_t dataSize) {
+    KSYMediaPacket * pkt = calloc(1, PKT_HDR_SIZE + dataSize);
+    if (pkt) {
+        pkt->type = type;
+        atomic_init(&pkt->ref, 1);
+    }
+    return pkt;
+}
+
+KSYMediaPacket* ksy_packet_audio(int rate, int chCnt, int nbFrame) {
+    if (rate <= 0 || chCnt <= 0 || nbFrame <= 0) {
+        return NULL;
+    }
+    KSYMediaPacket * pkt = allocPacket(KSYMediaType_Audio, sizeof(float) * nbFrame * chCnt);
+    if (pkt) {
+        pkt->rate    = rate;
+        pkt->chCnt   = chCnt;
+        pkt->nbFrame = nbFrame;
+        pkt->pcm     = (float*)((uint8_t*)pkt + PKT_HDR_SIZE);
+    }
+    return pkt;
+}
+
+KSYMediaPacket* ksy_packet_video(int width, int height) {
+    if (width <= 0 || height <= 0 || (width & 1) || (height & 1)) {
+        return NULL;
+    }
+    size_t ySize = (size_t)width * height;
+    KSYMediaPacket * pkt = allocPacket(KSYMediaType_Video, ySize * 3 / 2);
+    if (pkt) {
+        pkt->width     = width;
+        pkt->height    = height;
+        pkt->plane[0]  = (uint8_t*)pkt + PKT_HDR_SIZE;
+        pkt->plane[1]  = pkt->plane[0] + ySize;
+        pkt->plane[2]  = pkt->plane[1] + ySize / 4;
+        pkt->stride[0] = width;
+        pkt->stride[1] = width / 2;
+        pkt->stride[2] = width / 2;
+    }
+    return pkt;
+}
+
+KSYMediaPacket* ksy_packet_wrap(KSYMediaType type, void* opaque, void (*release)(void* opaque)) {
+    KSYMediaPacket * pkt = allocPacket(type, 0);
+    if (pkt) {
+        pkt->opaque  = opaque;
+        pkt->release = release;
+    }
+    else if (release) {
+        release(opaque);
+    }
+    return pkt;
+}
+
+KSYMediaPacket* ksy_packet_retain(KSYMediaPacket* pkt) {
+    if (pkt) {
+        atomic_fetch_add_explicit(&pkt->ref, 1, memory_order_relaxed);
+    }
+    return pkt;
+}
+
+void ksy_packet_release(KSYMediaPacket* pkt) {
+    if (pkt == NULL || atomic_fetch_sub_explicit(&pkt->ref, 1, memory_order_acq_rel) != 1) {
+        return;
+    }
+    if (pkt->release) {
+        pkt->release(pkt->opaque);
+    }
+    free(pkt);
+}
+
+KSYMediaPacket* ksy_packet_writable(KSYMediaPacket* pkt) {
+    if (pkt == NULL || atomic_load_explicit(&pkt->ref, memory_order_acquire) == 1) {
+        return pkt;
+    }
+    KSYMediaPacket * cp = NULL;
+    if (pkt->pcm) {
+        cp = ksy_packet_audio(pkt->rate, pkt->chCnt, pkt->nbFrame);
+        if (cp) {
+            memcpy(cp->pcm, pkt->pcm, sizeof(float) * pkt->nbFrame * pkt->chCnt);
+        }
+    }
+    else if (pkt->plane[0]) {
+        cp = ksy_packet_video(pkt->width, pkt->height);
+        for (int p = 0; cp && p < 3; ++p) {
+            int w = p ? pkt->width / 2 : pkt->width;
+            int h = p ? pkt->height / 2 : pkt->height;
+            for (int y = 0; y < h; ++y) {
+                memcpy(cp->plane[p] + y * cp->stride[p], pkt->plane[p] + y * pkt->stride[p], w);
+            }
+        }
+    }
+    if (cp == NULL) {
+        return NULL;
+    }
+    cp->pts     = pkt->pts;
+    cp->tOrigin = pkt->tOrigin;
+    ksy_packet_release(pkt);
+    return cp;
+}
+
+#pragma mark - scheduler
+// 队列有变化: 唤醒等待的调度线程
+static void wake(KSYMediaGraph* g) {
+    atomic_fetch_add_explicit(&g->seq, 1, memory_order_acq_rel);
+    pthread_mutex_lock(&g->lock);
+    pthread_cond_broadcast(&g->cond);
+    pthread_mutex_unlock(&g->lock);
+}
+
+static BOOL edgeFull(const GraphEdge* e) {
+    return !atomic_load_explicit(&e->bClosed, memory_order_acquire) && ksy_ring_fill(e->q) >= e->cap;
+}
+
+static BOOL edgeEnded(const GraphEdge* e) {
+    return atomic_load_explicit(&e->bEnd, memory_order_acquire) && ksy_ring_fill(e->q) <= 0;
+}
+
+static BOOL allInputsEnded(const KSYMediaNode* n) {
+    for (int p = 0; p < n->desc.nbIn; ++p) {
+        if (!edgeEnded(n->in[p])) {
+            return NO;
+        }
+    }
+    return n->desc.nbIn > 0;
+}
+
+static BOOL runnable(KSYMediaGraph* g, KSYMediaNode* n) {
+    if (atomic_load_explicit(&n->bDone, memory_order_relaxed) ||
+        atomic_load_explicit(&n->idleSeq, memory_order_relaxed) ==
+        atomic_load_explicit(&g->seq, memory_order_acquire)) {
+        return NO;
+    }
+    for (int p = 0; p < n->desc.nbOut; ++p) { // 背压
+        for (int f = 0; f < n->nbFan[p]; ++f) {
+            if (edgeFull(n->out[p][f])) {
+                return NO;
+            }
+        }
+    }
+    if (n->desc.nbIn == 0) {
+        return YES;
+    }
+    for (int p = 0; p < n->desc.nbIn; ++p) {
+        if (ksy_ring_fill(n->in[p]->q) > 0) {
+            return YES;
+        }
+    }
+    return allInputsEnded(n); // 结束前最后调用一次
+}
+
+static KSYMediaNode* pickNode(KSYMediaGraph* g) {
+    int start = atomic_fetch_add_explicit(&g->next, 1, memory_order_relaxed);
+    for (int i = 0; i < g->nbNode; ++i) {
+        KSYMediaNode * n = g->nodes[(start + i) % g->nbNode];
+        BOOL bFree = NO;
+        if (runnable(g, n) &&
+            atomic_compare_exchange_strong_explicit(&n->bBusy, &bFree, YES,
+                                                    memory_order_acquire, memory_order_relaxed)) {
+            return n;
+        }
+    }
+    return NULL;
+}
+
+static void finishNode(KSYMediaGraph* g, KSYMediaNode* n) {
+    for (int p = 0; p < n->desc.nbIn; ++p) { // 上游不再因为背压停下
+        atomic_store_explicit(&n->in[p]->bClosed, YES, memory_order_release);
+    }
+    for (int p = 0; p < n->desc.nbOut; ++p) {
+        for (int f = 0; f < n->nbFan[p]; ++f) {
+            atomic_store_explicit(&n->out[p][f]->bEnd, YES, memory_order_release);
+        }
+    }
+    atomic_store_explicit(&n->bDone, YES, memory_order_release);
+    atomic_fetch_add_explicit(&g->nbDone, 1, memory_order_acq_rel);
+    pthread_mutex_lock(&g->lock);
+    pthread_cond_broadcast(&g->doneCond);
+    pthread_mutex_unlock(&g->lock);
+    wake(g);
+}
+
+static void runNode(KSYMediaGraph* g, KSYMediaNode* n) {
+    int     seq = atomic_load_explicit(&g->seq, memory_order_acquire);
+    int64_t t0  = ksy_graph_now_ns();
+    n->bProgress = NO;
+    KSYNodeResult r = n->desc.process(n, n->desc.ctx);
+    atomic_fetch_add_explicit(&n->busyNs, ksy_graph_now_ns() - t0, memory_order_relaxed);
+    atomic_fetch_add_explicit(&n->calls, 1, memory_order_relaxed);
+    if (r != KSYNode_End && !n->bProgress && allInputsEnded(n)) {
+        r = KSYNode_End; // 输入都已结束, 节点没有更多的输出
+    }
+    if (r == KSYNode_End) {
+        finishNode(g, n);
+    }
+    else if (r == KSYNode_Again || !n->bProgress) {
+        atomic_store_explicit(&n->idleSeq, seq, memory_order_relaxed);
+    }
+    atomic_store_explicit(&n->bBusy, NO, memory_order_release);
+}
+
+static void* graphThread(void* arg) {
+    KSYMediaGraph * g = arg;
+    while (!atomic_load_explicit(&g->bQuit, memory_order_acquire)) {
+        int seq = atomic_load_explicit(&g->seq, memory_order_acquire);
+        KSYMediaNode * n = pickNode(g);
+        if (n) {
+            runNode(g, n);
+            continue; // 执行期间的事件可能使该节点 (或其他节点) 又可以运行
+        }
+        pthread_mutex_lock(&g->lock);
+        while (!atomic_load_explicit(&g->bQuit, memory_order_acquire) &&
+               atomic_load_explicit(&g->seq, memory_order_acquire) == seq) {
+            pthread_cond_wait(&g->cond, &g->lock);
+        }
+        pthread_mutex_unlock(&g->lock);
+    }
+    return NULL;
+}
+
+#pragma mark - graph
+KSYMediaGraph* ksy_graph_create(int nbThread) {
+    if (nbThread < 1 || nbThread > KSY_GRAPH_MAX_THREAD) {
+        return NULL;
+    }
+    KSYMediaGraph * g = calloc(1, sizeof(KSYMediaGraph));
+    if (g == NULL) {
+        return NULL;
+    }
+    g->nbThread = nbThread;
+    atomic_init(&g->seq, 0);
+    atomic_init(&g->next, 0);
+    atomic_init(&g->nbDone, 0);
+    atomic_init(&g->bQuit, NO);
+    pthread_mutex_init(&g->lock, NULL);
+    condInit(&g->cond);
+    condInit(&g->doneCond);
+    return g;
+}
+
+void ksy_graph_destroy(KSYMediaGraph* g) {
+    if (g == NULL) {
+        return;
+    }
+    ksy_graph_stop(g);
+    for (int i = 0; i < g->nbEdge; ++i) {
+        KSYMediaPacket * pkt = NULL;
+        while (ksy_ring_read(g->edges[i]->q, &pkt, 1) == 1) {
+            ksy_packet_release(pkt);
+        }
+        ksy_ring_destroy(g->edges[i]->q);
+        free(g->edges[i]);
+    }
+    for (int i = 0; i < g->nbNode; ++i) {
+        KSYMediaNode * n = g->nodes[i];
+        if (n->desc.destroy) {
+            n->desc.destroy(n->desc.ctx);
+        }
+        free(n);
+    }
+    pthread_cond_destroy(&g->doneCond);
+    pthread_cond_destroy(&g->cond);
+    pthread_mutex_destroy(&g->lock);
+    free(g);
+}
+
+KSYMediaNode* ksy_graph_add_node(KSYMediaGraph* g, const KSYNodeDesc* desc) {
+    if (desc == NULL) {
+        return NULL;
+    }
+    KSYMediaNode * n = NULL;
+    if (g && g->nbStarted == 0 && g->nbNode < KSY_GRAPH_MAX_NODE && desc->process &&
+        desc->nbIn >= 0 && desc->nbIn <= KSY_NODE_MAX_PORT &&
+        desc->nbOut >= 0 && desc->nbOut <= KSY_NODE_MAX_PORT) {
+        n = calloc(1, sizeof(KSYMediaNode));
+    }
+    if (n == NULL) {
+        if (desc->destroy) {
+            desc->destroy(desc->ctx);
+        }
+        return NULL;
+    }
+    n->g    = g;
+    n->desc = *desc;
+    snprintf(n->name, sizeof(n->name), "%s", desc->name ? desc->name : "node");
+    n->desc.name = n->name;
+    atomic_init(&n->bBusy, NO);
+    atomic_init(&n->bDone, NO);
+    atomic_init(&n->idleSeq, -1);
+    atomic_init(&n->calls, 0);
+    atomic_init(&n->pktIn, 0);
+    atomic_init(&n->pktOut, 0);
+    atomic_init(&n->dropCnt, 0);
+    atomic_init(&n->blockCnt, 0);
+    atomic_init(&n->busyNs, 0);
+    atomic_init(&n->waitMs, 0);
+    atomic_init(&n->latencyMs, 0);
+    atomic_init(&n->maxLatencyMs, 0);
+    g->nodes[g->nbNode++] = n;
+    return n;
+}
+
+static GraphEdge* newEdge(KSYMediaGraph* g, KSYMediaNode* src, KSYMediaNode* dst, int capacity) {
+    if (g->nbEdge >= GRAPH_MAX_EDGE || capacity < 1) {
+        return NULL;
+    }
+    GraphEdge * e = calloc(1, sizeof(GraphEdge));
+    if (e == NULL) {
+        return NULL;
+    }
+    e->q = ksy_ring_create(capacity, sizeof(KSYMediaPacket*));
+    if (e->q == NULL) {
+        free(e);
+        return NULL;
+    }
+    e->cap = capacity;
+    e->src = src;
+    e->dst = dst;
+    atomic_init(&e->bEnd, NO);
+    atomic_init(&e->bClosed, NO);
+    g->edges[g->nbEdge++] = e;
+    return e;
+}
+
+// 外部输入节点: 把入口队列中的包原样输出
+static KSYNodeResult inputProcess(KSYMediaNode* node, void* ctx) {
+    (void)ctx;
+    BOOL bDid = NO;
+    while (ksy_node_can_push(node, 0)) {
+        KSYMediaPacket * pkt = ksy_node_pop(node, 0);
+        if (pkt == NULL) {
+            break;
+        }
+        ksy_node_push(node, 0, pkt);
+        bDid = YES;
+    }
+    return bDid ? KSYNode_Ok : KSYNode_Again;
+}
+
+KSYMediaNode* ksy_graph_add_input(KSYMediaGraph* g, const char* name, KSYMediaType type, int capacity) {
+    KSYNodeDesc desc = {0};
+    desc.name       = name;
+    desc.nbIn       = 1;
+    desc.nbOut      = 1;
+    desc.inType[0]  = type;
+    desc.outType[0] = type;
+    desc.process    = inputProcess;
+    KSYMediaNode * n = ksy_graph_add_node(g, &desc);
+    if (n) {
+        n->in[0] = newEdge(g, NULL, n, capacity);
+        if (n->in[0] == NULL) {
+            return NULL; // 节点随图一起销毁, start 时检查出未连接的端口
+        }
+    }
+    return n;
+}
+
+BOOL ksy_graph_connect(KSYMediaGraph* g, KSYMediaNode* src, int outPort,
+                       KSYMediaNode* dst, int inPort, int capacity) {
+    if (g == NULL || src == NULL || dst == NULL || g->nbStarted > 0 ||
+        src->g != g || dst->g != g ||
+        outPort < 0 || outPort >= src->desc.nbOut || inPort < 0 || inPort >= dst->desc.nbIn ||
+        src->desc.outType[outPort] != dst->desc.inType[inPort] ||
+        dst->in[inPort] != NULL || src->nbFan[outPort] >= KSY_NODE_MAX_FANOUT) {
+        return NO;
+    }
+    GraphEdge * e = newEdge(g, src, dst, capacity);
+    if (e == NULL) {
+        return NO;
+    }
+    dst->in[inPort] = e;
+    src->out[outPort][src->nbFan[outPort]++] = e;
+    return YES;
+}
+
+BOOL ksy_graph_start(KSYMediaGraph* g) {
+    if (g == NULL || g->nbStarted > 0 || g->nbNode == 0) {
+        return NO;
+    }
+    for (int i = 0; i < g->nbNode; ++i) {
+        KSYMediaNode * n = g->nodes[i];
+        for (int p = 0; p < n->desc.nbIn; ++p) {
+            if (n->in[p] == NULL) {
+                return NO;
+            }
+        }
+        for (int p = 0; p < n->desc.nbOut; ++p) {
+            if (n->nbFan[p] == 0) {
+                return NO;
+            }
+        }
+    }
+    atomic_store(&g->bQuit, NO);
+    for (int i = 0; i < g->nbThread; ++i) {
+        if (pthread_create(&g->thread[i], NULL, graphThread, g) != 0) {
+            break;
+        }
+        g->nbStarted += 1;
+    }
+    if (g->nbStarted == 0) {
+        return NO;
+    }
+    wake(g);
+    return YES;
+}
+
+BOOL ksy_graph_wait(KSYMediaGraph* g, int timeoutMs) {
+    if (g == NULL) {
+        return NO;
+    }
+    int64_t until = ksy_graph_now_ns() + (int64_t)(timeoutMs > 0 ? timeoutMs : 0) * 1000000;
+    pthread_mutex_lock(&g->lock);
+    while (atomic_load(&g->nbDone) < g->nbNode) {
+        if (timeoutMs < 0) {
+            pthread_cond_wait(&g->doneCond, &g->lock);
+        }
+        else if (condWaitUntil(&g->doneCond, &g->lock, until) != 0) {
+            break;
+        }
+    }
+    BOOL bDone = atomic_load(&g->nbDone) >= g->nbNode;
+    pthread_mutex_unlock(&g->lock);
+    return bDone;
+}
+
+void ksy_graph_stop(KSYMediaGraph* g) {
+    if (g == NULL || g->nbStarted == 0) {
+        return;
+    }
+    atomic_store_explicit(&g->bQuit, YES, memory_order_release);
+    wake(g);
+    for (int i = 0; i < g->nbStarted; ++i) {
+        pthread_join(g->thread[i], NULL);
+    }
+    g->nbStarted = 0;
+}
+
+BOOL ksy_graph_inject(KSYMediaNode* input, KSYMediaPacket* pkt) {
+    if (input == NULL || pkt == NULL) {
+        ksy_packet_release(pkt);
+        return NO;
+    }
+    GraphEdge * e = input->in[0];
+    if (e == NULL || e->src != NULL || atomic_load(&e->bEnd) || atomic_load(&e->bClosed) || edgeFull(e) ||
+        pkt->type != input->desc.inType[0]) {
+        atomic_fetch_add_explicit(&input->dropCnt, 1, memory_order_relaxed);
+        ksy_packet_release(pkt);
+        return NO;
+    }
+    pkt->tPush   = ksy_graph_now_ns();
+    pkt->tOrigin = pkt->tOrigin ? pkt->tOrigin : pkt->tPush;
+    ksy_ring_write(e->q, &pkt, 1);
+    wake(input->g);
+    return YES;
+}
+
+BOOL ksy_graph_inject_wait(KSYMediaNode* input, KSYMediaPacket* pkt, int timeoutMs) {
+    GraphEdge * e = (input && pkt) ? input->in[0] : NULL;
+    if (e && e->src == NULL && timeoutMs > 0 && edgeFull(e)) {
+        // 下游取出包时 (ksy_node_pop) 会加锁广播 cond, 在锁内检查不会错过
+        KSYMediaGraph * g = input->g;
+        int64_t until = ksy_graph_now_ns() + (int64_t)timeoutMs * 1000000;
+        atomic_fetch_add_explicit(&input->blockCnt, 1, memory_order_relaxed);
+        pthread_mutex_lock(&g->lock);
+        while (edgeFull(e) && !atomic_load(&e->bEnd) &&
+               !atomic_load_explicit(&g->bQuit, memory_order_acquire)) {
+            if (condWaitUntil(&g->cond, &g->lock, until) != 0) {
+                break;
+            }
+        }
+        pthread_mutex_unlock(&g->lock);
+    }
+    return ksy_graph_inject(input, pkt);
+}
+
+void ksy_graph_end_input(KSYMediaNode* input) {
+    if (input && input->in[0] && input->in[0]->src == NULL) {
+        atomic_store_explicit(&input->in[0]->bEnd, YES, memory_order_release);
+        wake(input->g);
+    }
+}
+
+int ksy_graph_node_count(const KSYMediaGraph* g) {
+    return g ? g->nbNode : 0;
+}
+
+void ksy_graph_node_stat(const KSYMediaGraph* g, int idx, KSYNodeStat* stat) {
+    if (g == NULL || stat == NULL || idx < 0 || idx >= g->nbNode) {
+        return;
+    }
+    KSYMediaNode * n = g->nodes[idx];
+    stat->name         = n->name;
+    stat->calls        = atomic_load_explicit(&n->calls, memory_order_relaxed);
+    stat->pktIn        = atomic_load_explicit(&n->pktIn, memory_order_relaxed);
+    stat->pktOut       = atomic_load_explicit(&n->pktOut, memory_order_relaxed);
+    stat->dropCnt      = atomic_load_explicit(&n->dropCnt, memory_order_relaxed);
+    stat->blockCnt     = atomic_load_explicit(&n->blockCnt, memory_order_relaxed);
+    stat->busyMs       = atomic_load_explicit(&n->busyNs, memory_order_relaxed) * 1e-6;
+    stat->waitMs       = atomic_load_explicit(&n->waitMs, memory_order_relaxed);
+    stat->latencyMs    = atomic_load_explicit(&n->latencyMs, memory_order_relaxed);
+    stat->maxLatencyMs = atomic_load_explicit(&n->maxLatencyMs, memory_order_relaxed);
+    stat->bDone        = atomic_load_explicit(&n->bDone, memory_order_relaxed);
+    stat->queued       = 0;
+    for (int p = 0; p < n->desc.nbIn; ++p) {
+        stat->queued += n->in[p] ? ksy_ring_fill(n->in[p]->q) : 0;
+    }
+}
+
+#pragma mark - node
+int ksy_node_available(KSYMediaNode* node, int inPort) {
+    if (node == NULL || inPort < 0 || inPort >= node->desc.nbIn) {
+        return 0;
+    }
+    return ksy_ring_fill(node->in[inPort]->q);
+}
+
+BOOL ksy_node_ended(KSYMediaNode* node, int inPort) {
+    if (node == NULL || inPort < 0 || inPort >= node->desc.nbIn) {
+        return YES;
+    }
+    return edgeEnded(node->in[inPort]);
+}
+
+static void smooth(_Atomic float* v, float x) {
+    float old = atomic_load_explicit(v, memory_order_relaxed);
+    atomic_store_explicit(v, old + GRAPH_SMOOTH * (x - old), memory_order_relaxed);
+}
+
+KSYMediaPacket* ksy_node_pop(KSYMediaNode* node, int inPort) {
+    KSYMediaPacket * pkt = NULL;
+    if (node == NULL || inPort < 0 || inPort >= node->desc.nbIn ||
+        ksy_ring_read(node->in[inPort]->q, &pkt, 1) != 1) {
+        return NULL;
+    }
+    int64_t now = ksy_graph_now_ns();
+    float   lat = (now - pkt->tOrigin) * 1e-6f;
+    smooth(&node->waitMs, (now - pkt->tPush) * 1e-6f);
+    smooth(&node->latencyMs, lat);
+    if (lat > atomic_load_explicit(&node->maxLatencyMs, memory_order_relaxed)) {
+        atomic_store_explicit(&node->maxLatencyMs, lat, memory_order_relaxed);
+    }
+    atomic_fetch_add_explicit(&node->pktIn, 1, memory_order_relaxed);
+    node->bProgress = YES;
+    wake(node->g); // 上游有了空间
+    return pkt;
+}
+
+BOOL ksy_node_can_push(KSYMediaNode* node, int outPort) {
+    if (node == NULL || outPort < 0 || outPort >= node->desc.nbOut) {
+        return NO;
+    }
+    for (int f = 0; f < node->nbFan[outPort]; ++f) {
+        if (edgeFull(node->out[outPort][f])) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+void ksy_node_push(KSYMediaNode* node, int outPort, KSYMediaPacket* pkt) {
+    if (node == NULL || pkt == NULL || outPort < 0 || outPort >= node->desc.nbOut) {
+        ksy_packet_release(pkt);
+        return;
+    }
+    int64_t now = ksy_graph_now_ns();
+    pkt->tOrigin = pkt->tOrigin ? pkt->tOrigin : now;
+    pkt->tPush   = now;
+    int nbFan = node->nbFan[outPort];
+    for (int f = 0; f < nbFan; ++f) {
+        GraphEdge * e = node->out[outPort][f];
+        KSYMediaPacket * p = (f == nbFan - 1) ? pkt : ksy_packet_retain(pkt);
+        if (atomic_load_explicit(&e->bClosed, memory_order_acquire)) {
+            ksy_packet_release(p);
+            continue;
+        }
+        if (edgeFull(e)) {
+            atomic_fetch_add_explicit(&node->dropCnt, 1, memory_order_relaxed);
+            ksy_packet_release(p);
+            continue;
+        }
+        ksy_ring_write(e->q, &p, 1);
+    }
+    atomic_fetch_add_explicit(&node->pktOut, 1, memory_order_relaxed);
+    node->bProgress = YES;
+    wake(node->g);
+}
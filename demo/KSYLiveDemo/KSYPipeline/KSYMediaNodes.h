@@ -0,0 +1,75 @@
+//
+//  KSYMediaNodes.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYMediaGraph.h"
+
+/** 处理图的常用节点
+
+ 1. 文件源/文件输出: wav (16bit pcm / 32bit float, 输出float) 和 I420 裸数据, 用于离线运行和测试
+ 2. 函数节点: 用回调处理每个包 (一进一出, 或者只进不出的输出节点), 用于接入平台相关的处理
+ 3. 音频混合: 多路输入按固定块长对齐后相加, 已结束的输入不再等待
+ 4. 视频画中画: 把第二路 (最新的一帧) 缩放后叠加到第一路上
+ */
+
+/**
+ @abstract  包的处理函数 (调度线程)
+ @param     pkt 引用转移给函数
+ @return    输出的包 (可以是 pkt 本身), 返回NULL表示丢弃; 输出节点的返回值被释放
+ */
+typedef KSYMediaPacket* (*KSYPacketFn)(void* opaque, KSYMediaPacket* pkt);
+
+/**
+ @abstract  wav 文件源, 输出端口0: 音频
+ @param     blockFrames 每个包的帧数
+ @return    文件打不开或格式不支持时返回NULL
+ */
+KSYMediaNode* ksy_node_wav_source(KSYMediaGraph* g, const char* path, int blockFrames);
+
+/**
+ @abstract  wav 文件输出 (16bit pcm), 输入端口0: 音频; 采样率/声道数取第一个包的, 不一致的包丢弃
+ */
+KSYMediaNode* ksy_node_wav_sink(KSYMediaGraph* g, const char* path);
+
+/**
+ @abstract  I420 裸数据文件源, 输出端口0: 视频
+ @param     fps 用于计算时间戳
+ */
+KSYMediaNode* ksy_node_yuv_source(KSYMediaGraph* g, const char* path, int width, int height, int fps);
+
+/**
+ @abstract  I420 裸数据文件输出, 输入端口0: 视频
+ */
+KSYMediaNode* ksy_node_yuv_sink(KSYMediaGraph* g, const char* path);
+
+/**
+ @abstract  函数节点, 输入端口0 -> 输出端口0
+ */
+KSYMediaNode* ksy_node_map(KSYMediaGraph* g, const char* name, KSYMediaType type,
+                           KSYPacketFn fn, void* opaque);
+
+/**
+ @abstract  输出节点, 输入端口0, 每个包调用 fn
+ */
+KSYMediaNode* ksy_node_sink(KSYMediaGraph* g, const char* name, KSYMediaType type,
+                            KSYPacketFn fn, void* opaque);
+
+/**
+ @abstract  音频混合, 输入端口 0~nbIn-1 -> 输出端口0
+ @param     gain        各路的音量 (nbIn个, 为NULL时都为1)
+ @param     blockFrames 输出包的帧数
+ @discussion 输入的采样率/声道数须与参数一致, 不一致的包丢弃
+ */
+KSYMediaNode* ksy_node_audio_mix(KSYMediaGraph* g, int nbIn, int rate, int chCnt,
+                                 int blockFrames, const float* gain);
+
+/**
+ @abstract  画中画, 输入端口0: 主画面, 输入端口1: 小画面 -> 输出端口0
+ @param     x,y,w,h 小画面在主画面中的位置 (偶数, 超出主画面的部分裁掉)
+ @discussion 每个主画面帧叠加当时最新的小画面帧; 还没有小画面时原样输出
+ */
+KSYMediaNode* ksy_node_pip(KSYMediaGraph* g, int x, int y, int w, int h);
@@ -0,0 +1,601 @@
+//
+//  KSYMediaNodes.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYMediaNodes.h"
+#import "KSYAudioRing.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MIX_FIFO_FRAMES     48000   // 混合节点每路输入的缓存 (帧), 大于单个输入包
+
+static uint32_t rd32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+static int      rd16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+static void     wr32(uint8_t* p, uint32_t v) { p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24; }
+static void     wr16(uint8_t* p, int v) { p[0] = v; p[1] = v >> 8; }
+
+#pragma mark - wav source
+typedef struct {
+    FILE *      fp;
+    int         rate;
+    int         chCnt;
+    BOOL        bFloat;
+    int64_t     left;       // 还没读的帧数
+    int64_t     pos;        // 已输出的帧数
+    int         block;
+    void *      raw;
+} WavSource;
+
+static void wavSourceDestroy(void* ctx) {
+    WavSource * s = ctx;
+    if (s->fp) {
+        fclose(s->fp);
+    }
+    free(s->raw);
+    free(s);
+}
+
+static KSYNodeResult wavSourceProcess(KSYMediaNode* node, void* ctx) {
+    WavSource * s = ctx;
+    while (ksy_node_can_push(node, 0)) {
+        int nb = (int)(s->left < s->block ? s->left : s->block);
+        if (nb <= 0) {
+            return KSYNode_End;
+        }
+        int bpf = s->chCnt * (s->bFloat ? 4 : 2);
+        nb = (int)fread(s->raw, bpf, nb, s->fp);
+        KSYMediaPacket * pkt = nb > 0 ? ksy_packet_audio(s->rate, s->chCnt, nb) : NULL;
+        if (pkt == NULL) {
+            return KSYNode_End; // 文件被截断
+        }
+        int cnt = nb * s->chCnt;
+        if (s->bFloat) {
+            memcpy(pkt->pcm, s->raw, sizeof(float) * cnt);
+        }
+        else {
+            const int16_t * in = s->raw;
+            for (int i = 0; i < cnt; ++i) {
+                pkt->pcm[i] = in[i] * (1.0f / 32768);
+            }
+        }
+        pkt->pts  = s->pos * 1000000 / s->rate;
+        s->pos   += nb;
+        s->left  -= nb;
+        ksy_node_push(node, 0, pkt);
+    }
+    return KSYNode_Ok;
+}
+
+KSYMediaNode* ksy_node_wav_source(KSYMediaGraph* g, const char* path, int blockFrames) {
+    if (g == NULL || path == NULL || blockFrames <= 0) {
+        return NULL;
+    }
+    FILE * fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return NULL;
+    }
+    uint8_t hdr[12], ck[8], fmt[16];
+    int tag = 0, bits = 0, chCnt = 0, rate = 0;
+    int64_t dataSize = -1;
+    if (fread(hdr, 1, 12, fp) == 12 && memcmp(hdr, "RIFF", 4) == 0 && memcmp(hdr + 8, "WAVE", 4) == 0) {
+        while (fread(ck, 1, 8, fp) == 8) {
+            uint32_t size = rd32(ck + 4);
+            if (memcmp(ck, "fmt ", 4) == 0 && size >= 16 && fread(fmt, 1, 16, fp) == 16) {
+                tag   = rd16(fmt);
+                chCnt = rd16(fmt + 2);
+                rate  = (int)rd32(fmt + 4);
+                bits  = rd16(fmt + 14);
+                if (tag == 0xFFFE && size >= 40) { // WAVE_FORMAT_EXTENSIBLE, 取子格式
+                    uint8_t ext[24];
+                    if (fread(ext, 1, 24, fp) != 24) {
+                        break;
+                    }
+                    tag   = rd16(ext + 8);
+                    size -= 24;
+                }
+                fseek(fp, (size - 16) + (size & 1), SEEK_CUR);
+            }
+            else if (memcmp(ck, "data", 4) == 0) {
+                dataSize = size;
+                break;
+            }
+            else {
+                fseek(fp, size + (size & 1), SEEK_CUR);
+            }
+        }
+    }
+    BOOL bFloat = (tag == 3 && bits == 32);
+    WavSource * s = NULL;
+    if (dataSize >= 0 && ((tag == 1 && bits == 16) || bFloat) && chCnt >= 1 && chCnt <= 2 && rate > 0) {
+        s = calloc(1, sizeof(WavSource));
+    }
+    if (s) {
+        s->raw = malloc((size_t)blockFrames * chCnt * 4);
+    }
+    if (s == NULL || s->raw == NULL) {
+        free(s);
+        fclose(fp);
+        return NULL;
+    }
+    s->fp     = fp;
+    s->rate   = rate;
+    s->chCnt  = chCnt;
+    s->bFloat = bFloat;
+    s->left   = dataSize / (chCnt * bits / 8);
+    s->block  = blockFrames;
+    KSYNodeDesc desc = {0};
+    desc.name       = "wavSource";
+    desc.nbOut      = 1;
+    desc.outType[0] = KSYMediaType_Audio;
+    desc.ctx        = s;
+    desc.process    = wavSourceProcess;
+    desc.destroy    = wavSourceDestroy;
+    return ksy_graph_add_node(g, &desc);
+}
+
+#pragma mark - wav sink
+typedef struct {
+    FILE *      fp;
+    int         rate;
+    int         chCnt;
+    int64_t     nbFrame;
+    int16_t *   buf;
+    int         bufLen;
+} WavSink;
+
+// 写入 (或更新) 文件头
+static void wavSinkHeader(WavSink* s) {
+    uint32_t size = (uint32_t)(s->nbFrame * s->chCnt * 2);
+    uint8_t  h[44];
+    memcpy(h, "RIFF", 4);       wr32(h + 4, 36 + size);
+    memcpy(h + 8, "WAVEfmt ", 8); wr32(h + 16, 16);
+    wr16(h + 20, 1);
+    wr16(h + 22, s->chCnt);
+    wr32(h + 24, s->rate);
+    wr32(h + 28, s->rate * s->chCnt * 2);
+    wr16(h + 32, s->chCnt * 2);
+    wr16(h + 34, 16);
+    memcpy(h + 36, "data", 4);  wr32(h + 40, size);
+    fseek(s->fp, 0, SEEK_SET);
+    fwrite(h, 1, 44, s->fp);
+    fseek(s->fp, 0, SEEK_END);
+}
+
+static void wavSinkClose(WavSink* s) {
+    if (s->fp) {
+        if (s->chCnt > 0) {
+            wavSinkHeader(s);
+        }
+        fclose(s->fp);
+        s->fp = NULL;
+    }
+}
+
+static void wavSinkDestroy(void* ctx) {
+    WavSink * s = ctx;
+    wavSinkClose(s);
+    free(s->buf);
+    free(s);
+}
+
+static KSYNodeResult wavSinkProcess(KSYMediaNode* node, void* ctx) {
+    WavSink * s = ctx;
+    KSYMediaPacket * pkt = NULL;
+    while ((pkt = ksy_node_pop(node, 0))) {
+        if (pkt->pcm && s->fp && s->chCnt == 0) {
+            s->rate  = pkt->rate;
+            s->chCnt = pkt->chCnt;
+            wavSinkHeader(s);
+        }
+        int cnt = pkt->nbFrame * pkt->chCnt;
+        if (pkt->pcm && pkt->rate == s->rate && pkt->chCnt == s->chCnt && s->fp) {
+            if (cnt > s->bufLen) {
+                int16_t * buf = realloc(s->buf, sizeof(int16_t) * cnt);
+                if (buf) {
+                    s->buf    = buf;
+                    s->bufLen = cnt;
+                }
+            }
+            if (cnt <= s->bufLen) {
+                for (int i = 0; i < cnt; ++i) {
+                    float v = pkt->pcm[i] * 32768.0f;
+                    v = v > 32767.0f ? 32767.0f : (v < -32768.0f ? -32768.0f : v);
+                    s->buf[i] = (int16_t)(v < 0 ? v - 0.5f : v + 0.5f);
+                }
+                s->nbFrame += fwrite(s->buf, sizeof(int16_t) * s->chCnt, pkt->nbFrame, s->fp);
+            }
+        }
+        ksy_packet_release(pkt);
+    }
+    if (ksy_node_ended(node, 0)) {
+        wavSinkClose(s);
+        return KSYNode_End;
+    }
+    return KSYNode_Ok;
+}
+
+KSYMediaNode* ksy_node_wav_sink(KSYMediaGraph* g, const char* path) {
+    if (g == NULL || path == NULL) {
+        return NULL;
+    }
+    WavSink * s = calloc(1, sizeof(WavSink));
+    if (s == NULL) {
+        return NULL;
+    }
+    s->fp = fopen(path, "wb");
+    if (s->fp == NULL) {
+        free(s);
+        return NULL;
+    }
+    KSYNodeDesc desc = {0};
+    desc.name      = "wavSink";
+    desc.nbIn      = 1;
+    desc.inType[0] = KSYMediaType_Audio;
+    desc.ctx       = s;
+    desc.process   = wavSinkProcess;
+    desc.destroy   = wavSinkDestroy;
+    return ksy_graph_add_node(g, &desc);
+}
+
+#pragma mark - yuv source / sink
+typedef struct {
+    FILE *      fp;
+    int         width;
+    int         height;
+    int         fps;
+    int64_t     idx;
+} YuvFile;
+
+static void yuvFileDestroy(void* ctx) {
+    YuvFile * f = ctx;
+    if (f->fp) {
+        fclose(f->fp);
+    }
+    free(f);
+}
+
+static KSYNodeResult yuvSourceProcess(KSYMediaNode* node, void* ctx) {
+    YuvFile * f = ctx;
+    while (ksy_node_can_push(node, 0)) {
+        KSYMediaPacket * pkt = ksy_packet_video(f->width, f->height);
+        size_t size = (size_t)f->width * f->height * 3 / 2;
+        if (pkt == NULL || fread(pkt->plane[0], 1, size, f->fp) != size) {
+            ksy_packet_release(pkt);
+            return KSYNode_End;
+        }
+        pkt->pts = f->idx * 1000000 / f->fps;
+        f->idx  += 1;
+        ksy_node_push(node, 0, pkt);
+    }
+    return KSYNode_Ok;
+}
+
+static KSYNodeResult yuvSinkProcess(KSYMediaNode* node, void* ctx) {
+    YuvFile * f = ctx;
+    KSYMediaPacket * pkt = NULL;
+    while ((pkt = ksy_node_pop(node, 0))) {
+        for (int p = 0; pkt->plane[0] && p < 3; ++p) {
+            int w = p ? pkt->width / 2 : pkt->width;
+            int h = p ? pkt->height / 2 : pkt->height;
+            for (int y = 0; y < h; ++y) {
+                fwrite(pkt->plane[p] + y * pkt->stride[p], 1, w, f->fp);
+            }
+        }
+        f->idx += pkt->plane[0] ? 1 : 0;
+        ksy_packet_release(pkt);
+    }
+    if (ksy_node_ended(node, 0)) {
+        fflush(f->fp);
+        return KSYNode_End;
+    }
+    return KSYNode_Ok;
+}
+
+static KSYMediaNode* addYuvNode(KSYMediaGraph* g, const char* path, BOOL bSource,
+                                int width, int height, int fps) {
+    if (g == NULL || path == NULL) {
+        return NULL;
+    }
+    YuvFile * f = calloc(1, sizeof(YuvFile));
+    if (f == NULL) {
+        return NULL;
+    }
+    f->fp = fopen(path, bSource ? "rb" : "wb");
+    if (f->fp == NULL) {
+        free(f);
+        return NULL;
+    }
+    f->width  = width;
+    f->height = height;
+    f->fps    = fps;
+    KSYNodeDesc desc = {0};
+    if (bSource) {
+        desc.name       = "yuvSource";
+        desc.nbOut      = 1;
+        desc.outType[0] = KSYMediaType_Video;
+        desc.process    = yuvSourceProcess;
+    }
+    else {
+        desc.name       = "yuvSink";
+        desc.nbIn       = 1;
+        desc.inType[0]  = KSYMediaType_Video;
+        desc.process    = yuvSinkProcess;
+    }
+    desc.ctx     = f;
+    desc.destroy = yuvFileDestroy;
+    return ksy_graph_add_node(g, &desc);
+}
+
+KSYMediaNode* ksy_node_yuv_source(KSYMediaGraph* g, const char* path, int width, int height, int fps) {
+    if (width <= 0 || height <= 0 || (width & 1) || (height & 1) || fps <= 0) {
+        return NULL;
+    }
+    return addYuvNode(g, path, YES, width, height, fps);
+}
+
+KSYMediaNode* ksy_node_yuv_sink(KSYMediaGraph* g, const char* path) {
+    return addYuvNode(g, path, NO, 0, 0, 0);
+}
+
+#pragma mark - map / sink
+typedef struct {
+    KSYPacketFn fn;
+    void *      opaque;
+} FuncNode;
+
+static KSYNodeResult mapProcess(KSYMediaNode* node, void* ctx) {
+    FuncNode * f = ctx;
+    BOOL bDid = NO;
+    while (ksy_node_can_push(node, 0)) {
+        KSYMediaPacket * pkt = ksy_node_pop(node, 0);
+        if (pkt == NULL) {
+            break;
+        }
+        pkt = f->fn(f->opaque, pkt);
+        if (pkt) {
+            ksy_node_push(node, 0, pkt);
+        }
+        bDid = YES;
+    }
+    return bDid ? KSYNode_Ok : KSYNode_Again;
+}
+
+static KSYNodeResult sinkProcess(KSYMediaNode* node, void* ctx) {
+    FuncNode * f = ctx;
+    KSYMediaPacket * pkt = NULL;
+    BOOL bDid = NO;
+    while ((pkt = ksy_node_pop(node, 0))) {
+        ksy_packet_release(f->fn(f->opaque, pkt));
+        bDid = YES;
+    }
+    return bDid ? KSYNode_Ok : KSYNode_Again;
+}
+
+static KSYMediaNode* addFuncNode(KSYMediaGraph* g, const char* name, KSYMediaType type,
+                                 BOOL bMap, KSYPacketFn fn, void* opaque) {
+    if (g == NULL || fn == NULL) {
+        return NULL;
+    }
+    FuncNode * f = calloc(1, sizeof(FuncNode));
+    if (f == NULL) {
+        return NULL;
+    }
+    f->fn     = fn;
+    f->opaque = opaque;
+    KSYNodeDesc desc = {0};
+    desc.name       = name;
+    desc.nbIn       = 1;
+    desc.nbOut      = bMap ? 1 : 0;
+    desc.inType[0]  = type;
+    desc.outType[0] = type;
+    desc.ctx        = f;
+    desc.process    = bMap ? mapProcess : sinkProcess;
+    desc.destroy    = free;
+    return ksy_graph_add_node(g, &desc);
+}
+
+KSYMediaNode* ksy_node_map(KSYMediaGraph* g, const char* name, KSYMediaType type,
+                           KSYPacketFn fn, void* opaque) {
+    return addFuncNode(g, name ? name : "map", type, YES, fn, opaque);
+}
+
+KSYMediaNode* ksy_node_sink(KSYMediaGraph* g, const char* name, KSYMediaType type,
+                            KSYPacketFn fn, void* opaque) {
+    return addFuncNode(g, name ? name : "sink", type, NO, fn, opaque);
+}
+
+#pragma mark - audio mix
+typedef struct {
+    int             nbIn;
+    int             rate;
+    int             chCnt;
+    int             block;
+    float           gain[KSY_NODE_MAX_PORT];
+    KSYAudioRing *  fifo[KSY_NODE_MAX_PORT];
+    int64_t         tOrigin[KSY_NODE_MAX_PORT];  // 各路最近一个包进入图的时间
+    float *         tmp;
+    int64_t         pos;
+} AudioMix;
+
+static void mixDestroy(void* ctx) {
+    AudioMix * m = ctx;
+    for (int i = 0; i < m->nbIn; ++i) {
+        ksy_ring_destroy(m->fifo[i]);
+    }
+    free(m->tmp);
+    free(m);
+}
+
+static KSYNodeResult mixProcess(KSYMediaNode* node, void* ctx) {
+    AudioMix * m = ctx;
+    // 每路缓存不足一块时才取包, 缓存的数据量有上限
+    for (int i = 0; i < m->nbIn; ++i) {
+        KSYMediaPacket * pkt = NULL;
+        while (ksy_ring_fill(m->fifo[i]) < m->block && (pkt = ksy_node_pop(node, i))) {
+            if (pkt->pcm && pkt->rate == m->rate && pkt->chCnt == m->chCnt) {
+                ksy_ring_write(m->fifo[i], pkt->pcm, pkt->nbFrame);
+                m->tOrigin[i] = pkt->tOrigin;
+            }
+            ksy_packet_release(pkt);
+        }
+    }
+    while (ksy_node_can_push(node, 0)) {
+        int  nb    = 0;
+        BOOL bWait = NO;
+        for (int i = 0; i < m->nbIn; ++i) {
+            int fill = ksy_ring_fill(m->fifo[i]);
+            if (fill < m->block && !ksy_node_ended(node, i)) {
+                bWait = YES; // 等这一路的数据
+            }
+            nb = fill > nb ? fill : nb;
+        }
+        nb = nb < m->block ? nb : m->block;
+        if (bWait) {
+            return KSYNode_Again;
+        }
+        if (nb == 0) {
+            return KSYNode_End; // 全部输入都已结束
+        }
+        KSYMediaPacket * out = ksy_packet_audio(m->rate, m->chCnt, nb);
+        if (out == NULL) {
+            return KSYNode_Again;
+        }
+        int cnt = nb * m->chCnt;
+        memset(out->pcm, 0, sizeof(float) * cnt);
+        for (int i = 0; i < m->nbIn; ++i) {
+            int got = ksy_ring_read(m->fifo[i], m->tmp, nb) * m->chCnt;
+            for (int j = 0; j < got; ++j) {
+                out->pcm[j] += m->gain[i] * m->tmp[j];
+            }
+            if (got > 0 && m->tOrigin[i] && (out->tOrigin == 0 || m->tOrigin[i] < out->tOrigin)) {
+                out->tOrigin = m->tOrigin[i];
+            }
+        }
+        out->pts = m->pos * 1000000 / m->rate;
+        m->pos  += nb;
+        ksy_node_push(node, 0, out);
+    }
+    return KSYNode_Ok;
+}
+
+KSYMediaNode* ksy_node_audio_mix(KSYMediaGraph* g, int nbIn, int rate, int chCnt,
+                                 int blockFrames, const float* gain) {
+    if (g == NULL || nbIn < 1 || nbIn > KSY_NODE_MAX_PORT || rate <= 0 ||
+        chCnt < 1 || chCnt > 2 || blockFrames <= 0 || blockFrames > MIX_FIFO_FRAMES / 2) {
+        return NULL;
+    }
+    AudioMix * m = calloc(1, sizeof(AudioMix));
+    if (m == NULL) {
+        return NULL;
+    }
+    m->nbIn  = nbIn;
+    m->rate  = rate;
+    m->chCnt = chCnt;
+    m->block = blockFrames;
+    m->tmp   = malloc(sizeof(float) * blockFrames * chCnt);
+    BOOL bOk = (m->tmp != NULL);
+    KSYNodeDesc desc = {0};
+    for (int i = 0; i < nbIn; ++i) {
+        m->gain[i]     = gain ? gain[i] : 1.0f;
+        m->fifo[i]     = ksy_ring_create(MIX_FIFO_FRAMES, sizeof(float) * chCnt);
+        bOk            = bOk && m->fifo[i];
+        desc.inType[i] = KSYMediaType_Audio;
+    }
+    if (!bOk) {
+        mixDestroy(m);
+        return NULL;
+    }
+    desc.name       = "audioMix";
+    desc.nbIn       = nbIn;
+    desc.nbOut      = 1;
+    desc.outType[0] = KSYMediaType_Audio;
+    desc.ctx        = m;
+    desc.process    = mixProcess;
+    desc.destroy    = mixDestroy;
+    return ksy_graph_add_node(g, &desc);
+}
+
+#pragma mark - pip
+typedef struct {
+    int                 x, y, w, h;
+    KSYMediaPacket *    overlay;    // 最新的小画面
+} PipNode;
+
+static void pipDestroy(void* ctx) {
+    PipNode * p = ctx;
+    ksy_packet_release(p->overlay);
+    free(p);
+}
+
+// 最近邻缩放后覆盖到主画面的对应区域
+static void pipCompose(const PipNode* p, KSYMediaPacket* dst, const KSYMediaPacket* src) {
+    for (int pl = 0; pl < 3; ++pl) {
+        int sub = pl ? 2 : 1;
+        int dw  = dst->width / sub, dh = dst->height / sub;
+        int sw  = src->width / sub, sh = src->height / sub;
+        int rx  = p->x / sub, ry = p->y / sub, rw = p->w / sub, rh = p->h / sub;
+        for (int y = 0; y < rh && ry + y < dh; ++y) {
+            uint8_t *       d = dst->plane[pl] + (ry + y) * dst->stride[pl] + rx;
+            const uint8_t * s = src->plane[pl] + (int64_t)y * sh / rh * src->stride[pl];
+            for (int x = 0; x < rw && rx + x < dw; ++x) {
+                d[x] = s[(int64_t)x * sw / rw];
+            }
+        }
+    }
+}
+
+static KSYNodeResult pipProcess(KSYMediaNode* node, void* ctx) {
+    PipNode * p = ctx;
+    KSYMediaPacket * pkt = NULL;
+    while ((pkt = ksy_node_pop(node, 1))) { // 只保留最新的小画面
+        if (pkt->plane[0]) {
+            ksy_packet_release(p->overlay);
+            p->overlay = pkt;
+        }
+        else {
+            ksy_packet_release(pkt);
+        }
+    }
+    while (ksy_node_can_push(node, 0) && (pkt = ksy_node_pop(node, 0))) {
+        if (p->overlay && pkt->plane[0]) {
+            KSYMediaPacket * w = ksy_packet_writable(pkt);
+            if (w) {
+                pipCompose(p, w, p->overlay);
+                pkt = w;
+            }
+        }
+        ksy_node_push(node, 0, pkt);
+    }
+    // 主画面结束时结束, 不再等小画面
+    return ksy_node_ended(node, 0) ? KSYNode_End : KSYNode_Ok;
+}
+
+KSYMediaNode* ksy_node_pip(KSYMediaGraph* g, int x, int y, int w, int h) {
+    if (g == NULL || x < 0 || y < 0 || w <= 0 || h <= 0 || ((x | y | w | h) & 1)) {
+        return NULL;
+    }
+    PipNode * p = calloc(1, sizeof(PipNode));
+    if (p == NULL) {
+        return NULL;
+    }
+    p->x = x;
+    p->y = y;
+    p->w = w;
+    p->h = h;
+    KSYNodeDesc desc = {0};
+    desc.name       = "pip";
+    desc.nbIn       = 2;
+    desc.nbOut      = 1;
+    desc.inType[0]  = KSYMediaType_Video;
+    desc.inType[1]  = KSYMediaType_Video;
+    desc.outType[0] = KSYMediaType_Video;
+    desc.ctx        = p;
+    desc.process    = pipProcess;
+    desc.destroy    = pipDestroy;
+    return ksy_graph_add_node(g, &desc);
+}
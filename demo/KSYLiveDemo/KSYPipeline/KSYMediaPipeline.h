@@ -0,0 +1,104 @@
+//
+//  KSYMediaPipeline.h
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <CoreMedia/CoreMedia.h>
+#import "KSYMediaGraph.h"
+#import "KSYMediaNodes.h"
+
+/// 处理一个 CMSampleBufferRef (调度线程, 可以原地修改数据)
+typedef void (^KSYSampleBufferBlock)(CMSampleBufferRef sampleBuffer);
+
+/** 处理图 (KSYMediaGraph) 的 Objective-C 封装, 用于把回调中串行的处理步骤改为图中的节点
+
+ 1. 采集/混音等回调只调用 pushSampleBuffer:to: 把数据放入入口队列, 立即返回
+ 2. 处理步骤 (如限幅, 推流) 为图中的节点, 在调度线程上执行, 同一节点不会并发执行
+ 3. 入口队列满时丢弃并计数, 不阻塞采集/混音等实时线程 (抖动由队列长度吸收);
+    只有调用者标明为非实时的入口 (addInput:type:capacity:waitMs:, 如文件解码线程) 才等待下游 (背压)
+ 4. 图中的包携带 CMSampleBufferRef: 音频在送入时把PCM拷贝到内存池 (CMMemoryPool) 分配的新buffer,
+    回调返回后生产者可以重用自己的buffer; 视频只持有引用, 送入的 sampleBuffer 之后不能再被生产者修改
+ 5. 各节点的处理耗时/延迟/丢弃可以随时读取 (statString)
+ */
+@interface KSYMediaPipeline : NSObject
+
+/**
+ @abstract  初始化
+ @param     nbThread 调度线程数 (1~KSY_GRAPH_MAX_THREAD)
+ */
+- (instancetype) initWithThreads:(int)nbThread;
+
+/**
+ @abstract  底层的图, 可以直接添加 KSYMediaNodes 中的节点 (start 之前)
+ */
+@property (nonatomic, readonly) KSYMediaGraph * graph;
+
+/**
+ @abstract  添加入口节点 (start 之前)
+ @param     capacity 入口队列的长度 (包)
+ */
+- (KSYMediaNode*) addInput:(NSString*)name
+                      type:(KSYMediaType)type
+                  capacity:(int)capacity;
+
+/**
+ @abstract  添加非实时生产者的入口节点 (start 之前), 队列满时 pushSampleBuffer:to: 最多等待 waitMs
+ @discussion 只用于可以被拖慢的生产者; 采集/混音回调 (如 audioProcessingCallback) 在实时线程上,
+             等待会造成采集溢出, 应使用 addInput:type:capacity:
+ */
+- (KSYMediaNode*) addInput:(NSString*)name
+                      type:(KSYMediaType)type
+                  capacity:(int)capacity
+                    waitMs:(int)waitMs;
+
+/**
+ @abstract  添加处理节点 (start 之前), 处理后的数据继续送往下游
+ */
+- (KSYMediaNode*) addStage:(NSString*)name
+                      type:(KSYMediaType)type
+                     block:(KSYSampleBufferBlock)block;
+
+/**
+ @abstract  添加输出节点 (start 之前)
+ */
+- (KSYMediaNode*) addSink:(NSString*)name
+                     type:(KSYMediaType)type
+                    block:(KSYSampleBufferBlock)block;
+
+/**
+ @abstract  连接节点 (start 之前)
+ @param     capacity 队列的长度 (包)
+ */
+- (BOOL) connect:(KSYMediaNode*)src
+            port:(int)outPort
+              to:(KSYMediaNode*)dst
+            port:(int)inPort
+        capacity:(int)capacity;
+
+/**
+ @abstract  启动调度线程
+ */
+- (BOOL) start;
+
+/**
+ @abstract  停止调度线程 (dealloc 时自动停止)
+ */
+- (void) stop;
+
+/**
+ @abstract  送入数据 (入口节点的生产者线程)
+ @return    入口队列已满 (非实时入口为等待 waitMs 后仍然满) 时返回NO, 数据被丢弃
+ */
+- (BOOL) pushSampleBuffer:(CMSampleBufferRef)sampleBuffer
+                       to:(KSYMediaNode*)input;
+
+/**
+ @abstract  各节点的统计 (任意线程), 每个节点一行
+ */
+@property (nonatomic, readonly) NSString * statString;
+
+@end
@@ -0,0 +1,207 @@
+//
+//  KSYMediaPipeline.m
+//  KSYGPUStreamerDemo
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+
+#import "KSYMediaPipeline.h"
+
+@interface KSYMediaPipeline () {
+    KSYMediaGraph *     _graph;
+    NSMutableArray *    _blocks;    // 节点回调, 生存期与图相同
+    CMMemoryPoolRef     _memPool;   // 音频包的PCM, 释放后重用
+    // 非实时的入口及其最长等待时间
+    KSYMediaNode *      _waitInput[KSY_GRAPH_MAX_NODE];
+    int                 _waitMs[KSY_GRAPH_MAX_NODE];
+    int                 _nbWaitInput;
+}
+@end
+
+@implementation KSYMediaPipeline
+
+static void releaseSampleBuffer(void* opaque) {
+    CFRelease((CMSampleBufferRef)opaque);
+}
+
+// 把PCM拷贝到内存池分配的新buffer, 生成新的 CMSampleBuffer (格式和时间戳不变)
+static CMSampleBufferRef copyAudioBuffer(CMSampleBufferRef src, CFAllocatorRef alloc) {
+    CMBlockBufferRef       data = CMSampleBufferGetDataBuffer(src);
+    CMFormatDescriptionRef desc = CMSampleBufferGetFormatDescription(src);
+    size_t len = data ? CMBlockBufferGetDataLength(data) : 0;
+    if (len == 0 || desc == NULL) {
+        return NULL;
+    }
+    CMBlockBufferRef  bb  = NULL;
+    CMSampleBufferRef dst = NULL;
+    char *            ptr = NULL;
+    OSStatus err = CMBlockBufferCreateWithMemoryBlock(kCFAllocatorDefault, NULL, len, alloc, NULL,
+                                                      0, len, kCMBlockBufferAssureMemoryNowFlag, &bb);
+    if (err == noErr) {
+        err = CMBlockBufferGetDataPointer(bb, 0, NULL, NULL, &ptr);
+    }
+    if (err == noErr) {
+        err = CMBlockBufferCopyDataBytes(data, 0, len, ptr);
+    }
+    if (err == noErr) {
+        err = CMAudioSampleBufferCreateReadyWithPacketDescriptions(kCFAllocatorDefault, bb, desc,
+                                                                   CMSampleBufferGetNumSamples(src),
+                                                                   CMSampleBufferGetPresentationTimeStamp(src),
+                                                                   NULL, &dst);
+    }
+    if (bb) {
+        CFRelease(bb);
+    }
+    return err == noErr ? dst : NULL;
+}
+
+static KSYMediaPacket* callBlock(void* opaque, KSYMediaPacket* pkt) {
+    KSYSampleBufferBlock block = (__bridge KSYSampleBufferBlock)opaque;
+    if (pkt->opaque) {
+        block((CMSampleBufferRef)pkt->opaque);
+    }
+    return pkt;
+}
+
+- (instancetype) initWithThreads:(int)nbThread {
+    self = [super init];
+    if (self == nil) {
+        return nil;
+    }
+    _graph   = ksy_graph_create(nbThread);
+    _blocks  = [NSMutableArray array];
+    _memPool = CMMemoryPoolCreate(NULL);
+    if (_graph == NULL) {
+        return nil;
+    }
+    return self;
+}
+
+- (void) dealloc {
+    // 调度线程在此停止, 之后不再调用节点的回调; 队列中的包释放后内存池才能释放
+    ksy_graph_destroy(_graph);
+    if (_memPool) {
+        CMMemoryPoolInvalidate(_memPool);
+        CFRelease(_memPool);
+    }
+}
+
+- (KSYMediaGraph*) graph {
+    return _graph;
+}
+
+- (KSYMediaNode*) addInput:(NSString*)name
+                      type:(KSYMediaType)type
+                  capacity:(int)capacity {
+    return ksy_graph_add_input(_graph, name.UTF8String, type, capacity);
+}
+
+- (KSYMediaNode*) addInput:(NSString*)name
+                      type:(KSYMediaType)type
+                  capacity:(int)capacity
+                    waitMs:(int)waitMs {
+    KSYMediaNode * node = ksy_graph_add_input(_graph, name.UTF8String, type, capacity);
+    if (node && waitMs > 0 && _nbWaitInput < KSY_GRAPH_MAX_NODE) {
+        _waitInput[_nbWaitInput] = node;
+        _waitMs[_nbWaitInput]    = waitMs;
+        _nbWaitInput += 1;
+    }
+    return node;
+}
+
+- (KSYMediaNode*) addBlock:(KSYSampleBufferBlock)block
+                      name:(NSString*)name
+                      type:(KSYMediaType)type
+                     stage:(BOOL)bStage {
+    if (block == nil) {
+        return NULL;
+    }
+    KSYSampleBufferBlock blk = [block copy];
+    [_blocks addObject:blk];
+    void * opaque = (__bridge void*)blk;
+    if (bStage) {
+        return ksy_node_map(_graph, name.UTF8String, type, callBlock, opaque);
+    }
+    return ksy_node_sink(_graph, name.UTF8String, type, callBlock, opaque);
+}
+
+- (KSYMediaNode*) addStage:(NSString*)name
+                      type:(KSYMediaType)type
+                     block:(KSYSampleBufferBlock)block {
+    return [self addBlock:block name:name type:type stage:YES];
+}
+
+- (KSYMediaNode*) addSink:(NSString*)name
+                     type:(KSYMediaType)type
+                    block:(KSYSampleBufferBlock)block {
+    return [self addBlock:block name:name type:type stage:NO];
+}
+
+- (BOOL) connect:(KSYMediaNode*)src
+            port:(int)outPort
+              to:(KSYMediaNode*)dst
+            port:(int)inPort
+        capacity:(int)capacity {
+    return ksy_graph_connect(_graph, src, outPort, dst, inPort, capacity);
+}
+
+- (BOOL) start {
+    return ksy_graph_start(_graph);
+}
+
+- (void) stop {
+    ksy_graph_stop(_graph);
+}
+
+- (BOOL) pushSampleBuffer:(CMSampleBufferRef)sampleBuffer
+                       to:(KSYMediaNode*)input {
+    if (sampleBuffer == NULL || input == NULL) {
+        return NO;
+    }
+    KSYMediaType           type = KSYMediaType_Audio;
+    CMFormatDescriptionRef desc = CMSampleBufferGetFormatDescription(sampleBuffer);
+    if (desc && CMFormatDescriptionGetMediaType(desc) == kCMMediaType_Video) {
+        type = KSYMediaType_Video;
+    }
+    CMSampleBufferRef buf = NULL;
+    if (type == KSYMediaType_Audio) {
+        // 混音器的回调buffer在回调返回后可能被重用, 拷贝一份再交给调度线程
+        buf = copyAudioBuffer(sampleBuffer, CMMemoryPoolGetAllocator(_memPool));
+    }
+    else {
+        buf = (CMSampleBufferRef)CFRetain(sampleBuffer);
+    }
+    KSYMediaPacket * pkt = buf ? ksy_packet_wrap(type, (void*)buf, releaseSampleBuffer) : NULL;
+    if (pkt == NULL) {
+        return NO;
+    }
+    CMTime pts = CMSampleBufferGetPresentationTimeStamp(sampleBuffer);
+    if (CMTIME_IS_VALID(pts)) {
+        pkt->pts = CMTimeConvertScale(pts, 1000000, kCMTimeRoundingMethod_Default).value;
+    }
+    if (type == KSYMediaType_Audio) {
+        pkt->nbFrame = (int)CMSampleBufferGetNumSamples(sampleBuffer);
+    }
+    for (int i = 0; i < _nbWaitInput; ++i) { // 只有非实时的入口等待
+        if (_waitInput[i] == input) {
+            return ksy_graph_inject_wait(input, pkt, _waitMs[i]);
+        }
+    }
+    return ksy_graph_inject(input, pkt);
+}
+
+- (NSString*) statString {
+    NSMutableString * str = [NSMutableString string];
+    int cnt = ksy_graph_node_count(_graph);
+    for (int i = 0; i < cnt; ++i) {
+        KSYNodeStat st;
+        ksy_graph_node_stat(_graph, i, &st);
+        [str appendFormat:@"%@%s 包%lld 丢弃%lld 阻塞%lld 队列%d 耗时%.1fms 等待%.2fms 延迟%.2fms (最大%.1f)",
+         i ? @"\n" : @"", st.name, st.pktIn, st.dropCnt, st.blockCnt, st.queued,
+         st.busyMs, st.waitMs, st.latencyMs, st.maxLatencyMs];
+    }
+    return str;
+}
+
+@end
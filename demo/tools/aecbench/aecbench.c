@@ -0,0 +1,261 @@
+//
+//  aecbench.c
+//  aecbench
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+//  用合成的房间冲激响应离线测试回声消除的收敛和耗时 (可以在Linux/macOS上直接编译)
+//
+//  编译 (在本目录下):
+//    cc -O2 -std=gnu11 -Wno-deprecated -I../fxbench/compat -I../../KSYLiveDemo/KSYAudioUtils -x c \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioKernel.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioFFT.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioAec.m \
+//       aecbench.c -o aecbench -lm -lpthread
+//
+//  用法:
+//    aecbench [选项] [out.wav]
+//      -r 44100    采样率
+//      -s 10       时长 (秒)
+//      -t 200      滤波器的回声尾长 (毫秒)
+//      -d 40       回声路径的延迟 (毫秒, 播放+采集+声学)
+//      -T 250      房间的混响时间 RT60 (毫秒)
+//      -g -6       回声的增益 (dB)
+//      -c          在一半时长处改变回声路径, 测试重新收敛
+//      -D          在 40%~60% 处加入近端人声, 测试双讲
+//      -N          远端使用白噪声 (默认为类人声信号)
+//      -C          强制使用C实现的基础运算
+//    麦克风 = 远端 * 冲激响应 + 近端 + -60dB 白噪声
+//    out.wav 为双声道: 左为麦克风信号, 右为消除回声后的结果 (已补偿块延迟)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "KSYAudioAec.h"
+#include "KSYAudioKernel.h"
+
+static uint32_t s_seed = 1;
+
+static float frand(void) {
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return (s_seed >> 8) * (1.0f / 16777216.0f) * 2.0f - 1.0f;
+}
+
+static float grand(void) {
+    float s = 0;
+    for (int i = 0; i < 6; ++i) {
+        s += frand();
+    }
+    return s * 0.7071f;
+}
+
+// 类人声: 基频缓慢变化的谐波, 按音节开关
+static void synthVoice(float* out, int n, int rate, float f0, float level, float phase) {
+    double ph = 0;
+    for (int i = 0; i < n; ++i) {
+        double t   = (double)i / rate + phase;
+        double syl = fmod(t * 2.7, 1.0);
+        double env = syl < 0.7 ? sin(M_PI * syl / 0.7) : 0;
+        double f   = f0 * (1 + 0.15 * sin(2 * M_PI * 0.4 * t));
+        ph += 2 * M_PI * f / rate;
+        double s = 0;
+        for (int h = 1; h <= 20 && h * f < rate / 2; ++h) {
+            s += sin(h * ph) / h;
+        }
+        out[i] = (float)(level * env * s) + level * 0.05f * grand();
+    }
+}
+
+// 冲激响应: 直达声 + 指数衰减的噪声尾, 总能量归一化后乘以增益
+static void makeRir(float* h, int len, int rate, float delayMs, float rt60Ms, float gainDb) {
+    memset(h, 0, sizeof(float) * len);
+    int d = (int)(delayMs * rate / 1000);
+    double e = 0;
+    for (int i = d; i < len; ++i) {
+        double t = (double)(i - d) / rate;
+        h[i] = (float)(exp(-6.9 * t * 1000 / rt60Ms) * 0.4 * grand());
+        if (i == d) {
+            h[i] = 1.0f;
+        }
+        e += h[i] * h[i];
+    }
+    float g = (float)(pow(10, gainDb / 20) / sqrt(e));
+    for (int i = 0; i < len; ++i) {
+        h[i] *= g;
+    }
+}
+
+static void convolve(float* out, const float* x, int n, const float* h, int len, int from, int to) {
+    for (int i = from; i < to; ++i) {
+        double s = 0;
+        int kmax = i + 1 < len ? i + 1 : len;
+        for (int k = 0; k < kmax; ++k) {
+            if (h[k] != 0) {
+                s += h[k] * x[i - k];
+            }
+        }
+        out[i] = (float)s;
+    }
+}
+
+static double nowSec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void writeWav2(const char* path, const float* l, const float* r, int n, int rate) {
+    FILE * fp = fopen(path, "wb");
+    if (fp == NULL) {
+        fprintf(stderr, "cannot create %s\n", path);
+        return;
+    }
+    uint32_t size = (uint32_t)n * 4;
+    uint32_t hdr[11] = { 0x46464952, 36 + size, 0x45564157, 0x20746d66, 16,
+                         0x00020001, (uint32_t)rate, (uint32_t)rate * 4, 0x00100004,
+                         0x61746164, size };
+    fwrite(hdr, 4, 11, fp); // 小端
+    for (int i = 0; i < n; ++i) {
+        float v[2] = { l[i], r[i] };
+        int16_t s[2];
+        ksy_f32_to_s16(s, v, 2);
+        fwrite(s, 2, 2, fp);
+    }
+    fclose(fp);
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: aecbench [-r rate] [-s sec] [-t tailMs] [-d delayMs] [-T rt60Ms] "
+                    "[-g gainDb] [-c] [-D] [-N] [-C] [out.wav]\n");
+}
+
+int main(int argc, char** argv) {
+    int rate = 44100, tailMs = 200;
+    float sec = 10, delayMs = 40, rt60 = 250, gainDb = -6;
+    int bChange = 0, bDouble = 0, bForceC = 0, bNoise = 0;
+    int a = 1;
+    for (; a < argc && argv[a][0] == '-'; ++a) {
+        const char * opt = argv[a];
+        if (strcmp(opt, "-c") == 0) { bChange = 1; continue; }
+        if (strcmp(opt, "-D") == 0) { bDouble = 1; continue; }
+        if (strcmp(opt, "-C") == 0) { bForceC = 1; continue; }
+        if (strcmp(opt, "-N") == 0) { bNoise  = 1; continue; }
+        if (a + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const char * val = argv[++a];
+        if (strcmp(opt, "-r") == 0)      { rate    = atoi(val); }
+        else if (strcmp(opt, "-s") == 0) { sec     = atof(val); }
+        else if (strcmp(opt, "-t") == 0) { tailMs  = atoi(val); }
+        else if (strcmp(opt, "-d") == 0) { delayMs = atof(val); }
+        else if (strcmp(opt, "-T") == 0) { rt60    = atof(val); }
+        else if (strcmp(opt, "-g") == 0) { gainDb  = atof(val); }
+        else {
+            usage();
+            return 1;
+        }
+    }
+    const char * outPath = a < argc ? argv[a] : NULL;
+    ksy_audio_kernel_force_c(bForceC);
+    KSYAudioAec * aec = ksy_aec_create(rate, tailMs);
+    if (aec == NULL) {
+        fprintf(stderr, "invalid rate %d or tail %d ms\n", rate, tailMs);
+        return 1;
+    }
+    const int n   = (int)(sec * rate);
+    const int len = (int)((delayMs + rt60) * rate / 1000);
+    float * far  = calloc(n, sizeof(float));
+    float * near = calloc(n, sizeof(float));
+    float * echo = calloc(n, sizeof(float));
+    float * mic  = calloc(n, sizeof(float));
+    float * h    = calloc(len, sizeof(float));
+    if (bNoise) {
+        for (int i = 0; i < n; ++i) {
+            far[i] = 0.1f * grand();
+        }
+    }
+    else {
+        synthVoice(far, n, rate, 180, 0.3f, 0);
+    }
+    if (bDouble) {
+        int from = n * 4 / 10, to = n * 6 / 10;
+        synthVoice(near + from, to - from, rate, 120, 0.2f, 0.37f);
+    }
+    makeRir(h, len, rate, delayMs, rt60, gainDb);
+    convolve(echo, far, n, h, len, 0, bChange ? n / 2 : n);
+    if (bChange) {
+        makeRir(h, len, rate, delayMs + 7, rt60, gainDb + 2);
+        convolve(echo, far, n, h, len, n / 2, n);
+    }
+    for (int i = 0; i < n; ++i) {
+        mic[i] = echo[i] + near[i] + 0.001f * grand();
+    }
+
+    // 按采集回调的长度分段送入
+    const int feed = 1024;
+    float * out = malloc(sizeof(float) * n);
+    memcpy(out, mic, sizeof(float) * n);
+    double t0 = nowSec();
+    for (int off = 0; off < n; off += feed) {
+        int m = n - off < feed ? n - off : feed;
+        ksy_aec_process_f32(aec, far + off, out + off, m);
+    }
+    double wall = nowSec() - t0;
+    const int lag = ksy_aec_block_size(aec);
+    KSYAecStat st;
+    ksy_aec_get_stat(aec, &st);
+
+    // 每0.5秒的ERLE: 回声能量 / 残余回声能量 (扣除近端)
+    printf("rate %d, block %d, tail %d ms, echo delay %.0f ms, rt60 %.0f ms, kernel %s\n",
+           rate, lag, tailMs, delayMs, rt60, ksy_audio_kernel_name());
+    printf("  %6s %10s %10s\n", "time", "erle(dB)", "near(dB)");
+    const int seg = rate / 2;
+    double conv20 = -1, erleSum = 0;
+    int erleCnt = 0;
+    for (int s0 = 0; s0 + seg <= n - lag; s0 += seg) {
+        double ee = 0, rr = 0, nn = 0;
+        for (int i = s0; i < s0 + seg; ++i) {
+            double r = out[i + lag] - near[i];
+            ee += echo[i] * echo[i];
+            rr += r * r;
+            nn += near[i] * near[i];
+        }
+        double erle = 10 * log10((ee + 1e-12) / (rr + 1e-12));
+        double t = (double)(s0 + seg) / rate;
+        if (nn > 0) {
+            printf("  %6.1f %10.2f %10.2f  (double talk)\n", t, erle,
+                   10 * log10(nn / (rr + 1e-12)));
+        }
+        else {
+            printf("  %6.1f %10.2f %10s\n", t, erle, "-");
+        }
+        if (conv20 < 0 && erle >= 20) {
+            conv20 = t;
+        }
+        if (t > sec - 2 && nn == 0) {
+            erleSum += erle;
+            ++erleCnt;
+        }
+    }
+    printf("converge to 20 dB: %s%.1f s, erle of last 2 s %.2f dB, updates %d, resets %d\n",
+           conv20 < 0 ? "never " : "", conv20 < 0 ? 0 : conv20,
+           erleCnt ? erleSum / erleCnt : 0, st.nbUpdate, st.nbReset);
+    printf("cpu: %.2f us/block, %.2f us/10ms, %.3f%%\n",
+           wall * 1e6 / st.nbBlock, wall * 1e6 / st.nbBlock * rate / 100 / lag,
+           wall / sec * 100);
+    if (outPath) {
+        writeWav2(outPath, mic, out + lag, n - lag, rate);
+    }
+    ksy_aec_destroy(aec);
+    free(far);
+    free(near);
+    free(echo);
+    free(mic);
+    free(out);
+    free(h);
+    return 0;
+}
@@ -0,0 +1,504 @@
+//
+//  bgmbench.c
+//  bgmbench
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+//  离线测试背景音乐流式解码引擎 (KSYAudioBgmEngine) 的定位/循环/播放列表 (可以在Linux/macOS上直接编译)
+//
+//  编译 (在本目录下):
+//    cc -O2 -std=gnu11 -Wno-deprecated -I../fxbench/compat -I../../KSYLiveDemo/KSYAudioUtils -x c \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioRing.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioKernel.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioResampler.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioTimeStretch.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioCueTimeline.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioBgmEngine.m \
+//       bgmbench.c -o bgmbench -lm -lpthread
+//
+//  用法:
+//    bgmbench [选项] [a.wav b.wav ...]
+//      -r 44100    采样率 (给出wav时取第一个文件的采样率)
+//      -a 2000     预读时长 (毫秒)
+//      -b 1024     每次读取的帧数 (模拟混音器的块长)
+//      -x 4        读取速度 (实时的倍数, 0 为不等待)
+//      -d 0        合成解码源每解码1秒音频的额外耗时 (毫秒, 模拟压缩格式的解码)
+//    不给出文件时使用合成的解码源: 左声道为帧序号, 右声道为曲目id, 逐帧检查:
+//      1. 播放列表: 三首曲目首尾相接, 不能有缺失或重复的帧
+//      2. 循环: 长于/短于预解码文件头的两首曲目各循环多次, 结尾必须直接接上开头
+//      3. 定位: 播放中随机定位 (包括已解码完的结尾处), 定位后的第一帧必须是目标位置
+//    给出wav文件 (16位PCM) 时按播放列表播放, 报告启动耗时/解码CPU/预读长度
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "KSYAudioBgmEngine.h"
+
+static uint32_t s_seed = 1;
+
+static double frand01(void) {
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return (s_seed >> 8) * (1.0 / 16777216.0);
+}
+
+static double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+}
+
+static double s_costMs = 0; // 合成解码源每秒音频的额外耗时
+
+#pragma mark - synthetic source
+typedef struct {
+    int     id;
+    int64_t len;
+    int64_t pos;
+    int     rate;
+    int     ch;
+} SynSrc;
+
+static BOOL synOpen(void* ctx, int rate, int chCnt, int64_t* nbFrame) {
+    SynSrc* s = ctx;
+    s->rate = rate;
+    s->ch   = chCnt;
+    s->pos  = 0;
+    *nbFrame = s->len;
+    return YES;
+}
+
+static int synRead(void* ctx, float* buf, int nbFrame) {
+    SynSrc* s = ctx;
+    int n = (int)(s->len - s->pos < nbFrame ? s->len - s->pos : nbFrame);
+    for (int i = 0; i < n; ++i) {
+        buf[i*s->ch] = (float)(s->pos + i);
+        if (s->ch > 1) {
+            buf[i*s->ch + 1] = (float)s->id;
+        }
+    }
+    s->pos += n;
+    if (s_costMs > 0 && n > 0) { // 忙等, 计入线程CPU时间
+        double end = nowMs() + s_costMs * n / s->rate;
+        while (nowMs() < end) {
+        }
+    }
+    return n;
+}
+
+static BOOL synSeek(void* ctx, int64_t frame) {
+    SynSrc* s = ctx;
+    s->pos = frame < s->len ? frame : s->len;
+    return YES;
+}
+
+static void synClose(void* ctx) {
+    free(ctx);
+}
+
+static int enqueueSyn(KSYBgmEngine* eng, int id, int64_t len, BOOL bLoop) {
+    SynSrc* s = calloc(1, sizeof(SynSrc));
+    s->id  = id;
+    s->len = len;
+    KSYBgmSource src = { s, synOpen, synRead, synSeek, synClose };
+    return ksy_bgm_enqueue(eng, &src, bLoop);
+}
+
+#pragma mark - wav source
+typedef struct {
+    const char* path;
+    FILE*       fp;
+    long        dataOff;
+    int64_t     nbFrame;
+    int64_t     pos;
+    int         fileCh;
+    int         ch;
+    int16_t*    tmp;
+} WavSrc;
+
+static int wavProbe(const char* path, int* rate, int* ch, long* dataOff, int64_t* nbFrame) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return -1;
+    }
+    uint8_t hdr[12];
+    int ret = -1;
+    if (fread(hdr, 1, 12, fp) == 12 && memcmp(hdr, "RIFF", 4) == 0 &&
+        memcmp(hdr + 8, "WAVE", 4) == 0) {
+        uint8_t ck[8];
+        int bits = 0;
+        while (fread(ck, 1, 8, fp) == 8) {
+            uint32_t sz = ck[4] | ck[5] << 8 | ck[6] << 16 | (uint32_t)ck[7] << 24;
+            if (memcmp(ck, "fmt ", 4) == 0) {
+                uint8_t f[16];
+                if (sz < 16 || fread(f, 1, 16, fp) != 16) {
+                    break;
+                }
+                *ch   = f[2] | f[3] << 8;
+                *rate = f[4] | f[5] << 8 | f[6] << 16 | f[7] << 24;
+                bits  = f[14] | f[15] << 8;
+                fseek(fp, sz - 16 + (sz & 1), SEEK_CUR);
+            }
+            else if (memcmp(ck, "data", 4) == 0) {
+                if (bits == 16 && *ch > 0) {
+                    *dataOff = ftell(fp);
+                    *nbFrame = sz / (2 * *ch);
+                    ret = 0;
+                }
+                break;
+            }
+            else {
+                fseek(fp, sz + (sz & 1), SEEK_CUR);
+            }
+        }
+    }
+    fclose(fp);
+    return ret;
+}
+
+static BOOL wavOpen(void* ctx, int rate, int chCnt, int64_t* nbFrame) {
+    WavSrc* w = ctx;
+    int fileRate = 0;
+    if (wavProbe(w->path, &fileRate, &w->fileCh, &w->dataOff, &w->nbFrame) != 0 ||
+        fileRate != rate) {
+        return NO;
+    }
+    w->fp  = fopen(w->path, "rb");
+    w->ch  = chCnt;
+    w->tmp = malloc(sizeof(int16_t) * 4096 * w->fileCh);
+    if (w->fp == NULL || w->tmp == NULL) {
+        return NO;
+    }
+    fseek(w->fp, w->dataOff, SEEK_SET);
+    *nbFrame = w->nbFrame;
+    return YES;
+}
+
+static int wavRead(void* ctx, float* buf, int nbFrame) {
+    WavSrc* w = ctx;
+    int n = nbFrame < 4096 ? nbFrame : 4096;
+    if (n > w->nbFrame - w->pos) {
+        n = (int)(w->nbFrame - w->pos);
+    }
+    n = (int)fread(w->tmp, sizeof(int16_t) * w->fileCh, n, w->fp);
+    for (int i = 0; i < n; ++i) {
+        const int16_t* f = w->tmp + i * w->fileCh;
+        float l = f[0] / 32768.0f;
+        float r = w->fileCh > 1 ? f[1] / 32768.0f : l;
+        if (w->ch == 1) {
+            buf[i] = 0.5f * (l + r);
+        }
+        else {
+            buf[i*2]     = l;
+            buf[i*2 + 1] = r;
+        }
+    }
+    w->pos += n;
+    return n;
+}
+
+static BOOL wavSeek(void* ctx, int64_t frame) {
+    WavSrc* w = ctx;
+    w->pos = frame < w->nbFrame ? frame : w->nbFrame;
+    return fseek(w->fp, w->dataOff + (long)(w->pos * 2 * w->fileCh), SEEK_SET) == 0;
+}
+
+static void wavClose(void* ctx) {
+    WavSrc* w = ctx;
+    if (w->fp) {
+        fclose(w->fp);
+    }
+    free(w->tmp);
+    free(w);
+}
+
+#pragma mark - consumer
+typedef struct {
+    int nbStart, nbEnd, nbLoop, nbQueueEnd;
+} EventCnt;
+
+static void onEvent(void* opaque, KSYBgmEvent event, int trackId) {
+    EventCnt* c = opaque;
+    switch (event) {
+        case KSYBgmEvent_TrackStart: c->nbStart++;    break;
+        case KSYBgmEvent_Loop:       c->nbLoop++;     break;
+        case KSYBgmEvent_TrackEnd:   c->nbEnd++;      break;
+        case KSYBgmEvent_QueueEnd:   c->nbQueueEnd++; break;
+    }
+}
+
+static int    s_block = 1024;
+static double s_speed = 4;
+
+// 按设定的速度读取一块
+static int pull(KSYBgmEngine* eng, float* out, int rate) {
+    static double next = 0;
+    if (s_speed > 0) {
+        double now = nowMs();
+        if (next == 0 || next < now - 100) {
+            next = now;
+        }
+        if (next > now) {
+            usleep((useconds_t)((next - now) * 1000));
+        }
+        next += s_block * 1000.0 / rate / s_speed;
+    }
+    return ksy_bgm_read(eng, out, s_block);
+}
+
+// 逐帧检查: 同一曲目内帧序号连续, 换曲目时从0开始; 返回错误数
+typedef struct {
+    int     track;
+    int64_t idx;
+    int64_t lens[8];
+    int     errors;
+    int     joins;
+    int     wraps;
+    int64_t frames;
+} Checker;
+
+static void check(Checker* c, const float* buf, int n) {
+    for (int i = 0; i < n; ++i) {
+        int64_t idx = (int64_t)buf[i*2];
+        int     trk = (int)buf[i*2 + 1];
+        if (c->track >= 0) {
+            int64_t expect = c->idx + 1;
+            if (trk == c->track && expect == c->lens[trk]) {
+                expect = 0; // 循环
+            }
+            if (trk != c->track) {
+                if (idx != 0 || c->idx != c->lens[c->track] - 1) {
+                    c->errors++;
+                }
+                c->joins++;
+            }
+            else if (idx != expect) {
+                c->errors++;
+            }
+            else if (expect == 0) {
+                c->wraps++;
+            }
+        }
+        c->track = trk;
+        c->idx   = idx;
+        c->frames++;
+    }
+}
+
+static int testPlaylist(int rate, int aheadMs, float* out) {
+    KSYBgmEngine* eng = ksy_bgm_create(rate, 2, aheadMs);
+    EventCnt ev = {0};
+    ksy_bgm_set_event_callback(eng, onEvent, &ev);
+    Checker c = { .track = -1 };
+    c.lens[0] = (int64_t)(rate * 3.3);
+    c.lens[1] = (int64_t)(rate * 1.7) + 13;
+    c.lens[2] = rate * 2;
+    for (int i = 0; i < 3; ++i) {
+        enqueueSyn(eng, i, c.lens[i], NO);
+    }
+    int64_t total = c.lens[0] + c.lens[1] + c.lens[2];
+    int blocks = 0;
+    while (ev.nbQueueEnd == 0 && blocks++ < 100000) {
+        int n = pull(eng, out, rate);
+        check(&c, out, n);
+    }
+    KSYBgmStat st;
+    ksy_bgm_get_stat(eng, &st);
+    printf("playlist: %lld/%lld frames, %d joins, %d errors, events start %d end %d queueEnd %d, "
+           "underruns %lld -> %s\n",
+           (long long)c.frames, (long long)total, c.joins, c.errors,
+           ev.nbStart, ev.nbEnd, ev.nbQueueEnd, (long long)st.underrunCnt,
+           (c.frames == total && c.errors == 0 && c.joins == 2 && ev.nbEnd == 3) ? "ok" : "FAIL");
+    ksy_bgm_destroy(eng);
+    return c.errors || c.frames != total;
+}
+
+static int testLoop(int rate, int aheadMs, float* out, int64_t len, const char* name) {
+    KSYBgmEngine* eng = ksy_bgm_create(rate, 2, aheadMs);
+    EventCnt ev = {0};
+    ksy_bgm_set_event_callback(eng, onEvent, &ev);
+    Checker c = { .track = -1 };
+    c.lens[0] = len;
+    c.lens[1] = rate;
+    enqueueSyn(eng, 0, len, YES);
+    enqueueSyn(eng, 1, rate, NO);
+    while (c.frames < len * 5 + rate) {
+        int n = pull(eng, out, rate);
+        check(&c, out, n);
+    }
+    ksy_bgm_skip(eng); // 跳过循环的曲目, 播放下一首
+    c.track = -1;
+    int blocks = 0;
+    while (ev.nbQueueEnd == 0 && blocks++ < 100000) {
+        int n = pull(eng, out, rate);
+        check(&c, out, n);
+    }
+    KSYBgmStat st;
+    ksy_bgm_get_stat(eng, &st);
+    printf("loop %s (%lld frames): %d wraps, %d loop events, %d errors, next track %s, "
+           "underruns %lld -> %s\n",
+           name, (long long)len, c.wraps, ev.nbLoop, c.errors,
+           c.track == 1 && c.idx == rate - 1 ? "complete" : "incomplete",
+           (long long)st.underrunCnt,
+           (c.errors == 0 && c.wraps >= 5 && c.wraps == ev.nbLoop && c.track == 1) ? "ok" : "FAIL");
+    ksy_bgm_destroy(eng);
+    return c.errors || c.wraps < 5;
+}
+
+static int testSeek(int rate, int aheadMs, float* out) {
+    KSYBgmEngine* eng = ksy_bgm_create(rate, 2, aheadMs);
+    EventCnt ev = {0};
+    ksy_bgm_set_event_callback(eng, onEvent, &ev);
+    int64_t len = rate * 30;
+    enqueueSyn(eng, 0, len, NO);
+    enqueueSyn(eng, 1, rate * 5, NO);
+    int errors = 0, nbSeek = 0, posErr = 0;
+    double waitMs = 0, waitMax = 0;
+    int64_t last = -1;
+    for (int s = 0; s < 40; ++s) {
+        // 播放一段, 检查连续性和报告的位置
+        int nbBlock = 2 + (int)(frand01() * 20);
+        for (int b = 0; b < nbBlock; ++b) {
+            int n = pull(eng, out, rate);
+            for (int i = 0; i < n; ++i) {
+                int64_t idx = (int64_t)out[i*2];
+                if (last >= 0 && idx != last + 1 && (int)out[i*2 + 1] == 0) {
+                    errors++;
+                }
+                last = idx;
+            }
+            KSYBgmStat st;
+            ksy_bgm_get_stat(eng, &st);
+            if (n > 0 && st.trackId == 0 && st.position != last + 1) {
+                posErr++;
+            }
+        }
+        // 随机定位, 每4次有一次定位到结尾前1~1.5秒 (已解码完, 解码线程已进入下一首),
+        // 下一次定位即从这里开始
+        int64_t target = (s % 4 == 3) ? len - rate - (int64_t)(frand01() * rate / 2)
+                                      : (int64_t)(frand01() * (len - rate));
+        ksy_bgm_seek(eng, target);
+        nbSeek++;
+        double t0 = nowMs();
+        int n = 0;
+        while ((n = ksy_bgm_read(eng, out, s_block)) == 0 && nowMs() - t0 < 1000) {
+            usleep(500);
+        }
+        double w = nowMs() - t0;
+        waitMs += w;
+        waitMax = w > waitMax ? w : waitMax;
+        if (n == 0 || (int64_t)out[0] != target || (int)out[1] != 0) {
+            errors++;
+            printf("  seek %lld -> got %lld (track %d)\n",
+                   (long long)target, n ? (long long)out[0] : -1LL, n ? (int)out[1] : -1);
+        }
+        last = n ? (int64_t)out[(n - 1) * 2] : -1;
+    }
+    KSYBgmStat st;
+    ksy_bgm_get_stat(eng, &st);
+    printf("seek: %d seeks, %d errors, %d position mismatches, first data after %.2f ms avg "
+           "(%.2f max), underruns %lld -> %s\n",
+           nbSeek, errors, posErr, waitMs / nbSeek, waitMax, (long long)st.underrunCnt,
+           (errors == 0 && posErr == 0) ? "ok" : "FAIL");
+    ksy_bgm_destroy(eng);
+    return errors || posErr;
+}
+
+static int playFiles(int argc, char** argv, int first, int aheadMs, float* out) {
+    int rate = 0, ch = 0;
+    long off;
+    int64_t nb;
+    if (wavProbe(argv[first], &rate, &ch, &off, &nb) != 0) {
+        fprintf(stderr, "not a 16 bit PCM wav: %s\n", argv[first]);
+        return 1;
+    }
+    KSYBgmEngine* eng = ksy_bgm_create(rate, 2, aheadMs);
+    EventCnt ev = {0};
+    ksy_bgm_set_event_callback(eng, onEvent, &ev);
+    double t0 = nowMs(), tFirst = -1;
+    for (int a = first; a < argc; ++a) {
+        WavSrc* w = calloc(1, sizeof(WavSrc));
+        w->path = argv[a];
+        KSYBgmSource src = { w, wavOpen, wavRead, wavSeek, wavClose };
+        ksy_bgm_enqueue(eng, &src, NO);
+    }
+    int64_t frames = 0;
+    double cpuMax = 0, fillMin = 1e9, lastReport = 0;
+    while (ev.nbQueueEnd == 0) {
+        int n = pull(eng, out, rate);
+        if (n > 0 && tFirst < 0) {
+            tFirst = nowMs() - t0;
+        }
+        frames += n;
+        KSYBgmStat st;
+        ksy_bgm_get_stat(eng, &st);
+        if (frames > rate && (st.queued > 0 ||
+                              st.position + (int64_t)rate * aheadMs / 1000 < st.duration)) {
+            cpuMax  = st.cpuPercent > cpuMax ? st.cpuPercent : cpuMax;
+            fillMin = st.fillMs < fillMin ? st.fillMs : fillMin;
+        }
+        if (frames - lastReport >= rate * 5) {
+            lastReport = frames;
+            printf("  %6.1fs track %d pos %.1fs/%.1fs fill %.0f ms cpu %.2f%% queued %d\n",
+                   (double)frames / rate, st.trackId, (double)st.position / rate,
+                   (double)st.duration / rate, st.fillMs, st.cpuPercent, st.queued);
+        }
+    }
+    KSYBgmStat st;
+    ksy_bgm_get_stat(eng, &st);
+    printf("files: %d tracks (%d started, %d failed), %.1f s, first audio after %.2f ms, "
+           "cpu max %.2f%%, fill min %.0f ms, underruns %lld\n",
+           argc - first, ev.nbStart, ev.nbEnd - ev.nbStart, (double)frames / rate, tFirst,
+           cpuMax, fillMin, (long long)st.underrunCnt);
+    ksy_bgm_destroy(eng);
+    return 0;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: bgmbench [-r rate] [-a aheadMs] [-b block] [-x speed] "
+                    "[-d decodeCostMs] [a.wav ...]\n");
+}
+
+int main(int argc, char** argv) {
+    int rate = 44100, aheadMs = 2000;
+    int a = 1;
+    for (; a < argc && argv[a][0] == '-'; ++a) {
+        const char * opt = argv[a];
+        if (a + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const char * val = argv[++a];
+        if (strcmp(opt, "-r") == 0)      { rate     = atoi(val); }
+        else if (strcmp(opt, "-a") == 0) { aheadMs  = atoi(val); }
+        else if (strcmp(opt, "-b") == 0) { s_block  = atoi(val); }
+        else if (strcmp(opt, "-x") == 0) { s_speed  = atof(val); }
+        else if (strcmp(opt, "-d") == 0) { s_costMs = atof(val); }
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (s_block <= 0 || s_block > 8192 || ksy_bgm_create(rate, 2, aheadMs) == NULL) {
+        usage();
+        return 1;
+    }
+    float * out = malloc(sizeof(float) * s_block * 2);
+    if (a < argc) {
+        int ret = playFiles(argc, argv, a, aheadMs, out);
+        free(out);
+        return ret;
+    }
+    printf("rate %d, read-ahead %d ms, block %d, speed %.1fx, decode cost %.1f ms/s\n",
+           rate, aheadMs, s_block, s_speed, s_costMs);
+    int fail = 0;
+    fail |= testPlaylist(rate, aheadMs, out);
+    fail |= testLoop(rate, aheadMs, out, rate * 77 / 100, "long");
+    fail |= testLoop(rate, aheadMs, out, rate / 10 + 7, "short");
+    fail |= testSeek(rate, aheadMs, out);
+    free(out);
+    return fail;
+}
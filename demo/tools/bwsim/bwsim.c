@@ -0,0 +1,379 @@
+//
+//  bwsim.c
+//  bwsim
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+//  用带宽轨迹离线仿真推流码率自适应 (KSYBwEstimator), 比较不同的估计器 (可以在Linux/macOS上直接编译)
+//
+//  编译 (在本目录下):
+//    cc -O2 -std=gnu11 -Wno-deprecated -I../fxbench/compat -I../../KSYLiveDemo/KSYNetUtils -x c \
+//       ../../KSYLiveDemo/KSYNetUtils/KSYBwEstimator.m \
+//       bwsim.c -o bwsim -lm
+//
+//  用法:
+//    bwsim [选项]
+//      -e all      估计器: aimd / delay / all
+//      -t all      带宽轨迹: step / cell / spike / outage / all, 或文件 (每行: 时间ms 带宽kbps, 分段恒定)
+//      -i 1000     采样间隔 (毫秒), 与推流模块的统计周期一致
+//      -min 200 -max 2000 -init 800   视频码率范围和起始码率 (kbps)
+//      -a 48       音频码率 (kbps)
+//      -q 0        1: 估计器得到真实的队列延迟和RTT; 0: 与demo一样只有累计计数 (ksy_bwc_feed 推算积压)
+//      -v 0        1: 输出每次采样的时间线 (csv)
+//      -s 1        随机数种子
+//    模拟的发送端 (mock socket): 编码器按目标码率输出 (15fps, 2秒一个I帧, 新码率300ms后生效),
+//    发送队列按轨迹的带宽发出, 队首等待超过2秒时丢弃新的视频帧
+//    检查: 目标码率不超出范围; 延迟梯度在带宽骤降后更快排空队列, 各轨迹的队列延迟不高于AIMD
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "KSYBwEstimator.h"
+
+#define TICK_MS         10
+#define FPS             15
+#define GOP_FRAMES      30
+#define ENC_LAG_MS      300
+#define QUEUE_MAX_MS    2000
+#define BASE_RTT_MS     40
+#define MAX_PKT         16384
+#define HIST_BINS       2001    // 10ms 一格, 最后一格为 >= 20s
+
+static uint32_t s_seed = 1;
+
+static double urand(void) {
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return (s_seed >> 8) / 16777216.0;
+}
+
+static double nrand(void) {
+    double u = urand() + 1e-12, v = urand();
+    return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+#pragma mark - trace
+typedef struct {
+    char    name[64];
+    int     nb;
+    double  * t;    // 毫秒
+    double  * kbps;
+    double  durMs;
+} Trace;
+
+static void traceAdd(Trace* tr, double t, double kbps) {
+    tr->t    = realloc(tr->t, sizeof(double) * (tr->nb + 1));
+    tr->kbps = realloc(tr->kbps, sizeof(double) * (tr->nb + 1));
+    tr->t[tr->nb]    = t;
+    tr->kbps[tr->nb] = kbps;
+    tr->nb += 1;
+}
+
+static double traceAt(const Trace* tr, double t) {
+    double k = tr->nb ? tr->kbps[0] : 0;
+    for (int i = 0; i < tr->nb && tr->t[i] <= t; ++i) {
+        k = tr->kbps[i];
+    }
+    return k;
+}
+
+static int makeTrace(Trace* tr, const char* name) {
+    memset(tr, 0, sizeof(Trace));
+    snprintf(tr->name, sizeof(tr->name), "%s", name);
+    if (strcmp(name, "step") == 0) { // 带宽骤降再恢复
+        traceAdd(tr, 0, 2500);
+        traceAdd(tr, 30000, 600);
+        traceAdd(tr, 60000, 1800);
+        tr->durMs = 120000;
+    }
+    else if (strcmp(name, "cell") == 0) { // 蜂窝网络: 随机游走 + 偶尔的深衰落
+        double k = 1500;
+        for (double t = 0; t < 180000; t += 500) {
+            k *= exp(0.15 * nrand());
+            k  = k < 300 ? 300 : (k > 4000 ? 4000 : k);
+            BOOL bFade = urand() < 0.01;
+            traceAdd(tr, t, bFade ? k * 0.2 : k);
+            if (bFade) {
+                for (int i = 1; i < 4; ++i) {
+                    traceAdd(tr, t + i * 500, k * 0.2);
+                }
+                t += 1500;
+            }
+        }
+        tr->durMs = 180000;
+    }
+    else if (strcmp(name, "spike") == 0) { // 稳定的带宽上偶尔有1秒的尖峰
+        for (double t = 0; t < 120000; t += 10000) {
+            traceAdd(tr, t, 900);
+            traceAdd(tr, t + 5000, 4000);
+            traceAdd(tr, t + 6000, 900);
+        }
+        tr->durMs = 120000;
+    }
+    else if (strcmp(name, "outage") == 0) { // 3秒断网
+        traceAdd(tr, 0, 1500);
+        traceAdd(tr, 40000, 0);
+        traceAdd(tr, 43000, 1500);
+        tr->durMs = 100000;
+    }
+    else {
+        FILE * fp = fopen(name, "r");
+        if (fp == NULL) {
+            fprintf(stderr, "%s: no such trace\n", name);
+            return -1;
+        }
+        double t, k;
+        while (fscanf(fp, "%lf %lf", &t, &k) == 2) {
+            traceAdd(tr, t, k);
+            tr->durMs = t + 1000;
+        }
+        fclose(fp);
+        if (tr->nb == 0) {
+            fprintf(stderr, "%s: empty trace\n", name);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+#pragma mark - mock socket
+typedef struct {
+    int     bytes;
+    double  tEnq;
+} Pkt;
+
+typedef struct {
+    int     minKbps, maxKbps, initKbps, audioKbps;
+    int     intervalMs;
+    BOOL    bTrueDelay;
+    BOOL    bVerbose;
+} SimCfg;
+
+typedef struct {
+    double  util;           // 发出的数据量 / 可用的带宽
+    double  avgKbps;        // 平均视频目标码率
+    double  meanDelay;
+    double  p95Delay;
+    int     dropped;
+    int     changes;
+    double  drainMs;        // 带宽骤降后队列延迟回到 300ms 以下的时间 (step 轨迹)
+    BOOL    bRangeOk;
+} SimResult;
+
+static void simulate(const Trace* tr, const KSYBwEstimatorClass* cls, const SimCfg* cfg, SimResult* r) {
+    KSYBwControl * c = ksy_bwc_create(cls, cfg->minKbps, cfg->maxKbps, cfg->initKbps, cfg->audioKbps);
+    Pkt *   q      = malloc(sizeof(Pkt) * MAX_PKT);
+    int     qHead  = 0, qCnt = 0;
+    double  credit = 0;         // 本轮可发送的字节
+    int64_t sent   = 0;         // 累计发出的字节
+    int64_t offeredBytes = 0;   // 本区间编码输出的字节
+    int     dropped = 0, frame = 0, target = cfg->initKbps, encKbps = cfg->initKbps;
+    double  tTarget = 0, nextFrame = 0, nextAudio = 0, nextSample = cfg->intervalMs;
+    double  capSum = 0, sentSum = 0, tgtSum = 0, delaySum = 0;
+    int     nbTick = 0, nbSample = 0;
+    int *   hist = calloc(HIST_BINS, sizeof(int));
+    double  tDrop = -1, drainMs = -1;
+    memset(r, 0, sizeof(SimResult));
+    r->bRangeOk = YES;
+    ksy_bwc_feed(c, 0, 0, 0, 0, -1);
+    for (double t = 0; t < tr->durMs; t += TICK_MS) {
+        // 编码: 新的目标码率 ENC_LAG_MS 后生效
+        if (t >= tTarget + ENC_LAG_MS) {
+            encKbps = target;
+        }
+        while (t >= nextFrame) {
+            double unit  = encKbps * 1000.0 / 8 * GOP_FRAMES / FPS / (GOP_FRAMES + 3);
+            BOOL   bKey  = frame % GOP_FRAMES == 0;
+            int    bytes = (int)(unit * (bKey ? 4 : 1) * (1 + 0.15 * nrand() * 0.5));
+            bytes = bytes > 50 ? bytes : 50;
+            frame += 1;
+            nextFrame += 1000.0 / FPS;
+            double headAge = qCnt ? t - q[qHead].tEnq : 0;
+            if (headAge > QUEUE_MAX_MS || qCnt >= MAX_PKT) {
+                dropped += 1; // 发送阻塞, 丢弃新的视频帧
+                continue;
+            }
+            Pkt p = { bytes, t };
+            q[(qHead + qCnt++) % MAX_PKT] = p;
+            offeredBytes += bytes;
+        }
+        while (t >= nextAudio) {
+            int bytes = cfg->audioKbps * 1000 / 8 * 1024 / 44100;
+            nextAudio += 1024 * 1000.0 / 44100;
+            if (qCnt < MAX_PKT) {
+                Pkt p = { bytes, t };
+                q[(qHead + qCnt++) % MAX_PKT] = p;
+                offeredBytes += bytes;
+            }
+        }
+        // 发送
+        double cap = traceAt(tr, t);
+        credit += cap * 1000 / 8 * TICK_MS / 1000;
+        while (qCnt > 0 && credit >= q[qHead].bytes) {
+            credit -= q[qHead].bytes;
+            sent   += q[qHead].bytes;
+            sentSum += q[qHead].bytes * 8 / 1000.0;
+            qHead = (qHead + 1) % MAX_PKT;
+            qCnt -= 1;
+        }
+        if (qCnt == 0) {
+            credit = credit < 1500 ? credit : 1500; // 空闲时不积攒发送额度
+        }
+        double delay = qCnt ? t - q[qHead].tEnq : 0;
+        int    bin   = (int)(delay / 10);
+        hist[bin < HIST_BINS ? bin : HIST_BINS - 1] += 1;
+        delaySum += delay;
+        double usable = cap < cfg->maxKbps + cfg->audioKbps ? cap : cfg->maxKbps + cfg->audioKbps;
+        capSum += usable * TICK_MS / 1000;
+        tgtSum += target;
+        nbTick += 1;
+        // step 轨迹: 骤降后排空的时间
+        if (strcmp(tr->name, "step") == 0) {
+            if (tDrop < 0 && t >= 30000) {
+                tDrop = t;
+            }
+            if (tDrop >= 0 && drainMs < 0 && t > tDrop + 1000 && delay < 300) {
+                drainMs = t - tDrop;
+            }
+        }
+        // 采样
+        if (t + TICK_MS >= nextSample) {
+            double now = nextSample;
+            float offered = (float)(offeredBytes * 8.0 / cfg->intervalMs);
+            offeredBytes = 0;
+            int prev = target;
+            if (cfg->bTrueDelay) {
+                static int64_t lastSent = 0;
+                static int     lastDrop = 0;
+                if (nbSample == 0) {
+                    lastSent = 0;
+                    lastDrop = 0;
+                }
+                KSYBwSample s = {0};
+                s.tMs           = now;
+                s.intervalMs    = cfg->intervalMs;
+                s.sentKbps      = (float)((sent - lastSent) * 8.0 / cfg->intervalMs);
+                s.offeredKbps   = offered;
+                s.queueDelayMs  = (float)delay;
+                s.rttMs         = (float)(BASE_RTT_MS + delay);
+                s.droppedFrames = dropped - lastDrop;
+                lastSent = sent;
+                lastDrop = dropped;
+                target = ksy_bwc_update(c, &s);
+            }
+            else {
+                target = ksy_bwc_feed(c, now, sent / 1024, offered, dropped, -1);
+            }
+            if (target != prev) {
+                tTarget = now;
+            }
+            r->bRangeOk &= target >= cfg->minKbps && target <= cfg->maxKbps;
+            if (cfg->bVerbose) {
+                KSYBwStat st;
+                ksy_bwc_get_stat(c, &st);
+                printf("%s,%s,%.0f,%.0f,%d,%.0f,%.0f,%.0f,%d\n", tr->name, cls->name, now, cap,
+                       target, st.sentKbps, delay, st.queueDelayMs, dropped);
+            }
+            nextSample += cfg->intervalMs;
+            nbSample   += 1;
+        }
+    }
+    KSYBwStat st;
+    ksy_bwc_get_stat(c, &st);
+    int acc = 0, p95 = 0;
+    for (int i = 0; i < HIST_BINS; ++i) {
+        acc += hist[i];
+        if (acc >= nbTick * 0.95) {
+            p95 = i;
+            break;
+        }
+    }
+    r->util      = capSum > 0 ? sentSum / capSum : 0;
+    r->avgKbps   = tgtSum / nbTick;
+    r->meanDelay = delaySum / nbTick;
+    r->p95Delay  = p95 * 10.0;
+    r->dropped   = dropped;
+    r->changes   = st.raiseCnt + st.dropCnt;
+    r->drainMs   = drainMs;
+    free(hist);
+    free(q);
+    ksy_bwc_destroy(c);
+}
+
+int main(int argc, char** argv) {
+    const char * est = "all", * trace = "all";
+    SimCfg cfg = { 200, 2000, 800, 48, 1000, NO, NO };
+    for (int a = 1; a + 1 < argc; a += 2) {
+        if (strcmp(argv[a], "-e") == 0)         { est   = argv[a+1]; }
+        else if (strcmp(argv[a], "-t") == 0)    { trace = argv[a+1]; }
+        else if (strcmp(argv[a], "-i") == 0)    { cfg.intervalMs = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-min") == 0)  { cfg.minKbps    = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-max") == 0)  { cfg.maxKbps    = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-init") == 0) { cfg.initKbps   = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-a") == 0)    { cfg.audioKbps  = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-q") == 0)    { cfg.bTrueDelay = atoi(argv[a+1]) != 0; }
+        else if (strcmp(argv[a], "-v") == 0)    { cfg.bVerbose   = atoi(argv[a+1]) != 0; }
+        else if (strcmp(argv[a], "-s") == 0)    { s_seed = (uint32_t)atoi(argv[a+1]); }
+        else {
+            fprintf(stderr, "usage: bwsim [-e aimd|delay|all] [-t step|cell|spike|outage|all|file] "
+                    "[-i ms] [-min kbps] [-max kbps] [-init kbps] [-a kbps] [-q 0|1] [-v 0|1] [-s seed]\n");
+            return 1;
+        }
+    }
+    if (cfg.intervalMs < 50 || cfg.minKbps > cfg.maxKbps) {
+        fprintf(stderr, "bad interval or bitrate range\n");
+        return 1;
+    }
+    const KSYBwEstimatorClass * all[] = { &ksy_bwe_aimd, &ksy_bwe_delay };
+    const char * traces[] = { "step", "cell", "spike", "outage" };
+    int nbTrace = 4;
+    if (strcmp(trace, "all")) {
+        traces[0] = trace;
+        nbTrace   = 1;
+    }
+    if (cfg.bVerbose) {
+        printf("trace,estimator,t_ms,capacity,target,sent,queue_ms,est_queue_ms,dropped\n");
+    }
+    else {
+        printf("%-8s %-6s %6s %8s %8s %8s %6s %7s %8s\n",
+               "trace", "est", "util", "avgKbps", "delay", "p95", "drops", "changes", "drain");
+    }
+    int fail = 0;
+    for (int i = 0; i < nbTrace; ++i) {
+        Trace tr;
+        SimResult res[2];
+        BOOL bRan[2] = { NO, NO };
+        uint32_t seed = s_seed;
+        if (makeTrace(&tr, traces[i])) {
+            return 1;
+        }
+        for (int e = 0; e < 2; ++e) {
+            if (strcmp(est, "all") && strcmp(est, all[e]->name)) {
+                continue;
+            }
+            s_seed = seed + 17; // 各估计器的编码噪声相同
+            simulate(&tr, all[e], &cfg, &res[e]);
+            bRan[e] = YES;
+            fail |= !res[e].bRangeOk;
+            if (!cfg.bVerbose) {
+                printf("%-8s %-6s %5.1f%% %8.0f %6.0fms %6.0fms %6d %7d %6.0fms%s\n",
+                       tr.name, all[e]->name, res[e].util * 100, res[e].avgKbps, res[e].meanDelay,
+                       res[e].p95Delay, res[e].dropped, res[e].changes, res[e].drainMs,
+                       res[e].bRangeOk ? "" : "  target out of range -> FAIL");
+            }
+        }
+        if (bRan[0] && bRan[1] && !cfg.bVerbose) {
+            BOOL bOk = res[1].p95Delay <= res[0].p95Delay + 100;
+            if (strcmp(tr.name, "step") == 0) {
+                bOk &= res[1].drainMs >= 0 && (res[0].drainMs < 0 || res[1].drainMs <= res[0].drainMs);
+            }
+            printf("  delay vs aimd on %s -> %s\n", tr.name, bOk ? "ok" : "FAIL");
+            fail |= !bOk;
+        }
+        free(tr.t);
+        free(tr.kbps);
+        s_seed = seed;
+    }
+    return fail;
+}
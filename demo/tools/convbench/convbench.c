@@ -0,0 +1,266 @@
+//
+//  convbench.c
+//  convbench
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+//  KSYAudioConvert 的格式往返, 声道映射和声像检查 (可以在Linux/macOS上直接编译)
+//
+//  编译 (在本目录下):
+//    cc -O2 -std=gnu11 -Wno-deprecated -I../fxbench/compat -I../../KSYLiveDemo/KSYAudioUtils -x c \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioConvert.m \
+//       convbench.c -o convbench -lm
+//
+//  用法:
+//    convbench [选项]
+//      -n 1000     每次转换的帧数 (默认不是转换块长256的整数倍)
+//      -c 2        往返测试的声道数 (1~8)
+//      -s 1        随机数种子
+//    检查:
+//      1. 往返: S16 -> FLT/S16P/FLTP -> S16 逐位一致; FLT -> FLTP -> FLT 逐位一致;
+//         FLT -> S16 -> FLT 误差不超过半个LSB, 超出 [-1, 1) 的值饱和
+//      2. 声道映射: 单声道 -> 双声道两侧与输入相同; 双声道 -> 单声道为平均值 (误差1个LSB);
+//         chMap 交换左右声道
+//      3. 声像: 单声道输入为等功率 (L^2 + R^2 = 1), 居中时两侧 -3dB, 两端只有一侧;
+//         双声道输入为平衡调节, 居中时不衰减
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "KSYAudioConvert.h"
+
+static uint32_t s_seed = 1;
+// [0, 1), 用高位 (LCG的低位周期很短)
+static double urand(void) {
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return (s_seed >> 8) / 16777216.0;
+}
+
+static int report(const char* name, const char* note, BOOL bOk) {
+    printf("  %-10s %-56s -> %s\n", name, note, bOk ? "ok" : "FAIL");
+    return !bOk;
+}
+
+static const char* fmtName(int fmt) {
+    switch (fmt) {
+        case KSYSampleFmt_S16:  return "S16";
+        case KSYSampleFmt_FLT:  return "FLT";
+        case KSYSampleFmt_S16P: return "S16P";
+        case KSYSampleFmt_FLTP: return "FLTP";
+        default:                return "?";
+    }
+}
+
+// 按格式分配 nbFrame 帧 nbCh 声道的数据, 平面格式时每个声道一块
+static void allocPcm(uint8_t** planes, int fmt, int nbCh, int nbFrame) {
+    int sz = ksy_sample_fmt_size(fmt);
+    if (ksy_sample_fmt_planar(fmt)) {
+        for (int c = 0; c < nbCh; ++c) {
+            planes[c] = calloc(nbFrame, sz);
+        }
+    }
+    else {
+        planes[0] = calloc((size_t)nbFrame * nbCh, sz);
+    }
+}
+
+static void freePcm(uint8_t** planes, int fmt, int nbCh) {
+    int nbPlane = ksy_sample_fmt_planar(fmt) ? nbCh : 1;
+    for (int c = 0; c < nbPlane; ++c) {
+        free(planes[c]);
+        planes[c] = NULL;
+    }
+}
+
+// src -> mid -> src, 返回与原始数据不同的样本数
+static long long roundTrip(int srcFmt, int midFmt, int nbCh, int nbFrame,
+                           uint8_t** src, double tol) {
+    uint8_t * mid[KSY_AUDIO_MAX_CH] = {0};
+    uint8_t * back[KSY_AUDIO_MAX_CH] = {0};
+    allocPcm(mid,  midFmt, nbCh, nbFrame);
+    allocPcm(back, srcFmt, nbCh, nbFrame);
+    long long bad = 0;
+    if (ksy_audio_convert(mid, midFmt, nbCh, (const uint8_t* const*)src, srcFmt, nbCh,
+                          NULL, nbFrame) != 0 ||
+        ksy_audio_convert(back, srcFmt, nbCh, (const uint8_t* const*)mid, midFmt, nbCh,
+                          NULL, nbFrame) != 0) {
+        bad = -1;
+    }
+    else if (srcFmt == KSYSampleFmt_S16) {
+        const int16_t * a = (const int16_t*)src[0];
+        const int16_t * b = (const int16_t*)back[0];
+        for (int i = 0; i < nbFrame * nbCh; ++i) {
+            bad += a[i] != b[i];
+        }
+    }
+    else { // FLT
+        const float * a = (const float*)src[0];
+        const float * b = (const float*)back[0];
+        for (int i = 0; i < nbFrame * nbCh; ++i) {
+            float v = a[i];
+            if (midFmt == KSYSampleFmt_S16) { // 经过S16时饱和
+                v = v < -1.0f ? -1.0f : (v > 32767.0f/32768.0f ? 32767.0f/32768.0f : v);
+            }
+            bad += fabs(b[i] - v) > tol;
+        }
+    }
+    freePcm(mid,  midFmt, nbCh);
+    freePcm(back, srcFmt, nbCh);
+    return bad;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: convbench [-n frames] [-c channels] [-s seed]\n");
+}
+
+int main(int argc, char** argv) {
+    int nbFrame = 1000;
+    int nbCh    = 2;
+    for (int a = 1; a < argc; a += 2) {
+        if (a + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const char * opt = argv[a];
+        int v = atoi(argv[a+1]);
+        if      (strcmp(opt, "-n") == 0) { nbFrame = v; }
+        else if (strcmp(opt, "-c") == 0) { nbCh    = v; }
+        else if (strcmp(opt, "-s") == 0) { s_seed  = (uint32_t)v; }
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (nbFrame <= 0 || nbCh <= 0 || nbCh > KSY_AUDIO_MAX_CH) {
+        usage();
+        return 1;
+    }
+    printf("%d frames, %d channels\n", nbFrame, nbCh);
+    int fail = 0;
+    char note[128];
+
+    // 1. 往返, S16 覆盖整个取值范围, FLT 包括 [-1.25, 1.25) 的饱和部分
+    int16_t * s16 = malloc(sizeof(int16_t) * nbFrame * nbCh);
+    float *   flt = malloc(sizeof(float)   * nbFrame * nbCh);
+    for (int i = 0; i < nbFrame * nbCh; ++i) {
+        s16[i] = (int16_t)(int)floor(urand() * 65536.0 - 32768.0);
+        flt[i] = (float)(urand() * 2.5 - 1.25);
+    }
+    s16[0] = INT16_MIN;
+    s16[nbFrame * nbCh - 1] = INT16_MAX;
+    uint8_t * s16Src[1] = { (uint8_t*)s16 };
+    uint8_t * fltSrc[1] = { (uint8_t*)flt };
+    const int mids[3] = { KSYSampleFmt_FLT, KSYSampleFmt_S16P, KSYSampleFmt_FLTP };
+    for (int m = 0; m < 3; ++m) {
+        long long bad = roundTrip(KSYSampleFmt_S16, mids[m], nbCh, nbFrame, s16Src, 0);
+        snprintf(note, sizeof(note), "S16 -> %s -> S16: %lld samples differ", fmtName(mids[m]), bad);
+        fail |= report("roundtrip", note, bad == 0);
+    }
+    long long bad = roundTrip(KSYSampleFmt_FLT, KSYSampleFmt_FLTP, nbCh, nbFrame, fltSrc, 0);
+    snprintf(note, sizeof(note), "FLT -> FLTP -> FLT: %lld samples differ", bad);
+    fail |= report("roundtrip", note, bad == 0);
+    bad = roundTrip(KSYSampleFmt_FLT, KSYSampleFmt_S16, nbCh, nbFrame, fltSrc, 0.5 / 32768.0);
+    snprintf(note, sizeof(note), "FLT -> S16 -> FLT: %lld samples off by > 0.5 LSB", bad);
+    fail |= report("roundtrip", note, bad == 0);
+
+    // 2. 声道映射
+    int16_t * mono   = malloc(sizeof(int16_t) * nbFrame);
+    int16_t * stereo = malloc(sizeof(int16_t) * nbFrame * 2);
+    int16_t * out    = malloc(sizeof(int16_t) * nbFrame * 2);
+    for (int i = 0; i < nbFrame; ++i) {
+        mono[i] = (int16_t)(int)floor(urand() * 65536.0 - 32768.0);
+    }
+    for (int i = 0; i < nbFrame * 2; ++i) {
+        stereo[i] = (int16_t)(int)floor(urand() * 65536.0 - 32768.0);
+    }
+    uint8_t * pMono[1]   = { (uint8_t*)mono };
+    uint8_t * pStereo[1] = { (uint8_t*)stereo };
+    uint8_t * pOut[1]    = { (uint8_t*)out };
+    ksy_audio_convert(pOut, KSYSampleFmt_S16, 2, (const uint8_t* const*)pMono,
+                      KSYSampleFmt_S16, 1, NULL, nbFrame);
+    bad = 0;
+    for (int i = 0; i < nbFrame; ++i) {
+        bad += out[i*2] != mono[i] || out[i*2 + 1] != mono[i];
+    }
+    snprintf(note, sizeof(note), "mono -> stereo: %lld frames differ", bad);
+    fail |= report("matrix", note, bad == 0);
+
+    ksy_audio_convert(pOut, KSYSampleFmt_S16, 1, (const uint8_t* const*)pStereo,
+                      KSYSampleFmt_S16, 2, NULL, nbFrame);
+    bad = 0;
+    for (int i = 0; i < nbFrame; ++i) {
+        double avg = (stereo[i*2] + stereo[i*2 + 1]) / 2.0;
+        bad += fabs(out[i] - avg) > 1.0;
+    }
+    snprintf(note, sizeof(note), "stereo -> mono average: %lld frames off by > 1 LSB", bad);
+    fail |= report("matrix", note, bad == 0);
+
+    float mat[KSY_AUDIO_MAX_CH * KSY_AUDIO_MAX_CH];
+    const int swap[2] = { 1, 0 };
+    ksy_audio_channel_matrix(mat, 2, 2, swap, 0.0f);
+    ksy_audio_convert(pOut, KSYSampleFmt_S16, 2, (const uint8_t* const*)pStereo,
+                      KSYSampleFmt_S16, 2, mat, nbFrame);
+    bad = 0;
+    for (int i = 0; i < nbFrame; ++i) {
+        bad += out[i*2] != stereo[i*2 + 1] || out[i*2 + 1] != stereo[i*2];
+    }
+    snprintf(note, sizeof(note), "chMap {1, 0} swaps L/R: %lld frames differ", bad);
+    fail |= report("matrix", note, bad == 0);
+
+    // 3. 声像, 通过 FLT 转换测量实际的增益
+    double maxPowErr = 0, centreDb[2] = {0}, edge[4] = {0};
+    float one = 1.0f, lr[2];
+    uint8_t * pOne[1] = { (uint8_t*)&one };
+    uint8_t * pLr[1]  = { (uint8_t*)lr };
+    for (int k = -10; k <= 10; ++k) {
+        float pan = k / 10.0f;
+        ksy_audio_channel_matrix(mat, 2, 1, NULL, pan);
+        ksy_audio_convert(pLr, KSYSampleFmt_FLT, 2, (const uint8_t* const*)pOne,
+                          KSYSampleFmt_FLT, 1, mat, 1);
+        double err = fabs((double)lr[0]*lr[0] + (double)lr[1]*lr[1] - 1.0);
+        maxPowErr = err > maxPowErr ? err : maxPowErr;
+        if (k == 0) {
+            centreDb[0] = 20 * log10(lr[0]);
+            centreDb[1] = 20 * log10(lr[1]);
+        }
+        else if (k == -10) {
+            edge[0] = lr[0];
+            edge[1] = lr[1];
+        }
+        else if (k == 10) {
+            edge[2] = lr[0];
+            edge[3] = lr[1];
+        }
+    }
+    snprintf(note, sizeof(note), "mono pan -1..1: max |L^2+R^2-1| = %.1e", maxPowErr);
+    fail |= report("pan", note, maxPowErr < 1e-6);
+    snprintf(note, sizeof(note), "mono centre: L %.2f dB, R %.2f dB (expect -3.01)",
+             centreDb[0], centreDb[1]);
+    fail |= report("pan", note, fabs(centreDb[0] + 3.0103) < 0.01 && fabs(centreDb[1] + 3.0103) < 0.01);
+    snprintf(note, sizeof(note), "mono full left (%.3f, %.3f), full right (%.3f, %.3f)",
+             edge[0], edge[1], edge[2], edge[3]);
+    fail |= report("pan", note, fabs(edge[0] - 1) < 1e-6 && fabs(edge[1]) < 1e-6 &&
+                                fabs(edge[2]) < 1e-6 && fabs(edge[3] - 1) < 1e-6);
+
+    float st[2] = { 0.5f, -0.25f };
+    uint8_t * pSt[1] = { (uint8_t*)st };
+    ksy_audio_channel_matrix(mat, 2, 2, NULL, 0.0f);
+    ksy_audio_convert(pLr, KSYSampleFmt_FLT, 2, (const uint8_t* const*)pSt,
+                      KSYSampleFmt_FLT, 2, mat, 1);
+    BOOL bCentre = lr[0] == st[0] && lr[1] == st[1];
+    ksy_audio_channel_matrix(mat, 2, 2, NULL, 0.5f);
+    ksy_audio_convert(pLr, KSYSampleFmt_FLT, 2, (const uint8_t* const*)pSt,
+                      KSYSampleFmt_FLT, 2, mat, 1);
+    snprintf(note, sizeof(note), "stereo balance: centre unchanged, +0.5 -> (%.3f, %.3f)",
+             lr[0], lr[1]);
+    fail |= report("balance", note, bCentre && lr[0] == st[0] * 0.5f && lr[1] == st[1]);
+
+    free(s16);
+    free(flt);
+    free(mono);
+    free(stereo);
+    free(out);
+    return fail;
+}
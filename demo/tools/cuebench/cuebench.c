@@ -0,0 +1,380 @@
+//
+//  cuebench.c
+//  cuebench
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+//  离线测试时间轴事件 (KSYAudioCueTimeline) 的触发精度和开销 (可以在Linux/macOS上直接编译)
+//
+//  编译 (在本目录下):
+//    cc -O2 -std=gnu11 -Wno-deprecated -I../fxbench/compat -I../../KSYLiveDemo/KSYAudioUtils -x c \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioCueTimeline.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioRing.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioKernel.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioResampler.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioTimeStretch.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioBgmEngine.m \
+//       cuebench.c -o cuebench -lm -lpthread
+//
+//  用法:
+//    cuebench [选项]
+//      -n 100000   事件点的个数
+//      -s 1        随机数种子
+//    用合成的时钟 (按帧计数的播放位置) 检查:
+//      1. 随机块长/切歌/定位/循环下, 触发的事件与逐个比较的参考结果完全一致 (包括块内偏移)
+//      2. 播放线程推进的同时, 控制线程不断替换事件点 (索引交换与回收)
+//      3. 每块数据的开销与事件点数量无关
+//      4. 经过背景音乐引擎 (KSYAudioBgmEngine): 事件在输出数据中的位置与事件点一致, 循环后重新触发
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include "KSYAudioCueTimeline.h"
+#include "KSYAudioBgmEngine.h"
+
+static uint32_t s_seed = 1;
+
+static uint32_t urand(void) {
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return s_seed >> 8;
+}
+
+static double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+}
+
+#pragma mark - fired log
+typedef struct {
+    int     track;
+    int64_t frame;
+    int     tag;
+    int     offset;
+} Fired;
+
+typedef struct {
+    Fired * list;
+    int     cnt;
+    int     cap;
+} FiredLog;
+
+static void onFire(void* opaque, const KSYCue* cue, int offset) {
+    FiredLog * log = opaque;
+    if (log->cnt < log->cap) {
+        Fired f = { cue->trackId, cue->frame, cue->tag, offset };
+        log->list[log->cnt] = f;
+    }
+    log->cnt += 1;
+}
+
+static void onCount(void* opaque, const KSYCue* cue, int offset) {
+    (void)cue;
+    (void)offset;
+    *(int64_t*)opaque += 1;
+}
+
+static KSYCue* makeCues(int n, int64_t span) {
+    KSYCue * cues = malloc(sizeof(KSYCue) * n);
+    for (int i = 0; i < n; ++i) {
+        cues[i].trackId = 0;
+        cues[i].frame   = (int64_t)((double)urand() / 16777216.0 * span);
+        cues[i].tag     = i;
+    }
+    return cues;
+}
+
+#pragma mark - accuracy
+// 参考实现: 逐个比较全部事件点, 连续与否都触发 [beg, end) 内的事件点
+static int refFire(const KSYCue* cues, int n, int track, int64_t beg, int64_t end,
+                   int64_t* expect, int nbExpect) {
+    int cnt = 0;
+    for (int i = 0; i < n; ++i) {
+        if (cues[i].trackId == track && cues[i].frame >= beg && cues[i].frame < end) {
+            if (cnt < nbExpect) {
+                expect[cnt] = (int64_t)cues[i].tag << 32 | (int)(cues[i].frame - beg);
+            }
+            cnt += 1;
+        }
+    }
+    return cnt;
+}
+
+static int cmpI64(const void* a, const void* b) {
+    int64_t x = *(const int64_t*)a, y = *(const int64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static int testAccuracy(int nbCue) {
+    int      nbTrack = 3;
+    int64_t  span    = 44100 * 240; // 每首4分钟
+    int      perTrack = nbCue / nbTrack;
+    KSYCue * all     = malloc(sizeof(KSYCue) * perTrack * nbTrack);
+    FiredLog log     = { malloc(sizeof(Fired) * 4096), 0, 4096 };
+    int64_t * expect = malloc(sizeof(int64_t) * 4096);
+    int64_t * got    = malloc(sizeof(int64_t) * 4096);
+    KSYCueTimeline * tl = ksy_cue_create(onFire, &log);
+    for (int t = 0; t < nbTrack; ++t) {
+        KSYCue * c = makeCues(perTrack, span);
+        ksy_cue_set_track(tl, t, c, perTrack);
+        for (int i = 0; i < perTrack; ++i) {
+            all[t * perTrack + i]       = c[i];
+            all[t * perTrack + i].trackId = t;
+        }
+        free(c);
+    }
+    int     track = 0, errors = 0, jumps = 0, blocks = 0;
+    int64_t pos = 0, fired = 0;
+    double  t0 = nowMs();
+    double  tRef = 0;
+    for (int b = 0; b < 20000; ++b) {
+        uint32_t r = urand() % 1000;
+        BOOL bCont = YES;
+        if (r < 5) { // 切歌
+            track = urand() % nbTrack;
+            pos   = urand() % span;
+            bCont = NO;
+        }
+        else if (r < 15) { // 定位 (前后)
+            pos   = urand() % span;
+            bCont = NO;
+        }
+        else if (pos >= span) { // 循环
+            pos   = 0;
+            bCont = NO;
+        }
+        jumps += !bCont;
+        int n = 64 + urand() % 1985;
+        log.cnt = 0;
+        ksy_cue_advance(tl, track, pos, n, 0);
+        double t1 = nowMs();
+        int nbExp = refFire(all, perTrack * nbTrack, track, pos, pos + n, expect, 4096);
+        tRef += nowMs() - t1;
+        BOOL bErr = nbExp != log.cnt;
+        for (int i = 0; !bErr && i < log.cnt && i < 4096; ++i) {
+            got[i] = (int64_t)log.list[i].tag << 32 | log.list[i].offset;
+            bErr |= log.list[i].track != track ||
+                    log.list[i].frame != pos + log.list[i].offset;
+            bErr |= i > 0 && log.list[i].frame < log.list[i-1].frame; // 按时间顺序
+        }
+        if (!bErr) {
+            qsort(got, log.cnt, sizeof(int64_t), cmpI64);
+            qsort(expect, nbExp, sizeof(int64_t), cmpI64);
+            bErr = memcmp(got, expect, sizeof(int64_t) * log.cnt) != 0;
+        }
+        if (bErr && errors++ < 3) {
+            printf("  block %d track %d pos %lld n %d: fired %d, expect %d\n",
+                   b, track, (long long)pos, n, log.cnt, nbExp);
+        }
+        fired  += log.cnt;
+        pos    += n;
+        blocks += 1;
+    }
+    double ms = nowMs() - t0 - tRef;
+    printf("accuracy: %d cues, %d blocks, %d jumps, %lld fired, %d errors, "
+           "%.3f us per block (reference scan %.1f us) -> %s\n",
+           perTrack * nbTrack, blocks, jumps, (long long)fired, errors,
+           ms * 1e3 / blocks, tRef * 1e3 / blocks, errors ? "FAIL" : "ok");
+    ksy_cue_destroy(tl);
+    free(all);
+    free(log.list);
+    free(expect);
+    free(got);
+    return errors != 0;
+}
+
+#pragma mark - concurrent update
+typedef struct {
+    KSYCueTimeline * tl;
+    atomic_bool      bQuit;
+    int              updates;
+} Updater;
+
+static void* updateThread(void* arg) {
+    Updater * u = arg;
+    uint32_t  seed = 7;
+    KSYCue *  c = malloc(sizeof(KSYCue) * 2000);
+    while (!atomic_load(&u->bQuit)) {
+        seed = seed * 1664525u + 1013904223u;
+        int n = 1 + (seed >> 8) % 2000;
+        for (int i = 0; i < n; ++i) {
+            c[i].frame = (int64_t)i * 441;
+            c[i].tag   = i;
+        }
+        ksy_cue_set_track(u->tl, (seed >> 4) % 2, c, n);
+        u->updates += 1;
+        if (u->updates % 64 == 0) {
+            ksy_cue_clear(u->tl);
+        }
+        usleep(50);
+    }
+    free(c);
+    return NULL;
+}
+
+static int testConcurrent(void) {
+    int64_t cnt = 0;
+    Updater u   = { ksy_cue_create(onCount, &cnt), NO, 0 };
+    pthread_t th;
+    pthread_create(&th, NULL, updateThread, &u);
+    int64_t pos = 0;
+    double  t0  = nowMs();
+    int     blocks = 0;
+    while (nowMs() - t0 < 500) {
+        ksy_cue_advance(u.tl, 0, pos, 441, 0);
+        pos = (pos + 441) % (441 * 2000);
+        blocks += 1;
+    }
+    atomic_store(&u.bQuit, YES);
+    pthread_join(th, NULL);
+    // 最后一次修改之后, 每块 (441帧) 恰好触发一个事件点
+    KSYCue c[100];
+    for (int i = 0; i < 100; ++i) {
+        c[i].frame = (int64_t)i * 441;
+        c[i].tag   = i;
+    }
+    ksy_cue_clear(u.tl);
+    ksy_cue_set_track(u.tl, 0, c, 100);
+    cnt = 0;
+    for (int i = 0; i < 100; ++i) {
+        ksy_cue_advance(u.tl, 0, (int64_t)i * 441, 441, 0);
+    }
+    int fail = cnt != 100 || ksy_cue_count(u.tl) != 100;
+    printf("concurrent: %d updates during %d blocks, then %lld/100 fired -> %s\n",
+           u.updates, blocks, (long long)cnt, fail ? "FAIL" : "ok");
+    ksy_cue_destroy(u.tl);
+    return fail;
+}
+
+#pragma mark - cost
+static void testCost(void) {
+    int sizes[] = { 0, 100, 10000, 1000000 };
+    for (int s = 0; s < 4; ++s) {
+        int64_t  cnt = 0;
+        KSYCueTimeline * tl = ksy_cue_create(onCount, &cnt);
+        int64_t  span = 44100LL * 3600;
+        KSYCue * c = makeCues(sizes[s] ? sizes[s] : 1, span);
+        ksy_cue_set_track(tl, 0, c, sizes[s]);
+        int64_t pos = 0;
+        int     blocks = 200000;
+        double  t0 = nowMs();
+        for (int b = 0; b < blocks; ++b) {
+            ksy_cue_advance(tl, 0, pos, 1024, 0);
+            pos += 1024;
+            if (pos >= span) {
+                pos = 0;
+            }
+        }
+        double ms = nowMs() - t0;
+        printf("cost: %7d cues, %.1f ns per 1024-frame block, %lld fired\n",
+               sizes[s], ms * 1e6 / blocks, (long long)cnt);
+        ksy_cue_destroy(tl);
+        free(c);
+    }
+}
+
+#pragma mark - engine
+// 合成解码源: 长度 len 帧
+typedef struct {
+    int64_t pos;
+    int64_t len;
+} SynSrc;
+
+static BOOL synOpen(void* ctx, int rate, int chCnt, int64_t* nbFrame) {
+    (void)rate;
+    (void)chCnt;
+    *nbFrame = ((SynSrc*)ctx)->len;
+    return YES;
+}
+
+static int synRead(void* ctx, float* buf, int nbFrame) {
+    SynSrc * s = ctx;
+    int n = (int)(s->len - s->pos < nbFrame ? s->len - s->pos : nbFrame);
+    memset(buf, 0, sizeof(float) * n);
+    s->pos += n;
+    return n;
+}
+
+static BOOL synSeek(void* ctx, int64_t frame) {
+    ((SynSrc*)ctx)->pos = frame;
+    return YES;
+}
+
+static void synClose(void* ctx) {
+    (void)ctx;
+}
+
+typedef struct {
+    int64_t outPos;     // 当前块在输出中的起始位置
+    int64_t fired[64];
+    int     cnt;
+} EngLog;
+
+static void onEngCue(void* opaque, const KSYCue* cue, int offset) {
+    EngLog * l = opaque;
+    (void)cue;
+    if (l->cnt < 64) {
+        l->fired[l->cnt] = l->outPos + offset;
+    }
+    l->cnt += 1;
+}
+
+static int testEngine(void) {
+    int      rate = 44100, len = 30000, loops = 3;
+    SynSrc   src  = { 0, len };
+    EngLog   log  = { 0, {0}, 0 };
+    KSYBgmEngine *   eng = ksy_bgm_create(rate, 1, 500);
+    KSYCueTimeline * tl  = ksy_cue_create(onEngCue, &log);
+    ksy_bgm_set_cues(eng, tl);
+    KSYBgmSource s = { &src, synOpen, synRead, synSeek, synClose };
+    int id = ksy_bgm_enqueue(eng, &s, YES);
+    KSYCue cues[3] = { { 0, 0, 0 }, { 0, 12345, 1 }, { 0, 29999, 2 } };
+    ksy_cue_set_track(tl, id, cues, 3);
+    float buf[1024];
+    int64_t first = -1;
+    double  t0 = nowMs();
+    while (log.outPos < (int64_t)len * loops + 1024 && nowMs() - t0 < 3000) {
+        int n = ksy_bgm_read(eng, buf, 1000);
+        if (n > 0 && first < 0) {
+            first = log.outPos; // 输出中曲目开始的位置
+        }
+        log.outPos += n;
+        if (n < 1000) {
+            usleep(2000);
+        }
+    }
+    int errors = 0;
+    for (int i = 0; i < log.cnt && i < 64; ++i) {
+        int64_t expect = first + (int64_t)(i / 3) * len + cues[i % 3].frame;
+        errors += log.fired[i] != expect;
+    }
+    int fail = errors || log.cnt < loops * 3;
+    printf("engine: %d loops of %d frames, %d cues fired, %d off by >0 frames -> %s\n",
+           loops, len, log.cnt, errors, fail ? "FAIL" : "ok");
+    ksy_bgm_destroy(eng);
+    ksy_cue_destroy(tl);
+    return fail;
+}
+
+int main(int argc, char** argv) {
+    int nbCue = 100000;
+    for (int a = 1; a + 1 < argc; a += 2) {
+        if (strcmp(argv[a], "-n") == 0)      { nbCue  = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-s") == 0) { s_seed = (uint32_t)atoi(argv[a+1]); }
+        else {
+            fprintf(stderr, "usage: cuebench [-n cues] [-s seed]\n");
+            return 1;
+        }
+    }
+    int fail = 0;
+    fail |= testAccuracy(nbCue < 3 ? 3 : nbCue);
+    fail |= testConcurrent();
+    testCost();
+    fail |= testEngine();
+    return fail;
+}
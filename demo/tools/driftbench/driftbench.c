@@ -0,0 +1,230 @@
+//
+//  driftbench.c
+//  driftbench
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+//  模拟非主轨与主轨的时钟漂移, 测试漂移补偿 (KSYAudioDrift) (可以在Linux/macOS上直接编译)
+//  处理流程与 KSYAudioTrackBuffer 相同: 重采样 -> 环形缓冲 -> 按主轨周期取数据
+//
+//  编译 (在本目录下):
+//    cc -O2 -std=gnu11 -Wno-deprecated -I../fxbench/compat -I../../KSYLiveDemo/KSYAudioUtils -x c \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioKernel.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioResampler.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioRing.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioDrift.m \
+//       driftbench.c -o driftbench -lm -lpthread
+//
+//  用法:
+//    driftbench [选项]
+//      -skew 0.3   输入时钟相对主轨偏快的比例 (%), 负数为偏慢; 不指定时测试 +0.3, -0.3, +0.02, 0
+//      -t 7200     模拟的时长 (秒)
+//      -j 2        输入时间戳的抖动 (毫秒, 均匀分布)
+//      -f 3600     清空缓冲的时间 (秒, 如seek, 默认为时长的一半)
+//      -r 48000:44100  输入和主轨的采样率
+//      -v 1        每隔60秒输出一次状态
+//    每种偏差分别用两种时间戳运行:
+//      host:    时间戳取自主轨的时钟 (数据到达时的系统时间), 前馈部分可以估计出实际速率
+//      nominal: 时间戳按输入的标称采样率递增 (帧数/采样率), 前馈部分的比例恒为1, 只有PI反馈起作用
+//    检查 (|skew| 不超过0.4%时):
+//      1. 启动之后没有欠载和溢出
+//      2. 最后10分钟平滑后的缓冲长度偏离目标不超过5ms, 平均比例与 1+skew 相差不超过50ppm
+//      3. (|skew| 不小于0.2%时) host 模式下前馈估计生效: 清空缓冲后反馈部分复位, 前馈的比例保留,
+//         重新输出后的最大偏离不超过 nominal 模式 (反馈需要重新积分) 的一半
+//    启动时前馈部分需要 10 秒的时间戳才有估计, 两种模式的启动偏离相近, 只输出不检查
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "KSYAudioResampler.h"
+#include "KSYAudioRing.h"
+#include "KSYAudioDrift.h"
+
+#define IN_CHUNK        1024    // 输入每次的帧数
+#define MAIN_CHUNK      1024    // 主轨每次的帧数
+#define SETTLE_SEC      5.0     // 开始输出后这段时间不统计偏离 (平滑的缓冲长度还在上升)
+#define TAIL_SEC        600.0   // 最后这段时间的偏离
+#define FLUSH_WIN_SEC   300.0   // 清空缓冲之后统计偏离的时长
+#define MAX_SKEW_CHECK  0.004
+
+static int      s_inRate  = 48000;
+static int      s_outRate = 44100;
+static double   s_durSec  = 7200;
+static double   s_jitMs   = 2;
+static double   s_flushSec = -1;
+static BOOL     s_bVerbose = NO;
+static uint32_t s_seed    = 1;
+
+static double urand(void) {
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return (s_seed >> 8) / 16777216.0;
+}
+
+typedef struct {
+    double  maxDevMs;   // 开始输出之后, 平滑的缓冲长度偏离目标的最大值
+    double  flushDevMs; // 清空缓冲 (如seek) 重新开始输出之后的最大偏离
+    double  tailDevMs;  // 最后 TAIL_SEC 内的最大偏离
+    double  ratio;      // 最后 TAIL_SEC 内的平均比例
+    int64_t underrun;   // 启动之后的欠载次数
+    int64_t overrun;
+} SimResult;
+
+static void simulate(double skew, BOOL bHostPts, SimResult* res) {
+    const int target = s_outRate / 10;
+    KSYAudioRing      * ring  = ksy_ring_create(s_outRate / 2, sizeof(int16_t));
+    KSYAudioResampler * rs    = ksy_resampler_create(s_inRate, s_outRate, 1, KSYResampleQuality_Low);
+    KSYAudioDrift     * drift = ksy_drift_create(target, s_outRate);
+    int       maxOut = ksy_resampler_max_out(rs, IN_CHUNK) * 2;
+    float   * in     = calloc(IN_CHUNK, sizeof(float));
+    float   * out    = calloc(maxOut, sizeof(float));
+    int16_t * pcm    = calloc(maxOut > MAIN_CHUNK ? maxOut : MAIN_CHUNK, sizeof(int16_t));
+    double  tIn = 0, tMain = 0, tReport = 0;
+    int64_t framesIn = 0, underrunStart = -1;
+    double  tStart = -1, tRestart = -1, ratioSum = 0;
+    int     nbRatio = 0;
+    BOOL    bFlushed = NO;
+    BOOL    bPriming = YES;
+    memset(res, 0, sizeof(*res));
+    while (tMain < s_durSec) {
+        if (tIn <= tMain) {
+            // 输入端: 实际速度为标称采样率的 1+skew 倍
+            double pts = bHostPts ? tIn + s_jitMs / 1000 * (urand() - 0.5)
+                                  : (double)framesIn / s_inRate;
+            ksy_drift_input(drift, IN_CHUNK, s_inRate, pts);
+            ksy_resampler_set_ratio(rs, ksy_drift_ratio(drift));
+            int n = ksy_resampler_process(rs, in, IN_CHUNK, out, maxOut);
+            ksy_ring_write(ring, pcm, n);
+            framesIn += IN_CHUNK;
+            tIn      += IN_CHUNK / (s_inRate * (1.0 + skew));
+            continue;
+        }
+        if (!bFlushed && tMain >= s_flushSec) {
+            // 与 KSYAudioTrackBuffer 的 flush 相同: 反馈部分复位, 前馈的估计保留
+            ksy_ring_flush(ring);
+            ksy_drift_reset(drift);
+            bPriming = YES;
+            bFlushed = YES;
+        }
+        int fill = ksy_ring_fill(ring);
+        bPriming = bPriming && fill < target;
+        if (!bPriming) {
+            int n = ksy_ring_read(ring, pcm, MAIN_CHUNK);
+            ksy_drift_output(drift, fill, MAIN_CHUNK, n < MAIN_CHUNK);
+            bPriming = (n <= 0);
+            if (underrunStart < 0) { // 第一次输出时记下启动阶段的欠载次数
+                KSYAudioRingStat st;
+                ksy_ring_get_stat(ring, &st);
+                underrunStart = st.underrunCnt;
+                tStart        = tMain;
+            }
+            if (bFlushed && tRestart < 0) {
+                tRestart = tMain;
+            }
+        }
+        tMain += (double)MAIN_CHUNK / s_outRate;
+        double devMs = fabs(ksy_drift_fill(drift) - target) * 1000 / s_outRate;
+        if (tStart >= 0 && tMain - tStart >= SETTLE_SEC && !bFlushed && devMs > res->maxDevMs) {
+            res->maxDevMs = devMs;
+        }
+        if (tRestart >= 0 && tMain - tRestart >= SETTLE_SEC && tMain - tRestart < FLUSH_WIN_SEC &&
+            devMs > res->flushDevMs) {
+            res->flushDevMs = devMs;
+        }
+        if (tMain >= s_durSec - TAIL_SEC) {
+            res->tailDevMs = devMs > res->tailDevMs ? devMs : res->tailDevMs;
+            ratioSum += ksy_drift_ratio(drift);
+            nbRatio  += 1;
+        }
+        if (s_bVerbose && tMain >= tReport) {
+            printf("    t=%6.0fs fill=%5d smooth=%8.1f ratio=%.6f\n",
+                   tMain, fill, ksy_drift_fill(drift), ksy_drift_ratio(drift));
+            tReport += 60;
+        }
+    }
+    KSYAudioRingStat st;
+    ksy_ring_get_stat(ring, &st);
+    res->ratio    = nbRatio ? ratioSum / nbRatio : ksy_drift_ratio(drift);
+    res->underrun = st.underrunCnt - (underrunStart < 0 ? 0 : underrunStart);
+    res->overrun  = st.overrunFrames;
+    free(in);
+    free(out);
+    free(pcm);
+    ksy_drift_destroy(drift);
+    ksy_resampler_destroy(rs);
+    ksy_ring_destroy(ring);
+}
+
+static int runSkew(double skew) {
+    SimResult host, nominal;
+    simulate(skew, YES, &host);
+    simulate(skew, NO,  &nominal);
+    BOOL bCheck = fabs(skew) <= MAX_SKEW_CHECK;
+    int fail = 0;
+    const SimResult * r[2] = { &host, &nominal };
+    for (int i = 0; i < 2; ++i) {
+        double ppm = (r[i]->ratio - (1.0 + skew)) * 1e6;
+        BOOL bOk = r[i]->underrun == 0 && r[i]->overrun == 0 && r[i]->tailDevMs <= 5.0 &&
+                   fabs(ppm) <= 50;
+        // 偏差小于0.2%时, 清空后重新缓冲本身的偏离 (skew为0时也有约5~13ms) 与反馈的偏离相当, 不比较
+        if (i == 0 && fabs(skew) >= 0.002) {
+            bOk &= host.flushDevMs <= nominal.flushDevMs / 2;
+        }
+        printf("  skew %+.3f%% %-7s ratio %.6f (%+4.0f ppm)  dev: start %5.2f flush %5.2f "
+               "tail %4.2f ms  underrun %lld overrun %lld  %s\n",
+               skew * 100, i == 0 ? "host" : "nominal", r[i]->ratio,
+               (r[i]->ratio - (1.0 + skew)) * 1e6, r[i]->maxDevMs, r[i]->flushDevMs, r[i]->tailDevMs,
+               (long long)r[i]->underrun, (long long)r[i]->overrun,
+               bCheck ? (bOk ? "-> ok" : "-> FAIL") : "");
+        fail |= bCheck && !bOk;
+    }
+    return fail;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: driftbench [-skew percent] [-t sec] [-j ms] [-f sec] [-r in:out] [-v 0|1]\n");
+}
+
+int main(int argc, char** argv) {
+    double skews[8] = { 0.003, -0.003, 0.0002, 0 };
+    int nbSkew = 4;
+    for (int a = 1; a < argc; a += 2) {
+        if (a + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const char * opt = argv[a];
+        const char * val = argv[a+1];
+        if      (strcmp(opt, "-skew") == 0) { skews[0] = atof(val) / 100; nbSkew = 1; }
+        else if (strcmp(opt, "-t") == 0)    { s_durSec  = atof(val); }
+        else if (strcmp(opt, "-j") == 0)    { s_jitMs   = atof(val); }
+        else if (strcmp(opt, "-f") == 0)    { s_flushSec = atof(val); }
+        else if (strcmp(opt, "-v") == 0)    { s_bVerbose = atoi(val) != 0; }
+        else if (strcmp(opt, "-r") == 0) {
+            if (sscanf(val, "%d:%d", &s_inRate, &s_outRate) != 2) {
+                usage();
+                return 1;
+            }
+        }
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (s_flushSec < 0) {
+        s_flushSec = s_durSec / 2;
+    }
+    if (s_durSec < s_flushSec + FLUSH_WIN_SEC + TAIL_SEC || s_inRate <= 0 || s_outRate <= 0 ||
+        s_jitMs < 0) {
+        fprintf(stderr, "duration must be at least flush time + %.0f s\n", FLUSH_WIN_SEC + TAIL_SEC);
+        return 1;
+    }
+    printf("%d -> %d, %.0f s, target %d ms, pts jitter %.1f ms\n",
+           s_inRate, s_outRate, s_durSec, 100, s_jitMs);
+    int fail = 0;
+    for (int i = 0; i < nbSkew; ++i) {
+        fail |= runSkew(skews[i]);
+    }
+    return fail;
+}
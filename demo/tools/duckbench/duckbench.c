@@ -0,0 +1,211 @@
+//
+//  duckbench.c
+//  duckbench
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+//  用合成的人声片段测试侧链闪避的增益曲线 (KSYAudioSidechain) (可以在Linux/macOS上直接编译)
+//
+//  编译 (在本目录下):
+//    cc -O2 -std=gnu11 -Wno-deprecated -I../fxbench/compat -I../../KSYLiveDemo/KSYAudioUtils -x c \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioSidechain.m \
+//       duckbench.c -o duckbench -lm
+//
+//  用法:
+//    duckbench [选项]
+//      -a 10       attack (ms)
+//      -R 400      release (ms)
+//      -H 300      hold (ms)
+//      -d -12      闪避深度 (dB)
+//      -t -36      人声门限 (dBFS)
+//      -v -20      合成人声的峰值电平 (dBFS, 1KHz 正弦, 持续1秒, 前后各有静音)
+//      -r 44100    主轨的采样率
+//    输出的时间:
+//      attack:  人声开始 -> 增益下降到 63% (1 - 0.63*(1-深度))
+//      release: 人声结束 -> 增益开始回升; 开始回升 -> 恢复到 63%
+//    检查 (默认参数与 KSYAudioDucker 相同, 人声 -20dBFS 时为 10.8ms / 331ms / 400ms):
+//      1. attack 63%: attack + 包络上升到门限的时间 (包络为10ms平滑的均方值), 允许1个检测块(1ms)的误差
+//         开始回升:   包络从人声电平衰减到门限的时间 + hold + 1个检测块, 误差1ms
+//         回升 63%:   release, 误差1%
+//      2. 随机分块分析与整段分析得到的曲线逐点一致
+//      3. 闪避期间应用到不同采样率/声道数的track上 (按时长对齐), 结果为 原值 x 深度
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "KSYAudioSidechain.h"
+
+#define PRE_SEC     0.5     // 人声之前的静音
+#define VOICE_SEC   1.0
+#define POST_SEC    2.0
+#define ENV_MS      10.0    // 与 KSYAudioSidechain.m 的 SC_ENV_MS 相同
+
+static uint32_t s_seed = 1;
+// [0, n), 用高位 (LCG的低位周期很短)
+static int urandInt(int n) {
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return (int)(((uint64_t)(s_seed >> 8) * n) >> 24);
+}
+
+static int report(const char* name, const char* note, BOOL bOk) {
+    printf("  %-10s %-58s -> %s\n", name, note, bOk ? "ok" : "FAIL");
+    return !bOk;
+}
+
+// 整段分析, 返回曲线 (调用者释放)
+static float* analyzeWhole(const KSYDuckParam* param, int rate, const int16_t* pcm, int nbFrame) {
+    KSYAudioSidechain * sc = ksy_sidechain_create(rate);
+    ksy_sidechain_set_param(sc, param);
+    ksy_sidechain_analyze_s16(sc, pcm, nbFrame, 1);
+    int len = 0;
+    const float * c = ksy_sidechain_curve(sc, &len);
+    float * curve = malloc(sizeof(float) * nbFrame);
+    memcpy(curve, c, sizeof(float) * len);
+    ksy_sidechain_destroy(sc);
+    return curve;
+}
+
+// 第一个满足条件的位置 (从 from 开始), 找不到时返回 -1
+static int firstBelow(const float* c, int n, int from, float v) {
+    for (int i = from; i < n; ++i) {
+        if (c[i] <= v) {
+            return i;
+        }
+    }
+    return -1;
+}
+static int firstAbove(const float* c, int n, int from, float v) {
+    for (int i = from; i < n; ++i) {
+        if (c[i] >= v) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: duckbench [-a ms] [-R ms] [-H ms] [-d dB] [-t dBFS] [-v dBFS] [-r rate]\n");
+}
+
+int main(int argc, char** argv) {
+    KSYDuckParam param = { 10.0f, 400.0f, 300.0f, -12.0f, -36.0f };
+    float voiceDb = -20;
+    int   rate    = 44100;
+    for (int a = 1; a < argc; a += 2) {
+        if (a + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const char * opt = argv[a];
+        float v = (float)atof(argv[a+1]);
+        if      (strcmp(opt, "-a") == 0) { param.attackMs    = v; }
+        else if (strcmp(opt, "-R") == 0) { param.releaseMs   = v; }
+        else if (strcmp(opt, "-H") == 0) { param.holdMs      = v; }
+        else if (strcmp(opt, "-d") == 0) { param.depthDb     = v; }
+        else if (strcmp(opt, "-t") == 0) { param.thresholdDb = v; }
+        else if (strcmp(opt, "-v") == 0) { voiceDb = v; }
+        else if (strcmp(opt, "-r") == 0) { rate    = (int)v; }
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (rate < 8000 || !(param.depthDb < 0) || param.attackMs < 0 || param.releaseMs <= 0 ||
+        param.holdMs < 0 || voiceDb > 0 || voiceDb - 3.01f <= param.thresholdDb) {
+        // 正弦的均方值比峰值低3dB, 须高于门限
+        usage();
+        return 1;
+    }
+
+    int onset   = (int)(PRE_SEC * rate);
+    int offset  = onset + (int)(VOICE_SEC * rate);
+    int nbFrame = offset + (int)(POST_SEC * rate);
+    int16_t * mic = calloc(nbFrame, sizeof(int16_t));
+    double amp = pow(10.0, voiceDb / 20.0) * 32767.0;
+    for (int i = onset; i < offset; ++i) {
+        mic[i] = (int16_t)lrint(amp * sin(2 * M_PI * 1000.0 * (i - onset) / rate));
+    }
+    printf("attack %.0f ms, release %.0f ms, hold %.0f ms, depth %.1f dB, threshold %.0f dBFS, "
+           "voice %.0f dBFS @ %d Hz\n", param.attackMs, param.releaseMs, param.holdMs,
+           param.depthDb, param.thresholdDb, voiceDb, rate);
+
+    // 1. 时间常数
+    float * whole = analyzeWhole(&param, rate, mic, nbFrame);
+    float depth   = powf(10.0f, param.depthDb / 20.0f);
+    float atk63   = 1.0f - 0.632f * (1.0f - depth);
+    float rel63   = depth + 0.632f * (1.0f - depth);
+    int   iAtk    = firstBelow(whole, nbFrame, onset, atk63);
+    int   iFloor  = firstBelow(whole, nbFrame, onset, depth);
+    int   iRise   = iFloor < 0 ? -1 : firstAbove(whole, nbFrame, offset, depth * 1.0001f);
+    int   iRel    = iRise < 0 ? -1 : firstAbove(whole, nbFrame, iRise, rel63);
+    int fail = 0;
+    char note[128];
+    if (iAtk < 0 || iFloor < 0 || iRise < 0 || iRel < 0) {
+        report("curve", "gain never reached the depth or never recovered", NO);
+        return 1;
+    }
+    double msAtk  = (iAtk - onset) * 1000.0 / rate;
+    double msHold = (iRise - offset) * 1000.0 / rate;
+    double msRel  = (iRel - iRise) * 1000.0 / rate;
+    // 包络 (均方值) 与门限之比, 决定检测的延迟
+    double envRatio = pow(10.0, (voiceDb - 3.01 - param.thresholdDb) / 10.0);
+    double msDetect = ENV_MS * -log(1.0 - 1.0 / envRatio);
+    double msDecay  = ENV_MS * log(envRatio);
+    double expAtk   = param.attackMs + msDetect;
+    double expHold  = msDecay + param.holdMs + 1.0;
+    snprintf(note, sizeof(note), "63%% after %.1f ms (expect %.1f~%.1f)", msAtk, expAtk, expAtk + 1);
+    fail |= report("attack", note, msAtk >= expAtk - 0.1 && msAtk <= expAtk + 1.0);
+    snprintf(note, sizeof(note), "starts %.1f ms after the voice ends (expect %.1f)", msHold, expHold);
+    fail |= report("hold", note, fabs(msHold - expHold) <= 1.0);
+    snprintf(note, sizeof(note), "63%% after %.1f ms (expect %.0f)", msRel, param.releaseMs);
+    fail |= report("release", note, fabs(msRel - param.releaseMs) <= param.releaseMs * 0.01);
+
+    // 2. 随机分块分析 (1~2048帧, 包括不是1ms整数倍的长度)
+    KSYAudioSidechain * sc = ksy_sidechain_create(rate);
+    ksy_sidechain_set_param(sc, &param);
+    int64_t bad = 0;
+    int nbChunk = 0;
+    for (int off = 0; off < nbFrame; ++nbChunk) {
+        int n = 1 + urandInt(2048);
+        n = n < nbFrame - off ? n : nbFrame - off;
+        ksy_sidechain_analyze_s16(sc, mic + off, n, 1);
+        int len = 0;
+        const float * c = ksy_sidechain_curve(sc, &len);
+        for (int i = 0; i < len; ++i) {
+            bad += c[i] != whole[off + i];
+        }
+        off += n;
+    }
+    snprintf(note, sizeof(note), "%d chunks vs whole: %lld samples differ", nbChunk, (long long)bad);
+    fail |= report("chunked", note, bad == 0);
+
+    // 3. 完全闪避的一段 (人声中间的100ms) 应用到 48KHz 双声道的track上
+    int blk = rate / 10;
+    int mid = (onset + offset) / 2;
+    ksy_sidechain_reset(sc);
+    for (int off = 0; off + blk <= mid; off += blk) {
+        ksy_sidechain_analyze_s16(sc, mic + off, blk, 1);
+    }
+    int nbTrack = 4800;
+    int16_t * bgm = malloc(sizeof(int16_t) * nbTrack * 2);
+    for (int i = 0; i < nbTrack * 2; ++i) {
+        bgm[i] = (i & 1) ? -20000 : 16000;
+    }
+    ksy_sidechain_apply_s16(sc, bgm, nbTrack, 2);
+    int16_t expL = (int16_t)lrintf(16000 * depth), expR = (int16_t)lrintf(-20000 * depth);
+    bad = 0;
+    for (int i = 0; i < nbTrack; ++i) {
+        bad += bgm[i*2] != expL || bgm[i*2 + 1] != expR;
+    }
+    snprintf(note, sizeof(note), "%d Hz mono curve on 48000 Hz stereo: %lld frames differ",
+             rate, (long long)bad);
+    fail |= report("apply", note, bad == 0);
+
+    free(bgm);
+    free(whole);
+    free(mic);
+    ksy_sidechain_destroy(sc);
+    return fail;
+}
@@ -0,0 +1,326 @@
+//
+//  effectbench.c
+//  effectbench
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+//  测试短音效池的播放核心 (KSYAudioVoicePool) (可以在Linux/macOS上直接编译)
+//  KSYAudioEffectPool 的解码部分依赖 ExtAudioFile, 这里直接加载合成的PCM
+//
+//  编译 (在本目录下):
+//    cc -O2 -std=gnu11 -Wno-deprecated -I../fxbench/compat -I../../KSYLiveDemo/KSYAudioUtils -x c \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioKernel.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioRing.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioPcmCache.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioVoicePool.m \
+//       effectbench.c -o effectbench -lm -lpthread
+//  用 ThreadSanitizer 检查两个线程间的数据竞争 (把 -O2 换成 -O1 -g -fsanitize=thread)
+//
+//  用法:
+//    effectbench [选项]
+//      -e 64       加载的音效个数
+//      -a 3        同时播放的个数
+//      -n 1024     每次混合的帧数
+//      -l 20000    计时的次数
+//      -s 2        多线程测试的时长 (秒)
+//    检查:
+//      1. 输出与直接混合正在播放的音效 (含结尾补零) 逐点一致
+//      2. 耗时与加载的个数无关: 加载e个与加载a个相比不超过1.5倍; 比e路全部参与混音快 e/a/4 倍以上
+//      3. 主轨线程和控制线程同时运行 (随机播放/卸载/重新加载), 主轨线程把播放完的已卸载音效交回
+//         控制线程 (deferredCnt 大于0), 不释放内存 (renderFreeCnt 为0),
+//         结束后所有加载过的音效都由控制线程释放
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include "KSYAudioKernel.h"
+#include "KSYAudioVoicePool.h"
+
+#define RATE        44100
+#define MAX_VOICE   8
+
+static uint32_t s_seed = 1;
+static uint32_t urand(void) {
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return s_seed >> 8;
+}
+
+// [0, n), 用高位 (LCG的低位周期很短)
+static int urandInt(int n) {
+    return (int)(((uint64_t)urand() * n) >> 24);
+}
+
+static double nowSec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int16_t* makeSample(int len) {
+    int16_t * pcm = malloc(sizeof(int16_t) * len);
+    for (int i = 0; i < len; ++i) {
+        pcm[i] = (int16_t)(urand() & 0x3fff) - 0x2000;
+    }
+    return pcm;
+}
+
+static int report(const char* name, const char* note, BOOL bOk) {
+    printf("  %-10s %-56s -> %s\n", name, note, bOk ? "ok" : "FAIL");
+    return bOk ? 0 : 1;
+}
+
+// 1. 与直接混合的结果对比: 3个长度不同 (不是块长的整数倍) 的音效, 依次开始
+static int testExact(int nbFrame) {
+    const int   lens[3] = { nbFrame*3 + 17, nbFrame*2 + nbFrame/2, nbFrame + 1 };
+    const float vols[3] = { 0.8f, 1.3f, 0.5f };
+    const int   start[3] = { 0, 1, 3 }; // 第几块开始播放
+    KSYVoicePool * pool = ksy_voice_pool_create(1, MAX_VOICE);
+    int16_t * pcm[3];
+    int       ids[3];
+    for (int i = 0; i < 3; ++i) {
+        pcm[i] = makeSample(lens[i]);
+        int16_t * copy = malloc(sizeof(int16_t) * lens[i]);
+        memcpy(copy, pcm[i], sizeof(int16_t) * lens[i]);
+        ids[i] = ksy_voice_pool_add(pool, copy, lens[i], NULL);
+    }
+    int16_t * out  = malloc(sizeof(int16_t) * nbFrame);
+    int16_t * ref  = malloc(sizeof(int16_t) * nbFrame);
+    int16_t * tail = calloc((size_t)nbFrame * 3, sizeof(int16_t));
+    int64_t bad = 0;
+    int nbBlock = 0;
+    for (int b = 0; b < 8; ++b) {
+        for (int i = 0; i < 3; ++i) {
+            if (start[i] == b) {
+                ksy_voice_pool_play(pool, ids[i], vols[i]);
+            }
+        }
+        const int16_t * srcs[3];
+        float v[3];
+        int n = 0;
+        for (int i = 0; i < 3; ++i) {
+            int pos = (b - start[i]) * nbFrame;
+            if (b < start[i] || pos >= lens[i]) {
+                continue;
+            }
+            int remain = lens[i] - pos;
+            if (remain >= nbFrame) {
+                srcs[n] = pcm[i] + pos;
+            }
+            else {
+                int16_t * t = tail + (size_t)i * nbFrame;
+                memcpy(t, pcm[i] + pos, sizeof(int16_t) * remain);
+                memset(t + remain, 0, sizeof(int16_t) * (nbFrame - remain));
+                srcs[n] = t;
+            }
+            v[n++] = vols[i];
+        }
+        // 内核的结果与输入顺序无关 (逐点求和后饱和), 所以可以按加载顺序混合
+        BOOL bRender = ksy_voice_pool_render(pool, out, nbFrame);
+        if (bRender != (n > 0)) {
+            bad += nbFrame;
+            continue;
+        }
+        if (n == 0) {
+            continue;
+        }
+        ksy_mix_tracks_s16(ref, srcs, v, n, nbFrame);
+        for (int i = 0; i < nbFrame; ++i) {
+            bad += out[i] != ref[i];
+        }
+        nbBlock += 1;
+    }
+    char note[96];
+    snprintf(note, sizeof(note), "%d blocks with 1~3 voices, %lld samples differ",
+             nbBlock, (long long)bad);
+    for (int i = 0; i < 3; ++i) {
+        free(pcm[i]);
+    }
+    free(out);
+    free(ref);
+    free(tail);
+    ksy_voice_pool_destroy(pool);
+    return report("exact", note, bad == 0);
+}
+
+// 加载 nbEffect 个2秒的音效, 保持 nbActive 个在播放, 返回实时的倍数
+static double benchPool(int nbEffect, int nbActive, int nbFrame, int nbLoop) {
+    KSYVoicePool * pool = ksy_voice_pool_create(1, MAX_VOICE);
+    for (int e = 0; e < nbEffect; ++e) {
+        ksy_voice_pool_add(pool, makeSample(RATE * 2), RATE * 2, NULL);
+    }
+    int16_t * buf = malloc(sizeof(int16_t) * nbFrame);
+    double t0 = nowSec();
+    for (int l = 0; l < nbLoop; ++l) {
+        for (int e = ksy_voice_pool_active(pool); e < nbActive; ++e) {
+            ksy_voice_pool_play(pool, (l + e*7) % nbEffect, 0.8f);
+        }
+        ksy_voice_pool_render(pool, buf, nbFrame);
+    }
+    double dt = nowSec() - t0;
+    free(buf);
+    ksy_voice_pool_destroy(pool);
+    return (double)nbFrame * nbLoop / RATE / dt;
+}
+
+// 对照: 每个音效占混音器的一路, 每次所有的track都参与混音
+static double benchDense(int nbEffect, int nbFrame, int nbLoop) {
+    int16_t * pcm = makeSample(RATE * 2);
+    int16_t * buf = malloc(sizeof(int16_t) * nbFrame);
+    const int16_t ** srcs = malloc(sizeof(int16_t*) * nbEffect);
+    float * vols = malloc(sizeof(float) * nbEffect);
+    for (int e = 0; e < nbEffect; ++e) {
+        srcs[e] = pcm + (e * 997) % (RATE * 2 - nbFrame);
+        vols[e] = 0.8f;
+    }
+    double t0 = nowSec();
+    for (int l = 0; l < nbLoop; ++l) {
+        ksy_mix_tracks_s16(buf, srcs, vols, nbEffect, nbFrame);
+    }
+    double dt = nowSec() - t0;
+    free(pcm);
+    free(buf);
+    free(srcs);
+    free(vols);
+    return (double)nbFrame * nbLoop / RATE / dt;
+}
+
+static int testSpeed(int nbEffect, int nbActive, int nbFrame, int nbLoop) {
+    double few   = benchPool(nbActive, nbActive, nbFrame, nbLoop);
+    double many  = benchPool(nbEffect, nbActive, nbFrame, nbLoop);
+    double dense = benchDense(nbEffect, nbFrame, nbLoop);
+    char note[96];
+    int fail = 0;
+    snprintf(note, sizeof(note), "%d/%d active %.0fx realtime, %d/%d active %.0fx",
+             nbActive, nbActive, few, nbActive, nbEffect, many);
+    fail |= report("loaded", note, few <= many * 1.5);
+    snprintf(note, sizeof(note), "dense %d tracks %.0fx realtime (pool %.1fx faster)",
+             nbEffect, dense, many / dense);
+    fail |= report("dense", note, many >= dense * nbEffect / nbActive / 4);
+    return fail;
+}
+
+// 3. 两个线程同时运行
+typedef struct {
+    KSYVoicePool *  pool;
+    int             nbFrame;
+    atomic_int      bStop;
+    int64_t         nbRender;
+} RenderCtx;
+
+static void* renderThread(void* arg) {
+    RenderCtx * ctx = arg;
+    int16_t * buf = malloc(sizeof(int16_t) * ctx->nbFrame);
+    while (!atomic_load(&ctx->bStop)) {
+        ksy_voice_pool_render(ctx->pool, buf, ctx->nbFrame);
+        ctx->nbRender += 1;
+    }
+    free(buf);
+    return NULL;
+}
+
+static int testThreads(int nbEffect, int nbFrame, double sec) {
+    RenderCtx ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.pool    = ksy_voice_pool_create(1, MAX_VOICE);
+    ctx.nbFrame = nbFrame;
+    atomic_init(&ctx.bStop, 0);
+    ksy_voice_pool_reserve(ctx.pool, nbFrame);
+    int * ids = malloc(sizeof(int) * nbEffect);
+    int64_t nbAdded = 0, nbPlay = 0, nbRemove = 0;
+    for (int e = 0; e < nbEffect; ++e) {
+        int len = nbFrame / 2 + urandInt(nbFrame * 8); // 较短, 经常播放完
+        ids[e] = ksy_voice_pool_add(ctx.pool, makeSample(len), len, NULL);
+        nbAdded += 1;
+    }
+    pthread_t th;
+    pthread_create(&th, NULL, renderThread, &ctx);
+    double t0 = nowSec();
+    while (nowSec() - t0 < sec) {
+        int e = urandInt(nbEffect);
+        int op = urandInt(100);
+        if (op < 70) {
+            nbPlay += ksy_voice_pool_play(ctx.pool, ids[e], 0.5f);
+        }
+        else if (op < 95) { // 卸载 (可能正在播放), 再加载一个新的
+            ksy_voice_pool_remove(ctx.pool, ids[e]);
+            int len = nbFrame / 2 + urandInt(nbFrame * 8);
+            ids[e] = ksy_voice_pool_add(ctx.pool, makeSample(len), len, NULL);
+            nbAdded  += 1;
+            nbRemove += 1;
+        }
+        else {
+            ksy_voice_pool_stop_all(ctx.pool);
+        }
+        // 控制接口由界面触发, 频率远低于主轨; 单核时不让出CPU会一直写满命令队列
+        sched_yield();
+    }
+    atomic_store(&ctx.bStop, 1);
+    pthread_join(th, NULL);
+    // 主轨线程已停止, 由本线程代替它处理剩余的命令 (命令队列可能是满的, 先取空再停止)
+    int16_t * buf = malloc(sizeof(int16_t) * nbFrame);
+    ksy_voice_pool_render(ctx.pool, buf, nbFrame);
+    ksy_voice_pool_stop_all(ctx.pool);
+    ksy_voice_pool_render(ctx.pool, buf, nbFrame);
+    free(buf);
+    for (int e = 0; e < nbEffect; ++e) {
+        ksy_voice_pool_remove(ctx.pool, ids[e]);
+    }
+    KSYVoicePoolStat st;
+    ksy_voice_pool_get_stat(ctx.pool, &st);
+    printf("  %lld renders, %lld plays (%lld dropped), %lld unloads\n",
+           (long long)ctx.nbRender, (long long)nbPlay, (long long)st.droppedCnt,
+           (long long)nbRemove);
+    char note[96];
+    int fail = 0;
+    snprintf(note, sizeof(note), "handed back %lld, freed in render %lld",
+             (long long)st.deferredCnt, (long long)st.renderFreeCnt);
+    fail |= report("render", note, st.deferredCnt > 0 && st.renderFreeCnt == 0);
+    snprintf(note, sizeof(note), "added %lld, freed %lld, pending %d, active %d",
+             (long long)nbAdded, (long long)st.freedCnt, st.nbPending, st.nbActive);
+    fail |= report("release", note,
+                   st.freedCnt == nbAdded && st.nbPending == 0 && st.nbActive == 0);
+    free(ids);
+    ksy_voice_pool_destroy(ctx.pool);
+    return fail;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: effectbench [-e effects] [-a active] [-n frames] [-l loops] [-s sec]\n");
+}
+
+int main(int argc, char** argv) {
+    int nbEffect = 64, nbActive = 3, nbFrame = 1024, nbLoop = 20000;
+    double sec = 2;
+    for (int a = 1; a < argc; a += 2) {
+        if (a + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        if      (strcmp(argv[a], "-e") == 0) { nbEffect = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-a") == 0) { nbActive = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-n") == 0) { nbFrame  = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-l") == 0) { nbLoop   = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-s") == 0) { sec      = atof(argv[a+1]); }
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (nbActive <= 0 || nbActive > MAX_VOICE || nbEffect < nbActive || nbFrame <= 0 ||
+        nbFrame > RATE || nbLoop <= 0 || sec <= 0) {
+        usage();
+        return 1;
+    }
+    printf("%d effects, %d active, %d frames, kernel %s\n",
+           nbEffect, nbActive, nbFrame, ksy_audio_kernel_name());
+    int fail = 0;
+    fail |= testExact(nbFrame);
+    fail |= testSpeed(nbEffect, nbActive, nbFrame, nbLoop);
+    fail |= testThreads(nbEffect, nbFrame, sec);
+    return fail;
+}
@@ -0,0 +1,19 @@
+//
+//  Foundation.h
+//  fxbench
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+//  非Apple平台编译 KSYAudioUtils 中纯C模块时使用的最小替代头文件,
+//  只提供这些模块用到的类型和宏
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+typedef signed char BOOL;
+#define YES  ((BOOL)1)
+#define NO   ((BOOL)0)
+#define NS_ENUM(_type, _name) _type _name; enum
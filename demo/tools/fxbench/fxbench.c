@@ -0,0 +1,537 @@
+//
+//  fxbench.c
+//  fxbench
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+//  离线运行效果链, 统计各效果器每块数据的耗时 (可以在Linux/macOS上直接编译)
+//
+//  编译 (在本目录下):
+//    cc -O2 -std=gnu11 -Wno-deprecated -Icompat -I../../KSYLiveDemo/KSYAudioUtils -x c \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioKernel.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioFdnReverb.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioFFT.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioDenoise.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioFx.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioFxChain.m \
+//       fxbench.c -o fxbench -lm -lpthread
+//
+//  用法:
+//    fxbench [选项] in.wav [out.wav]
+//      -e gate,eq,pitch,reverb  效果器及顺序 (默认为 gate,eq,pitch,reverb; 另有 denoise)
+//      -p fx.idx=value          设置参数, fx为效果器在链中的序号, 可以重复
+//      -b 256                   效果链的块长 (帧)
+//      -f 1024                  每次送入的帧数 (模拟采集回调的长度)
+//      -n 1                     重复处理的次数 (只输出第一次的结果)
+//      -C                       强制使用C实现的基础运算
+//      -r clean.wav             参考信号 (输入为参考信号加噪声), 统计处理前后的信噪比
+//      -T                       混响(FDN)自检, 不需要输入文件 (见下)
+//    输入为 16位整数 或 32位浮点 的WAV, 1~2声道; 输出格式与输入相同
+//
+//  混响自检 (fxbench -T), 不通过时返回1:
+//    1. rt60: 房间大小 0, 0.5, 1 时, 冲激响应的RT60 (Schroeder积分, -5~-25dB拟合) 与目标值相差不超过5%
+//    2. 当前平台的各SIMD实现与C实现的输出逐点一致 (单声道S16, 双声道float, 随机分块)
+//    3. 输出各实现每个样本的耗时 (与 KSYStreamerVC 的混响性能测试相同的参数, 只输出不检查)
+//
+//  降噪的评估: 输出按互相关对齐参考信号 (补偿处理延迟) 后, 计算整体信噪比和
+//  分段信噪比 (20ms一段, 限制在 -10~35dB), 例如
+//    fxbench -e denoise -p 0.0=3 -r clean.wav noisy.wav out.wav
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include "KSYAudioFxChain.h"
+#include "KSYAudioKernel.h"
+#include "KSYAudioFdnReverb.h"
+
+typedef struct {
+    int      rate;
+    int      chCnt;
+    BOOL     bFloat;
+    int      nbFrame;
+    void *   data;
+} WavData;
+
+static uint32_t rd32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+static uint16_t rd16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+static void wr32(uint8_t* p, uint32_t v) {
+    p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+static void wr16(uint8_t* p, uint16_t v) {
+    p[0] = v; p[1] = v >> 8;
+}
+
+// 只解析 fmt 和 data 块, 其余的块跳过
+static int readWav(const char* path, WavData* wav) {
+    FILE * fp = fopen(path, "rb");
+    if (fp == NULL) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return -1;
+    }
+    uint8_t hdr[12], ck[8], fmt[16];
+    int bits = 0, tag = 0, ret = -1;
+    memset(wav, 0, sizeof(WavData));
+    if (fread(hdr, 1, 12, fp) != 12 || memcmp(hdr, "RIFF", 4) || memcmp(hdr+8, "WAVE", 4)) {
+        fprintf(stderr, "%s: not a wav file\n", path);
+        goto end;
+    }
+    while (fread(ck, 1, 8, fp) == 8) {
+        uint32_t size = rd32(ck+4);
+        if (memcmp(ck, "fmt ", 4) == 0 && size >= 16) {
+            if (fread(fmt, 1, 16, fp) != 16) {
+                goto end;
+            }
+            tag        = rd16(fmt);
+            wav->chCnt = rd16(fmt+2);
+            wav->rate  = (int)rd32(fmt+4);
+            bits       = rd16(fmt+14);
+            if (tag == 0xFFFE && size >= 40) { // WAVE_FORMAT_EXTENSIBLE, 取子格式
+                uint8_t ext[24];
+                if (fread(ext, 1, 24, fp) != 24) {
+                    goto end;
+                }
+                tag = rd16(ext+8);
+                size -= 24;
+            }
+            fseek(fp, (size - 16) + (size & 1), SEEK_CUR);
+        }
+        else if (memcmp(ck, "data", 4) == 0) {
+            BOOL bS16 = (tag == 1 && bits == 16);
+            wav->bFloat = (tag == 3 && bits == 32);
+            if ((!bS16 && !wav->bFloat) || wav->chCnt < 1 || wav->chCnt > 2) {
+                fprintf(stderr, "%s: only 16bit pcm / 32bit float, 1~2 channels\n", path);
+                goto end;
+            }
+            int bpf = wav->chCnt * bits / 8;
+            wav->nbFrame = (int)(size / bpf);
+            wav->data = malloc((size_t)wav->nbFrame * bpf);
+            if (wav->data == NULL ||
+                fread(wav->data, bpf, wav->nbFrame, fp) != (size_t)wav->nbFrame) {
+                fprintf(stderr, "%s: truncated data\n", path);
+                goto end;
+            }
+            ret = 0;
+            break;
+        }
+        else {
+            fseek(fp, size + (size & 1), SEEK_CUR);
+        }
+    }
+    if (ret != 0 && wav->data == NULL) {
+        fprintf(stderr, "%s: no data chunk\n", path);
+    }
+end:
+    fclose(fp);
+    return ret;
+}
+
+static int writeWav(const char* path, const WavData* wav) {
+    FILE * fp = fopen(path, "wb");
+    if (fp == NULL) {
+        fprintf(stderr, "cannot create %s\n", path);
+        return -1;
+    }
+    int bits = wav->bFloat ? 32 : 16;
+    uint32_t size = (uint32_t)wav->nbFrame * wav->chCnt * bits / 8;
+    uint8_t h[44];
+    memcpy(h, "RIFF", 4);      wr32(h+4, 36 + size);
+    memcpy(h+8, "WAVEfmt ", 8); wr32(h+16, 16);
+    wr16(h+20, wav->bFloat ? 3 : 1);
+    wr16(h+22, wav->chCnt);
+    wr32(h+24, wav->rate);
+    wr32(h+28, wav->rate * wav->chCnt * bits / 8);
+    wr16(h+32, wav->chCnt * bits / 8);
+    wr16(h+34, bits);
+    memcpy(h+36, "data", 4);   wr32(h+40, size);
+    int ret = (fwrite(h, 1, 44, fp) == 44 && fwrite(wav->data, 1, size, fp) == size) ? 0 : -1;
+    fclose(fp);
+    return ret;
+}
+
+static const KSYAudioFxClass* fxByName(const char* name) {
+    const KSYAudioFxClass * all[] = { &ksy_fx_gate, &ksy_fx_eq, &ksy_fx_pitch,
+                                      &ksy_fx_reverb, &ksy_fx_denoise };
+    for (int i = 0; i < 5; ++i) {
+        if (strcmp(all[i]->name, name) == 0) {
+            return all[i];
+        }
+    }
+    return NULL;
+}
+
+static double sampleAt(const WavData* wav, const void* data, size_t i) {
+    return wav->bFloat ? ((const float*)data)[i] : ((const int16_t*)data)[i] / 32768.0;
+}
+
+// 以参考信号 ref 为准, 计算 data 延迟 lag 帧后的信噪比; seg 不为NULL时同时计算分段信噪比
+static double snrDb(const WavData* ref, const WavData* wav, const void* data, int lag, double* seg) {
+    const int ch  = wav->chCnt;
+    const int len = (ref->nbFrame < wav->nbFrame - lag ? ref->nbFrame : wav->nbFrame - lag);
+    const int segLen = wav->rate / 50;
+    double es = 0, ee = 0, segSum = 0;
+    double ss = 0, se = 0;
+    int nbSeg = 0;
+    for (int i = 0; i < len; ++i) {
+        for (int c = 0; c < ch; ++c) {
+            double s = sampleAt(ref, ref->data, (size_t)i * ch + c);
+            double e = sampleAt(wav, data, (size_t)(i + lag) * ch + c) - s;
+            ss += s * s;
+            se += e * e;
+        }
+        if ((i + 1) % segLen == 0) {
+            // 静音段不计入分段信噪比
+            if (ss > 1e-7 * segLen * ch) {
+                double d = 10 * log10((ss + 1e-20) / (se + 1e-20));
+                segSum += d < -10 ? -10 : (d > 35 ? 35 : d);
+                ++nbSeg;
+            }
+            es += ss;
+            ee += se;
+            ss = se = 0;
+        }
+    }
+    es += ss;
+    ee += se;
+    if (seg) {
+        *seg = nbSeg ? segSum / nbSeg : 0;
+    }
+    return 10 * log10((es + 1e-20) / (ee + 1e-20));
+}
+
+// 在 0~maxLag 帧内搜索与参考信号互相关最大的延迟 (第1声道)
+static int findLag(const WavData* ref, const WavData* wav, const void* data, int maxLag) {
+    const int ch  = wav->chCnt;
+    const int len = ref->nbFrame < wav->nbFrame - maxLag ? ref->nbFrame : wav->nbFrame - maxLag;
+    int best = 0;
+    double bestCorr = -1e300;
+    for (int lag = 0; lag <= maxLag && len > 0; ++lag) {
+        double corr = 0;
+        for (int i = 0; i < len; ++i) {
+            corr += sampleAt(ref, ref->data, (size_t)i * ref->chCnt) *
+                    sampleAt(wav, data, (size_t)(i + lag) * ch);
+        }
+        if (corr > bestCorr) {
+            bestCorr = corr;
+            best = lag;
+        }
+    }
+    return best;
+}
+
+static double nowSec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: fxbench [-e gate,eq,pitch,reverb] [-p fx.idx=value]... "
+                    "[-b block] [-f frames] [-n repeat] [-C] [-r clean.wav] in.wav [out.wav]\n"
+                    "       fxbench -T\n");
+}
+
+#pragma mark - reverb self test
+
+static uint32_t s_seed = 1;
+static uint32_t urand(void) {
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return s_seed >> 8;
+}
+
+static int report(const char* name, const char* note, BOOL bOk) {
+    printf("  %-10s %-56s -> %s\n", name, note, bOk ? "ok" : "FAIL");
+    return !bOk;
+}
+
+// 冲激响应的RT60: Schroeder反向积分后, 对 -5~-25dB 的一段做线性拟合, 外推到60dB
+static double measureRt60(float room, int rate) {
+    double target = 0.3 + 3.2 * room * room;   // 与 ksy_fdn_set_param 相同
+    int nbFrame = (int)((target * 0.8 + 0.5) * rate);
+    float * y = calloc(nbFrame, sizeof(float));
+    y[0] = 1.0f;
+    KSYAudioFdnReverb * rv = ksy_fdn_create(rate, 1);
+    KSYReverbParam param = { room, 0.0f, 1.0f, 0.0f, 0.0f };
+    ksy_fdn_set_param(rv, &param);
+    ksy_fdn_process_f32(rv, y, nbFrame);
+    ksy_fdn_destroy(rv);
+    double * edc = malloc(sizeof(double) * nbFrame);
+    double acc = 0;
+    for (int i = nbFrame - 1; i >= 0; --i) {
+        acc += (double)y[i] * y[i];
+        edc[i] = acc;
+    }
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    int n = 0;
+    for (int i = 0; i < nbFrame; ++i) {
+        double db = 10 * log10(edc[i] / edc[0] + 1e-30);
+        if (db <= -5 && db >= -25) {
+            double t = (double)i / rate;
+            sx += t; sy += db; sxx += t * t; sxy += t * db;
+            ++n;
+        }
+    }
+    free(y);
+    free(edc);
+    double slope = n > 1 ? (n * sxy - sx * sy) / (n * sxx - sx * sx) : 0;
+    return slope < 0 ? -60 / slope : 0;
+}
+
+// 用当前实现处理随机分块的噪声, 结果写入 out
+static void runFdn(int chCnt, BOOL bFloat, const void* in, void* out, int nbFrame) {
+    KSYAudioFdnReverb * rv = ksy_fdn_create(44100, chCnt);
+    KSYReverbParam param = { 0.8f, 0.5f, 0.3f, 1.0f, 20.0f };
+    ksy_fdn_set_param(rv, &param);
+    size_t bytes = (size_t)nbFrame * chCnt * (bFloat ? 4 : 2);
+    memcpy(out, in, bytes);
+    s_seed = 7;
+    for (int off = 0; off < nbFrame; ) {
+        int n = 1 + (int)(((uint64_t)urand() * 1500) >> 24);
+        n = n < nbFrame - off ? n : nbFrame - off;
+        if (bFloat) {
+            ksy_fdn_process_f32(rv, (float*)out + (size_t)off * chCnt, n);
+        }
+        else {
+            ksy_fdn_process_s16(rv, (int16_t*)out + (size_t)off * chCnt, n);
+        }
+        off += n;
+    }
+    ksy_fdn_destroy(rv);
+}
+
+static int reverbSelfTest(void) {
+    int fail = 0;
+    char note[128];
+    const float rooms[3] = { 0.0f, 0.5f, 1.0f };
+    const int   rates[2] = { 48000, 44100 };
+    for (int r = 0; r < 2; ++r) {
+        for (int i = 0; i < 3; ++i) {
+            double target = 0.3 + 3.2 * rooms[i] * rooms[i];
+            double rt60 = measureRt60(rooms[i], rates[r]);
+            snprintf(note, sizeof(note), "room %.1f @ %d Hz: %.3f s (target %.2f s)",
+                     rooms[i], rates[r], rt60, target);
+            fail |= report("rt60", note, fabs(rt60 - target) <= target * 0.05);
+        }
+    }
+
+    const int nbFrame = 44100 * 2;
+    int16_t * s16 = malloc(sizeof(int16_t) * nbFrame * 2);
+    float   * f32 = malloc(sizeof(float) * nbFrame * 2);
+    for (int i = 0; i < nbFrame * 2; ++i) {
+        s16[i] = (int16_t)((int)(urand() & 0x7fff) - 0x4000);
+        f32[i] = s16[i] / 32768.0f;
+    }
+    int16_t * refS16 = malloc(sizeof(int16_t) * nbFrame);
+    float   * refF32 = malloc(sizeof(float) * nbFrame * 2);
+    int16_t * outS16 = malloc(sizeof(int16_t) * nbFrame);
+    float   * outF32 = malloc(sizeof(float) * nbFrame * 2);
+    const char * kernels[3] = { "sse2", "avx2", "neon" };
+    ksy_audio_kernel_select("c");
+    runFdn(1, NO, s16, refS16, nbFrame);
+    runFdn(2, YES, f32, refF32, nbFrame);
+    int nbSimd = 0;
+    for (int k = 0; k < 3; ++k) {
+        if (!ksy_audio_kernel_select(kernels[k])) {
+            continue;
+        }
+        ++nbSimd;
+        runFdn(1, NO, s16, outS16, nbFrame);
+        runFdn(2, YES, f32, outF32, nbFrame);
+        BOOL bSame = memcmp(outS16, refS16, sizeof(int16_t) * nbFrame) == 0 &&
+                     memcmp(outF32, refF32, sizeof(float) * nbFrame * 2) == 0;
+        snprintf(note, sizeof(note), "%s vs c: mono s16, stereo f32, random chunks", kernels[k]);
+        fail |= report("bitexact", note, bSame);
+    }
+    if (nbSimd == 0) {
+        printf("  %-10s %-56s\n", "bitexact", "no SIMD kernel on this platform, skipped");
+    }
+
+    // 与 KSYStreamerVC 的 benchReverb 相同: 1024个样本 x 2000次
+    const int nbSample = 1024, nbLoop = 2000;
+    KSYReverbParam param = { 0.8f, 0.5f, 0.3f, 1.0f, 20.0f };
+    const char * all[4] = { "c", "sse2", "avx2", "neon" };
+    for (int k = 0; k < 4; ++k) {
+        if (!ksy_audio_kernel_select(all[k])) {
+            continue;
+        }
+        KSYAudioFdnReverb * mono   = ksy_fdn_create(44100, 1);
+        KSYAudioFdnReverb * stereo = ksy_fdn_create(44100, 2);
+        ksy_fdn_set_param(mono, &param);
+        ksy_fdn_set_param(stereo, &param);
+        double t0 = nowSec();
+        for (int l = 0; l < nbLoop; ++l) {
+            ksy_fdn_process_s16(mono, s16, nbSample);
+        }
+        double dtMono = nowSec() - t0;
+        t0 = nowSec();
+        for (int l = 0; l < nbLoop; ++l) {
+            ksy_fdn_process_f32(stereo, f32, nbSample / 2);
+        }
+        double dtStereo = nowSec() - t0;
+        printf("  %-10s fdn[%s] mono s16: %.1f ns/sample, stereo f32: %.1f ns/sample\n", "speed",
+               all[k], dtMono * 1e9 / nbSample / nbLoop, dtStereo * 1e9 / nbSample / nbLoop);
+        ksy_fdn_destroy(mono);
+        ksy_fdn_destroy(stereo);
+    }
+    ksy_audio_kernel_select(NULL);
+    free(s16);
+    free(f32);
+    free(refS16);
+    free(refF32);
+    free(outS16);
+    free(outF32);
+    return fail;
+}
+
+int main(int argc, char** argv) {
+    const char * fxList = "gate,eq,pitch,reverb";
+    const char * refPath = NULL;
+    const char * params[64];
+    int nbParam = 0, block = 256, feed = 1024, repeat = 1;
+    BOOL bForceC = NO;
+    int a = 1;
+    for (; a < argc && argv[a][0] == '-'; ++a) {
+        const char * opt = argv[a];
+        if (strcmp(opt, "-C") == 0) {
+            bForceC = YES;
+            continue;
+        }
+        if (strcmp(opt, "-T") == 0) {
+            return reverbSelfTest();
+        }
+        if (a + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const char * val = argv[++a];
+        if (strcmp(opt, "-e") == 0)      { fxList = val; }
+        else if (strcmp(opt, "-b") == 0) { block  = atoi(val); }
+        else if (strcmp(opt, "-f") == 0) { feed   = atoi(val); }
+        else if (strcmp(opt, "-n") == 0) { repeat = atoi(val); }
+        else if (strcmp(opt, "-r") == 0) { refPath = val; }
+        else if (strcmp(opt, "-p") == 0 && nbParam < 64) { params[nbParam++] = val; }
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (a >= argc || feed <= 0 || repeat <= 0) {
+        usage();
+        return 1;
+    }
+    const char * inPath  = argv[a];
+    const char * outPath = a + 1 < argc ? argv[a+1] : NULL;
+    WavData wav;
+    if (readWav(inPath, &wav) != 0) {
+        return 1;
+    }
+    WavData ref = { 0 };
+    if (refPath) {
+        if (readWav(refPath, &ref) != 0) {
+            return 1;
+        }
+        if (ref.rate != wav.rate || ref.chCnt != wav.chCnt) {
+            fprintf(stderr, "%s: format differs from input\n", refPath);
+            return 1;
+        }
+    }
+    ksy_audio_kernel_force_c(bForceC);
+    KSYAudioFxChain * chain = ksy_fxchain_create(block);
+    if (chain == NULL) {
+        fprintf(stderr, "invalid block size %d\n", block);
+        return 1;
+    }
+    char names[256];
+    snprintf(names, sizeof(names), "%s", fxList);
+    for (char * tok = strtok(names, ","); tok; tok = strtok(NULL, ",")) {
+        const KSYAudioFxClass * cls = fxByName(tok);
+        if (cls == NULL || ksy_fxchain_add(chain, cls) < 0) {
+            fprintf(stderr, "unknown effect or chain full: %s\n", tok);
+            return 1;
+        }
+    }
+    for (int i = 0; i < nbParam; ++i) {
+        int fx = 0, idx = 0;
+        float v = 0;
+        if (sscanf(params[i], "%d.%d=%f", &fx, &idx, &v) != 3) {
+            fprintf(stderr, "bad param: %s\n", params[i]);
+            return 1;
+        }
+        ksy_fxchain_set_param(chain, fx, idx, v);
+    }
+
+    // 每次重复都从原始输入开始, 第一次的结果写入输出文件
+    size_t bytes = (size_t)wav.nbFrame * wav.chCnt * (wav.bFloat ? 4 : 2);
+    uint8_t * work = malloc(bytes);
+    uint8_t * out  = NULL;
+    double wall = 0;
+    ksy_fxchain_enable_profile(chain, YES);
+    for (int r = 0; r < repeat; ++r) {
+        memcpy(work, wav.data, bytes);
+        double t0 = nowSec();
+        for (int off = 0; off < wav.nbFrame; off += feed) {
+            int n = wav.nbFrame - off < feed ? wav.nbFrame - off : feed;
+            if (wav.bFloat) {
+                ksy_fxchain_process_f32(chain, (float*)work + (size_t)off * wav.chCnt,
+                                        n, wav.rate, wav.chCnt);
+            }
+            else {
+                ksy_fxchain_process_s16(chain, (int16_t*)work + (size_t)off * wav.chCnt,
+                                        n, wav.rate, wav.chCnt);
+            }
+        }
+        wall += nowSec() - t0;
+        if (r == 0) {
+            out  = work;
+            work = malloc(bytes);
+        }
+    }
+    double sec = (double)wav.nbFrame * repeat / wav.rate;
+    printf("%s: %d Hz, %d ch, %s, %.2f s x %d, block %d, kernel %s\n",
+           inPath, wav.rate, wav.chCnt, wav.bFloat ? "f32" : "s16",
+           (double)wav.nbFrame / wav.rate, repeat, block, ksy_audio_kernel_name());
+    printf("  %-8s %12s %12s %12s %10s\n", "effect", "us/block", "us/10ms", "ns/frame", "cpu%");
+    for (int i = 0; i < ksy_fxchain_count(chain); ++i) {
+        int64_t ns = 0, nbBlock = 0, nbFrame = 0;
+        ksy_fxchain_get_profile(chain, i, &ns, &nbBlock, &nbFrame);
+        double nsPerFrame = nbFrame ? (double)ns / nbFrame : 0.0;
+        printf("  %-8s %12.2f %12.2f %12.2f %10.3f\n", ksy_fxchain_class(chain, i)->name,
+               nbBlock ? ns / 1000.0 / nbBlock : 0.0,
+               nsPerFrame * wav.rate / 100 / 1000, nsPerFrame,
+               ns * 1e-9 / sec * 100);
+    }
+    double nsTotal = wall * 1e9 / ((double)wav.nbFrame * repeat);
+    printf("  %-8s %12s %12.2f %12.2f %10.3f\n", "total", "-",
+           nsTotal * wav.rate / 100 / 1000, nsTotal, wall / sec * 100);
+    if (refPath) {
+        double segIn = 0, segOut = 0;
+        int lag = findLag(&ref, &wav, out, wav.rate / 20);
+        double snrIn  = snrDb(&ref, &wav, wav.data, 0, &segIn);
+        double snrOut = snrDb(&ref, &wav, out, lag, &segOut);
+        printf("  snr      in %.2f dB, out %.2f dB, improvement %.2f dB (delay %d frames)\n",
+               snrIn, snrOut, snrOut - snrIn, lag);
+        printf("  segsnr   in %.2f dB, out %.2f dB, improvement %.2f dB\n",
+               segIn, segOut, segOut - segIn);
+    }
+    int ret = 0;
+    if (outPath) {
+        WavData res = wav;
+        res.data = out;
+        if (writeWav(outPath, &res) != 0) {
+            fprintf(stderr, "failed to write %s\n", outPath);
+            ret = 1;
+        }
+    }
+    ksy_fxchain_destroy(chain);
+    free(wav.data);
+    free(ref.data);
+    free(work);
+    free(out);
+    return ret;
+}
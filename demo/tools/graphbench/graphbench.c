@@ -0,0 +1,550 @@
+//
+//  graphbench.c
+//  graphbench
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+//  离线运行和测试音视频处理图 (KSYMediaGraph), 不依赖采集/推流 (可以在Linux/macOS上直接编译)
+//
+//  编译 (在本目录下):
+//    cc -O2 -std=gnu11 -Wno-deprecated -I../fxbench/compat -I../../KSYLiveDemo/KSYAudioUtils \
+//       -I../../KSYLiveDemo/KSYPipeline -x c \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioRing.m \
+//       ../../KSYLiveDemo/KSYPipeline/KSYMediaGraph.m \
+//       ../../KSYLiveDemo/KSYPipeline/KSYMediaNodes.m \
+//       graphbench.c -o graphbench -lm -lpthread
+//
+//  用法:
+//    graphbench [选项]
+//      -t 2        调度线程数
+//      -n 2000     每个测试的包数
+//    检查:
+//      1. 文件源 -> 函数节点 -> 混合 -> 文件输出: 样本数和数值与直接计算的结果一致
+//      2. 视频文件源 + 画中画 -> 文件输出: 帧数一致, 小画面以外的区域不变
+//      3. 背压: 慢的输出节点使上游停下, 队列长度不超过容量, 不丢包, 顺序不变
+//      4. 外部注入: 入口队列满时丢弃并计数, 不阻塞注入线程;
+//         等待注入 (ksy_graph_inject_wait): 下游慢时注入线程等待, 不丢包;
+//         下游停住时每次最多等待 timeout, 超时丢弃并计数
+//      5. 一个输出连接多个输入: 各路都收到全部的包, 包全部释放
+//      6. 调度线程数不同时的吞吐, 各节点的统计
+//    离线处理文件:
+//    graphbench -i in.wav -o out.wav [-g 0.5] [-t 2]
+//    graphbench -y in.yuv -W 640 -H 360 -Y out.yuv [-p in2.yuv -pw 320 -ph 180]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include "KSYMediaGraph.h"
+#include "KSYMediaNodes.h"
+
+static int s_nbThread = 2;
+
+static double nowMs(void) {
+    return ksy_graph_now_ns() * 1e-6;
+}
+
+static void printStat(const KSYMediaGraph* g) {
+    printf("  %-12s %8s %8s %8s %6s %9s %8s %8s %8s\n",
+           "node", "calls", "in", "out", "drop", "busy(ms)", "wait", "latency", "max");
+    for (int i = 0; i < ksy_graph_node_count(g); ++i) {
+        KSYNodeStat st;
+        ksy_graph_node_stat(g, i, &st);
+        printf("  %-12s %8lld %8lld %8lld %6lld %9.1f %8.2f %8.2f %8.2f\n",
+               st.name, (long long)st.calls, (long long)st.pktIn, (long long)st.pktOut,
+               (long long)st.dropCnt, st.busyMs, st.waitMs, st.latencyMs, st.maxLatencyMs);
+    }
+}
+
+#pragma mark - helpers
+static void wr32(uint8_t* p, uint32_t v) { p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24; }
+static void wr16(uint8_t* p, int v) { p[0] = v; p[1] = v >> 8; }
+
+static int writeWav(const char* path, const int16_t* data, int nbFrame, int rate, int chCnt) {
+    FILE * fp = fopen(path, "wb");
+    if (fp == NULL) {
+        return -1;
+    }
+    uint32_t size = (uint32_t)nbFrame * chCnt * 2;
+    uint8_t h[44];
+    memcpy(h, "RIFF", 4);       wr32(h + 4, 36 + size);
+    memcpy(h + 8, "WAVEfmt ", 8); wr32(h + 16, 16);
+    wr16(h + 20, 1);
+    wr16(h + 22, chCnt);
+    wr32(h + 24, rate);
+    wr32(h + 28, rate * chCnt * 2);
+    wr16(h + 32, chCnt * 2);
+    wr16(h + 34, 16);
+    memcpy(h + 36, "data", 4);  wr32(h + 40, size);
+    int ret = (fwrite(h, 1, 44, fp) == 44 && fwrite(data, 2, (size_t)nbFrame * chCnt, fp) ==
+               (size_t)nbFrame * chCnt) ? 0 : -1;
+    fclose(fp);
+    return ret;
+}
+
+// 读出 16bit wav 的数据 (跳过44字节的文件头, 只用于读 wav 输出节点写的文件)
+static int16_t* readWav16(const char* path, int* nbSample) {
+    FILE * fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return NULL;
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp) - 44;
+    fseek(fp, 44, SEEK_SET);
+    int16_t * data = malloc(size > 0 ? size : 1);
+    *nbSample = size > 0 ? (int)(fread(data, 2, size / 2, fp)) : 0;
+    fclose(fp);
+    return data;
+}
+
+static KSYMediaPacket* gainHalf(void* opaque, KSYMediaPacket* pkt) {
+    (void)opaque;
+    pkt = ksy_packet_writable(pkt);
+    for (int i = 0; pkt && i < pkt->nbFrame * pkt->chCnt; ++i) {
+        pkt->pcm[i] *= 0.5f;
+    }
+    return pkt;
+}
+
+#pragma mark - audio files
+static int testAudioFiles(void) {
+    const int rate = 44100, ch = 2, nA = 44100 * 3 + 123, nB = 44100 * 2 + 7;
+    int16_t * a = malloc(sizeof(int16_t) * nA * ch);
+    int16_t * b = malloc(sizeof(int16_t) * nB * ch);
+    for (int i = 0; i < nA * ch; ++i) {
+        a[i] = (int16_t)(12000 * sin(i * 0.013));
+    }
+    for (int i = 0; i < nB * ch; ++i) {
+        b[i] = (int16_t)(8000 * sin(i * 0.0071 + 1));
+    }
+    const char * pa = "/tmp/graphbench_a.wav", * pb = "/tmp/graphbench_b.wav", * po = "/tmp/graphbench_mix.wav";
+    writeWav(pa, a, nA, rate, ch);
+    writeWav(pb, b, nB, rate, ch);
+    // a -> 减半 -> mix.0, b (1024帧一包) -> mix.1 (块长 441)
+    KSYMediaGraph * g  = ksy_graph_create(s_nbThread);
+    KSYMediaNode * sa  = ksy_node_wav_source(g, pa, 1000);
+    KSYMediaNode * sb  = ksy_node_wav_source(g, pb, 1024);
+    KSYMediaNode * hf  = ksy_node_map(g, "half", KSYMediaType_Audio, gainHalf, NULL);
+    KSYMediaNode * mix = ksy_node_audio_mix(g, 2, rate, ch, 441, NULL);
+    KSYMediaNode * out = ksy_node_wav_sink(g, po);
+    BOOL bOk = sa && sb && hf && mix && out &&
+               ksy_graph_connect(g, sa, 0, hf, 0, 4) &&
+               ksy_graph_connect(g, hf, 0, mix, 0, 4) &&
+               ksy_graph_connect(g, sb, 0, mix, 1, 4) &&
+               ksy_graph_connect(g, mix, 0, out, 0, 8) &&
+               ksy_graph_start(g) && ksy_graph_wait(g, 10000);
+    ksy_graph_destroy(g);
+    int nbOut = 0, errors = 0, maxErr = 0;
+    int16_t * o = bOk ? readWav16(po, &nbOut) : NULL;
+    if (o == NULL || nbOut != nA * ch) {
+        errors += 1;
+    }
+    for (int i = 0; o && i < nbOut && i < nA * ch; ++i) {
+        float ref = a[i] / 32768.0f * 0.5f + (i < nB * ch ? b[i] / 32768.0f : 0);
+        int   d   = abs(o[i] - (int)lrintf(ref * 32768.0f));
+        maxErr = d > maxErr ? d : maxErr;
+    }
+    errors += maxErr > 1;
+    printf("audio files: %d + %d frames -> %d frames, max error %d lsb -> %s\n",
+           nA, nB, nbOut / ch, maxErr, errors ? "FAIL" : "ok");
+    free(a);
+    free(b);
+    free(o);
+    remove(pa);
+    remove(pb);
+    remove(po);
+    return errors != 0;
+}
+
+#pragma mark - video files
+static int writeYuv(const char* path, int w, int h, int nbFrame, int base) {
+    FILE * fp = fopen(path, "wb");
+    if (fp == NULL) {
+        return -1;
+    }
+    size_t    size = (size_t)w * h * 3 / 2;
+    uint8_t * buf  = malloc(size);
+    for (int f = 0; f < nbFrame; ++f) {
+        for (size_t i = 0; i < size; ++i) {
+            buf[i] = (uint8_t)(base + f + i % 7);
+        }
+        fwrite(buf, 1, size, fp);
+    }
+    free(buf);
+    fclose(fp);
+    return 0;
+}
+
+static int testVideoFiles(void) {
+    const int w = 320, h = 180, n = 60, ow = 160, oh = 90, on = 20;
+    const int px = 16, py = 16, pw = 96, ph = 54;
+    const char * pm = "/tmp/graphbench_main.yuv", * ps = "/tmp/graphbench_sub.yuv", * po = "/tmp/graphbench_out.yuv";
+    writeYuv(pm, w, h, n, 0);
+    writeYuv(ps, ow, oh, on, 200);
+    KSYMediaGraph * g   = ksy_graph_create(s_nbThread);
+    KSYMediaNode *  src = ksy_node_yuv_source(g, pm, w, h, 15);
+    KSYMediaNode *  sub = ksy_node_yuv_source(g, ps, ow, oh, 15);
+    KSYMediaNode *  pip = ksy_node_pip(g, px, py, pw, ph);
+    KSYMediaNode *  out = ksy_node_yuv_sink(g, po);
+    BOOL bOk = src && sub && pip && out &&
+               ksy_graph_connect(g, src, 0, pip, 0, 3) &&
+               ksy_graph_connect(g, sub, 0, pip, 1, 3) &&
+               ksy_graph_connect(g, pip, 0, out, 0, 3) &&
+               ksy_graph_start(g) && ksy_graph_wait(g, 10000);
+    ksy_graph_destroy(g);
+    // 对比: 小画面以外的区域与输入相同, 小画面区域或者与输入相同 (还没有小画面), 或者来自小画面
+    FILE *    fp   = fopen(po, "rb");
+    size_t    size = (size_t)w * h * 3 / 2;
+    uint8_t * buf  = malloc(size);
+    int frames = 0, errors = !bOk, withPip = 0;
+    while (fp && fread(buf, 1, size, fp) == size) {
+        BOOL bPip = NO;
+        for (size_t i = 0; i < (size_t)w * h; ++i) { // 只比较Y
+            int  x = (int)(i % w), y = (int)(i / w);
+            BOOL bIn = x >= px && x < px + pw && y >= py && y < py + ph;
+            int  ref = (uint8_t)(frames + i % 7);
+            if (buf[i] != ref) {
+                if (!bIn || buf[i] < 200) {
+                    errors += 1;
+                }
+                bPip = YES;
+            }
+        }
+        withPip += bPip;
+        frames  += 1;
+    }
+    if (fp) {
+        fclose(fp);
+    }
+    errors += (frames != n) + (withPip == 0);
+    printf("video files: %d frames -> %d frames, %d with pip -> %s\n",
+           n, frames, withPip, errors ? "FAIL" : "ok");
+    free(buf);
+    remove(pm);
+    remove(ps);
+    remove(po);
+    return errors != 0;
+}
+
+#pragma mark - synthetic nodes
+static atomic_int s_live; // 未释放的外部包
+
+static void onRelease(void* opaque) {
+    (void)opaque;
+    atomic_fetch_sub(&s_live, 1);
+}
+
+typedef struct {
+    int     total;
+    int     idx;
+    BOOL    bWrap;
+} CountSource;
+
+static KSYNodeResult countProcess(KSYMediaNode* node, void* ctx) {
+    CountSource * s = ctx;
+    while (ksy_node_can_push(node, 0)) {
+        if (s->idx >= s->total) {
+            return KSYNode_End;
+        }
+        KSYMediaPacket * pkt = NULL;
+        if (s->bWrap) {
+            atomic_fetch_add(&s_live, 1);
+            pkt = ksy_packet_wrap(KSYMediaType_Audio, NULL, onRelease);
+        }
+        else {
+            pkt = ksy_packet_audio(48000, 1, 480);
+        }
+        pkt->pts = s->idx++;
+        ksy_node_push(node, 0, pkt);
+    }
+    return KSYNode_Ok;
+}
+
+static KSYMediaNode* addCountSource(KSYMediaGraph* g, int total, BOOL bWrap) {
+    CountSource * s = calloc(1, sizeof(CountSource));
+    s->total = total;
+    s->bWrap = bWrap;
+    KSYNodeDesc desc = {0};
+    desc.name       = "source";
+    desc.nbOut      = 1;
+    desc.outType[0] = KSYMediaType_Audio;
+    desc.ctx        = s;
+    desc.process    = countProcess;
+    desc.destroy    = free;
+    return ksy_graph_add_node(g, &desc);
+}
+
+typedef struct {
+    int     usDelay;    // 每个包的处理时间
+    int     cnt;
+    int     outOfOrder;
+    int64_t lastPts;
+} CheckSink;
+
+static KSYMediaPacket* checkPacket(void* opaque, KSYMediaPacket* pkt) {
+    CheckSink * c = opaque;
+    if (c->usDelay > 0) {
+        usleep(c->usDelay);
+    }
+    c->outOfOrder += (c->cnt > 0 && pkt->pts != c->lastPts + 1);
+    c->lastPts     = pkt->pts;
+    c->cnt        += 1;
+    return pkt;
+}
+
+// 模拟一段处理 (约 us 微秒的计算)
+static KSYMediaPacket* busyWork(void* opaque, KSYMediaPacket* pkt) {
+    int    us = *(int*)opaque;
+    double t  = nowMs() + us * 1e-3;
+    volatile double x = 0;
+    while (nowMs() < t) {
+        x += 1;
+    }
+    return pkt;
+}
+
+#pragma mark - back pressure
+static int testBackPressure(int n) {
+    const int cap = 4;
+    CheckSink chk = { 1000, 0, 0, -1 };
+    n = n < 400 ? n : 400;
+    KSYMediaGraph * g   = ksy_graph_create(s_nbThread);
+    KSYMediaNode *  src = addCountSource(g, n, NO);
+    KSYMediaNode *  sk  = ksy_node_sink(g, "slowSink", KSYMediaType_Audio, checkPacket, &chk);
+    ksy_graph_connect(g, src, 0, sk, 0, cap);
+    ksy_graph_start(g);
+    int maxQueued = 0;
+    while (!ksy_graph_wait(g, 2)) {
+        KSYNodeStat st;
+        ksy_graph_node_stat(g, 1, &st);
+        maxQueued = st.queued > maxQueued ? st.queued : maxQueued;
+    }
+    KSYNodeStat ss;
+    ksy_graph_node_stat(g, 0, &ss);
+    int errors = (chk.cnt != n) + (chk.outOfOrder != 0) + (maxQueued > cap) + (ss.dropCnt != 0);
+    printf("back pressure: %d packets through a 1ms sink, queue max %d (cap %d), "
+           "source called %lld times, %d out of order -> %s\n",
+           chk.cnt, maxQueued, cap, (long long)ss.calls, chk.outOfOrder, errors ? "FAIL" : "ok");
+    ksy_graph_destroy(g);
+    return errors != 0;
+}
+
+#pragma mark - injection
+static int testInject(int n) {
+    CheckSink chk = { 200, 0, 0, -1 };
+    KSYMediaGraph * g  = ksy_graph_create(s_nbThread);
+    KSYMediaNode *  in = ksy_graph_add_input(g, "input", KSYMediaType_Audio, 8);
+    KSYMediaNode *  sk = ksy_node_sink(g, "sink", KSYMediaType_Audio, checkPacket, &chk);
+    ksy_graph_connect(g, in, 0, sk, 0, 8);
+    ksy_graph_start(g);
+    int    accepted = 0;
+    double maxCall  = 0;
+    for (int i = 0; i < n; ++i) {
+        KSYMediaPacket * pkt = ksy_packet_audio(48000, 1, 480);
+        pkt->pts = accepted;
+        double t0 = nowMs();
+        accepted += ksy_graph_inject(in, pkt);
+        double dt = nowMs() - t0;
+        maxCall = dt > maxCall ? dt : maxCall;
+        if (i % 16 == 0) {
+            usleep(100);
+        }
+    }
+    ksy_graph_end_input(in);
+    BOOL bDone = ksy_graph_wait(g, 10000);
+    KSYNodeStat st;
+    ksy_graph_node_stat(g, 0, &st);
+    int errors = !bDone + (chk.cnt != accepted) + (accepted + st.dropCnt != n) +
+                 (st.dropCnt == 0) + (chk.outOfOrder != 0);
+    printf("inject: %d injected, %d accepted, %lld dropped, sink got %d, max inject call %.3f ms -> %s\n",
+           n, accepted, (long long)st.dropCnt, chk.cnt, maxCall, errors ? "FAIL" : "ok");
+    ksy_graph_destroy(g);
+    return errors != 0;
+}
+
+// sinkUs: 输出节点处理每个包的时间, timeoutMs: 注入最多等待的时间
+static int testInjectWait(int n, int sinkUs, int timeoutMs) {
+    CheckSink chk = { sinkUs, 0, 0, -1 };
+    BOOL bStall = sinkUs > timeoutMs * 1000;
+    n = bStall ? 32 : n;
+    KSYMediaGraph * g  = ksy_graph_create(s_nbThread);
+    KSYMediaNode *  in = ksy_graph_add_input(g, "input", KSYMediaType_Audio, 8);
+    KSYMediaNode *  sk = ksy_node_sink(g, "sink", KSYMediaType_Audio, checkPacket, &chk);
+    ksy_graph_connect(g, in, 0, sk, 0, 8);
+    ksy_graph_start(g);
+    int    accepted = 0;
+    double maxCall  = 0;
+    for (int i = 0; i < n; ++i) {
+        KSYMediaPacket * pkt = ksy_packet_audio(48000, 1, 480);
+        pkt->pts = accepted;
+        double t0 = nowMs();
+        accepted += ksy_graph_inject_wait(in, pkt, timeoutMs);
+        double dt = nowMs() - t0;
+        maxCall = dt > maxCall ? dt : maxCall;
+    }
+    ksy_graph_end_input(in);
+    BOOL bDone = ksy_graph_wait(g, 10000);
+    KSYNodeStat st;
+    ksy_graph_node_stat(g, 0, &st);
+    int errors = !bDone + (chk.cnt != accepted) + (accepted + st.dropCnt != n) +
+                 (st.blockCnt == 0) + (chk.outOfOrder != 0);
+    if (bStall) { // 每次等待不超过 timeout (留出调度的余量), 超时的都丢弃
+        errors += (st.dropCnt == 0) + (maxCall > timeoutMs + 20);
+    }
+    else {
+        errors += st.dropCnt != 0;
+    }
+    printf("inject wait: %s sink, %d injected, %d accepted, %lld dropped, %lld blocked, "
+           "max inject call %.3f ms (timeout %d) -> %s\n", bStall ? "stalled" : "slow",
+           n, accepted, (long long)st.dropCnt, (long long)st.blockCnt, maxCall, timeoutMs,
+           errors ? "FAIL" : "ok");
+    ksy_graph_destroy(g);
+    return errors != 0;
+}
+
+#pragma mark - fan out
+static int testFanOut(int n) {
+    CheckSink c1 = { 0, 0, 0, -1 }, c2 = { 50, 0, 0, -1 }, c3 = { 0, 0, 0, -1 };
+    atomic_store(&s_live, 0);
+    KSYMediaGraph * g   = ksy_graph_create(s_nbThread);
+    KSYMediaNode *  src = addCountSource(g, n, YES);
+    KSYMediaNode *  s1  = ksy_node_sink(g, "sink1", KSYMediaType_Audio, checkPacket, &c1);
+    KSYMediaNode *  s2  = ksy_node_sink(g, "sink2", KSYMediaType_Audio, checkPacket, &c2);
+    KSYMediaNode *  s3  = ksy_node_sink(g, "sink3", KSYMediaType_Audio, checkPacket, &c3);
+    BOOL bOk = ksy_graph_connect(g, src, 0, s1, 0, 4) &&
+               ksy_graph_connect(g, src, 0, s2, 0, 4) &&
+               ksy_graph_connect(g, src, 0, s3, 0, 4) &&
+               !ksy_graph_connect(g, src, 0, s3, 0, 4) && // 输入端口只能连接一次
+               ksy_graph_start(g) && ksy_graph_wait(g, 10000);
+    ksy_graph_destroy(g);
+    int live   = atomic_load(&s_live);
+    int errors = !bOk + (c1.cnt != n) + (c2.cnt != n) + (c3.cnt != n) + (live != 0) +
+                 c1.outOfOrder + c2.outOfOrder + c3.outOfOrder;
+    printf("fan out: %d packets -> %d / %d / %d, %d not released -> %s\n",
+           n, c1.cnt, c2.cnt, c3.cnt, live, errors ? "FAIL" : "ok");
+    return errors != 0;
+}
+
+#pragma mark - throughput
+static int testThroughput(int n) {
+    int fail = 0;
+    int us   = 50;
+    for (int t = 1; t <= 4; t *= 2) {
+        CheckSink chk = { 0, 0, 0, -1 };
+        KSYMediaGraph * g   = ksy_graph_create(t);
+        KSYMediaNode *  src = addCountSource(g, n, NO);
+        KSYMediaNode *  m1  = ksy_node_map(g, "stage1", KSYMediaType_Audio, busyWork, &us);
+        KSYMediaNode *  m2  = ksy_node_map(g, "stage2", KSYMediaType_Audio, busyWork, &us);
+        KSYMediaNode *  m3  = ksy_node_map(g, "stage3", KSYMediaType_Audio, busyWork, &us);
+        KSYMediaNode *  sk  = ksy_node_sink(g, "sink", KSYMediaType_Audio, checkPacket, &chk);
+        ksy_graph_connect(g, src, 0, m1, 0, 8);
+        ksy_graph_connect(g, m1, 0, m2, 0, 8);
+        ksy_graph_connect(g, m2, 0, m3, 0, 8);
+        ksy_graph_connect(g, m3, 0, sk, 0, 8);
+        double t0 = nowMs();
+        ksy_graph_start(g);
+        BOOL bDone = ksy_graph_wait(g, 60000);
+        double ms = nowMs() - t0;
+        int errors = !bDone + (chk.cnt != n) + (chk.outOfOrder != 0);
+        printf("throughput: %d threads, 3 stages x %d us, %d packets in %.1f ms (%.0f pkt/s) -> %s\n",
+               t, us, chk.cnt, ms, chk.cnt / ms * 1e3, errors ? "FAIL" : "ok");
+        if (t == s_nbThread || (t == 4 && s_nbThread > 4)) {
+            printStat(g);
+        }
+        ksy_graph_destroy(g);
+        fail |= errors != 0;
+    }
+    return fail;
+}
+
+#pragma mark - files
+static float s_gain = 1.0f;
+
+static KSYMediaPacket* applyGain(void* opaque, KSYMediaPacket* pkt) {
+    (void)opaque;
+    pkt = ksy_packet_writable(pkt);
+    for (int i = 0; pkt && i < pkt->nbFrame * pkt->chCnt; ++i) {
+        pkt->pcm[i] *= s_gain;
+    }
+    return pkt;
+}
+
+static int runFiles(const char* inWav, const char* outWav, const char* inYuv, const char* outYuv,
+                    int w, int h, const char* pipYuv, int pw, int ph) {
+    KSYMediaGraph * g = ksy_graph_create(s_nbThread);
+    BOOL bOk = YES;
+    if (inWav && outWav) {
+        KSYMediaNode * src = ksy_node_wav_source(g, inWav, 1024);
+        KSYMediaNode * gn  = ksy_node_map(g, "gain", KSYMediaType_Audio, applyGain, NULL);
+        KSYMediaNode * out = ksy_node_wav_sink(g, outWav);
+        bOk = bOk && src && gn && out &&
+              ksy_graph_connect(g, src, 0, gn, 0, 8) && ksy_graph_connect(g, gn, 0, out, 0, 8);
+    }
+    if (inYuv && outYuv) {
+        KSYMediaNode * src = ksy_node_yuv_source(g, inYuv, w, h, 30);
+        KSYMediaNode * out = ksy_node_yuv_sink(g, outYuv);
+        if (pipYuv) {
+            KSYMediaNode * sub = ksy_node_yuv_source(g, pipYuv, pw, ph, 30);
+            KSYMediaNode * pip = ksy_node_pip(g, (w - pw / 2) & ~1, 16, (pw / 2) & ~1, (ph / 2) & ~1);
+            bOk = bOk && src && out && sub && pip &&
+                  ksy_graph_connect(g, src, 0, pip, 0, 4) && ksy_graph_connect(g, sub, 0, pip, 1, 4) &&
+                  ksy_graph_connect(g, pip, 0, out, 0, 4);
+        }
+        else {
+            bOk = bOk && src && out && ksy_graph_connect(g, src, 0, out, 0, 4);
+        }
+    }
+    double t0 = nowMs();
+    bOk = bOk && ksy_graph_start(g) && ksy_graph_wait(g, -1);
+    printf("%s in %.1f ms\n", bOk ? "done" : "failed to build the graph", nowMs() - t0);
+    if (bOk) {
+        printStat(g);
+    }
+    ksy_graph_destroy(g);
+    return !bOk;
+}
+
+int main(int argc, char** argv) {
+    int n = 2000, w = 0, h = 0, pw = 0, ph = 0;
+    const char * inWav = NULL, * outWav = NULL, * inYuv = NULL, * outYuv = NULL, * pipYuv = NULL;
+    for (int a = 1; a + 1 < argc; a += 2) {
+        if (strcmp(argv[a], "-t") == 0)       { s_nbThread = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-n") == 0)  { n      = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-i") == 0)  { inWav  = argv[a+1]; }
+        else if (strcmp(argv[a], "-o") == 0)  { outWav = argv[a+1]; }
+        else if (strcmp(argv[a], "-g") == 0)  { s_gain = (float)atof(argv[a+1]); }
+        else if (strcmp(argv[a], "-y") == 0)  { inYuv  = argv[a+1]; }
+        else if (strcmp(argv[a], "-Y") == 0)  { outYuv = argv[a+1]; }
+        else if (strcmp(argv[a], "-W") == 0)  { w      = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-H") == 0)  { h      = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-p") == 0)  { pipYuv = argv[a+1]; }
+        else if (strcmp(argv[a], "-pw") == 0) { pw     = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-ph") == 0) { ph     = atoi(argv[a+1]); }
+        else {
+            fprintf(stderr, "usage: graphbench [-t threads] [-n packets] "
+                    "[-i in.wav -o out.wav [-g gain]] [-y in.yuv -W w -H h -Y out.yuv [-p pip.yuv -pw w -ph h]]\n");
+            return 1;
+        }
+    }
+    if (s_nbThread < 1 || s_nbThread > KSY_GRAPH_MAX_THREAD) {
+        fprintf(stderr, "threads: 1~%d\n", KSY_GRAPH_MAX_THREAD);
+        return 1;
+    }
+    if (inWav || inYuv) {
+        return runFiles(inWav, outWav, inYuv, outYuv, w, h, pipYuv, pw, ph);
+    }
+    int fail = 0;
+    fail |= testAudioFiles();
+    fail |= testVideoFiles();
+    fail |= testBackPressure(n);
+    fail |= testInject(n);
+    fail |= testInjectWait(n, 200, 50);
+    fail |= testInjectWait(n, 100000, 5);
+    fail |= testFanOut(n);
+    fail |= testThroughput(n);
+    return fail;
+}
@@ -0,0 +1,231 @@
+//
+//  ladderbench.c
+//  ladderbench
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+//  用合成的带宽和CPU输入测试分辨率/帧率档位切换 (KSYVideoLadder) (可以在Linux/macOS上直接编译)
+//
+//  编译 (在本目录下):
+//    cc -O2 -std=gnu11 -Wno-deprecated -I../fxbench/compat -I../../KSYLiveDemo/KSYNetUtils -x c \
+//       ../../KSYLiveDemo/KSYNetUtils/KSYVideoLadder.m \
+//       ladderbench.c -o ladderbench -lm
+//
+//  用法:
+//    ladderbench [选项]
+//      -i 1000     采样间隔 (毫秒), 与demo的定时器一致
+//      -s 1        随机数种子
+//      -v 0        1: 输出每次采样的时间线 (csv)
+//    档位: 480x270@12 [100,400]  640x360@15 [250,650]  960x540@15 [500,1000] (kbps)
+//    检查:
+//      1. stable: 带宽充足 (有噪声), 不切换
+//      2. step:   带宽骤降后在 DownHoldMs 内降到合适的档位, 恢复后逐档升回, 升档前等待 UpHoldMs
+//      3. hover:  带宽在档位下限附近波动, 切换次数有限
+//      4. cpu:    带宽充足但CPU过高时逐档降低, CPU恢复后升回
+//      5. flap:   最高档的CPU占用过高 (升档后又被迫降档), 升档的等待时间加倍, 升档次数有限
+//      6. random: 随机的带宽和CPU, 档位不越界, 升档与上次切换的间隔不小于 MinDwellMs
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "KSYVideoLadder.h"
+
+#define DOWN_HOLD_MS    2000
+#define UP_HOLD_MS      8000
+#define MAX_UP_HOLD_MS  64000
+#define DWELL_MS        4000
+
+static const KSYLadderRung s_rungs[] = {
+    { 480, 270, 12, 100,  400 },
+    { 640, 360, 15, 250,  650 },
+    { 960, 540, 15, 500, 1000 },
+};
+#define NB_RUNG   ((int)(sizeof(s_rungs) / sizeof(s_rungs[0])))
+
+static uint32_t s_seed       = 1;
+static int      s_intervalMs = 1000;
+static BOOL     s_bVerbose   = NO;
+
+static double urand(void) {
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return (s_seed >> 8) / 16777216.0;
+}
+
+#pragma mark - scenarios
+/// 一个场景: 按时间给出带宽 (kbps) 和CPU占用, CPU可以依赖当前档位
+typedef struct {
+    const char *    name;
+    double          durMs;
+    int             initRung;
+    float (*bw) (double tMs);
+    float (*cpu)(double tMs, int rung);
+} Scenario;
+
+static float noisy(float kbps, float ratio) {
+    return kbps * (1 + ratio * (2 * urand() - 1));
+}
+
+static float bwStable(double t) { return noisy(900, 0.05f); }
+static float bwStep(double t)   { return noisy(t >= 30000 && t < 90000 ? 300 : 900, 0.05f); }
+static float bwHover(double t)  { return 500 + 80 * sin(2 * M_PI * t / 7000) + 20 * (2 * urand() - 1); }
+static float bwFlap(double t)   { return noisy(800, 0.05f); }
+
+static float s_walk = 600;
+static float bwRandom(double t) {
+    s_walk = fminf(fmaxf(s_walk + 120 * (2 * urand() - 1), 50), 1200);
+    return s_walk;
+}
+
+static float cpuIdle(double t, int rung)   { return 0.3f + 0.1f * urand(); }
+static float cpuBurst(double t, int rung)  { return t >= 30000 && t < 60000 ? 0.95f : 0.3f; }
+static float cpuByRung(double t, int rung) { return rung == NB_RUNG - 1 ? 0.95f : 0.5f; }
+static float cpuRandom(double t, int rung) { return urand() < 0.1 ? 0.95f : 0.3f; }
+
+#pragma mark - run
+/// 一次运行的记录
+typedef struct {
+    int     switches;
+    int     ups;
+    double  firstDownMs;    // 第一次降档的时间, <0 表示没有
+    int     firstDownRung;
+    double  firstUpAfterMs; // upAfterMs 之后的第一次升档, <0 表示没有
+    int     minRung;
+    int     lastRung;
+    BOOL    bDwellOk;       // 升档与上次切换的间隔不小于 MinDwellMs
+    BOOL    bRangeOk;
+    BOOL    bUpStepOk;      // 每次只升一档
+    KSYLadderStat stat;
+} RunResult;
+
+static void run(const Scenario* sc, double upAfterMs, RunResult* res) {
+    KSYVideoLadder * l = ksy_ladder_create(s_rungs, NB_RUNG, sc->initRung);
+    ksy_ladder_set_param(l, KSYLadder_DownHoldMs,  DOWN_HOLD_MS);
+    ksy_ladder_set_param(l, KSYLadder_UpHoldMs,    UP_HOLD_MS);
+    ksy_ladder_set_param(l, KSYLadder_MaxUpHoldMs, MAX_UP_HOLD_MS);
+    ksy_ladder_set_param(l, KSYLadder_MinDwellMs,  DWELL_MS);
+    ksy_ladder_reset(l, sc->initRung);
+    memset(res, 0, sizeof(*res));
+    res->firstDownMs    = -1;
+    res->firstUpAfterMs = -1;
+    res->minRung        = sc->initRung;
+    res->bDwellOk       = YES;
+    res->bRangeOk       = YES;
+    res->bUpStepOk      = YES;
+    int    prev   = sc->initRung;
+    double lastSw = 0;
+    for (double t = 0; t < sc->durMs; t += s_intervalMs) {
+        float bw   = sc->bw(t);
+        float cpu  = sc->cpu ? sc->cpu(t, prev) : -1;
+        int   rung = ksy_ladder_update(l, t, bw, cpu);
+        if (s_bVerbose) {
+            printf("%s,%.0f,%.0f,%.2f,%d\n", sc->name, t, bw, cpu, rung);
+        }
+        res->bRangeOk &= rung >= 0 && rung < NB_RUNG;
+        if (rung != prev) {
+            res->switches += 1;
+            if (rung > prev) {
+                res->ups       += 1;
+                res->bDwellOk  &= t - lastSw >= DWELL_MS;
+                res->bUpStepOk &= rung == prev + 1;
+                if (t >= upAfterMs && res->firstUpAfterMs < 0) {
+                    res->firstUpAfterMs = t;
+                }
+            }
+            else if (res->firstDownMs < 0) {
+                res->firstDownMs   = t;
+                res->firstDownRung = rung;
+            }
+            lastSw = t;
+        }
+        res->minRung = rung < res->minRung ? rung : res->minRung;
+        prev = rung;
+    }
+    res->lastRung = prev;
+    ksy_ladder_get_stat(l, &res->stat);
+    ksy_ladder_destroy(l);
+}
+
+static int report(const char* name, const RunResult* r, BOOL bOk, const char* note) {
+    bOk &= r->bRangeOk && r->bDwellOk && r->bUpStepOk;
+    if (!s_bVerbose) {
+        printf("%-7s 切换%3d 升%3d 降(码率)%3d 降(CPU)%3d 最低档%d 最终档%d 升档等待%5.0fms  %-28s -> %s\n",
+               name, r->switches, r->ups, r->stat.bwDownCnt, r->stat.cpuDownCnt,
+               r->minRung, r->lastRung, r->stat.upHoldMs, note, bOk ? "ok" : "FAIL");
+    }
+    return bOk ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    for (int a = 1; a < argc; a += 2) {
+        if (a + 1 >= argc) {
+            fprintf(stderr, "usage: ladderbench [-i ms] [-s seed] [-v 0|1]\n");
+            return 1;
+        }
+        if      (strcmp(argv[a], "-i") == 0) { s_intervalMs = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-s") == 0) { s_seed       = (uint32_t)atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-v") == 0) { s_bVerbose   = atoi(argv[a+1]) != 0; }
+        else {
+            fprintf(stderr, "usage: ladderbench [-i ms] [-s seed] [-v 0|1]\n");
+            return 1;
+        }
+    }
+    if (s_intervalMs < 50 || s_intervalMs > DOWN_HOLD_MS) {
+        fprintf(stderr, "interval must be in [50, %d] ms\n", DOWN_HOLD_MS);
+        return 1;
+    }
+    if (s_bVerbose) {
+        printf("scenario,t_ms,target_kbps,cpu,rung\n");
+    }
+    int fail = 0;
+    RunResult r;
+    char note[64];
+    double tick = s_intervalMs;
+
+    Scenario stable = { "stable", 120000, NB_RUNG - 1, bwStable, cpuIdle };
+    run(&stable, 0, &r);
+    fail |= report(stable.name, &r, r.switches == 0, "");
+
+    // 30s时降到300kbps (档位1的范围), 90s时恢复
+    Scenario step = { "step", 180000, NB_RUNG - 1, bwStep, cpuIdle };
+    run(&step, 90000, &r);
+    double downLag = r.firstDownMs - 30000;
+    double upLag   = r.firstUpAfterMs - 90000;
+    snprintf(note, sizeof(note), "降档延迟%.0fms 升档延迟%.0fms", downLag, upLag);
+    fail |= report(step.name, &r,
+                   r.firstDownMs >= 0 && downLag <= DOWN_HOLD_MS + tick && r.firstDownRung == 1 &&
+                   r.firstUpAfterMs >= 0 && upLag >= UP_HOLD_MS && upLag <= UP_HOLD_MS + 2 * tick &&
+                   r.lastRung == NB_RUNG - 1, note);
+
+    // 在最高档的下限 (500) 附近波动, 升档要求 575 持续8秒
+    Scenario hover = { "hover", 300000, NB_RUNG - 1, bwHover, cpuIdle };
+    run(&hover, 0, &r);
+    fail |= report(hover.name, &r, r.switches <= 2, "");
+
+    // 30~60s CPU过高
+    Scenario cpu = { "cpu", 120000, NB_RUNG - 1, bwStable, cpuBurst };
+    run(&cpu, 60000, &r);
+    snprintf(note, sizeof(note), "降档延迟%.0fms", r.firstDownMs - 30000);
+    fail |= report(cpu.name, &r,
+                   r.firstDownMs >= 0 && r.firstDownMs - 30000 <= DOWN_HOLD_MS + tick &&
+                   r.stat.cpuDownCnt >= 1 && r.stat.bwDownCnt == 0 &&
+                   r.firstUpAfterMs >= 60000 && r.lastRung == NB_RUNG - 1, note);
+
+    // 码率够最高档, 但最高档的CPU占用过高: 没有退避时约每10秒升降一次
+    Scenario flap = { "flap", 300000, 1, bwFlap, cpuByRung };
+    run(&flap, 0, &r);
+    fail |= report(flap.name, &r,
+                   r.ups <= 8 && r.stat.upHoldMs >= MAX_UP_HOLD_MS / 2 && r.stat.bwDownCnt == 0, "");
+
+    Scenario rnd = { "random", 600000, 1, bwRandom, cpuRandom };
+    run(&rnd, 0, &r);
+    fail |= report(rnd.name, &r, r.ups > 0, "");
+
+    // 没有CPU数据时只按码率切换
+    Scenario nocpu = { "nocpu", 180000, NB_RUNG - 1, bwStep, NULL };
+    run(&nocpu, 90000, &r);
+    fail |= report(nocpu.name, &r, r.stat.cpuDownCnt == 0 && r.firstDownRung == 1 &&
+                   r.lastRung == NB_RUNG - 1, "");
+    return fail;
+}
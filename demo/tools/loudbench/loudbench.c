@@ -0,0 +1,388 @@
+//
+//  loudbench.c
+//  loudbench
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+//  离线检查输出级的限幅器 (KSYAudioLimiter) 和响度表 (KSYAudioMeter) (可以在Linux/macOS上直接编译)
+//
+//  编译 (在本目录下):
+//    cc -O2 -std=gnu11 -Wno-deprecated -I../fxbench/compat -I../../KSYLiveDemo/KSYAudioUtils -x c \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioLimiter.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioMeter.m \
+//       loudbench.c -o loudbench -lm
+//
+//  用法:
+//    loudbench [选项] [in.wav | in.pcm]
+//      -t -1       限幅器的门限 (dBFS)
+//      -l 5        预读时长 (ms)
+//      -R 50       释放时间 (ms)
+//      -b 1024     每次处理的帧数 (模拟混音器回调的长度)
+//      -r 44100    输入为 .pcm (S16交织, 无文件头) 时的采样率
+//      -c 1        输入为 .pcm 时的声道数
+//      -o out.wav  保存限幅后的结果
+//    不指定输入时用合成信号自检:
+//      1. 1KHz 正弦, 双声道各 -23 dBFS (峰值): 积分/短期/瞬时响度为 -23.0 LUFS (误差0.1 LU以内),
+//         低于门限的信号经过限幅器后与输入 (延迟预读的长度) 逐点一致
+//      2. 门限为 -1/-3/-6/-12 dBFS 时, 超过门限 6~18dB 的正弦和满幅的突发噪声,
+//         输出的每个样本都不超过门限 (四舍五入到S16), 突发结束并经过释放时间后恢复逐点直通
+//    指定输入时, 输出限幅前后的响度和峰值, 检查限幅后的样本不超过门限
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "KSYAudioLimiter.h"
+#include "KSYAudioMeter.h"
+
+typedef struct {
+    int       rate;
+    int       chCnt;
+    int       nbFrame;
+    int16_t * pcm;
+} PcmData;
+
+static int s_block     = 1024;
+static float s_lookMs  = 5;
+static float s_relMs   = 50;
+
+static uint32_t s_seed = 1;
+static double urand(void) {
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return (s_seed >> 8) / 16777216.0;
+}
+
+static uint32_t rd32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+static uint16_t rd16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+static void wr32(uint8_t* p, uint32_t v) {
+    p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+static void wr16(uint8_t* p, uint16_t v) {
+    p[0] = v; p[1] = v >> 8;
+}
+
+// 只支持 16位整数 的WAV
+static int readWav(const char* path, PcmData* pd) {
+    FILE * fp = fopen(path, "rb");
+    if (fp == NULL) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return -1;
+    }
+    uint8_t hdr[12];
+    int ret = -1;
+    memset(pd, 0, sizeof(PcmData));
+    if (fread(hdr, 1, 12, fp) != 12 || memcmp(hdr, "RIFF", 4) || memcmp(hdr+8, "WAVE", 4)) {
+        fprintf(stderr, "%s: not a wav file\n", path);
+        fclose(fp);
+        return -1;
+    }
+    uint8_t ck[8];
+    while (fread(ck, 1, 8, fp) == 8) {
+        uint32_t size = rd32(ck+4);
+        if (memcmp(ck, "fmt ", 4) == 0) {
+            uint8_t fmt[16];
+            if (size < 16 || fread(fmt, 1, 16, fp) != 16) {
+                break;
+            }
+            pd->chCnt = rd16(fmt+2);
+            pd->rate  = (int)rd32(fmt+4);
+            if (rd16(fmt) != 1 || rd16(fmt+14) != 16) {
+                fprintf(stderr, "%s: only 16-bit PCM wav is supported\n", path);
+                break;
+            }
+            fseek(fp, size - 16 + (size & 1), SEEK_CUR);
+        }
+        else if (memcmp(ck, "data", 4) == 0 && pd->chCnt > 0) {
+            pd->nbFrame = (int)(size / (2 * pd->chCnt));
+            pd->pcm = malloc(sizeof(int16_t) * pd->nbFrame * pd->chCnt);
+            if (pd->pcm && fread(pd->pcm, 2 * pd->chCnt, pd->nbFrame, fp) == (size_t)pd->nbFrame) {
+                ret = 0;
+            }
+            break;
+        }
+        else {
+            fseek(fp, size + (size & 1), SEEK_CUR);
+        }
+    }
+    fclose(fp);
+    if (ret != 0) {
+        free(pd->pcm);
+        pd->pcm = NULL;
+    }
+    return ret;
+}
+
+static int readRaw(const char* path, int rate, int chCnt, PcmData* pd) {
+    FILE * fp = fopen(path, "rb");
+    if (fp == NULL) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return -1;
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    pd->rate    = rate;
+    pd->chCnt   = chCnt;
+    pd->nbFrame = (int)(size / (2 * chCnt));
+    pd->pcm     = malloc(sizeof(int16_t) * pd->nbFrame * chCnt);
+    int ret = (pd->pcm && fread(pd->pcm, 2 * chCnt, pd->nbFrame, fp) == (size_t)pd->nbFrame) ? 0 : -1;
+    fclose(fp);
+    return ret;
+}
+
+static int writeWav(const char* path, const PcmData* pd) {
+    FILE * fp = fopen(path, "wb");
+    if (fp == NULL) {
+        fprintf(stderr, "cannot create %s\n", path);
+        return -1;
+    }
+    uint32_t size = (uint32_t)pd->nbFrame * pd->chCnt * 2;
+    uint8_t h[44];
+    memcpy(h, "RIFF", 4);      wr32(h+4, 36 + size);
+    memcpy(h+8, "WAVEfmt ", 8); wr32(h+16, 16);
+    wr16(h+20, 1);
+    wr16(h+22, pd->chCnt);
+    wr32(h+24, pd->rate);
+    wr32(h+28, pd->rate * pd->chCnt * 2);
+    wr16(h+32, pd->chCnt * 2);
+    wr16(h+34, 16);
+    memcpy(h+36, "data", 4);   wr32(h+40, size);
+    int ret = (fwrite(h, 1, 44, fp) == 44 && fwrite(pd->pcm, 1, size, fp) == size) ? 0 : -1;
+    fclose(fp);
+    return ret;
+}
+
+static int report(const char* name, const char* note, int bOk) {
+    printf("  %-10s %-62s -> %s\n", name, note, bOk ? "ok" : "FAIL");
+    return bOk ? 0 : 1;
+}
+
+// 门限对应的S16最大值 (与限幅器相同的四舍五入)
+static int ceilingS16(float thresholdDb) {
+    return (int)lrintf(powf(10.0f, thresholdDb / 20.0f) * 32768.0f);
+}
+
+static int maxAbs(const int16_t* pcm, size_t n) {
+    int m = 0;
+    for (size_t i = 0; i < n; ++i) {
+        int a = abs(pcm[i]);
+        m = a > m ? a : m;
+    }
+    return m;
+}
+
+// 按块送入限幅器 (原地) 和两个电平表 (限幅前/后)
+static void runStage(KSYAudioLimiter* lim, KSYAudioMeter* mIn, KSYAudioMeter* mOut,
+                     int16_t* pcm, int nbFrame, int ch) {
+    for (int off = 0; off < nbFrame; off += s_block) {
+        int n = nbFrame - off < s_block ? nbFrame - off : s_block;
+        int16_t * p = pcm + (size_t)off * ch;
+        if (mIn) {
+            ksy_meter_process_s16(mIn, p, n);
+        }
+        if (lim) {
+            ksy_limiter_process_s16(lim, p, n);
+        }
+        if (mOut) {
+            ksy_meter_process_s16(mOut, p, n);
+        }
+    }
+}
+
+// 限幅器的输出与延迟后的输入逐点比较, 返回不一致的样本数 (只比较 [from, nbFrame))
+static int64_t diffDelayed(const int16_t* in, const int16_t* out, int nbFrame, int ch,
+                           int latency, int from) {
+    int64_t bad = 0;
+    for (int i = from > latency ? from : latency; i < nbFrame; ++i) {
+        for (int c = 0; c < ch; ++c) {
+            bad += out[(size_t)i*ch + c] != in[(size_t)(i - latency)*ch + c];
+        }
+    }
+    return bad;
+}
+
+// 1. -23 dBFS 的 1KHz 正弦
+static int testR128(int rate) {
+    const int ch = 2, sec = 20;
+    int nbFrame  = rate * sec;
+    double amp   = pow(10.0, -23.0 / 20.0) * 32768.0;
+    int16_t * in  = malloc(sizeof(int16_t) * nbFrame * ch);
+    int16_t * out = malloc(sizeof(int16_t) * nbFrame * ch);
+    for (int i = 0; i < nbFrame; ++i) {
+        int16_t v = (int16_t)lrint(amp * sin(2 * M_PI * 1000.0 * i / rate));
+        in[i*ch] = in[i*ch + 1] = v;
+    }
+    memcpy(out, in, sizeof(int16_t) * nbFrame * ch);
+    KSYAudioLimiter * lim = ksy_limiter_create(rate, ch, s_lookMs, s_relMs);
+    KSYAudioMeter   * mtr = ksy_meter_create(rate, ch);
+    runStage(lim, mtr, NULL, out, nbFrame, ch);
+    KSYAudioLevel lv;
+    ksy_meter_get(mtr, &lv);
+    char note[128];
+    int fail = 0;
+    snprintf(note, sizeof(note), "%d Hz: I %.2f  S %.2f  M %.2f LUFS, peak %.2f dBFS",
+             rate, lv.integrated, lv.shortTerm, lv.momentary, lv.maxPeak);
+    fail |= report("r128", note, fabs(lv.integrated + 23) <= 0.1 && fabs(lv.shortTerm + 23) <= 0.1 &&
+                                 fabs(lv.momentary + 23) <= 0.1);
+    int64_t bad = diffDelayed(in, out, nbFrame, ch, ksy_limiter_latency(lim), 0);
+    snprintf(note, sizeof(note), "below threshold, latency %d frames, %lld samples differ",
+             ksy_limiter_latency(lim), (long long)bad);
+    fail |= report("passthru", note, bad == 0 && ksy_limiter_reduction(lim) == 0);
+    free(in);
+    free(out);
+    ksy_limiter_destroy(lim);
+    ksy_meter_destroy(mtr);
+    return fail;
+}
+
+// 2. 超过门限的信号: 正弦逐段增大到门限以上 18dB, 中间夹满幅的突发噪声, 最后是低于门限的正弦
+static int testCeiling(int rate, float thresholdDb) {
+    const int ch = 2;
+    int seg      = rate;                // 每段1秒
+    int nbFrame  = seg * 6;
+    int16_t * in  = malloc(sizeof(int16_t) * nbFrame * ch);
+    int16_t * out = malloc(sizeof(int16_t) * nbFrame * ch);
+    double thr = pow(10.0, thresholdDb / 20.0) * 32768.0;
+    for (int i = 0; i < nbFrame; ++i) {
+        int    s = i / seg;
+        double v;
+        if (s < 3) {        // 超过门限 6/12/18 dB (超过满幅时削波)
+            v = thr * pow(10.0, 6.0 * (s + 1) / 20.0) * sin(2 * M_PI * 440.0 * i / rate);
+        }
+        else if (s == 3) {  // 满幅突发噪声: 每50ms中有5ms
+            v = (i % (rate / 20)) < rate / 200 ? (urand() < 0.5 ? -32768 : 32767) :
+                0.1 * thr * sin(2 * M_PI * 440.0 * i / rate);
+        }
+        else {              // 低于门限 6dB
+            v = 0.5 * thr * sin(2 * M_PI * 440.0 * i / rate);
+        }
+        for (int c = 0; c < ch; ++c) {
+            double x = c ? -v : v;
+            in[i*ch + c] = (int16_t)(x > 32767 ? 32767 : (x < -32768 ? -32768 : lrint(x)));
+        }
+    }
+    memcpy(out, in, sizeof(int16_t) * nbFrame * ch);
+    KSYAudioLimiter * lim = ksy_limiter_create(rate, ch, s_lookMs, s_relMs);
+    KSYAudioMeter   * mtr = ksy_meter_create(rate, ch);
+    ksy_limiter_set_threshold(lim, thresholdDb);
+    runStage(lim, NULL, mtr, out, nbFrame, ch);
+    KSYAudioLevel lv;
+    ksy_meter_get(mtr, &lv);
+    int ceil = ceilingS16(thresholdDb);
+    int peak = maxAbs(out, (size_t)nbFrame * ch);
+    // 最后一段: 突发结束后留出预读和10倍的释放时间
+    int from = seg * 4 + ksy_limiter_latency(lim) + (int)(s_relMs * 10 * rate / 1000);
+    int64_t bad = diffDelayed(in, out, nbFrame, ch, ksy_limiter_latency(lim), from);
+    char note[128];
+    int fail = 0;
+    snprintf(note, sizeof(note), "%5.1f dBFS: out peak %d <= %d (meter %.2f dBFS)",
+             thresholdDb, peak, ceil, lv.maxPeak);
+    fail |= report("ceiling", note, peak <= ceil);
+    snprintf(note, sizeof(note), "%5.1f dBFS: %lld samples differ after release",
+             thresholdDb, (long long)bad);
+    fail |= report("release", note, bad == 0);
+    free(in);
+    free(out);
+    ksy_limiter_destroy(lim);
+    ksy_meter_destroy(mtr);
+    return fail;
+}
+
+static int runFile(const PcmData* pd, float thresholdDb, const char* outPath) {
+    KSYAudioLimiter * lim  = ksy_limiter_create(pd->rate, pd->chCnt, s_lookMs, s_relMs);
+    KSYAudioMeter   * mIn  = ksy_meter_create(pd->rate, pd->chCnt);
+    KSYAudioMeter   * mOut = ksy_meter_create(pd->rate, pd->chCnt);
+    if (lim == NULL || mIn == NULL || mOut == NULL) {
+        fprintf(stderr, "unsupported format: %d Hz, %d ch\n", pd->rate, pd->chCnt);
+        return 1;
+    }
+    ksy_limiter_set_threshold(lim, thresholdDb);
+    runStage(lim, mIn, mOut, pd->pcm, pd->nbFrame, pd->chCnt);
+    KSYAudioLevel in, out;
+    ksy_meter_get(mIn, &in);
+    ksy_meter_get(mOut, &out);
+    printf("%d Hz, %d ch, %.2f s, threshold %.1f dBFS, latency %d frames\n",
+           pd->rate, pd->chCnt, (double)pd->nbFrame / pd->rate, thresholdDb,
+           ksy_limiter_latency(lim));
+    printf("  in:  integrated %7.2f LUFS  short-term %7.2f  max peak %6.2f dBFS\n",
+           in.integrated, in.shortTerm, in.maxPeak);
+    printf("  out: integrated %7.2f LUFS  short-term %7.2f  max peak %6.2f dBFS\n",
+           out.integrated, out.shortTerm, out.maxPeak);
+    int ceil = ceilingS16(thresholdDb);
+    int peak = maxAbs(pd->pcm, (size_t)pd->nbFrame * pd->chCnt);
+    char note[128];
+    snprintf(note, sizeof(note), "out peak %d <= %d", peak, ceil);
+    int fail = report("ceiling", note, peak <= ceil);
+    if (outPath && writeWav(outPath, pd) != 0) {
+        fail = 1;
+    }
+    ksy_limiter_destroy(lim);
+    ksy_meter_destroy(mIn);
+    ksy_meter_destroy(mOut);
+    return fail;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: loudbench [-t dBFS] [-l ms] [-R ms] [-b block] [-r rate] [-c ch] "
+                    "[-o out.wav] [in.wav | in.pcm]\n");
+}
+
+int main(int argc, char** argv) {
+    float thresholdDb = -1;
+    int rate = 44100, chCnt = 1;
+    const char * inPath  = NULL;
+    const char * outPath = NULL;
+    for (int a = 1; a < argc; ++a) {
+        if (argv[a][0] != '-') {
+            inPath = argv[a];
+            continue;
+        }
+        if (a + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const char * opt = argv[a];
+        const char * val = argv[++a];
+        if      (strcmp(opt, "-t") == 0) { thresholdDb = (float)atof(val); }
+        else if (strcmp(opt, "-l") == 0) { s_lookMs    = (float)atof(val); }
+        else if (strcmp(opt, "-R") == 0) { s_relMs     = (float)atof(val); }
+        else if (strcmp(opt, "-b") == 0) { s_block     = atoi(val); }
+        else if (strcmp(opt, "-r") == 0) { rate        = atoi(val); }
+        else if (strcmp(opt, "-c") == 0) { chCnt       = atoi(val); }
+        else if (strcmp(opt, "-o") == 0) { outPath     = val; }
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (s_block <= 0 || rate <= 0 || chCnt <= 0 || !(thresholdDb <= 0 && thresholdDb > -40) ||
+        !(s_lookMs >= 1 && s_lookMs <= 20) || !(s_relMs > 0)) {
+        usage();
+        return 1;
+    }
+    if (inPath) {
+        PcmData pd;
+        size_t len = strlen(inPath);
+        BOOL bRaw = len > 4 && strcmp(inPath + len - 4, ".pcm") == 0;
+        if ((bRaw ? readRaw(inPath, rate, chCnt, &pd) : readWav(inPath, &pd)) != 0) {
+            return 1;
+        }
+        int fail = runFile(&pd, thresholdDb, outPath);
+        free(pd.pcm);
+        return fail;
+    }
+    printf("self test: look-ahead %.1f ms, release %.0f ms, block %d\n", s_lookMs, s_relMs, s_block);
+    int fail = 0;
+    fail |= testR128(48000);
+    fail |= testR128(44100);
+    const float thresholds[] = { -1, -3, -6, -12 };
+    for (int i = 0; i < 4; ++i) {
+        fail |= testCeiling(44100, thresholds[i]);
+    }
+    return fail;
+}
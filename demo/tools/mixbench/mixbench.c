@@ -0,0 +1,122 @@
+//
+//  mixbench.c
+//  mixbench
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+//  统计各实现 (c/sse2/avx2/neon) 在不同路数下的混音速度 (可以在Linux/macOS上直接编译)
+//
+//  编译 (在本目录下):
+//    cc -O2 -std=gnu11 -Wno-deprecated -I../fxbench/compat -I../../KSYLiveDemo/KSYAudioUtils -x c \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioKernel.m \
+//       mixbench.c -o mixbench -lm -lpthread
+//
+//  用法:
+//    mixbench [选项]
+//      -n 1024     每次混音的样本数 (约23ms的44.1KHz单声道数据)
+//      -l 20000    每种组合重复的次数
+//      -t 8        最多的路数, 从1路测到t路
+//    输出每秒处理的输入样本数 (M samples/s, 按 路数*样本数 计) 和相对C实现的倍数;
+//    同时检查各实现的S16结果与C实现逐点一致, 不一致时返回1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "KSYAudioKernel.h"
+
+#define MAX_TRACK   8
+
+static const char * s_kernels[] = { "c", "sse2", "avx2", "neon" };
+#define NB_KERNEL   ((int)(sizeof(s_kernels) / sizeof(s_kernels[0])))
+
+static uint32_t s_seed = 1;
+static int16_t rand16(void) {
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return (int16_t)(s_seed >> 16);
+}
+
+static double nowSec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: mixbench [-n samples] [-l loops] [-t tracks]\n");
+}
+
+int main(int argc, char** argv) {
+    int nbSample = 1024, nbLoop = 20000, maxTrack = MAX_TRACK;
+    for (int a = 1; a < argc; a += 2) {
+        if (a + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        if      (strcmp(argv[a], "-n") == 0) { nbSample = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-l") == 0) { nbLoop   = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-t") == 0) { maxTrack = atoi(argv[a+1]); }
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (nbSample <= 0 || nbLoop <= 0 || maxTrack < 1 || maxTrack > MAX_TRACK) {
+        usage();
+        return 1;
+    }
+    // 满幅的随机数据, 多路叠加时会触发饱和
+    int16_t * pcm = malloc(sizeof(int16_t) * nbSample * MAX_TRACK);
+    int16_t * out = malloc(sizeof(int16_t) * nbSample);
+    int16_t * ref = malloc(sizeof(int16_t) * nbSample * (MAX_TRACK + 1));
+    for (int i = 0; i < nbSample * MAX_TRACK; ++i) {
+        pcm[i] = rand16();
+    }
+    const int16_t * srcs[MAX_TRACK];
+    float vols[MAX_TRACK];
+    for (int t = 0; t < MAX_TRACK; ++t) {
+        srcs[t] = pcm + nbSample * t;
+        vols[t] = 0.3f + 0.2f * t;
+    }
+
+    printf("%d samples x %d loops\n", nbSample, nbLoop);
+    printf("  %-6s %6s %16s %10s %8s\n", "kernel", "tracks", "M samples/s", "vs c", "exact");
+    double cRate[MAX_TRACK + 1] = { 0 };
+    int fail = 0;
+    for (int k = 0; k < NB_KERNEL; ++k) {
+        if (!ksy_audio_kernel_select(s_kernels[k])) {
+            continue; // 当前平台/CPU不支持
+        }
+        for (int nbTrack = 1; nbTrack <= maxTrack; ++nbTrack) {
+            // 先算一次结果, 与C实现的结果对比
+            ksy_mix_tracks_s16(out, srcs, vols, nbTrack, nbSample);
+            int16_t * r = ref + nbSample * nbTrack;
+            BOOL bExact = YES;
+            if (k == 0) {
+                memcpy(r, out, sizeof(int16_t) * nbSample);
+            }
+            else {
+                bExact = memcmp(r, out, sizeof(int16_t) * nbSample) == 0;
+            }
+            double t0 = nowSec();
+            for (int l = 0; l < nbLoop; ++l) {
+                ksy_mix_tracks_s16(out, srcs, vols, nbTrack, nbSample);
+            }
+            double dt = nowSec() - t0;
+            double rate = (double)nbSample * nbTrack * nbLoop / dt / 1e6;
+            if (k == 0) {
+                cRate[nbTrack] = rate;
+            }
+            printf("  %-6s %6d %16.1f %9.2fx %8s\n", s_kernels[k], nbTrack, rate,
+                   rate / cRate[nbTrack], bExact ? "ok" : "FAIL");
+            fail |= !bExact;
+        }
+    }
+    ksy_audio_kernel_select(NULL);
+    printf("auto: %s\n", ksy_audio_kernel_name());
+    free(pcm);
+    free(out);
+    free(ref);
+    return fail;
+}
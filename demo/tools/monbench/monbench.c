@@ -0,0 +1,157 @@
+//
+//  monbench.c
+//  monbench
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+//  用模拟的声卡测试耳返核心 (KSYAudioMonitor) 的延迟和欠载 (可以在Linux/macOS上直接编译)
+//
+//  编译 (在本目录下):
+//    cc -O2 -std=gnu11 -Wno-deprecated -I../fxbench/compat -I../../KSYLiveDemo/KSYAudioUtils -x c \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioRing.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioMonitor.m \
+//       monbench.c -o monbench -lm
+//
+//  用法:
+//    monbench [选项]
+//      -r 48000    采样率
+//      -i 256      采集块长 (帧)
+//      -o 256      播放块长 (帧)
+//      -p 0        播放时钟相对采集时钟的偏差 (ppm, 如蓝牙耳机 +-200)
+//      -j 0        采集回调的随机推迟 (毫秒, 模拟线程调度的抖动)
+//      -H 5        硬件的输入和输出延迟 (毫秒, 各自)
+//      -s 20       时长 (秒)
+//      -x          加入一个模拟的效果处理 (增益)
+//    输入为每0.25秒一个脉冲, 在输出端找到脉冲后按模拟的时间轴计算实际延迟, 与报告的延迟比较
+//    两个回调按时间顺序交替调用, 同一时刻先采集后播放 (与iOS RemoteIO的IO线程顺序相同)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "KSYAudioMonitor.h"
+
+static uint32_t s_seed = 1;
+
+static double frand01(void) {
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return (s_seed >> 8) * (1.0 / 16777216.0);
+}
+
+static void gainFx(void* opaque, float* pcm, int nbFrame, int rate) {
+    float g = *(float*)opaque;
+    for (int i = 0; i < nbFrame; ++i) {
+        pcm[i] *= g;
+    }
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: monbench [-r rate] [-i inFrames] [-o outFrames] [-p ppm] "
+                    "[-j jitterMs] [-H hwMs] [-s sec] [-x]\n");
+}
+
+int main(int argc, char** argv) {
+    int rate = 48000, inN = 256, outN = 256, bFx = 0;
+    double ppm = 0, jitterMs = 0, hwMs = 5, sec = 20;
+    for (int a = 1; a < argc; ++a) {
+        const char * opt = argv[a];
+        if (strcmp(opt, "-x") == 0) { bFx = 1; continue; }
+        if (a + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const char * val = argv[++a];
+        if (strcmp(opt, "-r") == 0)      { rate     = atoi(val); }
+        else if (strcmp(opt, "-i") == 0) { inN      = atoi(val); }
+        else if (strcmp(opt, "-o") == 0) { outN     = atoi(val); }
+        else if (strcmp(opt, "-p") == 0) { ppm      = atof(val); }
+        else if (strcmp(opt, "-j") == 0) { jitterMs = atof(val); }
+        else if (strcmp(opt, "-H") == 0) { hwMs     = atof(val); }
+        else if (strcmp(opt, "-s") == 0) { sec      = atof(val); }
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (inN <= 0 || outN <= 0 || inN > 8192 || outN > 8192) {
+        usage();
+        return 1;
+    }
+    KSYAudioMonitor * mon = ksy_monitor_create(rate, 200);
+    if (mon == NULL) {
+        fprintf(stderr, "invalid rate %d\n", rate);
+        return 1;
+    }
+    float gain = 0.5f;
+    if (bFx) {
+        ksy_monitor_set_processor(mon, gainFx, &gain);
+    }
+    ksy_monitor_set_device_latency(mon, hwMs / 1000, hwMs / 1000);
+
+    // 时间轴: ADC 的第 n 个样本在 n/rate 秒进入硬件, 再经过 hwMs 进入采集块;
+    // 采集块在写满后加上随机抖动时回调. 播放块 m 在 m*outN/outRate 秒回调,
+    // 数据在下一个块长之后开始播放, 再经过 hwMs 到达耳机
+    const double outRate = rate * (1 + ppm * 1e-6);
+    const int    period  = rate / 4;
+    const double inHw    = hwMs / 1000, outHw = hwMs / 1000;
+    float * in  = malloc(sizeof(float) * inN);
+    float * out = malloc(sizeof(float) * outN);
+    int64_t inIdx = 0, outIdx = 0, capBlk = 0, renBlk = 0;
+    double latSum = 0, latMin = 1e9, latMax = 0, repSum = 0;
+    int latCnt = 0, repCnt = 0;
+    int64_t lastPulse = -1;
+    while (1) {
+        double tCap = (double)(capBlk + 1) * inN / rate + inHw + jitterMs / 1000 * frand01();
+        double tRen = (double)renBlk * outN / outRate;
+        if (tCap > sec && tRen > sec) {
+            break;
+        }
+        if (tCap <= tRen) {
+            for (int i = 0; i < inN; ++i, ++inIdx) {
+                in[i] = (inIdx % period == 0) ? 1.0f : 0.0f;
+            }
+            ksy_monitor_capture(mon, in, inN, tCap);
+            ++capBlk;
+            continue;
+        }
+        ksy_monitor_render(mon, out, outN, tRen);
+        double tPlay = tRen + (double)outN / outRate + outHw;
+        for (int j = 0; j < outN; ++j, ++outIdx) {
+            if (out[j] > 0.1f) {
+                double t = tPlay + j / outRate;
+                int64_t pulse = (int64_t)floor(t * rate / period) * period;
+                if (pulse == lastPulse) {
+                    continue;
+                }
+                lastPulse = pulse;
+                double lat = (t - (double)pulse / rate) * 1000;
+                latSum += lat;
+                latCnt++;
+                latMin = lat < latMin ? lat : latMin;
+                latMax = lat > latMax ? lat : latMax;
+            }
+        }
+        ++renBlk;
+        if (tRen > 1.0) {
+            KSYMonitorStat st;
+            ksy_monitor_get_stat(mon, &st);
+            repSum += st.totalMs;
+            repCnt++;
+        }
+    }
+    KSYMonitorStat st;
+    ksy_monitor_get_stat(mon, &st);
+    printf("rate %d, in %d, out %d, drift %.0f ppm, jitter %.1f ms, hw %.1f ms\n",
+           rate, inN, outN, ppm, jitterMs, hwMs);
+    printf("measured latency: avg %.2f ms, min %.2f, max %.2f (%d pulses)\n",
+           latCnt ? latSum / latCnt : 0, latCnt ? latMin : 0, latMax, latCnt);
+    printf("reported latency: avg %.2f ms (in %.2f + proc %.3f + buf %.2f + out %.2f)\n",
+           repCnt ? repSum / repCnt : 0, st.inputMs, st.processMs, st.bufferMs, st.outputMs);
+    printf("cushion %d frames, underruns %lld, dropped %lld frames\n",
+           st.cushion, (long long)st.underrunCnt, (long long)st.dropFrames);
+    ksy_monitor_destroy(mon);
+    free(in);
+    free(out);
+    return 0;
+}
@@ -0,0 +1,443 @@
+//
+//  pcmbench.c
+//  pcmbench
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+//  离线测试解码PCM的磁盘缓存 (KSYAudioPcmCache) (可以在Linux/macOS上直接编译)
+//
+//  编译 (在本目录下):
+//    cc -O2 -std=gnu11 -Wno-deprecated -I../fxbench/compat -I../../KSYLiveDemo/KSYAudioUtils -x c \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioPcmCache.m \
+//       pcmbench.c -o pcmbench -lpthread
+//
+//  用法:
+//    pcmbench [选项] [a.wav b.wav ...]
+//      -c dir      缓存目录 (默认在/tmp下新建, 结束时删除)
+//      -m 200      缓存大小预算 (MB)
+//      -d 0        "解码"每秒音频的额外耗时 (毫秒, 模拟mp3/aac的解码)
+//    不给出文件时使用合成数据检查:
+//      1. 存入后内存映射读出, 数据逐帧一致; 内容相同的另一路径命中, 内容改变后不命中
+//      2. 截断的缓存文件被识别为损坏并删除
+//      3. 超出预算时按最近使用时间淘汰 (最近命中过的保留)
+//      4. 缓存被删除后, 已映射的数据仍然有效
+//    给出wav文件 (16位PCM) 时: 先解码并存入缓存, 再从缓存读取,
+//      报告解码存入的耗时, 以及从缓存得到第一块数据和读完整个文件的耗时
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <limits.h>
+#include "KSYAudioPcmCache.h"
+
+#define RATE    44100
+#define BLOCK   1024
+
+static double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+}
+
+static double s_costMs = 0; // 每秒音频的额外解码耗时
+
+static void burn(double ms) {
+    double end = nowMs() + ms;
+    while (nowMs() < end) {
+    }
+}
+
+static uint32_t s_seed = 1;
+
+static uint32_t rnd(void) {
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return s_seed >> 8;
+}
+
+static BOOL writeFile(const char* path, const uint8_t* data, size_t len) {
+    FILE* fp = fopen(path, "wb");
+    if (fp == NULL) {
+        return NO;
+    }
+    BOOL bOk = fwrite(data, 1, len, fp) == len;
+    return (fclose(fp) == 0) && bOk;
+}
+
+// 合成的"压缩文件": 随机内容, 不同的 seed 内容不同
+static BOOL makeSrc(const char* path, uint32_t seed, size_t len) {
+    uint8_t* data = malloc(len);
+    s_seed = seed;
+    for (size_t i = 0; i < len; ++i) {
+        data[i] = (uint8_t)rnd();
+    }
+    BOOL bOk = writeFile(path, data, len);
+    free(data);
+    return bOk;
+}
+
+static int16_t synSample(int64_t i, int id) {
+    return (int16_t)((i * 7 + id * 1000) & 0x7fff);
+}
+
+static BOOL storeSyn(KSYPcmCache* cache, const char* src, int64_t nbFrame, int id) {
+    KSYPcmWriter* w = ksy_pcm_cache_begin(cache, src);
+    int16_t buf[BLOCK];
+    for (int64_t pos = 0; w && pos < nbFrame; pos += BLOCK) {
+        int n = (int)(nbFrame - pos < BLOCK ? nbFrame - pos : BLOCK);
+        for (int i = 0; i < n; ++i) {
+            buf[i] = synSample(pos + i, id);
+        }
+        if (!ksy_pcm_writer_write(w, buf, n)) {
+            ksy_pcm_writer_abort(w);
+            return NO;
+        }
+    }
+    return ksy_pcm_writer_commit(w);
+}
+
+// 返回不一致的帧数, 没有缓存时返回 -1
+static int64_t verify(KSYPcmCache* cache, const char* src, int64_t nbFrame, int id) {
+    KSYPcmMap* map = ksy_pcm_cache_open(cache, src);
+    if (map == NULL) {
+        return -1;
+    }
+    int64_t bad = map->nbFrame != nbFrame ? 1 : 0;
+    for (int64_t i = 0; i < map->nbFrame && i < nbFrame; ++i) {
+        bad += map->pcm[i] != synSample(i, id);
+    }
+    ksy_pcm_map_release(map);
+    return bad;
+}
+
+static void entryName(KSYPcmCache* cache, const char* dir, const char* src, char* path) {
+    uint64_t key = 0;
+    ksy_pcm_cache_key(cache, src, &key);
+    snprintf(path, PATH_MAX, "%s/%016llx-%d-1.pcm", dir, (unsigned long long)key, RATE);
+}
+
+#pragma mark - synthetic tests
+static int testBasic(const char* dir) {
+    KSYPcmCache* cache = ksy_pcm_cache_create(dir, RATE, 1, 64 << 20);
+    char a[PATH_MAX], b[PATH_MAX];
+    snprintf(a, sizeof(a), "%s/src_a.mp3", dir);
+    snprintf(b, sizeof(b), "%s/src_b.mp3", dir);
+    makeSrc(a, 11, 300000);
+    makeSrc(b, 11, 300000); // 内容相同, 路径不同
+    int64_t len = RATE * 3 + 17;
+    int fail = 0;
+    if (verify(cache, a, len, 0) != -1) {
+        fail |= 1; // 存入之前不应命中
+    }
+    double t0 = nowMs();
+    BOOL bStored = storeSyn(cache, a, len, 0);
+    double t1 = nowMs();
+    int64_t badA = verify(cache, a, len, 0);
+    double t2 = nowMs();
+    int64_t badB = verify(cache, b, len, 0);
+    double t3 = nowMs();
+    fail |= !bStored || badA != 0 || badB != 0;
+    // 修改一个字节 (大小不变), 不应再命中
+    FILE* fp = fopen(a, "r+b");
+    fseek(fp, 1234, SEEK_SET);
+    fputc(0x5a ^ fgetc(fp), fp);
+    fclose(fp);
+    usleep(20000);
+    fp = fopen(a, "ab"); // 确保修改时间变化
+    fclose(fp);
+    int64_t badMod = verify(cache, a, len, 0);
+    fail |= badMod != -1;
+    KSYPcmCacheStat st;
+    ksy_pcm_cache_get_stat(cache, &st);
+    printf("basic: store %lld frames %.2f ms, open+verify %.2f ms, same content other path %s (%.2f ms), "
+           "modified source %s, hit %lld miss %lld -> %s\n",
+           (long long)len, t1 - t0, t2 - t1, badB == 0 ? "hit" : "MISS", t3 - t2,
+           badMod == -1 ? "miss" : "HIT", (long long)st.hitCnt, (long long)st.missCnt,
+           fail ? "FAIL" : "ok");
+    ksy_pcm_cache_destroy(cache);
+    return fail;
+}
+
+static int testCorrupt(const char* dir) {
+    KSYPcmCache* cache = ksy_pcm_cache_create(dir, RATE, 1, 64 << 20);
+    char src[PATH_MAX], entry[PATH_MAX];
+    snprintf(src, sizeof(src), "%s/src_c.mp3", dir);
+    makeSrc(src, 22, 100000);
+    storeSyn(cache, src, RATE, 3);
+    entryName(cache, dir, src, entry);
+    int fail = verify(cache, src, RATE, 3) != 0;
+    if (truncate(entry, 32 + RATE) != 0) { // 只剩一半数据
+        fail = 1;
+    }
+    fail |= verify(cache, src, RATE, 3) != -1;
+    BOOL bRemoved = access(entry, F_OK) != 0;
+    fail |= !bRemoved;
+    // 写入了0帧的缓存不被接受
+    KSYPcmWriter* w = ksy_pcm_cache_begin(cache, src);
+    BOOL bEmpty = ksy_pcm_writer_commit(w);
+    fail |= bEmpty;
+    printf("corrupt: truncated entry %s, empty commit %s -> %s\n",
+           bRemoved ? "rejected and removed" : "KEPT", bEmpty ? "ACCEPTED" : "rejected",
+           fail ? "FAIL" : "ok");
+    ksy_pcm_cache_destroy(cache);
+    return fail;
+}
+
+static int testLru(const char* dir) {
+    int64_t len   = RATE * 2;
+    int64_t entry = 32 + len * 2;
+    KSYPcmCache* cache = ksy_pcm_cache_create(dir, RATE, 1, 0);
+    ksy_pcm_cache_clear(cache);
+    ksy_pcm_cache_set_budget(cache, entry * 3 + entry / 2); // 可以放3个
+    char src[5][PATH_MAX];
+    for (int i = 0; i < 5; ++i) {
+        snprintf(src[i], PATH_MAX, "%s/lru_%d.m4a", dir, i);
+        makeSrc(src[i], 100 + i, 50000);
+    }
+    int fail = 0;
+    for (int i = 0; i < 3; ++i) {
+        fail |= !storeSyn(cache, src[i], len, i);
+        usleep(20000);
+    }
+    fail |= verify(cache, src[0], len, 0) != 0; // 命中, 0 变为最近使用
+    usleep(20000);
+    fail |= !storeSyn(cache, src[3], len, 3);   // 淘汰 1
+    usleep(20000);
+    BOOL bKeep0  = verify(cache, src[0], len, 0) == 0;
+    BOOL bEvict1 = verify(cache, src[1], len, 1) == -1;
+    usleep(20000);
+    fail |= !storeSyn(cache, src[4], len, 4);   // 淘汰 2 (0 刚被命中)
+    BOOL bEvict2 = verify(cache, src[2], len, 2) == -1;
+    BOOL bKeep34 = verify(cache, src[3], len, 3) == 0 && verify(cache, src[4], len, 4) == 0;
+    bKeep0 = bKeep0 && verify(cache, src[0], len, 0) == 0;
+    KSYPcmCacheStat st;
+    ksy_pcm_cache_get_stat(cache, &st);
+    fail |= !bKeep0 || !bEvict1 || !bEvict2 || !bKeep34 || st.bytes > st.budget;
+    // 单个就超出预算的不接受; 预算减小时立即淘汰
+    ksy_pcm_cache_set_budget(cache, entry - 1);
+    KSYPcmCacheStat st2;
+    ksy_pcm_cache_get_stat(cache, &st2);
+    BOOL bBig = storeSyn(cache, src[1], len, 1);
+    fail |= st2.nbEntry != 0 || bBig;
+    printf("lru: budget %lld bytes (3 entries): recently hit kept %s, oldest evicted %s/%s, "
+           "newest kept %s, %d entries %lld bytes, %lld evicted; shrink -> %d entries, "
+           "oversized store %s -> %s\n",
+           (long long)st.budget, bKeep0 ? "yes" : "NO", bEvict1 ? "yes" : "NO",
+           bEvict2 ? "yes" : "NO", bKeep34 ? "yes" : "NO", st.nbEntry, (long long)st.bytes,
+           (long long)st.evictCnt, st2.nbEntry, bBig ? "ACCEPTED" : "rejected",
+           fail ? "FAIL" : "ok");
+    ksy_pcm_cache_destroy(cache);
+    return fail;
+}
+
+static int testMappedAfterEvict(const char* dir) {
+    KSYPcmCache* cache = ksy_pcm_cache_create(dir, RATE, 1, 64 << 20);
+    char src[PATH_MAX];
+    snprintf(src, sizeof(src), "%s/src_e.aac", dir);
+    makeSrc(src, 33, 80000);
+    int64_t len = RATE * 4;
+    storeSyn(cache, src, len, 7);
+    KSYPcmMap* map = ksy_pcm_cache_open(cache, src);
+    ksy_pcm_cache_clear(cache);
+    int64_t bad = map ? 0 : 1;
+    for (int64_t i = 0; map && i < map->nbFrame; ++i) {
+        bad += map->pcm[i] != synSample(i, 7);
+    }
+    ksy_pcm_map_release(map);
+    BOOL bGone = ksy_pcm_cache_open(cache, src) == NULL;
+    int fail = bad != 0 || !bGone;
+    printf("mapped after clear: %lld bad frames, entry gone %s -> %s\n",
+           (long long)bad, bGone ? "yes" : "NO", fail ? "FAIL" : "ok");
+    ksy_pcm_cache_destroy(cache);
+    return fail;
+}
+
+#pragma mark - wav files
+static int16_t* loadWav(const char* path, int* rate, int64_t* nbFrame) {
+    FILE* fp = fopen(path, "rb");
+    uint8_t hdr[12], ck[8];
+    int ch = 0, bits = 0;
+    int16_t* pcm = NULL;
+    if (fp == NULL) {
+        return NULL;
+    }
+    if (fread(hdr, 1, 12, fp) == 12 && memcmp(hdr, "RIFF", 4) == 0 &&
+        memcmp(hdr + 8, "WAVE", 4) == 0) {
+        while (fread(ck, 1, 8, fp) == 8) {
+            uint32_t sz = ck[4] | ck[5] << 8 | ck[6] << 16 | (uint32_t)ck[7] << 24;
+            if (memcmp(ck, "fmt ", 4) == 0) {
+                uint8_t f[16];
+                if (sz < 16 || fread(f, 1, 16, fp) != 16) {
+                    break;
+                }
+                ch    = f[2] | f[3] << 8;
+                *rate = f[4] | f[5] << 8 | f[6] << 16 | f[7] << 24;
+                bits  = f[14] | f[15] << 8;
+                fseek(fp, sz - 16 + (sz & 1), SEEK_CUR);
+            }
+            else if (memcmp(ck, "data", 4) == 0) {
+                if (bits != 16 || ch <= 0) {
+                    break;
+                }
+                int64_t n = sz / (2 * ch);
+                int16_t* raw = malloc(sizeof(int16_t) * n * ch);
+                pcm = malloc(sizeof(int16_t) * n);
+                if (raw && pcm && fread(raw, sizeof(int16_t) * ch, n, fp) == (size_t)n) {
+                    for (int64_t i = 0; i < n; ++i) { // 混音器的格式为单声道
+                        int sum = 0;
+                        for (int c = 0; c < ch; ++c) {
+                            sum += raw[i*ch + c];
+                        }
+                        pcm[i] = (int16_t)(sum / ch);
+                    }
+                    *nbFrame = n;
+                }
+                else {
+                    free(pcm);
+                    pcm = NULL;
+                }
+                free(raw);
+                break;
+            }
+            else {
+                fseek(fp, sz + (sz & 1), SEEK_CUR);
+            }
+        }
+    }
+    fclose(fp);
+    return pcm;
+}
+
+static int playFiles(int argc, char** argv, int first, const char* dir, int64_t budget) {
+    int rate = 0;
+    int64_t nb = 0;
+    int16_t* probe = loadWav(argv[first], &rate, &nb);
+    if (probe == NULL) {
+        fprintf(stderr, "not a 16 bit PCM wav: %s\n", argv[first]);
+        return 1;
+    }
+    free(probe);
+    KSYPcmCache* cache = ksy_pcm_cache_create(dir, rate, 1, budget);
+    if (cache == NULL) {
+        fprintf(stderr, "can not create cache in %s\n", dir);
+        return 1;
+    }
+    printf("rate %d mono, budget %lld MB, decode cost %.1f ms/s\n",
+           rate, (long long)(budget >> 20), s_costMs);
+    int fail = 0;
+    for (int i = first; i < argc; ++i) {
+        // 1. 未缓存: 解码 (读取wav) 后才能得到数据, 同时存入缓存
+        int fileRate = 0;
+        int64_t len = 0;
+        double t0 = nowMs();
+        int16_t* pcm = loadWav(argv[i], &fileRate, &len);
+        if (pcm == NULL || fileRate != rate) {
+            fprintf(stderr, "skip %s (not 16 bit PCM at %d Hz)\n", argv[i], rate);
+            free(pcm);
+            continue;
+        }
+        burn(s_costMs * len / rate);
+        BOOL bStored = NO;
+        KSYPcmWriter* w = ksy_pcm_cache_begin(cache, argv[i]);
+        if (w && ksy_pcm_writer_write(w, pcm, (int)len)) {
+            bStored = ksy_pcm_writer_commit(w);
+        }
+        else {
+            ksy_pcm_writer_abort(w);
+        }
+        double tDec = nowMs() - t0;
+        // 2. 已缓存: 内存映射后直接读取
+        double t1 = nowMs();
+        KSYPcmMap* map = ksy_pcm_cache_open(cache, argv[i]);
+        double tOpen = nowMs() - t1;
+        int64_t bad = map ? 0 : 1;
+        double tFirst = 0;
+        for (int64_t pos = 0; map && pos < map->nbFrame; pos += BLOCK) {
+            int n = (int)(map->nbFrame - pos < BLOCK ? map->nbFrame - pos : BLOCK);
+            for (int k = 0; k < n; ++k) {
+                bad += map->pcm[pos + k] != pcm[pos + k];
+            }
+            if (pos == 0) {
+                tFirst = nowMs() - t1;
+            }
+        }
+        double tRead = nowMs() - t1;
+        fail |= !bStored || bad != 0;
+        printf("%s: %.1f s, decode+store %.2f ms, cached: open %.3f ms, "
+               "first block %.3f ms, read all %.2f ms, %s\n",
+               argv[i], (double)len / rate, tDec, tOpen, tFirst, tRead,
+               bad ? "MISMATCH" : "identical");
+        ksy_pcm_map_release(map);
+        free(pcm);
+    }
+    KSYPcmCacheStat st;
+    ksy_pcm_cache_get_stat(cache, &st);
+    printf("cache: %d entries, %.1f MB, hit %lld miss %lld evicted %lld\n",
+           st.nbEntry, st.bytes / 1048576.0, (long long)st.hitCnt,
+           (long long)st.missCnt, (long long)st.evictCnt);
+    ksy_pcm_cache_destroy(cache);
+    return fail;
+}
+
+static void removeDir(const char* dir) {
+    DIR* d = opendir(dir);
+    struct dirent* de;
+    char path[PATH_MAX];
+    while (d && (de = readdir(d)) != NULL) {
+        if (strcmp(de->d_name, ".") && strcmp(de->d_name, "..")) {
+            snprintf(path, sizeof(path), "%s/%s", dir, de->d_name);
+            unlink(path);
+        }
+    }
+    if (d) {
+        closedir(d);
+    }
+    rmdir(dir);
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: pcmbench [-c cacheDir] [-m budgetMB] [-d decodeCostMs] [a.wav ...]\n");
+}
+
+int main(int argc, char** argv) {
+    const char* dir = NULL;
+    int64_t budgetMB = 200;
+    int a = 1;
+    for (; a < argc && argv[a][0] == '-'; ++a) {
+        const char * opt = argv[a];
+        if (a + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const char * val = argv[++a];
+        if (strcmp(opt, "-c") == 0)      { dir      = val; }
+        else if (strcmp(opt, "-m") == 0) { budgetMB = atoll(val); }
+        else if (strcmp(opt, "-d") == 0) { s_costMs = atof(val); }
+        else {
+            usage();
+            return 1;
+        }
+    }
+    char tmp[] = "/tmp/pcmbenchXXXXXX";
+    if (dir == NULL && (dir = mkdtemp(tmp)) == NULL) {
+        fprintf(stderr, "can not create temp dir\n");
+        return 1;
+    }
+    int fail = 0;
+    if (a < argc) {
+        fail = playFiles(argc, argv, a, dir, budgetMB << 20);
+    }
+    else {
+        fail |= testBasic(dir);
+        fail |= testCorrupt(dir);
+        fail |= testLru(dir);
+        fail |= testMappedAfterEvict(dir);
+    }
+    if (dir == tmp) {
+        removeDir(dir);
+    }
+    return fail;
+}
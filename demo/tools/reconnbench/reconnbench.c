@@ -0,0 +1,537 @@
+//
+//  reconnbench.c
+//  reconnbench
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+//  用本地的TCP服务测试断线重连的部件 (KSYReconnect), 也可以作为可控断线的代理放在本地RTMP服务前面
+//  (可以在Linux/macOS上直接编译)
+//
+//  编译 (在本目录下):
+//    cc -O2 -std=gnu11 -Wno-deprecated -I../fxbench/compat -I../../KSYLiveDemo/KSYNetUtils -x c \
+//       ../../KSYLiveDemo/KSYNetUtils/KSYReconnect.m \
+//       reconnbench.c -o reconnbench -lm -lpthread
+//
+//  用法:
+//    reconnbench [-p 19350]    运行检查 (使用 127.0.0.2~127.0.0.4 上的端口 p)
+//      1. 地址缓存: 解析 localhost, 推流成功的地址排在最前, 过期后只在允许时返回, 解析失败保留原有的缓存
+//      2. 并行连接: 不响应/拒绝/正常的地址混在一起时, 很快连上正常的地址; 都失败时立即返回; 不响应时按超时返回
+//      3. 重连策略: 等待时间指数增长并有上限, 抖动在范围内, 连接稳定后复位, 连上后很快断开时继续退避, 超过次数放弃
+//      4. 断线重连: 服务端主动断开所有连接/暂停服务一段时间, 客户端按策略探测和重连, 统计中断时间
+//    reconnbench -proxy 19350 127.0.0.1:1935
+//      在19350端口转发到本地的RTMP服务 (如 nginx-rtmp/SRS), 推流地址改为 rtmp://<本机IP>:19350/app/stream,
+//      从标准输入读取命令: d 断开所有连接  p 暂停服务 (拒绝新连接)  r 恢复服务  q 退出
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "KSYReconnect.h"
+
+#define MAX_CONN    32
+
+static double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void sleepMs(double ms) {
+    if (ms > 0) {
+        usleep((useconds_t)(ms * 1000));
+    }
+}
+
+static int listenOn(const char* ip, int port, int backlog) {
+    struct sockaddr_in addr;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int on = 1;
+    if (fd < 0) {
+        return -1;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(port);
+    inet_pton(AF_INET, ip, &addr.sin_addr);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) || listen(fd, backlog)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+#pragma mark - server / proxy
+/// 可控的TCP服务: 接受连接后丢弃收到的数据, 或转发到 upstream
+typedef struct {
+    char        ip[KSY_IP_LEN];
+    int         port;
+    char        upIp[KSY_IP_LEN];   // 为空时不转发
+    int         upPort;
+    int         cmd[2];             // 命令管道: d/p/r/q
+    int         lfd;
+    int         cli[MAX_CONN];
+    int         up[MAX_CONN];
+    int         accepted;
+    pthread_t   tid;
+} Server;
+
+static int connectTo(const char* ip, int port) {
+    struct sockaddr_in addr;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(port);
+    inet_pton(AF_INET, ip, &addr.sin_addr);
+    if (fd >= 0 && connect(fd, (struct sockaddr*)&addr, sizeof(addr))) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+static void closeConn(Server* s, int i) {
+    close(s->cli[i]);
+    if (s->up[i] >= 0) {
+        close(s->up[i]);
+    }
+    s->cli[i] = s->up[i] = -1;
+}
+
+static void* serverLoop(void* arg) {
+    Server * s = arg;
+    char     buf[16384];
+    for (;;) {
+        struct pollfd pfd[2 + 2 * MAX_CONN];
+        int           who[2 + 2 * MAX_CONN]; // -1: 命令 -2: 监听 i: 客户端i i+MAX_CONN: 上游i
+        int           np = 0;
+        pfd[np].fd = s->cmd[0]; pfd[np].events = POLLIN; who[np++] = -1;
+        if (s->lfd >= 0) {
+            pfd[np].fd = s->lfd; pfd[np].events = POLLIN; who[np++] = -2;
+        }
+        for (int i = 0; i < MAX_CONN; ++i) {
+            if (s->cli[i] >= 0) {
+                pfd[np].fd = s->cli[i]; pfd[np].events = POLLIN; who[np++] = i;
+            }
+            if (s->up[i] >= 0) {
+                pfd[np].fd = s->up[i]; pfd[np].events = POLLIN; who[np++] = i + MAX_CONN;
+            }
+        }
+        if (poll(pfd, np, -1) <= 0) {
+            continue;
+        }
+        for (int k = 0; k < np; ++k) {
+            if (pfd[k].revents == 0) {
+                continue;
+            }
+            if (who[k] == -1) {
+                char c = 'q';
+                if (read(s->cmd[0], &c, 1) != 1 || c == 'q') {
+                    for (int i = 0; i < MAX_CONN; ++i) {
+                        if (s->cli[i] >= 0) {
+                            closeConn(s, i);
+                        }
+                    }
+                    if (s->lfd >= 0) {
+                        close(s->lfd);
+                    }
+                    return NULL;
+                }
+                if (c == 'd') {
+                    for (int i = 0; i < MAX_CONN; ++i) {
+                        if (s->cli[i] >= 0) {
+                            closeConn(s, i);
+                        }
+                    }
+                }
+                else if (c == 'p' && s->lfd >= 0) {
+                    close(s->lfd);
+                    s->lfd = -1;
+                }
+                else if (c == 'r' && s->lfd < 0) {
+                    s->lfd = listenOn(s->ip, s->port, 16);
+                }
+                break; // 连接列表可能已变化
+            }
+            if (who[k] == -2) {
+                int fd = accept(s->lfd, NULL, NULL);
+                int i  = 0;
+                while (i < MAX_CONN && s->cli[i] >= 0) {
+                    ++i;
+                }
+                if (fd >= 0 && i < MAX_CONN) {
+                    s->cli[i] = fd;
+                    s->up[i]  = s->upIp[0] ? connectTo(s->upIp, s->upPort) : -1;
+                    s->accepted += 1;
+                    if (s->upIp[0] && s->up[i] < 0) {
+                        closeConn(s, i);
+                    }
+                }
+                else if (fd >= 0) {
+                    close(fd);
+                }
+                continue;
+            }
+            int  i    = who[k] % MAX_CONN;
+            BOOL bUp  = who[k] >= MAX_CONN;
+            int  from = bUp ? s->up[i] : s->cli[i];
+            int  to   = bUp ? s->cli[i] : s->up[i];
+            if (from < 0) {
+                continue;
+            }
+            ssize_t n = read(from, buf, sizeof(buf));
+            if (n <= 0 || (to >= 0 && write(to, buf, n) != n)) {
+                closeConn(s, i);
+            }
+        }
+    }
+}
+
+static int serverStart(Server* s, const char* ip, int port, const char* upIp, int upPort) {
+    memset(s, 0, sizeof(*s));
+    snprintf(s->ip, sizeof(s->ip), "%s", ip);
+    snprintf(s->upIp, sizeof(s->upIp), "%s", upIp ? upIp : "");
+    s->port   = port;
+    s->upPort = upPort;
+    for (int i = 0; i < MAX_CONN; ++i) {
+        s->cli[i] = s->up[i] = -1;
+    }
+    s->lfd = listenOn(ip, port, 16);
+    if (s->lfd < 0 || pipe(s->cmd)) {
+        return -1;
+    }
+    return pthread_create(&s->tid, NULL, serverLoop, s);
+}
+
+static void serverCmd(Server* s, char c) {
+    if (write(s->cmd[1], &c, 1) != 1) {
+        fprintf(stderr, "server command failed\n");
+    }
+}
+
+static void serverStop(Server* s) {
+    serverCmd(s, 'q');
+    pthread_join(s->tid, NULL);
+    close(s->cmd[0]);
+    close(s->cmd[1]);
+}
+
+/// 不响应的地址: 监听队列占满后新的SYN被丢弃, 连接一直等待
+static int s_hangFds[MAX_CONN];
+static int s_nbHang = 0;
+
+static BOOL makeHang(const char* ip, int port) {
+    int lfd = listenOn(ip, port, 0);
+    if (lfd < 0) {
+        return NO;
+    }
+    s_hangFds[s_nbHang++] = lfd;
+    while (s_nbHang < MAX_CONN) {
+        char  ips[1][KSY_IP_LEN];
+        float ms = 0;
+        snprintf(ips[0], KSY_IP_LEN, "%s", ip);
+        // 用阻塞的连接填满队列, 连不上时说明已经占满
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port   = htons(port);
+        inet_pton(AF_INET, ip, &addr.sin_addr);
+        connect(fd, (struct sockaddr*)&addr, sizeof(addr));
+        s_hangFds[s_nbHang++] = fd;
+        if (ksy_tcp_race((const char (*)[KSY_IP_LEN])ips, 1, port, 100, 0, &ms) < 0) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+#pragma mark - checks
+static int report(const char* name, BOOL bOk, const char* fmt, ...) __attribute__((format(printf, 3, 4)));
+static int report(const char* name, BOOL bOk, const char* fmt, ...) {
+    char    msg[256];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(msg, sizeof(msg), fmt, ap);
+    va_end(ap);
+    printf("%-10s %-64s -> %s\n", name, msg, bOk ? "ok" : "FAIL");
+    return bOk ? 0 : 1;
+}
+
+static int testCache(void) {
+    int             fail = 0;
+    char            ips[KSY_HOST_MAX_IP][KSY_IP_LEN];
+    KSYHostCache *  c = ksy_hostcache_create(1000);
+    int n = ksy_hostcache_resolve(c, "localhost", 0);
+    fail |= report("cache", n >= 1, "resolve localhost: %d", n);
+
+    ksy_hostcache_add(c, "live.example.com", "10.0.0.1", 0);
+    ksy_hostcache_add(c, "live.example.com", "10.0.0.2", 0);
+    ksy_hostcache_add(c, "live.example.com", "10.0.0.1", 500);   // 推流成功的地址排在最前
+    n = ksy_hostcache_get(c, "live.example.com", 600, NO, ips, KSY_HOST_MAX_IP);
+    fail |= report("cache", n == 2 && strcmp(ips[0], "10.0.0.1") == 0,
+                   "preferred first: %d %s", n, n ? ips[0] : "-");
+
+    n = ksy_hostcache_get(c, "live.example.com", 1200, NO, ips, KSY_HOST_MAX_IP);
+    int nStale = ksy_hostcache_get(c, "live.example.com", 1200, YES, ips, KSY_HOST_MAX_IP);
+    // 1200ms时 10.0.0.2 已过期, 10.0.0.1 在500ms刷新过
+    fail |= report("cache", n == 1 && nStale == 2 && strcmp(ips[0], "10.0.0.1") == 0,
+                   "expire: valid %d stale %d", n, nStale);
+
+    n = ksy_hostcache_resolve(c, "no-such-host.invalid", 2000);
+    nStale = ksy_hostcache_get(c, "live.example.com", 5000, YES, ips, KSY_HOST_MAX_IP);
+    fail |= report("cache", n < 0 && nStale == 2, "resolve failure keeps cache: %d %d", n, nStale);
+
+    // 重新解析: 之前用过的地址仍在结果中时保持在最前
+    ksy_hostcache_add(c, "localhost", "127.0.0.1", 3000);
+    n = ksy_hostcache_resolve(c, "localhost", 3000);
+    int nb = ksy_hostcache_get(c, "localhost", 3000, NO, ips, KSY_HOST_MAX_IP);
+    BOOL bHas127 = NO;
+    for (int i = 0; i < nb; ++i) {
+        bHas127 |= strcmp(ips[i], "127.0.0.1") == 0;
+    }
+    fail |= report("cache", nb >= 1 && (!bHas127 || strcmp(ips[0], "127.0.0.1") == 0),
+                   "re-resolve keeps preferred: %d %s", nb, nb ? ips[0] : "-");
+    ksy_hostcache_destroy(c);
+    return fail;
+}
+
+static int testRace(int port) {
+    int     fail = 0;
+    float   ms   = 0;
+    Server  ok;
+    char    ips[3][KSY_IP_LEN] = { "127.0.0.4", "127.0.0.2", "127.0.0.3" };
+    if (serverStart(&ok, "127.0.0.3", port, NULL, 0)) {
+        return report("race", NO, "listen on 127.0.0.3:%d failed", port);
+    }
+    BOOL bHang = makeHang("127.0.0.4", port);
+
+    // 不响应, 拒绝, 正常: 拒绝后立即尝试下一个
+    double t0  = nowMs();
+    int    win = ksy_tcp_race((const char (*)[KSY_IP_LEN])ips, 3, port, 3000, 250, &ms);
+    fail |= report("race", win == 2 && ms < 250 + 100,
+                   "hang/refused/ok -> #%d in %.0fms (stagger 250)", win, ms);
+
+    // 都拒绝
+    char refused[2][KSY_IP_LEN] = { "127.0.0.2", "127.0.0.5" };
+    t0  = nowMs();
+    win = ksy_tcp_race((const char (*)[KSY_IP_LEN])refused, 2, port, 3000, 250, &ms);
+    double dt = nowMs() - t0;
+    fail |= report("race", win < 0 && dt < 100, "all refused -> %d in %.0fms", win, dt);
+
+    // 只有不响应的地址: 按超时返回
+    if (bHang) {
+        t0  = nowMs();
+        win = ksy_tcp_race((const char (*)[KSY_IP_LEN])ips, 1, port, 500, 250, &ms);
+        dt  = nowMs() - t0;
+        fail |= report("race", win < 0 && dt >= 490 && dt < 700, "hang only -> %d in %.0fms (timeout 500)", win, dt);
+    }
+    else {
+        printf("%-10s %-64s -> skip\n", "race", "cannot make an unresponsive address here");
+    }
+    serverStop(&ok);
+    while (s_nbHang > 0) {
+        close(s_hangFds[--s_nbHang]);
+    }
+    return fail;
+}
+
+static int testPolicy(void) {
+    int                 fail = 0;
+    KSYReconnStat       st;
+    KSYReconnPolicy *   p = ksy_reconn_create(7);
+    // 连续失败: 300, 600, 1200, 2400, 4800, 8000(上限) ±20%
+    BOOL   bOk = YES;
+    double t   = 0;
+    char   list[128] = "";
+    for (int i = 0; i < 7; ++i) {
+        int   d   = ksy_reconn_on_failure(p, t);
+        float ref = fminf(300 * (float)(1 << i), 8000);
+        bOk &= d >= ref * 0.8f - 1 && d <= ref * 1.2f + 1;
+        snprintf(list + strlen(list), sizeof(list) - strlen(list), "%d ", d);
+        t += d;
+    }
+    fail |= report("policy", bOk, "backoff: %s", list);
+
+    ksy_reconn_on_connected(p, t);
+    ksy_reconn_get_stat(p, &st);
+    fail |= report("policy", st.successCnt == 1 && fabsf(st.lastOutageMs - (float)t) < 1,
+                   "outage %.0fms success %d", st.lastOutageMs, st.successCnt);
+
+    // 连上2秒又断开 (不稳定): 继续退避
+    int d = ksy_reconn_on_failure(p, t + 2000);
+    fail |= report("policy", d >= 8000 * 0.8f, "unstable connection keeps backoff: %d", d);
+
+    // 稳定15秒后断开: 复位
+    t += 2000 + d;
+    ksy_reconn_on_connected(p, t);
+    d = ksy_reconn_on_failure(p, t + 15000);
+    fail |= report("policy", d <= 300 * 1.2f + 1, "stable connection resets backoff: %d", d);
+
+    // 最多重试3次
+    ksy_reconn_reset(p);
+    ksy_reconn_set_param(p, KSYReconn_MaxRetry, 3);
+    int r[4];
+    for (int i = 0; i < 4; ++i) {
+        r[i] = ksy_reconn_on_failure(p, 0);
+    }
+    fail |= report("policy", r[2] > 0 && r[3] < 0, "max retry 3: %d %d %d %d", r[0], r[1], r[2], r[3]);
+    ksy_reconn_destroy(p);
+    return fail;
+}
+
+/// 客户端: 按重连策略探测和连接, 连接断开时重连, 运行 durMs; 按时间向服务端发命令
+typedef struct {
+    int     reconnects;
+    float   maxOutageMs;
+    float   sumOutageMs;
+    int     probes;
+} ClientResult;
+
+static void runClient(int port, double durMs, Server* srv, double dropAt, double pauseAt,
+                      double resumeAt, ClientResult* res) {
+    KSYReconnPolicy * p = ksy_reconn_create(3);
+    char   ips[2][KSY_IP_LEN] = { "127.0.0.2", "127.0.0.3" };  // 拒绝的地址在前
+    double t0 = nowMs(), nextTry = t0;
+    int    fd = -1;
+    BOOL   bDropped = NO, bPaused = NO, bResumed = NO;
+    memset(res, 0, sizeof(*res));
+    while (nowMs() - t0 < durMs) {
+        double t = nowMs() - t0;
+        if (!bDropped && dropAt >= 0 && t >= dropAt) {
+            serverCmd(srv, 'd');
+            bDropped = YES;
+        }
+        if (!bPaused && pauseAt >= 0 && t >= pauseAt) {
+            serverCmd(srv, 'p');
+            serverCmd(srv, 'd');
+            bPaused = YES;
+        }
+        if (!bResumed && resumeAt >= 0 && t >= resumeAt) {
+            serverCmd(srv, 'r');
+            bResumed = YES;
+        }
+        if (fd >= 0) {
+            // 已连接: 检查是否被断开
+            struct pollfd pfd = { fd, POLLIN, 0 };
+            char c;
+            if (poll(&pfd, 1, 10) > 0 && read(fd, &c, 1) <= 0) {
+                close(fd);
+                fd = -1;
+                nextTry = nowMs() + ksy_reconn_on_failure(p, nowMs());
+            }
+            continue;
+        }
+        if (nowMs() < nextTry) {
+            sleepMs(fmin(nextTry - nowMs(), 10));
+            continue;
+        }
+        float ms  = 0;
+        int   win = ksy_tcp_race((const char (*)[KSY_IP_LEN])ips, 2, port, 1000, 250, &ms);
+        res->probes += 1;
+        if (win >= 0) {
+            fd = connectTo(ips[win], port);
+        }
+        if (fd >= 0) {
+            KSYReconnStat st;
+            ksy_reconn_on_connected(p, nowMs());
+            ksy_reconn_get_stat(p, &st);
+            if (st.successCnt > res->reconnects) {
+                res->reconnects   = st.successCnt;
+                res->sumOutageMs += st.lastOutageMs;
+                res->maxOutageMs  = fmaxf(res->maxOutageMs, st.lastOutageMs);
+            }
+        }
+        else {
+            nextTry = nowMs() + ksy_reconn_on_failure(p, nowMs());
+        }
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    ksy_reconn_destroy(p);
+}
+
+static int testSession(int port) {
+    int          fail = 0;
+    Server       srv;
+    ClientResult r;
+    if (serverStart(&srv, "127.0.0.3", port, NULL, 0)) {
+        return report("session", NO, "listen on 127.0.0.3:%d failed", port);
+    }
+    // 服务端断开连接: 一次退避 (300ms±20%) 后连上
+    runClient(port, 1500, &srv, 500, -1, -1, &r);
+    fail |= report("session", r.reconnects == 1 && r.maxOutageMs < 300 * 1.2f + 100,
+                   "drop: reconnects %d outage %.0fms probes %d", r.reconnects, r.maxOutageMs, r.probes);
+
+    // 服务暂停2.5秒: 退避 300,600,1200,2400 -> 恢复后的下一次尝试连上
+    runClient(port, 7000, &srv, -1, 500, 3000, &r);
+    fail |= report("session", r.reconnects == 1 && r.maxOutageMs >= 2500 && r.maxOutageMs < 2500 + 2400 * 1.2f + 200,
+                   "pause 2.5s: reconnects %d outage %.0fms probes %d", r.reconnects, r.maxOutageMs, r.probes);
+    serverStop(&srv);
+    return fail;
+}
+
+#pragma mark - proxy
+static int runProxy(int port, const char* upstream) {
+    char upIp[KSY_IP_LEN];
+    int  upPort = 1935;
+    if (sscanf(upstream, "%63[^:]:%d", upIp, &upPort) < 1) {
+        fprintf(stderr, "bad upstream %s\n", upstream);
+        return 1;
+    }
+    Server srv;
+    if (serverStart(&srv, "0.0.0.0", port, upIp, upPort)) {
+        fprintf(stderr, "listen on %d failed\n", port);
+        return 1;
+    }
+    printf("proxy :%d -> %s:%d  (d: drop all, p: pause, r: resume, q: quit)\n", port, upIp, upPort);
+    int c;
+    while ((c = getchar()) != EOF && c != 'q') {
+        if (c == 'd' || c == 'p' || c == 'r') {
+            serverCmd(&srv, (char)c);
+            if (c == 'p') {
+                serverCmd(&srv, 'd');
+            }
+            printf("%c (accepted %d)\n", c, srv.accepted);
+        }
+    }
+    serverStop(&srv);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    int port = 19350;
+    for (int a = 1; a < argc; a += 2) {
+        if (strcmp(argv[a], "-proxy") == 0 && a + 2 < argc) {
+            return runProxy(atoi(argv[a+1]), argv[a+2]);
+        }
+        if (a + 1 >= argc) {
+            break;
+        }
+        if      (strcmp(argv[a], "-p") == 0) { port = atoi(argv[a+1]); }
+        else {
+            fprintf(stderr, "usage: reconnbench [-p port] | -proxy port upstreamIp:port\n");
+            return 1;
+        }
+    }
+    int fail = 0;
+    fail |= testCache();
+    fail |= testRace(port);
+    fail |= testPolicy();
+    fail |= testSession(port + 1);
+    return fail;
+}
@@ -0,0 +1,183 @@
+//
+//  resamplebench.c
+//  resamplebench
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+//  用正弦信号测试多相重采样 (KSYAudioResampler) 各质量档位的 THD+N 和速度 (可以在Linux/macOS上直接编译)
+//
+//  编译 (在本目录下):
+//    cc -O2 -std=gnu11 -Wno-deprecated -I../fxbench/compat -I../../KSYLiveDemo/KSYAudioUtils -x c \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioKernel.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioResampler.m \
+//       resamplebench.c -o resamplebench -lm -lpthread
+//
+//  用法:
+//    resamplebench [选项]
+//      -r 48000:44100  只测试这一组采样率 (默认测试 48000:44100, 22050:44100, 44100:48000)
+//      -t 1000         测试正弦的频率 (Hz)
+//      -b 1024         每次输入的帧数 (模拟回调的长度)
+//      -s 2            信号的长度 (秒)
+//      -n 10           计时的重复次数
+//      -C              强制使用C实现的基础运算
+//    THD+N: 用最小二乘拟合已知频率的正弦 (含直流), 残差能量与正弦能量之比
+//    检查: 1KHz 下 Low/Medium/High 的 THD+N 分别不高于 -60/-80/-100 dB (各组采样率中最差的是2倍升采样)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include "KSYAudioResampler.h"
+#include "KSYAudioKernel.h"
+
+#define SKIP_FRAMES 256  // 跳过开头的滤波器暂态
+
+static const char * s_qName[]  = { "low", "medium", "high" };
+static const double s_qLimit[] = { -60, -80, -100 };
+
+// 拟合已知频率的正弦(含直流), 残差能量与正弦能量之比即为 THD+N (dB)
+static double toneThdN(const float* y, int n, double freq, double rate) {
+    double s[3][4] = {{0}};
+    for (int i = 0; i < n; ++i) {
+        double v[3] = { sin(2*M_PI*freq*i/rate), cos(2*M_PI*freq*i/rate), 1.0 };
+        for (int a = 0; a < 3; ++a) {
+            for (int b = 0; b < 3; ++b) {
+                s[a][b] += v[a]*v[b];
+            }
+            s[a][3] += v[a]*y[i];
+        }
+    }
+    for (int k = 0; k < 3; ++k) { // 高斯消元
+        for (int r = k+1; r < 3; ++r) {
+            double m = s[r][k] / s[k][k];
+            for (int c = k; c < 4; ++c) {
+                s[r][c] -= m*s[k][c];
+            }
+        }
+    }
+    double x[3];
+    for (int k = 2; k >= 0; --k) {
+        double t = s[k][3];
+        for (int c = k+1; c < 3; ++c) {
+            t -= s[k][c]*x[c];
+        }
+        x[k] = t / s[k][k];
+    }
+    double pSig = 0, pErr = 0;
+    for (int i = 0; i < n; ++i) {
+        double m = x[0]*sin(2*M_PI*freq*i/rate) + x[1]*cos(2*M_PI*freq*i/rate) + x[2];
+        pSig += m*m;
+        pErr += (y[i]-m)*(y[i]-m);
+    }
+    return 10*log10(pErr / pSig);
+}
+
+static double nowSec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// 按 block 帧分段输入, 返回输出的帧数
+static int runOnce(KSYAudioResampler* rs, const float* in, int nbIn, int block,
+                   float* out, int maxOut) {
+    int nbOut = 0;
+    for (int off = 0; off < nbIn; off += block) {
+        int n = nbIn - off < block ? nbIn - off : block;
+        nbOut += ksy_resampler_process(rs, in + off, n, out + nbOut, maxOut - nbOut);
+    }
+    return nbOut;
+}
+
+static int testRates(int inRate, int outRate, double freq, int block, double sec, int repeat) {
+    int nbIn   = (int)(inRate * sec);
+    float * in = malloc(sizeof(float) * nbIn);
+    for (int i = 0; i < nbIn; ++i) {
+        in[i] = (float)(0.5 * sin(2*M_PI*freq*i/inRate));
+    }
+    int fail = 0;
+    for (int q = KSYResampleQuality_Low; q <= KSYResampleQuality_High; ++q) {
+        KSYAudioResampler * rs = ksy_resampler_create(inRate, outRate, 1, q);
+        if (rs == NULL) {
+            fprintf(stderr, "cannot create resampler %d->%d\n", inRate, outRate);
+            free(in);
+            return 1;
+        }
+        int maxOut  = ksy_resampler_max_out(rs, block) * (nbIn / block + 1);
+        float * out = malloc(sizeof(float) * maxOut);
+        int nbOut   = runOnce(rs, in, nbIn, block, out, maxOut);
+        double thd  = toneThdN(out + SKIP_FRAMES, nbOut - SKIP_FRAMES, freq, outRate);
+        double t0   = nowSec();
+        for (int r = 0; r < repeat; ++r) {
+            ksy_resampler_reset(rs);
+            runOnce(rs, in, nbIn, block, out, maxOut);
+        }
+        double dt = (nowSec() - t0) / repeat;
+        // 只对1KHz左右的测试信号做检查, 高频信号的 THD+N 受截止频率影响
+        BOOL bCheck = freq <= 1000;
+        BOOL bOk    = !bCheck || thd <= s_qLimit[q];
+        printf("  %5d->%-5d %-6s  THD+N %7.1f dB  %7.0fx realtime  out %d  %s\n",
+               inRate, outRate, s_qName[q], thd, sec / dt, nbOut,
+               bCheck ? (bOk ? "-> ok" : "-> FAIL") : "");
+        fail |= !bOk;
+        free(out);
+        ksy_resampler_destroy(rs);
+    }
+    free(in);
+    return fail;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: resamplebench [-r in:out] [-t freq] [-b block] [-s sec] [-n repeat] [-C]\n");
+}
+
+int main(int argc, char** argv) {
+    int rates[][2] = { {48000, 44100}, {22050, 44100}, {44100, 48000} };
+    int nbRates = 3;
+    double freq = 1000, sec = 2;
+    int block = 1024, repeat = 10;
+    BOOL bForceC = NO;
+    for (int a = 1; a < argc; ++a) {
+        if (strcmp(argv[a], "-C") == 0) {
+            bForceC = YES;
+            continue;
+        }
+        if (a + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const char * val = argv[++a];
+        if (strcmp(argv[a-1], "-r") == 0) {
+            if (sscanf(val, "%d:%d", &rates[0][0], &rates[0][1]) != 2) {
+                usage();
+                return 1;
+            }
+            nbRates = 1;
+        }
+        else if (strcmp(argv[a-1], "-t") == 0) { freq   = atof(val); }
+        else if (strcmp(argv[a-1], "-b") == 0) { block  = atoi(val); }
+        else if (strcmp(argv[a-1], "-s") == 0) { sec    = atof(val); }
+        else if (strcmp(argv[a-1], "-n") == 0) { repeat = atoi(val); }
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (block <= 0 || repeat <= 0 || sec <= 0.1 || freq <= 0) {
+        usage();
+        return 1;
+    }
+    ksy_audio_kernel_force_c(bForceC);
+    printf("%.0f Hz tone, %.1f s, block %d, kernel %s\n", freq, sec, block, ksy_audio_kernel_name());
+    int fail = 0;
+    for (int r = 0; r < nbRates; ++r) {
+        if (rates[r][0] <= 0 || rates[r][1] <= 0 || freq * 2 >= rates[r][0] || freq * 2 >= rates[r][1]) {
+            fprintf(stderr, "tone %.0f Hz is above nyquist for %d->%d\n", freq, rates[r][0], rates[r][1]);
+            return 1;
+        }
+        fail |= testRates(rates[r][0], rates[r][1], freq, block, sec, repeat);
+    }
+    return fail;
+}
@@ -0,0 +1,231 @@
+//
+//  ringbench.c
+//  ringbench
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+//  KSYAudioRing 的多线程压力测试: 一个生产者线程和一个消费者线程以随机长度读写 (可以在Linux/macOS上直接编译)
+//
+//  编译 (在本目录下):
+//    cc -O2 -std=gnu11 -Wno-deprecated -I../fxbench/compat -I../../KSYLiveDemo/KSYAudioUtils -x c \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioRing.m \
+//       ringbench.c -o ringbench -lpthread
+//  用 ThreadSanitizer 检查数据竞争:
+//    cc -O1 -g -fsanitize=thread -std=gnu11 -Wno-deprecated -I../fxbench/compat \
+//       -I../../KSYLiveDemo/KSYAudioUtils -x c \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioRing.m \
+//       ringbench.c -o ringbench_tsan -lpthread
+//
+//  用法:
+//    ringbench [选项]
+//      -n 20000000 传输的总帧数
+//      -c 4096     环形缓冲的容量 (帧)
+//      -f 4        每帧的字节数 (4的倍数, 如双声道S16为4)
+//      -w 1024     每次写入的最大帧数 (1~w 随机)
+//      -r 1024     每次读取的最大帧数 (1~r 随机)
+//      -s 1        随机数种子
+//    生产者写满时把没写进去的部分留到下次重写, 所以数据不丢失, 消费者收到的帧序号必须连续
+//    检查:
+//      1. 每帧的内容与序号一致 (没有撕裂/重复/丢失)
+//      2. 统计的 overrunFrames / underrunCnt 与两端各自记录的一致
+//      3. highWater 不超过容量且不小于消费者看到的最大长度, 结束时读写的总帧数相等
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include "KSYAudioRing.h"
+
+#define WORD_MUL    0x9E3779B9u
+
+typedef struct {
+    KSYAudioRing *  ring;
+    int64_t         total;
+    int             frameSize;
+    int             maxWrite;
+    int             maxRead;
+    uint32_t        seed;
+    // 生产者记录
+    int64_t         rejected;   // 写满时没写进去的帧数 (之后重写)
+    int64_t         nbWrite;
+    // 消费者记录
+    int64_t         shortReads; // 读到的帧数少于请求的次数
+    int64_t         nbRead;
+    int64_t         badFrames;
+    int64_t         firstBad;
+    int             maxFill;
+} Bench;
+
+static uint32_t rnd(uint32_t* s) {
+    *s = *s * 1664525u + 1013904223u;
+    return *s >> 8;
+}
+
+static void fillFrame(uint8_t* p, int frameSize, int64_t seq) {
+    uint32_t * w = (uint32_t*)p;
+    for (int j = 0; j < frameSize / 4; ++j) {
+        w[j] = (uint32_t)seq + j * WORD_MUL;
+    }
+}
+
+static BOOL checkFrame(const uint8_t* p, int frameSize, int64_t seq) {
+    const uint32_t * w = (const uint32_t*)p;
+    for (int j = 0; j < frameSize / 4; ++j) {
+        if (w[j] != (uint32_t)seq + j * WORD_MUL) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+// 偶尔让出CPU, 使两端的速度交替领先, 覆盖写满和读空两种情况
+static void jitter(uint32_t* s) {
+    uint32_t r = rnd(s) & 1023;
+    if (r < 8) {
+        sched_yield();
+    }
+    else if (r < 10) {
+        struct timespec ts = { 0, 50000 };
+        nanosleep(&ts, NULL);
+    }
+}
+
+static void* producer(void* arg) {
+    Bench * b = arg;
+    uint32_t s = b->seed;
+    uint8_t * chunk = malloc((size_t)b->maxWrite * b->frameSize);
+    int64_t seq = 0;
+    while (seq < b->total) {
+        int n = 1 + (int)(rnd(&s) % b->maxWrite);
+        if (n > b->total - seq) {
+            n = (int)(b->total - seq);
+        }
+        for (int i = 0; i < n; ++i) {
+            fillFrame(chunk + (size_t)i * b->frameSize, b->frameSize, seq + i);
+        }
+        int w = ksy_ring_write(b->ring, chunk, n);
+        b->rejected += n - w;
+        b->nbWrite  += 1;
+        seq += w;
+        jitter(&s);
+    }
+    free(chunk);
+    return NULL;
+}
+
+static void* consumer(void* arg) {
+    Bench * b = arg;
+    uint32_t s = b->seed * 7 + 3;
+    uint8_t * chunk = malloc((size_t)b->maxRead * b->frameSize);
+    int64_t seq = 0;
+    b->firstBad = -1;
+    while (seq < b->total) {
+        int fill = ksy_ring_fill(b->ring);
+        b->maxFill = fill > b->maxFill ? fill : b->maxFill;
+        int n = 1 + (int)(rnd(&s) % b->maxRead);
+        int r = ksy_ring_read(b->ring, chunk, n);
+        b->shortReads += r < n;
+        b->nbRead     += 1;
+        for (int i = 0; i < r; ++i) {
+            if (!checkFrame(chunk + (size_t)i * b->frameSize, b->frameSize, seq + i)) {
+                b->badFrames += 1;
+                if (b->firstBad < 0) {
+                    b->firstBad = seq + i;
+                }
+            }
+        }
+        seq += r;
+        jitter(&s);
+    }
+    free(chunk);
+    return NULL;
+}
+
+static double nowSec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int report(const char* name, const char* note, BOOL bOk) {
+    printf("  %-10s %-48s -> %s\n", name, note, bOk ? "ok" : "FAIL");
+    return bOk ? 0 : 1;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: ringbench [-n frames] [-c capacity] [-f frameSize] "
+                    "[-w maxWrite] [-r maxRead] [-s seed]\n");
+}
+
+int main(int argc, char** argv) {
+    Bench b;
+    memset(&b, 0, sizeof(b));
+    b.total     = 20000000;
+    b.frameSize = 4;
+    b.maxWrite  = 1024;
+    b.maxRead   = 1024;
+    b.seed      = 1;
+    int capacity = 4096;
+    for (int a = 1; a < argc; a += 2) {
+        if (a + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        if      (strcmp(argv[a], "-n") == 0) { b.total     = atoll(argv[a+1]); }
+        else if (strcmp(argv[a], "-c") == 0) { capacity    = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-f") == 0) { b.frameSize = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-w") == 0) { b.maxWrite  = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-r") == 0) { b.maxRead   = atoi(argv[a+1]); }
+        else if (strcmp(argv[a], "-s") == 0) { b.seed      = (uint32_t)atoi(argv[a+1]); }
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (b.total <= 0 || b.frameSize <= 0 || b.frameSize % 4 || b.maxWrite <= 0 || b.maxRead <= 0) {
+        usage();
+        return 1;
+    }
+    b.ring = ksy_ring_create(capacity, b.frameSize);
+    if (b.ring == NULL) {
+        fprintf(stderr, "invalid capacity %d\n", capacity);
+        return 1;
+    }
+    pthread_t tp, tc;
+    double t0 = nowSec();
+    pthread_create(&tc, NULL, consumer, &b);
+    pthread_create(&tp, NULL, producer, &b);
+    pthread_join(tp, NULL);
+    pthread_join(tc, NULL);
+    double dt = nowSec() - t0;
+
+    KSYAudioRingStat st;
+    ksy_ring_get_stat(b.ring, &st);
+    printf("%lld frames x %d bytes, capacity %d, chunks 1~%d / 1~%d: %.2f s, %.1f M frames/s\n",
+           (long long)b.total, b.frameSize, st.capacity, b.maxWrite, b.maxRead,
+           dt, b.total / dt / 1e6);
+    printf("  writes %lld, reads %lld\n", (long long)b.nbWrite, (long long)b.nbRead);
+    char note[128];
+    int fail = 0;
+    snprintf(note, sizeof(note), "bad frames %lld (first at %lld)",
+             (long long)b.badFrames, (long long)b.firstBad);
+    fail |= report("data", note, b.badFrames == 0);
+    snprintf(note, sizeof(note), "ring %lld, producer %lld frames",
+             (long long)st.overrunFrames, (long long)b.rejected);
+    fail |= report("overrun", note, st.overrunFrames == b.rejected);
+    snprintf(note, sizeof(note), "ring %lld, consumer %lld",
+             (long long)st.underrunCnt, (long long)b.shortReads);
+    fail |= report("underrun", note, st.underrunCnt == b.shortReads);
+    snprintf(note, sizeof(note), "%d (consumer saw %d, capacity %d)",
+             st.highWater, b.maxFill, st.capacity);
+    fail |= report("highwater", note, st.highWater <= st.capacity && st.highWater >= b.maxFill);
+    snprintf(note, sizeof(note), "written %lld, read %lld, fill %d",
+             (long long)st.writeFrames, (long long)st.readFrames, st.fill);
+    fail |= report("totals", note,
+                   st.writeFrames == b.total && st.readFrames == b.total && st.fill == 0);
+    ksy_ring_destroy(b.ring);
+    return fail;
+}
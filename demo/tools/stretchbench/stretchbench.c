@@ -0,0 +1,465 @@
+//
+//  stretchbench.c
+//  stretchbench
+//
+//  Created by ksyun on 10/17/26.
+//  Copyright © 2026 ksyun. All rights reserved.
+//
+//  离线测试变速/变调 (KSYAudioTimeStretch) 的质量和CPU占用 (可以在Linux/macOS上直接编译)
+//
+//  编译 (在本目录下):
+//    cc -O2 -std=gnu11 -Wno-deprecated -I../fxbench/compat -I../../KSYLiveDemo/KSYAudioUtils -x c \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioKernel.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioResampler.m \
+//       ../../KSYLiveDemo/KSYAudioUtils/KSYAudioTimeStretch.m \
+//       stretchbench.c -o stretchbench -lm -lpthread
+//
+//  用法:
+//    stretchbench [选项] [in.wav out.wav]
+//      -t 1.0      速度 (0.5~2.0)
+//      -p 0        音高 (半音, -12~12)
+//      -b 1024     每次取出的帧数 (模拟混音器的块长)
+//      -C          强制使用C实现的基础运算
+//    不给出文件时用合成信号检查:
+//      1. 互相关内核: SIMD与C实现的结果一致, 对比耗时
+//      2. 正弦波在各种速度/音高下: 输出长度符合速度, 频率符合音高, 信噪比 (按期望频率拟合后的残差)
+//      3. 连续性: 处理中途改变参数, 相邻样本的最大跳变不超过正弦波本身的最大斜率
+//      4. CPU: 44.1KHz立体声的合成音乐, 处理每秒音频的耗时
+//    给出文件时 (16位PCM的wav) 按 -t/-p 处理后写入 out.wav, 报告耗时
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "KSYAudioKernel.h"
+#include "KSYAudioTimeStretch.h"
+
+#define RATE 44100
+
+static double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+}
+
+static int s_block = 1024;
+static BOOL s_forceC = NO;
+
+#pragma mark - sources
+// 合成信号, 按帧序号生成, 可以任意长
+typedef struct {
+    int     ch;
+    int64_t pos;
+    int64_t len;
+    double  freq;   // >0: 正弦波; 0: 合成音乐
+    double  amp;
+    int64_t consumed;
+} SynSrc;
+
+static uint32_t s_seed = 1;
+
+static float noise(void) {
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return (float)((s_seed >> 8) * (1.0 / 8388608.0) - 1.0);
+}
+
+static int synRead(void* ctx, float* buf, int n) {
+    SynSrc * s = ctx;
+    if (n > s->len - s->pos) {
+        n = (int)(s->len - s->pos);
+    }
+    for (int i = 0; i < n; ++i) {
+        double t = (double)(s->pos + i) / RATE;
+        float  v;
+        if (s->freq > 0) {
+            v = (float)(s->amp * sin(2 * M_PI * s->freq * t));
+        }
+        else { // 和弦 + 拍子 + 噪声
+            double beat = fmod(t, 0.5) < 0.05 ? 1.0 : 0.3;
+            v = (float)(0.15 * sin(2*M_PI*220*t) + 0.1 * sin(2*M_PI*277.2*t) +
+                        0.1 * sin(2*M_PI*329.6*t) + 0.05 * beat * noise());
+        }
+        for (int c = 0; c < s->ch; ++c) {
+            buf[i*s->ch + c] = v;
+        }
+    }
+    s->pos      += n;
+    s->consumed += n;
+    return n;
+}
+
+#pragma mark - kernel
+static int testKernel(void) {
+    int n = 353, lags = 661;
+    float * ref = malloc(sizeof(float) * n);
+    float * x   = malloc(sizeof(float) * (n + lags));
+    float * a   = malloc(sizeof(float) * lags);
+    float * b   = malloc(sizeof(float) * lags);
+    for (int i = 0; i < n; ++i) {
+        ref[i] = noise();
+    }
+    for (int i = 0; i < n + lags; ++i) {
+        x[i] = noise();
+    }
+    int rounds = 200;
+    ksy_audio_kernel_force_c(YES);
+    double t0 = nowMs();
+    for (int r = 0; r < rounds; ++r) {
+        ksy_xcorr_f32(ref, x, n, lags, a);
+    }
+    double tC = (nowMs() - t0) / rounds;
+    ksy_audio_kernel_force_c(NO);
+    t0 = nowMs();
+    for (int r = 0; r < rounds; ++r) {
+        ksy_xcorr_f32(ref, x, n, lags, b);
+    }
+    double tS = (nowMs() - t0) / rounds;
+    double maxErr = 0;
+    for (int k = 0; k < lags; ++k) {
+        double e = fabs(a[k] - b[k]) / (fabs(a[k]) + 1.0);
+        maxErr = e > maxErr ? e : maxErr;
+    }
+    // 长度不是4/8的倍数时的尾部
+    int fail = maxErr > 1e-4;
+    for (int tn = 1; tn < 12 && !fail; ++tn) {
+        for (int tl = 1; tl < 10; ++tl) {
+            ksy_audio_kernel_force_c(YES);
+            ksy_xcorr_f32(ref, x, tn, tl, a);
+            ksy_audio_kernel_force_c(NO);
+            ksy_xcorr_f32(ref, x, tn, tl, b);
+            for (int k = 0; k < tl; ++k) {
+                fail |= fabsf(a[k] - b[k]) > 1e-4f;
+            }
+        }
+    }
+    const char * simd = ksy_audio_kernel_name();
+    ksy_audio_kernel_force_c(s_forceC);
+    printf("xcorr %d x %d lags: c %.3f ms, %s %.3f ms (%.1fx), max rel err %.2e -> %s\n",
+           n, lags, tC, simd, tS, tC / tS, maxErr, fail ? "FAIL" : "ok");
+    free(ref);
+    free(x);
+    free(a);
+    free(b);
+    return fail;
+}
+
+#pragma mark - quality
+// 按期望频率分块做最小二乘拟合, 残差为噪声+失真; 同时在拟合频率附近搜索实际频率
+static double fitSnr(const float* y, int n, double freq) {
+    int    blk = 4096;
+    double sig = 0, err = 0;
+    for (int off = 0; off + blk <= n; off += blk) {
+        double ss = 0, sc = 0, cc = 0, ys = 0, yc = 0;
+        for (int i = 0; i < blk; ++i) {
+            double w = 2 * M_PI * freq * i / RATE;
+            double s = sin(w), c = cos(w);
+            ss += s*s; cc += c*c; sc += s*c;
+            ys += y[off+i]*s; yc += y[off+i]*c;
+        }
+        double det = ss*cc - sc*sc;
+        double A = (ys*cc - yc*sc) / det;
+        double B = (yc*ss - ys*sc) / det;
+        for (int i = 0; i < blk; ++i) {
+            double w = 2 * M_PI * freq * i / RATE;
+            double f = A * sin(w) + B * cos(w);
+            sig += f * f;
+            err += (y[off+i] - f) * (y[off+i] - f);
+        }
+    }
+    return 10 * log10(sig / (err + 1e-20));
+}
+
+// 过零点估计频率 (线性插值)
+static double zeroCrossFreq(const float* y, int n) {
+    double first = -1, last = -1;
+    int    cnt = 0;
+    for (int i = 1; i < n; ++i) {
+        if (y[i-1] < 0 && y[i] >= 0) {
+            double t = i - 1 + y[i-1] / (y[i-1] - y[i]);
+            if (first < 0) {
+                first = t;
+            }
+            last = t;
+            cnt += 1;
+        }
+    }
+    return cnt > 1 ? (cnt - 1) * RATE / (last - first) : 0;
+}
+
+static int testSine(float tempo, float semi) {
+    double freq = 440;
+    SynSrc src = { 1, 0, RATE * 20, freq, 0.5, 0 };
+    KSYAudioTimeStretch * st = ksy_stretch_create(RATE, 1);
+    ksy_stretch_set_tempo(st, tempo);
+    ksy_stretch_set_pitch(st, semi);
+    int    nbOut = RATE * 4;
+    float* out   = malloc(sizeof(float) * nbOut);
+    int    got   = 0;
+    while (got < nbOut) {
+        int n = nbOut - got < s_block ? nbOut - got : s_block;
+        int r = ksy_stretch_process(st, synRead, &src, out + got, n);
+        got += r;
+        if (r < n) {
+            break;
+        }
+    }
+    // 跳过开头, 输入消耗与输出之比即实际速度 (扣除缓存的输入)
+    int    skip    = RATE / 2;
+    double expectF = freq * pow(2.0, semi / 12.0);
+    double gotF    = zeroCrossFreq(out + skip, got - skip);
+    double snr     = fitSnr(out + skip, got - skip, gotF);
+    double speed   = (double)(src.consumed - ksy_stretch_buffered(st)) / got;
+    double maxStep = 0;
+    for (int i = skip + 1; i < got; ++i) {
+        double d = fabs(out[i] - out[i-1]);
+        maxStep = d > maxStep ? d : maxStep;
+    }
+    double sineStep = 0.5 * 2 * M_PI * expectF / RATE; // 正弦波的最大斜率
+    double cents = 1200 * log2(gotF / expectF);
+    int fail = got < nbOut || fabs(speed / tempo - 1) > 0.01 || fabs(cents) > 5 ||
+               snr < 25 || maxStep > sineStep * 1.3;
+    printf("sine 440Hz tempo %.2f pitch %+5.1f: speed %.4f, freq %.1f Hz (%+.1f cents), "
+           "SNR %.1f dB, max step %.2fx -> %s\n",
+           tempo, semi, speed, gotF, cents, snr, maxStep / sineStep, fail ? "FAIL" : "ok");
+    ksy_stretch_destroy(st);
+    free(out);
+    return fail;
+}
+
+// 处理中途改变参数 (直通 -> 变速 -> 变调 -> 回到原速原调), 检查跳变
+static int testSwitch(void) {
+    double freq = 330;
+    SynSrc src = { 2, 0, RATE * 30, freq, 0.5, 0 };
+    KSYAudioTimeStretch * st = ksy_stretch_create(RATE, 2);
+    float  steps[][2] = { {1, 0}, {0.8f, 0}, {0.8f, 3}, {1.25f, -5}, {1, 0}, {1.5f, 7} };
+    int    nbStep = sizeof(steps) / sizeof(steps[0]);
+    float* buf  = malloc(sizeof(float) * s_block * 2);
+    float  prev = 0;
+    double maxStep = 0;
+    int    got = 0;
+    for (int s = 0; s < nbStep; ++s) {
+        ksy_stretch_set_tempo(st, steps[s][0]);
+        ksy_stretch_set_pitch(st, steps[s][1]);
+        double f = freq * pow(2.0, steps[s][1] / 12.0);
+        maxStep = fmax(maxStep, 0.5 * 2 * M_PI * f / RATE);
+        for (int b = 0; b < RATE / s_block; ++b) { // 每组参数约1秒
+            int n = ksy_stretch_process(st, synRead, &src, buf, s_block);
+            for (int i = 0; i < n; ++i) {
+                float d = fabsf(buf[i*2] - prev);
+                if (got > 0 && d > maxStep * 1.3) {
+                    printf("  jump %.4f at frame %d (step %d)\n", d, got, s);
+                    maxStep = 1e9; // 只报告第一次
+                }
+                prev = buf[i*2];
+                got += 1;
+            }
+        }
+    }
+    int fail = maxStep > 1e8;
+    printf("switch: %d frames through %d parameter changes, %s -> %s\n",
+           got, nbStep - 1, fail ? "JUMP" : "continuous", fail ? "FAIL" : "ok");
+    ksy_stretch_destroy(st);
+    free(buf);
+    return fail;
+}
+
+#pragma mark - cpu
+static int testCpu(float tempo, float semi) {
+    int sec = 30;
+    SynSrc src = { 2, 0, (int64_t)RATE * sec * 3, 0, 0, 0 };
+    KSYAudioTimeStretch * st = ksy_stretch_create(RATE, 2);
+    ksy_stretch_set_tempo(st, tempo);
+    ksy_stretch_set_pitch(st, semi);
+    float* buf = malloc(sizeof(float) * s_block * 2);
+    int64_t total = (int64_t)RATE * sec, got = 0;
+    double t0 = nowMs();
+    while (got < total) {
+        int n = ksy_stretch_process(st, synRead, &src, buf, s_block);
+        if (n <= 0) {
+            break;
+        }
+        got += n;
+    }
+    double ms = nowMs() - t0;
+    // 扣除合成信号本身的耗时
+    SynSrc ref = { 2, 0, (int64_t)RATE * sec * 3, 0, 0, 0 };
+    float* tmp = malloc(sizeof(float) * s_block * 2);
+    double t1 = nowMs();
+    for (int64_t i = 0; i < src.consumed; i += s_block) {
+        synRead(&ref, tmp, s_block);
+    }
+    ms -= nowMs() - t1;
+    printf("cpu stereo tempo %.2f pitch %+5.1f (%s): %.2f ms per second of output, %.3f%% of realtime\n",
+           tempo, semi, ksy_audio_kernel_name(), ms / sec, ms / sec / 10);
+    ksy_stretch_destroy(st);
+    free(buf);
+    free(tmp);
+    return 0;
+}
+
+#pragma mark - wav
+typedef struct {
+    int      rate;
+    int      ch;
+    int64_t  nbFrame;
+    float *  pcm;
+    int64_t  pos;
+} Wav;
+
+static int wavRead(void* ctx, float* buf, int n) {
+    Wav * w = ctx;
+    if (n > w->nbFrame - w->pos) {
+        n = (int)(w->nbFrame - w->pos);
+    }
+    memcpy(buf, w->pcm + w->pos * w->ch, sizeof(float) * n * w->ch);
+    w->pos += n;
+    return n;
+}
+
+static int loadWav(const char* path, Wav* w) {
+    FILE * fp = fopen(path, "rb");
+    uint8_t hdr[12], ck[8];
+    int bits = 0, ret = -1;
+    if (fp == NULL) {
+        return -1;
+    }
+    if (fread(hdr, 1, 12, fp) == 12 && memcmp(hdr, "RIFF", 4) == 0 &&
+        memcmp(hdr + 8, "WAVE", 4) == 0) {
+        while (fread(ck, 1, 8, fp) == 8) {
+            uint32_t sz = ck[4] | ck[5] << 8 | ck[6] << 16 | (uint32_t)ck[7] << 24;
+            if (memcmp(ck, "fmt ", 4) == 0) {
+                uint8_t f[16];
+                if (sz < 16 || fread(f, 1, 16, fp) != 16) {
+                    break;
+                }
+                w->ch   = f[2] | f[3] << 8;
+                w->rate = f[4] | f[5] << 8 | f[6] << 16 | f[7] << 24;
+                bits    = f[14] | f[15] << 8;
+                fseek(fp, sz - 16 + (sz & 1), SEEK_CUR);
+            }
+            else if (memcmp(ck, "data", 4) == 0) {
+                if (bits != 16 || w->ch <= 0 || w->ch > 2) {
+                    break;
+                }
+                w->nbFrame = sz / (2 * w->ch);
+                int16_t * s16 = malloc(sz);
+                w->pcm = malloc(sizeof(float) * w->nbFrame * w->ch);
+                if (s16 && w->pcm && fread(s16, 2 * w->ch, w->nbFrame, fp) == (size_t)w->nbFrame) {
+                    ksy_s16_to_f32(w->pcm, s16, (int)(w->nbFrame * w->ch));
+                    ret = 0;
+                }
+                free(s16);
+                break;
+            }
+            else {
+                fseek(fp, sz + (sz & 1), SEEK_CUR);
+            }
+        }
+    }
+    fclose(fp);
+    return ret;
+}
+
+static void put32(FILE* fp, uint32_t v) {
+    uint8_t b[4] = { v, v >> 8, v >> 16, v >> 24 };
+    fwrite(b, 1, 4, fp);
+}
+
+static void put16(FILE* fp, uint16_t v) {
+    uint8_t b[2] = { v, v >> 8 };
+    fwrite(b, 1, 2, fp);
+}
+
+static int processFile(const char* in, const char* outPath, float tempo, float semi) {
+    Wav w = {0};
+    if (loadWav(in, &w) != 0) {
+        fprintf(stderr, "not a 16 bit PCM wav (1~2 channels): %s\n", in);
+        return 1;
+    }
+    KSYAudioTimeStretch * st = ksy_stretch_create(w.rate, w.ch);
+    ksy_stretch_set_tempo(st, tempo);
+    ksy_stretch_set_pitch(st, semi);
+    int64_t cap = (int64_t)(w.nbFrame / tempo) + s_block * 4;
+    float *   out = malloc(sizeof(float) * cap * w.ch);
+    int64_t   got = 0;
+    double t0 = nowMs();
+    while (got + s_block <= cap) {
+        int n = ksy_stretch_process(st, wavRead, &w, out + got * w.ch, s_block);
+        got += n;
+        if (n < s_block) {
+            break;
+        }
+    }
+    double ms = nowMs() - t0;
+    int16_t * s16 = malloc(sizeof(int16_t) * got * w.ch);
+    ksy_f32_to_s16(s16, out, (int)(got * w.ch));
+    FILE * fp = fopen(outPath, "wb");
+    if (fp == NULL) {
+        fprintf(stderr, "can not write %s\n", outPath);
+        return 1;
+    }
+    uint32_t dataLen = (uint32_t)(got * w.ch * 2);
+    fwrite("RIFF", 1, 4, fp); put32(fp, 36 + dataLen); fwrite("WAVE", 1, 4, fp);
+    fwrite("fmt ", 1, 4, fp); put32(fp, 16); put16(fp, 1); put16(fp, w.ch);
+    put32(fp, w.rate); put32(fp, w.rate * w.ch * 2); put16(fp, w.ch * 2); put16(fp, 16);
+    fwrite("data", 1, 4, fp); put32(fp, dataLen);
+    fwrite(s16, 2 * w.ch, got, fp);
+    fclose(fp);
+    printf("%s: %.2f s -> %.2f s (tempo %.2f, pitch %+.1f), %.1f ms, %.3f%% of realtime (%s)\n",
+           in, (double)w.nbFrame / w.rate, (double)got / w.rate, tempo, semi, ms,
+           ms / ((double)got / w.rate) / 10, ksy_audio_kernel_name());
+    ksy_stretch_destroy(st);
+    free(out);
+    free(s16);
+    free(w.pcm);
+    return 0;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: stretchbench [-t tempo] [-p semitone] [-b block] [-C] [in.wav out.wav]\n");
+}
+
+int main(int argc, char** argv) {
+    float tempo = 1.0f, semi = 0.0f;
+    int a = 1;
+    for (; a < argc && argv[a][0] == '-'; ++a) {
+        const char * opt = argv[a];
+        if (strcmp(opt, "-C") == 0) {
+            s_forceC = YES;
+            ksy_audio_kernel_force_c(YES);
+            continue;
+        }
+        if (a + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const char * val = argv[++a];
+        if (strcmp(opt, "-t") == 0)      { tempo   = atof(val); }
+        else if (strcmp(opt, "-p") == 0) { semi    = atof(val); }
+        else if (strcmp(opt, "-b") == 0) { s_block = atoi(val); }
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (s_block <= 0 || s_block > 8192) {
+        usage();
+        return 1;
+    }
+    if (a + 2 <= argc) {
+        return processFile(argv[a], argv[a+1], tempo, semi);
+    }
+    int fail = 0;
+    fail |= testKernel();
+    float cases[][2] = { {1, 0}, {0.5f, 0}, {0.75f, 0}, {1.5f, 0}, {2, 0},
+                         {1, 5}, {1, -5}, {1, 12}, {1, -12}, {0.8f, 3}, {1.25f, -7} };
+    for (int i = 0; i < (int)(sizeof(cases) / sizeof(cases[0])); ++i) {
+        fail |= testSine(cases[i][0], cases[i][1]);
+    }
+    fail |= testSwitch();
+    testCpu(0.8f, 0);
+    testCpu(1.0f, 4);
+    testCpu(1.25f, -3);
+    return fail;
+}